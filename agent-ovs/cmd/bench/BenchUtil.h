@@ -0,0 +1,165 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Helpers shared by the flow manager benchmarks
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#ifndef OPFLEXAGENT_BENCH_BENCHUTIL_H_
+#define OPFLEXAGENT_BENCH_BENCHUTIL_H_
+
+#include "SwitchManager.h"
+#include "SwitchConnection.h"
+#include "FlowExecutor.h"
+#include "PortMapper.h"
+#include "ovs-ofputil.h"
+
+#include <opflexagent/Agent.h>
+
+#include <pthread.h>
+#include <time.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace opflexagent {
+namespace bench {
+
+/**
+ * Wait for the tasks already posted to the agent IO thread
+ */
+inline void drain(Agent& agent) {
+    std::promise<void> done;
+    agent.getAgentIOService().post([&done]() { done.set_value(); });
+    done.get_future().wait();
+}
+
+/**
+ * Get the CPU time clock of the agent IO thread, which runs the flow
+ * manager tasks
+ */
+inline clockid_t getIOThreadClock(Agent& agent) {
+    std::promise<clockid_t> clock;
+    agent.getAgentIOService().post([&clock]() {
+            clockid_t c;
+            pthread_getcpuclockid(pthread_self(), &c);
+            clock.set_value(c);
+        });
+    return clock.get_future().get();
+}
+
+/**
+ * Read a CPU time clock in microseconds
+ */
+inline double cpuUs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * Stands in for the switch: counts the flow edits it is sent and
+ * acknowledges them immediately
+ */
+class CountingFlowExecutor : public FlowExecutor {
+public:
+    CountingFlowExecutor() : executes(0), edits(0), adds(0) {}
+
+    virtual bool Execute(const FlowEdit& fe) {
+        if (fe.edits.empty())
+            return true;
+        std::lock_guard<std::mutex> guard(mutex);
+        executes += 1;
+        edits += fe.edits.size();
+        for (const FlowEdit::Entry& e : fe.edits) {
+            if (e.first == FlowEdit::ADD)
+                adds += 1;
+        }
+        cond.notify_all();
+        return true;
+    }
+
+    virtual bool Execute(const GroupEdit&) { return true; }
+    virtual bool Execute(const TlvEdit&) { return true; }
+
+    /**
+     * Get the number of non-empty flow edits executed and the number
+     * of flow entries they changed
+     */
+    void getCounts(size_t& executes_, size_t& edits_) {
+        std::lock_guard<std::mutex> guard(mutex);
+        executes_ = executes;
+        edits_ = edits;
+    }
+
+    /**
+     * Get the number of flow entries added
+     */
+    size_t getAdds() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return adds;
+    }
+
+    /**
+     * Wait up to a minute until at least count flow entries have
+     * been changed
+     */
+    bool waitForEdits(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cond.wait_for(lock, std::chrono::seconds(60),
+                             [&]() { return edits >= count; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    size_t executes;
+    size_t edits;
+    size_t adds;
+};
+
+/**
+ * A switch manager that writes to its flow executor without
+ * connecting or syncing
+ */
+class BenchSwitchManager : public SwitchManager {
+public:
+    BenchSwitchManager(Agent& agent, FlowExecutor& flowExecutor,
+                       FlowReader& flowReader, PortMapper& portMapper)
+        : SwitchManager(agent, flowExecutor, flowReader, portMapper) {}
+
+    virtual void start(const std::string& swName) {
+        connection.reset(new SwitchConnection(swName));
+    }
+};
+
+/**
+ * A port mapper for the ports set up by the benchmark
+ */
+class BenchPortMapper : public PortMapper {
+public:
+    using PortMapper::FindPort;
+
+    virtual uint32_t FindPort(const std::string& name) {
+        auto it = ports.find(name);
+        return it == ports.end() ? OFPP_NONE : it->second;
+    }
+
+    /**
+     * The OpenFlow port number of each port name
+     */
+    std::unordered_map<std::string, uint32_t> ports;
+};
+
+} /* namespace bench */
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_BENCH_BENCHUTIL_H_ */
@@ -0,0 +1,333 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for endpoint advertisement throughput and pacing
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "BenchUtil.h"
+#include "AdvertManager.h"
+#include "IntFlowManager.h"
+#include "SwitchManager.h"
+#include "SwitchConnection.h"
+#include "FlowExecutor.h"
+#include "FlowReader.h"
+#include "CtZoneManager.h"
+#include "ovs-ofputil.h"
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/EndpointSource.h>
+#include <opflexagent/IdGenerator.h>
+#include <opflexagent/PolicyManager.h>
+#include <opflexagent/TunnelEpManager.h>
+#include <opflexagent/logging.h>
+
+#include <modelgbp/dmtree/Root.hpp>
+#include <opflex/ofcore/OFFramework.h>
+#include <opflex/modb/Mutator.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::chrono::steady_clock;
+using opflex::modb::URI;
+using opflex::modb::MAC;
+using opflex::modb::Mutator;
+using opflexagent::Agent;
+using opflexagent::AdvertManager;
+using opflexagent::IntFlowManager;
+using opflexagent::bench::BenchPortMapper;
+namespace po = boost::program_options;
+
+/*
+ * Drives an AdvertManager for a set of local endpoints against a
+ * switch connection that records when each packet-out is sent.
+ *
+ * The initial round, which builds every advertisement, is sent at
+ * once.  A periodic round is sent from the cached advertisements and
+ * paced across the pacing window.  For each round the time until the
+ * last advertisement is sent, the bursts of back-to-back packet-outs
+ * and, for the paced round, the largest deviation of a burst from its
+ * even share of the window are reported.
+ */
+
+static URI createPolicy(opflex::ofcore::OFFramework& framework) {
+    using namespace modelgbp;
+    using namespace modelgbp::gbp;
+    using namespace modelgbp::gbpe;
+
+    Mutator mutator(framework, "policyreg");
+    shared_ptr<policy::Universe> universe =
+        policy::Universe::resolve(framework).get();
+    shared_ptr<policy::Space> space = universe->addPolicySpace("bench");
+
+    shared_ptr<RoutingDomain> rd = space->addGbpRoutingDomain("rd");
+    rd->addGbpeInstContext()->setEncapId(1);
+    shared_ptr<BridgeDomain> bd = space->addGbpBridgeDomain("bd");
+    bd->addGbpeInstContext()->setEncapId(10);
+    bd->addGbpBridgeDomainToNetworkRSrc()
+        ->setTargetRoutingDomain(rd->getURI());
+    shared_ptr<FloodDomain> fd = space->addGbpFloodDomain("fd");
+    fd->addGbpFloodDomainToNetworkRSrc()
+        ->setTargetBridgeDomain(bd->getURI());
+    shared_ptr<EpGroup> epg = space->addGbpEpGroup("epg");
+    epg->addGbpEpGroupToNetworkRSrc()
+        ->setTargetFloodDomain(fd->getURI());
+    epg->addGbpeInstContext()->setEncapId(1000).setClassid(1000);
+    mutator.commit();
+    return epg->getURI();
+}
+
+// Stands in for the switch: records when each message is sent
+class RecordingSwitchConnection : public opflexagent::SwitchConnection {
+public:
+    RecordingSwitchConnection() : SwitchConnection("bench") {}
+
+    virtual bool IsConnected() { return true; }
+    virtual int GetProtocolVersion() { return OFP13_VERSION; }
+
+    virtual int SendMessage(OfpBuf&) {
+        std::lock_guard<std::mutex> guard(mutex);
+        sendTimes.push_back(steady_clock::now());
+        cond.notify_all();
+        return 0;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> guard(mutex);
+        sendTimes.clear();
+    }
+
+    bool waitForSends(size_t count, uint64_t timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cond.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                             [&]() { return sendTimes.size() >= count; });
+    }
+
+    vector<steady_clock::time_point> getSendTimes() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return sendTimes;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    vector<steady_clock::time_point> sendTimes;
+};
+
+struct Result {
+    double lastMs;
+    double durationMs;
+    size_t bursts;
+    size_t maxBurst;
+    double jitterMs;
+};
+
+/*
+ * Split the sends into bursts of messages less than gapUs apart.
+ * When an interval is given, the jitter is the largest deviation of
+ * the start of a burst from its slot in the window.
+ */
+static void analyze(const vector<steady_clock::time_point>& sendTimes,
+                    steady_clock::time_point scheduled,
+                    double gapUs, double intervalMs, Result& result) {
+    typedef std::chrono::duration<double, std::milli> ms_t;
+
+    result.lastMs = ms_t(sendTimes.back() - scheduled).count();
+    result.durationMs = ms_t(sendTimes.back() - sendTimes.front()).count();
+    result.bursts = 0;
+    result.maxBurst = 0;
+    result.jitterMs = 0;
+
+    size_t burst = 0;
+    for (size_t i = 0; i < sendTimes.size(); ++i) {
+        if (i == 0 ||
+            ms_t(sendTimes[i] - sendTimes[i - 1]).count() * 1000 > gapUs) {
+            if (intervalMs > 0) {
+                double offset =
+                    ms_t(sendTimes[i] - sendTimes.front()).count();
+                result.jitterMs =
+                    std::max(result.jitterMs,
+                             std::fabs(offset - result.bursts * intervalMs));
+            }
+            result.bursts += 1;
+            burst = 0;
+        }
+        burst += 1;
+        result.maxBurst = std::max(result.maxBurst, burst);
+    }
+}
+
+static bool run(AdvertManager& advertManager,
+                RecordingSwitchConnection& conn, uint32_t endpoints,
+                bool paced, uint64_t window, double gapUs,
+                double intervalMs, Result& result) {
+    conn.clear();
+    auto scheduled = steady_clock::now();
+    if (paced)
+        advertManager.schedulePeriodicEndpointAdv(0);
+    else
+        advertManager.scheduleInitialEndpointAdv(0);
+    if (!conn.waitForSends(endpoints, window + 60000))
+        return false;
+    analyze(conn.getSendTimes(), scheduled, gapUs,
+            paced ? intervalMs : 0, result);
+    return true;
+}
+
+static void printResult(const char* name, const Result& r,
+                        uint32_t endpoints) {
+    std::cout << "\"" << name << "\": {\"last_ms\": " << r.lastMs
+              << ", \"duration_ms\": " << r.durationMs
+              << ", \"advs_per_sec\": "
+              << (r.lastMs > 0 ? endpoints * 1000.0 / r.lastMs : 0)
+              << ", \"bursts\": " << r.bursts
+              << ", \"max_burst\": " << r.maxBurst
+              << ", \"jitter_ms\": " << r.jitterMs << "}";
+}
+
+int main(int argc, char** argv) {
+    uint32_t endpoints, batchSize;
+    uint64_t window;
+    double gapUs;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("endpoints", po::value<uint32_t>(&endpoints)->default_value(5000),
+         "Number of endpoints to advertise")
+        ("batch-size", po::value<uint32_t>(&batchSize)->
+         default_value(AdvertManager::DEFAULT_ADV_BATCH_SIZE),
+         "Number of endpoints per paced batch")
+        ("window", po::value<uint64_t>(&window)->default_value(2000),
+         "Pacing window in milliseconds")
+        ("burst-gap-us", po::value<double>(&gapUs)->default_value(1000),
+         "Gap in microseconds between sends that ends a burst")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (endpoints == 0 || batchSize == 0) {
+        std::cerr << "Need at least one endpoint per batch" << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "endpoint-adv-bench");
+
+    opflex::ofcore::OFFramework framework;
+    Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    URI epg = createPolicy(framework);
+    opflexagent::PolicyManager& pm = agent.getPolicyManager();
+    for (int i = 0; i < 10000; ++i) {
+        if (pm.getVnidForGroup(epg))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // each endpoint has a MAC and an IPv4 address, which is one
+    // gratuitous ARP
+    opflexagent::EndpointSource epSrc(&agent.getEndpointManager());
+    for (uint32_t i = 0; i < endpoints; ++i) {
+        uint8_t mac[6] = {0x02, 0x01, 0, (uint8_t)(i >> 16),
+                          (uint8_t)(i >> 8), (uint8_t)i};
+        opflexagent::Endpoint ep("ep-" + std::to_string(i));
+        ep.setMAC(MAC(mac));
+        ep.addIP("10." + std::to_string(i >> 16) + "." +
+                 std::to_string((i >> 8) & 0xff) + "." +
+                 std::to_string(i & 0xff));
+        ep.setEgURI(epg);
+        epSrc.updateEndpoint(ep);
+    }
+    opflexagent::EndpointManager& epMgr = agent.getEndpointManager();
+    for (int i = 0; i < 10000; ++i) {
+        if (epMgr.getEndpointsForGroup(epg).size() == endpoints)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    BenchPortMapper portMapper;
+    portMapper.ports["vxlan0"] = 2048;
+    opflexagent::TunnelEpManager tunnelEpManager(&agent);
+    opflexagent::IdGenerator idGen;
+    opflexagent::CtZoneManager ctZoneManager(idGen);
+    opflexagent::FlowExecutor executor;
+    opflexagent::FlowReader reader;
+    opflexagent::SwitchManager switchManager(agent, executor, reader,
+                                             portMapper);
+    IntFlowManager intFlowManager(agent, switchManager, idGen,
+                                  ctZoneManager, tunnelEpManager);
+    intFlowManager.setEncapType(IntFlowManager::ENCAP_VXLAN);
+    intFlowManager.setEncapIface("vxlan0");
+    intFlowManager.setTunnel("10.11.12.13", 4789);
+    intFlowManager.setVirtualRouter(true, false, "00:22:bd:f8:19:ff");
+
+    RecordingSwitchConnection conn;
+    AdvertManager advertManager(agent, intFlowManager);
+    advertManager.setPortMapper(&portMapper);
+    advertManager.registerConnection(&conn);
+    advertManager.setIOService(&agent.getAgentIOService());
+    advertManager.
+        enableEndpointAdv(AdvertManager::EPADV_GRATUITOUS_BROADCAST);
+    advertManager.setEndpointAdvPacing(batchSize, window);
+    advertManager.start();
+
+    // the pacing interval the advertisement manager aims for
+    size_t batches = (endpoints + batchSize - 1) / batchSize;
+    double intervalMs = batches > 1 ? (double)(window / batches) : 0;
+
+    Result ir, pr;
+    bool ok = run(advertManager, conn, endpoints, false, window, gapUs,
+                  intervalMs, ir) &&
+        run(advertManager, conn, endpoints, true, window, gapUs,
+            intervalMs, pr);
+
+    advertManager.stop();
+    agent.stop();
+
+    if (!ok) {
+        std::cerr << "endpoint advertisements were not sent" << std::endl;
+        return 1;
+    }
+
+    std::cout << "{\"benchmark\": \"endpoint_adv\", "
+              << "\"endpoints\": " << endpoints << ", "
+              << "\"batch_size\": " << batchSize << ", "
+              << "\"window\": " << window << ", "
+              << "\"interval_ms\": " << intervalMs << ", ";
+    printResult("initial", ir, endpoints);
+    std::cout << ", ";
+    printResult("periodic", pr, endpoints);
+    std::cout << "}" << std::endl;
+    return 0;
+}
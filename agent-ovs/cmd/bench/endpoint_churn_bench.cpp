@@ -0,0 +1,396 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for integration bridge flow generation under endpoint
+ * churn
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "BenchUtil.h"
+#include "IntFlowManager.h"
+#include "SwitchManager.h"
+#include "FlowExecutor.h"
+#include "FlowReader.h"
+#include "CtZoneManager.h"
+#include "ovs-ofputil.h"
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/EndpointSource.h>
+#include <opflexagent/IdGenerator.h>
+#include <opflexagent/PolicyManager.h>
+#include <opflexagent/TunnelEpManager.h>
+#include <opflexagent/logging.h>
+
+#include <modelgbp/dmtree/Root.hpp>
+#include <opflex/ofcore/OFFramework.h>
+#include <opflex/modb/Mutator.h>
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using opflex::modb::URI;
+using opflex::modb::MAC;
+using opflex::modb::Mutator;
+using opflexagent::Agent;
+using opflexagent::Endpoint;
+using opflexagent::IntFlowManager;
+using namespace opflexagent::bench;
+namespace po = boost::program_options;
+
+/*
+ * Simulates the endpoint file rewrites of a busy node.  Most rewrites
+ * only change the endpoint attributes, such as pod labels; some change
+ * its security groups, a few its virtual IPs, and rarely its IPs.
+ *
+ * Each round updates every endpoint once and waits for the
+ * integration flow manager to process the updates.  The CPU time of
+ * the agent IO thread, which runs the flow manager tasks, is reported
+ * per update for a flow manager that regenerates all the endpoint
+ * flows on each update (full) and for one that regenerates only the
+ * flow groups whose inputs changed (incremental).
+ */
+
+struct Policy {
+    URI epg;
+    URI natEpg;
+    vector<URI> secGroups;
+};
+
+static Policy createPolicy(opflex::ofcore::OFFramework& framework) {
+    using namespace modelgbp;
+    using namespace modelgbp::gbp;
+    using namespace modelgbp::gbpe;
+
+    Policy p;
+    Mutator mutator(framework, "policyreg");
+    shared_ptr<policy::Universe> universe =
+        policy::Universe::resolve(framework).get();
+    shared_ptr<policy::Space> space = universe->addPolicySpace("bench");
+
+    shared_ptr<RoutingDomain> rd = space->addGbpRoutingDomain("rd");
+    rd->addGbpeInstContext()->setEncapId(1);
+
+    for (int g = 0; g < 2; ++g) {
+        string n = std::to_string(g);
+        shared_ptr<BridgeDomain> bd = space->addGbpBridgeDomain("bd" + n);
+        bd->addGbpeInstContext()->setEncapId(10 + g);
+        bd->addGbpBridgeDomainToNetworkRSrc()
+            ->setTargetRoutingDomain(rd->getURI());
+        shared_ptr<FloodDomain> fd = space->addGbpFloodDomain("fd" + n);
+        fd->addGbpFloodDomainToNetworkRSrc()
+            ->setTargetBridgeDomain(bd->getURI());
+        shared_ptr<Subnets> subnets = space->addGbpSubnets("subnets" + n);
+        subnets->addGbpSubnet("subnet" + n)
+            ->setAddress(g == 0 ? "10.0.0.0" : "5.5.0.0")
+            .setPrefixLen(16);
+        bd->addGbpForwardingBehavioralGroupToSubnetsRSrc()
+            ->setTargetSubnets(subnets->getURI());
+
+        shared_ptr<EpGroup> epg = space->addGbpEpGroup("epg" + n);
+        epg->addGbpEpGroupToNetworkRSrc()
+            ->setTargetFloodDomain(fd->getURI());
+        epg->addGbpeInstContext()->setEncapId(1000 + g).setClassid(1000 + g);
+        (g == 0 ? p.epg : p.natEpg) = epg->getURI();
+    }
+    for (int s = 0; s < 3; ++s)
+        p.secGroups.push_back(space->addGbpSecGroup("sg" +
+                                                    std::to_string(s))
+                              ->getURI());
+    mutator.commit();
+    return p;
+}
+
+// A flow manager writing to a switch manager that stays in sync mode,
+// so flows are only diffed against the table state and never sent
+struct FlowStack {
+    FlowStack(Agent& agent, opflexagent::TunnelEpManager& tunnelEpManager,
+              opflexagent::PortMapper& portMapper, bool incremental)
+        : ctZoneManager(idGen),
+          switchManager(agent, executor, reader, portMapper),
+          intFlowManager(agent, switchManager, idGen, ctZoneManager,
+                         tunnelEpManager) {
+        ctZoneManager.setCtZoneRange(1, 65534);
+        ctZoneManager.init("conntrack");
+        intFlowManager.setIncrementalEndpointFlows(incremental);
+        intFlowManager.setEncapType(IntFlowManager::ENCAP_VXLAN);
+        intFlowManager.setEncapIface("vxlan0");
+        intFlowManager.setVirtualRouter(true, false, "00:22:bd:f8:19:ff");
+        intFlowManager.setVirtualDHCP(true, "00:22:bd:f8:19:ff");
+        switchManager.start("bench");
+        intFlowManager.start();
+    }
+
+    ~FlowStack() {
+        intFlowManager.stop();
+        switchManager.stop();
+    }
+
+    opflexagent::IdGenerator idGen;
+    opflexagent::CtZoneManager ctZoneManager;
+    opflexagent::FlowExecutor executor;
+    opflexagent::FlowReader reader;
+    opflexagent::SwitchManager switchManager;
+    IntFlowManager intFlowManager;
+};
+
+struct BenchEp {
+    Endpoint ep;
+    std::unordered_set<string> ips;
+    string extraIp;
+    bool hasExtraSg;
+    bool hasExtraIp;
+    bool hasVip;
+};
+
+enum Change { ATTRIBUTE, SECURITY_GROUP, VIRTUAL_IP, IP, N_CHANGES };
+
+static const char* CHANGE_NAMES[] =
+    {"attribute", "security_group", "virtual_ip", "ip"};
+
+static vector<BenchEp> createEndpoints(const Policy& p,
+                                       BenchPortMapper& portMapper,
+                                       uint32_t count, uint32_t ips,
+                                       uint32_t mappings) {
+    vector<BenchEp> eps;
+    uint32_t nextIp = 1;
+    auto ip = [&nextIp]() {
+        uint32_t n = nextIp++;
+        return "10.0." + std::to_string(n / 250) + "." +
+            std::to_string(n % 250 + 1);
+    };
+    for (uint32_t i = 0; i < count; ++i) {
+        string n = std::to_string(i);
+        BenchEp b{Endpoint("ep-" + n), {}, ip(), false, false, false};
+        Endpoint& ep = b.ep;
+        ep.setInterfaceName("veth" + n);
+        portMapper.ports["veth" + n] = 100 + i;
+        uint8_t mac[6] = {0x02, 0, 0, (uint8_t)(i >> 16),
+                          (uint8_t)(i >> 8), (uint8_t)i};
+        ep.setMAC(MAC(mac));
+        ep.setEgURI(p.epg);
+        for (uint32_t j = 0; j < ips; ++j)
+            b.ips.insert(ip());
+        ep.setIPs(b.ips);
+        ep.addSecurityGroup(p.secGroups[0]);
+        ep.addAttribute("app", "bench");
+        ep.addAttribute("pod-template-hash", "0");
+
+        uint32_t m = 0;
+        for (const string& mapped : b.ips) {
+            if (m >= mappings) break;
+            Endpoint::IPAddressMapping ipm(ep.getUUID() + "-ipm" +
+                                           std::to_string(m));
+            ipm.setMappedIP(mapped);
+            ipm.setFloatingIP("5.5." + std::to_string(i / 250) + "." +
+                              std::to_string(i % 250 + 1 + m));
+            ipm.setEgURI(p.natEpg);
+            ep.addIPAddressMapping(ipm);
+            m += 1;
+        }
+        eps.push_back(b);
+    }
+    return eps;
+}
+
+static Change pickChange(std::mt19937& rng) {
+    uint32_t r = rng() % 100;
+    if (r < 60) return ATTRIBUTE;
+    if (r < 85) return SECURITY_GROUP;
+    if (r < 95) return VIRTUAL_IP;
+    return IP;
+}
+
+static void applyChange(BenchEp& b, Change c, const Policy& p,
+                        uint32_t round) {
+    Endpoint& ep = b.ep;
+    switch (c) {
+    case ATTRIBUTE:
+        ep.addAttribute("pod-template-hash", std::to_string(round));
+        break;
+    case SECURITY_GROUP:
+        {
+            b.hasExtraSg = !b.hasExtraSg;
+            std::set<URI> sgs{p.secGroups[0]};
+            if (b.hasExtraSg)
+                sgs.insert(p.secGroups[1 + round % (p.secGroups.size() - 1)]);
+            ep.setSecurityGroups(sgs);
+        }
+        break;
+    case VIRTUAL_IP:
+        {
+            b.hasVip = !b.hasVip;
+            Endpoint::virt_ip_set vips;
+            if (b.hasVip)
+                vips.insert(std::make_pair(ep.getMAC().get(),
+                                           "10.254.0.1"));
+            ep.setVirtualIPs(vips);
+        }
+        break;
+    case IP:
+        {
+            b.hasExtraIp = !b.hasExtraIp;
+            std::unordered_set<string> ips(b.ips);
+            if (b.hasExtraIp)
+                ips.insert(b.extraIp);
+            ep.setIPs(ips);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+struct Result {
+    double cpuUsPerUpdate;
+    double wallUsPerUpdate;
+};
+
+static Result run(Agent& agent, FlowStack& stack, const Policy& p,
+                  vector<BenchEp> eps, uint32_t rounds,
+                  vector<size_t>& changeCounts) {
+    opflexagent::EndpointSource epSrc(&agent.getEndpointManager());
+    IntFlowManager& ifm = stack.intFlowManager;
+
+    // initial flows are not measured
+    for (BenchEp& b : eps) {
+        epSrc.updateEndpoint(b.ep);
+        ifm.endpointUpdated(b.ep.getUUID());
+    }
+    drain(agent);
+
+    // the same sequence of changes for each flow manager
+    std::mt19937 rng(42);
+    changeCounts.assign(N_CHANGES, 0);
+    clockid_t clock = getIOThreadClock(agent);
+    double cpuStart = cpuUs(clock);
+    auto wallStart = std::chrono::steady_clock::now();
+    for (uint32_t r = 0; r < rounds; ++r) {
+        // the task queue coalesces updates to the same endpoint, so
+        // each endpoint changes once per round
+        for (BenchEp& b : eps) {
+            Change c = pickChange(rng);
+            changeCounts[c] += 1;
+            applyChange(b, c, p, r + 1);
+            epSrc.updateEndpoint(b.ep);
+            ifm.endpointUpdated(b.ep.getUUID());
+        }
+        drain(agent);
+    }
+    double cpu = cpuUs(clock) - cpuStart;
+    double wall = std::chrono::duration<double, std::micro>
+        (std::chrono::steady_clock::now() - wallStart).count();
+
+    for (BenchEp& b : eps) {
+        epSrc.removeEndpoint(b.ep.getUUID());
+        ifm.endpointUpdated(b.ep.getUUID());
+    }
+    drain(agent);
+
+    size_t updates = (size_t)rounds * eps.size();
+    return Result{cpu / updates, wall / updates};
+}
+
+int main(int argc, char** argv) {
+    uint32_t endpoints, ips, mappings, rounds;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("endpoints", po::value<uint32_t>(&endpoints)->default_value(200),
+         "Number of local endpoints")
+        ("ips", po::value<uint32_t>(&ips)->default_value(2),
+         "Number of IPs per endpoint")
+        ("mappings", po::value<uint32_t>(&mappings)->default_value(1),
+         "Number of IP address mappings per endpoint")
+        ("rounds", po::value<uint32_t>(&rounds)->default_value(50),
+         "Number of update rounds over all the endpoints")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (endpoints == 0 || ips == 0 || rounds == 0) {
+        std::cerr << "Need at least one endpoint, IP and round"
+                  << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "endpoint-churn-bench");
+
+    opflex::ofcore::OFFramework framework;
+    Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    Policy p = createPolicy(framework);
+    opflexagent::PolicyManager& pm = agent.getPolicyManager();
+    for (int i = 0; i < 10000; ++i) {
+        if (pm.getSnapshot()->getGroup(p.natEpg))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    BenchPortMapper portMapper;
+    portMapper.ports["vxlan0"] = 2048;
+    vector<BenchEp> eps =
+        createEndpoints(p, portMapper, endpoints, ips, mappings);
+
+    // both flow managers stay alive until the agent stops, since they
+    // remain registered as framework peer status listeners
+    opflexagent::TunnelEpManager tunnelEpManager(&agent);
+    std::unique_ptr<FlowStack> full(new FlowStack(agent, tunnelEpManager,
+                                                  portMapper, false));
+    std::unique_ptr<FlowStack> incr(new FlowStack(agent, tunnelEpManager,
+                                                  portMapper, true));
+    vector<size_t> changeCounts;
+    Result fr = run(agent, *full, p, eps, rounds, changeCounts);
+    Result ir = run(agent, *incr, p, eps, rounds, changeCounts);
+
+    agent.stop();
+    incr.reset();
+    full.reset();
+
+    std::cout << "{\"benchmark\": \"endpoint_churn\", "
+              << "\"endpoints\": " << endpoints << ", "
+              << "\"ips\": " << ips << ", "
+              << "\"mappings\": " << mappings << ", "
+              << "\"updates\": " << (size_t)rounds * endpoints << ", "
+              << "\"changes\": {";
+    for (int c = 0; c < N_CHANGES; ++c)
+        std::cout << (c ? ", " : "") << "\"" << CHANGE_NAMES[c] << "\": "
+                  << changeCounts[c];
+    std::cout << "}, "
+              << "\"full\": {\"cpu_us_per_update\": " << fr.cpuUsPerUpdate
+              << ", \"wall_us_per_update\": " << fr.wallUsPerUpdate << "}, "
+              << "\"incremental\": {\"cpu_us_per_update\": "
+              << ir.cpuUsPerUpdate
+              << ", \"wall_us_per_update\": " << ir.wallUsPerUpdate << "}}"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,286 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the memory and lookup cost of the endpoint manager
+ * secondary indexes
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/EndpointIndex.h>
+
+#include <boost/program_options.hpp>
+
+#include <malloc.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using std::string;
+using std::vector;
+using opflexagent::EndpointIndex;
+using opflexagent::EndpointHandleTable;
+using opflexagent::EndpointUUIDView;
+namespace po = boost::program_options;
+
+/*
+ * Builds the indexes the endpoint manager keeps for local endpoints
+ * (endpoint group, security group set, interface, access interface
+ * and endpoint group mapping alias) in two ways:
+ *
+ * sets: a map from each key to an unordered_set of UUID strings, as
+ *   the endpoint manager used to, where lookups copy the set.
+ * handles: EndpointIndex over a shared EndpointHandleTable, where
+ *   lookups return a view.
+ *
+ * It reports the heap memory used by the indexes, then runs reader
+ * threads that look up and walk the endpoints of random groups while
+ * a writer moves endpoints between groups, all under one mutex as in
+ * the endpoint manager.
+ */
+
+static std::atomic<int64_t> heapBytes(0);
+
+// count the heap memory in use; not inlined, so that the compiler
+// sees matching allocation functions
+__attribute__((noinline)) void* operator new(size_t size) {
+    void* p = malloc(size);
+    if (!p) throw std::bad_alloc();
+    heapBytes.fetch_add(malloc_usable_size(p), std::memory_order_relaxed);
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    if (!p) return;
+    heapBytes.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+    free(p);
+}
+
+static string uuidFor(uint32_t i) {
+    static const char* hex = "0123456789abcdef";
+    std::mt19937 rng(i);
+    string u(36, '-');
+    for (size_t c = 0; c < u.size(); ++c) {
+        if (c != 8 && c != 13 && c != 18 && c != 23)
+            u[c] = hex[rng() % 16];
+    }
+    return u;
+}
+
+struct Ep {
+    string uuid;
+    string group;
+    string secGroups;
+    string iface;
+    string access;
+    string alias;
+};
+
+typedef std::unordered_set<string> str_uset_t;
+typedef std::unordered_map<string, str_uset_t> set_map_t;
+
+struct SetIndexes {
+    set_map_t group, secGroups, iface, access, alias;
+
+    void add(const Ep& ep) {
+        group[ep.group].insert(ep.uuid);
+        secGroups[ep.secGroups].insert(ep.uuid);
+        iface[ep.iface].insert(ep.uuid);
+        access[ep.access].insert(ep.uuid);
+        alias[ep.alias].insert(ep.uuid);
+    }
+    void move(const Ep& ep, const string& oldGroup) {
+        str_uset_t& eps = group[oldGroup];
+        eps.erase(ep.uuid);
+        if (eps.empty())
+            group.erase(oldGroup);
+        group[ep.group].insert(ep.uuid);
+    }
+    size_t lookup(const string& g, std::mutex& mtx) {
+        str_uset_t eps;
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            auto it = group.find(g);
+            if (it != group.end())
+                eps.insert(it->second.begin(), it->second.end());
+        }
+        size_t n = 0;
+        for (const string& uuid : eps)
+            n += uuid.size();
+        return n;
+    }
+};
+
+struct HandleIndexes {
+    EndpointHandleTable handles;
+    EndpointIndex<string> group, secGroups, iface, access, alias;
+
+    HandleIndexes()
+        : group(handles), secGroups(handles), iface(handles),
+          access(handles), alias(handles) {}
+
+    void add(const Ep& ep) {
+        group.insert(ep.group, ep.uuid);
+        secGroups.insert(ep.secGroups, ep.uuid);
+        iface.insert(ep.iface, ep.uuid);
+        access.insert(ep.access, ep.uuid);
+        alias.insert(ep.alias, ep.uuid);
+    }
+    void move(const Ep& ep, const string& oldGroup) {
+        group.erase(oldGroup, ep.uuid);
+        group.insert(ep.group, ep.uuid);
+    }
+    size_t lookup(const string& g, std::mutex& mtx) {
+        EndpointUUIDView eps;
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            eps = group.get(g);
+        }
+        size_t n = 0;
+        for (const string& uuid : eps)
+            n += uuid.size();
+        return n;
+    }
+};
+
+struct Result {
+    int64_t bytes;
+    double lookupsPerSec;
+    double movesPerSec;
+};
+
+template <typename I>
+static Result run(vector<Ep> eps, uint32_t groups, uint32_t threads,
+                  uint32_t durationMs) {
+    Result r{0, 0, 0};
+    int64_t before = heapBytes.load();
+    I* idx = new I();
+    for (const Ep& ep : eps)
+        idx->add(ep);
+    r.bytes = heapBytes.load() - before - (int64_t)sizeof(I);
+
+    std::mutex mtx;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> lookups(0), sink(0);
+    size_t moves = 0;
+    vector<std::thread> readers;
+    for (uint32_t t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t]() {
+                std::mt19937 rng(t);
+                size_t n = 0, s = 0;
+                while (!done.load(std::memory_order_relaxed)) {
+                    s += idx->lookup("epg" + std::to_string(rng() % groups),
+                                     mtx);
+                    n += 1;
+                }
+                lookups += n;
+                sink += s;
+            });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::milliseconds(durationMs);
+    std::mt19937 rng(42);
+    while (std::chrono::steady_clock::now() < end) {
+        Ep& ep = eps[rng() % eps.size()];
+        string old = ep.group;
+        ep.group = "epg" + std::to_string(rng() % groups);
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            idx->move(ep, old);
+        }
+        moves += 1;
+        std::this_thread::yield();
+    }
+    done = true;
+    for (std::thread& t : readers)
+        t.join();
+    double secs = std::chrono::duration<double>
+        (std::chrono::steady_clock::now() - start).count();
+    r.lookupsPerSec = lookups / secs;
+    r.movesPerSec = moves / secs;
+    delete idx;
+    return r;
+}
+
+static void print(const char* name, const Result& r, uint32_t endpoints) {
+    std::cout << "\"" << name << "\": {\"bytes\": " << r.bytes
+              << ", \"bytes_per_endpoint\": " << r.bytes / endpoints
+              << ", \"lookups_per_sec\": " << r.lookupsPerSec
+              << ", \"moves_per_sec\": " << r.movesPerSec << "}";
+}
+
+int main(int argc, char** argv) {
+    uint32_t endpoints, groups, secGroupSets, threads, durationMs;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("endpoints", po::value<uint32_t>(&endpoints)->default_value(20000),
+         "Number of endpoints")
+        ("groups", po::value<uint32_t>(&groups)->default_value(50),
+         "Number of endpoint groups")
+        ("secgrp-sets",
+         po::value<uint32_t>(&secGroupSets)->default_value(20),
+         "Number of distinct security group sets")
+        ("threads", po::value<uint32_t>(&threads)->default_value(4),
+         "Number of reader threads")
+        ("duration", po::value<uint32_t>(&durationMs)->default_value(2000),
+         "Duration of the lookup phase in milliseconds")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (endpoints == 0 || groups == 0 || secGroupSets == 0) {
+        std::cerr << "Need at least one endpoint, group and security "
+                  << "group set" << std::endl;
+        return 1;
+    }
+
+    vector<Ep> eps;
+    for (uint32_t i = 0; i < endpoints; ++i) {
+        string n = std::to_string(i);
+        eps.push_back(Ep{uuidFor(i), "epg" + std::to_string(i % groups),
+                         "sgset" + std::to_string(i % secGroupSets),
+                         "veth" + n, "tap" + n,
+                         "alias" + std::to_string(i % 4)});
+    }
+
+    Result sets = run<SetIndexes>(eps, groups, threads, durationMs);
+    Result handles = run<HandleIndexes>(eps, groups, threads, durationMs);
+
+    std::cout << "{\"benchmark\": \"endpoint_index\", "
+              << "\"endpoints\": " << endpoints << ", "
+              << "\"groups\": " << groups << ", "
+              << "\"threads\": " << threads << ", ";
+    print("sets", sets, endpoints);
+    std::cout << ", ";
+    print("handles", handles, endpoints);
+    std::cout << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,288 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the integration bridge flow manager handling of
+ * endpoint updates against load balanced services
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "BenchUtil.h"
+#include "IntFlowManager.h"
+#include "FlowReader.h"
+#include "CtZoneManager.h"
+#include "ovs-ofputil.h"
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/EndpointSource.h>
+#include <opflexagent/IdGenerator.h>
+#include <opflexagent/PolicyManager.h>
+#include <opflexagent/ServiceSource.h>
+#include <opflexagent/TunnelEpManager.h>
+#include <opflexagent/logging.h>
+
+#include <modelgbp/dmtree/Root.hpp>
+#include <opflex/ofcore/OFFramework.h>
+#include <opflex/modb/Mutator.h>
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using opflex::modb::URI;
+using opflex::modb::MAC;
+using opflex::modb::Mutator;
+using opflexagent::Agent;
+using opflexagent::Endpoint;
+using opflexagent::Service;
+using opflexagent::IntFlowManager;
+using namespace opflexagent::bench;
+namespace po = boost::program_options;
+
+/*
+ * Measures the endpoint updates of a node running load balanced
+ * services.  Each update moves the endpoint to a new set of IPv4 and
+ * IPv6 addresses, so the flow manager rewrites the endpoint's source,
+ * bridge, route and proxy ARP/ND flows and matches each of its
+ * addresses against the service IP and next hops of every service
+ * mapping for the pod to service stats flows.
+ *
+ * The endpoints go through the endpoint manager and the flow manager
+ * handles them in IntFlowManager::handleEndpointUpdate on the agent IO
+ * thread.  The CPU time of that thread and the flow edits sent to the
+ * switch are reported per update.
+ */
+
+static URI createPolicy(opflex::ofcore::OFFramework& framework,
+                        URI& rdURI) {
+    using namespace modelgbp;
+    using namespace modelgbp::gbp;
+    using namespace modelgbp::gbpe;
+
+    Mutator mutator(framework, "policyreg");
+    shared_ptr<policy::Universe> universe =
+        policy::Universe::resolve(framework).get();
+    shared_ptr<policy::Space> space = universe->addPolicySpace("bench");
+
+    shared_ptr<RoutingDomain> rd = space->addGbpRoutingDomain("rd");
+    rd->addGbpeInstContext()->setEncapId(1);
+    shared_ptr<BridgeDomain> bd = space->addGbpBridgeDomain("bd");
+    bd->addGbpeInstContext()->setEncapId(10);
+    bd->addGbpBridgeDomainToNetworkRSrc()
+        ->setTargetRoutingDomain(rd->getURI());
+    shared_ptr<FloodDomain> fd = space->addGbpFloodDomain("fd");
+    fd->addGbpFloodDomainToNetworkRSrc()
+        ->setTargetBridgeDomain(bd->getURI());
+    shared_ptr<Subnets> subnets = space->addGbpSubnets("subnets");
+    subnets->addGbpSubnet("subnet4")
+        ->setAddress("10.0.0.0").setPrefixLen(8);
+    subnets->addGbpSubnet("subnet6")
+        ->setAddress("fd00:10::").setPrefixLen(32);
+    bd->addGbpForwardingBehavioralGroupToSubnetsRSrc()
+        ->setTargetSubnets(subnets->getURI());
+
+    shared_ptr<EpGroup> epg = space->addGbpEpGroup("epg");
+    epg->addGbpEpGroupToNetworkRSrc()
+        ->setTargetFloodDomain(fd->getURI());
+    epg->addGbpeInstContext()->setEncapId(1000).setClassid(1000);
+    mutator.commit();
+
+    rdURI = rd->getURI();
+    return epg->getURI();
+}
+
+// The addresses of an endpoint in a round; alternating IPv4 and IPv6
+static std::unordered_set<string> epIps(uint32_t ep, uint32_t ips,
+                                        uint32_t round) {
+    std::unordered_set<string> result;
+    for (uint32_t j = 0; j < ips; ++j) {
+        uint32_t n = (round % 2) * 0x800000 + ep * ips + j + 1;
+        if (j % 2 == 0) {
+            result.insert("10." + std::to_string(n >> 16) + "." +
+                          std::to_string((n >> 8) & 0xff) + "." +
+                          std::to_string(n & 0xff));
+        } else {
+            std::stringstream ip;
+            ip << "fd00:10::" << std::hex << (n >> 16) << ":"
+               << (n & 0xffff);
+            result.insert(ip.str());
+        }
+    }
+    return result;
+}
+
+static Service createService(const URI& rdURI, uint32_t s,
+                             uint32_t nextHops) {
+    Service as;
+    as.setUUID("svc-" + std::to_string(s));
+    as.setDomainURI(rdURI);
+    as.setServiceMode(Service::LOADBALANCER);
+
+    Service::ServiceMapping sm;
+    if (s % 2 == 0)
+        sm.setServiceIP("172.30." + std::to_string(s / 256) + "." +
+                        std::to_string(s % 256));
+    else
+        sm.setServiceIP("fd00:ffff::" + std::to_string(s % 10000));
+    sm.setServiceProto("tcp");
+    sm.setServicePort(80);
+    sm.setNextHopPort(8080);
+    for (uint32_t n = 0; n < nextHops; ++n)
+        sm.addNextHopIP("10.200." + std::to_string(s % 256) + "." +
+                        std::to_string(n % 256));
+    as.addServiceMapping(sm);
+    return as;
+}
+
+int main(int argc, char** argv) {
+    uint32_t endpoints, ips, services, nextHops, rounds;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("endpoints", po::value<uint32_t>(&endpoints)->default_value(100),
+         "Number of local endpoints")
+        ("ips", po::value<uint32_t>(&ips)->default_value(2),
+         "Number of IPs per endpoint, alternating IPv4 and IPv6")
+        ("services", po::value<uint32_t>(&services)->default_value(50),
+         "Number of load balanced services, alternating IPv4 and IPv6")
+        ("next-hops", po::value<uint32_t>(&nextHops)->default_value(4),
+         "Number of next hops of each service")
+        ("rounds", po::value<uint32_t>(&rounds)->default_value(20),
+         "Number of update rounds over all the endpoints")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (endpoints == 0 || ips == 0 || rounds == 0) {
+        std::cerr << "Need at least one endpoint, IP and round"
+                  << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "endpoint-ip-bench");
+
+    opflex::ofcore::OFFramework framework;
+    Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    URI rdURI("/");
+    URI epg = createPolicy(framework, rdURI);
+    opflexagent::PolicyManager& pm = agent.getPolicyManager();
+    for (int i = 0; i < 10000; ++i) {
+        if (pm.getSnapshot()->getGroup(epg))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    BenchPortMapper portMapper;
+    portMapper.ports["vxlan0"] = 2048;
+    opflexagent::TunnelEpManager tunnelEpManager(&agent);
+    opflexagent::IdGenerator idGen;
+    opflexagent::CtZoneManager ctZoneManager(idGen);
+    ctZoneManager.setCtZoneRange(1, 65534);
+    ctZoneManager.init("conntrack");
+    CountingFlowExecutor executor;
+    opflexagent::FlowReader reader;
+    BenchSwitchManager switchManager(agent, executor, reader, portMapper);
+    IntFlowManager intFlowManager(agent, switchManager, idGen,
+                                  ctZoneManager, tunnelEpManager);
+    intFlowManager.setEncapType(IntFlowManager::ENCAP_VXLAN);
+    intFlowManager.setEncapIface("vxlan0");
+    intFlowManager.setVirtualRouter(true, false, "00:22:bd:f8:19:ff");
+    switchManager.start("bench");
+    intFlowManager.start();
+    intFlowManager.registerModbListeners();
+    intFlowManager.egDomainUpdated(epg);
+    intFlowManager.domainUpdated(modelgbp::gbp::RoutingDomain::CLASS_ID,
+                                 rdURI);
+
+    // the flow manager is registered with the service and endpoint
+    // managers, so the sources alone drive it
+    opflexagent::ServiceSource svcSrc(&agent.getServiceManager());
+    for (uint32_t s = 0; s < services; ++s)
+        svcSrc.updateService(createService(rdURI, s, nextHops));
+
+    opflexagent::EndpointSource epSrc(&agent.getEndpointManager());
+    vector<Endpoint> eps;
+    for (uint32_t i = 0; i < endpoints; ++i) {
+        string n = std::to_string(i);
+        Endpoint ep("ep-" + n);
+        ep.setInterfaceName("veth" + n);
+        portMapper.ports["veth" + n] = 100 + i;
+        uint8_t mac[6] = {0x02, 0, 0, (uint8_t)(i >> 16),
+                          (uint8_t)(i >> 8), (uint8_t)i};
+        ep.setMAC(MAC(mac));
+        ep.setEgURI(epg);
+        ep.setIPs(epIps(i, ips, 0));
+        epSrc.updateEndpoint(ep);
+        eps.push_back(ep);
+    }
+    // initial flows are not measured
+    drain(agent);
+
+    size_t executes0, edits0;
+    executor.getCounts(executes0, edits0);
+    clockid_t clock = getIOThreadClock(agent);
+    double cpuStart = cpuUs(clock);
+    auto wallStart = std::chrono::steady_clock::now();
+    for (uint32_t r = 1; r <= rounds; ++r) {
+        // the task queue coalesces updates to the same endpoint, so
+        // each endpoint changes once per round
+        for (uint32_t i = 0; i < endpoints; ++i) {
+            eps[i].setIPs(epIps(i, ips, r));
+            epSrc.updateEndpoint(eps[i]);
+        }
+        drain(agent);
+    }
+    double cpu = cpuUs(clock) - cpuStart;
+    double wall = std::chrono::duration<double, std::micro>
+        (std::chrono::steady_clock::now() - wallStart).count();
+    size_t executes, edits;
+    executor.getCounts(executes, edits);
+    executes -= executes0;
+    edits -= edits0;
+
+    agent.stop();
+    intFlowManager.stop();
+    switchManager.stop();
+
+    size_t updates = (size_t)rounds * endpoints;
+    std::cout << "{\"benchmark\": \"endpoint_ip\", "
+              << "\"endpoints\": " << endpoints << ", "
+              << "\"ips\": " << ips << ", "
+              << "\"services\": " << services << ", "
+              << "\"next_hops\": " << nextHops << ", "
+              << "\"updates\": " << updates << ", "
+              << "\"cpu_us_per_update\": " << cpu / updates << ", "
+              << "\"wall_us_per_update\": " << wall / updates << ", "
+              << "\"executes\": " << executes << ", "
+              << "\"edits_per_update\": " << (double)edits / updates
+              << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the CPU cost of an interface stats cycle: publishing
+ * endpoint counters to the MODB compared with writing them only to
+ * the in-process counter registry
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/EndpointManager.h>
+#include <opflexagent/EndpointSource.h>
+#include <opflexagent/logging.h>
+
+#include <opflex/ofcore/OFFramework.h>
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::chrono::steady_clock;
+using opflexagent::EndpointManager;
+namespace po = boost::program_options;
+
+class BenchEndpointSource : public opflexagent::EndpointSource {
+public:
+    BenchEndpointSource(EndpointManager* manager)
+        : EndpointSource(manager) {}
+    virtual ~BenchEndpointSource() {}
+};
+
+static double cpuMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+struct Result {
+    double wallMs;
+    double cpuMs;
+};
+
+/*
+ * Run the given number of stats cycles, each updating the counters
+ * of every endpoint the way InterfaceStatsManager does.  Process CPU
+ * time includes the MODB notification threads woken by the updates.
+ */
+static Result run(EndpointManager& epMgr, const vector<string>& uuids,
+                  uint32_t cycles, uint64_t& counter) {
+    double cpuStart = cpuMs();
+    auto start = steady_clock::now();
+    for (uint32_t c = 0; c < cycles; ++c) {
+        for (const string& uuid : uuids) {
+            EndpointManager::EpCounters counters{};
+            uint64_t v = ++counter;
+            counters.txPackets = v;
+            counters.rxPackets = v;
+            counters.txBytes = v * 1500;
+            counters.rxBytes = v * 1500;
+            epMgr.updateEndpointCounters(uuid, counters);
+        }
+    }
+    double wall = std::chrono::duration<double, std::milli>
+        (steady_clock::now() - start).count();
+    return {wall / cycles, (cpuMs() - cpuStart) / cycles};
+}
+
+int main(int argc, char** argv) {
+    uint32_t endpoints, cycles;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("endpoints", po::value<uint32_t>(&endpoints)->default_value(10000),
+         "Number of local endpoints")
+        ("cycles", po::value<uint32_t>(&cycles)->default_value(5),
+         "Number of stats cycles to average over")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "ep-stats-bench");
+
+    opflex::ofcore::OFFramework framework;
+    opflexagent::Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    EndpointManager& epMgr = agent.getEndpointManager();
+    BenchEndpointSource source(&epMgr);
+    vector<string> uuids;
+    for (uint32_t i = 0; i < endpoints; ++i) {
+        string uuid = "ep-" + std::to_string(i);
+        opflexagent::Endpoint ep(uuid);
+        ep.setInterfaceName("veth" + std::to_string(i));
+        ep.setAccessInterface("access" + std::to_string(i));
+        source.updateEndpoint(ep);
+        uuids.push_back(uuid);
+    }
+
+    uint64_t counter = 0;
+    // the first cycle creates the counter objects and registry rows
+    epMgr.setCounterPublishInterval(0);
+    run(epMgr, uuids, 1, counter);
+    Result modb = run(epMgr, uuids, cycles, counter);
+
+    epMgr.setCounterPublishInterval(-1);
+    Result registry = run(epMgr, uuids, cycles, counter);
+
+    agent.stop();
+
+    std::cout << "{\"benchmark\": \"ep_stats\", "
+              << "\"endpoints\": " << endpoints << ", "
+              << "\"cycles\": " << cycles << ", "
+              << "\"modb\": {\"cycle_wall_ms\": " << modb.wallMs
+              << ", \"cycle_cpu_ms\": " << modb.cpuMs << "}, "
+              << "\"registry\": {\"cycle_wall_ms\": " << registry.wallMs
+              << ", \"cycle_cpu_ms\": " << registry.cpuMs << "}}"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,244 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the rate of flow writes to a simulated switch, with
+ * and without batching of flow edits across tasks
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "BenchUtil.h"
+#include "FlowBuilder.h"
+#include "FlowExecutor.h"
+#include "FlowReader.h"
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/TaskQueue.h>
+#include <opflexagent/logging.h>
+
+#include <opflex/ofcore/OFFramework.h>
+
+#include <boost/program_options.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using std::string;
+using opflexagent::Agent;
+using opflexagent::FlowBuilder;
+using opflexagent::FlowEdit;
+using opflexagent::FlowEntryList;
+using namespace opflexagent::bench;
+namespace po = boost::program_options;
+
+/*
+ * Simulates the flow churn of endpoint or service updates: a burst of
+ * small tasks on the agent task queue, each writing a few flows to a
+ * few tables.  The switch applies each barrier-terminated write in a
+ * fixed round trip time plus a time per flow edit.
+ *
+ * The flows per second written to the switch and the number of
+ * barriers are reported with batching disabled, where each write is
+ * sent with its own barrier, and with batching across tasks.
+ */
+
+// Stands in for the switch, taking the configured time to apply a
+// write before acknowledging it
+class SimulatedFlowExecutor : public opflexagent::FlowExecutor {
+public:
+    SimulatedFlowExecutor(long rttUs_, double editUs_)
+        : rttUs(rttUs_), editUs(editUs_), executes(0), edits(0) {}
+
+    virtual bool Execute(const FlowEdit& fe) {
+        if (fe.edits.empty())
+            return true;
+        std::this_thread::sleep_for(std::chrono::microseconds
+                                    ((long)(rttUs + editUs *
+                                            fe.edits.size())));
+        std::lock_guard<std::mutex> guard(mutex);
+        executes += 1;
+        edits += fe.edits.size();
+        cond.notify_all();
+        return true;
+    }
+
+    virtual bool Execute(const opflexagent::GroupEdit&) { return true; }
+    virtual bool Execute(const opflexagent::TlvEdit&) { return true; }
+
+    void getCounts(size_t& executes_, size_t& edits_) {
+        std::lock_guard<std::mutex> guard(mutex);
+        executes_ = executes;
+        edits_ = edits;
+    }
+
+    bool waitForEdits(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cond.wait_for(lock, std::chrono::seconds(300),
+                             [&]() { return edits >= count; });
+    }
+
+private:
+    long rttUs;
+    double editUs;
+    std::mutex mutex;
+    std::condition_variable cond;
+    size_t executes;
+    size_t edits;
+};
+
+struct Result {
+    double ms;
+    size_t executes;
+    size_t edits;
+};
+
+/*
+ * Dispatch `tasks` tasks that each write `flows` flows to each of
+ * `tables` tables, and wait for all the edits to reach the switch.
+ * Each round writes flows that differ from the last round's, so every
+ * flow is modified.
+ */
+static bool run(Agent& agent, opflexagent::SwitchManager& switchManager,
+                SimulatedFlowExecutor& executor, uint32_t tasks,
+                uint32_t tables, uint32_t flows, uint32_t round,
+                Result& result) {
+    opflexagent::TaskQueue taskQueue(agent.getAgentIOService());
+
+    size_t executes0, edits0;
+    executor.getCounts(executes0, edits0);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < tasks; ++t) {
+        string id = "task-" + std::to_string(t);
+        taskQueue.dispatch(id, [=, &switchManager]() {
+                for (uint32_t table = 0; table < tables; ++table) {
+                    FlowEntryList el;
+                    for (uint32_t f = 0; f < flows; ++f) {
+                        uint8_t mac[6] = {0x02, (uint8_t)f, 0,
+                                          (uint8_t)(t >> 16),
+                                          (uint8_t)(t >> 8), (uint8_t)t};
+                        FlowBuilder().priority(10)
+                            .ethDst(mac)
+                            .action().output(round).parent()
+                            .build(el);
+                    }
+                    switchManager.writeFlow(id, table, el);
+                }
+            });
+    }
+    // modifying a flow is a single edit
+    bool ok = executor.waitForEdits(edits0 + (size_t)tasks * tables * flows);
+    result.ms = std::chrono::duration<double, std::milli>
+        (std::chrono::steady_clock::now() - start).count();
+    executor.getCounts(result.executes, result.edits);
+    result.executes -= executes0;
+    result.edits -= edits0;
+    return ok;
+}
+
+static void printResult(const char* name, const Result& r) {
+    std::cout << "\"" << name << "\": {\"ms\": " << r.ms
+              << ", \"flows_per_sec\": " << r.edits / (r.ms / 1000)
+              << ", \"barriers\": " << r.executes
+              << ", \"edits\": " << r.edits << "}";
+}
+
+int main(int argc, char** argv) {
+    uint32_t tasks, tables, flows, maxEdits;
+    long rttUs, maxDelay;
+    double editUs;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("tasks", po::value<uint32_t>(&tasks)->default_value(2000),
+         "Number of tasks in the burst")
+        ("tables", po::value<uint32_t>(&tables)->default_value(3),
+         "Number of tables each task writes")
+        ("flows", po::value<uint32_t>(&flows)->default_value(2),
+         "Number of flows each task writes to each table")
+        ("rtt-us", po::value<long>(&rttUs)->default_value(200),
+         "Simulated switch round trip time per barrier in microseconds")
+        ("edit-us", po::value<double>(&editUs)->default_value(2),
+         "Simulated switch time per flow edit in microseconds")
+        ("max-edits", po::value<uint32_t>(&maxEdits)->
+         default_value(opflexagent::SwitchManager::
+                       DEFAULT_FLOW_BATCH_MAX_EDITS),
+         "Largest number of flow edits in a batch")
+        ("max-delay", po::value<long>(&maxDelay)->
+         default_value(opflexagent::SwitchManager::
+                       DEFAULT_FLOW_BATCH_MAX_DELAY),
+         "Longest time in milliseconds a flow edit waits in a batch")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (tasks == 0 || tables == 0 || flows == 0 || maxEdits == 0) {
+        std::cerr << "Need at least one task, table, flow and edit"
+                  << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "flow-batch-bench");
+
+    opflex::ofcore::OFFramework framework;
+    Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    BenchPortMapper portMapper;
+    SimulatedFlowExecutor executor(rttUs, editUs);
+    opflexagent::FlowReader reader;
+    BenchSwitchManager switchManager(agent, executor, reader, portMapper);
+    switchManager.setMaxFlowTables(tables);
+    switchManager.start("bench");
+
+    // the first round adds the flows, and is not measured
+    Result ur, br;
+    bool ok = run(agent, switchManager, executor, tasks, tables, flows,
+                  1, ur) &&
+        run(agent, switchManager, executor, tasks, tables, flows, 2, ur);
+    switchManager.setFlowBatching(maxEdits, maxDelay);
+    ok = ok &&
+        run(agent, switchManager, executor, tasks, tables, flows, 3, br);
+
+    switchManager.stop();
+    agent.stop();
+
+    if (!ok) {
+        std::cerr << "flows were not written" << std::endl;
+        return 1;
+    }
+
+    std::cout << "{\"benchmark\": \"flow_batch\", "
+              << "\"tasks\": " << tasks << ", "
+              << "\"tables\": " << tables << ", "
+              << "\"flows\": " << flows << ", "
+              << "\"rtt_us\": " << rttUs << ", "
+              << "\"edit_us\": " << editUs << ", "
+              << "\"max_edits\": " << maxEdits << ", "
+              << "\"max_delay\": " << maxDelay << ", ";
+    printResult("unbatched", ur);
+    std::cout << ", ";
+    printResult("batched", br);
+    std::cout << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,188 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for packet-in handling latency while the same switch
+ * connection is delivering large stats replies
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "SwitchConnection.h"
+#include "ovs-ofputil.h"
+
+#include <opflexagent/logging.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <openvswitch/ofp-msgs.h>
+}
+
+using std::vector;
+using std::chrono::steady_clock;
+using opflexagent::SwitchConnection;
+using opflexagent::MessageHandler;
+using opflexagent::MessageExecutor;
+namespace po = boost::program_options;
+
+typedef std::chrono::duration<double, std::micro> micros;
+
+/*
+ * Each message carries its index into the arrival schedule, so the
+ * handlers can tell how long it waited
+ */
+static OfpBuf makeMessage(uint32_t seq) {
+    OfpBuf msg(64);
+    *(uint32_t*)msg.put_zeros(sizeof(seq)) = seq;
+    return msg;
+}
+
+static uint32_t getSeq(ofpbuf* msg) {
+    return *(uint32_t*)msg->data;
+}
+
+class PacketInHandler : public MessageHandler {
+public:
+    PacketInHandler(const vector<steady_clock::time_point>& arrivals_)
+        : arrivals(arrivals_) {}
+
+    void Handle(SwitchConnection*, int, ofpbuf* msg,
+                struct ofputil_flow_removed*) {
+        latencyUs.push_back(micros(steady_clock::now() -
+                                   arrivals[getSeq(msg)]).count());
+    }
+
+    const vector<steady_clock::time_point>& arrivals;
+    vector<double> latencyUs;
+};
+
+/*
+ * Stands in for decoding a large flow stats reply, which costs
+ * roughly the same CPU time whichever thread it runs on
+ */
+class StatsHandler : public MessageHandler {
+public:
+    StatsHandler(uint64_t decodeUs_, bool offload)
+        : decodeUs(decodeUs_), executor("bench stats"), handled(0) {
+        if (offload)
+            executor.start();
+    }
+
+    void Handle(SwitchConnection*, int, ofpbuf*,
+                struct ofputil_flow_removed*) {
+        auto end = steady_clock::now() + std::chrono::microseconds(decodeUs);
+        while (steady_clock::now() < end) {}
+        ++handled;
+    }
+
+    MessageExecutor* GetExecutor(int) { return &executor; }
+
+    uint64_t decodeUs;
+    MessageExecutor executor;
+    std::atomic<uint64_t> handled;
+};
+
+static double percentile(vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)(p / 100 * (v.size() - 1) + 0.5);
+    return v[std::min(rank, v.size() - 1)];
+}
+
+/*
+ * Play a schedule of packet-ins at a steady rate with a stats reply
+ * every statsEvery packet-ins through the connection's dispatch path,
+ * as the connection thread would on receiving them
+ */
+static void run(bool offload, uint32_t packetIns, uint64_t intervalUs,
+                uint32_t statsEvery, uint64_t decodeUs) {
+    SwitchConnection conn("bench");
+    vector<steady_clock::time_point> arrivals;
+    vector<int> types;
+    auto start = steady_clock::now() + std::chrono::milliseconds(10);
+    for (uint32_t i = 0; i < packetIns; ++i) {
+        auto at = start + std::chrono::microseconds(i * intervalUs);
+        if (statsEvery && i % statsEvery == 0) {
+            arrivals.push_back(at);
+            types.push_back(OFPTYPE_FLOW_STATS_REPLY);
+        }
+        arrivals.push_back(at);
+        types.push_back(OFPTYPE_PACKET_IN);
+    }
+
+    PacketInHandler pin(arrivals);
+    StatsHandler stats(decodeUs, offload);
+    pin.latencyUs.reserve(packetIns);
+    conn.RegisterMessageHandler(OFPTYPE_PACKET_IN, &pin);
+    conn.RegisterMessageHandler(OFPTYPE_FLOW_STATS_REPLY, &stats);
+
+    for (size_t i = 0; i < arrivals.size(); ++i) {
+        std::this_thread::sleep_until(arrivals[i]);
+        OfpBuf msg(makeMessage(i));
+        conn.DispatchMessage(types[i], msg.get(), NULL);
+    }
+    size_t statsReplies = arrivals.size() - packetIns;
+    while (stats.handled < statsReplies)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    stats.executor.stop();
+
+    std::cout << "{\"benchmark\": \"of_dispatch\", "
+              << "\"mode\": \"" << (offload ? "executor" : "inline")
+              << "\", "
+              << "\"packet_ins\": " << packetIns << ", "
+              << "\"stats_replies\": " << statsReplies << ", "
+              << "\"decode_us\": " << decodeUs << ", "
+              << "\"packet_in_us_p50\": " << percentile(pin.latencyUs, 50)
+              << ", \"packet_in_us_p99\": " << percentile(pin.latencyUs, 99)
+              << ", \"packet_in_us_max\": " << percentile(pin.latencyUs, 100)
+              << "}" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    uint32_t packetIns, statsEvery;
+    uint64_t intervalUs, decodeUs;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("packet-ins", po::value<uint32_t>(&packetIns)->default_value(5000),
+         "Number of packet-ins to deliver")
+        ("interval", po::value<uint64_t>(&intervalUs)->default_value(200),
+         "Microseconds between packet-ins")
+        ("stats-every", po::value<uint32_t>(&statsEvery)->default_value(250),
+         "Deliver a stats reply before every this many packet-ins")
+        ("decode", po::value<uint64_t>(&decodeUs)->default_value(20000),
+         "Microseconds of CPU time to decode each stats reply")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "of-dispatch-bench");
+
+    run(false, packetIns, intervalUs, statsEvery, decodeUs);
+    run(true, packetIns, intervalUs, statsEvery, decodeUs);
+    return 0;
+}
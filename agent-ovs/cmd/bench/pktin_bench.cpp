@@ -0,0 +1,357 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for DHCP packet-in throughput during a boot storm
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "PacketInCache.h"
+#include "Packets.h"
+#include "SwitchConnection.h"
+#include "dhcp.h"
+#include "ovs-ofpbuf.h"
+
+#include <opflexagent/Endpoint.h>
+#include <opflexagent/KeyedRateLimiter.h>
+#include <opflexagent/logging.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using std::chrono::steady_clock;
+using boost::asio::ip::address_v4;
+using opflex::modb::MAC;
+using opflexagent::Endpoint;
+using opflexagent::MessageExecutor;
+using opflexagent::PacketInCache;
+namespace po = boost::program_options;
+namespace packets = opflexagent::packets;
+namespace dhcp = opflexagent::dhcp;
+
+typedef std::chrono::duration<double, std::micro> micros;
+
+static const uint8_t SERVER_MAC[6] = {0x00, 0x22, 0xbd, 0xf8, 0x19, 0xff};
+
+/*
+ * Stands in for the endpoint manager: the endpoints on each
+ * interface, behind a lock, looked up the way findEpsForIface does
+ */
+struct Directory {
+    std::mutex mtx;
+    std::unordered_map<string, std::unordered_set<string> > ifaceEps;
+    std::unordered_map<string, shared_ptr<const Endpoint> > eps;
+
+    shared_ptr<const Endpoint> find(const string& iface, const MAC& mac) {
+        std::unordered_set<string> uuids;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            uuids = ifaceEps[iface];
+        }
+        for (const string& uuid : uuids) {
+            shared_ptr<const Endpoint> ep;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                ep = eps[uuid];
+            }
+            if (ep && ep->getMAC() && ep->getMAC().get() == mac)
+                return ep;
+        }
+        return shared_ptr<const Endpoint>();
+    }
+};
+
+struct Client {
+    string iface;
+    MAC mac;
+};
+
+static OfpBuf compose(const Endpoint& ep, const MAC& mac,
+                      uint8_t type, uint32_t xid) {
+    const Endpoint::DHCPv4Config& v4c = ep.getDHCPv4Config().get();
+    address_v4 ip = address_v4::from_string(v4c.getIpAddress().get());
+    uint8_t clientMac[6];
+    mac.toUIntArray(clientMac);
+    return packets::compose_dhcpv4_reply(type, xid, SERVER_MAC, clientMac,
+                                         ip.to_ulong(),
+                                         v4c.getPrefixLen().get_value_or(32),
+                                         v4c.getServerIp(),
+                                         v4c.getRouters(),
+                                         v4c.getDnsServers(),
+                                         v4c.getDomain(),
+                                         v4c.getStaticRoutes(),
+                                         v4c.getInterfaceMtu(),
+                                         v4c.getLeaseTime());
+}
+
+// resolve the endpoint and encode the whole reply for each request
+static size_t answerUncached(Directory& dir, const Client& c,
+                             uint8_t type, uint32_t xid) {
+    shared_ptr<const Endpoint> ep = dir.find(c.iface, c.mac);
+    OfpBuf b(compose(*ep, c.mac, type, xid));
+    return b.size();
+}
+
+// reuse the resolved endpoint and encoded reply
+static size_t answerCached(PacketInCache& cache, Directory& dir,
+                           const Client& c, uint8_t type, uint32_t xid) {
+    PacketInCache::ep_entry_ptr entry = cache.getEndpoint(c.iface, c.mac);
+    if (!entry) {
+        uint64_t generation = cache.getGeneration();
+        auto e = std::make_shared<PacketInCache::EndpointEntry>();
+        e->ep = dir.find(c.iface, c.mac);
+        OfpBuf b(compose(*e->ep, c.mac, dhcp::message_type::OFFER, 0));
+        e->dhcpv4Reply.assign((uint8_t*)b.data(),
+                              (uint8_t*)b.data() + b.size());
+        entry = e;
+        cache.putEndpoint(c.iface, c.mac, entry, generation);
+    }
+    OfpBuf b(ofpbuf_clone_data(entry->dhcpv4Reply.data(),
+                               entry->dhcpv4Reply.size()));
+    packets::patch_dhcpv4_reply((uint8_t*)b.data(), b.size(), type, xid);
+    return b.size();
+}
+
+struct StormResult {
+    uint64_t goodSent;
+    uint64_t goodAnswered;
+    uint64_t stormAnswered;
+    uint64_t dropped;
+    double goodP50Us;
+    double goodP99Us;
+};
+
+/*
+ * Offer packet-ins at a fixed rate, most of them from a few storming
+ * ports, and measure how the well-behaved ports are served
+ */
+static StormResult storm(const vector<Client>& clients,
+                         const vector<uint32_t>& schedule,
+                         const vector<bool>& stormPort,
+                         double offeredRate,
+                         bool protect, size_t threads, size_t queueDepth,
+                         uint32_t portRate, uint32_t portBurst,
+                         Directory& dir) {
+    PacketInCache cache;
+    MessageExecutor executor("bench packet-in", protect ? threads : 1,
+                             protect ? queueDepth : 0);
+    opflexagent::KeyedTokenBucket<uint32_t>
+        limiter(protect ? portRate : 0, portBurst);
+    executor.start();
+
+    vector<double> latency(schedule.size(), -1);
+    std::atomic<uint64_t> stormAnswered(0);
+    uint64_t limited = 0;
+
+    steady_clock::time_point start = steady_clock::now();
+    for (size_t i = 0; i < schedule.size(); ++i) {
+        steady_clock::time_point due = start +
+            std::chrono::duration_cast<steady_clock::duration>
+            (std::chrono::duration<double>(i / offeredRate));
+        while (steady_clock::now() < due) {}
+
+        uint32_t port = schedule[i];
+        if (!limiter.event(port)) {
+            limited += 1;
+            continue;
+        }
+        steady_clock::time_point arrival = steady_clock::now();
+        const Client& c = clients[port];
+        bool isStorm = stormPort[port];
+        executor.execute([&, i, arrival, isStorm]() {
+                if (protect)
+                    answerCached(cache, dir, c,
+                                 dhcp::message_type::OFFER, i);
+                else
+                    answerUncached(dir, c, dhcp::message_type::OFFER, i);
+                if (isStorm)
+                    stormAnswered += 1;
+                else
+                    latency[i] = micros(steady_clock::now() - arrival).count();
+            });
+    }
+    while (executor.getQueueDepth() > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    executor.stop();
+
+    StormResult r{0, 0, stormAnswered, limited + executor.getDropped(), 0, 0};
+    vector<double> good;
+    for (size_t i = 0; i < schedule.size(); ++i) {
+        if (stormPort[schedule[i]])
+            continue;
+        r.goodSent += 1;
+        if (latency[i] >= 0)
+            good.push_back(latency[i]);
+    }
+    r.goodAnswered = good.size();
+    std::sort(good.begin(), good.end());
+    if (!good.empty()) {
+        r.goodP50Us = good[good.size() / 2];
+        r.goodP99Us = good[std::min(good.size() - 1, good.size() * 99 / 100)];
+    }
+    return r;
+}
+
+static void print(const char* name, const StormResult& r) {
+    std::cout << "\"" << name << "\": {\"good_sent\": " << r.goodSent
+              << ", \"good_answered\": " << r.goodAnswered
+              << ", \"storm_answered\": " << r.stormAnswered
+              << ", \"dropped\": " << r.dropped
+              << ", \"good_p50_us\": " << r.goodP50Us
+              << ", \"good_p99_us\": " << r.goodP99Us << "}";
+}
+
+int main(int argc, char** argv) {
+    uint32_t ports, stormPorts, requests, portRate, portBurst;
+    size_t threads, queueDepth;
+    double stormFraction, offeredRate;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("ports", po::value<uint32_t>(&ports)->default_value(1000),
+         "Number of endpoint ports")
+        ("storm-ports", po::value<uint32_t>(&stormPorts)->default_value(10),
+         "Number of ports flooding DHCP requests")
+        ("storm-fraction",
+         po::value<double>(&stormFraction)->default_value(0.9),
+         "Fraction of requests from the flooding ports")
+        ("requests", po::value<uint32_t>(&requests)->default_value(200000),
+         "Number of requests in the storm")
+        ("offered-rate", po::value<double>(&offeredRate)->default_value(0),
+         "Requests per second offered in the storm; 0 offers twice "
+         "what one uncached thread can answer")
+        ("threads", po::value<size_t>(&threads)->default_value(2),
+         "Number of packet-in worker threads")
+        ("queue-depth", po::value<size_t>(&queueDepth)->default_value(1024),
+         "Maximum number of queued packet-ins")
+        ("port-rate", po::value<uint32_t>(&portRate)->default_value(50),
+         "Requests per second allowed per port")
+        ("port-burst", po::value<uint32_t>(&portBurst)->default_value(100),
+         "Requests allowed per port in a burst")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (ports == 0 || stormPorts > ports) {
+        std::cerr << "Need at least one port, and no more storm ports "
+                  << "than ports" << std::endl;
+        return 1;
+    }
+
+    Directory dir;
+    vector<Client> clients;
+    for (uint32_t p = 0; p < ports; ++p) {
+        string uuid = "ep-" + std::to_string(p);
+        string iface = "veth" + std::to_string(p);
+        uint8_t mac[6] = {0x02, 0x00};
+        memcpy(mac + 2, &p, 4);
+        std::shared_ptr<Endpoint> ep = std::make_shared<Endpoint>(uuid);
+        ep->setMAC(MAC(mac));
+        ep->setInterfaceName(iface);
+        Endpoint::DHCPv4Config c;
+        c.setIpAddress(address_v4(0x0a140000 + p + 2).to_string());
+        c.setPrefixLen(16);
+        c.addRouter("10.20.0.1");
+        c.addDnsServer("8.8.8.8");
+        c.addDnsServer("8.8.4.4");
+        c.setDomain("cluster.example.com");
+        c.addStaticRoute("169.254.169.254", 32, "10.20.0.1");
+        c.setInterfaceMtu(1450);
+        ep->setDHCPv4Config(c);
+        dir.eps[uuid] = ep;
+        dir.ifaceEps[iface].insert(uuid);
+        clients.push_back(Client{iface, MAC(mac)});
+    }
+
+    // single-threaded cost per reply
+    const uint32_t iterations = 200000;
+    volatile size_t sink = 0;
+    PacketInCache cache;
+    auto t0 = steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+        sink += answerUncached(dir, clients[i % ports],
+                               dhcp::message_type::OFFER, i);
+    auto t1 = steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+        sink += answerCached(cache, dir, clients[i % ports],
+                             dhcp::message_type::OFFER, i);
+    auto t2 = steady_clock::now();
+    double uncachedNs =
+        std::chrono::duration<double, std::nano>(t1 - t0).count() /
+        iterations;
+    double cachedNs =
+        std::chrono::duration<double, std::nano>(t2 - t1).count() /
+        iterations;
+
+    if (offeredRate <= 0)
+        offeredRate = 2 * 1e9 / uncachedNs;
+
+    // the storm schedule: which port each request comes from
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::uniform_int_distribution<uint32_t> pickStorm(0, stormPorts - 1);
+    std::uniform_int_distribution<uint32_t> pickAny(0, ports - 1);
+    vector<bool> stormPort(ports, false);
+    for (uint32_t p = 0; p < stormPorts; ++p)
+        stormPort[p] = true;
+    vector<uint32_t> schedule;
+    for (uint32_t i = 0; i < requests; ++i) {
+        if (stormPorts > 0 && coin(rng) < stormFraction)
+            schedule.push_back(pickStorm(rng));
+        else
+            schedule.push_back(pickAny(rng));
+    }
+
+    StormResult unprotected =
+        storm(clients, schedule, stormPort, offeredRate, false,
+              threads, queueDepth, portRate, portBurst, dir);
+    StormResult protectedResult =
+        storm(clients, schedule, stormPort, offeredRate, true,
+              threads, queueDepth, portRate, portBurst, dir);
+
+    std::cout << "{\"benchmark\": \"pktin\", "
+              << "\"ports\": " << ports << ", "
+              << "\"storm_ports\": " << stormPorts << ", "
+              << "\"requests\": " << requests << ", "
+              << "\"offered_rate\": " << offeredRate << ", "
+              << "\"uncached_ns_per_reply\": " << uncachedNs << ", "
+              << "\"cached_ns_per_reply\": " << cachedNs << ", "
+              << "\"cache_hit_rate\": "
+              << (double)cache.getHits() /
+                 (cache.getHits() + cache.getMisses()) << ", ";
+    print("inline_uncached", unprotected);
+    std::cout << ", ";
+    print("pool_cached_limited", protectedResult);
+    std::cout << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,182 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for sampled pod<-->svc accounting
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/HeavyHitterSketch.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using std::vector;
+namespace po = boost::program_options;
+
+/*
+ * Traffic between the pods of a node and the cluster services, with
+ * pod<-->svc pair weights following a Zipf distribution.  The exact
+ * method counts every packet per pair, as the pair of stats flows for
+ * each pod and service IP does; the sampled method sees one in N
+ * packets and keeps a fixed-size sketch of the heaviest pairs.
+ */
+struct Counts {
+    uint64_t packets;
+    uint64_t bytes;
+};
+
+int main(int argc, char** argv) {
+    uint32_t pods, services, samplingRate, topK, sketchSize;
+    uint64_t packets;
+    double skew;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("pods", po::value<uint32_t>(&pods)->default_value(250),
+         "Number of local pods")
+        ("services", po::value<uint32_t>(&services)->default_value(2000),
+         "Number of services")
+        ("packets", po::value<uint64_t>(&packets)->default_value(50000000),
+         "Number of packets to simulate")
+        ("skew", po::value<double>(&skew)->default_value(1.1),
+         "Zipf exponent of the pod<-->svc pair weights")
+        ("sampling-rate",
+         po::value<uint32_t>(&samplingRate)->default_value(1000),
+         "Sample one in this many packets")
+        ("top-k", po::value<uint32_t>(&topK)->default_value(1000),
+         "Number of pairs to report")
+        ("sketch-size", po::value<uint32_t>(&sketchSize)->default_value(4000),
+         "Number of pairs tracked by the sketch")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::mt19937_64 rng(42);
+    const uint64_t pairs = (uint64_t)pods * services;
+
+    // rank r gets weight 1/r^skew; ranks are shuffled over the pairs
+    vector<double> cdf(pairs);
+    double total = 0;
+    for (uint64_t r = 0; r < pairs; ++r) {
+        total += 1.0 / std::pow(r + 1, skew);
+        cdf[r] = total;
+    }
+    vector<uint64_t> pairOfRank(pairs);
+    for (uint64_t i = 0; i < pairs; ++i)
+        pairOfRank[i] = i;
+    std::shuffle(pairOfRank.begin(), pairOfRank.end(), rng);
+
+    std::uniform_real_distribution<double> pickRank(0, total);
+    std::uniform_int_distribution<uint32_t> pickSize(64, 1500);
+    std::uniform_int_distribution<uint32_t> pickSample(0, samplingRate - 1);
+
+    std::unordered_map<uint64_t, Counts> exact;
+    opflexagent::HeavyHitterSketch<uint64_t> sketch(std::max(sketchSize,
+                                                             topK));
+    double exactNs = 0, sampledNs = 0;
+
+    const uint64_t batch = 1 << 16;
+    vector<std::pair<uint64_t, uint32_t> > pkts(batch);
+    for (uint64_t done = 0; done < packets; done += batch) {
+        size_t n = std::min<uint64_t>(batch, packets - done);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t rank = std::lower_bound(cdf.begin(), cdf.end(),
+                                             pickRank(rng)) - cdf.begin();
+            pkts[i] = std::make_pair(pairOfRank[std::min(rank, pairs - 1)],
+                                     pickSize(rng));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            Counts& c = exact[pkts[i].first];
+            c.packets += 1;
+            c.bytes += pkts[i].second;
+        }
+        auto mid = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            if (pickSample(rng) == 0)
+                sketch.add(pkts[i].first, 1, pkts[i].second);
+        }
+        auto end = std::chrono::steady_clock::now();
+        exactNs += std::chrono::duration<double, std::nano>(mid - start)
+            .count();
+        sampledNs += std::chrono::duration<double, std::nano>(end - mid)
+            .count();
+    }
+
+    // the true top K
+    vector<std::pair<uint64_t, Counts> > truth(exact.begin(), exact.end());
+    size_t k = std::min<size_t>(topK, truth.size());
+    std::partial_sort(truth.begin(), truth.begin() + k, truth.end(),
+                      [](const std::pair<uint64_t, Counts>& a,
+                         const std::pair<uint64_t, Counts>& b) {
+                          return a.second.bytes > b.second.bytes;
+                      });
+    truth.resize(k);
+
+    vector<opflexagent::HeavyHitterSketch<uint64_t>::Entry> top;
+    sketch.getTop(topK, top);
+    std::unordered_map<uint64_t, uint64_t> estimate;
+    for (const auto& e : top)
+        estimate[e.key] = e.bytes * samplingRate;
+
+    size_t found = 0;
+    double relErr = 0;
+    for (const auto& t : truth) {
+        auto it = estimate.find(t.first);
+        if (it == estimate.end())
+            continue;
+        found += 1;
+        relErr += std::fabs((double)it->second - (double)t.second.bytes) /
+            t.second.bytes;
+    }
+
+    // each active pair costs a counter entry plus two stats flows
+    size_t exactMemory = exact.bucket_count() * sizeof(void*) +
+        exact.size() * (sizeof(uint64_t) + sizeof(Counts) + sizeof(void*));
+
+    std::cout << "{\"benchmark\": \"podsvc_sketch\", "
+              << "\"pods\": " << pods << ", "
+              << "\"services\": " << services << ", "
+              << "\"packets\": " << packets << ", "
+              << "\"sampling_rate\": " << samplingRate << ", "
+              << "\"top_k\": " << topK << ", "
+              << "\"exact\": {\"active_pairs\": " << exact.size()
+              << ", \"stats_flows\": " << 2 * exact.size()
+              << ", \"memory_bytes\": " << exactMemory
+              << ", \"ns_per_packet\": " << exactNs / packets << "}, "
+              << "\"sampled\": {\"tracked_pairs\": " << sketch.size()
+              << ", \"stats_flows\": 0"
+              << ", \"memory_bytes\": " << sketch.getMemoryUsage()
+              << ", \"ns_per_packet\": " << sampledNs / packets
+              << ", \"top_k_recall\": " << (k ? (double)found / k : 1.0)
+              << ", \"mean_rel_error\": " << (found ? relErr / found : 0.0)
+              << "}}" << std::endl;
+    return 0;
+}
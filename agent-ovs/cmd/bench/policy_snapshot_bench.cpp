@@ -0,0 +1,327 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the policy queries made by endpoint updates while the
+ * policy changes
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/PolicyManager.h>
+#include <opflexagent/logging.h>
+
+#include <modelgbp/dmtree/Root.hpp>
+#include <modelgbp/gbp/DirectionEnumT.hpp>
+#include <opflex/ofcore/OFFramework.h>
+#include <opflex/modb/Mutator.h>
+
+#include <boost/program_options.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using opflex::modb::URI;
+using opflex::modb::Mutator;
+using opflexagent::PolicyManager;
+namespace po = boost::program_options;
+
+/*
+ * Each simulated endpoint update makes the policy queries that
+ * IntFlowManager::handleEndpointUpdate makes for the endpoint group:
+ * the forwarding info (VNID and domains) and the flood domain, and
+ * the contracts of the group with their groups and rules, as
+ * handleContractUpdate does when the group changes.
+ *
+ * locked: the PolicyManager getters, each of which takes the state
+ *   lock and copies its result.
+ * snapshot: one PolicyManager::getSnapshot per update.
+ *
+ * Meanwhile a churn thread changes the sclass of random groups
+ * through the MODB, so the PolicyManager keeps updating its state.
+ */
+
+struct Policy {
+    vector<URI> groups;
+    // contracts of each group
+    vector<vector<URI> > groupContracts;
+};
+
+static Policy createPolicy(opflex::ofcore::OFFramework& framework,
+                           uint32_t groups, uint32_t contracts,
+                           uint32_t rules) {
+    using namespace modelgbp;
+    using namespace modelgbp::gbp;
+    using namespace modelgbp::gbpe;
+
+    Policy p;
+    Mutator mutator(framework, "policyreg");
+    shared_ptr<policy::Universe> universe =
+        policy::Universe::resolve(framework).get();
+    shared_ptr<policy::Space> space = universe->addPolicySpace("bench");
+
+    shared_ptr<RoutingDomain> rd = space->addGbpRoutingDomain("rd");
+    rd->addGbpeInstContext()->setEncapId(1);
+
+    vector<shared_ptr<Contract> > cons;
+    for (uint32_t c = 0; c < contracts; ++c) {
+        string name = "contract" + std::to_string(c);
+        shared_ptr<Contract> con = space->addGbpContract(name);
+        for (uint32_t r = 0; r < rules; ++r) {
+            string cname = name + "-classifier" + std::to_string(r);
+            shared_ptr<L24Classifier> cls = space->addGbpeL24Classifier(cname);
+            cls->setOrder(r).setEtherT(0x800).setProt(6)
+                .setDFromPort(1000 + r).setDToPort(1000 + r);
+            con->addGbpSubject("subject")
+                ->addGbpRule("rule" + std::to_string(r))
+                ->setOrder(r).setDirection(DirectionEnumT::CONST_IN)
+                .addGbpRuleToClassifierRSrc(cls->getURI().toString());
+        }
+        cons.push_back(con);
+    }
+
+    for (uint32_t g = 0; g < groups; ++g) {
+        string n = std::to_string(g);
+        shared_ptr<BridgeDomain> bd = space->addGbpBridgeDomain("bd" + n);
+        bd->addGbpBridgeDomainToNetworkRSrc()
+            ->setTargetRoutingDomain(rd->getURI());
+        shared_ptr<FloodDomain> fd = space->addGbpFloodDomain("fd" + n);
+        fd->addGbpFloodDomainToNetworkRSrc()
+            ->setTargetBridgeDomain(bd->getURI());
+        shared_ptr<Subnets> subnets = space->addGbpSubnets("subnets" + n);
+        subnets->addGbpSubnet("subnet" + n)
+            ->setAddress("10." + std::to_string(g / 256) + "." +
+                         std::to_string(g % 256) + ".0")
+            .setPrefixLen(24);
+        fd->addGbpForwardingBehavioralGroupToSubnetsRSrc()
+            ->setTargetSubnets(subnets->getURI());
+
+        shared_ptr<EpGroup> epg = space->addGbpEpGroup("epg" + n);
+        epg->addGbpEpGroupToNetworkRSrc()
+            ->setTargetFloodDomain(fd->getURI());
+        epg->addGbpeInstContext()->setEncapId(1000 + g).setClassid(1000 + g);
+
+        // each group provides one contract and consumes the next
+        vector<URI> gc;
+        if (contracts > 0) {
+            const URI& prov = cons[g % contracts]->getURI();
+            const URI& consumed = cons[(g + 1) % contracts]->getURI();
+            epg->addGbpEpGroupToProvContractRSrc(prov.toString());
+            epg->addGbpEpGroupToConsContractRSrc(consumed.toString());
+            gc.push_back(prov);
+            gc.push_back(consumed);
+        }
+        p.groups.push_back(epg->getURI());
+        p.groupContracts.push_back(gc);
+    }
+    mutator.commit();
+    return p;
+}
+
+static size_t lockedUpdate(PolicyManager& pm, const URI& eg,
+                           const vector<URI>& contracts) {
+    size_t n = 0;
+    boost::optional<uint32_t> vnid = pm.getVnidForGroup(eg);
+    if (!vnid) return n;
+    n += pm.getRDForGroup(eg) ? 1 : 0;
+    n += pm.getBDForGroup(eg) ? 1 : 0;
+    n += pm.getFDForGroup(eg) ? 1 : 0;
+    n += pm.getFDForGroup(eg) ? 1 : 0;
+    PolicyManager::subnet_vector_t subnets;
+    pm.getSubnetsForGroup(eg, subnets);
+    n += subnets.size();
+
+    for (const URI& c : contracts) {
+        if (!pm.contractExists(c)) continue;
+        PolicyManager::uri_set_t prov, cons, intra;
+        pm.getContractProviders(c, prov);
+        pm.getContractConsumers(c, cons);
+        pm.getContractIntra(c, intra);
+        for (const URI& g : prov)
+            n += pm.getVnidForGroup(g) && pm.getRDForGroup(g) ? 1 : 0;
+        for (const URI& g : cons)
+            n += pm.getVnidForGroup(g) && pm.getRDForGroup(g) ? 1 : 0;
+        PolicyManager::rule_list_t rules;
+        pm.getContractRules(c, rules);
+        n += rules.size();
+    }
+    return n;
+}
+
+static size_t snapshotUpdate(PolicyManager& pm, const URI& eg,
+                             const vector<URI>& contracts) {
+    size_t n = 0;
+    PolicyManager::snapshot_ptr policy = pm.getSnapshot();
+    shared_ptr<const PolicyManager::Snapshot::GroupInfo> group =
+        policy->getGroup(eg);
+    if (!group || !group->vnid) return n;
+    n += group->routingDomain ? 1 : 0;
+    n += group->bridgeDomain ? 1 : 0;
+    n += group->floodDomain ? 1 : 0;
+    n += group->floodDomain ? 1 : 0;
+    n += group->subnets.size();
+
+    for (const URI& c : contracts) {
+        shared_ptr<const PolicyManager::Snapshot::ContractInfo> contract =
+            policy->getContract(c);
+        if (!contract) continue;
+        for (const URI& g : contract->providerGroups) {
+            auto gi = policy->getGroup(g);
+            n += gi && gi->vnid && gi->routingDomain ? 1 : 0;
+        }
+        for (const URI& g : contract->consumerGroups) {
+            auto gi = policy->getGroup(g);
+            n += gi && gi->vnid && gi->routingDomain ? 1 : 0;
+        }
+        n += contract->rules.size();
+    }
+    return n;
+}
+
+struct Result {
+    double updatesPerSec;
+    uint64_t churn;
+};
+
+static Result run(opflex::ofcore::OFFramework& framework, PolicyManager& pm,
+                  const Policy& p, bool snapshot, uint32_t threads,
+                  uint32_t durationMs, std::atomic<size_t>& sink) {
+    using namespace modelgbp;
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> updates(0);
+    std::atomic<uint64_t> churn(0);
+
+    // change the sclass of a group, which the policy manager
+    // processes as a group domain update
+    std::thread churner([&]() {
+            std::mt19937 rng(7);
+            std::uniform_int_distribution<size_t> pick(0, p.groups.size() - 1);
+            shared_ptr<policy::Universe> universe =
+                policy::Universe::resolve(framework).get();
+            while (!done) {
+                size_t g = pick(rng);
+                Mutator mutator(framework, "policyreg");
+                universe->addPolicySpace("bench")
+                    ->addGbpEpGroup("epg" + std::to_string(g))
+                    ->addGbpeInstContext()
+                    ->setClassid(1000 + g + (churn % 2) * 50000);
+                mutator.commit();
+                churn += 1;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+
+    vector<std::thread> readers;
+    for (uint32_t t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t]() {
+                std::mt19937 rng(t);
+                std::uniform_int_distribution<size_t>
+                    pick(0, p.groups.size() - 1);
+                size_t local = 0;
+                uint64_t count = 0;
+                while (!done) {
+                    size_t g = pick(rng);
+                    local += snapshot
+                        ? snapshotUpdate(pm, p.groups[g], p.groupContracts[g])
+                        : lockedUpdate(pm, p.groups[g], p.groupContracts[g]);
+                    count += 1;
+                }
+                updates += count;
+                sink += local;
+            });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    done = true;
+    for (std::thread& r : readers)
+        r.join();
+    churner.join();
+
+    return Result{updates * 1000.0 / durationMs, churn};
+}
+
+int main(int argc, char** argv) {
+    uint32_t groups, contracts, rules, threads, durationMs;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("groups", po::value<uint32_t>(&groups)->default_value(500),
+         "Number of endpoint groups")
+        ("contracts", po::value<uint32_t>(&contracts)->default_value(50),
+         "Number of contracts")
+        ("rules", po::value<uint32_t>(&rules)->default_value(20),
+         "Number of rules per contract")
+        ("threads", po::value<uint32_t>(&threads)->default_value(4),
+         "Number of threads processing endpoint updates")
+        ("duration", po::value<uint32_t>(&durationMs)->default_value(2000),
+         "Run time for each mode in milliseconds")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (groups == 0 || durationMs == 0) {
+        std::cerr << "Need at least one group and a non-zero duration"
+                  << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "policy-snapshot-bench");
+
+    opflex::ofcore::OFFramework framework;
+    opflexagent::Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    PolicyManager& pm = agent.getPolicyManager();
+    Policy p = createPolicy(framework, groups, contracts, rules);
+
+    // wait for the policy manager to index the policy
+    for (int i = 0; i < 10000; ++i) {
+        PolicyManager::snapshot_ptr s = pm.getSnapshot();
+        if (s->getGroup(p.groups.back()) &&
+            (contracts == 0 || s->getContract(p.groupContracts.back()[0])))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::atomic<size_t> sink(0);
+    Result locked = run(framework, pm, p, false, threads, durationMs, sink);
+    Result snap = run(framework, pm, p, true, threads, durationMs, sink);
+
+    agent.stop();
+
+    std::cout << "{\"benchmark\": \"policy_snapshot\", "
+              << "\"groups\": " << groups << ", "
+              << "\"contracts\": " << contracts << ", "
+              << "\"rules\": " << rules << ", "
+              << "\"threads\": " << threads << ", "
+              << "\"locked\": {\"updates_per_sec\": " << locked.updatesPerSec
+              << ", \"policy_changes\": " << locked.churn << "}, "
+              << "\"snapshot\": {\"updates_per_sec\": " << snap.updatesPerSec
+              << ", \"policy_changes\": " << snap.churn << "}}"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,283 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for integration bridge flow generation for a burst of
+ * remote endpoints
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "BenchUtil.h"
+#include "IntFlowManager.h"
+#include "FlowReader.h"
+#include "CtZoneManager.h"
+#include "ovs-ofputil.h"
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/IdGenerator.h>
+#include <opflexagent/PolicyManager.h>
+#include <opflexagent/TunnelEpManager.h>
+#include <opflexagent/logging.h>
+
+#include <modelgbp/dmtree/Root.hpp>
+#include <opflex/ofcore/OFFramework.h>
+#include <opflex/modb/Mutator.h>
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using opflex::modb::URI;
+using opflex::modb::MAC;
+using opflex::modb::Mutator;
+using opflexagent::Agent;
+using opflexagent::IntFlowManager;
+using namespace opflexagent::bench;
+namespace po = boost::program_options;
+
+/*
+ * Simulates a burst of remote endpoints learned from the fabric, such
+ * as after the agent reconnects to a leaf.  The remote endpoint
+ * inventory is committed and the time until the flows for every
+ * endpoint have been sent to the switch is measured.
+ *
+ * The same endpoints are also added one at a time, waiting for the
+ * flows of each one before adding the next, so that every update is
+ * processed on its own.  This is how each endpoint of a burst was
+ * processed before updates were batched.
+ */
+
+static vector<URI> createPolicy(opflex::ofcore::OFFramework& framework,
+                                uint32_t groups) {
+    using namespace modelgbp;
+    using namespace modelgbp::gbp;
+    using namespace modelgbp::gbpe;
+
+    vector<URI> epgs;
+    Mutator mutator(framework, "policyreg");
+    shared_ptr<policy::Universe> universe =
+        policy::Universe::resolve(framework).get();
+    shared_ptr<policy::Space> space = universe->addPolicySpace("bench");
+
+    shared_ptr<RoutingDomain> rd = space->addGbpRoutingDomain("rd");
+    rd->addGbpeInstContext()->setEncapId(1);
+    shared_ptr<BridgeDomain> bd = space->addGbpBridgeDomain("bd");
+    bd->addGbpeInstContext()->setEncapId(10);
+    bd->addGbpBridgeDomainToNetworkRSrc()
+        ->setTargetRoutingDomain(rd->getURI());
+    shared_ptr<FloodDomain> fd = space->addGbpFloodDomain("fd");
+    fd->addGbpFloodDomainToNetworkRSrc()
+        ->setTargetBridgeDomain(bd->getURI());
+
+    for (uint32_t g = 0; g < groups; ++g) {
+        shared_ptr<EpGroup> epg =
+            space->addGbpEpGroup("epg" + std::to_string(g));
+        epg->addGbpEpGroupToNetworkRSrc()
+            ->setTargetFloodDomain(fd->getURI());
+        epg->addGbpeInstContext()->setEncapId(1000 + g).setClassid(1000 + g);
+        epgs.push_back(epg->getURI());
+    }
+    mutator.commit();
+    return epgs;
+}
+
+// Each endpoint has a MAC and a /32 IP, which is a bridge flow, a
+// proxy ARP flow and a route flow
+static const size_t EDITS_PER_EP = 3;
+
+static string epUuid(uint32_t i) {
+    return "rep-" + std::to_string(i);
+}
+
+static void addRemoteEp(shared_ptr<modelgbp::inv::RemoteEndpointInventory> inv,
+                        const vector<URI>& epgs, uint32_t tunnels,
+                        uint32_t i) {
+    uint8_t mac[6] = {0x02, 0x01, 0, (uint8_t)(i >> 16),
+                      (uint8_t)(i >> 8), (uint8_t)i};
+    uint32_t t = i % tunnels;
+    auto rep = inv->addInvRemoteInventoryEp(epUuid(i));
+    rep->setMac(MAC(mac))
+        .setNextHopTunnel("192.168." + std::to_string(t / 250) + "." +
+                          std::to_string(t % 250 + 1))
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epgs[i % epgs.size()]);
+    rep->addInvRemoteIp("10." + std::to_string(i >> 16) + "." +
+                        std::to_string((i >> 8) & 0xff) + "." +
+                        std::to_string(i & 0xff));
+}
+
+struct Result {
+    double ms;
+    double cpuMs;
+    size_t executes;
+    size_t edits;
+};
+
+static bool run(opflex::ofcore::OFFramework& framework, Agent& agent,
+                CountingFlowExecutor& executor, const vector<URI>& epgs,
+                uint32_t count, uint32_t tunnels, bool burst,
+                Result& result) {
+    shared_ptr<modelgbp::inv::RemoteEndpointInventory> inv;
+    {
+        Mutator mutator(framework, "policyelement");
+        inv = modelgbp::inv::Universe::resolve(framework).get()
+            ->addInvRemoteEndpointInventory();
+        mutator.commit();
+    }
+    drain(agent);
+
+    size_t executes0, edits0;
+    executor.getCounts(executes0, edits0);
+    clockid_t clock = getIOThreadClock(agent);
+    double cpuStart = cpuUs(clock);
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    if (burst) {
+        Mutator mutator(framework, "policyelement");
+        for (uint32_t i = 0; i < count; ++i)
+            addRemoteEp(inv, epgs, tunnels, i);
+        mutator.commit();
+        ok = executor.waitForEdits(edits0 + count * EDITS_PER_EP);
+    } else {
+        for (uint32_t i = 0; ok && i < count; ++i) {
+            Mutator mutator(framework, "policyelement");
+            addRemoteEp(inv, epgs, tunnels, i);
+            mutator.commit();
+            ok = executor.waitForEdits(edits0 + (i + 1) * EDITS_PER_EP);
+        }
+    }
+    result.ms = std::chrono::duration<double, std::milli>
+        (std::chrono::steady_clock::now() - start).count();
+    result.cpuMs = (cpuUs(clock) - cpuStart) / 1000;
+    executor.getCounts(result.executes, result.edits);
+    result.executes -= executes0;
+    result.edits -= edits0;
+    if (!ok) return false;
+
+    // removing the endpoints clears their flows for the next run
+    {
+        Mutator mutator(framework, "policyelement");
+        for (uint32_t i = 0; i < count; ++i)
+            modelgbp::inv::RemoteInventoryEp::remove(framework, epUuid(i));
+        mutator.commit();
+    }
+    return executor.waitForEdits(edits0 + 2 * count * EDITS_PER_EP);
+}
+
+static void printResult(const char* name, const Result& r, uint32_t count) {
+    std::cout << "\"" << name << "\": {\"ms\": " << r.ms
+              << ", \"io_cpu_ms\": " << r.cpuMs
+              << ", \"us_per_endpoint\": " << r.ms * 1000 / count
+              << ", \"executes\": " << r.executes
+              << ", \"edits\": " << r.edits << "}";
+}
+
+int main(int argc, char** argv) {
+    uint32_t endpoints, paced, groups, tunnels;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("endpoints", po::value<uint32_t>(&endpoints)->default_value(20000),
+         "Number of remote endpoints in the burst")
+        ("paced", po::value<uint32_t>(&paced)->default_value(2000),
+         "Number of remote endpoints added one at a time")
+        ("groups", po::value<uint32_t>(&groups)->default_value(20),
+         "Number of endpoint groups")
+        ("tunnels", po::value<uint32_t>(&tunnels)->default_value(500),
+         "Number of remote tunnel destinations")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (endpoints == 0 || paced == 0 || groups == 0 || tunnels == 0) {
+        std::cerr << "Need at least one endpoint, group and tunnel"
+                  << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "remote-ep-bench");
+
+    opflex::ofcore::OFFramework framework;
+    Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    vector<URI> epgs = createPolicy(framework, groups);
+    opflexagent::PolicyManager& pm = agent.getPolicyManager();
+    for (int i = 0; i < 10000; ++i) {
+        if (pm.getSnapshot()->getGroup(epgs.back()))
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    BenchPortMapper portMapper;
+    portMapper.ports["vxlan0"] = 2048;
+    opflexagent::TunnelEpManager tunnelEpManager(&agent);
+    opflexagent::IdGenerator idGen;
+    opflexagent::CtZoneManager ctZoneManager(idGen);
+    ctZoneManager.setCtZoneRange(1, 65534);
+    ctZoneManager.init("conntrack");
+    CountingFlowExecutor executor;
+    opflexagent::FlowReader reader;
+    BenchSwitchManager switchManager(agent, executor, reader, portMapper);
+    IntFlowManager intFlowManager(agent, switchManager, idGen,
+                                  ctZoneManager, tunnelEpManager);
+    intFlowManager.setEncapType(IntFlowManager::ENCAP_VXLAN);
+    intFlowManager.setEncapIface("vxlan0");
+    intFlowManager.setVirtualRouter(true, false, "00:22:bd:f8:19:ff");
+    switchManager.start("bench");
+    intFlowManager.start();
+    intFlowManager.registerModbListeners();
+    for (const URI& epg : epgs)
+        intFlowManager.egDomainUpdated(epg);
+    drain(agent);
+
+    Result pr, br;
+    bool ok = run(framework, agent, executor, epgs, paced, tunnels,
+                  false, pr) &&
+        run(framework, agent, executor, epgs, endpoints, tunnels,
+            true, br);
+
+    agent.stop();
+    intFlowManager.stop();
+    switchManager.stop();
+
+    if (!ok) {
+        std::cerr << "remote endpoint flows were not written" << std::endl;
+        return 1;
+    }
+
+    std::cout << "{\"benchmark\": \"remote_ep\", "
+              << "\"endpoints\": " << endpoints << ", "
+              << "\"paced\": " << paced << ", "
+              << "\"groups\": " << groups << ", "
+              << "\"tunnels\": " << tunnels << ", ";
+    printResult("one_at_a_time", pr, paced);
+    std::cout << ", ";
+    printResult("burst", br, endpoints);
+    std::cout << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,285 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for security group flow compilation
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "BenchUtil.h"
+#include "AccessFlowManager.h"
+#include "CtZoneManager.h"
+#include "MockSwitchManager.h"
+#include "MockFlowReader.h"
+#include "MockPortMapper.h"
+
+#include <opflexagent/Agent.h>
+#include <opflexagent/EndpointSource.h>
+#include <opflexagent/IdGenerator.h>
+#include <opflexagent/PolicyManager.h>
+#include <opflexagent/logging.h>
+
+#include <modelgbp/dmtree/Root.hpp>
+#include <modelgbp/l2/EtherTypeEnumT.hpp>
+#include <opflex/ofcore/OFFramework.h>
+#include <opflex/modb/Mutator.h>
+
+#include <boost/program_options.hpp>
+#include <boost/asio/ip/address_v4.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using opflex::modb::URI;
+using opflex::modb::Mutator;
+using opflexagent::Agent;
+using opflexagent::Endpoint;
+using opflexagent::AccessFlowManager;
+using namespace opflexagent::bench;
+namespace po = boost::program_options;
+
+/*
+ * Kubernetes-style network policies: each namespace has a policy that
+ * allows traffic to a port from the pods of the namespace.  The remote
+ * subnets are the individual pod IPs, as rendered by the CNI for
+ * namespace selectors.  Each policy is a security group, and each
+ * endpoint has a set of them.
+ *
+ * The endpoints are added to an access flow manager writing to a
+ * simulated switch, and the security group flows written and the CPU
+ * time of the agent IO thread, which runs the flow manager tasks, are
+ * reported.  Every security group is then invalidated, as on a policy
+ * update, so every set is compiled again, which is reported
+ * separately.
+ */
+
+static vector<URI> createPolicy(opflex::ofcore::OFFramework& framework,
+                                uint32_t namespaces, uint32_t podsPerNs,
+                                uint32_t nodes) {
+    using namespace modelgbp;
+    using namespace modelgbp::gbp;
+    using namespace modelgbp::gbpe;
+
+    vector<URI> secGrps;
+    Mutator mutator(framework, "policyreg");
+    shared_ptr<policy::Universe> universe =
+        policy::Universe::resolve(framework).get();
+    shared_ptr<policy::Space> space = universe->addPolicySpace("bench");
+
+    // pods are scheduled round-robin across nodes, so the pods of a
+    // namespace are mostly contiguous within each node CIDR
+    vector<uint32_t> nextPod(nodes, 2);
+    for (uint32_t ns = 0; ns < namespaces; ++ns) {
+        string n = std::to_string(ns);
+        shared_ptr<L24Classifier> cls = space->addGbpeL24Classifier("np" + n);
+        cls->setEtherT(l2::EtherTypeEnumT::CONST_IPV4).setProt(6)
+            .setDFromPort(8000 + ns % 100);
+
+        shared_ptr<Subnets> subnets = space->addGbpSubnets("pods" + n);
+        for (uint32_t pod = 0; pod < podsPerNs; ++pod) {
+            uint32_t node = pod % nodes;
+            uint32_t host = nextPod[node]++ % 254;
+            boost::asio::ip::address_v4
+                ip((10u << 24) | (2u << 16) | (node << 8) | host);
+            subnets->addGbpSubnet(std::to_string(pod))
+                ->setAddress(ip.to_string()).setPrefixLen(32);
+        }
+
+        shared_ptr<SecGroup> sg = space->addGbpSecGroup("np" + n);
+        shared_ptr<SecGroupRule> rule =
+            sg->addGbpSecGroupSubject("subject")->addGbpSecGroupRule("rule");
+        rule->setDirection(DirectionEnumT::CONST_IN).setOrder(100)
+            .addGbpRuleToClassifierRSrc(cls->getURI().toString());
+        rule->addGbpSecGroupRuleToRemoteAddressRSrc(subnets->getURI()
+                                                    .toString());
+        secGrps.push_back(sg->getURI());
+    }
+    mutator.commit();
+    return secGrps;
+}
+
+// wait until the policy manager has resolved the rules of every
+// security group with all their remote subnets
+static bool waitForPolicy(Agent& agent, const vector<URI>& secGrps,
+                          uint32_t podsPerNs) {
+    opflexagent::PolicyManager& pm = agent.getPolicyManager();
+    for (int i = 0; i < 60000; ++i) {
+        auto snapshot = pm.getSnapshot();
+        bool ready = true;
+        for (size_t s = 0; ready && s < secGrps.size(); ++s) {
+            auto rules = snapshot->getSecGroupRules(secGrps[s]);
+            ready = rules && rules->size() == 1 &&
+                rules->front()->getRemoteSubnets().size() == podsPerNs;
+        }
+        if (ready)
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+struct Result {
+    double cpuMs;
+    double ms;
+    size_t adds;
+    size_t edits;
+};
+
+static Result measure(Agent& agent, CountingFlowExecutor& executor,
+                      const std::function<void ()>& update) {
+    size_t executes0, edits0;
+    executor.getCounts(executes0, edits0);
+    size_t adds0 = executor.getAdds();
+    clockid_t clock = getIOThreadClock(agent);
+    double cpuStart = cpuUs(clock);
+    auto start = std::chrono::steady_clock::now();
+    update();
+    // a security group update queues the updates of its sets
+    drain(agent);
+    drain(agent);
+    Result r;
+    r.cpuMs = (cpuUs(clock) - cpuStart) / 1000;
+    r.ms = std::chrono::duration<double, std::milli>
+        (std::chrono::steady_clock::now() - start).count();
+    size_t executes;
+    executor.getCounts(executes, r.edits);
+    r.adds = executor.getAdds() - adds0;
+    r.edits -= edits0;
+    return r;
+}
+
+static void printResult(const char* name, const Result& r) {
+    std::cout << "\"" << name << "\": {\"cpu_ms\": " << r.cpuMs
+              << ", \"ms\": " << r.ms
+              << ", \"flows_added\": " << r.adds
+              << ", \"edits\": " << r.edits << "}";
+}
+
+int main(int argc, char** argv) {
+    uint32_t namespaces, podsPerNs, nodes, sets, policiesPerSet;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("namespaces", po::value<uint32_t>(&namespaces)->default_value(50),
+         "Number of namespaces, each with one network policy")
+        ("pods", po::value<uint32_t>(&podsPerNs)->default_value(100),
+         "Number of pods per namespace")
+        ("nodes", po::value<uint32_t>(&nodes)->default_value(20),
+         "Number of nodes, each with a /24 pod CIDR")
+        ("sets", po::value<uint32_t>(&sets)->default_value(200),
+         "Number of distinct security group sets")
+        ("policies-per-set",
+         po::value<uint32_t>(&policiesPerSet)->default_value(4),
+         "Number of network policies in each security group set")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (namespaces == 0 || podsPerNs == 0 || nodes == 0 || sets == 0 ||
+        policiesPerSet == 0) {
+        std::cerr << "Need at least one namespace, pod, node, set and "
+                  << "policy per set" << std::endl;
+        return 1;
+    }
+
+    opflexagent::initLogging("error", false, "", "secgrp-compile-bench");
+
+    opflex::ofcore::OFFramework framework;
+    Agent agent(framework, std::make_tuple("error", false, ""));
+    agent.start();
+
+    vector<URI> secGrps =
+        createPolicy(framework, namespaces, podsPerNs, nodes);
+    if (!waitForPolicy(agent, secGrps, podsPerNs)) {
+        std::cerr << "security groups were not resolved" << std::endl;
+        return 1;
+    }
+
+    opflexagent::IdGenerator idGen;
+    idGen.initNamespace("l24classifierRule");
+    opflexagent::CtZoneManager ctZoneManager(idGen);
+    ctZoneManager.setCtZoneRange(1, 65534);
+    ctZoneManager.init("conntrack");
+    CountingFlowExecutor executor;
+    opflexagent::MockFlowReader reader;
+    opflexagent::MockPortMapper portMapper;
+    opflexagent::MockSwitchManager switchManager(agent, executor, reader,
+                                                 portMapper);
+    AccessFlowManager accessFlowManager(agent, switchManager, idGen,
+                                        ctZoneManager);
+    switchManager.registerStateHandler(&accessFlowManager);
+    switchManager.start("bench");
+    accessFlowManager.start();
+    switchManager.enableSync();
+    switchManager.connect();
+    drain(agent);
+
+    // every endpoint has its own set of security groups
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, secGrps.size() - 1);
+    size_t perSet = std::min<size_t>(policiesPerSet, secGrps.size());
+    vector<Endpoint> eps;
+    for (uint32_t s = 0; s < sets; ++s) {
+        std::set<URI> set;
+        while (set.size() < perSet)
+            set.insert(secGrps[pick(rng)]);
+        eps.emplace_back("ep-" + std::to_string(s));
+        eps.back().setSecurityGroups(set);
+    }
+
+    opflexagent::EndpointSource epSrc(&agent.getEndpointManager());
+    Result added = measure(agent, executor, [&]() {
+            for (const Endpoint& ep : eps)
+                epSrc.updateEndpoint(ep);
+        });
+
+    // invalidate every security group, as a policy update would, so
+    // that every set is compiled again
+    Result updated = measure(agent, executor, [&]() {
+            for (const URI& sg : secGrps)
+                accessFlowManager.secGroupUpdated(sg);
+        });
+
+    accessFlowManager.stop();
+    switchManager.stop();
+    agent.stop();
+
+    std::cout << "{\"benchmark\": \"secgrp_compile\", "
+              << "\"namespaces\": " << namespaces << ", "
+              << "\"pods_per_namespace\": " << podsPerNs << ", "
+              << "\"sets\": " << sets << ", "
+              << "\"policies_per_set\": " << policiesPerSet << ", "
+              << "\"remote_subnets\": "
+              << sets * perSet * podsPerNs << ", ";
+    printResult("add", added);
+    std::cout << ", ";
+    printResult("update", updated);
+    std::cout << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,272 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for service next hop selection under next hop churn
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "MaglevTable.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+using opflexagent::MaglevTable;
+namespace po = boost::program_options;
+
+/*
+ * Simulates a service whose next hops are replaced one at a time, as
+ * in a rolling update, and compares the two ways the integration
+ * bridge selects a next hop:
+ *
+ * hash: multipath iter_hash over the next hops, which are numbered
+ *   by their position in the service mapping.
+ * maglev: multipath modulo_n into a Maglev lookup table whose slots
+ *   resolve to stable per-next-hop links.
+ *
+ * For each step it measures the fraction of established connections
+ * that move to a different next hop, and the number of flows in the
+ * service next hop table that must be added, modified or removed.
+ */
+
+static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// OVS iter_hash: rehash until the link is in range
+static uint32_t iterHash(uint64_t conn, uint32_t maxLink, uint32_t arg) {
+    if (arg <= maxLink) {
+        arg = 1;
+        while (arg <= maxLink)
+            arg <<= 1;
+    }
+    for (uint64_t i = 1;; ++i) {
+        uint32_t link = (uint32_t)(mix(conn ^ (i * 0x9e3779b97f4a7c15ULL))
+                                   % arg);
+        if (link <= maxLink)
+            return link;
+    }
+}
+
+// flow key in the next hop table -> next hop it selects
+typedef std::map<uint64_t, string> flows_t;
+
+static size_t flowDelta(const flows_t& before, const flows_t& after) {
+    size_t delta = 0;
+    for (const auto& f : before) {
+        auto it = after.find(f.first);
+        if (it == after.end() || it->second != f.second)
+            delta += 1;
+    }
+    for (const auto& f : after) {
+        if (before.find(f.first) == before.end())
+            delta += 1;
+    }
+    return delta;
+}
+
+struct Selector {
+    virtual ~Selector() {}
+    virtual void update(const vector<string>& nextHops) = 0;
+    virtual const string& select(uint64_t conn) const = 0;
+    virtual const flows_t& getFlows() const = 0;
+};
+
+struct HashSelector : public Selector {
+    vector<string> nextHops;
+    flows_t flows;
+
+    virtual void update(const vector<string>& nhs) {
+        nextHops = nhs;
+        flows.clear();
+        for (size_t i = 0; i < nextHops.size(); ++i)
+            flows[i] = nextHops[i];
+    }
+    virtual const string& select(uint64_t conn) const {
+        return nextHops[iterHash(conn, nextHops.size() - 1, 32)];
+    }
+    virtual const flows_t& getFlows() const { return flows; }
+};
+
+struct MaglevSelector : public Selector {
+    uint32_t size;
+    vector<string> nextHops;
+    vector<uint32_t> table;
+    flows_t flows;
+
+    explicit MaglevSelector(uint32_t size_) : size(size_) {}
+
+    virtual void update(const vector<string>& nhs) {
+        nextHops = nhs;
+        MaglevTable::populate(nextHops, size, table);
+        vector<uint32_t> linkIds;
+        MaglevTable::getLinkIds(nextHops, size, linkIds);
+        flows.clear();
+        // slot flows select a link; link flows select the next hop.
+        // The first next hop is the default and has no link flow.
+        for (uint32_t slot = 0; slot < table.size(); ++slot)
+            flows[slot] = std::to_string(linkIds[table[slot]]);
+        for (size_t i = 0; i < nextHops.size(); ++i)
+            flows[i == 0 ? (uint64_t)-1 : linkIds[i]] = nextHops[i];
+    }
+    virtual const string& select(uint64_t conn) const {
+        return nextHops[table[mix(conn) % size]];
+    }
+    virtual const flows_t& getFlows() const { return flows; }
+};
+
+struct Result {
+    // fraction of connections to surviving next hops that moved, when
+    // a next hop is removed and when one is added
+    double remappedOnRemove;
+    double remappedOnAdd;
+    double flowDelta;
+    size_t flows;
+};
+
+static Result run(Selector& sel, const vector<vector<string> >& steps,
+                  const vector<uint64_t>& conns) {
+    Result r{0, 0, 0, 0};
+    size_t removes = 0, adds = 0;
+    sel.update(steps[0]);
+    vector<string> current;
+    for (uint64_t c : conns)
+        current.push_back(sel.select(c));
+
+    for (size_t s = 1; s < steps.size(); ++s) {
+        flows_t before = sel.getFlows();
+        sel.update(steps[s]);
+        r.flowDelta += flowDelta(before, sel.getFlows());
+
+        // connections to a surviving next hop that moved anyway
+        size_t moved = 0, surviving = 0;
+        for (size_t i = 0; i < conns.size(); ++i) {
+            const string& nh = sel.select(conns[i]);
+            if (std::find(steps[s].begin(), steps[s].end(), current[i]) !=
+                steps[s].end()) {
+                surviving += 1;
+                if (nh != current[i])
+                    moved += 1;
+            }
+            current[i] = nh;
+        }
+        double frac = surviving ? (double)moved / surviving : 0;
+        if (steps[s].size() < steps[s - 1].size()) {
+            r.remappedOnRemove += frac;
+            removes += 1;
+        } else {
+            r.remappedOnAdd += frac;
+            adds += 1;
+        }
+    }
+    r.remappedOnRemove /= std::max<size_t>(removes, 1);
+    r.remappedOnAdd /= std::max<size_t>(adds, 1);
+    r.flowDelta /= steps.size() - 1;
+    r.flows = sel.getFlows().size();
+    return r;
+}
+
+static void print(const char* name, const Result& r) {
+    std::cout << "\"" << name << "\": {\"flows\": " << r.flows
+              << ", \"mean_flow_delta\": " << r.flowDelta
+              << ", \"remapped_on_remove\": " << r.remappedOnRemove
+              << ", \"remapped_on_add\": " << r.remappedOnAdd << "}";
+}
+
+int main(int argc, char** argv) {
+    uint32_t nextHops, steps, connections, tableSize;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("next-hops", po::value<uint32_t>(&nextHops)->default_value(10),
+         "Number of service next hops")
+        ("steps", po::value<uint32_t>(&steps)->default_value(50),
+         "Number of next hop replacements")
+        ("connections",
+         po::value<uint32_t>(&connections)->default_value(100000),
+         "Number of established connections")
+        ("table-size",
+         po::value<uint32_t>(&tableSize)->
+         default_value(MaglevTable::DEFAULT_SIZE),
+         "Maglev lookup table size")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (nextHops < 2) {
+        std::cerr << "At least 2 next hops are needed" << std::endl;
+        return 1;
+    }
+    tableSize = MaglevTable::nextPrime(tableSize);
+
+    // a rolling update: a random next hop goes away, then its
+    // replacement is added at the end of the list
+    std::mt19937_64 rng(42);
+    uint32_t nextIp = 1;
+    auto ip = [&nextIp]() {
+        uint32_t n = nextIp++;
+        return "10.1." + std::to_string(n / 250) + "." +
+            std::to_string(n % 250 + 1);
+    };
+    vector<vector<string> > seq;
+    vector<string> nhs;
+    for (uint32_t i = 0; i < nextHops; ++i)
+        nhs.push_back(ip());
+    seq.push_back(nhs);
+    for (uint32_t s = 0; s < steps; ++s) {
+        std::uniform_int_distribution<size_t> pick(0, nhs.size() - 1);
+        nhs.erase(nhs.begin() + pick(rng));
+        seq.push_back(nhs);
+        nhs.push_back(ip());
+        seq.push_back(nhs);
+    }
+
+    vector<uint64_t> conns;
+    for (uint32_t i = 0; i < connections; ++i)
+        conns.push_back(rng());
+
+    HashSelector hash;
+    MaglevSelector maglev(tableSize);
+    Result hr = run(hash, seq, conns);
+    Result mr = run(maglev, seq, conns);
+
+    std::cout << "{\"benchmark\": \"service_lb\", "
+              << "\"next_hops\": " << nextHops << ", "
+              << "\"changes\": " << seq.size() - 1 << ", "
+              << "\"connections\": " << connections << ", "
+              << "\"table_size\": " << tableSize << ", ";
+    print("hash", hr);
+    std::cout << ", ";
+    print("maglev", mr);
+    std::cout << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,283 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the CPU cost of discovering the tunnel endpoint
+ * uplink address by polling compared to netlink notifications
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/InterfaceAddrCache.h>
+
+#include <opflex/modb/MAC.h>
+
+#include <boost/program_options.hpp>
+
+#include <ifaddrs.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <time.h>
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+using opflexagent::InterfaceAddrCache;
+namespace po = boost::program_options;
+
+/*
+ * Simulates a host with an uplink and thousands of veth interfaces,
+ * each with an IPv6 link-local address, and measures the CPU time of
+ * the tunnel endpoint manager finding the uplink address:
+ *
+ * poll: every timer interval, enumerate every link and address and
+ *   choose the uplink address.  getifaddrs() does this with a netlink
+ *   dump of all links and addresses, which is replayed here into an
+ *   empty cache; the getifaddrs() cost on this host is also reported.
+ * netlink: apply one link or address notification to the synced
+ *   cache and choose the uplink address again, for each change.
+ *
+ * It reports the CPU time per hour of each, with the given polling
+ * interval and rate of interface changes.
+ */
+
+static double cpuUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+class NlBuilder {
+public:
+    void link(int index, const string& name, unsigned flags,
+              const opflex::modb::MAC& mac, uint16_t type = RTM_NEWLINK) {
+        vector<char> msg(NLMSG_SPACE(sizeof(struct ifinfomsg)));
+        struct ifinfomsg* ifi = (struct ifinfomsg*)NLMSG_DATA(msg.data());
+        ifi->ifi_index = index;
+        ifi->ifi_flags = flags;
+        attr(msg, IFLA_IFNAME, name.c_str(), name.size() + 1);
+        uint8_t b[6];
+        mac.toUIntArray(b);
+        attr(msg, IFLA_ADDRESS, b, sizeof(b));
+        add(msg, type);
+    }
+
+    void addr(int index, const boost::asio::ip::address& ip,
+              uint16_t type = RTM_NEWADDR) {
+        vector<char> msg(NLMSG_SPACE(sizeof(struct ifaddrmsg)));
+        struct ifaddrmsg* ifa = (struct ifaddrmsg*)NLMSG_DATA(msg.data());
+        ifa->ifa_index = index;
+        if (ip.is_v4()) {
+            ifa->ifa_family = AF_INET;
+            auto b = ip.to_v4().to_bytes();
+            attr(msg, IFA_LOCAL, b.data(), b.size());
+        } else {
+            ifa->ifa_family = AF_INET6;
+            auto b = ip.to_v6().to_bytes();
+            attr(msg, IFA_ADDRESS, b.data(), b.size());
+        }
+        add(msg, type);
+    }
+
+    void done() {
+        vector<char> msg(NLMSG_SPACE(sizeof(int)));
+        add(msg, NLMSG_DONE);
+    }
+
+    vector<char> buf;
+
+private:
+    static void attr(vector<char>& msg, uint16_t type,
+                     const void* data, size_t len) {
+        size_t off = msg.size();
+        msg.resize(off + RTA_SPACE(len));
+        struct rtattr* rta = (struct rtattr*)&msg[off];
+        rta->rta_type = type;
+        rta->rta_len = RTA_LENGTH(len);
+        memcpy(RTA_DATA(rta), data, len);
+    }
+
+    void add(vector<char>& msg, uint16_t type) {
+        struct nlmsghdr* nlh = (struct nlmsghdr*)msg.data();
+        nlh->nlmsg_len = msg.size();
+        nlh->nlmsg_type = type;
+        buf.insert(buf.end(), msg.begin(), msg.end());
+    }
+};
+
+static opflex::modb::MAC macFor(uint32_t i) {
+    uint8_t b[6] = {0x02, 0, (uint8_t)(i >> 24), (uint8_t)(i >> 16),
+                    (uint8_t)(i >> 8), (uint8_t)i};
+    return opflex::modb::MAC(b);
+}
+
+static boost::asio::ip::address linkLocal(uint32_t i) {
+    boost::asio::ip::address_v6::bytes_type b = {{0xfe, 0x80}};
+    b[12] = (uint8_t)(i >> 24);
+    b[13] = (uint8_t)(i >> 16);
+    b[14] = (uint8_t)(i >> 8);
+    b[15] = (uint8_t)i;
+    return boost::asio::ip::address_v6(b);
+}
+
+// a dump of the links or of the addresses of the simulated host, in
+// datagrams of at most 32KB as the kernel sends them
+static vector<vector<char> > dump(uint32_t veths, bool links) {
+    vector<vector<char> > datagrams;
+    NlBuilder b;
+    for (uint32_t i = 0; i <= veths + 1; ++i) {
+        int index = i + 1;
+        if (links) {
+            if (i == 0)
+                b.link(index, "lo", IFF_UP | IFF_LOOPBACK, macFor(0));
+            else if (i == 1)
+                b.link(index, "eth0", IFF_UP, macFor(1));
+            else
+                b.link(index, "veth" + std::to_string(i), IFF_UP,
+                       macFor(i));
+        } else {
+            if (i == 1)
+                b.addr(index, boost::asio::ip::address::from_string
+                       ("10.0.0.1"));
+            b.addr(index, linkLocal(i));
+        }
+        if (b.buf.size() > 32 * 1024 - 1024) {
+            datagrams.push_back(std::move(b.buf));
+            b.buf.clear();
+        }
+    }
+    b.done();
+    datagrams.push_back(std::move(b.buf));
+    return datagrams;
+}
+
+int main(int argc, char** argv) {
+    uint32_t veths, polls, events;
+    double interval, eventRate;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "Print this help message")
+        ("veths", po::value<uint32_t>(&veths)->default_value(5000),
+         "Number of veth interfaces on the simulated host")
+        ("polls", po::value<uint32_t>(&polls)->default_value(200),
+         "Number of polls to measure")
+        ("events", po::value<uint32_t>(&events)->default_value(100000),
+         "Number of notifications to measure")
+        ("interval", po::value<double>(&interval)->default_value(5),
+         "Polling interval in seconds")
+        ("event-rate", po::value<double>(&eventRate)->default_value(10),
+         "Interface changes per second")
+        ;
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << desc;
+            return 0;
+        }
+    } catch (const po::unknown_option& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (polls == 0 || events == 0 || interval <= 0) {
+        std::cerr << "Need at least one poll and event, and a positive "
+                  << "interval" << std::endl;
+        return 1;
+    }
+
+    vector<vector<char> > linkDump = dump(veths, true);
+    vector<vector<char> > addrDump = dump(veths, false);
+    string a, mac, iface;
+    bool v4 = false;
+    size_t sink = 0;
+
+    // poll: enumerate everything each time
+    double start = cpuUs();
+    for (uint32_t p = 0; p < polls; ++p) {
+        InterfaceAddrCache cache;
+        for (const vector<char>& d : linkDump)
+            cache.apply(d.data(), d.size());
+        for (const vector<char>& d : addrDump)
+            cache.apply(d.data(), d.size());
+        cache.getUplink("", a, mac, iface, v4);
+        sink += a.size();
+    }
+    double pollUs = (cpuUs() - start) / polls;
+
+    // getifaddrs() on this host, for reference
+    uint32_t hostAddrs = 0;
+    start = cpuUs();
+    for (uint32_t p = 0; p < polls; ++p) {
+        struct ifaddrs* ifaddr;
+        if (getifaddrs(&ifaddr) == -1)
+            break;
+        hostAddrs = 0;
+        for (struct ifaddrs* ifa = ifaddr; ifa; ifa = ifa->ifa_next)
+            hostAddrs += 1;
+        freeifaddrs(ifaddr);
+    }
+    double hostUs = (cpuUs() - start) / polls;
+
+    // netlink: apply one change at a time to the synced cache
+    InterfaceAddrCache cache;
+    for (const vector<char>& d : linkDump)
+        cache.apply(d.data(), d.size());
+    for (const vector<char>& d : addrDump)
+        cache.apply(d.data(), d.size());
+    vector<vector<char> > changes;
+    std::mt19937 rng(42);
+    for (uint32_t e = 0; e < 1024; ++e) {
+        uint32_t i = 2 + rng() % (veths ? veths : 1);
+        NlBuilder b;
+        switch (e % 3) {
+        case 0:
+            b.link(i + 1, "veth" + std::to_string(i),
+                   (e % 2) ? IFF_UP : 0, macFor(i));
+            break;
+        case 1:
+            b.addr(i + 1, linkLocal(i), RTM_DELADDR);
+            break;
+        default:
+            b.addr(i + 1, linkLocal(i));
+            break;
+        }
+        changes.push_back(std::move(b.buf));
+    }
+    start = cpuUs();
+    for (uint32_t e = 0; e < events; ++e) {
+        const vector<char>& c = changes[e % changes.size()];
+        if (cache.apply(c.data(), c.size()) & InterfaceAddrCache::CHANGED)
+            cache.getUplink("", a, mac, iface, v4);
+        sink += a.size();
+    }
+    double eventUs = (cpuUs() - start) / events;
+
+    double pollMsPerHour = pollUs * (3600 / interval) / 1000;
+    double eventMsPerHour = eventUs * eventRate * 3600 / 1000;
+    std::cout << "{\"benchmark\": \"tunnel_ep\", "
+              << "\"veths\": " << veths << ", "
+              << "\"interval_s\": " << interval << ", "
+              << "\"event_rate\": " << eventRate << ", "
+              << "\"poll_us\": " << pollUs << ", "
+              << "\"event_us\": " << eventUs << ", "
+              << "\"host_getifaddrs_us\": " << hostUs << ", "
+              << "\"host_addrs\": " << hostAddrs << ", "
+              << "\"poll_cpu_ms_per_hour\": " << pollMsPerHour << ", "
+              << "\"netlink_cpu_ms_per_hour\": " << eventMsPerHour << ", "
+              << "\"cpu_ms_saved_per_hour\": "
+              << pollMsPerHour - eventMsPerHour << ", "
+              << "\"uplink\": \"" << (sink ? a : "") << "\"}" << std::endl;
+    return 0;
+}
@@ -85,6 +85,10 @@ int main(int argc, char** argv) {
         ("props,p", "Include object properties in output")
         ("width,w", po::value<int>()->default_value(w.ws_col - 1),
          "Truncate output to the specified number of characters")
+        ("page-size", po::value<size_t>()->default_value(1000),
+         "Retrieve results in pages of at most this many objects, "
+         "writing list and dump output as each page arrives "
+         "(0 to retrieve everything in one reply)")
         ;
 
     bool log_to_syslog = false;
@@ -102,6 +106,7 @@ int main(int argc, char** argv) {
     bool followRefs = false;
     int truncate = 0;
     bool unresolved = false;
+    size_t page_size = 0;
     po::variables_map vm;
     try {
         po::store(po::command_line_parser(argc, argv).
@@ -139,6 +144,7 @@ int main(int argc, char** argv) {
         if (vm.count("query"))
             queries = vm["query"].as<std::vector<string> >();
         truncate = vm["width"].as<int>();
+        page_size = vm["page-size"].as<size_t>();
     } catch (const po::unknown_option& e) {
         std::cerr << e.what() << std::endl;
         return 1;
@@ -167,6 +173,7 @@ int main(int argc, char** argv) {
                                                 modelgbp::getMetadata()));
         client->setRecursive(recursive);
         client->setFollowRefs(followRefs);
+        client->setPageSize(page_size);
 
         if(unresolved) {
             client->setUnresolved(true);
@@ -196,9 +203,6 @@ int main(int argc, char** argv) {
             client->loadFromFile(inf);
         }
 
-        if (queries.size() > 0)
-            client->execute();
-
         FILE* outf = stdout;
         if (out_file != "") {
             outf = fopen(out_file.c_str(), "w");
@@ -210,14 +214,32 @@ int main(int argc, char** argv) {
         }
         stream<file_descriptor_sink> outs(fileno(outf), close_handle);
 
-        if (type == "dump")
-            client->dumpToFile(outf);
-        else if (type == "list")
-            client->prettyPrint(outs, false, props, true, truncate);
-        else if (type == "asciitree")
-            client->prettyPrint(outs, true, props, false, truncate);
-        else
-            client->prettyPrint(outs, true, props, true, truncate);
+        // list and dump output do not need the whole result in memory,
+        // so write each page out as it arrives.  Following references
+        // needs the objects already retrieved, so keep everything then.
+        bool streaming = page_size > 0 && load_file == "" &&
+            !followRefs && !unresolved &&
+            (type == "list" || type == "dump");
+        if (streaming) {
+            if (type == "dump")
+                client->setStreamDump(outf);
+            else
+                client->setStreamOutput(&outs, props, true, truncate);
+        }
+
+        if (queries.size() > 0)
+            client->execute();
+
+        if (!streaming) {
+            if (type == "dump")
+                client->dumpToFile(outf);
+            else if (type == "list")
+                client->prettyPrint(outs, false, props, true, truncate);
+            else if (type == "asciitree")
+                client->prettyPrint(outs, true, props, false, truncate);
+            else
+                client->prettyPrint(outs, true, props, true, truncate);
+        }
 
         fclose(outf);
 
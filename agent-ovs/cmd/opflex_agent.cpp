@@ -237,6 +237,8 @@ int main(int argc, char** argv) {
              "Use the specified log level (default info). "
              "Overridden by log level in configuration file")
             ("syslog", "Log to syslog instead of file or standard out")
+            ("log-async", "Write log messages from a background thread "
+             "so that logging never blocks the agent")
             ("daemon", "Run the agent as a daemon");
     } catch (const boost::bad_lexical_cast& e) {
         std::cerr << e.what() << std::endl;
@@ -246,6 +248,7 @@ int main(int argc, char** argv) {
     bool daemon = false;
     bool watch = false;
     bool logToSyslog = false;
+    bool logAsync = false;
     std::string log_file;
     std::string level_str;
 
@@ -276,6 +279,9 @@ int main(int argc, char** argv) {
         if (vm.count("syslog")) {
             logToSyslog = true;
         }
+        if (vm.count("log-async")) {
+            logAsync = true;
+        }
     } catch (const po::unknown_option& e) {
         std::cerr << e.what() << std::endl;
         return 2;
@@ -288,6 +294,8 @@ int main(int argc, char** argv) {
         daemonize();
 
     initLogging(level_str, logToSyslog, log_file);
+    if (logAsync)
+        startAsyncLogging();
 
     // Initialize agent and configuration
     std::vector<string> configFiles;
@@ -320,7 +328,11 @@ int main(int argc, char** argv) {
         });
 
     int rc = launcher.run();
-    if (rc) exit(rc);
+    if (rc) {
+        stopAsyncLogging();
+        exit(rc);
+    }
     signal_thread.join();
+    stopAsyncLogging();
     return 0;
 }
@@ -190,12 +190,15 @@ void Agent::setProperties(const boost::property_tree::ptree& properties) {
     static const std::string OPFLEX_STATS_MODE("opflex.statistics.mode");
     static const std::string OPFLEX_STATS_INTERFACE_SETTING("opflex.statistics.interface.enabled");
     static const std::string OPFLEX_STATS_INTERFACE_INTERVAL("opflex.statistics.interface.interval");
+    static const std::string OPFLEX_STATS_INTERFACE_MODB_INTERVAL("opflex.statistics.interface.modb-interval");
     static const std::string OPFLEX_STATS_CONTRACT_SETTING("opflex.statistics.contract.enabled");
     static const std::string OPFLEX_STATS_CONTRACT_INTERVAL("opflex.statistics.contract.interval");
     static const std::string OPFLEX_STATS_SECGRP_SETTING("opflex.statistics.security-group.enabled");
     static const std::string OPFLEX_STATS_SECGRP_INTERVAL("opflex.statistics.security-group.interval");
     static const std::string OPFLEX_PRR_INTERVAL("opflex.timers.prr");
     static const std::string OPFLEX_HANDSHAKE("opflex.timers.handshake-timeout");
+    static const std::string OPFLEX_COMPRESSION("opflex.compression");
+    static const std::string OPFLEX_PRIMARY_ROUTING("opflex.primary-routing");
     static const std::string DISABLED_FEATURES("feature.disabled");
     static const std::string BEHAVIOR_L34FLOWS_WITHOUT_SUBNET("behavior.l34flows-without-subnet");
 
@@ -483,6 +486,35 @@ void Agent::setProperties(const boost::property_tree::ptree& properties) {
         LOG(INFO) << "peer handshake timeout set to " << peerHandshakeTimeout << " ms";
     }
 
+    boost::optional<long> epCounterModbOpt =
+        properties.get_optional<long>(OPFLEX_STATS_INTERFACE_MODB_INTERVAL);
+    if (epCounterModbOpt) {
+        long interval = epCounterModbOpt.get();
+        endpointManager.setCounterPublishInterval(interval < 0 ? -1 :
+                                                  interval * 1000);
+        if (interval < 0)
+            LOG(INFO) << "endpoint counter publishing to MODB disabled";
+        else
+            LOG(INFO) << "endpoint counter MODB interval set to "
+                      << interval << " secs";
+    }
+
+    boost::optional<bool> compressionOpt =
+        properties.get_optional<bool>(OPFLEX_COMPRESSION);
+    if (compressionOpt) {
+        opflexCompression = compressionOpt.get();
+        LOG(INFO) << "opflex compression "
+                  << (opflexCompression ? "enabled" : "disabled");
+    }
+
+    boost::optional<bool> primaryRoutingOpt =
+        properties.get_optional<bool>(OPFLEX_PRIMARY_ROUTING);
+    if (primaryRoutingOpt) {
+        opflexPrimaryRouting = primaryRoutingOpt.get();
+        LOG(INFO) << "opflex primary routing "
+                  << (opflexPrimaryRouting ? "enabled" : "disabled");
+    }
+
     LOG(INFO) << "Agent mode set to " <<
        ((this->rendererFwdMode == opflex::ofcore::OFConstants::TRANSPORT_MODE)?
         "transport-mode" : "stitched-mode");
@@ -548,6 +580,8 @@ void Agent::applyProperties() {
      
     framework.setPrrTimerDuration(prr_timer);
     framework.setHandshakeTimeout(peerHandshakeTimeout);
+    framework.setCompression(opflexCompression);
+    framework.setPrimaryRouting(opflexPrimaryRouting);
 }
 
 void Agent::start() {
@@ -33,38 +33,35 @@ const std::string &AgentLogHandler::getLevelString() {
     return logLevelStr;
 }
 
-void AgentLogHandler::handleMessage(const std::string& file,
-                                   const int line,
-                                   const std::string& function,
-                                   const Level level,
-                                   const std::string& message) {
-    opflexagent::LogLevel agentLevel = opflexagent::INFO;
+LogLevel AgentLogHandler::toAgentLevel(Level level) {
     switch (level) {
     case OFLogHandler::TRACE:
-        agentLevel = opflexagent::TRACE;
-        break;
+        return opflexagent::TRACE;
     case OFLogHandler::DEBUG5:
     case OFLogHandler::DEBUG4:
     case OFLogHandler::DEBUG3:
     case OFLogHandler::DEBUG2:
     case OFLogHandler::DEBUG1:
     case OFLogHandler::DEBUG0:
-        agentLevel = opflexagent::DEBUG;
-        break;
+        return opflexagent::DEBUG;
     case OFLogHandler::INFO:
-        agentLevel = opflexagent::INFO;
-        break;
+        return opflexagent::INFO;
     case OFLogHandler::WARNING:
-        agentLevel = opflexagent::WARNING;
-        break;
+        return opflexagent::WARNING;
     case OFLogHandler::ERROR:
-        agentLevel = opflexagent::ERROR;
-        break;
+        return opflexagent::ERROR;
     default:
     case OFLogHandler::FATAL:
-        agentLevel = opflexagent::FATAL;
-        break;
+        return opflexagent::FATAL;
     }
+}
+
+void AgentLogHandler::handleMessage(const std::string& file,
+                                   const int line,
+                                   const std::string& function,
+                                   const Level level,
+                                   const std::string& message) {
+    opflexagent::LogLevel agentLevel = toAgentLevel(level);
     LOG1(agentLevel, file.c_str(), line, function.c_str(), message);
 }
 
@@ -16,9 +16,54 @@
 #include <boost/functional/hash.hpp>
 
 #include <opflexagent/Endpoint.h>
+#include <opflexagent/logging.h>
 
 namespace opflexagent {
 
+static void addIPPrefix(const std::string& ip,
+                        std::vector<network::ip_prefix>& prefixes) {
+    network::ip_prefix prefix;
+    if (!network::ip_prefix::from_string(ip, prefix, false)) {
+        LOG(WARNING) << "Invalid endpoint IP: " << ip;
+        return;
+    }
+    prefixes.push_back(prefix);
+}
+
+void Endpoint::setIPs(const std::unordered_set<std::string>& ips) {
+    this->ips = ips;
+    ipPrefixes.clear();
+    for (const std::string& ip : ips)
+        addIPPrefix(ip, ipPrefixes);
+}
+
+void Endpoint::addIP(const std::string& ip) {
+    if (this->ips.insert(ip).second)
+        addIPPrefix(ip, ipPrefixes);
+}
+
+static void addAnycastAddr(const std::string& ip,
+                           std::vector<network::ip_addr>& addrs) {
+    network::ip_addr addr;
+    if (!network::ip_addr::from_string(ip, addr)) {
+        LOG(WARNING) << "Invalid anycast return IP: " << ip;
+        return;
+    }
+    addrs.push_back(addr);
+}
+
+void Endpoint::setAnycastReturnIPs(const std::unordered_set<std::string>& ips) {
+    this->anycastReturnIps = ips;
+    anycastReturnAddrs.clear();
+    for (const std::string& ip : ips)
+        addAnycastAddr(ip, anycastReturnAddrs);
+}
+
+void Endpoint::addAnycastReturnIP(const std::string& ip) {
+    if (this->anycastReturnIps.insert(ip).second)
+        addAnycastAddr(ip, anycastReturnAddrs);
+}
+
 std::ostream & operator<<(std::ostream &os, const Endpoint& ep) {
     using boost::algorithm::join;
 
@@ -0,0 +1,68 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for EndpointHandleTable class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/EndpointIndex.h>
+
+namespace opflexagent {
+
+const size_t EndpointHandleTable::CHUNK_SIZE;
+
+EndpointHandleTable::EndpointHandleTable()
+    : table(std::make_shared<table_t>()), nextHandle(0) {}
+
+std::string& EndpointHandleTable::slot(handle_t handle) {
+    // copy the parts of the table that a snapshot still references
+    if (!isUnique(table))
+        table = std::make_shared<table_t>(*table);
+    size_t c = handle / CHUNK_SIZE;
+    if (c == table->size())
+        table->push_back(std::make_shared<chunk_t>());
+    std::shared_ptr<chunk_t>& chunk = (*table)[c];
+    if (!isUnique(chunk))
+        chunk = std::make_shared<chunk_t>(*chunk);
+    return (*chunk)[handle % CHUNK_SIZE];
+}
+
+EndpointHandleTable::handle_t
+EndpointHandleTable::acquire(const std::string& uuid) {
+    auto r = refs.emplace(uuid, std::make_pair(handle_t(0), 0u));
+    std::pair<handle_t, uint32_t>& ref = r.first->second;
+    if (r.second) {
+        if (freeHandles.empty()) {
+            ref.first = nextHandle++;
+        } else {
+            ref.first = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        slot(ref.first) = uuid;
+    }
+    ref.second += 1;
+    return ref.first;
+}
+
+void EndpointHandleTable::release(handle_t handle) {
+    auto it = refs.find(get(handle));
+    if (it == refs.end()) return;
+    if (--it->second.second > 0) return;
+    refs.erase(it);
+    std::string().swap(slot(handle));
+    freeHandles.push_back(handle);
+}
+
+bool EndpointHandleTable::find(const std::string& uuid,
+                               /* out */ handle_t& handle) const {
+    auto it = refs.find(uuid);
+    if (it == refs.end()) return false;
+    handle = it->second.first;
+    return true;
+}
+
+} /* namespace opflexagent */
@@ -64,7 +64,14 @@ EndpointManager::EndpointManager(Agent& agent_,
                                  PolicyManager& policyManager_,
                                  PrometheusManager& prometheusManager_)
     : agent(agent_), framework(framework_), policyManager(policyManager_),
-      prometheusManager(prometheusManager_), epgMappingListener(*this) {
+      prometheusManager(prometheusManager_),
+      epCounterRegistry(EP_COUNTER_MAX), counterPublishInterval(0),
+      group_ep_map(ep_handles), group_remote_ep_map(ep_handles),
+      secgrp_ep_map(ep_handles), ipm_group_ep_map(ep_handles),
+      iface_ep_map(ep_handles), access_iface_ep_map(ep_handles),
+      access_uplink_ep_map(ep_handles), ipm_nexthop_if_ep_map(ep_handles),
+      epgmapping_ep_map(ep_handles),
+      epgMappingListener(*this) {
 
 }
 #else
@@ -72,6 +79,12 @@ EndpointManager::EndpointManager(Agent& agent_,
                                  opflex::ofcore::OFFramework& framework_,
                                  PolicyManager& policyManager_)
     : agent(agent_), framework(framework_), policyManager(policyManager_),
+      epCounterRegistry(EP_COUNTER_MAX), counterPublishInterval(0),
+      group_ep_map(ep_handles), group_remote_ep_map(ep_handles),
+      secgrp_ep_map(ep_handles), ipm_group_ep_map(ep_handles),
+      iface_ep_map(ep_handles), access_iface_ep_map(ep_handles),
+      access_uplink_ep_map(ep_handles), ipm_nexthop_if_ep_map(ep_handles),
+      epgmapping_ep_map(ep_handles),
       epgMappingListener(*this) {
 
 }
@@ -217,15 +230,10 @@ static void updateEpMap(const optional<std::string>& oldVal,
                         T& val_map,
                         const std::string& uuid) {
     if (oldVal != val) {
-        if (oldVal) {
-            unordered_set<string>& eps = val_map[oldVal.get()];
-            eps.erase(uuid);
-            if (eps.empty())
-                val_map.erase(oldVal.get());
-        }
-        if (val) {
-            val_map[val.get()].insert(uuid);
-        }
+        if (oldVal)
+            val_map.erase(oldVal.get(), uuid);
+        if (val)
+            val_map.insert(val.get(), uuid);
     }
 }
 
@@ -253,21 +261,12 @@ void EndpointManager::updateEndpoint(const Endpoint& endpoint) {
     const set<URI>& oldSecGroups = es.endpoint->getSecurityGroups();
     const set<URI>& secGroups = endpoint.getSecurityGroups();
     if (secGroups != oldSecGroups) {
-        secgrp_ep_map_t::iterator it = secgrp_ep_map.find(oldSecGroups);
-        if (it != secgrp_ep_map.end()) {
-            it->second.erase(uuid);
-
-            if (it->second.empty()) {
-                secgrp_ep_map.erase(it);
-                notifySecGroupSets.insert(oldSecGroups);
-            }
-        }
+        if (secgrp_ep_map.erase(oldSecGroups, uuid) &&
+            !secgrp_ep_map.contains(oldSecGroups))
+            notifySecGroupSets.insert(oldSecGroups);
     }
-    str_uset_t& ep_set = secgrp_ep_map[secGroups];
-    if (ep_set.find(uuid) == ep_set.end()) {
-        ep_set.insert(uuid);
+    if (secgrp_ep_map.insert(secGroups, uuid))
         notifySecGroupSets.insert(secGroups);
-    }
 
     // update interface name to endpoint mapping
     const optional<std::string>& oldIface = es.endpoint->getInterfaceName();
@@ -289,16 +288,12 @@ void EndpointManager::updateEndpoint(const Endpoint& endpoint) {
     for (const Endpoint::IPAddressMapping& ipm :
              es.endpoint->getIPAddressMappings()) {
         if (!ipm.getNextHopIf()) continue;
-        unordered_set<string>& eps =
-            ipm_nexthop_if_ep_map[ipm.getNextHopIf().get()];
-        eps.erase(uuid);
-        if (eps.empty())
-            ipm_nexthop_if_ep_map.erase(ipm.getNextHopIf().get());
+        ipm_nexthop_if_ep_map.erase(ipm.getNextHopIf().get(), uuid);
     }
     for (const Endpoint::IPAddressMapping& ipm :
              endpoint.getIPAddressMappings()) {
         if (!ipm.getNextHopIf()) continue;
-        ipm_nexthop_if_ep_map[ipm.getNextHopIf().get()].insert(uuid);
+        ipm_nexthop_if_ep_map.insert(ipm.getNextHopIf().get(), uuid);
     }
 
     // update epg mapping alias to endpoint mapping
@@ -386,40 +381,26 @@ void EndpointManager::removeEndpoint(const std::string& uuid) {
             L3Ep::remove(framework, l3ep);
         }
         EpCounter::remove(framework, uuid);
+        removeEndpointCounters(uuid);
         if (es.egURI) {
-            group_ep_map_t::iterator it = group_ep_map.find(es.egURI.get());
-            if (it != group_ep_map.end()) {
-                it->second.erase(uuid);
-                if (it->second.empty()) {
-                    group_ep_map.erase(it);
-                    if(es.endpoint->isExternal()){
-                        notifyExtDomSets.insert(es.egURI.get());
-                        local_ext_dom_map.erase(es.egURI.get());
-                    }
+            if (group_ep_map.erase(es.egURI.get(), uuid) &&
+                !group_ep_map.contains(es.egURI.get())) {
+                if(es.endpoint->isExternal()){
+                    notifyExtDomSets.insert(es.egURI.get());
+                    local_ext_dom_map.erase(es.egURI.get());
                 }
             }
         }
 
         {
             const set<URI>& secGroups = es.endpoint->getSecurityGroups();
-            secgrp_ep_map_t::iterator sgit = secgrp_ep_map.find(secGroups);
-            if (sgit != secgrp_ep_map.end())
-                sgit->second.erase(uuid);
-
-            if (sgit->second.empty()) {
-                secgrp_ep_map.erase(sgit);
+            if (secgrp_ep_map.erase(secGroups, uuid) &&
+                !secgrp_ep_map.contains(secGroups))
                 notifySecGroupSets.insert(secGroups);
-            }
         }
 
         for (const URI& ipmGrp : es.ipMappingGroups) {
-            group_ep_map_t::iterator it = ipm_group_ep_map.find(ipmGrp);
-            if (it != ipm_group_ep_map.end()) {
-                it->second.erase(uuid);
-                if (it->second.empty()) {
-                    ipm_group_ep_map.erase(it);
-                }
-            }
+            ipm_group_ep_map.erase(ipmGrp, uuid);
         }
 
         updateEpMap(es.endpoint->getInterfaceName(), boost::none,
@@ -432,11 +413,7 @@ void EndpointManager::removeEndpoint(const std::string& uuid) {
         for (const Endpoint::IPAddressMapping& ipm :
                  es.endpoint->getIPAddressMappings()) {
             if (!ipm.getNextHopIf()) continue;
-            unordered_set<string>& eps =
-                ipm_nexthop_if_ep_map[ipm.getNextHopIf().get()];
-            eps.erase(uuid);
-            if (eps.empty())
-                ipm_nexthop_if_ep_map.erase(ipm.getNextHopIf().get());
+            ipm_nexthop_if_ep_map.erase(ipm.getNextHopIf().get(), uuid);
         }
 
         updateEpMap(es.endpoint->getEgMappingAlias(), boost::none,
@@ -545,7 +522,7 @@ void EndpointManager::updateEndpointRemote(const opflex::modb::URI& uri) {
             uuid = it->second;
             auto git = remote_ep_group_map.find(uuid.get());
             if (git != remote_ep_group_map.end()) {
-                group_remote_ep_map.erase(git->second);
+                group_remote_ep_map.erase(git->second, uuid.get());
                 remote_ep_group_map.erase(git);
             }
             remote_ep_uuid_map.erase(it);
@@ -565,15 +542,10 @@ void EndpointManager::updateEndpointRemote(const opflex::modb::URI& uri) {
             oldEgUri = uit->second;
 
         if (oldEgUri != egUri) {
-            if (oldEgUri) {
-                unordered_set<string>& eps =
-                    group_remote_ep_map[oldEgUri.get()];
-                eps.erase(uuid.get());
-                if (eps.empty())
-                    group_remote_ep_map.erase(oldEgUri.get());
-            }
+            if (oldEgUri)
+                group_remote_ep_map.erase(oldEgUri.get(), uuid.get());
             if (egUri) {
-                group_remote_ep_map[egUri.get()].insert(uuid.get());
+                group_remote_ep_map.insert(egUri.get(), uuid.get());
                 remote_ep_group_map.emplace(uuid.get(), egUri.get());
             } else {
                 remote_ep_group_map.erase(uuid.get());
@@ -603,21 +575,12 @@ void EndpointManager::updateEndpointExternal(const Endpoint& endpoint) {
     const set<URI>& oldSecGroups = es.endpoint->getSecurityGroups();
     const set<URI>& secGroups = endpoint.getSecurityGroups();
     if (secGroups != oldSecGroups) {
-        secgrp_ep_map_t::iterator it = secgrp_ep_map.find(oldSecGroups);
-        if (it != secgrp_ep_map.end()) {
-            it->second.erase(uuid);
-
-            if (it->second.empty()) {
-                secgrp_ep_map.erase(it);
-                notifySecGroupSets.insert(oldSecGroups);
-            }
-        }
+        if (secgrp_ep_map.erase(oldSecGroups, uuid) &&
+            !secgrp_ep_map.contains(oldSecGroups))
+            notifySecGroupSets.insert(oldSecGroups);
     }
-    str_uset_t& ep_set = secgrp_ep_map[secGroups];
-    if (ep_set.find(uuid) == ep_set.end()) {
-        ep_set.insert(uuid);
+    if (secgrp_ep_map.insert(secGroups, uuid))
         notifySecGroupSets.insert(secGroups);
-    }
 
     // update endpoint group to endpoint mapping
     const optional<URI>& oldEgURI = es.egURI;
@@ -625,15 +588,10 @@ void EndpointManager::updateEndpointExternal(const Endpoint& endpoint) {
     optional<URI> egURI = endpoint.getEgURI();
    // update endpoint group to endpoint mapping
     if(oldEgURI != egURI) {
-        if (oldEgURI) {
-            unordered_set<string>& eps = group_ep_map[oldEgURI.get()];
-            eps.erase(uuid);
-            if (eps.empty())
-                group_ep_map.erase(oldEgURI.get());
-        }
-        if (egURI) {
-            group_ep_map[egURI.get()].insert(uuid);
-        }
+        if (oldEgURI)
+            group_ep_map.erase(oldEgURI.get(), uuid);
+        if (egURI)
+            group_ep_map.insert(egURI.get(), uuid);
         es.egURI = egURI;
     }
 
@@ -748,6 +706,7 @@ void EndpointManager::removeEndpointExternal(const std::string& uuid) {
 #endif
         ExternalL3Ep::remove(framework, uuid);
         EpCounter::remove(framework, uuid);
+        removeEndpointCounters(uuid);
         rd = policyManager.getRDForExternalInterface(
                 es.endpoint->getExtInterfaceURI().get());
         if(rd) {
@@ -760,25 +719,13 @@ void EndpointManager::removeEndpointExternal(const std::string& uuid) {
                 }
             }
         }
-        if (es.egURI) {
-            group_ep_map_t::iterator it = group_ep_map.find(es.egURI.get());
-            if (it != group_ep_map.end()) {
-                it->second.erase(uuid);
-                if (it->second.empty()) {
-                    group_ep_map.erase(it);
-                }
-            }
-        }
+        if (es.egURI)
+            group_ep_map.erase(es.egURI.get(), uuid);
         {
             const set<URI>& secGroups = es.endpoint->getSecurityGroups();
-            secgrp_ep_map_t::iterator sgit = secgrp_ep_map.find(secGroups);
-            if (sgit != secgrp_ep_map.end())
-                sgit->second.erase(uuid);
-
-            if (sgit->second.empty()) {
-                secgrp_ep_map.erase(sgit);
+            if (secgrp_ep_map.erase(secGroups, uuid) &&
+                !secgrp_ep_map.contains(secGroups))
                 notifySecGroupSets.insert(secGroups);
-            }
         }
         updateEpMap(es.endpoint->getInterfaceName(), boost::none,
                     iface_ep_map, uuid);
@@ -821,10 +768,8 @@ bool EndpointManager::updateEndpointLocal(const std::string& uuid,
 
     if (oldEgURI != egURI) {
         if (oldEgURI) {
-            unordered_set<string>& eps = group_ep_map[oldEgURI.get()];
-            eps.erase(uuid);
-            if (eps.empty()) {
-                group_ep_map.erase(oldEgURI.get());
+            group_ep_map.erase(oldEgURI.get(), uuid);
+            if (!group_ep_map.contains(oldEgURI.get())) {
                 auto it = local_ext_dom_map.find(oldEgURI.get());
                 if(it != local_ext_dom_map.end()) {
                     local_ext_dom_map.erase(it);
@@ -835,7 +780,7 @@ bool EndpointManager::updateEndpointLocal(const std::string& uuid,
             }
         }
         if (egURI) {
-            group_ep_map[egURI.get()].insert(uuid);
+            group_ep_map.insert(egURI.get(), uuid);
         }
         if(es.endpoint->isExternal()) {
             auto it = local_ext_dom_map.find(egURI.get());
@@ -972,15 +917,11 @@ bool EndpointManager::updateEndpointLocal(const std::string& uuid,
 
     // Update IP address mapping group map
     for (const URI& ipmGrp : newipmgroups) {
-        ipm_group_ep_map[ipmGrp].insert(uuid);
+        ipm_group_ep_map.insert(ipmGrp, uuid);
     }
     for (const URI& ipmGrp : es.ipMappingGroups) {
-        if (newipmgroups.find(ipmGrp) == newipmgroups.end()) {
-            unordered_set<string>& eps = ipm_group_ep_map[ipmGrp];
-            eps.erase(uuid);
-            if (eps.empty())
-                ipm_group_ep_map.erase(ipmGrp);
-        }
+        if (newipmgroups.find(ipmGrp) == newipmgroups.end())
+            ipm_group_ep_map.erase(ipmGrp, uuid);
     }
     es.ipMappingGroups = newipmgroups;
 
@@ -1229,27 +1170,16 @@ void EndpointManager::egDomainUpdated(const URI& egURI) {
     unordered_set<string> remoteNotify;
     unique_lock<mutex> guard(ep_mutex);
 
-    group_ep_map_t::const_iterator it = group_ep_map.find(egURI);
-    if (it != group_ep_map.end()) {
-        for (const std::string& uuid : it->second) {
-            if (updateEndpointReg(uuid))
-                notify.insert(uuid);
-        }
+    for (const std::string& uuid : group_ep_map.get(egURI)) {
+        if (updateEndpointReg(uuid))
+            notify.insert(uuid);
     }
 
-    group_ep_map_t::const_iterator rit = group_remote_ep_map.find(egURI);
-    if (rit != group_remote_ep_map.end()) {
-        for (const std::string& uuid : rit->second) {
-            remoteNotify.insert(uuid);
-        }
-    }
+    group_remote_ep_map.get(egURI, remoteNotify);
 
-    it = ipm_group_ep_map.find(egURI);
-    if (it != ipm_group_ep_map.end()) {
-        for (const std::string& uuid : it->second) {
-            if (updateEndpointReg(uuid))
-                notify.insert(uuid);
-        }
+    for (const std::string& uuid : ipm_group_ep_map.get(egURI)) {
+        if (updateEndpointReg(uuid))
+            notify.insert(uuid);
     }
     guard.unlock();
 
@@ -1264,17 +1194,17 @@ void EndpointManager::egDomainUpdated(const URI& egURI) {
 void EndpointManager::externalInterfaceUpdated(const URI& extIntURI) {
     using namespace modelgbp::gbp;
     unique_lock<mutex> guard(ep_mutex);
-    group_ep_map_t::const_iterator gep_it = group_ep_map.find(extIntURI);
+    EndpointUUIDView eps = group_ep_map.get(extIntURI);
     optional<shared_ptr<RoutingDomain>> rd;
     unordered_set<string> notify;
     rd = policyManager.getRDForExternalInterface(extIntURI);
     if(!rd)
         return;
     ipmac_map_t &ip_mac_map = adj_ep_map[rd.get()->getURI()];
-    if (gep_it == group_ep_map.end()) {
+    if (eps.empty()) {
         return;
     }
-    for (const std::string& uuid : gep_it->second) {
+    for (const std::string& uuid : eps) {
         auto eep_it = ext_ep_map.find(uuid);
         if (eep_it != ext_ep_map.end()) {
             notify.insert(uuid);
@@ -1305,38 +1235,27 @@ bool EndpointManager::getAdjacency(const URI& rdURI,
     return true;
 }
 
-template <typename K, typename M>
-static void getEps(const K& key, const M& map,
-                   /* out */ unordered_set<string>& eps) {
-    auto it = map.find(key);
-    if (it != map.end()) {
-        eps.insert(it->second.begin(), it->second.end());
-    }
-}
-
-template <typename M>
-static void getEps(const M& map, /* out */ unordered_set<string>& eps) {
-    for (const auto& elem : map) {
-        eps.insert(elem.second.begin(), elem.second.end());
-    }
-}
-
 void EndpointManager::getEndpointsForGroup(const URI& egURI,
                                            /*out*/ unordered_set<string>& eps) {
     unique_lock<mutex> guard(ep_mutex);
-    getEps(egURI, group_ep_map, eps);
+    group_ep_map.get(egURI, eps);
+}
+
+EndpointUUIDView EndpointManager::getEndpointsForGroup(const URI& egURI) {
+    unique_lock<mutex> guard(ep_mutex);
+    return group_ep_map.get(egURI);
 }
 
 bool EndpointManager::secGrpSetEmpty(const uri_set_t& secGrps) {
     unique_lock<mutex> guard(ep_mutex);
-    return secgrp_ep_map.find(secGrps) == secgrp_ep_map.end();
+    return !secgrp_ep_map.contains(secGrps);
 }
 
 void EndpointManager::
 getSecGrpSetsForSecGrp(const URI& secGrp,
                        /* out */ unordered_set<uri_set_t>& result) {
     unique_lock<mutex> guard(ep_mutex);
-    for (const secgrp_ep_map_t::value_type& v : secgrp_ep_map) {
+    for (const auto& v : secgrp_ep_map) {
         if (v.first.find(secGrp) != v.first.end())
             result.insert(v.first);
     }
@@ -1345,13 +1264,24 @@ getSecGrpSetsForSecGrp(const URI& secGrp,
 void EndpointManager::getEndpointsForIPMGroup(const URI& egURI,
                                               unordered_set<string>& eps) {
     unique_lock<mutex> guard(ep_mutex);
-    getEps(egURI, ipm_group_ep_map, eps);
+    ipm_group_ep_map.get(egURI, eps);
+}
+
+EndpointUUIDView EndpointManager::getEndpointsForIPMGroup(const URI& egURI) {
+    unique_lock<mutex> guard(ep_mutex);
+    return ipm_group_ep_map.get(egURI);
 }
 
 void EndpointManager::getEndpointsByIface(const std::string& ifaceName,
                                           /* out */ str_uset_t& eps) {
     unique_lock<mutex> guard(ep_mutex);
-    getEps(ifaceName, iface_ep_map, eps);
+    iface_ep_map.get(ifaceName, eps);
+}
+
+EndpointUUIDView
+EndpointManager::getEndpointsByIface(const std::string& ifaceName) {
+    unique_lock<mutex> guard(ep_mutex);
+    return iface_ep_map.get(ifaceName);
 }
 
 const ip_ep_map_t& EndpointManager::getIPLocalEpMap (void) {
@@ -1359,27 +1289,42 @@ const ip_ep_map_t& EndpointManager::getIPLocalEpMap (void) {
     return ip_local_ep_map;
 }
 
+shared_ptr<const Endpoint>
+EndpointManager::getLocalEndpointByIP(const std::string& ip) {
+    unique_lock<mutex> guard(ep_mutex);
+    auto it = ip_local_ep_map.find(ip);
+    if (it == ip_local_ep_map.end())
+        return shared_ptr<const Endpoint>();
+    return it->second;
+}
+
 void EndpointManager::getEndpointUUIDs( /* out */ str_uset_t& eps) {
     unique_lock<mutex> guard(ep_mutex);
-    getEps(iface_ep_map, eps);
+    iface_ep_map.getAll(eps);
 }
 
 void EndpointManager::getEndpointsByAccessIface(const std::string& ifaceName,
                                                 /* out */ str_uset_t& eps) {
     unique_lock<mutex> guard(ep_mutex);
-    getEps(ifaceName, access_iface_ep_map, eps);
+    access_iface_ep_map.get(ifaceName, eps);
+}
+
+EndpointUUIDView
+EndpointManager::getEndpointsByAccessIface(const std::string& ifaceName) {
+    unique_lock<mutex> guard(ep_mutex);
+    return access_iface_ep_map.get(ifaceName);
 }
 
 void EndpointManager::getEndpointsByAccessUplink(const std::string& ifaceName,
                                                  /* out */ str_uset_t& eps) {
     unique_lock<mutex> guard(ep_mutex);
-    getEps(ifaceName, access_uplink_ep_map, eps);
+    access_uplink_ep_map.get(ifaceName, eps);
 }
 
 void EndpointManager::getEndpointsByIpmNextHopIf(const std::string& ifaceName,
                                                  /* out */ str_uset_t& eps) {
     unique_lock<mutex> guard(ep_mutex);
-    getEps(ifaceName, ipm_nexthop_if_ep_map, eps);
+    ipm_nexthop_if_ep_map.get(ifaceName, eps);
 }
 
 void EndpointManager::getLocalExternalDomains(std::unordered_set<opflex::modb::URI>& domain) {
@@ -1404,31 +1349,85 @@ uint32_t EndpointManager::getExtEncapId(const opflex::modb::URI& epgURI) {
     return 0;
 }
 
+void EndpointManager::setCounterPublishInterval(long interval) {
+    unique_lock<mutex> guard(counter_mutex);
+    counterPublishInterval = interval;
+    counterPublishTimes.clear();
+}
+
+bool EndpointManager::shouldPublishCounters(const std::string& uuid) {
+    unique_lock<mutex> guard(counter_mutex);
+    if (counterPublishInterval < 0)
+        return false;
+    if (counterPublishInterval == 0)
+        return true;
+    auto now = std::chrono::steady_clock::now();
+    auto r = counterPublishTimes.emplace(uuid, now);
+    if (r.second)
+        return true;
+    if (now - r.first->second <
+        std::chrono::milliseconds(counterPublishInterval))
+        return false;
+    r.first->second = now;
+    return true;
+}
+
+void EndpointManager::removeEndpointCounters(const std::string& uuid) {
+    epCounterRegistry.remove(uuid);
+    unique_lock<mutex> guard(counter_mutex);
+    counterPublishTimes.erase(uuid);
+}
+
 void EndpointManager::updateEndpointCounters(const std::string& uuid,
                                              EpCounters& newVals) {
     using namespace modelgbp::gbpe;
     using namespace modelgbp::observer;
 
-    Mutator mutator(framework, "policyelement");
-    optional<shared_ptr<EpStatUniverse> > su =
-        EpStatUniverse::resolve(framework);
-    if (su) {
-        su.get()->addGbpeEpCounter(uuid)
-            ->setRxPackets(newVals.rxPackets)
-            .setTxPackets(newVals.txPackets)
-            .setRxDrop(newVals.rxDrop)
-            .setTxDrop(newVals.txDrop)
-            .setRxBroadcast(newVals.rxBroadcast)
-            .setTxBroadcast(newVals.txBroadcast)
-            .setRxMulticast(newVals.rxMulticast)
-            .setTxMulticast(newVals.txMulticast)
-            .setRxUnicast(newVals.rxUnicast)
-            .setTxUnicast(newVals.txUnicast)
-            .setRxBytes(newVals.rxBytes)
-            .setTxBytes(newVals.txBytes);
+    MetricsRegistry::id_t id;
+    {
+        // Counters read before an endpoint was removed can arrive
+        // after it; only register rows for endpoints that still exist
+        unique_lock<mutex> guard(ep_mutex);
+        if (ep_map.find(uuid) == ep_map.end() &&
+            ext_ep_map.find(uuid) == ext_ep_map.end())
+            return;
+        id = epCounterRegistry.getId(uuid);
+    }
+    epCounterRegistry.set(id, EP_RX_BYTES, newVals.rxBytes);
+    epCounterRegistry.set(id, EP_RX_PKTS, newVals.rxPackets);
+    epCounterRegistry.set(id, EP_RX_DROPS, newVals.rxDrop);
+    epCounterRegistry.set(id, EP_RX_UCAST, newVals.rxUnicast);
+    epCounterRegistry.set(id, EP_RX_MCAST, newVals.rxMulticast);
+    epCounterRegistry.set(id, EP_RX_BCAST, newVals.rxBroadcast);
+    epCounterRegistry.set(id, EP_TX_BYTES, newVals.txBytes);
+    epCounterRegistry.set(id, EP_TX_PKTS, newVals.txPackets);
+    epCounterRegistry.set(id, EP_TX_DROPS, newVals.txDrop);
+    epCounterRegistry.set(id, EP_TX_UCAST, newVals.txUnicast);
+    epCounterRegistry.set(id, EP_TX_MCAST, newVals.txMulticast);
+    epCounterRegistry.set(id, EP_TX_BCAST, newVals.txBroadcast);
+
+    if (shouldPublishCounters(uuid)) {
+        Mutator mutator(framework, "policyelement");
+        optional<shared_ptr<EpStatUniverse> > su =
+            EpStatUniverse::resolve(framework);
+        if (su) {
+            su.get()->addGbpeEpCounter(uuid)
+                ->setRxPackets(newVals.rxPackets)
+                .setTxPackets(newVals.txPackets)
+                .setRxDrop(newVals.rxDrop)
+                .setTxDrop(newVals.txDrop)
+                .setRxBroadcast(newVals.rxBroadcast)
+                .setTxBroadcast(newVals.txBroadcast)
+                .setRxMulticast(newVals.rxMulticast)
+                .setTxMulticast(newVals.txMulticast)
+                .setRxUnicast(newVals.rxUnicast)
+                .setTxUnicast(newVals.txUnicast)
+                .setRxBytes(newVals.rxBytes)
+                .setTxBytes(newVals.txBytes);
+        }
+        mutator.commit();
     }
 
-    mutator.commit();
 #ifdef HAVE_PROMETHEUS_SUPPORT
     ep_map_t::iterator it = ep_map.find(uuid);
     if (it != ep_map.end()) {
@@ -1437,7 +1436,8 @@ void EndpointManager::updateEndpointCounters(const std::string& uuid,
         if (ep_name)
             prometheusManager.addNUpdateEpCounter(uuid, ep_name.get(),
                                                   es.endpoint->getAttributeHash(),
-                                                  es.endpoint->getAttributes());
+                                                  es.endpoint->getAttributes(),
+                                                  id);
         else
             LOG(ERROR) << "ep name not found for uuid:" << uuid;
     }
@@ -1494,12 +1494,11 @@ void EndpointManager::EPGMappingListener::objectUpdated(class_id_t classId,
         optional<const std::string&> name = epgMapping.get()->getName();
         if (!name) return;
 
-        string_ep_map_t::iterator it =
-            epmanager.epgmapping_ep_map.find(name.get());
-        if (it == epmanager.epgmapping_ep_map.end()) return;
+        EndpointUUIDView eps = epmanager.epgmapping_ep_map.get(name.get());
+        if (eps.empty()) return;
 
         unordered_set<string> notify;
-        for (const std::string& uuid : it->second) {
+        for (const std::string& uuid : eps) {
             if (epmanager.updateEndpointLocal(uuid)) {
                 notify.insert(uuid);
             }
@@ -0,0 +1,293 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for InterfaceAddrCache and RtnetlinkSocket classes.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <config.h>
+#ifdef HAVE_LINUX_RTNETLINK_H
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <opflex/modb/MAC.h>
+
+#include <opflexagent/InterfaceAddrCache.h>
+#include <opflexagent/logging.h>
+
+namespace opflexagent {
+
+using std::string;
+using boost::asio::ip::address;
+using boost::asio::ip::address_v4;
+using boost::asio::ip::address_v6;
+
+RtnetlinkSocket::RtnetlinkSocket() : fd(-1), seq(0) {}
+
+RtnetlinkSocket::~RtnetlinkSocket() {
+    close();
+}
+
+#ifdef HAVE_LINUX_RTNETLINK_H
+
+int RtnetlinkSocket::open() {
+    close();
+    fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        int err = errno;
+        LOG(ERROR) << "Could not create rtnetlink socket: " << strerror(err);
+        return -1;
+    }
+
+    // a dump of thousands of interfaces arrives in a burst
+    int rcvbuf = 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_nl local;
+    memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if (bind(fd, (struct sockaddr*)&local, sizeof(local)) < 0) {
+        int err = errno;
+        LOG(ERROR) << "Could not bind rtnetlink socket: " << strerror(err);
+        close();
+        return -1;
+    }
+    return fd;
+}
+
+bool RtnetlinkSocket::requestDump(uint16_t type) {
+    if (fd < 0) return false;
+
+    struct {
+        struct nlmsghdr nlh;
+        union {
+            struct ifinfomsg ifi;
+            struct ifaddrmsg ifa;
+        };
+    } req;
+    memset(&req, 0, sizeof(req));
+    req.nlh.nlmsg_len = NLMSG_LENGTH(type == RTM_GETLINK
+                                     ? sizeof(struct ifinfomsg)
+                                     : sizeof(struct ifaddrmsg));
+    req.nlh.nlmsg_type = type;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = ++seq;
+
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(fd, &req, req.nlh.nlmsg_len, 0,
+               (struct sockaddr*)&kernel, sizeof(kernel)) < 0) {
+        int err = errno;
+        LOG(ERROR) << "Could not send rtnetlink dump request: "
+                   << strerror(err);
+        return false;
+    }
+    return true;
+}
+
+void RtnetlinkSocket::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+static void parseAttrs(struct rtattr* rta, int len,
+                       struct rtattr** attrs, int max) {
+    std::fill(attrs, attrs + max + 1, nullptr);
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type <= max)
+            attrs[rta->rta_type] = rta;
+    }
+}
+
+static bool getAddress(const struct ifaddrmsg* ifa, struct rtattr** attrs,
+                       /* out */ address& addr) {
+    // IFA_LOCAL is the local address of a point-to-point interface,
+    // where IFA_ADDRESS is the peer
+    struct rtattr* rta = attrs[IFA_LOCAL] ? attrs[IFA_LOCAL]
+        : attrs[IFA_ADDRESS];
+    if (!rta) return false;
+    if (ifa->ifa_family == AF_INET &&
+        RTA_PAYLOAD(rta) == sizeof(address_v4::bytes_type)) {
+        address_v4::bytes_type b;
+        memcpy(b.data(), RTA_DATA(rta), b.size());
+        addr = address_v4(b);
+        return true;
+    } else if (ifa->ifa_family == AF_INET6 &&
+               RTA_PAYLOAD(rta) == sizeof(address_v6::bytes_type)) {
+        address_v6::bytes_type b;
+        memcpy(b.data(), RTA_DATA(rta), b.size());
+        addr = address_v6(b);
+        return true;
+    }
+    return false;
+}
+
+int InterfaceAddrCache::apply(const void* buf, size_t len) {
+    int result = 0;
+    const struct nlmsghdr* nlh = (const struct nlmsghdr*)buf;
+    int remaining = (int)len;
+    for (; NLMSG_OK(nlh, remaining); nlh = NLMSG_NEXT(nlh, remaining)) {
+        switch (nlh->nlmsg_type) {
+        case NLMSG_DONE:
+            result |= DUMP_DONE;
+            break;
+        case NLMSG_ERROR:
+            {
+                const struct nlmsgerr* err =
+                    (const struct nlmsgerr*)NLMSG_DATA(nlh);
+                if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*err)) ||
+                    err->error != 0)
+                    result |= FAILED;
+            }
+            break;
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+            {
+                if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg)))
+                    break;
+                struct ifinfomsg* ifi = (struct ifinfomsg*)NLMSG_DATA(nlh);
+                if (nlh->nlmsg_type == RTM_DELLINK) {
+                    if (links.erase(ifi->ifi_index) > 0)
+                        result |= CHANGED;
+                    break;
+                }
+
+                struct rtattr* attrs[IFLA_MAX + 1];
+                parseAttrs(IFLA_RTA(ifi), IFLA_PAYLOAD(nlh), attrs, IFLA_MAX);
+                Link& link = links[ifi->ifi_index];
+                string name = link.name;
+                if (attrs[IFLA_IFNAME])
+                    name = (const char*)RTA_DATA(attrs[IFLA_IFNAME]);
+                string mac = link.mac;
+                if (attrs[IFLA_ADDRESS] &&
+                    RTA_PAYLOAD(attrs[IFLA_ADDRESS]) == 6)
+                    mac = opflex::modb::MAC((uint8_t*)
+                                            RTA_DATA(attrs[IFLA_ADDRESS]))
+                        .toString();
+                if (name != link.name || mac != link.mac ||
+                    ifi->ifi_flags != link.flags) {
+                    link.name = name;
+                    link.mac = mac;
+                    link.flags = ifi->ifi_flags;
+                    result |= CHANGED;
+                }
+            }
+            break;
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+            {
+                if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifaddrmsg)))
+                    break;
+                struct ifaddrmsg* ifa = (struct ifaddrmsg*)NLMSG_DATA(nlh);
+                struct rtattr* attrs[IFA_MAX + 1];
+                parseAttrs(IFA_RTA(ifa), IFA_PAYLOAD(nlh), attrs, IFA_MAX);
+                address addr;
+                if (!getAddress(ifa, attrs, addr))
+                    break;
+
+                if (nlh->nlmsg_type == RTM_DELADDR) {
+                    auto lit = links.find(ifa->ifa_index);
+                    if (lit == links.end()) break;
+                    auto& addrs = lit->second.addresses;
+                    auto it = std::find(addrs.begin(), addrs.end(), addr);
+                    if (it != addrs.end()) {
+                        addrs.erase(it);
+                        result |= CHANGED;
+                    }
+                } else {
+                    // the link may not be known yet if its notification
+                    // was lost; its name and flags follow with it
+                    auto& addrs = links[ifa->ifa_index].addresses;
+                    if (std::find(addrs.begin(), addrs.end(), addr) ==
+                        addrs.end()) {
+                        addrs.push_back(addr);
+                        result |= CHANGED;
+                    }
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return result;
+}
+
+bool InterfaceAddrCache::getUplink(const string& uplinkIface,
+                                   /* out */ string& bestAddress,
+                                   /* out */ string& bestMac,
+                                   /* out */ string& bestIface,
+                                   /* out */ bool& bestAddrIsV4) const {
+    const Link* best = nullptr;
+    for (const auto& e : links) {
+        const Link& link = e.second;
+
+        // If the user specified an interface, only use that interface
+        if (uplinkIface != "" && uplinkIface != link.name)
+            continue;
+
+        // Need an IPv4 or IPv6 address on a non-loopback up interface
+        if (link.flags & IFF_LOOPBACK)
+            continue;
+        if (!(link.flags & IFF_UP))
+            continue;
+
+        for (const address& addr : link.addresses) {
+            // address_v6 is built without a scope, so none to remove
+            bestAddress = addr.to_string();
+            bestAddrIsV4 = addr.is_v4();
+            best = &link;
+            if (bestAddrIsV4) {
+                // prefer ipv4 address, if present
+                bestMac = link.mac;
+                bestIface = link.name;
+                return true;
+            }
+        }
+    }
+    if (!best) return false;
+    bestMac = best->mac;
+    bestIface = best->name;
+    return true;
+}
+
+#else /* HAVE_LINUX_RTNETLINK_H */
+
+int RtnetlinkSocket::open() {
+    LOG(ERROR) << "rtnetlink is not supported on this platform";
+    return -1;
+}
+
+bool RtnetlinkSocket::requestDump(uint16_t) {
+    return false;
+}
+
+void RtnetlinkSocket::close() {}
+
+int InterfaceAddrCache::apply(const void*, size_t) {
+    return FAILED;
+}
+
+bool InterfaceAddrCache::getUplink(const string&, string&, string&,
+                                   string&, bool&) const {
+    return false;
+}
+
+#endif /* HAVE_LINUX_RTNETLINK_H */
+
+} /* namespace opflexagent */
@@ -0,0 +1,92 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for MetricsRegistry class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/MetricsRegistry.h>
+#include <opflexagent/logging.h>
+
+#include <limits>
+
+namespace opflexagent {
+
+const MetricsRegistry::id_t MetricsRegistry::INVALID_ID =
+    std::numeric_limits<MetricsRegistry::id_t>::max();
+const size_t MetricsRegistry::BLOCK_ROWS;
+const size_t MetricsRegistry::MAX_BLOCKS;
+
+MetricsRegistry::MetricsRegistry(size_t width_)
+    : width(width_), blocks(new std::atomic<cell_t*>[MAX_BLOCKS]),
+      nextId(0) {
+    for (size_t i = 0; i < MAX_BLOCKS; ++i)
+        blocks[i].store(nullptr, std::memory_order_relaxed);
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    for (size_t i = 0; i < MAX_BLOCKS; ++i)
+        delete[] blocks[i].load(std::memory_order_relaxed);
+}
+
+MetricsRegistry::id_t MetricsRegistry::getId(const std::string& key) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = ids.find(key);
+    if (it != ids.end())
+        return it->second;
+
+    id_t id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        if (nextId >= BLOCK_ROWS * MAX_BLOCKS) {
+            LOG(ERROR) << "Metrics registry full; not tracking " << key;
+            return INVALID_ID;
+        }
+        id = nextId++;
+        size_t b = id / BLOCK_ROWS;
+        if (blocks[b].load(std::memory_order_relaxed) == nullptr) {
+            cell_t* block = new cell_t[BLOCK_ROWS * width];
+            for (size_t i = 0; i < BLOCK_ROWS * width; ++i)
+                block[i].store(0, std::memory_order_relaxed);
+            blocks[b].store(block, std::memory_order_release);
+        }
+    }
+    for (size_t c = 0; c < width; ++c)
+        cell(id, c).store(0, std::memory_order_relaxed);
+    ids.emplace(key, id);
+    return id;
+}
+
+MetricsRegistry::id_t MetricsRegistry::findId(const std::string& key) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = ids.find(key);
+    return it == ids.end() ? INVALID_ID : it->second;
+}
+
+void MetricsRegistry::remove(const std::string& key) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = ids.find(key);
+    if (it == ids.end())
+        return;
+    freeIds.push_back(it->second);
+    ids.erase(it);
+}
+
+size_t MetricsRegistry::size() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return ids.size();
+}
+
+void MetricsRegistry::forEach(const visitor_t& visitor) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (const auto& e : ids)
+        visitor(e.first, e.second);
+}
+
+} /* namespace opflexagent */
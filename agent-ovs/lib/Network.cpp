@@ -14,6 +14,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include <vector>
+#include <algorithm>
 
 #include <endian.h>
 
@@ -214,5 +215,228 @@ bool prefix_match(const boost::asio::ip::address& addr,
     return false;
 }
 
+/*
+ * Address bits of a prefix held as a 128-bit (high, low) pair.  IPv4
+ * addresses use only the low 32 bits.
+ */
+typedef std::pair<uint64_t, uint64_t> prefix_bits_t;
+typedef std::pair<prefix_bits_t, uint8_t> prefix_t;
+
+static prefix_bits_t mask_bits(const prefix_bits_t& bits, uint8_t prefixLen,
+                               uint8_t width) {
+    uint8_t host = width - prefixLen;
+    prefix_bits_t r(bits);
+    if (host >= 128) {
+        r.first = r.second = 0;
+    } else if (host >= 64) {
+        r.second = 0;
+        if (host > 64)
+            r.first &= ~((uint64_t)0) << (host - 64);
+    } else if (host > 0) {
+        r.second &= ~((uint64_t)0) << host;
+    }
+    return r;
+}
+
+static void compress_prefixes(std::vector<prefix_t>& prefixes,
+                              uint8_t width) {
+    std::sort(prefixes.begin(), prefixes.end());
+
+    std::vector<prefix_t> cover;
+    for (const prefix_t& p : prefixes) {
+        // drop prefixes contained in the previously kept prefix
+        if (!cover.empty() && cover.back().second <= p.second &&
+            mask_bits(p.first, cover.back().second, width) ==
+            cover.back().first)
+            continue;
+
+        cover.push_back(p);
+
+        // merge sibling prefixes into their parent
+        while (cover.size() >= 2) {
+            const prefix_t& b = cover[cover.size() - 1];
+            const prefix_t& a = cover[cover.size() - 2];
+            if (a.second != b.second || a.second == 0 ||
+                mask_bits(a.first, a.second - 1, width) !=
+                mask_bits(b.first, b.second - 1, width))
+                break;
+            prefix_t parent(mask_bits(a.first, a.second - 1, width),
+                            a.second - 1);
+            cover.pop_back();
+            cover.back() = parent;
+        }
+    }
+    prefixes.swap(cover);
+}
+
+void compress_subnets(const subnets_t& subnets,
+                      /* out */ subnets_t& result) {
+    std::vector<prefix_t> v4;
+    std::vector<prefix_t> v6;
+
+    for (const subnet_t& sn : subnets) {
+        boost::system::error_code ec;
+        address addr = address::from_string(sn.first, ec);
+        if (sn.first.empty() || ec) {
+            result.insert(sn);
+            continue;
+        }
+
+        if (addr.is_v4()) {
+            uint8_t prefixLen = std::min<uint8_t>(sn.second, 32);
+            prefix_bits_t bits(0, addr.to_v4().to_ulong());
+            v4.emplace_back(mask_bits(bits, prefixLen, 32), prefixLen);
+        } else {
+            uint8_t prefixLen = std::min<uint8_t>(sn.second, 128);
+            address_v6::bytes_type bytes = addr.to_v6().to_bytes();
+            uint64_t hi, lo;
+            memcpy(&hi, bytes.data(), sizeof(hi));
+            memcpy(&lo, bytes.data() + 8, sizeof(lo));
+            prefix_bits_t bits(be64toh(hi), be64toh(lo));
+            v6.emplace_back(mask_bits(bits, prefixLen, 128), prefixLen);
+        }
+    }
+
+    compress_prefixes(v4, 32);
+    compress_prefixes(v6, 128);
+
+    for (const prefix_t& p : v4) {
+        address_v4 addr((uint32_t)p.first.second);
+        result.emplace(addr.to_string(), p.second);
+    }
+    for (const prefix_t& p : v6) {
+        address_v6::bytes_type bytes;
+        uint64_t hi = htobe64(p.first.first);
+        uint64_t lo = htobe64(p.first.second);
+        memcpy(bytes.data(), &hi, sizeof(hi));
+        memcpy(bytes.data() + 8, &lo, sizeof(lo));
+        result.emplace(address_v6(bytes).to_string(), p.second);
+    }
+}
+
+ip_addr::ip_addr(const address& addr) : bytes_(), family_(UNSPEC) {
+    if (addr.is_v4()) {
+        address_v4::bytes_type b = addr.to_v4().to_bytes();
+        memcpy(bytes_.data(), b.data(), b.size());
+        family_ = V4;
+    } else if (addr.is_v6()) {
+        address_v6::bytes_type b = addr.to_v6().to_bytes();
+        memcpy(bytes_.data(), b.data(), b.size());
+        family_ = V6;
+    }
+}
+
+bool ip_addr::from_string(const std::string& str, /* out */ ip_addr& addr) {
+    // inet_pton needs a terminated string without the scope
+    char buf[INET6_ADDRSTRLEN];
+    size_t len = str.find('%');
+    if (len == std::string::npos)
+        len = str.size();
+    if (len == 0 || len >= sizeof(buf))
+        return false;
+    memcpy(buf, str.data(), len);
+    buf[len] = '\0';
+
+    ip_addr r;
+    if (memchr(buf, ':', len) == NULL) {
+        if (len != str.size() || inet_pton(AF_INET, buf, r.bytes_.data()) != 1)
+            return false;
+        r.family_ = V4;
+    } else {
+        if (inet_pton(AF_INET6, buf, r.bytes_.data()) != 1)
+            return false;
+        r.family_ = V6;
+    }
+    addr = r;
+    return true;
+}
+
+ip_addr ip_addr::mask(uint8_t prefixLen) const {
+    ip_addr r(*this);
+    size_t nbytes = is_v4() ? 4 : 16;
+    for (size_t i = 0; i < nbytes; ++i) {
+        if (prefixLen >= 8) {
+            prefixLen -= 8;
+        } else {
+            r.bytes_[i] &= (uint8_t)(0xff00 >> prefixLen);
+            prefixLen = 0;
+        }
+    }
+    return r;
+}
+
+address ip_addr::to_address() const {
+    if (is_v4()) {
+        address_v4::bytes_type b;
+        memcpy(b.data(), bytes_.data(), b.size());
+        return address_v4(b);
+    } else if (is_v6()) {
+        return address_v6(bytes_);
+    }
+    return address();
+}
+
+std::string ip_addr::to_string() const {
+    if (empty())
+        return "";
+    char buf[INET6_ADDRSTRLEN];
+    inet_ntop(is_v4() ? AF_INET : AF_INET6, bytes_.data(), buf, sizeof(buf));
+    return buf;
+}
+
+std::size_t ip_addr::hash() const {
+    uint64_t hi, lo;
+    memcpy(&hi, bytes_.data(), sizeof(hi));
+    memcpy(&lo, bytes_.data() + 8, sizeof(lo));
+    std::size_t h = family_;
+    boost::hash_combine(h, hi);
+    boost::hash_combine(h, lo);
+    return h;
+}
+
+std::ostream& operator<<(std::ostream &os, const ip_addr& addr) {
+    os << addr.to_string();
+    return os;
+}
+
+bool ip_prefix::from_string(const std::string& cidrStr,
+                            /* out */ ip_prefix& prefix,
+                            bool do_mask_addr /*=true */) {
+    size_t slash = cidrStr.find('/');
+    ip_addr addr;
+    if (!ip_addr::from_string(cidrStr.substr(0, slash), addr))
+        return false;
+
+    uint8_t len = addr.max_prefix_len();
+    if (slash != std::string::npos) {
+        const char* p = cidrStr.c_str() + slash + 1;
+        if (*p == '\0')
+            return false;
+        unsigned l = 0;
+        for (; *p; ++p) {
+            if (*p < '0' || *p > '9')
+                return false;
+            l = l * 10 + (*p - '0');
+            if (l > addr.max_prefix_len())
+                return false;
+        }
+        len = l;
+        if (do_mask_addr)
+            addr = addr.mask(len);
+    }
+
+    prefix = ip_prefix(addr, len);
+    return true;
+}
+
+std::string ip_prefix::to_string() const {
+    return addr_.to_string() + "/" + std::to_string(len_);
+}
+
+std::ostream& operator<<(std::ostream &os, const ip_prefix& prefix) {
+    os << prefix.to_string();
+    return os;
+}
+
 } /* namespace packets */
 } /* namespace opflexagent */
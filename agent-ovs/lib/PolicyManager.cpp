@@ -47,7 +47,7 @@ using boost::asio::ip::address;
 PolicyManager::PolicyManager(OFFramework& framework_,
                              boost::asio::io_service& agent_io_)
     : framework(framework_), opflexDomain("default"), taskQueue(agent_io_),
-      domainListener(*this), contractListener(*this),
+      snapshot(make_shared<Snapshot>()), domainListener(*this), contractListener(*this),
       secGroupListener(*this), configListener(*this), routeListener(*this) {
 
 }
@@ -160,6 +160,9 @@ void PolicyManager::stop() {
     group_map.clear();
     vnid_map.clear();
     redirGrpMap.clear();
+    auto next = make_shared<Snapshot>(*snapshot);
+    next->groups = make_shared<Snapshot::entry_map_t<Snapshot::GroupInfo> >();
+    publish(next);
 }
 
 void PolicyManager::registerListener(PolicyListener* listener) {
@@ -1259,6 +1262,7 @@ void PolicyManager::updateContracts() {
             ++itr;
         }
     }
+    publishContracts(contractsToNotify);
     guard.unlock();
 
     for (const URI& u : contractsToNotify) {
@@ -1285,6 +1289,7 @@ void PolicyManager::updateSecGrps() {
             ++it;
         }
     }
+    publishSecGroups(toNotify);
     guard.unlock();
 
     for (const URI& u : toNotify) {
@@ -1465,6 +1470,19 @@ void PolicyManager::updateRemoteRouteChildrenForPolicyPrefix(
     }
 }
 
+// Parse the prefix of an external subnet
+static bool getExtSubnetPrefix(const modelgbp::gbp::ExternalSubnet& extsub,
+                               /* out */ network::ip_prefix& prefix) {
+    if (!extsub.isAddressSet() || !extsub.isPrefixLenSet())
+        return false;
+    network::ip_addr addr;
+    if (!network::ip_addr::from_string(extsub.getAddress().get(), addr))
+        return false;
+    uint8_t len = extsub.getPrefixLen().get();
+    prefix = network::ip_prefix(addr, std::min(len, addr.max_prefix_len()));
+    return true;
+}
+
 void PolicyManager::updateL3Nets(const opflex::modb::URI& rdURI,
                                  uri_set_t& contractsToNotify,
                                  uri_set_t& notifyLocalRoutes) {
@@ -1524,12 +1542,10 @@ void PolicyManager::updateL3Nets(const opflex::modb::URI& rdURI,
                 net->resolveGbpExternalSubnet(extSubs);
                 ext_subnet_map_t newExtSubs;
                 for (shared_ptr<ExternalSubnet> &extsub : extSubs) {
-                    if (!extsub->isAddressSet() || !extsub->isPrefixLenSet())
+                    ExtSubnetState ess{extsub, network::ip_prefix()};
+                    if (!getExtSubnetPrefix(*extsub, ess.prefix))
                         continue;
-                    boost::system::error_code ec;
-                    address::from_string(extsub->getAddress().get(), ec);
-                    if (ec) continue;
-                    newExtSubs[extsub->getURI()] = extsub;
+                    newExtSubs[extsub->getURI()] = ess;
                     if(l3s.subnet_map.find(extsub->getURI()) ==
                        l3s.subnet_map.end()) {
                         optional<shared_ptr<modelgbp::gbp::L3ExternalNetwork>>
@@ -1589,7 +1605,7 @@ void PolicyManager::updateL3Nets(const opflex::modb::URI& rdURI,
                             extsub,
                             notifyLocalRoutes);
                         notifyLocalRoutes.insert(localRoute.get()->getURI());
-                        l3s.subnet_map[extsub->getURI()] = extsub;
+                        l3s.subnet_map[extsub->getURI()] = ess;
                     }
                 }
                 for (auto snet = l3s.subnet_map.begin();
@@ -1599,9 +1615,11 @@ void PolicyManager::updateL3Nets(const opflex::modb::URI& rdURI,
                     if(newExtSubs.find(snet->first) == newExtSubs.end()) {
                         //This is a deleted policy prefix, update localRoutes
                         //being served by this policy prefix
-                        opflex::modb::URI delURI = snet->second->getURI();
-                        std::string delPPfx = snet->second->getAddress().get();
-                        uint32_t pPfxLen = snet->second->getPrefixLen().get();
+                        const shared_ptr<ExternalSubnet>& delSub =
+                            snet->second.extsub;
+                        opflex::modb::URI delURI = delSub->getURI();
+                        std::string delPPfx = delSub->getAddress().get();
+                        uint32_t pPfxLen = delSub->getPrefixLen().get();
                         localRoute = LocalRoute::resolve(
                                          framework,
                                          rd.get()->getURI().toString(),
@@ -1772,36 +1790,27 @@ void PolicyManager::getBestPolicyPrefix(
                         optional<shared_ptr<
                             modelgbp::gbp::ExternalSubnet>> &newExtSub) {
     using namespace modelgbp::gbp;
-    boost::system::error_code ec;
-    address targetAddr =
-    address::from_string(pfx, ec);
-    if (ec || (rd_map.find(rdURI) == rd_map.end())) {
+    network::ip_addr targetAddr;
+    if (!network::ip_addr::from_string(pfx, targetAddr) ||
+        (rd_map.find(rdURI) == rd_map.end())) {
         return;
     }
+    // subnet prefixes were parsed when they were added
+    uint8_t targetLen =
+        std::min<uint32_t>(pfxLen, targetAddr.max_prefix_len());
+    network::ip_prefix target(targetAddr, targetLen);
     uint32_t bestLen = 0;
     RoutingDomainState &rs = rd_map[rdURI];
     for (const auto& extNet : rs.extNets) {
         L3NetworkState &l3s = l3n_map[extNet];
         for (auto &extSubItr: l3s.subnet_map) {
-            shared_ptr<modelgbp::gbp::ExternalSubnet> &extsub =
-            extSubItr.second;
-            if (!extsub->isAddressSet() || !extsub->isPrefixLenSet())
-                continue;
-            address addr =
-            address::from_string(extsub->getAddress().get(), ec);
-            if (ec) continue;
-            uint32_t prefixLen = extsub->getPrefixLen().get();
-            if(addr.is_v4()  !=  targetAddr.is_v4()) {
-                continue;
-            }
-            bool is_exact_match = false;
-            if(network::prefix_match(addr, prefixLen, targetAddr,
-                                     pfxLen, is_exact_match) &&
-               (prefixLen >= bestLen)) {
+            const network::ip_prefix& prefix = extSubItr.second.prefix;
+            uint32_t prefixLen = prefix.length();
+            if (prefix.contains(target) && (prefixLen >= bestLen)) {
                 newNet = l3s.extNet;
-                newExtSub = extsub;
+                newExtSub = extSubItr.second.extsub;
                 bestLen = prefixLen;
-                if(is_exact_match) {
+                if (prefixLen == targetLen) {
                     return;
                 }
             }
@@ -1987,6 +1996,13 @@ void PolicyManager::updateDomain(class_id_t class_id, const URI& uri) {
             deleteSubnets(uri);
     }
 
+    {
+        // a new group is published even if it has no domains yet
+        uri_set_t groups(notifyGroups);
+        if (class_id == modelgbp::gbp::EpGroup::CLASS_ID)
+            groups.insert(uri);
+        publishGroups(groups);
+    }
     guard.unlock();
 
     for (const URI& u : notifyGroups) {
@@ -2109,6 +2125,162 @@ bool PolicyManager::getRoute(
     return false;
 }
 
+PolicyManager::Snapshot::Snapshot()
+    : version(0),
+      groups(make_shared<entry_map_t<GroupInfo> >()),
+      contracts(make_shared<entry_map_t<ContractInfo> >()),
+      secGroups(make_shared<entry_map_t<rule_list_t> >()),
+      staticRoutes(make_shared<entry_map_t<PolicyRoute> >()),
+      remoteRoutes(make_shared<entry_map_t<PolicyRoute> >()) {}
+
+template <typename T>
+static shared_ptr<const T>
+findEntry(const std::unordered_map<URI, shared_ptr<const T> >& map,
+          const URI& uri) {
+    auto it = map.find(uri);
+    return it != map.end() ? it->second : shared_ptr<const T>();
+}
+
+shared_ptr<const PolicyManager::Snapshot::GroupInfo>
+PolicyManager::Snapshot::getGroup(const URI& eg) const {
+    return findEntry(*groups, eg);
+}
+
+shared_ptr<const PolicyManager::Snapshot::ContractInfo>
+PolicyManager::Snapshot::getContract(const URI& contract) const {
+    return findEntry(*contracts, contract);
+}
+
+shared_ptr<const PolicyManager::rule_list_t>
+PolicyManager::Snapshot::getSecGroupRules(const URI& secGroup) const {
+    return findEntry(*secGroups, secGroup);
+}
+
+shared_ptr<const PolicyRoute>
+PolicyManager::Snapshot::getRoute(class_id_t route_type,
+                                  const URI& rtURI) const {
+    if (route_type == modelgbp::gbp::StaticRoute::CLASS_ID)
+        return findEntry(*staticRoutes, rtURI);
+    if (route_type == modelgbp::gbp::RemoteRoute::CLASS_ID)
+        return findEntry(*remoteRoutes, rtURI);
+    return shared_ptr<const PolicyRoute>();
+}
+
+PolicyManager::snapshot_ptr PolicyManager::getSnapshot() const {
+    return std::atomic_load(&snapshot);
+}
+
+/*
+ * Copy a snapshot map and rebuild the entries for the given URIs;
+ * build returns an empty pointer for entries that were removed.
+ */
+template <typename T, typename F>
+static shared_ptr<const std::unordered_map<URI, shared_ptr<const T> > >
+rebuildEntries(const std::unordered_map<URI, shared_ptr<const T> >& prev,
+               const PolicyManager::uri_set_t& uris, F build) {
+    auto next = make_shared<std::unordered_map<URI, shared_ptr<const T> > >
+        (prev);
+    for (const URI& u : uris) {
+        shared_ptr<const T> entry = build(u);
+        if (entry)
+            (*next)[u] = entry;
+        else
+            next->erase(u);
+    }
+    return next;
+}
+
+void PolicyManager::publish(const shared_ptr<Snapshot>& next) {
+    next->version = snapshot->version + 1;
+    std::atomic_store(&snapshot, snapshot_ptr(next));
+}
+
+void PolicyManager::publishGroups(const uri_set_t& groups) {
+    if (groups.empty()) return;
+    auto next = make_shared<Snapshot>(*snapshot);
+    next->groups =
+        rebuildEntries(*snapshot->groups, groups, [this](const URI& eg) {
+            shared_ptr<Snapshot::GroupInfo> info;
+            group_map_t::const_iterator it = group_map.find(eg);
+            if (it == group_map.end()) return info;
+
+            const GroupState& gs = it->second;
+            info = make_shared<Snapshot::GroupInfo>();
+            if (gs.instContext) {
+                info->vnid = gs.instContext.get()->getEncapId();
+                info->sclass = gs.instContext.get()->getClassid();
+                info->multicastIP =
+                    gs.instContext.get()->getMulticastGroupIP();
+            }
+            info->routingDomain = gs.routingDomain;
+            info->bridgeDomain = gs.bridgeDomain;
+            info->floodDomain = gs.floodDomain;
+            info->floodContext = gs.floodContext;
+            for (const subnet_map_t::value_type& v : gs.subnet_map)
+                info->subnets.push_back(v.second);
+            return info;
+        });
+    publish(next);
+}
+
+void PolicyManager::publishContracts(const uri_set_t& contracts) {
+    if (contracts.empty()) return;
+    auto next = make_shared<Snapshot>(*snapshot);
+    next->contracts =
+        rebuildEntries(*snapshot->contracts, contracts,
+                       [this](const URI& c) {
+            shared_ptr<Snapshot::ContractInfo> info;
+            contract_map_t::const_iterator it = contractMap.find(c);
+            if (it == contractMap.end()) return info;
+
+            info = make_shared<Snapshot::ContractInfo>();
+            info->providerGroups = it->second.providerGroups;
+            info->consumerGroups = it->second.consumerGroups;
+            info->intraGroups = it->second.intraGroups;
+            info->rules = it->second.rules;
+            return info;
+        });
+    publish(next);
+}
+
+void PolicyManager::publishSecGroups(const uri_set_t& secGroups) {
+    if (secGroups.empty()) return;
+    auto next = make_shared<Snapshot>(*snapshot);
+    next->secGroups =
+        rebuildEntries(*snapshot->secGroups, secGroups,
+                       [this](const URI& sg) {
+            secgrp_map_t::const_iterator it = secGrpMap.find(sg);
+            return it != secGrpMap.end()
+                ? make_shared<rule_list_t>(it->second)
+                : shared_ptr<rule_list_t>();
+        });
+    publish(next);
+}
+
+void PolicyManager::publishRoutes(bool static_source,
+                                  const uri_set_t& routes) {
+    if (routes.empty()) return;
+    const route_map_t& routeMap =
+        static_source ? static_route_map : remote_route_map;
+    auto next = make_shared<Snapshot>(*snapshot);
+    // routes in the maps are replaced rather than modified when they
+    // change, apart from the present flag used while parsing, so the
+    // snapshot can share them
+    auto build = [&routeMap](const URI& rt) {
+        route_map_t::const_iterator it = routeMap.find(rt);
+        return it != routeMap.end()
+            ? shared_ptr<const PolicyRoute>(it->second)
+            : shared_ptr<const PolicyRoute>();
+    };
+    if (static_source)
+        next->staticRoutes =
+            rebuildEntries(*snapshot->staticRoutes, routes, build);
+    else
+        next->remoteRoutes =
+            rebuildEntries(*snapshot->remoteRoutes, routes, build);
+    publish(next);
+}
+
 void PolicyManager::updateExternalNode(const URI& uri,
                                        uri_set_t &notifyStaticRoutes,
                                        uri_set_t &notifyLocalRoutes) {
@@ -2340,27 +2512,23 @@ void PolicyManager::updatePolicyPrefixChildrenForRemoteRoute(
          uri_set_t &notifyLocalRoutes) {
     using namespace modelgbp::gbp;
     using namespace modelgbp::epdr;
-    boost::system::error_code ec;
-    address targetAddr =
-    address::from_string(pfx, ec);
-    if (ec || (rd_map.find(rdURI) == rd_map.end())) {
+    network::ip_addr targetAddr;
+    if (!network::ip_addr::from_string(pfx, targetAddr) ||
+        (rd_map.find(rdURI) == rd_map.end())) {
         return;
     }
+    network::ip_prefix target(targetAddr,
+                              std::min<uint32_t>(pfxLen,
+                                                 targetAddr.max_prefix_len()));
     RoutingDomainState &rs = rd_map[rdURI];
     for (const auto& extNet : rs.extNets) {
         L3NetworkState &l3s = l3n_map[extNet];
         for (auto &extSubItr: l3s.subnet_map) {
-            shared_ptr<modelgbp::gbp::ExternalSubnet> &extsub =
-                extSubItr.second;
-            if (!extsub->isAddressSet() || !extsub->isPrefixLenSet())
-                continue;
-            address addr =
-            address::from_string(extsub->getAddress().get(), ec);
-            if (ec) continue;
-            uint32_t prefixLen = extsub->getPrefixLen().get();
-            bool is_exact_match = false;
-            if(network::prefix_match(targetAddr, pfxLen, addr,
-                                     prefixLen, is_exact_match)) {
+            if (target.contains(extSubItr.second.prefix)) {
+                const network::ip_addr& addr =
+                    extSubItr.second.prefix.address();
+                uint32_t prefixLen =
+                    extSubItr.second.extsub->getPrefixLen().get();
                 optional<shared_ptr<LocalRoute>> localRoute
                     = boost::make_optional<shared_ptr<LocalRoute> >(false, nullptr);
                 optional<shared_ptr<LocalRouteToRrtRSrc>> lrtToRrt;
@@ -2678,9 +2846,10 @@ void PolicyManager::updateExternalNetworkPrefixes(
         {
             optional<shared_ptr<L3ExternalNetwork>> newNet;
             optional<shared_ptr<ExternalSubnet>> newExtSub;
-            opflex::modb::URI delURI = snet->second->getURI();
-            std::string delPPfx = snet->second->getAddress().get();
-            uint32_t pPfxLen = snet->second->getPrefixLen().get();
+            const shared_ptr<ExternalSubnet>& delSub = snet->second.extsub;
+            opflex::modb::URI delURI = delSub->getURI();
+            std::string delPPfx = delSub->getAddress().get();
+            uint32_t pPfxLen = delSub->getPrefixLen().get();
             //This is a deleted policy prefix, update localRoutes
             //being served by this policy prefix
             localRoute = LocalRoute::resolve(
@@ -2738,6 +2907,7 @@ executeAndNotifyContract(const std::function<void(uri_set_t&)>& func) {
     {
         unique_lock<mutex> guard(state_mutex);
         func(contractsToNotify);
+        publishContracts(contractsToNotify);
     }
 
     for (const URI& u : contractsToNotify) {
@@ -2754,6 +2924,7 @@ void PolicyManager::
     {
         unique_lock<mutex> guard(state_mutex);
         func(contractsToNotify, localRoutesToNotify);
+        publishContracts(contractsToNotify);
     }
 
     for (const URI& u : contractsToNotify) {
@@ -2804,8 +2975,9 @@ void PolicyManager::ContractListener::objectUpdated(class_id_t classId,
     } else {
         {
             unique_lock<mutex> guard(pmanager.state_mutex);
-            if (classId == Contract::CLASS_ID) {
-                pmanager.contractMap[uri];
+            if (classId == Contract::CLASS_ID &&
+                pmanager.contractMap.emplace(uri, ContractState()).second) {
+                pmanager.publishContracts({uri});
             }
         }
 
@@ -2825,8 +2997,9 @@ void PolicyManager::SecGroupListener::objectUpdated(class_id_t classId,
     LOG(DEBUG) << "SecGroupListener update for URI " << uri;
     {
         unique_lock<mutex> guard(pmanager.state_mutex);
-        if (classId == modelgbp::gbp::SecGroup::CLASS_ID) {
-            pmanager.secGrpMap[uri];
+        if (classId == modelgbp::gbp::SecGroup::CLASS_ID &&
+            pmanager.secGrpMap.emplace(uri, rule_list_t()).second) {
+            pmanager.publishSecGroups({uri});
         }
     }
 
@@ -2855,6 +3028,7 @@ void PolicyManager::executeAndNotifyRoutes(bool static_source,
     {
         unique_lock<mutex> guard(state_mutex);
         func(notifyRoutes, notifyLocalRoutes);
+        publishRoutes(static_source, notifyRoutes);
     }
 
     if(static_source){
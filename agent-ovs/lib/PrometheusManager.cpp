@@ -228,6 +228,28 @@ static string table_drop_family_help[] =
   "opflex table drop packets"
 };
 
+static string send_queue_family_names[] =
+{
+  "opflex_switch_send_queue_depth",
+  "opflex_switch_send_queue_max_depth",
+  "opflex_switch_send_queue_sent",
+  "opflex_switch_send_queue_dropped",
+  "opflex_switch_send_queue_blocked",
+  "opflex_switch_send_queue_avg_latency_us",
+  "opflex_switch_send_queue_max_latency_us"
+};
+
+static string send_queue_family_help[] =
+{
+  "number of openflow messages waiting to be written to the bridge",
+  "highest number of openflow messages waiting at once",
+  "number of openflow messages written to the bridge",
+  "number of openflow messages dropped on error or disconnect",
+  "number of senders that waited for space in the send queue",
+  "average time in microseconds an openflow message spent queued",
+  "longest time in microseconds an openflow message spent queued"
+};
+
 #define RETURN_IF_DISABLED  if (disabled) {return;}
 
 // construct PrometheusManager
@@ -355,10 +377,10 @@ void PrometheusManager::removeDynamicCounters ()
 // remove all dynamic counters during stop
 void PrometheusManager::removeDynamicGauges ()
 {
-    // Remove EpCounter related gauges
+    // Remove EpCounter related labels
     {
         const lock_guard<mutex> lock(ep_counter_mutex);
-        removeDynamicGaugeEp();
+        removeEpCounterLabels();
     }
 
     // Remove SvcTargetCounter related gauges
@@ -565,16 +587,8 @@ void PrometheusManager::createStaticGaugeFamiliesEp (void)
                          .Register(*registry_ptr);
     gauge_ep_total_family_ptr = &gauge_ep_total_family;
 
-    for (EP_METRICS metric=EP_RX_BYTES;
-            metric < EP_METRICS_MAX;
-                metric = EP_METRICS(metric+1)) {
-        auto& gauge_ep_family = BuildGauge()
-                             .Name(ep_family_names[metric])
-                             .Help(ep_family_help[metric])
-                             .Labels({})
-                             .Register(*registry_ptr);
-        gauge_ep_family_ptr[metric] = &gauge_ep_family;
-    }
+    // The per-ep gauge families are generated on every scrape by
+    // EpCounterCollector rather than being kept in the registry
 }
 
 // create all SvcTarget specific gauge families during start
@@ -663,6 +677,33 @@ void PrometheusManager::createStaticGaugeFamiliesTableDrop(void) {
     }
 }
 
+void PrometheusManager::createStaticGaugeFamiliesSendQueue(void) {
+    for (SEND_QUEUE_METRICS metric=SEND_QUEUE_METRICS_MIN;
+            metric <= SEND_QUEUE_METRICS_MAX;
+                metric = SEND_QUEUE_METRICS(metric+1)) {
+        auto& gauge_send_queue_family = BuildGauge()
+                             .Name(send_queue_family_names[metric])
+                             .Help(send_queue_family_help[metric])
+                             .Labels({})
+                             .Register(*registry_ptr);
+        gauge_send_queue_family_ptr[metric] = &gauge_send_queue_family;
+    }
+}
+
+// remove the send queue gauges of every bridge during stop
+void PrometheusManager::removeStaticGaugesSendQueue ()
+{
+    for (SEND_QUEUE_METRICS metric=SEND_QUEUE_METRICS_MIN;
+            metric <= SEND_QUEUE_METRICS_MAX;
+                metric = SEND_QUEUE_METRICS(metric+1)) {
+        for (const auto& itr : send_queue_gauge_map[metric]) {
+            gauge_check.remove(itr.second);
+            gauge_send_queue_family_ptr[metric]->Remove(itr.second);
+        }
+        send_queue_gauge_map[metric].clear();
+    }
+}
+
 // remove all static counters during stop
 void PrometheusManager::removeStaticGaugesTableDrop ()
 {
@@ -728,6 +769,11 @@ void PrometheusManager::createStaticGaugeFamilies (void)
 
     createStaticGaugeFamiliesTableDrop();
 
+    {
+        const lock_guard<mutex> lock(send_queue_mutex);
+        createStaticGaugeFamiliesSendQueue();
+    }
+
     {
         const lock_guard<mutex> lock(contract_stats_mutex);
         createStaticGaugeFamiliesContractClassifier();
@@ -796,6 +842,11 @@ void PrometheusManager::removeStaticGauges ()
     }
     // Remove TableDropCounter related gauges
     removeStaticGaugesTableDrop();
+    // Remove SendQueue related gauges
+    {
+        const lock_guard<mutex> lock(send_queue_mutex);
+        removeStaticGaugesSendQueue();
+    }
 
 }
 
@@ -865,6 +916,9 @@ void PrometheusManager::start (bool exposeLocalHostOnly, bool exposeEpSvcNan_)
 
     // ask the exposer to scrape the registry on incoming scrapes
     exposer_ptr->RegisterCollectable(registry_ptr);
+    // and to read the ep counters straight from the endpoint manager
+    ep_collector_ptr = make_shared<EpCounterCollector>(*this);
+    exposer_ptr->RegisterCollectable(ep_collector_ptr);
 
     string allowed;
     for (const auto& allow : agent.getPrometheusEpAttributes())
@@ -883,11 +937,6 @@ void PrometheusManager::init ()
         counter_ep_create_family_ptr = nullptr;
         counter_ep_remove_family_ptr = nullptr;
         gauge_ep_total_family_ptr = nullptr;
-        for (EP_METRICS metric=EP_RX_BYTES;
-                metric < EP_METRICS_MAX;
-                    metric = EP_METRICS(metric+1)) {
-            gauge_ep_family_ptr[metric] = nullptr;
-        }
     }
 
     {
@@ -960,6 +1009,15 @@ void PrometheusManager::init ()
         }
     }
 
+    {
+        const lock_guard<mutex> lock(send_queue_mutex);
+        for (SEND_QUEUE_METRICS metric=SEND_QUEUE_METRICS_MIN;
+                metric <= SEND_QUEUE_METRICS_MAX;
+                    metric = SEND_QUEUE_METRICS(metric+1)) {
+            gauge_send_queue_family_ptr[metric] = nullptr;
+        }
+    }
+
     {
         const lock_guard<mutex> lock(sgclassifier_stats_mutex);
         for (SGCLASSIFIER_METRICS metric=SGCLASSIFIER_METRICS_MIN;
@@ -1006,6 +1064,8 @@ void PrometheusManager::stop ()
     exposer_ptr.reset();
     exposer_ptr = nullptr;
 
+    ep_collector_ptr.reset();
+
     registry_ptr.reset();
     registry_ptr = nullptr;
 }
@@ -1538,74 +1598,101 @@ void PrometheusManager::createDynamicGaugePodSvc (PODSVC_METRICS metric,
     podsvc_gauge_map[metric][uuid] = make_pair(std::move(label_map), &gauge);
 }
 
-// Create EpCounter gauge given metric type and an uuid
-bool PrometheusManager::createDynamicGaugeEp (EP_METRICS metric,
-                                              const string& uuid,
-                                              const string& ep_name,
-                                              const size_t& attr_hash,
-                    const unordered_map<string, string>&    attr_map)
+// Create or relabel the EpCounter metrics of an ep
+bool PrometheusManager::createEpCounterLabels (const string& uuid,
+                                               const string& ep_name,
+                                               const size_t& attr_hash,
+                     const unordered_map<string, string>&    attr_map,
+                                               MetricsRegistry::id_t counter_id)
 {
-    /**
-     * We create a hash of all the key, value pairs in label attr_map
-     * and then maintain a map of uuid to another pair of all attr hash
-     * and gauge ptr
-     * {uuid: pair(old_all_attr_hash, gauge_ptr)}
-     */
-    auto hgauge = getDynamicGaugeEp(metric, uuid);
-    if (hgauge) {
+    auto itr = ep_label_map.find(uuid);
+    if (itr != ep_label_map.end()) {
+        itr->second.counter_id = counter_id;
         /**
          * Detect attribute change by comparing hashes:
          * Check incoming hash with the cached hash to detect attribute change
          * Note:
-         * - we dont do a delete and create of metric for every attribute change.
-         * Rather the dttribute's delete and create will get processed in EP Mgr.
+         * - we dont relabel the metric for every attribute change.
+         * Rather the attribute's delete and create will get processed in EP Mgr.
          * Then during periodic update of epCounter, we will detect attr change in
-         * PrometheusManager and do a delete/create of metric for latest label
+         * PrometheusManager and relabel the metric with the latest label
          * annotations.
-         * - by not doing del/add of metric for every attribute change, we reduce
-         * # of metric+label creation in prometheus.
          */
-        if (attr_hash == hgauge.get().first)
+        if (attr_hash == itr->second.attr_hash)
             return false;
-        else {
-            LOG(DEBUG) << "addNupdate epcounter: " << ep_name
-                       << " incoming attr_hash: " << attr_hash << "\n"
-                       << "existing ep metric, but deleting: hash modified;"
-                       << " metric: " << ep_family_names[metric]
-                       << " hash: " << hgauge.get().first
-                       << " gaugeptr: " << hgauge.get().second;
-            removeDynamicGaugeEp(metric, uuid);
-        }
+        LOG(DEBUG) << "addNupdate epcounter: " << ep_name
+                   << " incoming attr_hash: " << attr_hash << "\n"
+                   << "existing ep metric, but relabeling: hash modified;"
+                   << " hash: " << itr->second.attr_hash;
+        removeEpCounterLabels(uuid);
     }
 
     auto label_map = createLabelMapFromEpAttr(ep_name,
                                               attr_map,
                                               agent.getPrometheusEpAttributes());
     auto hash = hash_labels(label_map);
-    auto& gauge = gauge_ep_family_ptr[metric]->Add(label_map);
-    if (gauge_check.is_dup(&gauge)) {
-        LOG(ERROR) << "duplicate ep dyn gauge family: " << ep_name
-                   << " metric: " << metric
+    auto dup = ep_label_hashes.find(hash);
+    if (dup != ep_label_hashes.end()) {
+        LOG(ERROR) << "duplicate ep labels: " << ep_name
                    << " uuid: " << uuid
-                   << " label hash: " << hash
-                   << " gaugeptr: " << &gauge;
-        // Note: return true so that: if metrics are created before and later
-        // result in duplication due to change in attributes, the pre-duplicated
-        // metrics can get freed.
-        return true;
+                   << " existing uuid: " << dup->second
+                   << " label hash: " << hash;
+        return false;
     }
-    LOG(DEBUG) << "created ep dyn gauge family: " << ep_name
-               << " metric: " << metric
+    LOG(DEBUG) << "created ep counter labels: " << ep_name
                << " uuid: " << uuid
-               << " label hash: " << hash
-               << " gaugeptr: " << &gauge;
-    gauge_check.add(&gauge);
+               << " label hash: " << hash;
 
-    ep_gauge_map[metric][uuid] = make_pair(hash, &gauge);
+    EpCounterLabels& l = ep_label_map[uuid];
+    l.attr_hash = attr_hash;
+    l.label_hash = hash;
+    l.counter_id = counter_id;
+    for (const auto& label : label_map)
+        l.labels.push_back(ClientMetric::Label{label.first, label.second});
+    ep_label_hashes.emplace(hash, uuid);
 
     return true;
 }
 
+// Build the EpCounter metric families from the endpoint counter registry
+vector<MetricFamily> PrometheusManager::collectEpCounters ()
+{
+    static_assert((int)EP_METRICS_MAX == (int)EndpointManager::EP_COUNTER_MAX,
+                  "ep metrics must match the endpoint counter registry");
+
+    MetricsRegistry& registry =
+        agent.getEndpointManager().getEpCounterRegistry();
+    vector<MetricFamily> families(EP_METRICS_MAX);
+
+    const lock_guard<mutex> lock(ep_counter_mutex);
+    for (EP_METRICS metric=EP_RX_BYTES;
+            metric < EP_METRICS_MAX;
+                metric = EP_METRICS(metric+1)) {
+        families[metric].name = ep_family_names[metric];
+        families[metric].help = ep_family_help[metric];
+        families[metric].type = MetricType::Gauge;
+        families[metric].metric.reserve(ep_label_map.size());
+    }
+    for (const auto& ep : ep_label_map) {
+        const EpCounterLabels& l = ep.second;
+        for (EP_METRICS metric=EP_RX_BYTES;
+                metric < EP_METRICS_MAX;
+                    metric = EP_METRICS(metric+1)) {
+            ClientMetric m;
+            m.label = l.labels;
+            m.gauge.value = static_cast<double>(registry.get(l.counter_id,
+                                                             metric));
+            families[metric].metric.push_back(std::move(m));
+        }
+    }
+    return families;
+}
+
+vector<MetricFamily> PrometheusManager::EpCounterCollector::Collect () const
+{
+    return manager.collectEpCounters();
+}
+
 // Create a label map that can be used for annotation, given the ep attr map
 const map<string,string> PrometheusManager::createLabelMapFromSvcTargetAttr (
                                                            const string& nhip,
@@ -1905,21 +1992,6 @@ mgauge_pair_t PrometheusManager::getDynamicGaugePodSvc (PODSVC_METRICS metric,
     return mgauge;
 }
 
-// Get EpCounter gauge given the metric, uuid of EP
-hgauge_pair_t PrometheusManager::getDynamicGaugeEp (EP_METRICS metric,
-                                                   const string& uuid)
-{
-    hgauge_pair_t hgauge = boost::none;
-    auto itr = ep_gauge_map[metric].find(uuid);
-    if (itr == ep_gauge_map[metric].end()) {
-        LOG(DEBUG) << "Dyn Gauge EpCounter not found " << uuid;
-    } else {
-        hgauge = itr->second;
-    }
-
-    return hgauge;
-}
-
 // Remove dynamic ContractClassifierCounter gauge given a metic type and
 // name of srcEpg, dstEpg & classifier
 bool PrometheusManager::removeDynamicGaugeContractClassifier (CONTRACT_METRICS metric,
@@ -2261,51 +2333,30 @@ void PrometheusManager::removeDynamicGaugePodSvc ()
     }
 }
 
-// Remove dynamic EpCounter gauge given a metic type and ep uuid
-bool PrometheusManager::removeDynamicGaugeEp (EP_METRICS metric,
-                                              const string& uuid)
+// Remove the EpCounter labels of an ep
+bool PrometheusManager::removeEpCounterLabels (const string& uuid)
 {
-    auto hgauge = getDynamicGaugeEp(metric, uuid);
-    if (hgauge) {
-        ep_gauge_map[metric].erase(uuid);
-        gauge_check.remove(hgauge.get().second);
-        gauge_ep_family_ptr[metric]->Remove(hgauge.get().second);
-    } else {
-        LOG(DEBUG) << "remove dynamic gauge ep not found uuid:" << uuid;
+    auto itr = ep_label_map.find(uuid);
+    if (itr == ep_label_map.end()) {
+        LOG(DEBUG) << "remove ep counter labels not found uuid:" << uuid;
         return false;
     }
+    ep_label_hashes.erase(itr->second.label_hash);
+    ep_label_map.erase(itr);
     return true;
 }
 
-// Remove dynamic EpCounter gauge given a metic type
-void PrometheusManager::removeDynamicGaugeEp (EP_METRICS metric)
-{
-    auto itr = ep_gauge_map[metric].begin();
-    while (itr != ep_gauge_map[metric].end()) {
-        LOG(DEBUG) << "Delete Ep uuid: " << itr->first
-                   << " hash: " << itr->second.get().first
-                   << " Gauge: " << itr->second.get().second;
-        gauge_check.remove(itr->second.get().second);
-        gauge_ep_family_ptr[metric]->Remove(itr->second.get().second);
-        itr++;
-
-        if (metric == (EP_METRICS_MAX-1)) {
-            incStaticCounterEpRemove();
-            updateStaticGaugeEpTotal(false);
-        }
-    }
-
-    ep_gauge_map[metric].clear();
-}
-
-// Remove dynamic EpCounter gauges for all metrics
-void PrometheusManager::removeDynamicGaugeEp ()
+// Remove the EpCounter labels of every ep
+void PrometheusManager::removeEpCounterLabels ()
 {
-    for (EP_METRICS metric=EP_RX_BYTES;
-            metric < EP_METRICS_MAX;
-                metric = EP_METRICS(metric+1)) {
-        removeDynamicGaugeEp(metric);
+    for (const auto& ep : ep_label_map) {
+        LOG(DEBUG) << "Delete Ep uuid: " << ep.first
+                   << " hash: " << ep.second.attr_hash;
+        incStaticCounterEpRemove();
+        updateStaticGaugeEpTotal(false);
     }
+    ep_label_map.clear();
+    ep_label_hashes.clear();
 }
 
 // Remove all dynamically allocated counter families
@@ -2416,11 +2467,6 @@ void PrometheusManager::removeStaticGaugeFamiliesPodSvc()
 void PrometheusManager::removeStaticGaugeFamiliesEp()
 {
     gauge_ep_total_family_ptr = nullptr;
-    for (EP_METRICS metric=EP_RX_BYTES;
-            metric < EP_METRICS_MAX;
-                metric = EP_METRICS(metric+1)) {
-        gauge_ep_family_ptr[metric] = nullptr;
-    }
 }
 
 // Remove all statically allocated svc target gauge families
@@ -2454,6 +2500,15 @@ void PrometheusManager::removeStaticGaugeFamiliesTableDrop()
     }
 }
 
+void PrometheusManager::removeStaticGaugeFamiliesSendQueue()
+{
+    for (SEND_QUEUE_METRICS metric=SEND_QUEUE_METRICS_MIN;
+            metric <= SEND_QUEUE_METRICS_MAX;
+                metric = SEND_QUEUE_METRICS(metric+1)) {
+        gauge_send_queue_family_ptr[metric] = nullptr;
+    }
+}
+
 // Remove all statically allocated gauge families
 void PrometheusManager::removeStaticGaugeFamilies()
 {
@@ -2508,6 +2563,12 @@ void PrometheusManager::removeStaticGaugeFamilies()
     // TableDrop specific
     removeStaticGaugeFamiliesTableDrop();
 
+    // SendQueue specific
+    {
+        const lock_guard<mutex> lock(send_queue_mutex);
+        removeStaticGaugeFamiliesSendQueue();
+    }
+
     // ContractClassifierCounter specific
     {
         const lock_guard<mutex> lock(contract_stats_mutex);
@@ -3028,94 +3089,26 @@ void PrometheusManager::addNUpdateOFPeerStats (void)
 void PrometheusManager::addNUpdateEpCounter (const string& uuid,
                                              const string& ep_name,
                                              const size_t& attr_hash,
-                  const unordered_map<string, string>&    attr_map)
+                  const unordered_map<string, string>&    attr_map,
+                                             MetricsRegistry::id_t counter_id)
 {
     RETURN_IF_DISABLED
-    using namespace opflex::modb;
-    using namespace modelgbp::gbpe;
-    using namespace modelgbp::observer;
+    if (counter_id == MetricsRegistry::INVALID_ID)
+        return;
 
     const lock_guard<mutex> lock(ep_counter_mutex);
-    Mutator mutator(framework, "policyelement");
-    optional<shared_ptr<EpStatUniverse> > su =
-                            EpStatUniverse::resolve(framework);
-    if (su) {
-        optional<shared_ptr<EpCounter>> ep_counter =
-                            su.get()->resolveGbpeEpCounter(uuid);
-        if (ep_counter) {
-
-            // Create the gauge counters if they arent present already
-            for (EP_METRICS metric=EP_RX_BYTES;
-                    metric < EP_METRICS_MAX;
-                        metric = EP_METRICS(metric+1)) {
-                if (!createDynamicGaugeEp(metric,
-                                          uuid,
-                                          ep_name,
-                                          attr_hash,
-                                          attr_map)) {
-                    break;
-                }
-
-                if (metric == (EP_METRICS_MAX-1)) {
-                    incStaticCounterEpCreate();
-                    updateStaticGaugeEpTotal(true);
-                }
-            }
-
-            // Update the metrics
-            for (EP_METRICS metric=EP_RX_BYTES;
-                    metric < EP_METRICS_MAX;
-                        metric = EP_METRICS(metric+1)) {
-                hgauge_pair_t hgauge = getDynamicGaugeEp(metric, uuid);
-                optional<uint64_t>   metric_opt;
-                switch (metric) {
-                case EP_RX_BYTES:
-                    metric_opt = ep_counter.get()->getRxBytes();
-                    break;
-                case EP_RX_PKTS:
-                    metric_opt = ep_counter.get()->getRxPackets();
-                    break;
-                case EP_RX_DROPS:
-                    metric_opt = ep_counter.get()->getRxDrop();
-                    break;
-                case EP_RX_UCAST:
-                    metric_opt = ep_counter.get()->getRxUnicast();
-                    break;
-                case EP_RX_MCAST:
-                    metric_opt = ep_counter.get()->getRxMulticast();
-                    break;
-                case EP_RX_BCAST:
-                    metric_opt = ep_counter.get()->getRxBroadcast();
-                    break;
-                case EP_TX_BYTES:
-                    metric_opt = ep_counter.get()->getTxBytes();
-                    break;
-                case EP_TX_PKTS:
-                    metric_opt = ep_counter.get()->getTxPackets();
-                    break;
-                case EP_TX_DROPS:
-                    metric_opt = ep_counter.get()->getTxDrop();
-                    break;
-                case EP_TX_UCAST:
-                    metric_opt = ep_counter.get()->getTxUnicast();
-                    break;
-                case EP_TX_MCAST:
-                    metric_opt = ep_counter.get()->getTxMulticast();
-                    break;
-                case EP_TX_BCAST:
-                    metric_opt = ep_counter.get()->getTxBroadcast();
-                    break;
-                default:
-                    LOG(ERROR) << "Unhandled metric: " << metric;
-                }
-                if (metric_opt && hgauge)
-                    hgauge.get().second->Set(static_cast<double>(metric_opt.get()));
-                if (!hgauge) {
-                    LOG(ERROR) << "ep stats invalid update for uuid: " << uuid;
-                    break;
-                }
-            }
-        }
+    // The values are read from the registry at scrape time, so there
+    // is only something to do when the ep is new or its labels changed
+    bool existed = ep_label_map.find(uuid) != ep_label_map.end();
+    createEpCounterLabels(uuid, ep_name, attr_hash, attr_map, counter_id);
+    bool exists = ep_label_map.find(uuid) != ep_label_map.end();
+    if (exists && !existed) {
+        incStaticCounterEpCreate();
+        updateStaticGaugeEpTotal(true);
+    } else if (existed && !exists) {
+        // relabeled onto labels that another ep already has
+        incStaticCounterEpRemove();
+        updateStaticGaugeEpTotal(false);
     }
 }
 
@@ -3210,16 +3203,9 @@ void PrometheusManager::removeEpCounter (const string& uuid,
     const lock_guard<mutex> lock(ep_counter_mutex);
     LOG(DEBUG) << "remove ep counter " << ep_name;
 
-    for (EP_METRICS metric=EP_RX_BYTES;
-            metric < EP_METRICS_MAX;
-                metric = EP_METRICS(metric+1)) {
-        if (!removeDynamicGaugeEp(metric, uuid))
-            break;
-
-        if (metric == (EP_METRICS_MAX-1)) {
-            incStaticCounterEpRemove();
-            updateStaticGaugeEpTotal(false);
-        }
+    if (removeEpCounterLabels(uuid)) {
+        incStaticCounterEpRemove();
+        updateStaticGaugeEpTotal(false);
     }
 }
 
@@ -3389,4 +3375,66 @@ void PrometheusManager::updateTableDropGauge (const string& bridge_name,
     }
 }
 
+/* Function called from InterfaceStatsManager to create/update the
+ * SendQueue metrics of a bridge connection */
+void PrometheusManager::addNUpdateSendQueueGauge (const string& bridge_name,
+                                                  uint64_t depth,
+                                                  uint64_t max_depth,
+                                                  uint64_t sent,
+                                                  uint64_t dropped,
+                                                  uint64_t blocked,
+                                                  uint64_t avg_latency_us,
+                                                  uint64_t max_latency_us)
+{
+    RETURN_IF_DISABLED
+    if (bridge_name.empty())
+        return;
+
+    const uint64_t values[SEND_QUEUE_METRICS_MAX+1] =
+        {depth, max_depth, sent, dropped, blocked,
+         avg_latency_us, max_latency_us};
+
+    const lock_guard<mutex> lock(send_queue_mutex);
+    for (SEND_QUEUE_METRICS metric=SEND_QUEUE_METRICS_MIN;
+            metric <= SEND_QUEUE_METRICS_MAX;
+                metric = SEND_QUEUE_METRICS(metric+1)) {
+        Gauge *pgauge = nullptr;
+        const auto& itr = send_queue_gauge_map[metric].find(bridge_name);
+        if (itr != send_queue_gauge_map[metric].end()) {
+            pgauge = itr->second;
+        } else {
+            auto& gauge = gauge_send_queue_family_ptr[metric]->Add(
+                                                {{"bridge", bridge_name}});
+            if (gauge_check.is_dup(&gauge)) {
+                LOG(ERROR) << "duplicate send queue gauge"
+                           << " bridge_name: " << bridge_name;
+                return;
+            }
+            LOG(DEBUG) << "created send queue gauge"
+                       << " bridge_name: " << bridge_name
+                       << " metric: " << metric;
+            gauge_check.add(&gauge);
+            send_queue_gauge_map[metric][bridge_name] = &gauge;
+            pgauge = &gauge;
+        }
+        pgauge->Set(static_cast<double>(values[metric]));
+    }
+}
+
+void PrometheusManager::removeSendQueueGauge (const string& bridge_name)
+{
+    RETURN_IF_DISABLED
+    const lock_guard<mutex> lock(send_queue_mutex);
+    for (SEND_QUEUE_METRICS metric=SEND_QUEUE_METRICS_MIN;
+            metric <= SEND_QUEUE_METRICS_MAX;
+                metric = SEND_QUEUE_METRICS(metric+1)) {
+        const auto& itr = send_queue_gauge_map[metric].find(bridge_name);
+        if (itr == send_queue_gauge_map[metric].end())
+            continue;
+        gauge_check.remove(itr->second);
+        gauge_send_queue_family_ptr[metric]->Remove(itr->second);
+        send_queue_gauge_map[metric].erase(itr);
+    }
+}
+
 } /* namespace opflexagent */
@@ -14,6 +14,9 @@
 #include <arpa/inet.h>
 #include <ifaddrs.h>
 #endif
+#ifdef HAVE_LINUX_RTNETLINK_H
+#include <linux/rtnetlink.h>
+#endif
 #include <fstream>
 #include <cerrno>
 #include <random>
@@ -43,21 +46,26 @@ using boost::uuids::to_string;
 using boost::uuids::basic_random_generator;
 using boost::asio::deadline_timer;
 using boost::asio::placeholders::error;
+using boost::asio::placeholders::bytes_transferred;
+using boost::asio::posix::stream_descriptor;
 using boost::posix_time::milliseconds;
 using boost::system::error_code;
 
 TunnelEpManager::TunnelEpManager(Agent* agent_, long timer_interval_)
     : agent(agent_), renderer(nullptr),
       agent_io(agent_->getAgentIOService()),
-      timer_interval(timer_interval_), stopping(false), uplinkVlan(0),
-      terminationIpIsV4(false) {
+      timer_interval(timer_interval_), stopping(false), netlinkDump(0),
+      uplinkVlan(0), terminationIpIsV4(false) {
     std::random_device rng;
     std::mt19937 urng(rng());
     tunnelEpUUID = to_string(basic_random_generator<std::mt19937>(urng)());
+#ifdef HAVE_LINUX_RTNETLINK_H
+    netlinkSocket.reset(new RtnetlinkSocket());
+#endif
 }
 
 TunnelEpManager::~TunnelEpManager() {
-
+    stopNetlink();
 }
 
 void TunnelEpManager::start() {
@@ -71,13 +79,21 @@ void TunnelEpManager::start() {
         root.get()->addGbpeTunnelEpUniverse();
     mutator.commit();
 
+    // the uplink address is discovered from netlink notifications,
+    // unless the renderer provides it
+    if (!(renderer && renderer->isUplinkAddressImplemented()) &&
+        startNetlink())
+        return;
+    startPolling();
+}
+
+void TunnelEpManager::startPolling() {
 #ifdef HAVE_IFADDRS_H
     timer.reset(new deadline_timer(agent_io, milliseconds(0)));
     timer->async_wait(bind(&TunnelEpManager::on_timer, this, error));
 #else
     LOG(ERROR) << "Cannot enumerate interfaces: unsupported platform";
 #endif
-
 }
 
 void TunnelEpManager::stop() {
@@ -87,6 +103,9 @@ void TunnelEpManager::stop() {
     if (timer) {
         timer->cancel();
     }
+    if (netlinkDesc) {
+        netlinkDesc->cancel();
+    }
 }
 
 const std::string& TunnelEpManager::getTerminationIp(const std::string& uuid) {
@@ -272,6 +291,17 @@ void TunnelEpManager::on_timer(const error_code& ec) {
 #endif
     }
 
+    updateTerminationEp(bestAddress, bestMac, bestIface);
+
+    if (!stopping) {
+        timer->expires_at(timer->expires_at() + milliseconds(timer_interval));
+        timer->async_wait(bind(&TunnelEpManager::on_timer, this, error));
+    }
+}
+
+void TunnelEpManager::updateTerminationEp(const string& bestAddress,
+                                          const string& bestMac,
+                                          const string& bestIface) {
     if ((!bestAddress.empty() && bestAddress != terminationIp) ||
         (!bestMac.empty() && bestMac != terminationMac)) {
         {
@@ -304,11 +334,113 @@ void TunnelEpManager::on_timer(const error_code& ec) {
 
         notifyListeners(tunnelEpUUID);
     }
+}
 
-    if (!stopping) {
-        timer->expires_at(timer->expires_at() + milliseconds(timer_interval));
-        timer->async_wait(bind(&TunnelEpManager::on_timer, this, error));
+bool TunnelEpManager::startNetlink() {
+#ifdef HAVE_LINUX_RTNETLINK_H
+    stopNetlink();
+    if (!netlinkSocket)
+        return false;
+    int fd = netlinkSocket->open();
+    if (fd < 0) {
+        LOG(WARNING) << "Could not subscribe to interface changes, "
+                     << "polling interfaces every " << timer_interval << "ms";
+        return false;
+    }
+    netlinkDesc.reset(new stream_descriptor(agent_io, fd));
+    // large enough for a datagram of a dump
+    netlinkBuf.resize(64 * 1024);
+    addrCache.clear();
+    if (!requestNetlinkDump(RTM_GETLINK)) {
+        stopNetlink();
+        return false;
     }
+    readNetlink();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TunnelEpManager::stopNetlink() {
+    if (netlinkDesc) {
+        // the file descriptor is owned by the netlink socket
+        netlinkDesc->release();
+        netlinkDesc.reset();
+    }
+    if (netlinkSocket)
+        netlinkSocket->close();
+    netlinkDump = 0;
+}
+
+bool TunnelEpManager::requestNetlinkDump(uint16_t type) {
+    netlinkDump = type;
+    return netlinkSocket->requestDump(type);
+}
+
+void TunnelEpManager::readNetlink() {
+    netlinkDesc->async_read_some(boost::asio::buffer(netlinkBuf),
+                                 bind(&TunnelEpManager::on_netlink, this,
+                                      error, bytes_transferred));
+}
+
+void TunnelEpManager::on_netlink(const error_code& ec, std::size_t len) {
+#ifdef HAVE_LINUX_RTNETLINK_H
+    if (ec == boost::asio::error::operation_aborted) {
+        if (stopping)
+            stopNetlink();
+        return;
+    }
+
+    bool ok = true;
+    int result = 0;
+    if (ec) {
+        if (ec.value() == ENOBUFS) {
+            // notifications were dropped, so rebuild the cache
+            LOG(WARNING) << "Interface notifications lost, resyncing";
+            addrCache.clear();
+            ok = requestNetlinkDump(RTM_GETLINK);
+        } else {
+            LOG(ERROR) << "Could not read interface notifications: "
+                       << ec.message();
+            ok = false;
+        }
+    } else {
+        result = addrCache.apply(netlinkBuf.data(), len);
+        if ((result & InterfaceAddrCache::FAILED) && netlinkDump != 0) {
+            LOG(ERROR) << "Interface dump failed";
+            ok = false;
+        } else if (result & InterfaceAddrCache::DUMP_DONE) {
+            if (netlinkDump == RTM_GETLINK) {
+                ok = requestNetlinkDump(RTM_GETADDR);
+            } else if (netlinkDump == RTM_GETADDR) {
+                netlinkDump = 0;
+                result |= InterfaceAddrCache::CHANGED;
+            }
+        }
+    }
+
+    if (!ok) {
+        LOG(WARNING) << "Polling interfaces every " << timer_interval << "ms";
+        stopNetlink();
+        startPolling();
+        return;
+    }
+
+    if (netlinkDump == 0 && (result & InterfaceAddrCache::CHANGED)) {
+        string bestAddress;
+        string bestIface;
+        string bestMac;
+        bool bestAddrIsV4 = false;
+        addrCache.getUplink(uplinkIface, bestAddress, bestMac, bestIface,
+                            bestAddrIsV4);
+        terminationIpIsV4 = bestAddrIsV4;
+        updateTerminationEp(bestAddress, bestMac, bestIface);
+    }
+
+    if (!stopping)
+        readNetlink();
+#endif
 }
 
 void TunnelEpManager::registerListener(EndpointListener* listener) {
@@ -361,6 +361,10 @@ private:
     boost::uint_t<64>::fast prr_timer = 7200;  /* seconds */
     /* handshake timeout */
     uint32_t peerHandshakeTimeout = 45000;
+    /* offer compressed opflex messages to peers */
+    bool opflexCompression = false;
+    /* send resolves to one primary peer per role */
+    bool opflexPrimaryRouting = false;
 
     std::set<std::string> endpointSourceFSPaths;
     std::set<std::string> disabledFeaturesSet;
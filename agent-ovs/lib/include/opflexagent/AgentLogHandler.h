@@ -15,6 +15,8 @@
 #ifndef OPFLEXAGENT_AGENTLOGHANDLER_H
 #define OPFLEXAGENT_AGENTLOGHANDLER_H
 
+#include <opflexagent/logging.h>
+
 #include <opflex/logging/OFLogHandler.h>
 
 namespace opflexagent {
@@ -42,6 +44,15 @@ public:
                                const opflex::logging::OFLogHandler::Level level,
                                const std::string& message);
 
+    /**
+     * Map an OpFlex framework log level to the agent log level that
+     * it is written at
+     *
+     * @param level the framework log level
+     * @return the corresponding agent log level
+     */
+    static LogLevel toAgentLevel(opflex::logging::OFLogHandler::Level level);
+
     /**
      * Implement opflex::logging::OFLogHandler::setLevel
      */
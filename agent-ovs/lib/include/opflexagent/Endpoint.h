@@ -13,6 +13,8 @@
 #ifndef OPFLEXAGENT_ENDPOINT_H
 #define OPFLEXAGENT_ENDPOINT_H
 
+#include <opflexagent/Network.h>
+
 #include <opflex/modb/URI.h>
 #include <opflex/modb/MAC.h>
 
@@ -155,24 +157,31 @@ public:
         return ips;
     }
 
+    /**
+     * Get the IP addresses associated with this endpoint, parsed
+     * into prefixes.  An address without a prefix length is a host
+     * prefix, and invalid addresses are omitted.
+     *
+     * @return the IP address prefixes
+     */
+    const std::vector<network::ip_prefix>& getIPPrefixes() const {
+        return ipPrefixes;
+    }
+
     /**
      * Set the IP addresses for this endpoint.  This will overwrite
      * any existing IP addresses
      *
      * @param ips the IP addresses
      */
-    void setIPs(const std::unordered_set<std::string>& ips) {
-        this->ips = ips;
-    }
+    void setIPs(const std::unordered_set<std::string>& ips);
 
     /**
      * Add an IP address to the list of IPs
      *
      * @param ip the IP address to add
      */
-    void addIP(const std::string& ip) {
-        this->ips.insert(ip);
-    }
+    void addIP(const std::string& ip);
 
     /**
      * Get the list of IP addresses that are valid sources for anycast
@@ -184,6 +193,16 @@ public:
         return anycastReturnIps;
     }
 
+    /**
+     * Get the IP addresses that are valid sources for anycast service
+     * addresses, parsed.  Invalid addresses are omitted.
+     *
+     * @return the IP addresses
+     */
+    const std::vector<network::ip_addr>& getAnycastReturnAddrs() const {
+        return anycastReturnAddrs;
+    }
+
     /**
      * Set the list of IP addresses that are valid sources for anycast
      * service addresses.  This will overwrite any existing IP
@@ -191,9 +210,7 @@ public:
      *
      * @param ips the IP addresses
      */
-    void setAnycastReturnIPs(const std::unordered_set<std::string>& ips) {
-        this->anycastReturnIps = ips;
-    }
+    void setAnycastReturnIPs(const std::unordered_set<std::string>& ips);
 
     /**
      * Add an IP address to the list of IPs that are valid sources for
@@ -201,9 +218,7 @@ public:
      *
      * @param ip the IP address to add
      */
-    void addAnycastReturnIP(const std::string& ip) {
-        this->anycastReturnIps.insert(ip);
-    }
+    void addAnycastReturnIP(const std::string& ip);
 
     /**
      * A MAC/IP address pair representing a virtual IP that can be
@@ -1308,8 +1323,15 @@ public:
 private:
     std::string uuid;
     boost::optional<opflex::modb::MAC> mac;
+    // The address strings are kept as the source gave them: they form
+    // the L3 endpoint URIs and the IP to endpoint index keys in
+    // EndpointManager and are written back out in the endpoint's
+    // string form.  Formatting them from the parsed prefixes would
+    // change those keys for input that is not in canonical form.
     std::unordered_set<std::string> ips;
+    std::vector<network::ip_prefix> ipPrefixes;
     std::unordered_set<std::string> anycastReturnIps;
+    std::vector<network::ip_addr> anycastReturnAddrs;
     virt_ip_set virtualIps;
     boost::optional<std::string> egMappingAlias;
     boost::optional<opflex::modb::URI> egURI;
@@ -0,0 +1,410 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Include file for endpoint index classes
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_ENDPOINTINDEX_H
+#define OPFLEXAGENT_ENDPOINTINDEX_H
+
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace opflexagent {
+
+/**
+ * Assigns dense integer handles to endpoint UUIDs, so that endpoint
+ * indexes store a 32-bit handle rather than a copy of the UUID.  A
+ * UUID keeps its handle as long as it is referenced, and the handles
+ * of released UUIDs are reused.
+ *
+ * The table of UUIDs is copy-on-write in fixed size chunks: a
+ * snapshot from getTable() keeps resolving the handles it covered
+ * even after they are released or reused, while an update with no
+ * snapshot outstanding changes the table in place.
+ *
+ * Not thread safe; the owner serializes updates and snapshots.
+ */
+class EndpointHandleTable : private boost::noncopyable {
+public:
+    /**
+     * A dense endpoint handle
+     */
+    typedef uint32_t handle_t;
+
+    /**
+     * Number of UUIDs in each chunk of the table
+     */
+    static const size_t CHUNK_SIZE = 256;
+
+    /**
+     * A chunk of the UUID table
+     */
+    typedef std::array<std::string, CHUNK_SIZE> chunk_t;
+
+    /**
+     * The UUID table, indexed by handle / CHUNK_SIZE
+     */
+    typedef std::vector<std::shared_ptr<chunk_t> > table_t;
+
+    EndpointHandleTable();
+
+    /**
+     * Take a reference to the handle for a UUID, assigning a handle
+     * if the UUID has none
+     *
+     * @param uuid the endpoint UUID
+     * @return the handle for the UUID
+     */
+    handle_t acquire(const std::string& uuid);
+
+    /**
+     * Drop a reference taken with acquire.  The handle is freed when
+     * its last reference is dropped.
+     *
+     * @param handle the handle to release
+     */
+    void release(handle_t handle);
+
+    /**
+     * Look up the handle for a UUID
+     *
+     * @param uuid the endpoint UUID
+     * @param handle set to the handle if the UUID has one
+     * @return true if the UUID has a handle
+     */
+    bool find(const std::string& uuid, /* out */ handle_t& handle) const;
+
+    /**
+     * Get the UUID for a handle in use
+     *
+     * @param handle the handle
+     * @return the UUID for the handle
+     */
+    const std::string& get(handle_t handle) const {
+        return (*(*table)[handle / CHUNK_SIZE])[handle % CHUNK_SIZE];
+    }
+
+    /**
+     * Get a snapshot of the UUID table that resolves the handles in
+     * use now, and is not changed by later updates
+     */
+    std::shared_ptr<const table_t> getTable() const { return table; }
+
+    /**
+     * Get the number of handles in use
+     */
+    size_t size() const { return refs.size(); }
+
+    /**
+     * Check whether the given shared state is referenced only by its
+     * owner, and so can be updated in place.  Snapshots are only
+     * taken and dropped under the owner's lock, or dropped by
+     * readers, so a count of one stays valid until the owner takes
+     * another snapshot.
+     *
+     * @param p the state to check
+     * @return true if no snapshot references the state
+     */
+    template <typename T>
+    static bool isUnique(const std::shared_ptr<T>& p) {
+        if (p.use_count() != 1) return false;
+        // order the update after the reads of the reader that dropped
+        // the last snapshot
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+private:
+    // UUID -> handle and its reference count
+    std::unordered_map<std::string, std::pair<handle_t, uint32_t> > refs;
+    std::shared_ptr<table_t> table;
+    std::vector<handle_t> freeHandles;
+    handle_t nextHandle;
+
+    std::string& slot(handle_t handle);
+};
+
+/**
+ * A read-only set of endpoint UUIDs taken from an EndpointIndex.  A
+ * view is a snapshot: it can be read without holding the lock of the
+ * index owner, and is not changed by later updates to the index.
+ */
+class EndpointUUIDView {
+public:
+    /**
+     * An iterator over the UUIDs in the view
+     */
+    class const_iterator {
+    public:
+        /** iterator category */
+        typedef std::forward_iterator_tag iterator_category;
+        /** value type */
+        typedef std::string value_type;
+        /** difference type */
+        typedef std::ptrdiff_t difference_type;
+        /** pointer type */
+        typedef const std::string* pointer;
+        /** reference type */
+        typedef const std::string& reference;
+
+        /** Create an iterator at the given position in the view */
+        const_iterator(const EndpointUUIDView* view_, size_t pos_)
+            : view(view_), pos(pos_) {}
+        /** Get the current UUID */
+        reference operator*() const { return (*view)[pos]; }
+        /** Get the current UUID */
+        pointer operator->() const { return &(*view)[pos]; }
+        /** Advance the iterator */
+        const_iterator& operator++() { ++pos; return *this; }
+        /** Advance the iterator */
+        const_iterator operator++(int) {
+            const_iterator r(*this); ++pos; return r;
+        }
+        /** Compare iterators */
+        bool operator==(const const_iterator& o) const {
+            return pos == o.pos;
+        }
+        /** Compare iterators */
+        bool operator!=(const const_iterator& o) const {
+            return pos != o.pos;
+        }
+    private:
+        const EndpointUUIDView* view;
+        size_t pos;
+    };
+
+    /**
+     * Create an empty view
+     */
+    EndpointUUIDView() {}
+
+    /**
+     * Create a view of the given handles
+     *
+     * @param handles_ the endpoint handles
+     * @param table_ a snapshot of the table that resolves them
+     */
+    EndpointUUIDView(std::shared_ptr<const std::vector<
+                         EndpointHandleTable::handle_t> > handles_,
+                     std::shared_ptr<const EndpointHandleTable::table_t>
+                         table_)
+        : handles(std::move(handles_)), table(std::move(table_)) {}
+
+    /** Get the number of UUIDs in the view */
+    size_t size() const { return handles ? handles->size() : 0; }
+    /** Check whether the view is empty */
+    bool empty() const { return size() == 0; }
+
+    /** Get the UUID at the given position */
+    const std::string& operator[](size_t pos) const {
+        EndpointHandleTable::handle_t h = (*handles)[pos];
+        return (*(*table)[h / EndpointHandleTable::CHUNK_SIZE])
+            [h % EndpointHandleTable::CHUNK_SIZE];
+    }
+
+    /** Get an iterator to the first UUID */
+    const_iterator begin() const { return const_iterator(this, 0); }
+    /** Get an iterator past the last UUID */
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    std::shared_ptr<const std::vector<EndpointHandleTable::handle_t> >
+        handles;
+    std::shared_ptr<const EndpointHandleTable::table_t> table;
+};
+
+/**
+ * A secondary index from keys to sets of endpoints.  Each set is a
+ * sorted vector of endpoint handles that is copied on write only
+ * while a view of it is outstanding.
+ *
+ * Not thread safe; the owner serializes updates and lookups, but the
+ * views returned by get() may be read and dropped without locking.
+ *
+ * @param K the key type
+ * @param Hash the hash function for the key type
+ */
+template <typename K, typename Hash = std::hash<K> >
+class EndpointIndex : private boost::noncopyable {
+public:
+    /**
+     * A set of endpoint handles
+     */
+    typedef std::vector<EndpointHandleTable::handle_t> handle_vec_t;
+
+    /**
+     * The map from keys to sets of endpoint handles
+     */
+    typedef std::unordered_map<K, std::shared_ptr<handle_vec_t>, Hash>
+        map_t;
+
+    /**
+     * Iterator over the keys of the index and their handles
+     */
+    typedef typename map_t::const_iterator const_iterator;
+
+    /**
+     * Create an index that stores handles from the given table
+     *
+     * @param handles_ the handle table shared by the indexes of an
+     * owner
+     */
+    explicit EndpointIndex(EndpointHandleTable& handles_)
+        : handles(handles_) {}
+
+    ~EndpointIndex() { clear(); }
+
+    /**
+     * Add an endpoint to the set for a key
+     *
+     * @param key the key
+     * @param uuid the endpoint UUID
+     * @return true if the endpoint was not already in the set
+     */
+    bool insert(const K& key, const std::string& uuid) {
+        EndpointHandleTable::handle_t h = handles.acquire(uuid);
+        std::shared_ptr<handle_vec_t>& hv = map[key];
+        if (!hv) {
+            hv = std::make_shared<handle_vec_t>(1, h);
+            return true;
+        }
+        auto it = std::lower_bound(hv->begin(), hv->end(), h);
+        if (it != hv->end() && *it == h) {
+            handles.release(h);
+            return false;
+        }
+        if (!EndpointHandleTable::isUnique(hv)) {
+            size_t pos = it - hv->begin();
+            hv = std::make_shared<handle_vec_t>(*hv);
+            it = hv->begin() + pos;
+        }
+        hv->insert(it, h);
+        return true;
+    }
+
+    /**
+     * Remove an endpoint from the set for a key.  The key is removed
+     * with its last endpoint.
+     *
+     * @param key the key
+     * @param uuid the endpoint UUID
+     * @return true if the endpoint was in the set
+     */
+    bool erase(const K& key, const std::string& uuid) {
+        EndpointHandleTable::handle_t h;
+        if (!handles.find(uuid, h)) return false;
+        auto mit = map.find(key);
+        if (mit == map.end()) return false;
+        std::shared_ptr<handle_vec_t>& hv = mit->second;
+        auto it = std::lower_bound(hv->begin(), hv->end(), h);
+        if (it == hv->end() || *it != h) return false;
+        if (hv->size() == 1) {
+            map.erase(mit);
+        } else {
+            if (!EndpointHandleTable::isUnique(hv)) {
+                size_t pos = it - hv->begin();
+                hv = std::make_shared<handle_vec_t>(*hv);
+                it = hv->begin() + pos;
+            }
+            hv->erase(it);
+        }
+        handles.release(h);
+        return true;
+    }
+
+    /**
+     * Check whether any endpoint is in the set for a key
+     */
+    bool contains(const K& key) const {
+        return map.find(key) != map.end();
+    }
+
+    /**
+     * Check whether an endpoint is in the set for a key
+     */
+    bool contains(const K& key, const std::string& uuid) const {
+        EndpointHandleTable::handle_t h;
+        if (!handles.find(uuid, h)) return false;
+        auto mit = map.find(key);
+        if (mit == map.end()) return false;
+        return std::binary_search(mit->second->begin(),
+                                  mit->second->end(), h);
+    }
+
+    /**
+     * Get a view of the endpoints in the set for a key
+     *
+     * @param key the key
+     * @return the view, which is empty if there is no such key
+     */
+    EndpointUUIDView get(const K& key) const {
+        auto mit = map.find(key);
+        if (mit == map.end()) return EndpointUUIDView();
+        return EndpointUUIDView(mit->second, handles.getTable());
+    }
+
+    /**
+     * Add the endpoints in the set for a key to a set of UUIDs
+     */
+    void get(const K& key,
+             /* out */ std::unordered_set<std::string>& uuids) const {
+        auto mit = map.find(key);
+        if (mit == map.end()) return;
+        for (EndpointHandleTable::handle_t h : *mit->second)
+            uuids.insert(handles.get(h));
+    }
+
+    /**
+     * Add the endpoints in the sets for all keys to a set of UUIDs
+     */
+    void getAll(/* out */ std::unordered_set<std::string>& uuids) const {
+        for (const auto& e : map) {
+            for (EndpointHandleTable::handle_t h : *e.second)
+                uuids.insert(handles.get(h));
+        }
+    }
+
+    /**
+     * Remove all keys and endpoints from the index
+     */
+    void clear() {
+        for (const auto& e : map) {
+            for (EndpointHandleTable::handle_t h : *e.second)
+                handles.release(h);
+        }
+        map.clear();
+    }
+
+    /** Get the number of keys in the index */
+    size_t size() const { return map.size(); }
+    /** Get an iterator to the first key */
+    const_iterator begin() const { return map.begin(); }
+    /** Get an iterator past the last key */
+    const_iterator end() const { return map.end(); }
+
+private:
+    EndpointHandleTable& handles;
+    map_t map;
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_ENDPOINTINDEX_H */
@@ -19,7 +19,9 @@
 
 #include <opflexagent/Endpoint.h>
 #include <opflexagent/EndpointListener.h>
+#include <opflexagent/EndpointIndex.h>
 #include <opflexagent/PolicyManager.h>
+#include <opflexagent/MetricsRegistry.h>
 #ifdef HAVE_PROMETHEUS_SUPPORT
 #include <opflexagent/PrometheusManager.h>
 #endif
@@ -34,6 +36,7 @@
 #include <unordered_set>
 #include <memory>
 #include <mutex>
+#include <chrono>
 
 namespace opflexagent {
 
@@ -130,6 +133,16 @@ public:
     void getEndpointsForGroup(const opflex::modb::URI& egURI,
                               /* out */ std::unordered_set<std::string>& eps);
 
+    /**
+     * Get a view of the endpoints that exist for a given endpoint
+     * group.  The view does not copy the UUIDs, and can be read
+     * without locking since later updates do not change it.
+     *
+     * @param egURI the URI for the endpoint group
+     * @return the UUIDs of matching endpoints
+     */
+    EndpointUUIDView getEndpointsForGroup(const opflex::modb::URI& egURI);
+
     /**
      * Check whether the given security group set contains any endpoints
      *
@@ -160,6 +173,17 @@ public:
     void getEndpointsForIPMGroup(const opflex::modb::URI& egURI,
                                  /* out */ std::unordered_set<std::string>& eps);
 
+    /**
+     * Get a view of the endpoints with IP address mappings mapped to
+     * the given endpoint group
+     *
+     * @param egURI the URI for the endpoint group for the ip address
+     * mappings
+     * @return the UUIDs of matching endpoints
+     * @see getEndpointsForGroup(const opflex::modb::URI&)
+     */
+    EndpointUUIDView getEndpointsForIPMGroup(const opflex::modb::URI& egURI);
+
     /**
      * Get the endpoints that are on a particular integration interface
      *
@@ -170,6 +194,16 @@ public:
     void getEndpointsByIface(const std::string& ifaceName,
                              /* out */ std::unordered_set<std::string>& eps);
 
+    /**
+     * Get a view of the endpoints that are on a particular
+     * integration interface
+     *
+     * @param ifaceName the name of the interface
+     * @return the UUIDs of matching endpoints
+     * @see getEndpointsForGroup(const opflex::modb::URI&)
+     */
+    EndpointUUIDView getEndpointsByIface(const std::string& ifaceName);
+
     /**
      * Get all endpoints
      *
@@ -185,6 +219,14 @@ public:
      */
     const ip_ep_map_t& getIPLocalEpMap(void);
 
+    /**
+     * Get the local endpoint with the given IP address
+     *
+     * @param ip the IP address
+     * @return the endpoint, or an empty pointer if there is none
+     */
+    std::shared_ptr<const Endpoint> getLocalEndpointByIP(const std::string& ip);
+
     /**
      * Get the endpoints that are on a particular access interface
      *
@@ -195,6 +237,16 @@ public:
     void getEndpointsByAccessIface(const std::string& ifaceName,
                                    /* out */ std::unordered_set<std::string>& eps);
 
+    /**
+     * Get a view of the endpoints that are on a particular access
+     * interface
+     *
+     * @param ifaceName the name of the interface
+     * @return the UUIDs of matching endpoints
+     * @see getEndpointsForGroup(const opflex::modb::URI&)
+     */
+    EndpointUUIDView getEndpointsByAccessIface(const std::string& ifaceName);
+
     /**
      * Get the endpoints that are on a particular access uplink interface
      *
@@ -304,7 +356,22 @@ public:
     };
 
     /**
-     * Update the counters for an endpoint to the specified values
+     * Index of each endpoint counter in the endpoint counter
+     * registry.  PrometheusManager relies on this order.
+     */
+    enum EpCounterIndex {
+        EP_RX_BYTES, EP_RX_PKTS, EP_RX_DROPS,
+        EP_RX_UCAST, EP_RX_MCAST, EP_RX_BCAST,
+        EP_TX_BYTES, EP_TX_PKTS, EP_TX_DROPS,
+        EP_TX_UCAST, EP_TX_MCAST, EP_TX_BCAST,
+        EP_COUNTER_MAX
+    };
+
+    /**
+     * Update the counters for an endpoint to the specified values.
+     * The values are stored in the endpoint counter registry, and
+     * also published to the EpCounter object in the MODB subject to
+     * the counter publish interval.
      *
      * @param uuid the UUID of the endpoint to update
      * @param newVals the new counter values
@@ -312,6 +379,23 @@ public:
     void updateEndpointCounters(const std::string& uuid,
                                 EpCounters& newVals);
 
+    /**
+     * Get the registry holding the latest counters for each local
+     * endpoint, keyed by endpoint UUID and indexed by EpCounterIndex
+     *
+     * @return the endpoint counter registry
+     */
+    MetricsRegistry& getEpCounterRegistry() { return epCounterRegistry; }
+
+    /**
+     * Set how often endpoint counters are published to the MODB.
+     *
+     * @param interval minimum time in milliseconds between updates
+     * to the EpCounter object of an endpoint.  Zero publishes every
+     * update and a negative value disables publishing.
+     */
+    void setCounterPublishInterval(long interval);
+
     // see PolicyListener
     virtual void egDomainUpdated(const opflex::modb::URI& egURI);
 
@@ -399,6 +483,30 @@ private:
     PrometheusManager& prometheusManager;
 #endif
 
+    /**
+     * Latest counters for each local endpoint
+     */
+    MetricsRegistry epCounterRegistry;
+
+    /**
+     * Lock for counter publishing state
+     */
+    std::mutex counter_mutex;
+    long counterPublishInterval;
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+        counterPublishTimes;
+
+    /**
+     * Check whether an endpoint's counters are due to be published
+     * to the MODB, and if so note that they are being published
+     */
+    bool shouldPublishCounters(const std::string& uuid);
+
+    /**
+     * Forget the counters for an endpoint that has been removed
+     */
+    void removeEndpointCounters(const std::string& uuid);
+
     class EndpointState {
     public:
         EndpointState();
@@ -444,12 +552,11 @@ private:
     boost::optional<opflex::modb::URI> resolveEpgMapping(EndpointState& es);
     typedef std::unordered_map<std::string, EndpointState> ep_map_t;
     typedef std::unordered_set<std::string> str_uset_t;
-    typedef std::unordered_map<opflex::modb::URI, str_uset_t> group_ep_map_t;
+    typedef EndpointIndex<opflex::modb::URI> group_ep_map_t;
     typedef std::unordered_map<std::string, opflex::modb::URI> ep_group_map_t;
     typedef std::unordered_map<opflex::modb::URI, std::string> ep_uuid_map_t;
-    typedef std::unordered_map<std::string, str_uset_t> string_ep_map_t;
-    typedef std::unordered_map<EndpointListener::uri_set_t,
-                               str_uset_t> secgrp_ep_map_t;
+    typedef EndpointIndex<std::string> string_ep_map_t;
+    typedef EndpointIndex<EndpointListener::uri_set_t> secgrp_ep_map_t;
     typedef std::unordered_map<std::string,
                             std::shared_ptr<const Endpoint>> ipmac_map_t;
     typedef std::unordered_map<opflex::modb::URI, ipmac_map_t> adj_ep_map_t;
@@ -462,6 +569,11 @@ private:
      */
     ep_map_t ep_map;
 
+    /**
+     * Handles for the endpoint UUIDs in the indexes below
+     */
+    EndpointHandleTable ep_handles;
+
     /**
      * Map endpoint group URI to a set of endpoint UUIDs
      */
@@ -0,0 +1,252 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Include file for HeavyHitterSketch
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_HEAVY_HITTER_SKETCH_H
+#define OPFLEXAGENT_HEAVY_HITTER_SKETCH_H
+
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace opflexagent {
+
+/**
+ * A fixed-size summary of the heaviest keys in a stream of weighted
+ * updates, using the Space-Saving algorithm.
+ *
+ * At most capacity keys are tracked, ranked by byte count.  When a
+ * key that is not tracked arrives and the sketch is full, it replaces
+ * the lightest tracked key and inherits its counts, which are
+ * recorded as the new key's error bound.  Counts are therefore never
+ * underestimated, and any key whose true byte count exceeds
+ * (total bytes / capacity) is guaranteed to be tracked.
+ *
+ * Each entry also counts the traffic added for its key since the key
+ * was last marked as exported.  Inherited counts are not included, so
+ * a key that is evicted and later tracked again does not count the
+ * traffic that was already exported a second time.
+ *
+ * Not thread safe.
+ *
+ * @param K the key type
+ * @param Hash hash function for the key type
+ */
+template <typename K, typename Hash = std::hash<K> >
+class HeavyHitterSketch : private boost::noncopyable {
+public:
+    /**
+     * A tracked key and its estimated counts
+     */
+    struct Entry {
+        /**
+         * The key
+         */
+        K key;
+        /**
+         * Estimated number of packets
+         */
+        uint64_t packets;
+        /**
+         * Estimated number of bytes
+         */
+        uint64_t bytes;
+        /**
+         * Maximum amount by which bytes may overestimate the true
+         * byte count
+         */
+        uint64_t error;
+        /**
+         * Packets added for the key since it was last exported
+         */
+        uint64_t newPackets;
+        /**
+         * Bytes added for the key since it was last exported
+         */
+        uint64_t newBytes;
+    };
+
+    /**
+     * Create a sketch
+     *
+     * @param capacity_ the maximum number of keys to track
+     */
+    explicit HeavyHitterSketch(size_t capacity_)
+        : capacity(std::max<size_t>(capacity_, 1)) {
+        heap.reserve(capacity);
+        index.reserve(capacity);
+    }
+
+    /**
+     * Add traffic for a key
+     *
+     * @param key the key
+     * @param packets the number of packets to add
+     * @param bytes the number of bytes to add
+     */
+    void add(const K& key, uint64_t packets, uint64_t bytes) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            Entry& e = heap[it->second];
+            e.packets += packets;
+            e.bytes += bytes;
+            e.newPackets += packets;
+            e.newBytes += bytes;
+            siftDown(it->second);
+        } else if (heap.size() < capacity) {
+            heap.push_back({key, packets, bytes, 0, packets, bytes});
+            index[key] = heap.size() - 1;
+            siftUp(heap.size() - 1);
+        } else {
+            // evict the lightest key and take over its counts
+            Entry& e = heap[0];
+            index.erase(e.key);
+            e.key = key;
+            e.error = e.bytes;
+            e.packets += packets;
+            e.bytes += bytes;
+            e.newPackets = packets;
+            e.newBytes = bytes;
+            index[key] = 0;
+            siftDown(0);
+        }
+    }
+
+    /**
+     * Stop tracking a key
+     *
+     * @param key the key to remove
+     * @return true if the key was tracked
+     */
+    bool remove(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end())
+            return false;
+        size_t i = it->second;
+        index.erase(it);
+        if (i != heap.size() - 1) {
+            heap[i] = std::move(heap.back());
+            index[heap[i].key] = i;
+            heap.pop_back();
+            siftUp(i);
+            siftDown(i);
+        } else {
+            heap.pop_back();
+        }
+        return true;
+    }
+
+    /**
+     * Mark the traffic counted for a key so far as exported, so that
+     * the key's new counts start again from zero
+     *
+     * @param key the key
+     */
+    void markExported(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end())
+            return;
+        Entry& e = heap[it->second];
+        e.newPackets = 0;
+        e.newBytes = 0;
+    }
+
+    /**
+     * Get the heaviest tracked keys, heaviest first
+     *
+     * @param k the maximum number of keys to return
+     * @param out receives the entries
+     */
+    void getTop(size_t k, std::vector<Entry>& out) const {
+        out.assign(heap.begin(), heap.end());
+        k = std::min(k, out.size());
+        auto heavier = [](const Entry& a, const Entry& b) {
+            return a.bytes > b.bytes;
+        };
+        std::partial_sort(out.begin(), out.begin() + k, out.end(), heavier);
+        out.resize(k);
+    }
+
+    /**
+     * Get the number of tracked keys
+     */
+    size_t size() const { return heap.size(); }
+
+    /**
+     * Get the maximum number of tracked keys
+     */
+    size_t getCapacity() const { return capacity; }
+
+    /**
+     * Get the approximate memory used by the sketch in bytes
+     */
+    size_t getMemoryUsage() const {
+        // each index node holds the key, the heap position and a
+        // next pointer, plus allocator overhead
+        return heap.capacity() * sizeof(Entry) +
+            index.bucket_count() * sizeof(void*) +
+            index.size() * (sizeof(K) + sizeof(size_t) + 2 * sizeof(void*));
+    }
+
+    /**
+     * Stop tracking all keys
+     */
+    void clear() {
+        heap.clear();
+        index.clear();
+    }
+
+private:
+    const size_t capacity;
+    // min-heap on bytes, so the eviction candidate is at the root
+    std::vector<Entry> heap;
+    std::unordered_map<K, size_t, Hash> index;
+
+    void swapEntries(size_t a, size_t b) {
+        std::swap(heap[a], heap[b]);
+        index[heap[a].key] = a;
+        index[heap[b].key] = b;
+    }
+
+    void siftUp(size_t i) {
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (heap[parent].bytes <= heap[i].bytes)
+                break;
+            swapEntries(i, parent);
+            i = parent;
+        }
+    }
+
+    void siftDown(size_t i) {
+        for (;;) {
+            size_t smallest = i;
+            size_t l = 2 * i + 1;
+            size_t r = l + 1;
+            if (l < heap.size() && heap[l].bytes < heap[smallest].bytes)
+                smallest = l;
+            if (r < heap.size() && heap[r].bytes < heap[smallest].bytes)
+                smallest = r;
+            if (smallest == i)
+                break;
+            swapEntries(i, smallest);
+            i = smallest;
+        }
+    }
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_HEAVY_HITTER_SKETCH_H */
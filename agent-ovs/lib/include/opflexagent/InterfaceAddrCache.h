@@ -0,0 +1,161 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Include file for interface address cache
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_INTERFACEADDRCACHE_H
+#define OPFLEXAGENT_INTERFACEADDRCACHE_H
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace opflexagent {
+
+/**
+ * A source of rtnetlink messages describing the links and addresses
+ * of the host.  Abstracted so that tests can supply the messages.
+ */
+class NetlinkSocket : private boost::noncopyable {
+public:
+    virtual ~NetlinkSocket() {}
+
+    /**
+     * Open the socket, subscribed to link and IPv4/IPv6 address
+     * change notifications
+     *
+     * @return a file descriptor from which to read the messages, or
+     * -1 on error.  The descriptor remains owned by the socket.
+     */
+    virtual int open() = 0;
+
+    /**
+     * Request a dump of all links or all addresses, which is ended
+     * by a NLMSG_DONE message
+     *
+     * @param type RTM_GETLINK or RTM_GETADDR
+     * @return true if the request was sent
+     */
+    virtual bool requestDump(uint16_t type) = 0;
+
+    /**
+     * Close the socket
+     */
+    virtual void close() = 0;
+};
+
+/**
+ * A NETLINK_ROUTE socket subscribed to the link, IPv4 address and
+ * IPv6 address multicast groups
+ */
+class RtnetlinkSocket : public NetlinkSocket {
+public:
+    RtnetlinkSocket();
+    virtual ~RtnetlinkSocket();
+
+    virtual int open();
+    virtual bool requestDump(uint16_t type);
+    virtual void close();
+
+private:
+    int fd;
+    uint32_t seq;
+};
+
+/**
+ * An in-memory copy of the links and addresses of the host, built
+ * from a dump of links and addresses and then kept up to date from
+ * rtnetlink change notifications, so that finding the uplink address
+ * does not need to enumerate every interface.
+ */
+class InterfaceAddrCache {
+public:
+    /**
+     * Flags returned by apply()
+     */
+    enum {
+        /** The links or addresses in the cache changed */
+        CHANGED = 1,
+        /** A dump was completed */
+        DUMP_DONE = 2,
+        /** The kernel reported an error */
+        FAILED = 4
+    };
+
+    /**
+     * A link and its addresses
+     */
+    struct Link {
+        /** the interface name */
+        std::string name;
+        /** the interface flags (IFF_*) */
+        unsigned flags = 0;
+        /** the hardware address, or empty if it has none */
+        std::string mac;
+        /** the addresses in the order they were added */
+        std::vector<boost::asio::ip::address> addresses;
+    };
+
+    /**
+     * The links of the host by interface index
+     */
+    typedef std::map<int, Link> link_map_t;
+
+    /**
+     * Apply a buffer of rtnetlink messages to the cache
+     *
+     * @param buf the messages
+     * @param len the length of the buffer
+     * @return a combination of CHANGED, DUMP_DONE and FAILED
+     */
+    int apply(const void* buf, size_t len);
+
+    /**
+     * Choose the uplink address in the same way as a scan of
+     * getifaddrs(): the first IPv4 address, or else the last IPv6
+     * address, of an up, non-loopback interface in interface index
+     * order
+     *
+     * @param uplinkIface only consider the interface with this name,
+     * or all interfaces if empty
+     * @param address set to the address, without a scope
+     * @param mac set to the hardware address of the interface
+     * @param iface set to the name of the interface
+     * @param isV4 set to true if the address is IPv4
+     * @return true if an address was found
+     */
+    bool getUplink(const std::string& uplinkIface,
+                   /* out */ std::string& address,
+                   /* out */ std::string& mac,
+                   /* out */ std::string& iface,
+                   /* out */ bool& isV4) const;
+
+    /**
+     * Get the links in the cache
+     */
+    const link_map_t& getLinks() const { return links; }
+
+    /**
+     * Remove all links and addresses
+     */
+    void clear() { links.clear(); }
+
+private:
+    link_map_t links;
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_INTERFACEADDRCACHE_H */
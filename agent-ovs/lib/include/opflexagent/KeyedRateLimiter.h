@@ -17,9 +17,11 @@
 
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
 #include <mutex>
 #include <vector>
 #include <chrono>
+#include <algorithm>
 
 namespace opflexagent {
 
@@ -112,6 +114,133 @@ private:
     }
 };
 
+/**
+ * A class that enforces a rate on events related to each key with a
+ * token bucket per key.  Unlike KeyedRateLimiter, which allows a
+ * single event per key in its window, this allows a sustained rate of
+ * events with bursts up to a configured size, which suits keys that
+ * legitimately produce several events in quick succession.
+ *
+ * @param K the key type; must be hashable
+ */
+template <typename K>
+class KeyedTokenBucket : private boost::noncopyable {
+public:
+    /**
+     * A point in time to apply the rate limiter at
+     */
+    typedef std::chrono::steady_clock::time_point time_point;
+
+    /**
+     * Instantiate a keyed token bucket
+     *
+     * @param rate_ the number of events per second allowed for each
+     * key, or zero for no limit
+     * @param burst_ the number of events allowed for a key in a
+     * burst; at least one
+     */
+    KeyedTokenBucket(double rate_ = 0, double burst_ = 1)
+        : rate(rate_), burst(burst_ < 1 ? 1 : burst_) { }
+
+    /**
+     * Change the rate and burst size.  Resets the state of all keys.
+     *
+     * @param rate_ the number of events per second allowed for each
+     * key, or zero for no limit
+     * @param burst_ the number of events allowed for a key in a
+     * burst; at least one
+     */
+    void setRate(double rate_, double burst_) {
+        std::lock_guard<std::mutex> guard(mtx);
+        rate = rate_;
+        burst = burst_ < 1 ? 1 : burst_;
+        buckets.clear();
+    }
+
+    /**
+     * Clear the rate limiter and reset its state to the initial state
+     */
+    void clear() {
+        std::lock_guard<std::mutex> guard(mtx);
+        buckets.clear();
+    }
+
+    /**
+     * Forget the state for a key, for example when the key will not
+     * be seen again
+     *
+     * @param key the key to forget
+     */
+    void erase(const K& key) {
+        std::lock_guard<std::mutex> guard(mtx);
+        buckets.erase(key);
+    }
+
+    /**
+     * Get the number of keys with state in the rate limiter
+     *
+     * @return the number of keys
+     */
+    size_t size() {
+        std::lock_guard<std::mutex> guard(mtx);
+        return buckets.size();
+    }
+
+    /**
+     * Apply the rate limiter to the given key.  Returns true if the
+     * key's bucket has a token left, and takes it.
+     *
+     * @param key the key to check
+     * @return true to indicate the event should be handled, otherwise
+     * false.
+     */
+    bool event(const K& key) {
+        return event(key, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * Apply the rate limiter to the given key at the given time
+     *
+     * @param key the key to check
+     * @param now the time of the event
+     * @return true to indicate the event should be handled, otherwise
+     * false.
+     */
+    bool event(const K& key, time_point now) {
+        std::lock_guard<std::mutex> guard(mtx);
+        if (rate <= 0)
+            return true;
+
+        auto it = buckets.find(key);
+        if (it == buckets.end()) {
+            buckets.emplace(key, bucket_t{burst - 1, now});
+            return true;
+        }
+
+        bucket_t& b = it->second;
+        if (now > b.last) {
+            std::chrono::duration<double> elapsed = now - b.last;
+            b.tokens = std::min(burst, b.tokens + elapsed.count() * rate);
+            b.last = now;
+        }
+        if (b.tokens < 1)
+            return false;
+        b.tokens -= 1;
+        return true;
+    }
+
+private:
+    struct bucket_t {
+        double tokens;
+        time_point last;
+    };
+
+    std::mutex mtx;
+    double rate;
+    double burst;
+    std::unordered_map<K, bucket_t> buckets;
+};
+
 } /* namespace opflexagent */
 
 #endif /* OPFLEXAGENT_KEYED_RATE_LIMITER */
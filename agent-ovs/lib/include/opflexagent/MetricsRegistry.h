@@ -0,0 +1,169 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Definition of MetricsRegistry class
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_METRICSREGISTRY_H
+#define OPFLEXAGENT_METRICSREGISTRY_H
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace opflexagent {
+
+/**
+ * An in-process store of counter values for a set of objects, such
+ * as endpoints, that stats collectors write to directly and that
+ * exporters read when they are scraped.
+ *
+ * Each object is registered under a string key and is given a
+ * compact ID that indexes a fixed-width row of counters.  Registering
+ * and removing objects takes a lock; reading and writing counters
+ * given an ID does not.  Rows are never moved or freed while the
+ * registry exists, so an ID stays safe to use after its object is
+ * removed, though its row may by then be reused for another object.
+ */
+class MetricsRegistry : private boost::noncopyable {
+public:
+    /**
+     * A compact identifier for a row of counters
+     */
+    typedef uint32_t id_t;
+
+    /**
+     * An ID that does not refer to any row
+     */
+    static const id_t INVALID_ID;
+
+    /**
+     * Create a registry
+     *
+     * @param width the number of counters in each row
+     */
+    explicit MetricsRegistry(size_t width);
+    ~MetricsRegistry();
+
+    /**
+     * Get the ID for a key, registering it with all counters zero if
+     * it is not already registered
+     *
+     * @param key the key for the object
+     * @return the ID of its counters, or INVALID_ID if the registry
+     * is full
+     */
+    id_t getId(const std::string& key);
+
+    /**
+     * Get the ID for a key without registering it
+     *
+     * @param key the key for the object
+     * @return the ID of its counters, or INVALID_ID if not registered
+     */
+    id_t findId(const std::string& key) const;
+
+    /**
+     * Unregister a key, making its row available for reuse
+     *
+     * @param key the key for the object
+     */
+    void remove(const std::string& key);
+
+    /**
+     * Set a counter
+     *
+     * @param id the ID of the row
+     * @param counter the index of the counter in the row
+     * @param value the new value
+     */
+    void set(id_t id, size_t counter, uint64_t value) {
+        if (id == INVALID_ID || counter >= width) return;
+        cell(id, counter).store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Add to a counter
+     *
+     * @param id the ID of the row
+     * @param counter the index of the counter in the row
+     * @param delta the amount to add
+     */
+    void add(id_t id, size_t counter, uint64_t delta) {
+        if (id == INVALID_ID || counter >= width) return;
+        cell(id, counter).fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the value of a counter
+     *
+     * @param id the ID of the row
+     * @param counter the index of the counter in the row
+     * @return the current value
+     */
+    uint64_t get(id_t id, size_t counter) const {
+        if (id == INVALID_ID || counter >= width) return 0;
+        return cell(id, counter).load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of registered keys
+     */
+    size_t size() const;
+
+    /**
+     * Get the number of counters in each row
+     */
+    size_t getWidth() const { return width; }
+
+    /**
+     * Visitor for registered rows
+     */
+    typedef std::function<void(const std::string&, id_t)> visitor_t;
+
+    /**
+     * Call a function for each registered key and its ID.  The
+     * registry is locked while this runs, so the visitor must not
+     * register or remove keys.
+     *
+     * @param visitor the function to call
+     */
+    void forEach(const visitor_t& visitor) const;
+
+private:
+    // rows per block; blocks are allocated as the registry grows
+    static const size_t BLOCK_ROWS = 1024;
+    static const size_t MAX_BLOCKS = 4096;
+
+    typedef std::atomic<uint64_t> cell_t;
+
+    std::atomic<uint64_t>& cell(id_t id, size_t counter) const {
+        cell_t* block = blocks[id / BLOCK_ROWS].load(std::memory_order_acquire);
+        return block[(id % BLOCK_ROWS) * width + counter];
+    }
+
+    const size_t width;
+    std::unique_ptr<std::atomic<cell_t*>[]> blocks;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, id_t> ids;
+    std::vector<id_t> freeIds;
+    id_t nextId;
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_METRICSREGISTRY_H */
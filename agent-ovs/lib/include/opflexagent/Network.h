@@ -19,6 +19,7 @@
 #include <boost/asio/ip/address.hpp>
 #include <opflex/modb/MAC.h>
 
+#include <array>
 #include <cstdint>
 #include <arpa/inet.h>
 #include <netinet/ip6.h>
@@ -201,7 +202,221 @@ bool prefix_match(const boost::asio::ip::address& addr,
                   uint32_t tgtPfxLen,
                   bool &is_exact_match);
 
+/**
+ * Compute a minimal CIDR cover for a set of subnets.  Subnets that
+ * are contained in another subnet of the set are dropped and sibling
+ * prefixes are merged into their parent prefix, so the result matches
+ * exactly the same addresses using as few prefixes as possible.
+ * Subnets that cannot be parsed, as well as the empty "match all"
+ * subnet, are passed through unchanged.
+ *
+ * @param subnets the subnets to compress
+ * @param result the set to which the compressed subnets are added
+ */
+void compress_subnets(const subnets_t& subnets,
+                      /* out */ subnets_t& result);
+
+/**
+ * A compact binary IPv4 or IPv6 address: 16 bytes in network byte
+ * order, with an IPv4 address in the first 4 bytes, and the address
+ * family.  Parse an address once where it enters the agent, then
+ * hash and compare it without formatting; format it only for output.
+ */
+class ip_addr {
+public:
+    /**
+     * The address family
+     */
+    enum family_t { UNSPEC = 0, V4 = 4, V6 = 6 };
+
+    /**
+     * The address bytes
+     */
+    typedef std::array<uint8_t, 16> bytes_type;
+
+    /**
+     * Create an unspecified address, with no family
+     */
+    ip_addr() : bytes_(), family_(UNSPEC) {}
+
+    /**
+     * Create an address from a boost address.  The scope of an IPv6
+     * address is not kept.
+     */
+    explicit ip_addr(const boost::asio::ip::address& addr);
+
+    /**
+     * Parse an IPv4 or IPv6 address
+     *
+     * @param str the address string.  The scope of an IPv6 address
+     * is not kept.
+     * @param addr set to the address if it was valid
+     * @return true if the string is a valid address
+     */
+    static bool from_string(const std::string& str,
+                            /* out */ ip_addr& addr);
+
+    /** Get the address family */
+    family_t family() const { return (family_t)family_; }
+    /** Check whether this is an IPv4 address */
+    bool is_v4() const { return family_ == V4; }
+    /** Check whether this is an IPv6 address */
+    bool is_v6() const { return family_ == V6; }
+    /** Check whether this address has no family */
+    bool empty() const { return family_ == UNSPEC; }
+    /** Get the address bytes */
+    const bytes_type& bytes() const { return bytes_; }
+    /** Get the number of bits in an address of this family */
+    uint8_t max_prefix_len() const { return is_v4() ? 32 : 128; }
+
+    /**
+     * Get the address with all but the first prefixLen bits cleared
+     */
+    ip_addr mask(uint8_t prefixLen) const;
+
+    /** Convert to a boost address */
+    boost::asio::ip::address to_address() const;
+    /** Format the address */
+    std::string to_string() const;
+
+    /** Hash the address */
+    std::size_t hash() const;
+
+    /** Compare addresses */
+    bool operator==(const ip_addr& o) const {
+        return family_ == o.family_ && bytes_ == o.bytes_;
+    }
+    /** Compare addresses */
+    bool operator!=(const ip_addr& o) const { return !(*this == o); }
+    /** Order addresses by family, then by address */
+    bool operator<(const ip_addr& o) const {
+        return family_ != o.family_ ? family_ < o.family_ : bytes_ < o.bytes_;
+    }
+
+private:
+    bytes_type bytes_;
+    uint8_t family_;
+};
+
+/**
+ * ip_addr stream insertion
+ */
+std::ostream& operator<<(std::ostream &os, const ip_addr& addr);
+
+/**
+ * A binary address prefix: an ip_addr and a prefix length
+ */
+class ip_prefix {
+public:
+    /**
+     * Create an empty prefix
+     */
+    ip_prefix() : len_(0) {}
+
+    /**
+     * Create a prefix
+     *
+     * @param addr the address
+     * @param len the prefix length, which must not exceed the length
+     * of the address
+     */
+    ip_prefix(const ip_addr& addr, uint8_t len) : addr_(addr), len_(len) {}
+
+    /**
+     * Parse a prefix in the same way as cidr_from_string: an address
+     * without a prefix length is a host prefix
+     *
+     * @param cidrStr the prefix string
+     * @param prefix set to the prefix if it was valid
+     * @param do_mask_addr mask the address to the prefix length if
+     * true
+     * @return true if the string is a valid prefix
+     */
+    static bool from_string(const std::string& cidrStr,
+                            /* out */ ip_prefix& prefix,
+                            bool do_mask_addr = true);
+
+    /** Get the address */
+    const ip_addr& address() const { return addr_; }
+    /** Get the prefix length */
+    uint8_t length() const { return len_; }
+
+    /**
+     * Check whether the prefix contains an address
+     */
+    bool contains(const ip_addr& addr) const {
+        return addr.family() == addr_.family() &&
+            addr.mask(len_) == addr_.mask(len_);
+    }
+
+    /**
+     * Check whether the prefix contains another prefix, which is at
+     * least as long
+     */
+    bool contains(const ip_prefix& prefix) const {
+        return len_ <= prefix.len_ && contains(prefix.addr_);
+    }
+
+    /** Convert to a cidr_t */
+    cidr_t to_cidr() const { return cidr_t(addr_.to_address(), len_); }
+    /** Format the prefix as address/length */
+    std::string to_string() const;
+
+    /** Hash the prefix */
+    std::size_t hash() const { return addr_.hash() * 31 + len_; }
+
+    /** Compare prefixes */
+    bool operator==(const ip_prefix& o) const {
+        return len_ == o.len_ && addr_ == o.addr_;
+    }
+    /** Compare prefixes */
+    bool operator!=(const ip_prefix& o) const { return !(*this == o); }
+    /** Order prefixes by address, then by length */
+    bool operator<(const ip_prefix& o) const {
+        return addr_ != o.addr_ ? addr_ < o.addr_ : len_ < o.len_;
+    }
+
+private:
+    ip_addr addr_;
+    uint8_t len_;
+};
+
+/**
+ * ip_prefix stream insertion
+ */
+std::ostream& operator<<(std::ostream &os, const ip_prefix& prefix);
+
 } /* namespace packets */
 } /* namespace opflexagent */
 
+namespace std {
+
+/**
+ * Template specialization for std::hash<ip_addr>, making it suitable
+ * as a key in a std::unordered_map
+ */
+template<> struct hash<opflexagent::network::ip_addr> {
+    /**
+     * Hash the ip_addr
+     */
+    std::size_t operator()(const opflexagent::network::ip_addr& a) const {
+        return a.hash();
+    }
+};
+
+/**
+ * Template specialization for std::hash<ip_prefix>, making it
+ * suitable as a key in a std::unordered_map
+ */
+template<> struct hash<opflexagent::network::ip_prefix> {
+    /**
+     * Hash the ip_prefix
+     */
+    std::size_t operator()(const opflexagent::network::ip_prefix& p) const {
+        return p.hash();
+    }
+};
+
+} /* namespace std */
+
 #endif /* OPFLEXAGENT_NETWORK_H */
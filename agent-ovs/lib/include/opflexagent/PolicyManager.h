@@ -761,14 +761,161 @@ public:
      * Handle Subnets deletion
      */
     void deleteSubnets(const opflex::modb::URI& subnets);
+
+    /**
+     * An immutable view of the state derived from the policy for
+     * endpoint groups, contracts, security groups and routes.  A new
+     * snapshot is published after each policy update and before the
+     * listeners are notified, so a snapshot taken from a listener
+     * reflects at least the update being notified.  Readers that make
+     * many queries in one task should hold a snapshot for the
+     * duration of the task rather than call the locked getters.
+     */
+    class Snapshot {
+    public:
+        /**
+         * State derived for an endpoint group
+         */
+        struct GroupInfo {
+            /** The VNID of the group */
+            boost::optional<uint32_t> vnid;
+            /** The sclass of the group */
+            boost::optional<uint32_t> sclass;
+            /** The multicast IP of the group */
+            boost::optional<std::string> multicastIP;
+            /** The routing domain of the group */
+            boost::optional<std::shared_ptr<modelgbp::gbp::RoutingDomain> >
+                routingDomain;
+            /** The bridge domain of the group */
+            boost::optional<std::shared_ptr<modelgbp::gbp::BridgeDomain> >
+                bridgeDomain;
+            /** The flood domain of the group */
+            boost::optional<std::shared_ptr<modelgbp::gbp::FloodDomain> >
+                floodDomain;
+            /** The flood context of the group */
+            boost::optional<std::shared_ptr<modelgbp::gbpe::FloodContext> >
+                floodContext;
+            /** The subnets of the group */
+            subnet_vector_t subnets;
+        };
+
+        /**
+         * State derived for a contract
+         */
+        struct ContractInfo {
+            /** The groups that provide the contract */
+            uri_set_t providerGroups;
+            /** The groups that consume the contract */
+            uri_set_t consumerGroups;
+            /** The groups with the contract as intra-group policy */
+            uri_set_t intraGroups;
+            /** The rules of the contract, in priority order */
+            rule_list_t rules;
+        };
+
+        /**
+         * Create an empty snapshot
+         */
+        Snapshot();
+
+        /**
+         * Get the version of this snapshot, which increases with each
+         * snapshot published
+         *
+         * @return the version
+         */
+        uint64_t getVersion() const { return version; }
+
+        /**
+         * Get the state for an endpoint group
+         *
+         * @param eg the URI of the endpoint group
+         * @return the state or an empty pointer if the group does not
+         * exist
+         */
+        std::shared_ptr<const GroupInfo>
+        getGroup(const opflex::modb::URI& eg) const;
+
+        /**
+         * Get the state for a contract
+         *
+         * @param contract the URI of the contract
+         * @return the state or an empty pointer if the contract does
+         * not exist
+         */
+        std::shared_ptr<const ContractInfo>
+        getContract(const opflex::modb::URI& contract) const;
+
+        /**
+         * Get the rules of a security group
+         *
+         * @param secGroup the URI of the security group
+         * @return the rules or an empty pointer if the security group
+         * does not exist
+         */
+        std::shared_ptr<const rule_list_t>
+        getSecGroupRules(const opflex::modb::URI& secGroup) const;
+
+        /**
+         * Get a static or remote route.  Local routes are resolved
+         * from the MODB and can only be queried with
+         * PolicyManager::getRoute.
+         *
+         * @param route_type StaticRoute::CLASS_ID or
+         * RemoteRoute::CLASS_ID
+         * @param rtURI URI for the route
+         * @return the route or an empty pointer if it is not found
+         */
+        std::shared_ptr<const PolicyRoute>
+        getRoute(opflex::modb::class_id_t route_type,
+                 const opflex::modb::URI& rtURI) const;
+
+    private:
+        friend class PolicyManager;
+
+        template <typename T>
+        using entry_map_t =
+            std::unordered_map<opflex::modb::URI, std::shared_ptr<const T> >;
+
+        uint64_t version;
+
+        // each map is shared between snapshots until one of its
+        // entries changes
+        std::shared_ptr<const entry_map_t<GroupInfo> > groups;
+        std::shared_ptr<const entry_map_t<ContractInfo> > contracts;
+        std::shared_ptr<const entry_map_t<rule_list_t> > secGroups;
+        std::shared_ptr<const entry_map_t<PolicyRoute> > staticRoutes;
+        std::shared_ptr<const entry_map_t<PolicyRoute> > remoteRoutes;
+    };
+
+    /**
+     * A pointer to a policy snapshot
+     */
+    typedef std::shared_ptr<const Snapshot> snapshot_ptr;
+
+    /**
+     * Get the current policy snapshot.  This does not take the state
+     * lock.
+     *
+     * @return the snapshot
+     */
+    snapshot_ptr getSnapshot() const;
+
 private:
     opflex::ofcore::OFFramework& framework;
     std::string opflexDomain;
     TaskQueue taskQueue;
     typedef std::unordered_map<opflex::modb::URI,
                 std::shared_ptr<modelgbp::gbp::Subnet> > subnet_map_t;
-    typedef std::unordered_map<opflex::modb::URI,
-                std::shared_ptr<modelgbp::gbp::ExternalSubnet> >
+    /**
+     * An external subnet with its prefix parsed once when it is
+     * added, so that prefix lookups do not parse every subnet
+     */
+    struct ExtSubnetState {
+        std::shared_ptr<modelgbp::gbp::ExternalSubnet> extsub;
+        network::ip_prefix prefix;
+    };
+    typedef std::unordered_map<opflex::modb::URI, ExtSubnetState>
                     ext_subnet_map_t;
     /**
      * State and indices related to a given group
@@ -873,6 +1020,52 @@ private:
     std::mutex state_mutex;
     std::mutex subnets_rd_mutex;
 
+    /**
+     * The current snapshot.  Replaced with std::atomic_store while
+     * holding state_mutex, and read with std::atomic_load.
+     */
+    snapshot_ptr snapshot;
+
+    /**
+     * Publish a snapshot with the state for the given endpoint
+     * groups rebuilt from group_map.  Caller must hold state_mutex.
+     *
+     * @param groups the groups that were updated or removed
+     */
+    void publishGroups(const uri_set_t& groups);
+
+    /**
+     * Publish a snapshot with the state for the given contracts
+     * rebuilt from contractMap.  Caller must hold state_mutex.
+     *
+     * @param contracts the contracts that were updated or removed
+     */
+    void publishContracts(const uri_set_t& contracts);
+
+    /**
+     * Publish a snapshot with the rules for the given security groups
+     * rebuilt from secGrpMap.  Caller must hold state_mutex.
+     *
+     * @param secGroups the security groups that were updated or
+     * removed
+     */
+    void publishSecGroups(const uri_set_t& secGroups);
+
+    /**
+     * Publish a snapshot with the given routes rebuilt from the route
+     * maps.  Caller must hold state_mutex.
+     *
+     * @param static_source true for static routes, false for remote
+     * routes
+     * @param routes the routes that were updated or removed
+     */
+    void publishRoutes(bool static_source, const uri_set_t& routes);
+
+    /**
+     * Publish a new snapshot.  Caller must hold state_mutex.
+     */
+    void publish(const std::shared_ptr<Snapshot>& next);
+
     // Listen to changes related to forwarding domains
     class DomainListener : public opflex::modb::ObjectListener {
     public:
@@ -14,6 +14,7 @@
 #define __OPFLEXAGENT_PROMETHEUS_MANAGER_H__
 
 #include <opflex/ofcore/OFFramework.h>
+#include <opflexagent/MetricsRegistry.h>
 #include <unordered_map>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 #include <prometheus/counter.h>
 #include <prometheus/exposer.h>
 #include <prometheus/registry.h>
+#include <prometheus/collectable.h>
 
 namespace opflexagent {
 
@@ -89,18 +91,22 @@ public:
             const unordered_map<string, string>&    attr_map,
             const unordered_set<string>&        allowed_set);
     /**
-     * Create EpCounter metric family if its not present.
-     * Update EpCounter metric family if its already present
+     * Create EpCounter metrics if they are not present, or update
+     * their labels if the ep attributes changed.  The counter values
+     * are read from the endpoint manager's counter registry whenever
+     * prometheus scrapes the agent.
      *
      * @param uuid        uuid of ep
      * @param ep_name     the name of the ep
      * @param attr_hash   hash of prometheus compatible ep attr
      * @param attr_map    map of all ep attributes
+     * @param counter_id  the ep's ID in the endpoint counter registry
      */
     void addNUpdateEpCounter(const string& uuid,
                              const string& ep_name,
                              const size_t& attr_hash,
-        const unordered_map<string, string>&    attr_map);
+        const unordered_map<string, string>&    attr_map,
+                             MetricsRegistry::id_t counter_id);
     /**
      * Remove EpCounter metric given the ep name
      */
@@ -279,6 +285,35 @@ public:
                               const uint64_t &bytes,
                               const uint64_t &packets);
 
+    /**
+     * Create or update the SendQueue metrics of the outbound message
+     * queue of the connection to a bridge
+     *
+     * @param bridge_name     Name of the bridge
+     * @param depth           messages waiting to be written
+     * @param max_depth       highest number of messages waiting at once
+     * @param sent            messages written to the switch
+     * @param dropped         messages dropped on error or disconnect
+     * @param blocked         senders that had to wait for queue space
+     * @param avg_latency_us  average time a message spent queued
+     * @param max_latency_us  longest time a message spent queued
+     */
+    void addNUpdateSendQueueGauge(const string& bridge_name,
+                                  uint64_t depth,
+                                  uint64_t max_depth,
+                                  uint64_t sent,
+                                  uint64_t dropped,
+                                  uint64_t blocked,
+                                  uint64_t avg_latency_us,
+                                  uint64_t max_latency_us);
+
+    /**
+     * Remove the SendQueue metrics of the connection to a bridge
+     *
+     * @param bridge_name     Name of the bridge
+     */
+    void removeSendQueueGauge(const string& bridge_name);
+
     /* SecGrpClassifierCounter related APIs */
     /**
      * Create SGClassifierCounter metric family if its not present.
@@ -427,8 +462,6 @@ private:
     };
 
     // Static Metric families and metrics
-    // metric families to track all EpCounter metrics
-    Family<Gauge>      *gauge_ep_family_ptr[EP_METRICS_MAX];
     // Counter family to track all EpCounter creates
     Family<Counter>    *counter_ep_create_family_ptr;
     // Counter family to track all EpCounter removes
@@ -466,29 +499,56 @@ private:
     // remove any ep counter metric during stop
     void removeStaticCountersEp(void);
 
-    // Dynamic Metric families and metrics
-    // CRUD for every EP Counter metric
-    // func to create gauge for EpCounter given metric type, uuid & attr map
-    bool createDynamicGaugeEp(EP_METRICS metric,
-                              const string& uuid,
-                              const string& ep_name,
-                              const size_t& attr_hash,
-        const unordered_map<string, string>&    attr_map);
-    // func to get gauge for EpCounter given metric type, uuid
-    hgauge_pair_t getDynamicGaugeEp(EP_METRICS metric, const string& uuid);
-    // func to remove gauge for EpCounter given metric type, uuid
-    bool removeDynamicGaugeEp(EP_METRICS metric, const string& uuid);
-    // func to remove all gauge of every EpCounter for a metric type
-    void removeDynamicGaugeEp(EP_METRICS metric);
-    // func to remove all gauges of every EpCounter
-    void removeDynamicGaugeEp(void);
+    /**
+     * The labels of an ep's counter metrics and where to find their
+     * values.  The per-ep metrics are not kept in the prometheus
+     * registry; they are generated from these and the endpoint
+     * counter registry on every scrape.
+     */
+    struct EpCounterLabels {
+        // hash of the ep attributes the labels were created from
+        size_t attr_hash;
+        // hash of the labels themselves
+        size_t label_hash;
+        // the labels, ready to copy into each metric
+        std::vector<ClientMetric::Label> labels;
+        // the ep's row in the endpoint counter registry
+        MetricsRegistry::id_t counter_id;
+    };
 
     /**
-     * cache the pair of (label map hash, gauge ptr) for every ep uuid
-     * The hash is created utilizing prometheus lib, which is basically
-     * a rolling hash  of all the key,value pairs of the ep attributes.
+     * Collectable registered with the exposer that reads the ep
+     * counters when prometheus scrapes the agent
      */
-    unordered_map<string, hgauge_pair_t> ep_gauge_map[EP_METRICS_MAX];
+    class EpCounterCollector : public Collectable {
+    public:
+        // Construct a collector for the given manager
+        EpCounterCollector(PrometheusManager& manager_) : manager(manager_) {}
+        // see Collectable
+        std::vector<MetricFamily> Collect() const override;
+    private:
+        PrometheusManager& manager;
+    };
+    shared_ptr<EpCounterCollector> ep_collector_ptr;
+
+    // CRUD for every EP's labels
+    // func to create or relabel an ep; returns true if it was created
+    bool createEpCounterLabels(const string& uuid,
+                               const string& ep_name,
+                               const size_t& attr_hash,
+        const unordered_map<string, string>&    attr_map,
+                               MetricsRegistry::id_t counter_id);
+    // func to remove an ep's labels; returns false if not present
+    bool removeEpCounterLabels(const string& uuid);
+    // func to remove the labels of every ep
+    void removeEpCounterLabels(void);
+    // func to build the ep metric families at scrape time
+    std::vector<MetricFamily> collectEpCounters(void);
+
+    // labels of every ep that has counters, keyed by ep uuid
+    unordered_map<string, EpCounterLabels> ep_label_map;
+    // label hashes in use, to detect eps with identical labels
+    unordered_map<size_t, string> ep_label_hashes;
 
     //Utility apis
     // Create a label map that can be used for annotation, given the ep attr map
@@ -893,6 +953,39 @@ private:
             const string& table_name);
     /* End of TableDropCounter related apis and state */
 
+    /* Start of SendQueue related apis and state */
+    // Lock to safe guard SendQueue related state
+    mutex send_queue_mutex;
+
+    enum SEND_QUEUE_METRICS {
+        SEND_QUEUE_METRICS_MIN,
+        SEND_QUEUE_DEPTH = SEND_QUEUE_METRICS_MIN,
+        SEND_QUEUE_MAX_DEPTH,
+        SEND_QUEUE_SENT,
+        SEND_QUEUE_DROPPED,
+        SEND_QUEUE_BLOCKED,
+        SEND_QUEUE_AVG_LATENCY,
+        SEND_QUEUE_MAX_LATENCY,
+        SEND_QUEUE_METRICS_MAX = SEND_QUEUE_MAX_LATENCY
+    };
+
+    // Static Metric families and metrics
+    // metric families to track all SendQueue metrics
+    Family<Gauge>      *gauge_send_queue_family_ptr[SEND_QUEUE_METRICS_MAX+1];
+
+    // create send queue gauge metric families during start
+    void createStaticGaugeFamiliesSendQueue(void);
+
+    // remove the send queue gauges of every bridge
+    void removeStaticGaugesSendQueue(void);
+
+    void removeStaticGaugeFamiliesSendQueue(void);
+    /**
+     * cache Gauge ptr for every bridge
+     */
+    unordered_map<string, Gauge*> send_queue_gauge_map[SEND_QUEUE_METRICS_MAX+1];
+    /* End of SendQueue related apis and state */
+
     /* Start of SGClassifierCounter related apis and state */
     // Lock to safe guard SGClassifierCounter related state
     mutex sgclassifier_stats_mutex;
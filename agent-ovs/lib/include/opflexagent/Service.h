@@ -14,6 +14,8 @@
 #include <unordered_set>
 #include <set>
 
+#include <opflexagent/Network.h>
+
 #include <boost/optional.hpp>
 #include <opflex/modb/URI.h>
 #include <opflex/modb/MAC.h>
@@ -305,6 +307,8 @@ public:
          */
         void setServiceIP(const std::string& serviceIp) {
             this->serviceIp = serviceIp;
+            serviceAddr = network::ip_addr();
+            network::ip_addr::from_string(serviceIp, serviceAddr);
         }
 
         /**
@@ -312,6 +316,17 @@ public:
          */
         void unsetServiceIP() {
             serviceIp = boost::none;
+            serviceAddr = network::ip_addr();
+        }
+
+        /**
+         * Get the parsed service IP address for this service mapping
+         *
+         * @return the IP address, which is empty if the service IP is
+         * unset or invalid
+         */
+        const network::ip_addr& getServiceAddr() const {
+            return serviceAddr;
         }
 
         /**
@@ -412,6 +427,9 @@ public:
          */
         void setNextHopIPs(const std::set<std::string>& nextHopIps) {
             this->nextHopIps = nextHopIps;
+            nextHopAddrs.clear();
+            for (const std::string& ip : nextHopIps)
+                addNextHopAddr(ip);
         }
 
         /**
@@ -420,7 +438,18 @@ public:
          * @param nextHopIp the IP address
          */
         void addNextHopIP(const std::string& nextHopIp) {
-            this->nextHopIps.insert(nextHopIp);
+            if (this->nextHopIps.insert(nextHopIp).second)
+                addNextHopAddr(nextHopIp);
+        }
+
+        /**
+         * Get the parsed next hop IP addresses for this service
+         * mapping.  Invalid addresses are omitted.
+         *
+         * @return the set of IP addresses
+         */
+        const std::set<network::ip_addr>& getNextHopAddrs() const {
+            return nextHopAddrs;
         }
 
         /**
@@ -495,14 +524,27 @@ public:
         }
 
     private:
+        // The address strings are kept as the source gave them: they
+        // are what operator== compares to detect a changed mapping
+        // and are written back out in the service's string form.
+        // The parsed addresses are derived from them once by the
+        // setters for the flow programming paths.
         boost::optional<std::string> serviceIp;
+        network::ip_addr serviceAddr;
         boost::optional<std::string> serviceProto;
         boost::optional<uint16_t> servicePort;
         boost::optional<std::string> gatewayIp;
         std::set<std::string> nextHopIps;
+        std::set<network::ip_addr> nextHopAddrs;
         boost::optional<uint16_t> nextHopPort;
         boost::optional<uint16_t> nodePort;
         bool ctMode;
+
+        void addNextHopAddr(const std::string& ip) {
+            network::ip_addr addr;
+            if (network::ip_addr::from_string(ip, addr))
+                nextHopAddrs.insert(addr);
+        }
     };
 
     /**
@@ -10,13 +10,16 @@
  */
 
 #include <opflexagent/EndpointListener.h>
+#include <opflexagent/InterfaceAddrCache.h>
 
 #include <opflex/ofcore/OFFramework.h>
 
 #include <boost/noncopyable.hpp>
 #include <boost/asio.hpp>
 
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #pragma once
 #ifndef OPFLEXAGENT_TUNNELEPMANAGER_H
@@ -83,6 +86,18 @@ public:
         this->uplinkVlan = uplinkVlan;
     }
 
+    /**
+     * Set the source of link and address notifications used to
+     * discover the uplink address as it changes.  Must be called
+     * before start().  If null, or if the socket cannot be opened,
+     * the interfaces are polled every timer interval instead.
+     *
+     * @param socket the netlink socket
+     */
+    void setNetlinkSocket(std::unique_ptr<NetlinkSocket> socket) {
+        netlinkSocket = std::move(socket);
+    }
+
     /**
      * Set the renderer being used with opflexagent currently
      *
@@ -146,9 +161,37 @@ private:
     std::unique_ptr<boost::asio::deadline_timer> timer;
 
     void on_timer(const boost::system::error_code& ec);
+    void startPolling();
 
     std::atomic<bool> stopping;
 
+    /**
+     * Source of link and address notifications, if not polling
+     */
+    std::unique_ptr<NetlinkSocket> netlinkSocket;
+    std::unique_ptr<boost::asio::posix::stream_descriptor> netlinkDesc;
+    std::vector<char> netlinkBuf;
+
+    /**
+     * The links and addresses of the host, as last notified
+     */
+    InterfaceAddrCache addrCache;
+
+    /**
+     * The type of the dump in progress, or 0 once the cache is synced
+     */
+    uint16_t netlinkDump;
+
+    bool startNetlink();
+    void stopNetlink();
+    bool requestNetlinkDump(uint16_t type);
+    void readNetlink();
+    void on_netlink(const boost::system::error_code& ec, std::size_t len);
+
+    void updateTerminationEp(const std::string& bestAddress,
+                             const std::string& bestMac,
+                             const std::string& bestIface);
+
     /**
      * the uplink interface to search
      */
@@ -16,6 +16,8 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <ctime>
+#include <cstdint>
 #include <boost/assert.hpp>
 
 namespace opflexagent {
@@ -45,6 +47,31 @@ public:
     virtual
     void write(LogLevel level, const char *filename, int lineno,
                const char *functionName, const std::string& message) = 0;
+
+    /**
+     * Write a log message that was logged earlier by another thread.
+     * Messages written this way need not reach the destination until
+     * flush() is called.  The default implementation calls write().
+     *
+     * @param timestamp The wall clock time the message was logged
+     * @param level The log level of the message
+     * @param filename Name of source file that generated the message
+     * @param lineno Line number in source file that generated the message
+     * @param functionName Name of function that generated the message
+     * @param message The log message to write
+     */
+    virtual
+    void writeDeferred(const struct timespec& timestamp,
+                       LogLevel level, const char *filename, int lineno,
+                       const char *functionName, const std::string& message) {
+        write(level, filename, lineno, functionName, message);
+    }
+
+    /**
+     * Make sure any messages written with writeDeferred() have
+     * reached the log destination
+     */
+    virtual void flush() {}
 };
 
 /**
@@ -60,6 +87,30 @@ void initLogging(const std::string& level, bool toSyslog,
                  const std::string& log_file,
                  const std::string& syslog_name = "opflex-agent");
 
+/**
+ * Hand log messages off to a background thread that writes them to
+ * the log destination in batches, so that logging threads never wait
+ * on the destination.  Each thread can queue up to bufferSize
+ * messages; beyond that its messages are dropped and counted.
+ *
+ * @param bufferSize the number of messages each thread can queue.
+ * The size given to the first call is kept when async logging is
+ * started again after stopAsyncLogging().
+ */
+void startAsyncLogging(size_t bufferSize = 8192);
+
+/**
+ * Write out any queued log messages and go back to writing log
+ * messages from the thread that logs them
+ */
+void stopAsyncLogging();
+
+/**
+ * Get the number of log messages dropped because a thread's queue
+ * was full while logging asynchronously
+ */
+uint64_t getDroppedLogMessages();
+
 /**
  * Change the logging level of the agent.
  *
@@ -17,15 +17,18 @@
 #include <opflexagent/AgentLogHandler.h>
 
 #include <opflex/logging/OFLogHandler.h>
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include <opflex/logging/AsyncLogHandler.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <mutex>
 
 #include <syslog.h>
 
 using opflex::logging::OFLogHandler;
+using opflex::logging::AsyncLogHandler;
 
 namespace opflexagent {
 
@@ -43,10 +46,8 @@ public:
      * Constructor that accepts the output stream to write logs to.
      * @param outStream The stream to send messages to.
      */
-    OStreamLogSink(std::ostream& outStream) : out(&outStream) {
-        static const boost::posix_time::time_facet facet;
-        out->imbue(std::locale(out->getloc(), &facet));
-    }
+    OStreamLogSink(std::ostream& outStream)
+        : out(&outStream), cachedSecond(-1) {}
 
     /**
      * Constructor that accepts the name of a file where log messages will be
@@ -54,7 +55,8 @@ public:
      * @param fileName The filename to send log messages to.
      */
     OStreamLogSink(const std::string& fileName) :
-        fileStream(fileName.c_str(), std::ios_base::out | std::ios_base::app) {
+        fileStream(fileName.c_str(), std::ios_base::out | std::ios_base::app),
+        cachedSecond(-1) {
         if (!fileStream.good()) {
             out = &std::cout;
             std::cerr << "Unable to open log file: " << fileName << std::endl;
@@ -66,6 +68,30 @@ public:
     virtual
     void write(LogLevel level, const char *filename, int lineno,
                const char *functionName, const std::string& message) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        std::lock_guard<std::mutex> lock(logMtx);
+        format(now, level, filename, lineno, functionName, message);
+        out->flush();
+    }
+
+    virtual
+    void writeDeferred(const struct timespec& timestamp,
+                       LogLevel level, const char *filename, int lineno,
+                       const char *functionName, const std::string& message) {
+        std::lock_guard<std::mutex> lock(logMtx);
+        format(timestamp, level, filename, lineno, functionName, message);
+    }
+
+    virtual void flush() {
+        std::lock_guard<std::mutex> lock(logMtx);
+        out->flush();
+    }
+
+private:
+    void format(const struct timespec& timestamp,
+                LogLevel level, const char *filename, int lineno,
+                const char *functionName, const std::string& message) {
         const char *levelStr = LEVEL_STR_DEBUG;
         switch (level) {
         case TRACE:   levelStr = LEVEL_STR_TRACE; break;
@@ -75,16 +101,27 @@ public:
         case ERROR:   levelStr = LEVEL_STR_ERROR; break;
         case FATAL:   levelStr = LEVEL_STR_FATAL; break;
         }
-        std::lock_guard<std::mutex> lock(logMtx);
-        (*out) << "[" << boost::posix_time::microsec_clock::local_time()
+        // Converting to local time is the expensive part, so only do
+        // it when the second changes.  The format matches the boost
+        // ptime output used previously, e.g. 2020-Jan-31 13:45:10.123456
+        if (timestamp.tv_sec != cachedSecond) {
+            struct tm tm;
+            localtime_r(&timestamp.tv_sec, &tm);
+            strftime(cachedTime, sizeof(cachedTime), "%Y-%b-%d %H:%M:%S", &tm);
+            cachedSecond = timestamp.tv_sec;
+        }
+        char usec[8];
+        snprintf(usec, sizeof(usec), ".%06ld", timestamp.tv_nsec / 1000);
+        (*out) << "[" << cachedTime << usec
             << "] [" << levelStr << "] [" << filename << ":" << lineno << ":"
-            << functionName << "] " << message << std::endl;
+            << functionName << "] " << message << '\n';
     }
 
-private:
     std::fstream fileStream;
     std::ostream *out;
     std::mutex logMtx;
+    time_t cachedSecond;
+    char cachedTime[32];
     static const char * LEVEL_STR_TRACE;
     static const char * LEVEL_STR_DEBUG;
     static const char * LEVEL_STR_INFO;
@@ -136,8 +173,102 @@ private:
 static OStreamLogSink consoleLogSink(std::cout);
 static LogSink * currentLogSink = &consoleLogSink;
 
+static OFLogHandler::Level toOFLevel(LogLevel level) {
+    switch (level) {
+    case TRACE:   return OFLogHandler::TRACE;
+    case DEBUG:   return OFLogHandler::DEBUG0;
+    case INFO:    return OFLogHandler::INFO;
+    case WARNING: return OFLogHandler::WARNING;
+    case ERROR:   return OFLogHandler::ERROR;
+    default:
+    case FATAL:   return OFLogHandler::FATAL;
+    }
+}
+
+/**
+ * Log handler used by the asynchronous log writer thread to write
+ * queued messages to the current log sink
+ */
+class SinkLogHandler : public OFLogHandler {
+public:
+    SinkLogHandler() : OFLogHandler(TRACE) {}
+
+    virtual void handleMessage(const std::string& file,
+                               const int line,
+                               const std::string& function,
+                               const Level level,
+                               const std::string& message) {
+        currentLogSink->write(AgentLogHandler::toAgentLevel(level),
+                              file.c_str(), line, function.c_str(), message);
+    }
+
+    virtual void handleDeferredMessage(const struct timespec& timestamp,
+                                       const std::string& file,
+                                       const int line,
+                                       const std::string& function,
+                                       const Level level,
+                                       const std::string& message) {
+        currentLogSink->writeDeferred(timestamp,
+                                      AgentLogHandler::toAgentLevel(level),
+                                      file.c_str(), line, function.c_str(),
+                                      message);
+    }
+
+    virtual void flush() {
+        currentLogSink->flush();
+    }
+};
+
+static SinkLogHandler sinkLogHandler;
+
+/**
+ * Log sink that queues messages for the asynchronous log writer
+ * thread
+ */
+class AsyncLogSink : public LogSink {
+public:
+    AsyncLogSink(size_t bufferSize) : handler(sinkLogHandler, bufferSize) {}
+
+    void write(LogLevel level, const char *filename, int lineno,
+               const char *functionName, const std::string& message) {
+        handler.handleMessage(filename, lineno, functionName,
+                              toOFLevel(level), message);
+    }
+
+    AsyncLogHandler handler;
+};
+
+static std::mutex asyncMtx;
+// Created by the first start and reused by later ones: other threads
+// may still hold it after a stop, so it is never freed
+static AsyncLogSink* asyncLogSinkStore = NULL;
+static std::atomic<AsyncLogSink*> asyncLogSink(NULL);
+
 LogSink * getLogSink() {
-    return currentLogSink;
+    LogSink* sink = asyncLogSink.load(std::memory_order_acquire);
+    return sink ? sink : currentLogSink;
+}
+
+void startAsyncLogging(size_t bufferSize) {
+    std::lock_guard<std::mutex> guard(asyncMtx);
+    if (asyncLogSink) return;
+    if (!asyncLogSinkStore)
+        asyncLogSinkStore = new AsyncLogSink(bufferSize);
+    asyncLogSinkStore->handler.start();
+    asyncLogSink.store(asyncLogSinkStore, std::memory_order_release);
+}
+
+void stopAsyncLogging() {
+    std::lock_guard<std::mutex> guard(asyncMtx);
+    AsyncLogSink* sink = asyncLogSink.exchange(NULL);
+    if (!sink) return;
+    // once stopped the sink writes straight to the current sink
+    sink->handler.stop();
+}
+
+uint64_t getDroppedLogMessages() {
+    std::lock_guard<std::mutex> guard(asyncMtx);
+    return asyncLogSinkStore ? asyncLogSinkStore->handler.getDropped() : 0;
 }
 
 void initLogging(const std::string& levelstr,
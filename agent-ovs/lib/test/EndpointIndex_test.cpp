@@ -0,0 +1,118 @@
+/*
+ * Test suite for endpoint index classes
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/EndpointIndex.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <unordered_set>
+
+namespace opflexagent {
+
+using std::string;
+typedef std::unordered_set<string> str_uset_t;
+
+static str_uset_t toSet(const EndpointUUIDView& view) {
+    return str_uset_t(view.begin(), view.end());
+}
+
+BOOST_AUTO_TEST_SUITE(EndpointIndex_test)
+
+BOOST_AUTO_TEST_CASE(handles) {
+    EndpointHandleTable t;
+    EndpointHandleTable::handle_t a = t.acquire("a");
+    EndpointHandleTable::handle_t b = t.acquire("b");
+    BOOST_CHECK(a != b);
+    BOOST_CHECK_EQUAL(a, t.acquire("a"));
+    BOOST_CHECK_EQUAL("a", t.get(a));
+    BOOST_CHECK_EQUAL(2, t.size());
+
+    // released with its last reference, then reused
+    t.release(a);
+    EndpointHandleTable::handle_t h;
+    BOOST_CHECK(t.find("a", h));
+    t.release(a);
+    BOOST_CHECK(!t.find("a", h));
+    BOOST_CHECK_EQUAL(a, t.acquire("c"));
+    BOOST_CHECK_EQUAL("c", t.get(a));
+    BOOST_CHECK_EQUAL("b", t.get(b));
+}
+
+BOOST_AUTO_TEST_CASE(table_snapshot) {
+    EndpointHandleTable t;
+    for (size_t i = 0; i < EndpointHandleTable::CHUNK_SIZE + 10; ++i)
+        t.acquire("ep" + std::to_string(i));
+    std::shared_ptr<const EndpointHandleTable::table_t> snap = t.getTable();
+
+    // reusing a handle does not change the snapshot
+    t.release(3);
+    BOOST_CHECK_EQUAL(3, t.acquire("new"));
+    BOOST_CHECK_EQUAL("new", t.get(3));
+    BOOST_CHECK_EQUAL("ep3", (*(*snap)[0])[3]);
+    // the chunk that did not change is still shared
+    BOOST_CHECK((*snap)[1] == (*t.getTable())[1]);
+}
+
+BOOST_AUTO_TEST_CASE(index) {
+    EndpointHandleTable t;
+    EndpointIndex<string> idx(t);
+    BOOST_CHECK(idx.insert("k1", "a"));
+    BOOST_CHECK(idx.insert("k1", "b"));
+    BOOST_CHECK(!idx.insert("k1", "a"));
+    BOOST_CHECK(idx.insert("k2", "a"));
+    BOOST_CHECK_EQUAL(2, idx.size());
+    BOOST_CHECK_EQUAL(2, t.size());
+    BOOST_CHECK(idx.contains("k1", "b"));
+    BOOST_CHECK(!idx.contains("k2", "b"));
+    BOOST_CHECK(toSet(idx.get("k1")) == str_uset_t({"a", "b"}));
+    BOOST_CHECK(idx.get("k3").empty());
+
+    str_uset_t all;
+    idx.getAll(all);
+    BOOST_CHECK(all == str_uset_t({"a", "b"}));
+
+    BOOST_CHECK(!idx.erase("k1", "c"));
+    BOOST_CHECK(idx.erase("k1", "b"));
+    BOOST_CHECK(!idx.contains("k1", "b"));
+    BOOST_CHECK_EQUAL(1, t.size());
+    BOOST_CHECK(idx.erase("k1", "a"));
+    BOOST_CHECK(!idx.contains("k1"));
+    BOOST_CHECK_EQUAL(1, t.size());
+
+    idx.clear();
+    BOOST_CHECK_EQUAL(0, idx.size());
+    BOOST_CHECK_EQUAL(0, t.size());
+}
+
+BOOST_AUTO_TEST_CASE(view_snapshot) {
+    EndpointHandleTable t;
+    EndpointIndex<string> idx(t);
+    idx.insert("k", "a");
+    idx.insert("k", "b");
+    EndpointUUIDView view = idx.get("k");
+
+    // later updates, including reuse of the handle of "a", are not
+    // visible in the view
+    idx.erase("k", "a");
+    idx.insert("k", "c");
+    idx.insert("other", "d");
+    BOOST_CHECK(toSet(view) == str_uset_t({"a", "b"}));
+    BOOST_CHECK(toSet(idx.get("k")) == str_uset_t({"b", "c"}));
+
+    idx.erase("k", "b");
+    idx.erase("k", "c");
+    BOOST_CHECK_EQUAL(2, view.size());
+    BOOST_CHECK(idx.get("k").empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace opflexagent */
@@ -378,11 +378,26 @@ BOOST_FIXTURE_TEST_CASE( basic, EndpointFixture ) {
     BOOST_CHECK(epUuids.find(ep1.getUUID()) != epUuids.end());
     BOOST_CHECK(epUuids.find(ep2.getUUID()) != epUuids.end());
 
+    EndpointUUIDView view =
+        agent.getEndpointManager().getEndpointsForGroup(epgu);
+    BOOST_CHECK(std::unordered_set<std::string>(view.begin(), view.end()) ==
+                epUuids);
+    BOOST_CHECK_EQUAL(1, agent.getEndpointManager()
+                      .getEndpointsForIPMGroup(epgnat).size());
+    BOOST_CHECK_EQUAL(ep1.getUUID(), *agent.getEndpointManager()
+                      .getEndpointsByIface("veth1").begin());
+
     epSource.removeEndpoint(ep2.getUUID());
     epUuids.clear();
     agent.getEndpointManager().getEndpointsForGroup(epgu, epUuids);
     BOOST_CHECK_EQUAL(1, epUuids.size());
     BOOST_CHECK(epUuids.find(ep1.getUUID()) != epUuids.end());
+    // the view taken earlier is not changed by the removal
+    BOOST_CHECK_EQUAL(2, view.size());
+    BOOST_CHECK_EQUAL(1, agent.getEndpointManager()
+                      .getEndpointsForGroup(epgu).size());
+    BOOST_CHECK(agent.getEndpointManager()
+                .getEndpointsForIPMGroup(epgnat).empty());
 
     epSource.updateEndpoint(ep2);
 
@@ -885,6 +900,117 @@ BOOST_FIXTURE_TEST_CASE( remoteEndpoint, BaseFixture ) {
     agent.getEndpointManager().unregisterListener(&listener);
 }
 
+#ifdef HAVE_PROMETHEUS_SUPPORT
+BOOST_FIXTURE_TEST_CASE( epCounterPrometheus, BaseFixture ) {
+    const string cmd =
+        "curl --proxy \"\" --compressed --silent http://127.0.0.1:9612/metrics 2>&1;";
+    MockEndpointSource epSource(&agent.getEndpointManager());
+    EndpointManager& epMgr = agent.getEndpointManager();
+
+    Endpoint ep1("e82e883b-851d-4cc6-bedb-fb5e27530043");
+    ep1.setMAC(MAC("00:00:00:00:00:01"));
+    ep1.setInterfaceName("veth1");
+    ep1.setAccessInterface("access1");
+    ep1.addAttribute("vm-name", "pod1");
+    ep1.addAttribute("namespace", "ns1");
+    Endpoint ep2("72ffb982-b2d5-4ae4-91ac-0dd61daf527a");
+    ep2.setMAC(MAC("00:00:00:00:00:02"));
+    ep2.setInterfaceName("veth2");
+    ep2.setAccessInterface("access2");
+    epSource.updateEndpoint(ep1);
+    epSource.updateEndpoint(ep2);
+
+    EndpointManager::EpCounters c1{};
+    c1.rxBytes = 1500;
+    c1.rxPackets = 1;
+    c1.txBytes = 3000;
+    c1.txPackets = 2;
+    c1.txDrop = 3;
+    epMgr.updateEndpointCounters(ep1.getUUID(), c1);
+    EndpointManager::EpCounters c2{};
+    c2.rxUnicast = 7;
+    epMgr.updateEndpointCounters(ep2.getUUID(), c2);
+
+    // the values are read from the counter registry when scraped
+    const string l1 = "{name=\"pod1\",namespace=\"ns1\"}";
+    const string l2 = "{name=\"access2\"}";
+    string output = BaseFixture::getOutputFromCommand(cmd);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_rx_bytes" + l1 +
+                               " 1500.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_rx_packets" + l1 +
+                               " 1.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_tx_bytes" + l1 +
+                               " 3000.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_tx_packets" + l1 +
+                               " 2.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_tx_drop_packets" + l1 +
+                               " 3.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_rx_ucast_packets" + l1 +
+                               " 0.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_rx_ucast_packets" + l2 +
+                               " 7.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_active_total 2.000000"),
+                   string::npos);
+
+    // an update is visible at the next scrape
+    c1.rxBytes = 4500;
+    epMgr.updateEndpointCounters(ep1.getUUID(), c1);
+    output = BaseFixture::getOutputFromCommand(cmd);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_rx_bytes" + l1 +
+                               " 4500.000000"), string::npos);
+    BOOST_CHECK_EQUAL(output.find("opflex_endpoint_rx_bytes" + l1 +
+                                  " 1500.000000"), string::npos);
+
+    // removing an endpoint removes its metrics
+    epSource.removeEndpoint(ep1.getUUID());
+    output = BaseFixture::getOutputFromCommand(cmd);
+    BOOST_CHECK_EQUAL(output.find("opflex_endpoint_rx_bytes" + l1),
+                      string::npos);
+    BOOST_CHECK_EQUAL(output.find("opflex_endpoint_tx_drop_packets" + l1),
+                      string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_rx_ucast_packets" + l2 +
+                               " 7.000000"), string::npos);
+    BOOST_CHECK_NE(output.find("opflex_endpoint_active_total 1.000000"),
+                   string::npos);
+
+    epSource.removeEndpoint(ep2.getUUID());
+    output = BaseFixture::getOutputFromCommand(cmd);
+    BOOST_CHECK_EQUAL(output.find("opflex_endpoint_rx_ucast_packets" + l2),
+                      string::npos);
+}
+#endif
+
+BOOST_FIXTURE_TEST_CASE( epCounterRemoved, BaseFixture ) {
+    MockEndpointSource epSource(&agent.getEndpointManager());
+    EndpointManager& epMgr = agent.getEndpointManager();
+    MetricsRegistry& registry = epMgr.getEpCounterRegistry();
+
+    Endpoint ep1("e82e883b-851d-4cc6-bedb-fb5e27530043");
+    ep1.setMAC(MAC("00:00:00:00:00:01"));
+    ep1.setInterfaceName("veth1");
+    epSource.updateEndpoint(ep1);
+
+    EndpointManager::EpCounters c1{};
+    c1.rxBytes = 1500;
+    epMgr.updateEndpointCounters(ep1.getUUID(), c1);
+    MetricsRegistry::id_t id = registry.findId(ep1.getUUID());
+    BOOST_REQUIRE(id != MetricsRegistry::INVALID_ID);
+    BOOST_CHECK_EQUAL(1500u, registry.get(id, EndpointManager::EP_RX_BYTES));
+
+    // counters that arrive after the endpoint is removed are dropped
+    epSource.removeEndpoint(ep1.getUUID());
+    BOOST_CHECK_EQUAL(MetricsRegistry::INVALID_ID,
+                      registry.findId(ep1.getUUID()));
+    epMgr.updateEndpointCounters(ep1.getUUID(), c1);
+    BOOST_CHECK_EQUAL(MetricsRegistry::INVALID_ID,
+                      registry.findId(ep1.getUUID()));
+
+    // as are counters for an endpoint that was never added
+    epMgr.updateEndpointCounters("unknown", c1);
+    BOOST_CHECK_EQUAL(MetricsRegistry::INVALID_ID,
+                      registry.findId("unknown"));
+}
+
 BOOST_FIXTURE_TEST_CASE( fsextsource, FSEndpointFixture ) {
 
     // check already existing
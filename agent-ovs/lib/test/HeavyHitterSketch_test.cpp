@@ -0,0 +1,159 @@
+/*
+ * Test suite for class HeavyHitterSketch
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/HeavyHitterSketch.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+namespace opflexagent {
+
+BOOST_AUTO_TEST_SUITE(HeavyHitterSketch_test)
+
+typedef HeavyHitterSketch<std::string> sketch_t;
+
+BOOST_AUTO_TEST_CASE(exact) {
+    sketch_t s(4);
+    s.add("a", 1, 100);
+    s.add("b", 2, 300);
+    s.add("c", 1, 200);
+    s.add("a", 1, 50);
+    BOOST_CHECK_EQUAL(3, s.size());
+
+    std::vector<sketch_t::Entry> top;
+    s.getTop(2, top);
+    BOOST_REQUIRE_EQUAL(2, top.size());
+    BOOST_CHECK_EQUAL("b", top[0].key);
+    BOOST_CHECK_EQUAL(300, top[0].bytes);
+    BOOST_CHECK_EQUAL("c", top[1].key);
+
+    s.getTop(10, top);
+    BOOST_REQUIRE_EQUAL(3, top.size());
+    BOOST_CHECK_EQUAL("a", top[2].key);
+    BOOST_CHECK_EQUAL(2, top[2].packets);
+    BOOST_CHECK_EQUAL(150, top[2].bytes);
+    BOOST_CHECK_EQUAL(0, top[2].error);
+}
+
+BOOST_AUTO_TEST_CASE(evict) {
+    sketch_t s(2);
+    s.add("a", 1, 100);
+    s.add("b", 1, 10);
+    // replaces b, the lightest, and inherits its counts
+    s.add("c", 1, 5);
+    BOOST_CHECK_EQUAL(2, s.size());
+
+    std::vector<sketch_t::Entry> top;
+    s.getTop(2, top);
+    BOOST_REQUIRE_EQUAL(2, top.size());
+    BOOST_CHECK_EQUAL("a", top[0].key);
+    BOOST_CHECK_EQUAL("c", top[1].key);
+    BOOST_CHECK_EQUAL(15, top[1].bytes);
+    BOOST_CHECK_EQUAL(2, top[1].packets);
+    BOOST_CHECK_EQUAL(10, top[1].error);
+}
+
+BOOST_AUTO_TEST_CASE(heavy_hitters) {
+    // a few heavy keys among many light ones are always found
+    sketch_t s(16);
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 50; ++i)
+            s.add("light" + std::to_string(i), 1, 10);
+        s.add("heavy1", 10, 5000);
+        s.add("heavy2", 10, 3000);
+    }
+
+    std::vector<sketch_t::Entry> top;
+    s.getTop(2, top);
+    BOOST_REQUIRE_EQUAL(2, top.size());
+    BOOST_CHECK_EQUAL("heavy1", top[0].key);
+    BOOST_CHECK_EQUAL("heavy2", top[1].key);
+    BOOST_CHECK(top[0].bytes >= 500000);
+    BOOST_CHECK(top[0].bytes - top[0].error <= 500000);
+}
+
+BOOST_AUTO_TEST_CASE(reenter) {
+    sketch_t s(2);
+    s.add("a", 1, 100);
+    s.add("b", 2, 200);
+
+    std::vector<sketch_t::Entry> top;
+    s.getTop(2, top);
+    BOOST_REQUIRE_EQUAL(2, top.size());
+    BOOST_CHECK_EQUAL("b", top[0].key);
+    BOOST_CHECK_EQUAL(200, top[0].newBytes);
+    BOOST_CHECK_EQUAL(100, top[1].newBytes);
+    s.markExported("a");
+    s.markExported("b");
+
+    // c evicts a and inherits its counts, but only its own traffic
+    // is new
+    s.add("c", 1, 10);
+    s.getTop(2, top);
+    BOOST_REQUIRE_EQUAL(2, top.size());
+    BOOST_CHECK_EQUAL("b", top[0].key);
+    BOOST_CHECK_EQUAL(0, top[0].newBytes);
+    BOOST_CHECK_EQUAL("c", top[1].key);
+    BOOST_CHECK_EQUAL(110, top[1].bytes);
+    BOOST_CHECK_EQUAL(10, top[1].newBytes);
+    BOOST_CHECK_EQUAL(1, top[1].newPackets);
+    s.markExported("c");
+
+    // a comes back by evicting c; the 100 bytes exported before it
+    // was evicted are not new again
+    s.add("a", 1, 20);
+    s.getTop(2, top);
+    BOOST_REQUIRE_EQUAL(2, top.size());
+    BOOST_CHECK_EQUAL("b", top[0].key);
+    BOOST_CHECK_EQUAL("a", top[1].key);
+    BOOST_CHECK_EQUAL(130, top[1].bytes);
+    BOOST_CHECK_EQUAL(110, top[1].error);
+    BOOST_CHECK_EQUAL(20, top[1].newBytes);
+    BOOST_CHECK_EQUAL(1, top[1].newPackets);
+
+    // new counts accumulate until the key is exported
+    s.add("a", 1, 30);
+    s.getTop(2, top);
+    BOOST_CHECK_EQUAL("a", top[1].key);
+    BOOST_CHECK_EQUAL(50, top[1].newBytes);
+    BOOST_CHECK_EQUAL(2, top[1].newPackets);
+    s.markExported("a");
+    s.markExported("x");
+    s.getTop(2, top);
+    BOOST_CHECK_EQUAL(0, top[1].newBytes);
+    BOOST_CHECK_EQUAL(0, top[1].newPackets);
+}
+
+BOOST_AUTO_TEST_CASE(remove) {
+    sketch_t s(4);
+    s.add("a", 1, 100);
+    s.add("b", 1, 200);
+    s.add("c", 1, 300);
+    BOOST_CHECK(s.remove("a"));
+    BOOST_CHECK(!s.remove("a"));
+    BOOST_CHECK_EQUAL(2, s.size());
+
+    s.add("d", 1, 50);
+    std::vector<sketch_t::Entry> top;
+    s.getTop(4, top);
+    BOOST_REQUIRE_EQUAL(3, top.size());
+    BOOST_CHECK_EQUAL("c", top[0].key);
+    BOOST_CHECK_EQUAL("b", top[1].key);
+    BOOST_CHECK_EQUAL("d", top[2].key);
+
+    s.clear();
+    BOOST_CHECK_EQUAL(0, s.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -33,6 +33,42 @@ BOOST_AUTO_TEST_CASE(limit) {
     BOOST_CHECK(l.event("test"));
 }
 
+BOOST_AUTO_TEST_CASE(token_bucket) {
+    typedef std::chrono::steady_clock::time_point time_point;
+    typedef std::chrono::milliseconds ms;
+    KeyedTokenBucket<uint32_t> l(10, 3);
+    time_point t0 = std::chrono::steady_clock::now();
+
+    // a burst of three, then nothing until a token is refilled
+    BOOST_CHECK(l.event(1, t0));
+    BOOST_CHECK(l.event(1, t0));
+    BOOST_CHECK(l.event(1, t0));
+    BOOST_CHECK_EQUAL(false, l.event(1, t0));
+    BOOST_CHECK_EQUAL(false, l.event(1, t0 + ms(50)));
+    BOOST_CHECK(l.event(1, t0 + ms(110)));
+    BOOST_CHECK_EQUAL(false, l.event(1, t0 + ms(120)));
+
+    // keys have separate buckets
+    BOOST_CHECK(l.event(2, t0 + ms(120)));
+    BOOST_CHECK_EQUAL(2, l.size());
+
+    // tokens don't accumulate beyond the burst size
+    time_point t1 = t0 + ms(10000);
+    BOOST_CHECK(l.event(1, t1));
+    BOOST_CHECK(l.event(1, t1));
+    BOOST_CHECK(l.event(1, t1));
+    BOOST_CHECK_EQUAL(false, l.event(1, t1));
+
+    l.erase(1);
+    BOOST_CHECK_EQUAL(1, l.size());
+    BOOST_CHECK(l.event(1, t1));
+
+    // no limit
+    l.setRate(0, 1);
+    for (int i = 0; i < 100; ++i)
+        BOOST_CHECK(l.event(1, t1));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -0,0 +1,103 @@
+/*
+ * Test suite for class MetricsRegistry
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <opflexagent/MetricsRegistry.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace opflexagent {
+
+BOOST_AUTO_TEST_SUITE(MetricsRegistry_test)
+
+BOOST_AUTO_TEST_CASE(basic) {
+    MetricsRegistry r(3);
+    BOOST_CHECK_EQUAL(3, r.getWidth());
+    BOOST_CHECK_EQUAL(MetricsRegistry::INVALID_ID, r.findId("a"));
+
+    MetricsRegistry::id_t a = r.getId("a");
+    MetricsRegistry::id_t b = r.getId("b");
+    BOOST_CHECK(a != b);
+    BOOST_CHECK_EQUAL(a, r.getId("a"));
+    BOOST_CHECK_EQUAL(a, r.findId("a"));
+    BOOST_CHECK_EQUAL(2, r.size());
+
+    r.set(a, 0, 10);
+    r.add(a, 0, 5);
+    r.set(b, 2, 7);
+    BOOST_CHECK_EQUAL(15, r.get(a, 0));
+    BOOST_CHECK_EQUAL(0, r.get(a, 2));
+    BOOST_CHECK_EQUAL(7, r.get(b, 2));
+
+    // out of range counters and invalid IDs are ignored
+    r.set(a, 3, 1);
+    r.set(MetricsRegistry::INVALID_ID, 0, 1);
+    BOOST_CHECK_EQUAL(0, r.get(a, 3));
+    BOOST_CHECK_EQUAL(0, r.get(MetricsRegistry::INVALID_ID, 0));
+
+    std::set<std::string> keys;
+    r.forEach([&](const std::string& key, MetricsRegistry::id_t id) {
+            keys.insert(key);
+            BOOST_CHECK_EQUAL(id, key == "a" ? a : b);
+        });
+    BOOST_CHECK_EQUAL(2, keys.size());
+}
+
+BOOST_AUTO_TEST_CASE(reuse) {
+    MetricsRegistry r(2);
+    MetricsRegistry::id_t a = r.getId("a");
+    r.set(a, 1, 42);
+    r.remove("a");
+    BOOST_CHECK_EQUAL(MetricsRegistry::INVALID_ID, r.findId("a"));
+    BOOST_CHECK_EQUAL(0, r.size());
+
+    // the row is reused for the next key, with its counters reset
+    MetricsRegistry::id_t c = r.getId("c");
+    BOOST_CHECK_EQUAL(a, c);
+    BOOST_CHECK_EQUAL(0, r.get(c, 1));
+}
+
+BOOST_AUTO_TEST_CASE(grow) {
+    MetricsRegistry r(1);
+    std::vector<MetricsRegistry::id_t> ids;
+    for (size_t i = 0; i < 5000; ++i) {
+        ids.push_back(r.getId(std::to_string(i)));
+        r.set(ids.back(), 0, i);
+    }
+    for (size_t i = 0; i < ids.size(); ++i)
+        BOOST_CHECK_EQUAL(i, r.get(ids[i], 0));
+}
+
+BOOST_AUTO_TEST_CASE(concurrent) {
+    MetricsRegistry r(1);
+    MetricsRegistry::id_t id = r.getId("a");
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+                for (size_t i = 0; i < 10000; ++i)
+                    r.add(id, 0, 1);
+            });
+    }
+    // registering other keys while counters are updated must not
+    // disturb them
+    for (size_t i = 0; i < 2000; ++i)
+        r.getId(std::to_string(i));
+    for (std::thread& t : threads)
+        t.join();
+    BOOST_CHECK_EQUAL(40000, r.get(id, 0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -14,6 +14,8 @@
 
 #include <opflex/modb/MAC.h>
 
+#include <unordered_set>
+
 using namespace opflexagent::network;
 using boost::asio::ip::address;
 using boost::asio::ip::address_v6;
@@ -156,4 +158,105 @@ BOOST_AUTO_TEST_CASE(test_solicited_node) {
 #undef cni
 }
 
+BOOST_AUTO_TEST_CASE(test_compress_subnets) {
+    subnets_t result;
+
+    compress_subnets({{"10.0.0.0", 25}, {"10.0.0.128", 25},
+                      {"10.0.1.0", 24}, {"10.0.0.17", 32},
+                      {"10.0.3.4", 32}, {"10.0.3.5", 32},
+                      {"10.0.3.6", 32}}, result);
+    BOOST_CHECK(result == subnets_t({{"10.0.0.0", 23},
+                                    {"10.0.3.4", 31},
+                                    {"10.0.3.6", 32}}));
+
+    result.clear();
+    compress_subnets({{"10.1.2.3", 8}, {"10.200.0.0", 16}}, result);
+    BOOST_CHECK(result == subnets_t({{"10.0.0.0", 8}}));
+
+    result.clear();
+    compress_subnets({{"0.0.0.0", 1}, {"128.0.0.0", 1},
+                      {"fd00::", 65}, {"fd00::8000:0:0:0", 65},
+                      {"fd00:0:0:1::5", 128}}, result);
+    BOOST_CHECK(result == subnets_t({{"0.0.0.0", 0},
+                                    {"fd00::", 64},
+                                    {"fd00:0:0:1::5", 128}}));
+
+    result.clear();
+    compress_subnets({{"", 0}, {"foo", 24}, {"1.2.3.4", 32}}, result);
+    BOOST_CHECK(result == subnets_t({{"", 0}, {"foo", 24},
+                                    {"1.2.3.4", 32}}));
+}
+
+BOOST_AUTO_TEST_CASE(test_ip_addr) {
+    ip_addr a, b, c;
+    BOOST_CHECK(a.empty());
+    BOOST_CHECK(ip_addr::from_string("10.1.2.3", a));
+    BOOST_CHECK(a.is_v4());
+    BOOST_CHECK_EQUAL("10.1.2.3", a.to_string());
+    BOOST_CHECK_EQUAL(address::from_string("10.1.2.3"), a.to_address());
+    BOOST_CHECK(ip_addr(address::from_string("10.1.2.3")) == a);
+
+    BOOST_CHECK(ip_addr::from_string("fd00::1%eth0", b));
+    BOOST_CHECK(b.is_v6());
+    BOOST_CHECK_EQUAL("fd00::1", b.to_string());
+    BOOST_CHECK(a < b);
+    BOOST_CHECK(a != b);
+
+    // the same bytes in a different family
+    BOOST_CHECK(ip_addr::from_string("a01:203::", c));
+    BOOST_CHECK(a != c);
+    BOOST_CHECK(a.hash() != c.hash());
+
+    BOOST_CHECK(!ip_addr::from_string("", c));
+    BOOST_CHECK(!ip_addr::from_string("10.1.2", c));
+    BOOST_CHECK(!ip_addr::from_string("10.1.2.3%eth0", c));
+    BOOST_CHECK(!ip_addr::from_string("fd00::g", c));
+    BOOST_CHECK_EQUAL("a01:203::", c.to_string());
+
+    BOOST_CHECK_EQUAL("10.1.0.0", a.mask(17).to_string());
+    BOOST_CHECK_EQUAL("fd00::", b.mask(64).to_string());
+}
+
+BOOST_AUTO_TEST_CASE(test_ip_prefix) {
+    ip_prefix p;
+    BOOST_CHECK(ip_prefix::from_string("10.1.2.3", p));
+    BOOST_CHECK_EQUAL(32, p.length());
+    BOOST_CHECK(ip_prefix::from_string("fd00::1", p));
+    BOOST_CHECK_EQUAL(128, p.length());
+
+    BOOST_CHECK(ip_prefix::from_string("10.1.2.3/16", p));
+    BOOST_CHECK_EQUAL("10.1.0.0/16", p.to_string());
+    BOOST_CHECK(ip_prefix::from_string("10.1.2.3/16", p, false));
+    BOOST_CHECK_EQUAL("10.1.2.3/16", p.to_string());
+    cidr_t cidr;
+    BOOST_CHECK(cidr_from_string("10.1.2.3/16", cidr, false));
+    BOOST_CHECK(cidr == p.to_cidr());
+
+    ip_addr a;
+    ip_addr::from_string("10.1.255.1", a);
+    BOOST_CHECK(p.contains(a));
+    ip_addr::from_string("10.2.0.1", a);
+    BOOST_CHECK(!p.contains(a));
+    ip_prefix sub(a.mask(24), 24);
+    BOOST_CHECK(!p.contains(sub));
+    ip_prefix::from_string("10.1.7.0/24", sub);
+    BOOST_CHECK(p.contains(sub));
+    BOOST_CHECK(!sub.contains(p));
+    BOOST_CHECK(p.contains(p));
+
+    BOOST_CHECK(!ip_prefix::from_string("10.1.2.3/33", p));
+    BOOST_CHECK(!ip_prefix::from_string("10.1.2.3/", p));
+    BOOST_CHECK(!ip_prefix::from_string("10.1.2.3/1x", p));
+    BOOST_CHECK(!ip_prefix::from_string("fd00::/129", p));
+
+    std::unordered_set<ip_prefix> prefixes;
+    ip_prefix::from_string("10.0.0.0/8", p);
+    prefixes.insert(p);
+    ip_prefix::from_string("10.0.0.0/16", p);
+    prefixes.insert(p);
+    ip_prefix::from_string("10.1.0.0/8", p);
+    prefixes.insert(p);
+    BOOST_CHECK_EQUAL(2, prefixes.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
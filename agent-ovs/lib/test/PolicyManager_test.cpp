@@ -517,6 +517,46 @@ BOOST_FIXTURE_TEST_CASE( contract_rules, PolicyFixture ) {
                            DirectionEnumT::CONST_IN));
 }
 
+BOOST_FIXTURE_TEST_CASE( snapshot, PolicyFixture ) {
+    PolicyManager& pm = agent.getPolicyManager();
+    shared_ptr<const PolicyManager::Snapshot::ContractInfo> contract;
+    WAIT_FOR(pm.getSnapshot()->getGroup(eg1->getURI()), 500);
+    WAIT_FOR_DO(contract && contract->rules.size() == 6, 500,
+                contract = pm.getSnapshot()->getContract(con1->getURI()));
+
+    PolicyManager::snapshot_ptr before = pm.getSnapshot();
+    shared_ptr<const PolicyManager::Snapshot::GroupInfo> group =
+        before->getGroup(eg1->getURI());
+    BOOST_REQUIRE(group);
+    BOOST_CHECK(group->vnid.get() == 1234);
+    BOOST_CHECK(group->sclass.get() == 3456);
+    BOOST_CHECK(group->multicastIP.get() == "224.1.1.1");
+    BOOST_CHECK(group->floodDomain.get()->getURI() == fd->getURI());
+    PolicyManager::subnet_vector_t subnets;
+    pm.getSubnetsForGroup(eg1->getURI(), subnets);
+    BOOST_CHECK_EQUAL(subnets.size(), group->subnets.size());
+    BOOST_CHECK(!before->getGroup(URI("bad")));
+
+    contract = before->getContract(con1->getURI());
+    BOOST_REQUIRE(contract);
+    BOOST_CHECK(contract->providerGroups.size() == 2);
+    BOOST_CHECK(checkContains(contract->providerGroups, eg1->getURI()));
+    BOOST_CHECK(checkContains(contract->consumerGroups, eg2->getURI()));
+    BOOST_CHECK(!before->getContract(URI("invalid")));
+
+    Mutator mutator(framework, "policyreg");
+    eg1->remove();
+    mutator.commit();
+    WAIT_FOR(!pm.getSnapshot()->getGroup(eg1->getURI()), 500);
+    WAIT_FOR(!checkContains(pm.getSnapshot()->getContract(con1->getURI())
+                            ->providerGroups, eg1->getURI()), 500);
+
+    // a snapshot that is held does not change
+    BOOST_CHECK(pm.getSnapshot()->getVersion() > before->getVersion());
+    BOOST_CHECK(before->getGroup(eg1->getURI()) == group);
+    BOOST_CHECK(before->getContract(con1->getURI()) == contract);
+}
+
 BOOST_FIXTURE_TEST_CASE( nat_rd_update, PolicyFixture ) {
     PolicyManager& pm = agent.getPolicyManager();
 
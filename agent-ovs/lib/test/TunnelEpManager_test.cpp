@@ -0,0 +1,265 @@
+/*
+ * Test suite for class TunnelEpManager and its interface address cache
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#ifdef HAVE_LINUX_RTNETLINK_H
+
+#include <opflexagent/InterfaceAddrCache.h>
+#include <opflexagent/TunnelEpManager.h>
+#include <opflexagent/test/BaseFixture.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace opflexagent {
+
+using std::string;
+using boost::asio::ip::address;
+
+// Builds buffers of rtnetlink messages as the kernel would send them
+class NlBuilder {
+public:
+    NlBuilder& link(int index, const string& name, unsigned flags,
+                    const string& mac, uint16_t type = RTM_NEWLINK) {
+        std::vector<char> msg(NLMSG_SPACE(sizeof(struct ifinfomsg)));
+        struct ifinfomsg* ifi = (struct ifinfomsg*)NLMSG_DATA(msg.data());
+        ifi->ifi_family = AF_UNSPEC;
+        ifi->ifi_index = index;
+        ifi->ifi_flags = flags;
+        attr(msg, IFLA_IFNAME, name.c_str(), name.size() + 1);
+        if (!mac.empty()) {
+            uint8_t b[6];
+            opflex::modb::MAC(mac).toUIntArray(b);
+            attr(msg, IFLA_ADDRESS, b, sizeof(b));
+        }
+        return add(msg, type);
+    }
+
+    NlBuilder& addr(int index, const string& a,
+                    uint16_t type = RTM_NEWADDR) {
+        address ip = address::from_string(a);
+        std::vector<char> msg(NLMSG_SPACE(sizeof(struct ifaddrmsg)));
+        struct ifaddrmsg* ifa = (struct ifaddrmsg*)NLMSG_DATA(msg.data());
+        ifa->ifa_index = index;
+        if (ip.is_v4()) {
+            ifa->ifa_family = AF_INET;
+            auto b = ip.to_v4().to_bytes();
+            attr(msg, IFA_ADDRESS, b.data(), b.size());
+            attr(msg, IFA_LOCAL, b.data(), b.size());
+        } else {
+            ifa->ifa_family = AF_INET6;
+            auto b = ip.to_v6().to_bytes();
+            attr(msg, IFA_ADDRESS, b.data(), b.size());
+        }
+        return add(msg, type);
+    }
+
+    NlBuilder& done() {
+        std::vector<char> msg(NLMSG_SPACE(sizeof(int)));
+        return add(msg, NLMSG_DONE);
+    }
+
+    const std::vector<char>& get() const { return buf; }
+
+private:
+    std::vector<char> buf;
+
+    static void attr(std::vector<char>& msg, uint16_t type,
+                     const void* data, size_t len) {
+        size_t off = msg.size();
+        msg.resize(off + RTA_SPACE(len));
+        struct rtattr* rta = (struct rtattr*)&msg[off];
+        rta->rta_type = type;
+        rta->rta_len = RTA_LENGTH(len);
+        memcpy(RTA_DATA(rta), data, len);
+    }
+
+    NlBuilder& add(std::vector<char>& msg, uint16_t type) {
+        struct nlmsghdr* nlh = (struct nlmsghdr*)msg.data();
+        nlh->nlmsg_len = msg.size();
+        nlh->nlmsg_type = type;
+        nlh->nlmsg_flags = NLM_F_MULTI;
+        buf.insert(buf.end(), msg.begin(), msg.end());
+        return *this;
+    }
+};
+
+// A netlink socket that answers dumps with the given messages, and
+// can send notifications
+class MockNetlinkSocket : public NetlinkSocket {
+public:
+    MockNetlinkSocket(std::vector<char> links_, std::vector<char> addrs_)
+        : links(std::move(links_)), addrs(std::move(addrs_)) {
+        fds[0] = fds[1] = -1;
+    }
+    virtual ~MockNetlinkSocket() { close(); }
+
+    virtual int open() {
+        // datagrams, like netlink
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) < 0)
+            return -1;
+        return fds[0];
+    }
+
+    virtual bool requestDump(uint16_t type) {
+        dumps.push_back(type);
+        return send(type == RTM_GETLINK ? links : addrs);
+    }
+
+    virtual void close() {
+        for (int& fd : fds) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    }
+
+    bool send(const std::vector<char>& msgs) {
+        return ::send(fds[1], msgs.data(), msgs.size(), 0) ==
+            (ssize_t)msgs.size();
+    }
+
+    std::vector<uint16_t> dumps;
+
+private:
+    std::vector<char> links;
+    std::vector<char> addrs;
+    int fds[2];
+};
+
+// Records the UUID of the updated tunnel endpoint
+class UuidListener : public EndpointListener {
+public:
+    virtual void endpointUpdated(const std::string& uuid_) {
+        std::lock_guard<std::mutex> guard(mutex);
+        uuid = uuid_;
+    }
+
+    string getUuid() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return uuid;
+    }
+
+private:
+    std::mutex mutex;
+    string uuid;
+};
+
+static string getTerminationIp(TunnelEpManager& m, const string& uuid) {
+    try {
+        return m.getTerminationIp(uuid);
+    } catch (const std::out_of_range&) {
+        return "";
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(TunnelEpManager_test)
+
+BOOST_AUTO_TEST_CASE(cache) {
+    InterfaceAddrCache cache;
+    string a, mac, iface;
+    bool v4 = false;
+    BOOST_CHECK(!cache.getUplink("", a, mac, iface, v4));
+
+    NlBuilder dump;
+    dump.link(1, "lo", IFF_UP | IFF_LOOPBACK, "")
+        .link(2, "eth0", IFF_UP, "00:00:00:00:00:02")
+        .link(3, "eth1", 0, "00:00:00:00:00:03")
+        .link(4, "veth4", IFF_UP, "00:00:00:00:00:04")
+        .addr(1, "127.0.0.1")
+        .addr(2, "fe80::2")
+        .addr(3, "10.0.0.3")
+        .done();
+    int r = cache.apply(dump.get().data(), dump.get().size());
+    BOOST_CHECK(r & InterfaceAddrCache::CHANGED);
+    BOOST_CHECK(r & InterfaceAddrCache::DUMP_DONE);
+    BOOST_CHECK_EQUAL(4, cache.getLinks().size());
+
+    // the only address of an up, non-loopback interface
+    BOOST_CHECK(cache.getUplink("", a, mac, iface, v4));
+    BOOST_CHECK_EQUAL("fe80::2", a);
+    BOOST_CHECK_EQUAL("00:00:00:00:00:02", mac);
+    BOOST_CHECK_EQUAL("eth0", iface);
+    BOOST_CHECK(!v4);
+
+    // IPv4 is preferred
+    NlBuilder up;
+    up.link(3, "eth1", IFF_UP, "00:00:00:00:00:03");
+    BOOST_CHECK(cache.apply(up.get().data(), up.get().size()) &
+                InterfaceAddrCache::CHANGED);
+    BOOST_CHECK(cache.getUplink("", a, mac, iface, v4));
+    BOOST_CHECK_EQUAL("10.0.0.3", a);
+    BOOST_CHECK_EQUAL("eth1", iface);
+    BOOST_CHECK(v4);
+
+    // unless another interface is chosen
+    BOOST_CHECK(cache.getUplink("eth0", a, mac, iface, v4));
+    BOOST_CHECK_EQUAL("fe80::2", a);
+    BOOST_CHECK(!cache.getUplink("veth4", a, mac, iface, v4));
+
+    // repeated notifications do not change the cache
+    BOOST_CHECK_EQUAL(0, cache.apply(up.get().data(), up.get().size()));
+
+    NlBuilder del;
+    del.addr(3, "10.0.0.3", RTM_DELADDR).link(2, "eth0", 0, "", RTM_DELLINK);
+    BOOST_CHECK(cache.apply(del.get().data(), del.get().size()) &
+                InterfaceAddrCache::CHANGED);
+    BOOST_CHECK_EQUAL(3, cache.getLinks().size());
+    BOOST_CHECK(!cache.getUplink("", a, mac, iface, v4));
+}
+
+BOOST_FIXTURE_TEST_CASE(netlink, BaseFixture) {
+    NlBuilder links, addrs;
+    links.link(1, "lo", IFF_UP | IFF_LOOPBACK, "")
+        .link(2, "eth0", IFF_UP, "00:00:00:00:00:02")
+        .done();
+    addrs.addr(1, "127.0.0.1").addr(2, "10.0.0.2").done();
+    MockNetlinkSocket* sock =
+        new MockNetlinkSocket(links.get(), addrs.get());
+
+    TunnelEpManager m(&agent, 60 * 60 * 1000);
+    m.setNetlinkSocket(std::unique_ptr<NetlinkSocket>(sock));
+    UuidListener listener;
+    m.registerListener(&listener);
+    m.start();
+
+    WAIT_FOR(listener.getUuid() != "", 1000);
+    string uuid = listener.getUuid();
+    BOOST_CHECK(m.isTunnelEp(uuid));
+    BOOST_CHECK_EQUAL("10.0.0.2", getTerminationIp(m, uuid));
+    BOOST_CHECK_EQUAL("00:00:00:00:00:02", m.getTerminationMac(uuid));
+    BOOST_CHECK(sock->dumps ==
+                std::vector<uint16_t>({RTM_GETLINK, RTM_GETADDR}));
+
+    // an address change is applied without waiting for the timer
+    NlBuilder change;
+    change.addr(2, "10.0.0.2", RTM_DELADDR).addr(2, "10.0.0.20");
+    BOOST_REQUIRE(sock->send(change.get()));
+    WAIT_FOR(getTerminationIp(m, uuid) == "10.0.0.20", 1000);
+
+    m.stop();
+    m.unregisterListener(&listener);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* namespace opflexagent */
+
+#endif /* HAVE_LINUX_RTNETLINK_H */
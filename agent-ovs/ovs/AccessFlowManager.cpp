@@ -69,7 +69,7 @@ AccessFlowManager::AccessFlowManager(Agent& agent_,
                                      CtZoneManager& ctZoneManager_)
     : agent(agent_), switchManager(switchManager_), idGen(idGen_),
       ctZoneManager(ctZoneManager_), taskQueue(agent.getAgentIOService()),
-      conntrackEnabled(false), stopping(false), dropLogRemotePort(0) {
+      secGrpRulesGen(0), conntrackEnabled(false), stopping(false), dropLogRemotePort(0) {
     // set up flow tables
     switchManager.setMaxFlowTables(NUM_FLOW_TABLES);
     SwitchManager::TableDescriptionMap fwdTblDescr;
@@ -554,21 +554,83 @@ void AccessFlowManager::handlePortStatusUpdate(const string& portName,
 }
 
 void AccessFlowManager::handleSecGrpUpdate(const opflex::modb::URI& uri) {
+    {
+        std::lock_guard<std::mutex> guard(secGrpRulesMutex);
+        secGrpRulesCache.erase(uri);
+        secGrpRulesGen += 1;
+    }
+
     unordered_set<uri_set_t> secGrpSets;
     agent.getEndpointManager().getSecGrpSetsForSecGrp(uri, secGrpSets);
     for (const uri_set_t& secGrpSet : secGrpSets)
         secGroupSetUpdated(secGrpSet);
 }
 
+AccessFlowManager::sec_grp_rules_ptr
+AccessFlowManager::getSecGrpRules(const URI& secGrp) {
+    using modelgbp::gbp::ConnTrackEnumT;
+
+    // The rules are compiled without holding the lock.  Read the
+    // generation first, so that rules compiled from a policy snapshot
+    // older than a concurrent invalidation are not cached
+    uint64_t gen;
+    {
+        std::lock_guard<std::mutex> guard(secGrpRulesMutex);
+        auto it = secGrpRulesCache.find(secGrp);
+        if (it != secGrpRulesCache.end())
+            return it->second;
+        gen = secGrpRulesGen;
+    }
+
+    shared_ptr<const PolicyManager::rule_list_t> rules =
+        agent.getPolicyManager().getSnapshot()->getSecGroupRules(secGrp);
+    if (!rules)
+        rules = std::make_shared<PolicyManager::rule_list_t>();
+
+    auto compiled = std::make_shared<sec_grp_rules_t>();
+    compiled->reserve(rules->size());
+    for (const shared_ptr<PolicyRule>& pc : *rules) {
+        SecGrpRule rule;
+        rule.cls = pc->getL24Classifier();
+        rule.dir = pc->getDirection();
+        rule.priority = pc->getPriority();
+        const URI& ruleURI = rule.cls->getURI();
+        rule.cookie = idGen.getId("l24classifierRule", ruleURI.toString());
+        rule.skipL34 = false;
+        if (!pc->getRemoteSubnets().empty()) {
+            network::compress_subnets(pc->getRemoteSubnets(),
+                                      rule.remoteSubs);
+        } else {
+            rule.skipL34 = !agent.addL34FlowsWithoutSubnet();
+            LOG(DEBUG) << "skipL34 flows: " << rule.skipL34
+                       << " for rule: " << ruleURI;
+        }
+
+        rule.act = flowutils::CA_DENY;
+        if (pc->getAllow()) {
+            if (rule.cls->getConnectionTracking(ConnTrackEnumT::CONST_NORMAL) ==
+                ConnTrackEnumT::CONST_REFLEXIVE) {
+                rule.act = flowutils::CA_REFLEX_FWD;
+            } else {
+                rule.act = flowutils::CA_ALLOW;
+            }
+        }
+        compiled->push_back(std::move(rule));
+    }
+
+    std::lock_guard<std::mutex> guard(secGrpRulesMutex);
+    if (gen == secGrpRulesGen)
+        secGrpRulesCache[secGrp] = compiled;
+    return compiled;
+}
+
 void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                               const string& secGrpsIdStr) {
     using modelgbp::gbpe::L24Classifier;
     using modelgbp::gbp::DirectionEnumT;
-    using modelgbp::gbp::ConnTrackEnumT;
     using flowutils::CA_REFLEX_REV_ALLOW;
     using flowutils::CA_REFLEX_REV_TRACK;
     using flowutils::CA_REFLEX_FWD;
-    using flowutils::CA_ALLOW;
     using flowutils::CA_REFLEX_FWD_TRACK;
     using flowutils::CA_REFLEX_FWD_EST;
     using flowutils::CA_REFLEX_REV_RELATED;
@@ -587,34 +649,18 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
     FlowEntryList secGrpOut;
 
     for (const opflex::modb::URI& secGrp : secGrps) {
-        PolicyManager::rule_list_t rules;
-        agent.getPolicyManager().getSecGroupRules(secGrp, rules);
-
-        for (shared_ptr<PolicyRule>& pc : rules) {
-            uint8_t dir = pc->getDirection();
-            bool skipL34 = false;
-            const shared_ptr<L24Classifier>& cls = pc->getL24Classifier();
-            const URI& ruleURI = cls.get()->getURI();
-            uint64_t secGrpCookie =
-                idGen.getId("l24classifierRule", ruleURI.toString());
+        sec_grp_rules_ptr rules = getSecGrpRules(secGrp);
+
+        for (const SecGrpRule& rule : *rules) {
+            uint8_t dir = rule.dir;
+            bool skipL34 = rule.skipL34;
+            const shared_ptr<L24Classifier>& cls = rule.cls;
+            uint64_t secGrpCookie = rule.cookie;
+            flowutils::ClassAction act = rule.act;
+            uint16_t prio = rule.priority;
             boost::optional<const network::subnets_t&> remoteSubs;
-            if (!pc->getRemoteSubnets().empty()) {
-                remoteSubs = pc->getRemoteSubnets();
-            } else {
-                skipL34 = !agent.addL34FlowsWithoutSubnet();
-                LOG(DEBUG) << "skipL34 flows: " << skipL34
-                           << " for rule: " << ruleURI;
-            }
-
-            flowutils::ClassAction act = flowutils::CA_DENY;
-            if (pc->getAllow()) {
-                if (cls->getConnectionTracking(ConnTrackEnumT::CONST_NORMAL) ==
-                    ConnTrackEnumT::CONST_REFLEXIVE) {
-                    act = CA_REFLEX_FWD;
-                } else {
-                    act = CA_ALLOW;
-                }
-            }
+            if (!rule.remoteSubs.empty())
+                remoteSubs = rule.remoteSubs;
 
             /*
              * Do not program higher level protocols
@@ -626,7 +672,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                     dir == DirectionEnumT::CONST_IN) {
                     flowutils::add_l2classifier_entries(*cls, act,
                                                         OUT_TABLE_ID,
-                                                        pc->getPriority(),
+                                                        prio,
                                                         OFPUTIL_FF_SEND_FLOW_REM,
                                                         secGrpCookie,
                                                         secGrpSetId, 0,
@@ -636,7 +682,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                     dir == DirectionEnumT::CONST_OUT) {
                     flowutils::add_l2classifier_entries(*cls, act,
                                                         OUT_TABLE_ID,
-                                                        pc->getPriority(),
+                                                        prio,
                                                         OFPUTIL_FF_SEND_FLOW_REM,
                                                         secGrpCookie,
                                                         secGrpSetId, 0,
@@ -651,7 +697,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                   remoteSubs,
                                                   boost::none,
                                                   OUT_TABLE_ID,
-                                                  pc->getPriority(),
+                                                  prio,
                                                   OFPUTIL_FF_SEND_FLOW_REM,
                                                   secGrpCookie,
                                                   secGrpSetId, 0,
@@ -661,7 +707,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       remoteSubs,
                                                       boost::none,
                                                       GROUP_MAP_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
@@ -670,7 +716,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       remoteSubs,
                                                       boost::none,
                                                       OUT_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
@@ -680,7 +726,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       boost::none,
                                                       remoteSubs,
                                                       GROUP_MAP_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       0,
                                                       secGrpSetId, 0,
@@ -689,7 +735,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       boost::none,
                                                       remoteSubs,
                                                       OUT_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
@@ -698,7 +744,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       boost::none,
                                                       remoteSubs,
                                                       OUT_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
@@ -711,7 +757,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                   boost::none,
                                                   remoteSubs,
                                                   OUT_TABLE_ID,
-                                                  pc->getPriority(),
+                                                  prio,
                                                   OFPUTIL_FF_SEND_FLOW_REM,
                                                   secGrpCookie,
                                                   secGrpSetId, 0,
@@ -721,7 +767,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       boost::none,
                                                       remoteSubs,
                                                       GROUP_MAP_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
@@ -730,7 +776,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       boost::none,
                                                       remoteSubs,
                                                       OUT_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
@@ -740,7 +786,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       remoteSubs,
                                                       boost::none,
                                                       GROUP_MAP_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       0,
                                                       secGrpSetId, 0,
@@ -749,7 +795,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       remoteSubs,
                                                       boost::none,
                                                       OUT_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
@@ -758,7 +804,7 @@ void AccessFlowManager::handleSecGrpSetUpdate(const uri_set_t& secGrps,
                                                       remoteSubs,
                                                       boost::none,
                                                       OUT_TABLE_ID,
-                                                      pc->getPriority(),
+                                                      prio,
                                                       OFPUTIL_FF_SEND_FLOW_REM,
                                                       secGrpCookie,
                                                       secGrpSetId, 0,
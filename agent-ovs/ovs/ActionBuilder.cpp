@@ -261,6 +261,14 @@ ActionBuilder& ActionBuilder::macVlanLearn(uint16_t prio,
     return *this;
 }
 
+ActionBuilder& ActionBuilder::sample(uint16_t probability,
+                                     uint32_t collectorSetId,
+                                     uint32_t obsDomainId,
+                                     uint32_t obsPointId) {
+    act_sample(buf, probability, collectorSetId, obsDomainId, obsPointId);
+    return *this;
+}
+
 ActionBuilder& ActionBuilder::tunMetadata(mf_field_id regId, uint32_t regValue) {
     uint32_t value = htonl(regValue);
     uint32_t mask = ~((uint32_t)0);
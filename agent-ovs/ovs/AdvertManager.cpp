@@ -54,12 +54,18 @@ namespace opflexagent {
 
 static const address_v6 ALL_NODES_IP(address_v6::from_string("ff02::1"));
 
+const size_t AdvertManager::DEFAULT_ADV_BATCH_SIZE;
+const uint64_t AdvertManager::DEFAULT_ADV_PACING_WINDOW;
+
 AdvertManager::AdvertManager(Agent& agent_,
                              IntFlowManager& intFlowManager_)
     : urng(rng()), all_ep_dis(300,600), repeat_dis(3000,5000),
       sendRouterAdv(false), initialRouterAdvs(0),
       sendEndpointAdv(EPADV_DISABLED), tunnelEndpointAdv(EPADV_DISABLED),
       tunnelEpAdvInterval(300),
+      epAdvCacheGen(0), advBatchSize(DEFAULT_ADV_BATCH_SIZE),
+      advPacingWindow(DEFAULT_ADV_PACING_WINDOW), advPacingInterval(0),
+      pacedEpAdvRound(false),
       agent(agent_), intFlowManager(intFlowManager_),
       portMapper(NULL), switchConnection(NULL),
       ioService(&agent.getAgentIOService()),
@@ -82,6 +88,7 @@ void AdvertManager::start() {
     if (sendEndpointAdv != EPADV_DISABLED) {
         allEndpointAdvTimer.reset(new deadline_timer(*ioService));
         endpointAdvTimer.reset(new deadline_timer(*ioService));
+        advPacingTimer.reset(new deadline_timer(*ioService));
         scheduleInitialEndpointAdv();
     }
 
@@ -97,6 +104,8 @@ void AdvertManager::stop() {
         endpointAdvTimer->cancel();
     if (allEndpointAdvTimer)
         allEndpointAdvTimer->cancel();
+    if (advPacingTimer)
+        advPacingTimer->cancel();
     if(tunnelEpAdvTimer)
         tunnelEpAdvTimer->cancel();
 }
@@ -113,6 +122,18 @@ void AdvertManager::scheduleInitialRouterAdv() {
 
 void AdvertManager::scheduleInitialEndpointAdv(uint64_t delay) {
     lock_guard<recursive_mutex> guard(timer_mutex);
+    pacedEpAdvRound = false;
+    if (allEndpointAdvTimer) {
+        allEndpointAdvTimer->expires_from_now(milliseconds(delay));
+        allEndpointAdvTimer->
+            async_wait(bind(&AdvertManager::onAllEndpointAdvTimer,
+                            this, error));
+    }
+}
+
+void AdvertManager::schedulePeriodicEndpointAdv(uint64_t delay) {
+    lock_guard<recursive_mutex> guard(timer_mutex);
+    pacedEpAdvRound = true;
     if (allEndpointAdvTimer) {
         allEndpointAdvTimer->expires_from_now(milliseconds(delay));
         allEndpointAdvTimer->
@@ -130,6 +151,12 @@ void AdvertManager::doScheduleEpAdv(uint64_t time) {
 }
 
 void AdvertManager::scheduleEndpointAdv(const std::string& uuid) {
+    {
+        lock_guard<mutex> guard(adv_cache_mutex);
+        epAdvCache.erase(uuid);
+        epAdvCacheGen += 1;
+    }
+
     lock_guard<recursive_mutex> timerGuard(timer_mutex);
     if (endpointAdvTimer) {
         unique_lock<mutex> guard(ep_mutex);
@@ -149,13 +176,18 @@ void AdvertManager::scheduleServiceAdv(const std::string& uuid) {
     }
 }
 
-static int send_packet_out(SwitchConnection* conn,
-                           OfpBuf& b,
-                           unordered_set<uint32_t>& out_ports,
-                           IntFlowManager::EncapType encapType =
-                           IntFlowManager::ENCAP_NONE,
-                           uint32_t vnid = 0,
-                           const address& tunDst = address()) {
+void AdvertManager::invalidateEndpointAdvs() {
+    lock_guard<mutex> guard(adv_cache_mutex);
+    epAdvCache.clear();
+    epAdvCacheGen += 1;
+}
+
+static OfpBuf encode_packet_out(int protoVersion,
+                                OfpBuf& b,
+                                unordered_set<uint32_t>& out_ports,
+                                IntFlowManager::EncapType encapType,
+                                uint32_t vnid,
+                                const address& tunDst) {
     struct ofputil_packet_out po{};
     po.buffer_id = UINT32_MAX;
     po.packet = b.data();
@@ -173,12 +205,23 @@ static int send_packet_out(SwitchConnection* conn,
     ab.build(&po);
 
     ofputil_protocol proto = ofputil_protocol_from_ofp_version
-        ((ofp_version)conn->GetProtocolVersion());
+        ((ofp_version)protoVersion);
     assert(ofputil_protocol_is_valid(proto));
     OfpBuf message(ofputil_encode_packet_out(&po, proto));
-    int error = conn->SendMessage(message);
     free(po.ofpacts);
-    return error;
+    return message;
+}
+
+static int send_packet_out(SwitchConnection* conn,
+                           OfpBuf& b,
+                           unordered_set<uint32_t>& out_ports,
+                           IntFlowManager::EncapType encapType =
+                           IntFlowManager::ENCAP_NONE,
+                           uint32_t vnid = 0,
+                           const address& tunDst = address()) {
+    OfpBuf message(encode_packet_out(conn->GetProtocolVersion(), b,
+                                     out_ports, encapType, vnid, tunDst));
+    return conn->SendMessage(message);
 }
 
 void AdvertManager::sendRouterAdvs() {
@@ -191,10 +234,8 @@ void AdvertManager::sendRouterAdvs() {
     polMgr.getGroups(epgURIs);
 
     for (const URI& epg : epgURIs) {
-        unordered_set<string> eps;
         unordered_set<uint32_t> out_ports;
-        epMgr.getEndpointsForGroup(epg, eps);
-        for (const string& uuid : eps) {
+        for (const string& uuid : epMgr.getEndpointsForGroup(epg)) {
             shared_ptr<const Endpoint> ep = epMgr.getEndpoint(uuid);
             if (!ep) continue;
 
@@ -260,23 +301,22 @@ void AdvertManager::onRouterAdvTimer(const boost::system::error_code& ec) {
     }
 }
 
-static void doSendEpAdv(PolicyManager& policyManager,
-                        SwitchConnection* switchConnection,
-                        const string& ip, const uint8_t* epMac,
-                        const uint8_t* routerMac,
-                        const URI& egURI, uint32_t epgVnid,
-                        unordered_set<uint32_t>& out_ports,
-                        AdvertManager::EndpointAdvMode mode,
-                        IntFlowManager::EncapType encapType,
-                        const address& tunDst) {
+static bool parseAdvIP(const string& ip, address& addr) {
     boost::system::error_code ec;
-    address addr = address::from_string(ip, ec);
+    addr = address::from_string(ip, ec);
     if (ec) {
         LOG(ERROR) << "Invalid IP address: " << ip
                    << ": " << ec.message();
-        return;
+        return false;
     }
+    return true;
+}
 
+static OfpBuf composeEpAdv(PolicyManager& policyManager,
+                           const address& addr, const uint8_t* epMac,
+                           const uint8_t* routerMac,
+                           const URI& egURI,
+                           AdvertManager::EndpointAdvMode mode) {
     OfpBuf b((struct ofpbuf*)NULL);
 
     boost::optional<address> routerIp;
@@ -344,6 +384,19 @@ static void doSendEpAdv(PolicyManager& policyManager,
                                                 addrv, allnodes);
         }
     }
+    return b;
+}
+
+static void doSendEpAdv(PolicyManager& policyManager,
+                        SwitchConnection* switchConnection,
+                        const address& ip, const uint8_t* epMac,
+                        const uint8_t* routerMac,
+                        const URI& egURI, uint32_t epgVnid,
+                        unordered_set<uint32_t>& out_ports,
+                        AdvertManager::EndpointAdvMode mode,
+                        IntFlowManager::EncapType encapType,
+                        const address& tunDst) {
+    OfpBuf b(composeEpAdv(policyManager, ip, epMac, routerMac, egURI, mode));
     if (!b.get()) return;
 
     int error = send_packet_out(switchConnection, b, out_ports,
@@ -354,9 +407,30 @@ static void doSendEpAdv(PolicyManager& policyManager,
     }
 }
 
-void AdvertManager::sendEndpointAdvs(const string& uuid) {
-    uint32_t tunPort = intFlowManager.getTunnelPort();
-    if (tunPort == OFPP_NONE) return;
+/*
+ * Compose an endpoint advertisement and append the encoded
+ * packet-out message to the list of messages
+ */
+static void encodeEpAdv(PolicyManager& policyManager, int protoVersion,
+                        const address& ip, const uint8_t* epMac,
+                        const uint8_t* routerMac,
+                        const URI& egURI, uint32_t epgVnid,
+                        unordered_set<uint32_t>& out_ports,
+                        AdvertManager::EndpointAdvMode mode,
+                        IntFlowManager::EncapType encapType,
+                        const address& tunDst,
+                        std::vector<std::vector<uint8_t> >& msgs) {
+    OfpBuf b(composeEpAdv(policyManager, ip, epMac, routerMac, egURI, mode));
+    if (!b.get()) return;
+
+    OfpBuf message(encode_packet_out(protoVersion, b, out_ports,
+                                     encapType, epgVnid, tunDst));
+    const uint8_t* data = (const uint8_t*)message.data();
+    msgs.emplace_back(data, data + message.size());
+}
+
+AdvertManager::ep_adv_template_ptr
+AdvertManager::buildEndpointAdvs(const string& uuid, uint32_t tunPort) {
     unordered_set<uint32_t> out_ports;
     out_ports.insert(tunPort);
 
@@ -364,29 +438,38 @@ void AdvertManager::sendEndpointAdvs(const string& uuid) {
     PolicyManager& polMgr = agent.getPolicyManager();
 
     shared_ptr<const Endpoint> ep = epMgr.getEndpoint(uuid);
-    if (!ep) return;
-    if (!ep->getMAC()) return;
-    if (ep->isDisableAdv()) return;
+    if (!ep) return ep_adv_template_ptr();
+
+    auto advs = std::make_shared<EpAdvTemplate>();
+    advs->tunPort = tunPort;
+    advs->protoVersion = switchConnection->GetProtocolVersion();
+
+    if (!ep->getMAC()) return advs;
+    if (ep->isDisableAdv()) return advs;
 
     optional<URI> epgURI = epMgr.getComputedEPG(uuid);
-    if (!epgURI) return;
+    if (!epgURI) return advs;
     optional<uint32_t> epgVnid = polMgr.getVnidForGroup(epgURI.get());
-    if (!epgVnid) return;
+    if (!epgVnid) return advs;
 
     uint8_t epMac[6];
     ep->getMAC().get().toUIntArray(epMac);
     const uint8_t* routerMac = intFlowManager.getRouterMacAddr();
 
-    for (const string& ip : ep->getIPs()) {
-        LOG(DEBUG) << "Sending endpoint advertisement for "
+    for (const network::ip_prefix& prefix : ep->getIPPrefixes()) {
+        // only host addresses are advertised
+        const network::ip_addr& ip = prefix.address();
+        if (prefix.length() != (ip.is_v4() ? 32 : 128))
+            continue;
+        LOG(DEBUG) << "Building endpoint advertisement for "
                    << ep->getMAC().get() << " " << ip;
 
-        doSendEpAdv(polMgr, switchConnection,
-                    ip, epMac, routerMac, epgURI.get(), epgVnid.get(),
-                    out_ports, sendEndpointAdv,
+        encodeEpAdv(polMgr, advs->protoVersion,
+                    ip.to_address(), epMac, routerMac, epgURI.get(),
+                    epgVnid.get(), out_ports, sendEndpointAdv,
                     intFlowManager.getEncapType(),
-                    intFlowManager.getEPGTunnelDst(epgURI.get()));
-
+                    intFlowManager.getEPGTunnelDst(epgURI.get()),
+                    advs->msgs);
     }
 
     for (const Endpoint::IPAddressMapping& ipm : ep->getIPAddressMappings()) {
@@ -400,19 +483,67 @@ void AdvertManager::sendEndpointAdvs(const string& uuid) {
             polMgr.getVnidForGroup(ipm.getEgURI().get());
         if (!ipmVnid) continue;
 
-        LOG(DEBUG) << "Sending endpoint advertisement for "
-                   << ep->getMAC().get() << " " << ipm.getFloatingIP().get();
+        address floatingIp;
+        if (!parseAdvIP(ipm.getFloatingIP().get(), floatingIp))
+            continue;
+
+        LOG(DEBUG) << "Building endpoint advertisement for "
+                   << ep->getMAC().get() << " " << floatingIp;
 
-        doSendEpAdv(polMgr, switchConnection,
-                    ipm.getFloatingIP().get(), epMac,
+        encodeEpAdv(polMgr, advs->protoVersion,
+                    floatingIp, epMac,
                     routerMac, ipm.getEgURI().get(),
                     ipmVnid.get(), out_ports, sendEndpointAdv,
                     intFlowManager.getEncapType(),
-                    intFlowManager.getEPGTunnelDst(ipm.getEgURI().get()));
+                    intFlowManager.getEPGTunnelDst(ipm.getEgURI().get()),
+                    advs->msgs);
+    }
+
+    return advs;
+}
+
+void AdvertManager::sendEndpointAdvs(const string& uuid) {
+    uint32_t tunPort = intFlowManager.getTunnelPort();
+    if (tunPort == OFPP_NONE) return;
+
+    ep_adv_template_ptr advs;
+    uint64_t gen;
+    {
+        lock_guard<mutex> guard(adv_cache_mutex);
+        auto it = epAdvCache.find(uuid);
+        if (it != epAdvCache.end() &&
+            it->second->tunPort == tunPort &&
+            it->second->protoVersion ==
+            switchConnection->GetProtocolVersion())
+            advs = it->second;
+        gen = epAdvCacheGen;
+    }
+    if (!advs) {
+        advs = buildEndpointAdvs(uuid, tunPort);
+        if (!advs) return;
+
+        // don't cache advertisements built from an endpoint that was
+        // updated while they were being built
+        lock_guard<mutex> guard(adv_cache_mutex);
+        if (gen == epAdvCacheGen)
+            epAdvCache[uuid] = advs;
+    }
+
+    if (advs->msgs.empty()) return;
+    LOG(DEBUG) << "Sending " << advs->msgs.size()
+               << " endpoint advertisements for " << uuid;
+
+    for (const std::vector<uint8_t>& msg : advs->msgs) {
+        OfpBuf message(ofpbuf_clone_data(msg.data(), msg.size()));
+        int error = switchConnection->SendMessage(message);
+        if (error) {
+            LOG(ERROR) << "Could not write packet-out: "
+                       << ovs_strerror(error);
+        }
     }
 }
 
-void AdvertManager::sendAllEndpointAdvs() {
+void AdvertManager::sendAllEndpointAdvs(bool paced) {
     LOG(DEBUG) << "Sending all endpoint advertisements";
 
     EndpointManager& epMgr = agent.getEndpointManager();
@@ -420,11 +551,62 @@ void AdvertManager::sendAllEndpointAdvs() {
 
     PolicyManager::uri_set_t epgURIs;
     polMgr.getGroups(epgURIs);
+    std::deque<string> allEps;
     for (const URI& epg : epgURIs) {
-        unordered_set<string> eps;
-        epMgr.getEndpointsForGroup(epg, eps);
-        for (const string& uuid : eps) {
-            sendEndpointAdvs(uuid);
+        EndpointUUIDView eps = epMgr.getEndpointsForGroup(epg);
+        allEps.insert(allEps.end(), eps.begin(), eps.end());
+    }
+
+    // Spread the batches evenly across the pacing window.  Any
+    // endpoints left over from a previous round are replaced.
+    {
+        lock_guard<mutex> guard(ep_mutex);
+        if (paced) {
+            size_t batches = (allEps.size() + advBatchSize - 1) / advBatchSize;
+            advPacingInterval = batches > 1 ? advPacingWindow / batches : 0;
+            pendingAllEps.swap(allEps);
+        } else {
+            pendingAllEps.clear();
+        }
+    }
+    if (paced) {
+        onAdvPacingTimer(boost::system::error_code());
+        return;
+    }
+
+    // The initial round goes out at once so that no endpoint waits
+    // for the pacing window after a restart or reconnect
+    for (const string& uuid : allEps) {
+        sendEndpointAdvs(uuid);
+    }
+}
+
+void AdvertManager::onAdvPacingTimer(const boost::system::error_code& ec) {
+    if (ec || stopping)
+        return;
+
+    std::vector<string> batch;
+    bool more;
+    {
+        lock_guard<mutex> guard(ep_mutex);
+        while (!pendingAllEps.empty() && batch.size() < advBatchSize) {
+            batch.push_back(std::move(pendingAllEps.front()));
+            pendingAllEps.pop_front();
+        }
+        more = !pendingAllEps.empty();
+    }
+
+    for (const string& uuid : batch) {
+        sendEndpointAdvs(uuid);
+    }
+
+    if (more) {
+        lock_guard<recursive_mutex> guard(timer_mutex);
+        if (advPacingTimer) {
+            advPacingTimer->expires_from_now(milliseconds(advPacingInterval));
+            advPacingTimer->
+                async_wait(bind(&AdvertManager::onAdvPacingTimer,
+                                this, error));
         }
     }
 }
@@ -500,15 +682,18 @@ void AdvertManager::onAllEndpointAdvTimer(const boost::system::error_code& ec) {
     if (!portMapper)
         return;
 
+    lock_guard<recursive_mutex> guard(timer_mutex);
     if (switchConnection->IsConnected()) {
         agent.getAgentIOService()
-            .dispatch(bind(&AdvertManager::sendAllEndpointAdvs, this));
+            .dispatch(bind(&AdvertManager::sendAllEndpointAdvs, this,
+                           pacedEpAdvRound));
         agent.getAgentIOService()
             .dispatch(bind(&AdvertManager::sendAllServiceAdvs, this));
+        // rounds after the first one are paced
+        pacedEpAdvRound = true;
     }
 
     if (!stopping) {
-        lock_guard<recursive_mutex> guard(timer_mutex);
         allEndpointAdvTimer->expires_from_now(seconds(all_ep_dis(urng)));
         allEndpointAdvTimer->
             async_wait(bind(&AdvertManager::onAllEndpointAdvTimer,
@@ -547,7 +732,11 @@ void AdvertManager::sendServiceAdvs(const string& uuid) {
                << svc->getInterfaceName().get()
                << " (vlan " << unsigned(vnid) << ")";
 
-    doSendEpAdv(polMgr, switchConnection, svc->getIfaceIP().get(),
+    address ifaceIp;
+    if (!parseAdvIP(svc->getIfaceIP().get(), ifaceIp))
+        return;
+
+    doSendEpAdv(polMgr, switchConnection, ifaceIp,
                 svcMac, routerMac, URI::ROOT, vnid,
                 out_ports, sendEndpointAdv, encapType, address());
 }
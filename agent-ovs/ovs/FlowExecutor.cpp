@@ -208,7 +208,13 @@ FlowExecutor::DoExecuteNoBlock(const T& fe,
         }
         LOG(DEBUG) << "[" << swConn->getSwitchName() << "] "
                    << "Executing xid=" << ntohl(xid) << ", " << e;
-        int error = swConn->SendMessage(msg);
+        // the message is only queued here; a failure to write it
+        // fails the barrier request
+        int error = barrXid
+            ? swConn->SendMessage(msg, [this, barrXid](int err) {
+                    SendDone(barrXid.get(), err, false);
+                })
+            : swConn->SendMessage(msg);
         if (error) {
             LOG(ERROR) << "[" << swConn->getSwitchName() << "] "
                        << "Error sending flow mod message: "
@@ -224,7 +230,9 @@ FlowExecutor::WaitOnBarrier(OfpBuf& barrReq) {
     ovs_be32 barrXid = ((ofp_header *)barrReq.data())->xid;
     LOG(DEBUG) << "[" << swConn->getSwitchName() << "] "
                << "Sending barrier request xid=" << barrXid;
-    int err = swConn->SendMessage(barrReq);
+    int err = swConn->SendMessage(barrReq, [this, barrXid](int err) {
+            SendDone(barrXid, err, true);
+        });
     if (err) {
         LOG(ERROR) << "[" << swConn->getSwitchName() << "] "
                    << "Error sending barrier request: "
@@ -245,6 +253,24 @@ FlowExecutor::WaitOnBarrier(OfpBuf& barrReq) {
     return reqStatus;
 }
 
+void
+FlowExecutor::SendDone(uint32_t barrXid, int err, bool barrier) {
+    if (err == 0)
+        return;
+    mutex_guard lock(reqMtx);
+    RequestMap::iterator itr = requests.find(barrXid);
+    if (itr == requests.end())
+        return;
+    RequestState& req = itr->second;
+    if (req.status == 0)
+        req.status = err;
+    // no reply will come for a barrier that was never written
+    if (barrier) {
+        req.done = true;
+        reqCondVar.notify_all();
+    }
+}
+
 void
 FlowExecutor::Handle(SwitchConnection *,
                      int msgType,
@@ -10,6 +10,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
+#include <algorithm>
+#include <tuple>
 #include <boost/system/error_code.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
@@ -50,6 +52,7 @@
 #include "FlowConstants.h"
 #include "FlowBuilder.h"
 #include "RangeMask.h"
+#include "MaglevTable.h"
 
 #include "arp.h"
 #include "eth.h"
@@ -152,7 +155,9 @@ IntFlowManager::IntFlowManager(Agent& agent_,
     floodScope(FLOOD_DOMAIN), tunnelPortStr("4789"),
     virtualRouterEnabled(false), routerAdv(false),
     virtualDHCPEnabled(false), conntrackEnabled(false), dropLogRemotePort(0),
-    serviceStatsFlowDisabled(false),
+    serviceStatsFlowDisabled(false), podSvcSampleProbability(0),
+    podSvcSampleCollectorSetId(0), maglevTableSize(0),
+    incrementalEpFlows(true),
     advertManager(agent, *this), isSyncing(false), stopping(false) {
     // set up flow tables
     switchManager.setMaxFlowTables(NUM_FLOW_TABLES);
@@ -284,6 +289,24 @@ void IntFlowManager::setDropLog(const string& dropLogPort, const string& dropLog
     dropLogRemotePort = _dropLogRemotePort;
 }
 
+void IntFlowManager::setPodSvcSampling(uint16_t probability,
+                                       uint32_t collectorSetId) {
+    podSvcSampleProbability = probability;
+    podSvcSampleCollectorSetId = collectorSetId;
+}
+
+void IntFlowManager::setMaglevTableSize(uint32_t tableSize) {
+    // the slot is selected with a multipath action, which supports
+    // at most 65536 links
+    maglevTableSize = tableSize
+        ? MaglevTable::nextPrime(std::min<uint32_t>(tableSize, 65521))
+        : 0;
+}
+
+void IntFlowManager::setIncrementalEndpointFlows(bool enabled) {
+    incrementalEpFlows = enabled;
+}
+
 void IntFlowManager::setVirtualRouter(bool virtualRouterEnabled,
                                       bool routerAdv,
                                       const string& virtualRouterMac) {
@@ -315,6 +338,11 @@ void IntFlowManager::setEndpointAdv(AdvertManager::EndpointAdvMode mode,
     advertManager.enableTunnelEndpointAdv(tunnelMode, tunnelAdvIntvl);
 }
 
+void IntFlowManager::setEndpointAdvPacing(size_t batchSize,
+                                          uint64_t window) {
+    advertManager.setEndpointAdvPacing(batchSize, window);
+}
+
 void IntFlowManager::setMulticastGroupFile(const std::string& mcastGroupFile) {
     this->mcastGroupFile = mcastGroupFile;
 }
@@ -350,8 +378,15 @@ void IntFlowManager::endpointUpdated(const std::string& uuid) {
         advertManager.scheduleTunnelEpAdv(uuid);
         return;
     }
-    advertManager.scheduleEndpointAdv(uuid);
-    taskQueue.dispatch(uuid, [=]() { handleEndpointUpdate(uuid); });
+    taskQueue.dispatch(uuid, [=]() {
+            handleEndpointUpdate(uuid);
+            // advertise the endpoint once its flows are in the
+            // switch, rather than while they wait in a batch
+            switchManager.onFlowsWritten([this, uuid](bool success) {
+                    if (success)
+                        advertManager.scheduleEndpointAdv(uuid);
+                });
+        });
 }
 
 void IntFlowManager::localExternalDomainUpdated(const opflex::modb::URI& egURI) {
@@ -361,15 +396,27 @@ void IntFlowManager::localExternalDomainUpdated(const opflex::modb::URI& egURI)
 
 void IntFlowManager::remoteEndpointUpdated(const string& uuid) {
     if (stopping) return;
-    taskQueue.dispatch(uuid,
-                       [=](){ handleRemoteEndpointUpdate(uuid); });
+    {
+        std::lock_guard<std::mutex> guard(remoteEpMutex);
+        pendingRemoteEps.insert(uuid);
+    }
+    // updates that arrive before the batch task runs join its batch
+    taskQueue.dispatch("remote-ep-batch",
+                       [=](){ handleRemoteEndpointBatch(); });
 }
 
 void IntFlowManager::serviceUpdated(const std::string& uuid) {
     if (stopping) return;
 
-    advertManager.scheduleServiceAdv(uuid);
-    taskQueue.dispatch(uuid, [=]() { handleServiceUpdate(uuid); });
+    taskQueue.dispatch(uuid, [=]() {
+            handleServiceUpdate(uuid);
+            // as for endpoints, advertise the service once its flows
+            // are in the switch
+            switchManager.onFlowsWritten([this, uuid](bool success) {
+                    if (success)
+                        advertManager.scheduleServiceAdv(uuid);
+                });
+        });
 }
 
 void IntFlowManager::rdConfigUpdated(const opflex::modb::URI& rdURI) {
@@ -485,6 +532,8 @@ void IntFlowManager::lbVlanUpdated(LearningBridgeIface::vlan_range_t vlan) {
 void IntFlowManager::egDomainUpdated(const opflex::modb::URI& egURI) {
     if (stopping) return;
 
+    advertManager.invalidateEndpointAdvs();
+
     taskQueue.dispatch(egURI.toString(),
                        [=]() { handleEndpointGroupDomainUpdate(egURI); });
 }
@@ -492,6 +541,8 @@ void IntFlowManager::egDomainUpdated(const opflex::modb::URI& egURI) {
 void IntFlowManager::domainUpdated(class_id_t cid, const URI& domURI) {
     if (stopping) return;
 
+    advertManager.invalidateEndpointAdvs();
+
     taskQueue.dispatch(domURI.toString(),
                        [=]() { handleDomainUpdate(cid, domURI); });
 }
@@ -525,6 +576,7 @@ void IntFlowManager::configUpdated(const opflex::modb::URI& configURI) {
         }
     }
     switchManager.enableSync();
+    advertManager.invalidateEndpointAdvs();
     agent.getAgentIOService()
         .dispatch([=]() { handleConfigUpdate(configURI); });
 }
@@ -551,7 +603,8 @@ void IntFlowManager::peerStatusUpdated(const std::string&, int,
     }
 }
 
-bool IntFlowManager::getGroupForwardingInfo(const URI& epgURI, uint32_t& vnid,
+bool IntFlowManager::getGroupForwardingInfo(const PolicyManager::Snapshot& policy,
+                                            const URI& epgURI, uint32_t& vnid,
                                             optional<URI>& rdURI,
                                             uint32_t& rdId,
                                             optional<URI>& bdURI,
@@ -581,16 +634,18 @@ bool IntFlowManager::getGroupForwardingInfo(const URI& epgURI, uint32_t& vnid,
 
         rdId = 0;
     } else {
-        PolicyManager& polMgr = agent.getPolicyManager();
-        optional<uint32_t> epgVnid = polMgr.getVnidForGroup(epgURI);
-        if (!epgVnid) {
+        shared_ptr<const PolicyManager::Snapshot::GroupInfo> group =
+            policy.getGroup(epgURI);
+        if (!group || !group->vnid) {
             return false;
         }
-        vnid = epgVnid.get();
+        vnid = group->vnid.get();
 
-        optional<shared_ptr<RoutingDomain> > epgRd = polMgr.getRDForGroup(epgURI);
-        optional<shared_ptr<BridgeDomain> > epgBd = polMgr.getBDForGroup(epgURI);
-        optional<shared_ptr<FloodDomain> > epgFd = polMgr.getFDForGroup(epgURI);
+        const optional<shared_ptr<RoutingDomain> >& epgRd =
+            group->routingDomain;
+        const optional<shared_ptr<BridgeDomain> >& epgBd =
+            group->bridgeDomain;
+        const optional<shared_ptr<FloodDomain> >& epgFd = group->floodDomain;
         if (!epgRd && !epgBd && !epgFd) {
             return false;
         }
@@ -945,7 +1000,7 @@ static void flowsIpm(IntFlowManager& flowMgr,
                      uint32_t bdId, uint32_t fgrpId,
                      uint32_t fepgVnid, uint32_t frdId,
                      uint32_t fbdId, uint32_t ffdId,
-                     address& mappedIp, address& floatingIp,
+                     const address& mappedIp, const address& floatingIp,
                      uint32_t nextHopPort, const uint8_t* nextHopMac) {
     const uint8_t* effNextHopMac =
         nextHopMac ? nextHopMac : flowMgr.getRouterMacAddr();
@@ -1298,15 +1353,9 @@ static void flowsEndpointSource(FlowEntryList& elSrc,
         actionSource(l2Classify, epgVnid, bdId, fgrpId, rdId)
             .build(elSrc);
 
-        for (const string& ipStr : endPoint.getIPs()) {
-            network::cidr_t cidr;
-            if (!network::cidr_from_string(ipStr, cidr, false)) {
-                LOG(WARNING) << "Invalid endpoint IP: "
-                             << ipStr;
-                continue;
-            }
+        for (const network::ip_prefix& ip : endPoint.getIPPrefixes()) {
             actionSource(FlowBuilder().priority(140)
-                         .ipSrc(cidr.first, cidr.second)
+                         .ipSrc(ip.address().to_address(), ip.length())
                          .inPort(ofPort).ethSrc(macAddr),
                          epgVnid, bdId, fgrpId, rdId)
                 .build(elSrc);
@@ -1415,32 +1464,95 @@ bool getHostAccess(EndpointManager& epMgr,
     return false;
 }
 
-void IntFlowManager::handleRemoteEndpointUpdate(const string& uuid) {
-    LOG(DEBUG) << "Updating remote endpoint " << uuid;
+void IntFlowManager::handleRemoteEndpointBatch() {
+    unordered_set<string> uuids;
+    {
+        std::lock_guard<std::mutex> guard(remoteEpMutex);
+        uuids.swap(pendingRemoteEps);
+    }
+    if (uuids.empty()) return;
 
-    optional<shared_ptr<modelgbp::inv::RemoteInventoryEp>> ep =
-        modelgbp::inv::RemoteInventoryEp::resolve(agent.getFramework(), uuid);
+    LOG(DEBUG) << "Updating " << uuids.size() << " remote endpoints";
 
-    if (!ep || (encapType == ENCAP_VLAN || encapType == ENCAP_NONE)) {
-        switchManager.clearFlows(uuid, BRIDGE_TABLE_ID);
-        switchManager.clearFlows(uuid, ROUTE_TABLE_ID);
-        switchManager.clearFlows(uuid, SRC_TABLE_ID);
-        return;
+    typedef shared_ptr<modelgbp::inv::RemoteInventoryEp> rep_ptr;
+    SwitchManager::obj_flows_t srcFlows;
+    SwitchManager::obj_flows_t bridgeFlows;
+    SwitchManager::obj_flows_t routeFlows;
+    auto addFlowLists = [&](const string& uuid) {
+        srcFlows.emplace_back(uuid, FlowEntryList());
+        bridgeFlows.emplace_back(uuid, FlowEntryList());
+        routeFlows.emplace_back(uuid, FlowEntryList());
+    };
+
+    // Group the endpoints by endpoint group, since the endpoints of a
+    // group share its forwarding state.  Endpoints that are gone or
+    // have no group get empty flow lists, which clears their flows.
+    unordered_map<URI, vector<pair<string, rep_ptr>>> groupEps;
+    bool clearOnly = (encapType == ENCAP_VLAN || encapType == ENCAP_NONE);
+    for (const string& uuid : uuids) {
+        optional<rep_ptr> ep;
+        if (!clearOnly)
+            ep = modelgbp::inv::RemoteInventoryEp::
+                resolve(agent.getFramework(), uuid);
+        optional<URI> epgURI;
+        if (ep) {
+            auto epgRef = ep.get()->resolveInvRemoteInventoryEpToGroupRSrc();
+            if (epgRef)
+                epgURI = epgRef.get()->getTargetURI();
+        }
+        if (epgURI)
+            groupEps[epgURI.get()].emplace_back(uuid, ep.get());
+        else
+            addFlowLists(uuid);
+    }
+
+    if (!groupEps.empty()) {
+        PolicyManager::snapshot_ptr policy =
+            agent.getPolicyManager().getSnapshot();
+        RemoteEpGroupCtx ctx;
+        ctx.hostPort = OFPP_NONE;
+        for (const auto& group : groupEps) {
+            optional<URI> fgrpURI, bdURI, rdURI;
+            ctx.epgVnid = ctx.rdId = ctx.bdId = ctx.fgrpId = 0;
+            bool hasForwardingInfo =
+                getGroupForwardingInfo(*policy, group.first, ctx.epgVnid,
+                                       rdURI, ctx.rdId, bdURI, ctx.bdId,
+                                       fgrpURI, ctx.fgrpId);
+            for (const auto& ep : group.second) {
+                addFlowLists(ep.first);
+                if (hasForwardingInfo)
+                    addRemoteEndpointFlows(*ep.second, ctx,
+                                           srcFlows.back().second,
+                                           bridgeFlows.back().second,
+                                           routeFlows.back().second);
+            }
+        }
     }
 
+    switchManager.writeFlows(SRC_TABLE_ID, srcFlows);
+    switchManager.writeFlows(BRIDGE_TABLE_ID, bridgeFlows);
+    switchManager.writeFlows(ROUTE_TABLE_ID, routeFlows);
+}
+
+void IntFlowManager::
+addRemoteEndpointFlows(modelgbp::inv::RemoteInventoryEp& ep,
+                       RemoteEpGroupCtx& ctx,
+                       FlowEntryList& elSrc,
+                       FlowEntryList& elBridgeDst,
+                       FlowEntryList& elRouteDst) {
     // Get remote endpoint MAC
     uint8_t macAddr[6];
-    bool hasMac = ep.get()->isMacSet();
+    bool hasMac = ep.isMacSet();
     if (hasMac)
-        ep.get()->getMac().get().toUIntArray(macAddr);
+        ep.getMac().get().toUIntArray(macAddr);
 
     boost::system::error_code ec;
 
     // Get remote tunnel destination
     optional<address> tunDst;
     bool hasTunDest = false;
-    if (ep.get()->isNextHopTunnelSet()) {
-        string ipStr = ep.get()->getNextHopTunnel().get();
+    if (ep.isNextHopTunnelSet()) {
+        string ipStr = ep.getNextHopTunnel().get();
         tunDst = address::from_string(ipStr, ec);
         if (ec || !tunDst->is_v4()) {
             LOG(WARNING) << "Invalid remote tunnel destination IP: "
@@ -1450,148 +1562,132 @@ void IntFlowManager::handleRemoteEndpointUpdate(const string& uuid) {
         }
     }
 
-    uint32_t epgVnid = 0, rdId = 0, bdId = 0, fgrpId = 0;
-    optional<URI> epgURI, fgrpURI, bdURI, rdURI;
-    auto epgRef = ep.get()->resolveInvRemoteInventoryEpToGroupRSrc();
-    if (epgRef) {
-        epgURI = epgRef.get()->getTargetURI();
+    const uint32_t epgVnid = ctx.epgVnid;
+    const uint32_t rdId = ctx.rdId;
+    const uint32_t bdId = ctx.bdId;
+    const uint32_t fgrpId = ctx.fgrpId;
+
+    FlowBuilder bridgeFlow;
+    uint32_t outReg = 0;
+    uint64_t meta;
+
+    if (hasTunDest) {
+        outReg = tunDst->to_v4().to_ulong();
+        meta = flow::meta::out::REMOTE_TUNNEL;
+    } else {
+        meta = flow::meta::out::HOST_ACCESS;
+        // the host access port is the same for every endpoint in
+        // the batch
+        if (!ctx.hostAccessChecked) {
+            ctx.hasHostMac = getHostAccess(agent.getEndpointManager(),
+                                           switchManager, ctx.hostPort,
+                                           ctx.hostMac);
+            ctx.hostAccessChecked = true;
+        }
     }
 
-    bool hasForwardingInfo = false;
-    if (epgURI && getGroupForwardingInfo(epgURI.get(), epgVnid, rdURI,
-                                         rdId, bdURI, bdId, fgrpURI, fgrpId)) {
-        hasForwardingInfo = true;
+    if (hasMac) {
+        matchDestDom(bridgeFlow, bdId, 0)
+            .priority(10)
+            .ethDst(macAddr)
+            .action()
+            .reg(MFF_REG2, epgVnid)
+            .reg(MFF_REG7, outReg)
+            .metadata(meta, flow::meta::out::MASK)
+            .go(POL_TABLE_ID)
+            .parent().build(elBridgeDst);
     }
 
-    FlowEntryList elBridgeDst;
-    FlowEntryList elRouteDst;
-    FlowEntryList elSrc;
+    // Get remote endpoint IP addresses
     std::vector<std::shared_ptr<modelgbp::inv::RemoteIp>> invIps;
+    ep.resolveInvRemoteIp(invIps);
+    for (const auto& invIp : invIps) {
+        if (!invIp->isIpSet()) continue;
 
-    if (hasForwardingInfo) {
-        FlowBuilder bridgeFlow;
-        uint32_t outReg = 0;
-        uint64_t meta;
-        uint32_t hostPort = OFPP_NONE;
-        bool hasHostMac = false;
-        uint8_t hostMac[6];
+        address addr = address::from_string(invIp->getIp().get(), ec);
+        if (ec) {
+            LOG(WARNING) << "Invalid remote endpoint IP: "
+                         << invIp->getIp().get() << ": " << ec.message();
+            continue;
+        }
 
-        if (hasTunDest) {
-            outReg = tunDst->to_v4().to_ulong();
-            meta = flow::meta::out::REMOTE_TUNNEL;
+        uint8_t prefix;
+        if (invIp->isPrefixLenSet()) {
+            prefix = invIp->getPrefixLen().get();
         } else {
-            meta = flow::meta::out::HOST_ACCESS;
-            hasHostMac = getHostAccess(agent.getEndpointManager(),
-                                       switchManager, hostPort, hostMac);
+            if (addr.is_v4())
+                prefix = 32;
+            else
+                prefix = 128;
         }
 
-        if (hasMac) {
-            matchDestDom(bridgeFlow, bdId, 0)
-                .priority(10)
-                .ethDst(macAddr)
+        FlowBuilder routeFlow;
+        FlowBuilder proxyArp;
+        if (hasTunDest) {
+            matchDestDom(routeFlow, 0, rdId)
+                .priority(500)
+                .ethDst(getRouterMacAddr())
+                .ipDst(addr, prefix)
                 .action()
                 .reg(MFF_REG2, epgVnid)
                 .reg(MFF_REG7, outReg)
                 .metadata(meta, flow::meta::out::MASK)
                 .go(POL_TABLE_ID)
-                .parent().build(elBridgeDst);
-        }
-
-
-        // Get remote endpoint IP addresses
-        ep.get()->resolveInvRemoteIp(invIps);
-        for (const auto& invIp : invIps) {
-            if (!invIp->isIpSet()) continue;
-
-            address addr = address::from_string(invIp->getIp().get(), ec);
-            if (ec) {
-                LOG(WARNING) << "Invalid remote endpoint IP: "
-                             << invIp->getIp().get() << ": " << ec.message();
-                continue;
-            }
-
-            uint8_t prefix;
-            if (invIp->isPrefixLenSet()) {
-                prefix = invIp->getPrefixLen().get();
-            } else {
-                if (addr.is_v4())
-                    prefix = 32;
-                else
-                    prefix = 128;
+                .parent().build(elRouteDst);
+        } else {
+            /*
+             * ingress (=> pod) uses veth_host mac and inPort
+             * but epg from the subnet. A priority 140 rule
+             * for veth_host subnets overrides these rules
+             * in the source table. So the SEPG will either
+             * be EPG of veth_host for its subnets or EPG
+             * of ext policy for ext policy subnets programmed
+             * here. These flows only depend on veth_host
+             * endpoint file which should always be there in
+             * the cloud case.
+             */
+            if (ctx.hasHostMac && ctx.hostPort != OFPP_NONE) {
+                actionSource(FlowBuilder().priority(10 + prefix)
+                             .ipSrc(addr, prefix)
+                             .inPort(ctx.hostPort).ethSrc(ctx.hostMac),
+                             epgVnid, bdId, fgrpId, rdId)
+                     .build(elSrc);
             }
+            // egress (<= pod)
+            routeFlow
+                .priority(10 + prefix)
+                .ethType(eth::type::IP)
+                .reg(6, rdId)
+                .ethDst(getRouterMacAddr())
+                .ipDst(addr, prefix)
+                .action()
+                .reg(MFF_REG2, epgVnid)
+                .metadata(meta, flow::meta::out::MASK)
+                .go(POL_TABLE_ID)
+                .parent().build(elRouteDst);
+        }
 
-            FlowBuilder routeFlow;
-            FlowBuilder proxyArp;
-            if (hasTunDest) {
-                matchDestDom(routeFlow, 0, rdId)
-                    .priority(500)
-                    .ethDst(getRouterMacAddr())
-                    .ipDst(addr, prefix)
-                    .action()
-                    .reg(MFF_REG2, epgVnid)
-                    .reg(MFF_REG7, outReg)
-                    .metadata(meta, flow::meta::out::MASK)
-                    .go(POL_TABLE_ID)
-                    .parent().build(elRouteDst);
-            } else {
-                /*
-                 * ingress (=> pod) uses veth_host mac and inPort
-                 * but epg from the subnet. A priority 140 rule
-                 * for veth_host subnets overrides these rules
-                 * in the source table. So the SEPG will either
-                 * be EPG of veth_host for its subnets or EPG
-                 * of ext policy for ext policy subnets programmed
-                 * here. These flows only depend on veth_host
-                 * endpoint file which should always be there in
-                 * the cloud case.
-                 */
-                if (hasHostMac && hostPort != OFPP_NONE) {
-                    actionSource(FlowBuilder().priority(10 + prefix)
-                                 .ipSrc(addr, prefix)
-                                 .inPort(hostPort).ethSrc(hostMac),
-                                 epgVnid, bdId, fgrpId, rdId)
-                         .build(elSrc);
-                }
-                // egress (<= pod)
-                routeFlow
-                    .priority(10 + prefix)
-                    .ethType(eth::type::IP)
-                    .reg(6, rdId)
-                    .ethDst(getRouterMacAddr())
-                    .ipDst(addr, prefix)
-                    .action()
-                    .reg(MFF_REG2, epgVnid)
-                    .metadata(meta, flow::meta::out::MASK)
-                    .go(POL_TABLE_ID)
-                    .parent().build(elRouteDst);
+        if (addr.is_v4()) {
+            if (hasMac && prefix == 32) {
+                // Resolve inter-node arp without going to leaf
+                matchDestArp(proxyArp.priority(40), addr, bdId, rdId);
+                actionArpReply(proxyArp, macAddr, addr)
+                    .build(elBridgeDst);
             }
-
-            if (addr.is_v4()) {
-                if (hasMac && prefix == 32) {
-                    // Resolve inter-node arp without going to leaf
-                    matchDestArp(proxyArp.priority(40), addr, bdId, rdId);
-                    actionArpReply(proxyArp, macAddr, addr)
-                        .build(elBridgeDst);
-                }
-                if (invIp->isNextHopIPSet() && invIp->isNextHopMacSet()) {
-                    uint8_t nextHopMac[6];
-                    address nextHopIP =
-                        address::from_string(invIp->getNextHopIP().get(), ec);
-                    if (ec) continue;
-                    invIp->getNextHopMac().get().toUIntArray(nextHopMac);
-                    // Resolve arp to CSR Gateway
-                    matchDestArp(proxyArp.priority(40), addr, bdId, rdId,
-                                 prefix);
-                    actionArpReply(proxyArp, nextHopMac, nextHopIP)
-                        .build(elBridgeDst);
-                }
+            if (invIp->isNextHopIPSet() && invIp->isNextHopMacSet()) {
+                uint8_t nextHopMac[6];
+                address nextHopIP =
+                    address::from_string(invIp->getNextHopIP().get(), ec);
+                if (ec) continue;
+                invIp->getNextHopMac().get().toUIntArray(nextHopMac);
+                // Resolve arp to CSR Gateway
+                matchDestArp(proxyArp.priority(40), addr, bdId, rdId,
+                             prefix);
+                actionArpReply(proxyArp, nextHopMac, nextHopIP)
+                    .build(elBridgeDst);
             }
         }
     }
-
-    switchManager.writeFlow(uuid, SRC_TABLE_ID, elSrc);
-    switchManager.writeFlow(uuid, BRIDGE_TABLE_ID, elBridgeDst);
-    switchManager.writeFlow(uuid, ROUTE_TABLE_ID, elRouteDst);
 }
 
 static void flowsEndpointPortRangeSNAT(const Snat& as,
@@ -1651,13 +1747,8 @@ static void flowsEndpointSNAT(SnatManager& snatMgr,
     address nwDst;
     uint8_t prefixlen = 0;
 
-    for (const string& ipStr : endPoint.getIPs()) {
-        network::cidr_t cidr;
-        if (!network::cidr_from_string(ipStr, cidr, false)) {
-            LOG(WARNING) << "Invalid endpoint IP: "
-                         << ipStr << ": " << ec.message();
-            continue;
-        }
+    for (const network::ip_prefix& ip : endPoint.getIPPrefixes()) {
+        network::cidr_t cidr = ip.to_cidr();
 
         // Program route table flow to forward to snat table
         for (auto it = as.getDest().begin(); it != as.getDest().end(); ++it) {
@@ -1720,6 +1811,65 @@ static void flowsEndpointSNAT(SnatManager& snatMgr,
     }
 }
 
+bool IntFlowManager::EndpointFlowInputs::IpMapping::
+operator==(const IpMapping& o) const {
+    return std::tie(mappedIp, floatingIp, epgVnid, rdId, bdId, fdId,
+                    nextHopPort, nextHopMac) ==
+        std::tie(o.mappedIp, o.floatingIp, o.epgVnid, o.rdId, o.bdId, o.fdId,
+                 o.nextHopPort, o.nextHopMac);
+}
+
+bool IntFlowManager::EndpointFlowInputs::SnatIp::
+operator==(const SnatIp& o) const {
+    // the SNAT manager replaces the object on every update
+    return snat == o.snat && port == o.port && zoneId == o.zoneId;
+}
+
+uint32_t IntFlowManager::EndpointFlowInputs::
+getChanges(const EndpointFlowInputs& p) const {
+    if (std::tie(ofPort, tunnelPort, epgVnid, rdId, bdId, fgrpId,
+                 hasForwardingInfo, arpMode, ndMode, unkFloodMode,
+                 bcastFloodMode, routingMode, encapType,
+                 virtualRouterEnabled, virtualDHCPEnabled,
+                 routerMac, dhcpMac, mac, ips, external) !=
+        std::tie(p.ofPort, p.tunnelPort, p.epgVnid, p.rdId, p.bdId, p.fgrpId,
+                 p.hasForwardingInfo, p.arpMode, p.ndMode, p.unkFloodMode,
+                 p.bcastFloodMode, p.routingMode, p.encapType,
+                 p.virtualRouterEnabled, p.virtualDHCPEnabled,
+                 p.routerMac, p.dhcpMac, p.mac, p.ips, p.external))
+        return FLOWS_ALL;
+
+    uint32_t changes = 0;
+    if (promiscuousMode != p.promiscuousMode)
+        changes |= FLOWS_SEC;
+    if (natMode != p.natMode)
+        changes |= FLOWS_SRC;
+    if (discoveryProxyMode != p.discoveryProxyMode)
+        changes |= FLOWS_BRIDGE;
+    // virtual IPs are allowed by port security, get virtual DHCP
+    // flows and are routed in active-active mode
+    if (aapModeAA != p.aapModeAA || virtualIps != p.virtualIps)
+        changes |= FLOWS_SEC | FLOWS_ROUTE;
+    if (std::tie(dhcpv4, dhcpv6, dhcpv4ServerIp, dhcpv4ServerMac) !=
+        std::tie(p.dhcpv4, p.dhcpv6, p.dhcpv4ServerIp, p.dhcpv4ServerMac))
+        changes |= FLOWS_SEC | FLOWS_BRIDGE;
+    if (anycastReturnIps != p.anycastReturnIps)
+        changes |= FLOWS_SERVICE_DST;
+    if (ipMappings != p.ipMappings)
+        changes |= FLOWS_IPM;
+    if (snatIps != p.snatIps)
+        changes |= FLOWS_SNAT;
+    return changes;
+}
+
+static string getIpmFlowId(const string& uuid) {
+    return "ep-ipm:" + uuid;
+}
+
+static string getSnatFlowId(const string& uuid) {
+    return "ep-snat:" + uuid;
+}
+
 void IntFlowManager::handleEndpointUpdate(const string& uuid) {
     LOG(DEBUG) << "Updating endpoint " << uuid;
 
@@ -1731,10 +1881,18 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
         switchManager.clearFlows(uuid, SRC_TABLE_ID);
         switchManager.clearFlows(uuid, BRIDGE_TABLE_ID);
         switchManager.clearFlows(uuid, ROUTE_TABLE_ID);
-        switchManager.clearFlows(uuid, SNAT_TABLE_ID);
-        switchManager.clearFlows(uuid, SNAT_REV_TABLE_ID);
         switchManager.clearFlows(uuid, SERVICE_DST_TABLE_ID);
         switchManager.clearFlows(uuid, OUT_TABLE_ID);
+        const string ipmId = getIpmFlowId(uuid);
+        switchManager.clearFlows(ipmId, SRC_TABLE_ID);
+        switchManager.clearFlows(ipmId, BRIDGE_TABLE_ID);
+        switchManager.clearFlows(ipmId, ROUTE_TABLE_ID);
+        switchManager.clearFlows(ipmId, OUT_TABLE_ID);
+        const string snatId = getSnatFlowId(uuid);
+        switchManager.clearFlows(snatId, ROUTE_TABLE_ID);
+        switchManager.clearFlows(snatId, SNAT_TABLE_ID);
+        switchManager.clearFlows(snatId, SNAT_REV_TABLE_ID);
+        epFlowInputs.erase(uuid);
         removeEndpointFromFloodGroup(uuid);
         agent.getSnatManager().delEndpoint(uuid);
         updateSvcStatsFlows(uuid, false, false);
@@ -1750,21 +1908,17 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
     boost::system::error_code ec;
 
     std::vector<address> ipAddresses;
-    for (const string& ipStr : endPoint.getIPs()) {
-        network::cidr_t cidr;
-        if (!network::cidr_from_string(ipStr, cidr, false)) {
-            LOG(WARNING) << "Invalid endpoint IP: "
-                         << ipStr << ": " << ec.message();
-        } else {
-            ipAddresses.push_back(cidr.first);
-        }
-    }
-    if (hasMac) {
-        address_v6 linkLocalIp(network::construct_link_local_ip_addr(macAddr));
-        if (endPoint.getIPs().find(linkLocalIp.to_string()) ==
-            endPoint.getIPs().end())
-            ipAddresses.push_back(linkLocalIp);
+    bool hasLinkLocal = false;
+    address_v6 linkLocalIp;
+    if (hasMac)
+        linkLocalIp = network::construct_link_local_ip_addr(macAddr);
+    for (const network::ip_prefix& ip : endPoint.getIPPrefixes()) {
+        ipAddresses.push_back(ip.address().to_address());
+        if (ipAddresses.back() == linkLocalIp)
+            hasLinkLocal = true;
     }
+    if (hasMac && !hasLinkLocal)
+        ipAddresses.push_back(linkLocalIp);
 
     uint32_t ofPort = OFPP_NONE;
     const optional<string>& ofPortName = endPoint.getInterfaceName();
@@ -1776,23 +1930,30 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
     FlowEntryList elSrc;
     FlowEntryList elBridgeDst;
     FlowEntryList elRouteDst;
-    FlowEntryList elSnat;
-    FlowEntryList elRevSnat;
     FlowEntryList elServiceMap;
     FlowEntryList elOutput;
+    FlowEntryList elIpmSrc;
+    FlowEntryList elIpmBridgeDst;
+    FlowEntryList elIpmRouteDst;
+    FlowEntryList elIpmOutput;
+    FlowEntryList elSnatRouteDst;
+    FlowEntryList elSnat;
+    FlowEntryList elRevSnat;
 
     optional<URI> epgURI = epMgr.getComputedEPG(uuid);
     bool hasForwardingInfo = false;
     uint32_t epgVnid = 0, rdId = 0, bdId = 0, fgrpId = 0;
     optional<URI> fgrpURI, bdURI, rdURI;
     optional<shared_ptr<FloodDomain> > fd;
+    PolicyManager::snapshot_ptr policy =
+        agent.getPolicyManager().getSnapshot();
 
     uint8_t arpMode = AddressResModeEnumT::CONST_UNICAST;
     uint8_t ndMode = AddressResModeEnumT::CONST_UNICAST;
     uint8_t unkFloodMode = UnknownFloodModeEnumT::CONST_DROP;
     uint8_t bcastFloodMode = BcastFloodModeEnumT::CONST_NORMAL;
 
-    if (epgURI && getGroupForwardingInfo(epgURI.get(), epgVnid, rdURI,
+    if (epgURI && getGroupForwardingInfo(*policy, epgURI.get(), epgVnid, rdURI,
                                          rdId, bdURI, bdId, fgrpURI, fgrpId)) {
         hasForwardingInfo = true;
     }
@@ -1808,8 +1969,12 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
         // Add stats flows for service metric collection
         updateSvcStatsFlows(uuid, false, true);
 
-        if (hasForwardingInfo)
-            fd = agent.getPolicyManager().getFDForGroup(epgURI.get());
+        if (hasForwardingInfo) {
+            shared_ptr<const PolicyManager::Snapshot::GroupInfo> group =
+                policy->getGroup(epgURI.get());
+            if (group)
+                fd = group->floodDomain;
+        }
 
         if (fd) {
             // Irrespective of flooding scope (epg vs. flood-domain), the
@@ -1827,25 +1992,129 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
         }
     }
 
-    // Virtual DHCP is allowed even without forwarding resolution
-    flowsEndpointDHCPSource(*this, elPortSec, elBridgeDst, endPoint, ofPort,
-                            hasMac, macAddr, virtualDHCPEnabled,
-                            hasForwardingInfo, epgVnid, rdId, bdId);
+    uint8_t routingMode = RoutingModeEnumT::CONST_DISABLED;
+    if (hasForwardingInfo && epgURI &&
+        rdId != 0 && bdId != 0 && ofPort != OFPP_NONE)
+        routingMode =
+            agent.getPolicyManager().getEffectiveRoutingMode(epgURI.get());
+    bool routed = hasForwardingInfo && rdId != 0 && bdId != 0 &&
+        ofPort != OFPP_NONE && virtualRouterEnabled && hasMac &&
+        routingMode == RoutingModeEnumT::CONST_ENABLED;
+
+    EndpointFlowInputs inputs;
+    inputs.ofPort = ofPort;
+    inputs.tunnelPort = getTunnelPort();
+    inputs.epgVnid = epgVnid;
+    inputs.rdId = rdId;
+    inputs.bdId = bdId;
+    inputs.fgrpId = fgrpId;
+    inputs.hasForwardingInfo = hasForwardingInfo;
+    inputs.arpMode = arpMode;
+    inputs.ndMode = ndMode;
+    inputs.unkFloodMode = unkFloodMode;
+    inputs.bcastFloodMode = bcastFloodMode;
+    inputs.routingMode = routingMode;
+    inputs.encapType = encapType;
+    inputs.virtualRouterEnabled = virtualRouterEnabled;
+    inputs.virtualDHCPEnabled = virtualDHCPEnabled;
+    inputs.routerMac = MAC(routerMac);
+    inputs.dhcpMac = MAC(dhcpMac);
+    inputs.mac = endPoint.getMAC();
+    inputs.ips = endPoint.getIPs();
+    inputs.external = endPoint.isExternal();
+    inputs.promiscuousMode = endPoint.isPromiscuousMode();
+    inputs.natMode = endPoint.isNatMode();
+    inputs.discoveryProxyMode = endPoint.isDiscoveryProxyMode();
+    inputs.aapModeAA = endPoint.isAapModeAA();
+    inputs.virtualIps = endPoint.getVirtualIPs();
+    inputs.anycastReturnIps = endPoint.getAnycastReturnIPs();
+    const optional<Endpoint::DHCPv4Config>& v4c = endPoint.getDHCPv4Config();
+    inputs.dhcpv4 = v4c != boost::none;
+    inputs.dhcpv6 = endPoint.getDHCPv6Config() != boost::none;
+    if (v4c) {
+        inputs.dhcpv4ServerIp = v4c.get().getServerIp();
+        inputs.dhcpv4ServerMac = v4c.get().getServerMac();
+    }
+
+    if (routed) {
+        // IP address mappings
+        for (const Endpoint::IPAddressMapping& ipm :
+                 endPoint.getIPAddressMappings()) {
+            if (!ipm.getMappedIP() || !ipm.getEgURI())
+                continue;
 
-    bool hostAcc = false;
-    /* Add ARP responder for veth_host */
-    if (uuid.find("veth_host_ac") != std::string::npos) {
-        hostAcc = true;
-        for (const string& ipStr : endPoint.getIPs()) {
-            network::cidr_t cidr;
-            if (!network::cidr_from_string(ipStr, cidr, false)) {
-                LOG(WARNING) << "Invalid endpoint IP: "
-                             << ipStr << ": " << ec.message();
+            EndpointFlowInputs::IpMapping m;
+            m.mappedIp = address::from_string(ipm.getMappedIP().get(), ec);
+            if (ec) continue;
+
+            if (ipm.getFloatingIP()) {
+                m.floatingIp =
+                    address::from_string(ipm.getFloatingIP().get(), ec);
+                if (ec) continue;
+                if (m.floatingIp.is_v4() != m.mappedIp.is_v4()) continue;
+            }
+
+            optional<URI> ffdURI, fbdURI, frdURI;
+            if (!getGroupForwardingInfo(*policy, ipm.getEgURI().get(),
+                                        m.epgVnid, frdURI, m.rdId,
+                                        fbdURI, m.bdId, ffdURI, m.fdId))
                 continue;
-            } else {
-                LOG(DEBUG) << "Found endpoint IP: "
-                           << ipStr;
+
+            m.nextHopPort = OFPP_NONE;
+            if (ipm.getNextHopIf()) {
+                m.nextHopPort = switchManager.getPortMapper()
+                    .FindPort(ipm.getNextHopIf().get());
+                if (m.nextHopPort == OFPP_NONE) continue;
             }
+            m.nextHopMac = ipm.getNextHopMAC();
+            inputs.ipMappings.push_back(m);
+        }
+
+        for (const auto& snatUuid : endPoint.getSnatUuids()) {
+            // Inform snat manager of our interest in this snat-ip
+            agent.getSnatManager().addEndpoint(snatUuid, uuid);
+            shared_ptr<const Snat> asWrapper =
+                agent.getSnatManager().getSnat(snatUuid);
+            if (!asWrapper || !asWrapper->isLocal() ||
+                asWrapper->getUUID() != snatUuid)
+                continue;
+
+            uint16_t zoneId = 0;
+            if (asWrapper->getZone())
+                zoneId = asWrapper->getZone().get();
+            if (zoneId == 0)
+                zoneId = ctZoneManager.getId(asWrapper->getUUID());
+            uint32_t snatPort = switchManager.getPortMapper()
+                .FindPort(asWrapper->getInterfaceName());
+            if (snatPort != OFPP_NONE)
+                inputs.snatIps.push_back({asWrapper, snatPort, zoneId});
+        }
+    }
+
+    /* The host access endpoint has flows that depend on its UUID */
+    bool hostAcc = uuid.find("veth_host_ac") != std::string::npos;
+
+    uint32_t changes = EndpointFlowInputs::FLOWS_ALL;
+    auto last = epFlowInputs.emplace(uuid, EndpointFlowInputs());
+    if (incrementalEpFlows && !hostAcc && !last.second)
+        changes = inputs.getChanges(last.first->second);
+    last.first->second = std::move(inputs);
+    const EndpointFlowInputs& in = last.first->second;
+    LOG(DEBUG) << "Regenerating endpoint flow groups 0x" << std::hex
+               << changes << std::dec << " for " << uuid;
+
+    // Virtual DHCP is allowed even without forwarding resolution
+    if (changes & (EndpointFlowInputs::FLOWS_SEC |
+                   EndpointFlowInputs::FLOWS_BRIDGE))
+        flowsEndpointDHCPSource(*this, elPortSec, elBridgeDst, endPoint,
+                                ofPort, hasMac, macAddr, virtualDHCPEnabled,
+                                hasForwardingInfo, epgVnid, rdId, bdId);
+
+    /* Add ARP responder for veth_host */
+    if (hostAcc) {
+        for (const network::ip_prefix& ip : endPoint.getIPPrefixes()) {
+            network::cidr_t cidr = ip.to_cidr();
+            LOG(DEBUG) << "Found endpoint IP: " << ip.address();
             FlowBuilder proxyArp;
             proxyArp.priority(41).inPort(ofPort)
                 .ethSrc(macAddr).arpSrc(cidr.first)
@@ -1898,16 +2167,19 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
 
     if (hasForwardingInfo) {
         /* Port security flows */
-        flowsEndpointPortSec(elPortSec, endPoint, ofPort,
-                             hasMac, macAddr, ipAddresses);
+        if (changes & EndpointFlowInputs::FLOWS_SEC)
+            flowsEndpointPortSec(elPortSec, endPoint, ofPort,
+                                 hasMac, macAddr, ipAddresses);
 
         /* Source Table flows; applicable only to local endpoints */
-        flowsEndpointSource(elSrc, endPoint, ofPort, hostAcc,
-                            hasMac, macAddr, unkFloodMode, bcastFloodMode,
-                            epgVnid, bdId, fgrpId, rdId);
+        if (changes & EndpointFlowInputs::FLOWS_SRC)
+            flowsEndpointSource(elSrc, endPoint, ofPort, hostAcc,
+                                hasMac, macAddr, unkFloodMode, bcastFloodMode,
+                                epgVnid, bdId, fgrpId, rdId);
 
         /* Bridge, route, and output flows */
-        if (bdId != 0 && hasMac && ofPort != OFPP_NONE) {
+        if ((changes & EndpointFlowInputs::FLOWS_BRIDGE) &&
+            bdId != 0 && hasMac && ofPort != OFPP_NONE) {
             FlowBuilder().priority(10).ethDst(macAddr).reg(4, bdId)
                 .action()
                 .reg(MFF_REG2, epgVnid)
@@ -1917,11 +2189,8 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
         }
 
         if (rdId != 0 && bdId != 0 && ofPort != OFPP_NONE) {
-            uint8_t routingMode =
-                agent.getPolicyManager().getEffectiveRoutingMode(epgURI.get());
-
-            if (virtualRouterEnabled && hasMac &&
-                routingMode == RoutingModeEnumT::CONST_ENABLED) {
+            if (routed && (changes & (EndpointFlowInputs::FLOWS_BRIDGE |
+                                      EndpointFlowInputs::FLOWS_ROUTE))) {
                 for (const address& ipAddr : ipAddresses) {
                     if (endPoint.isDiscoveryProxyMode()) {
                         // Auto-reply to ARP and NDP requests for endpoint
@@ -1976,108 +2245,62 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
                             .go(POL_TABLE_ID)
                             .parent().build(elRouteDst);
                     }
-
-                }
-
-                // virtual ip addresses in active-active AAP mode
-                if (endPoint.isAapModeAA()) {
-                    for (const Endpoint::virt_ip_t& vip : endPoint.getVirtualIPs()) {
-                        network::cidr_t vip_cidr;
-                        if (!network::cidr_from_string(vip.second, vip_cidr)) {
-                            LOG(WARNING) << "Invalid endpoint VIP (CIDR): " << vip.second;
-                            continue;
-                        }
-                        uint8_t vmac[6];
-                        vip.first.toUIntArray(vmac);
-
-                        FlowBuilder e0;
-                        matchDestDom(e0, 0, rdId);
-                        e0.priority(500)
-                            .ethDst(vmac)
-                            .ipDst(vip_cidr.first, vip_cidr.second)
-                            .action()
-                            .reg(MFF_REG2, epgVnid)
-                            .reg(MFF_REG7, ofPort)
-                            .metadata(flow::meta::ROUTED, flow::meta::ROUTED)
-                            .go(POL_TABLE_ID)
-                            .parent().build(elRouteDst);
-                    }
                 }
+            }
 
-                // IP address mappings
-                for(const Endpoint::IPAddressMapping& ipm :
-                        endPoint.getIPAddressMappings()) {
-                    if (!ipm.getMappedIP() || !ipm.getEgURI())
+            // virtual ip addresses in active-active AAP mode
+            if (routed && (changes & EndpointFlowInputs::FLOWS_ROUTE) &&
+                endPoint.isAapModeAA()) {
+                for (const Endpoint::virt_ip_t& vip : endPoint.getVirtualIPs()) {
+                    network::cidr_t vip_cidr;
+                    if (!network::cidr_from_string(vip.second, vip_cidr)) {
+                        LOG(WARNING) << "Invalid endpoint VIP (CIDR): " << vip.second;
                         continue;
-
-                    address mappedIp =
-                        address::from_string(ipm.getMappedIP().get(), ec);
-                    if (ec) continue;
-
-                    address floatingIp;
-                    if (ipm.getFloatingIP()) {
-                        floatingIp =
-                            address::from_string(ipm.getFloatingIP().get(), ec);
-                        if (ec) continue;
-                        if (floatingIp.is_v4() != mappedIp.is_v4()) continue;
                     }
+                    uint8_t vmac[6];
+                    vip.first.toUIntArray(vmac);
 
-                    uint32_t fepgVnid, frdId, fbdId, ffdId;
-                    optional<URI> ffdURI, fbdURI, frdURI;
-                    if (!getGroupForwardingInfo(ipm.getEgURI().get(),
-                                                fepgVnid, frdURI, frdId,
-                                                fbdURI, fbdId, ffdURI, ffdId))
-                        continue;
+                    FlowBuilder e0;
+                    matchDestDom(e0, 0, rdId);
+                    e0.priority(500)
+                        .ethDst(vmac)
+                        .ipDst(vip_cidr.first, vip_cidr.second)
+                        .action()
+                        .reg(MFF_REG2, epgVnid)
+                        .reg(MFF_REG7, ofPort)
+                        .metadata(flow::meta::ROUTED, flow::meta::ROUTED)
+                        .go(POL_TABLE_ID)
+                        .parent().build(elRouteDst);
+                }
+            }
 
-                    uint32_t nextHop = OFPP_NONE;
-                    if (ipm.getNextHopIf()) {
-                        nextHop = switchManager.getPortMapper()
-                            .FindPort(ipm.getNextHopIf().get());
-                        if (nextHop == OFPP_NONE) continue;
-                    }
+            if (routed && (changes & EndpointFlowInputs::FLOWS_IPM)) {
+                for (const EndpointFlowInputs::IpMapping& m :
+                         in.ipMappings) {
                     uint8_t nextHopMac[6];
                     const uint8_t* nextHopMacp = NULL;
-                    if (ipm.getNextHopMAC()) {
-                        ipm.getNextHopMAC().get().toUIntArray(nextHopMac);
+                    if (m.nextHopMac) {
+                        m.nextHopMac.get().toUIntArray(nextHopMac);
                         nextHopMacp = nextHopMac;
                     }
 
-                    flowsIpm(*this, elSrc, elBridgeDst, elRouteDst,
-                             elOutput, macAddr, ofPort,
+                    flowsIpm(*this, elIpmSrc, elIpmBridgeDst, elIpmRouteDst,
+                             elIpmOutput, macAddr, ofPort,
                              epgVnid, rdId, bdId, fgrpId,
-                             fepgVnid, frdId, fbdId, ffdId,
-                             mappedIp, floatingIp, nextHop,
+                             m.epgVnid, m.rdId, m.bdId, m.fdId,
+                             m.mappedIp, m.floatingIp, m.nextHopPort,
                              nextHopMacp);
                 }
+            }
 
-                const std::vector<std::string>& snatUuids
-                    = endPoint.getSnatUuids();
+            if (routed && (changes & EndpointFlowInputs::FLOWS_SNAT)) {
                 int count = 0;
-                for (const auto& snatUuid: snatUuids) {
-                    // Inform snat manager of our interest in this snat-ip
-                    agent.getSnatManager().addEndpoint(snatUuid, uuid);
-                    shared_ptr<const Snat> asWrapper =
-                        agent.getSnatManager().getSnat(snatUuid);
-                     if (asWrapper && asWrapper->isLocal() &&
-                         asWrapper->getUUID() == snatUuid) {
-                         const Snat& as = *asWrapper;
-                         uint16_t zoneId = 0;
-                         uint32_t snatPort = OFPP_NONE;
-
-                         if (as.getZone())
-                             zoneId = as.getZone().get();
-                         if (zoneId == 0)
-                             zoneId = ctZoneManager.getId(as.getUUID());
-                         snatPort = switchManager.getPortMapper()
-                             .FindPort(as.getInterfaceName());
-                         if (snatPort != OFPP_NONE) {
-                             flowsEndpointSNAT(agent.getSnatManager(),
-                                               as, snatPort, rdId, zoneId,
-                                               endPoint, uuid,
-                                               elRouteDst, elSnat, ofPort,
-                                               macAddr, count, elRevSnat);
-                         }
-                    }
+                for (const EndpointFlowInputs::SnatIp& sip : in.snatIps) {
+                    flowsEndpointSNAT(agent.getSnatManager(),
+                                      *sip.snat, sip.port, rdId, sip.zoneId,
+                                      endPoint, uuid,
+                                      elSnatRouteDst, elSnat, ofPort,
+                                      macAddr, count, elRevSnat);
                 }
                 LOG(DEBUG) << "Compiled " << count << " SNAT flows";
             }
@@ -2087,17 +2310,12 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
             // normal network semantics and policy.  The service map table
             // is reachable only for traffic originating from service
             // interfaces.
-            if (hasMac) {
+            if (hasMac &&
+                (changes & EndpointFlowInputs::FLOWS_SERVICE_DST)) {
                 std::vector<address> anycastReturnIps;
-                for (const string& ipStr : endPoint.getAnycastReturnIPs()) {
-                    address addr = address::from_string(ipStr, ec);
-                    if (ec) {
-                        LOG(WARNING) << "Invalid anycast return IP: "
-                                     << ipStr << ": " << ec.message();
-                    } else {
-                        anycastReturnIps.push_back(addr);
-                    }
-                }
+                for (const network::ip_addr& addr :
+                         endPoint.getAnycastReturnAddrs())
+                    anycastReturnIps.push_back(addr.to_address());
                 if (anycastReturnIps.size() == 0) {
                     anycastReturnIps = ipAddresses;
                 }
@@ -2122,7 +2340,8 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
             }
         }
 
-        if (ofPort != OFPP_NONE) {
+        if ((changes & EndpointFlowInputs::FLOWS_OUT) &&
+            ofPort != OFPP_NONE) {
             // If a packet has a routing action applied, we'll allow it to
             // hairpin for ordinary default output action or reverse NAT
             // output
@@ -2143,14 +2362,31 @@ void IntFlowManager::handleEndpointUpdate(const string& uuid) {
         }
     }
 
-    switchManager.writeFlow(uuid, SEC_TABLE_ID, elPortSec);
-    switchManager.writeFlow(uuid, SRC_TABLE_ID, elSrc);
-    switchManager.writeFlow(uuid, BRIDGE_TABLE_ID, elBridgeDst);
-    switchManager.writeFlow(uuid, ROUTE_TABLE_ID, elRouteDst);
-    switchManager.writeFlow(uuid, SNAT_TABLE_ID, elSnat);
-    switchManager.writeFlow(uuid, SNAT_REV_TABLE_ID, elRevSnat);
-    switchManager.writeFlow(uuid, SERVICE_DST_TABLE_ID, elServiceMap);
-    switchManager.writeFlow(uuid, OUT_TABLE_ID, elOutput);
+    if (changes & EndpointFlowInputs::FLOWS_SEC)
+        switchManager.writeFlow(uuid, SEC_TABLE_ID, elPortSec);
+    if (changes & EndpointFlowInputs::FLOWS_SRC)
+        switchManager.writeFlow(uuid, SRC_TABLE_ID, elSrc);
+    if (changes & EndpointFlowInputs::FLOWS_BRIDGE)
+        switchManager.writeFlow(uuid, BRIDGE_TABLE_ID, elBridgeDst);
+    if (changes & EndpointFlowInputs::FLOWS_ROUTE)
+        switchManager.writeFlow(uuid, ROUTE_TABLE_ID, elRouteDst);
+    if (changes & EndpointFlowInputs::FLOWS_SERVICE_DST)
+        switchManager.writeFlow(uuid, SERVICE_DST_TABLE_ID, elServiceMap);
+    if (changes & EndpointFlowInputs::FLOWS_OUT)
+        switchManager.writeFlow(uuid, OUT_TABLE_ID, elOutput);
+    if (changes & EndpointFlowInputs::FLOWS_IPM) {
+        const string ipmId = getIpmFlowId(uuid);
+        switchManager.writeFlow(ipmId, SRC_TABLE_ID, elIpmSrc);
+        switchManager.writeFlow(ipmId, BRIDGE_TABLE_ID, elIpmBridgeDst);
+        switchManager.writeFlow(ipmId, ROUTE_TABLE_ID, elIpmRouteDst);
+        switchManager.writeFlow(ipmId, OUT_TABLE_ID, elIpmOutput);
+    }
+    if (changes & EndpointFlowInputs::FLOWS_SNAT) {
+        const string snatId = getSnatFlowId(uuid);
+        switchManager.writeFlow(snatId, ROUTE_TABLE_ID, elSnatRouteDst);
+        switchManager.writeFlow(snatId, SNAT_TABLE_ID, elSnat);
+        switchManager.writeFlow(snatId, SNAT_REV_TABLE_ID, elRevSnat);
+    }
 
     if (fgrpURI && ofPort != OFPP_NONE) {
         updateEndpointFloodGroup(fgrpURI.get(), endPoint, ofPort,
@@ -2627,6 +2863,30 @@ void IntFlowManager::clearPodSvcStatsCounters (const std::string& uuid)
 #endif
 }
 
+boost::optional<std::string>
+IntFlowManager::getSampledServiceUuid(uint32_t obsPointId) {
+    return idGen.getStringForId(ID_NMSPC_SERVICE, obsPointId);
+}
+
+void IntFlowManager::updatePodSvcSampledCounters(bool isEpToSvc,
+                                                 const std::string& uuid,
+                                                 uint64_t pkts,
+                                                 uint64_t bytes) {
+    const std::lock_guard<mutex> lock(svcStatMutex);
+    const string& idStr = (isEpToSvc ? "eptosvc:" : "svctoep:") + uuid;
+    // create the counters and refresh their attributes, then add the
+    // traffic
+    updatePodSvcStatsCounters(0, isEpToSvc, idStr, 0, 0);
+    if (pkts)
+        updatePodSvcStatsCounters(0, isEpToSvc, idStr, pkts, bytes);
+}
+
+void IntFlowManager::clearPodSvcSampledCounters(bool isEpToSvc,
+                                                const std::string& uuid) {
+    const std::lock_guard<mutex> lock(svcStatMutex);
+    clearPodSvcStatsCounters((isEpToSvc ? "eptosvc:" : "svctoep:") + uuid);
+}
+
 // Reset svc-tgt counter stats, deletion of the object will be handled in
 // ServiceManager
 void IntFlowManager::clearSvcTgtStatsCounters (const std::string& svcUuid,
@@ -3581,6 +3841,11 @@ void IntFlowManager::updatePodSvcStatsFlows (const string &uuid,
                << " is_svc: " << is_svc
                << " is_add: " << is_add << "#######";
 
+    // When sampling, the load balancing flows account for pod<-->svc
+    // traffic and the counters are maintained from the samples
+    if (podSvcSampleProbability != 0)
+        return;
+
     /* A service could have multiple ServiceMappings and an EP
      * could have multiple IPs. The flows are created for each of the
      * IP pairs between pod <--> svc.
@@ -3604,34 +3869,22 @@ void IntFlowManager::updatePodSvcStatsFlows (const string &uuid,
     // Expr to add stats flow between "ep to svc" and "svc to ep"
     auto podSvcFlowAddExpr =
         [this, &uuid_felist_map](const string &uuid,
-                                 const string &epipStr,
+                                 const network::ip_addr &epIp,
                                  const Service::ServiceMapping &sm) -> void {
 
-        boost::system::error_code ec;
-
-        address epAddr = address::from_string(epipStr, ec);
-        if (ec) {
-            LOG(WARNING) << "Invalid endpoint IP: "
-                         << epipStr << ": " << ec.message();
-            return;
-        }
-
         if (!sm.getServiceIP())
             return;
-        address svcAddr =
-            address::from_string(sm.getServiceIP().get(), ec);
-        if (ec) {
+        if (sm.getServiceAddr().empty()) {
             LOG(WARNING) << "Invalid service IP: "
-                         << sm.getServiceIP().get()
-                         << ": " << ec.message();
+                         << sm.getServiceIP().get();
             return;
         }
         LOG(TRACE) << "Adding pod<-->svc flow between"
-                   << " EP IP: " << epipStr
+                   << " EP IP: " << epIp
                    << " SVC-SM IP: " << sm.getServiceIP().get();
 
         // ensure flows are either v4 or v6 - no mix-n-match
-        if (svcAddr.is_v4() != epAddr.is_v4()) {
+        if (sm.getServiceAddr().family() != epIp.family()) {
             LOG(TRACE) << "Not adding flow - ip types are different";
             return;
         }
@@ -3674,6 +3927,8 @@ void IntFlowManager::updatePodSvcStatsFlows (const string &uuid,
         updatePodSvcStatsCounters(podSvcUuidCkMap[uuid].first, true, ingStr, 0, 0);
         updatePodSvcStatsCounters(podSvcUuidCkMap[uuid].second, false, egrStr, 0, 0);
 
+        address epAddr = epIp.to_address();
+        address svcAddr = sm.getServiceAddr().to_address();
         FlowBuilder epToSvc; // to service stats
         FlowBuilder svcToEp; // from service stats
 
@@ -3772,15 +4027,13 @@ void IntFlowManager::updatePodSvcStatsFlows (const string &uuid,
                     continue;
                 }
 
-                for (const string& epipStr : endPoint.getIPs()) {
-                    network::cidr_t cidr;
-                    if (!network::cidr_from_string(epipStr, cidr, false))
-                        continue;
+                for (const network::ip_prefix& epIp :
+                         endPoint.getIPPrefixes()) {
                     // Dont create EPIP <--> SVCIP flows if EPIP is one of the
                     // next hops of this service.
-                    const auto& nhips = sm.getNextHopIPs();
-                    if (nhips.find(cidr.first.to_string()) == nhips.end()) {
-                        podSvcFlowAddExpr(epUuid+":"+uuid, cidr.first.to_string(), sm);
+                    const auto& nhips = sm.getNextHopAddrs();
+                    if (nhips.find(epIp.address()) == nhips.end()) {
+                        podSvcFlowAddExpr(epUuid+":"+uuid, epIp.address(), sm);
                     } else {
                         epsvc_uuids.insert(epUuid+":"+uuid);
                     }
@@ -3836,10 +4089,7 @@ void IntFlowManager::updatePodSvcStatsFlows (const string &uuid,
         // flows will get created between this EP and Svc, and unwanted flows will get
         // cleaned up.
         unordered_set<string> epsvc_uuids;
-        for (const string& epipStr : endPoint.getIPs()) {
-             network::cidr_t cidr;
-             if (!network::cidr_from_string(epipStr, cidr, false))
-                 continue;
+        for (const network::ip_prefix& epIp : endPoint.getIPPrefixes()) {
 
             for (const string& svcUuid : svcUuids) {
                 shared_ptr<const Service> asWrapper
@@ -3863,9 +4113,9 @@ void IntFlowManager::updatePodSvcStatsFlows (const string &uuid,
                 for (auto const& sm : as.getServiceMappings()) {
                     // Dont create EPIP <--> SVCIP flows if EPIP is one of the
                     // next hops of this service.
-                    const auto& nhips = sm.getNextHopIPs();
-                    if (nhips.find(cidr.first.to_string()) == nhips.end()) {
-                        podSvcFlowAddExpr(uuid+":"+svcUuid, cidr.first.to_string(), sm);
+                    const auto& nhips = sm.getNextHopAddrs();
+                    if (nhips.find(epIp.address()) == nhips.end()) {
+                        podSvcFlowAddExpr(uuid+":"+svcUuid, epIp.address(), sm);
                     } else {
                         epsvc_uuids.insert(uuid+":"+svcUuid);
                     }
@@ -3922,6 +4172,12 @@ void IntFlowManager::programServiceSnatDnatFlows (const string& uuid)
 
         uint32_t rdId = getId(RoutingDomain::CLASS_ID, as.getDomainURI().get());
         uint32_t ctMark = idGen.getId(ID_NMSPC_SERVICE, uuid);
+        // sample pod<-->svc traffic on the load balancing flows, with
+        // the service ID as the observation point
+        uint32_t sampleSvcId = ctMark;
+        bool sampled = podSvcSampleProbability != 0 &&
+            as.getServiceMode() == Service::LOADBALANCER &&
+            !as.getInterfaceName();
         if (as.getInterfaceName())
             ctMark |= 1 << 31;
 
@@ -3968,6 +4224,37 @@ void IntFlowManager::programServiceSnatDnatFlows (const string& uuid)
             }
 
 
+            // With a Maglev table, the bridge table stores the
+            // table slot in reg7 and the slot flows replace it with
+            // the link of the next hop that owns the slot.  Links
+            // are derived from the next hop address rather than its
+            // position so that they don't change when other next
+            // hops come and go.
+            bool maglev = useMaglev(nextHopAddrs.size());
+            vector<uint32_t> linkIds;
+            if (maglev) {
+                vector<string> nextHopNames;
+                for (const address& nextHopAddr : nextHopAddrs)
+                    nextHopNames.push_back(nextHopAddr.to_string());
+                MaglevTable::getLinkIds(nextHopNames, maglevTableSize,
+                                        linkIds);
+
+                vector<uint32_t> table;
+                MaglevTable::populate(nextHopNames, maglevTableSize, table);
+                for (uint32_t slot = 0; slot < table.size(); ++slot) {
+                    FlowBuilder slotMap;
+                    matchDestDom(slotMap, 0, rdId);
+                    matchActionServiceProto(slotMap, proto, sm, true, false);
+                    slotMap.priority(101)
+                        .ipDst(serviceAddr)
+                        .reg(7, slot)
+                        .action()
+                        .reg(MFF_REG7, linkIds[table[slot]])
+                        .resubmit(OFPP_IN_PORT, SERVICE_NEXTHOP_TABLE_ID);
+                    slotMap.build(serviceNextHopFlows);
+                }
+            }
+
             uint16_t link = 0;
             for (const address& nextHopAddr : nextHopAddrs) {
                 {
@@ -3983,8 +4270,13 @@ void IntFlowManager::programServiceSnatDnatFlows (const string& uuid)
                         ipMap.priority(99);
                     } else {
                         ipMap.priority(100)
-                            .reg(7, link);
+                            .reg(7, maglev ? linkIds[link] : link);
                     }
+                    if (sampled)
+                        ipMap.action().sample(podSvcSampleProbability,
+                                              podSvcSampleCollectorSetId,
+                                              SAMPLE_TO_SERVICE,
+                                              sampleSvcId);
                     ipMap.action().ipDst(nextHopAddr).decTtl();
 
                     if (as.getServiceMode() == Service::LOADBALANCER) {
@@ -4090,8 +4382,14 @@ void IntFlowManager::programServiceSnatDnatFlows (const string& uuid)
                             }
                         }
                         ipRevMap.priority(100)
-                            .ipSrc(nextHopAddr)
-                            .action()
+                            .ipSrc(nextHopAddr);
+                        if (sampled)
+                            ipRevMap.action()
+                                .sample(podSvcSampleProbability,
+                                        podSvcSampleCollectorSetId,
+                                        SAMPLE_FROM_SERVICE,
+                                        sampleSvcId);
+                        ipRevMap.action()
                             .ethSrc(macAddr)
                             .ipSrc(serviceAddr)
                             .decTtl();
@@ -4255,13 +4553,23 @@ void IntFlowManager::handleServiceUpdate(const string& uuid) {
                     } else {
                         serviceDest.action().ethDst(getRouterMacAddr());
                     }
-                    serviceDest.action()
-                        .multipath(NX_HASH_FIELDS_SYMMETRIC_L3L4_UDP,
-                                   1024,
-                                   ActionBuilder::NX_MP_ALG_ITER_HASH,
-                                   static_cast<uint16_t>(nextHopAddrs.size()-1),
-                                   32, MFF_REG7)
-                        .go(SERVICE_NEXTHOP_TABLE_ID);
+                    if (useMaglev(nextHopAddrs.size())) {
+                        // select a slot in the Maglev table
+                        serviceDest.action()
+                            .multipath(NX_HASH_FIELDS_SYMMETRIC_L3L4_UDP,
+                                       1024,
+                                       ActionBuilder::NX_MP_ALG_MODULO_N,
+                                       static_cast<uint16_t>(maglevTableSize-1),
+                                       0, MFF_REG7);
+                    } else {
+                        serviceDest.action()
+                            .multipath(NX_HASH_FIELDS_SYMMETRIC_L3L4_UDP,
+                                       1024,
+                                       ActionBuilder::NX_MP_ALG_ITER_HASH,
+                                       static_cast<uint16_t>(nextHopAddrs.size()-1),
+                                       32, MFF_REG7);
+                    }
+                    serviceDest.action().go(SERVICE_NEXTHOP_TABLE_ID);
                 } else if (as.getServiceMode() == Service::LOCAL_ANYCAST &&
                            ofPort != OFPP_NONE) {
                     serviceDest.action()
@@ -4920,7 +5228,10 @@ void IntFlowManager::handleEndpointGroupDomainUpdate(const URI& epgURI) {
     address epgTunDst = getEPGTunnelDst(epgURI);
 
     PolicyManager& polMgr = agent.getPolicyManager();
-    if (!polMgr.groupExists(epgURI)) {  // EPG removed
+    PolicyManager::snapshot_ptr policy = polMgr.getSnapshot();
+    shared_ptr<const PolicyManager::Snapshot::GroupInfo> group =
+        policy->getGroup(epgURI);
+    if (!group) {  // EPG removed
         switchManager.clearFlows(epgId, SRC_TABLE_ID);
         switchManager.clearFlows(epgId, POL_TABLE_ID);
         switchManager.clearFlows(epgId, OUT_TABLE_ID);
@@ -4931,7 +5242,7 @@ void IntFlowManager::handleEndpointGroupDomainUpdate(const URI& epgURI) {
 
     uint32_t epgVnid, rdId, bdId, fgrpId;
     optional<URI> fgrpURI, bdURI, rdURI;
-    if (!getGroupForwardingInfo(epgURI, epgVnid, rdURI, rdId,
+    if (!getGroupForwardingInfo(*policy, epgURI, epgVnid, rdURI, rdId,
                                 bdURI, bdId, fgrpURI, fgrpId)) {
         return;
     }
@@ -4979,7 +5290,7 @@ void IntFlowManager::handleEndpointGroupDomainUpdate(const URI& epgURI) {
     }
 
     if (virtualRouterEnabled && rdId != 0 && bdId != 0) {
-        updateGroupSubnets(epgURI, bdId, rdId);
+        updateGroupSubnets(*group, bdId, rdId);
 
         FlowEntryList bridgel;
         uint8_t routingMode =
@@ -5075,10 +5386,10 @@ void IntFlowManager::handleEndpointGroupDomainUpdate(const URI& epgURI) {
         if (!ep) continue;
         const boost::optional<opflex::modb::URI>& egURI = ep->getEgURI();
         if (!egURI) continue;
-        boost::optional<std::shared_ptr<modelgbp::gbp::RoutingDomain> > rd =
-            polMgr.getRDForGroup(egURI.get());
-        if (rd)
-            ipmRds.insert(rd.get()->getURI());
+        shared_ptr<const PolicyManager::Snapshot::GroupInfo> ipmGroup =
+            policy->getGroup(egURI.get());
+        if (ipmGroup && ipmGroup->routingDomain)
+            ipmRds.insert(ipmGroup->routingDomain.get()->getURI());
     }
     for (const URI& rdURI : ipmRds) {
         // update routing domains that have references to the
@@ -5100,11 +5411,9 @@ void IntFlowManager::handleEndpointGroupDomainUpdate(const URI& epgURI) {
         contractUpdated(contract);
     }
 
-    optional<string> epgMcastIp = polMgr.getMulticastIPForGroup(epgURI);
-    updateMulticastList(epgMcastIp, epgURI);
+    updateMulticastList(group->multicastIP, epgURI);
     optional<string> fdcMcastIp;
-    optional<shared_ptr<FloodContext> > fdCtx =
-        polMgr.getFloodContextForGroup(epgURI);
+    const optional<shared_ptr<FloodContext> >& fdCtx = group->floodContext;
     if (fdCtx) {
         if (fdCtx.get()->getMulticastGroupIP())
             fdcMcastIp = fdCtx.get()->getMulticastGroupIP().get();
@@ -5141,7 +5450,8 @@ void IntFlowManager::handleLocalExternalDomainUpdated(const opflex::modb::URI &e
 
     uint32_t epgVnid, rdId, bdId, fgrpId;
     optional<URI> fgrpURI, bdURI, rdURI;
-    if (!getGroupForwardingInfo(epgURI, epgVnid, rdURI, rdId,
+    if (!getGroupForwardingInfo(*agent.getPolicyManager().getSnapshot(),
+                                epgURI, epgVnid, rdURI, rdId,
                                 bdURI, bdId, fgrpURI, fgrpId)) {
         return;
     }
@@ -5199,24 +5509,21 @@ void IntFlowManager::handleLocalExternalDomainUpdated(const opflex::modb::URI &e
 
     switchManager.writeFlow(epgId, OUT_TABLE_ID, egOutFlows);
 
-    unordered_set<string> epUuids;
-    // note this combines with the IPM group endpoints from above:
-    epMgr.getEndpointsForGroup(epgURI, epUuids);
-    for (const string& uuid : epUuids) {
+    for (const string& uuid : epMgr.getEndpointsForGroup(epgURI)) {
         advertManager.scheduleEndpointAdv(uuid);
         endpointUpdated(uuid);
     }
 
 }
 
-void IntFlowManager::updateGroupSubnets(const URI& egURI, uint32_t bdId,
-                                        uint32_t rdId) {
-    PolicyManager::subnet_vector_t subnets;
-    agent.getPolicyManager().getSubnetsForGroup(egURI, subnets);
+void IntFlowManager::updateGroupSubnets(
+    const PolicyManager::Snapshot::GroupInfo& group,
+    uint32_t bdId, uint32_t rdId) {
+    const PolicyManager::subnet_vector_t& subnets = group.subnets;
 
     uint32_t tunPort = getTunnelPort();
 
-    for (shared_ptr<Subnet>& sn : subnets) {
+    for (const shared_ptr<Subnet>& sn : subnets) {
         FlowEntryList el;
 
         optional<address> routerIp =
@@ -5697,28 +6004,24 @@ IntFlowManager::handleContractUpdate(const opflex::modb::URI& contractURI) {
     LOG(DEBUG) << "Updating contract " << contractURI;
 
     const string& contractId = contractURI.toString();
-    PolicyManager& polMgr = agent.getPolicyManager();
-    if (!polMgr.contractExists(contractURI)) {  // Contract removed
+    PolicyManager::snapshot_ptr policy =
+        agent.getPolicyManager().getSnapshot();
+    shared_ptr<const PolicyManager::Snapshot::ContractInfo> contract =
+        policy->getContract(contractURI);
+    if (!contract) {  // Contract removed
         switchManager.clearFlows(contractId, POL_TABLE_ID);
         return;
     }
-    PolicyManager::uri_set_t provURIs;
-    PolicyManager::uri_set_t consURIs;
-    PolicyManager::uri_set_t intraURIs;
-    polMgr.getContractProviders(contractURI, provURIs);
-    polMgr.getContractConsumers(contractURI, consURIs);
-    polMgr.getContractIntra(contractURI, intraURIs);
 
     typedef unordered_set<uint32_t> id_set_t;
     id_set_t provIds;
     id_set_t consIds;
     id_set_t intraIds;
-    getGroupVnid(provURIs, provIds);
-    getGroupVnid(consURIs, consIds);
-    getGroupVnid(intraURIs, intraIds);
+    getGroupVnid(*policy, contract->providerGroups, provIds);
+    getGroupVnid(*policy, contract->consumerGroups, consIds);
+    getGroupVnid(*policy, contract->intraGroups, intraIds);
 
-    PolicyManager::rule_list_t rules;
-    polMgr.getContractRules(contractURI, rules);
+    const PolicyManager::rule_list_t& rules = contract->rules;
 
     LOG(DEBUG) << "Update for contract " << contractURI
                << ", #prov=" << provIds.size()
@@ -5907,12 +6210,21 @@ void IntFlowManager::handlePortStatusUpdate(const string& portName,
 
 void IntFlowManager::getGroupVnid(const unordered_set<URI>& uris,
     /* out */unordered_set<uint32_t>& ids) {
+    getGroupVnid(*agent.getPolicyManager().getSnapshot(), uris, ids);
+}
+
+void IntFlowManager::getGroupVnid(const PolicyManager::Snapshot& policy,
+                                  const unordered_set<URI>& uris,
+                                  /* out */unordered_set<uint32_t>& ids) {
     PolicyManager& pm = agent.getPolicyManager();
     for (const URI& u : uris) {
-        optional<uint32_t> vnid = pm.getVnidForGroup(u);
+        shared_ptr<const PolicyManager::Snapshot::GroupInfo> group =
+            policy.getGroup(u);
+        optional<uint32_t> vnid;
         optional<shared_ptr<RoutingDomain> > rd;
-        if (vnid) {
-            rd = pm.getRDForGroup(u);
+        if (group && group->vnid) {
+            vnid = group->vnid;
+            rd = group->routingDomain;
         } else {
             rd = pm.getRDForL3ExtNet(u);
             if (rd) {
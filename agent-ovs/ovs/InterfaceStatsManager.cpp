@@ -38,7 +38,8 @@ InterfaceStatsManager::InterfaceStatsManager(Agent* agent_,
       accessPortMapper(accessPortMapper_),
       intConnection(NULL), accessConnection(NULL),
       agent_io(agent_->getAgentIOService()),
-      timer_interval(timer_interval_), stopping(false) {
+      timer_interval(timer_interval_), statsExecutor("interface stats"),
+      stopping(false) {
 }
 
 InterfaceStatsManager::~InterfaceStatsManager() {
@@ -62,6 +63,7 @@ void InterfaceStatsManager::start() {
     LOG(DEBUG) << "Starting interface stats manager ("
                << timer_interval << " ms)";
 
+    statsExecutor.start();
     if (intConnection)
         intConnection->RegisterMessageHandler(OFPTYPE_PORT_STATS_REPLY, this);
     if (accessConnection) {
@@ -86,10 +88,19 @@ void InterfaceStatsManager::stop() {
                                                              this);
         agent->getEndpointManager().unregisterListener(this);
     }
+    statsExecutor.stop();
 
     if (timer) {
         timer->cancel();
     }
+
+#ifdef HAVE_PROMETHEUS_SUPPORT
+    for (SwitchConnection* conn : {intConnection, accessConnection}) {
+        if (conn)
+            agent->getPrometheusManager()
+                .removeSendQueueGauge(conn->getSwitchName());
+    }
+#endif
 }
 
 void InterfaceStatsManager::endpointUpdated(const std::string& uuid) {
@@ -99,6 +110,28 @@ void InterfaceStatsManager::endpointUpdated(const std::string& uuid) {
     }
 }
 
+void InterfaceStatsManager::
+updateSendQueueStats(SwitchConnection* connection) {
+    SwitchConnection::SendQueueStats stats = connection->getSendQueueStats();
+    uint64_t avgLatencyUs =
+        stats.sent ? stats.totalLatencyUs / stats.sent : 0;
+    LOG(DEBUG) << "Send queue for " << connection->getSwitchName()
+               << ": depth=" << stats.depth
+               << " max-depth=" << stats.maxDepth
+               << " sent=" << stats.sent
+               << " dropped=" << stats.dropped
+               << " blocked=" << stats.blocked
+               << " avg-latency-us=" << avgLatencyUs
+               << " max-latency-us=" << stats.maxLatencyUs;
+#ifdef HAVE_PROMETHEUS_SUPPORT
+    agent->getPrometheusManager()
+        .addNUpdateSendQueueGauge(connection->getSwitchName(),
+                                  stats.depth, stats.maxDepth,
+                                  stats.sent, stats.dropped, stats.blocked,
+                                  avgLatencyUs, stats.maxLatencyUs);
+#endif
+}
+
 void InterfaceStatsManager::on_timer(const error_code& ec) {
     if (ec) {
         // shut down the timer when we get a cancellation
@@ -106,6 +139,11 @@ void InterfaceStatsManager::on_timer(const error_code& ec) {
         return;
     }
 
+    if (intConnection)
+        updateSendQueueStats(intConnection);
+    if (accessConnection)
+        updateSendQueueStats(accessConnection);
+
     // send port stats request
     if (intConnection) {
         OfpBuf intPortStatsReq(ofputil_encode_dump_ports_request(
@@ -0,0 +1,279 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for IpfixCollector class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "IpfixCollector.h"
+#include <opflexagent/logging.h>
+
+#include <boost/asio/placeholders.hpp>
+#include <boost/bind.hpp>
+
+namespace opflexagent {
+
+using boost::asio::ip::address;
+using boost::asio::ip::address_v4;
+using boost::asio::ip::address_v6;
+using boost::asio::ip::udp;
+
+namespace ipfix {
+static const uint16_t VERSION = 10;
+static const size_t MSG_HDR_LEN = 16;
+static const size_t SET_HDR_LEN = 4;
+static const uint16_t TEMPLATE_SET = 2;
+static const uint16_t OPTIONS_TEMPLATE_SET = 3;
+static const uint16_t MIN_DATA_SET = 256;
+static const uint16_t VARLEN = 65535;
+
+// information elements (RFC 7012)
+static const uint16_t OCTET_DELTA_COUNT = 1;
+static const uint16_t PACKET_DELTA_COUNT = 2;
+static const uint16_t SOURCE_IPV4_ADDRESS = 8;
+static const uint16_t DESTINATION_IPV4_ADDRESS = 12;
+static const uint16_t SOURCE_IPV6_ADDRESS = 27;
+static const uint16_t DESTINATION_IPV6_ADDRESS = 28;
+static const uint16_t OBSERVATION_POINT_ID = 138;
+static const uint16_t LAYER2_OCTET_DELTA_COUNT = 352;
+} /* namespace ipfix */
+
+static uint16_t get16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)get16(p) << 16) | get16(p + 2);
+}
+
+// unsigned integers may be exported with reduced-size encoding
+static uint64_t getUint(const uint8_t* p, size_t len) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < len && i < 8; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t templateKey(uint32_t domain, uint16_t templateId) {
+    return ((uint64_t)domain << 16) | templateId;
+}
+
+IpfixCollector::IpfixCollector(boost::asio::io_service& io_service,
+                               const record_cb_t& callback_)
+    : socket(io_service), callback(callback_), stopped(true),
+      malformed(0) {}
+
+bool IpfixCollector::start(const address& addr, uint16_t port) {
+    boost::system::error_code ec;
+    udp::endpoint local(addr, port);
+    socket.open(local.protocol(), ec);
+    if (!ec)
+        socket.set_option(boost::asio::socket_base::reuse_address(true), ec);
+    if (!ec)
+        socket.bind(local, ec);
+    if (ec) {
+        LOG(ERROR) << "Could not listen for IPFIX on " << local
+                   << ": " << ec.message();
+        socket.close(ec);
+        return false;
+    }
+    LOG(INFO) << "Listening for IPFIX on " << local;
+    stopped = false;
+    startReceive();
+    return true;
+}
+
+void IpfixCollector::stop() {
+    boost::system::error_code ec;
+    stopped = true;
+    socket.cancel(ec);
+    socket.close(ec);
+}
+
+void IpfixCollector::startReceive() {
+    socket.async_receive_from(boost::asio::buffer(buffer), remoteEndpoint,
+                              boost::bind(&IpfixCollector::handleReceive,
+                                          this,
+                                          boost::asio::placeholders::error,
+                                          boost::asio::placeholders::
+                                          bytes_transferred));
+}
+
+void IpfixCollector::handleReceive(const boost::system::error_code& ec,
+                                   size_t bytes) {
+    if (stopped || ec == boost::asio::error::operation_aborted)
+        return;
+    if (ec) {
+        LOG(WARNING) << "Error receiving IPFIX message: " << ec.message();
+    } else if (!handleMessage(buffer.data(), bytes)) {
+        LOG(DEBUG) << "Malformed IPFIX message from " << remoteEndpoint;
+    }
+    startReceive();
+}
+
+bool IpfixCollector::handleMessage(const uint8_t* data, size_t len) {
+    if (len < ipfix::MSG_HDR_LEN || get16(data) != ipfix::VERSION ||
+        get16(data + 2) > len || get16(data + 2) < ipfix::MSG_HDR_LEN) {
+        malformed += 1;
+        return false;
+    }
+    const uint8_t* end = data + get16(data + 2);
+    uint32_t domain = get32(data + 12);
+
+    const uint8_t* p = data + ipfix::MSG_HDR_LEN;
+    while (p + ipfix::SET_HDR_LEN <= end) {
+        uint16_t setId = get16(p);
+        uint16_t setLen = get16(p + 2);
+        if (setLen < ipfix::SET_HDR_LEN || p + setLen > end) {
+            malformed += 1;
+            return false;
+        }
+        const uint8_t* setEnd = p + setLen;
+        bool ok = true;
+        if (setId == ipfix::TEMPLATE_SET ||
+            setId == ipfix::OPTIONS_TEMPLATE_SET) {
+            ok = handleTemplateSet(domain, p + ipfix::SET_HDR_LEN, setEnd,
+                                   setId == ipfix::OPTIONS_TEMPLATE_SET);
+        } else if (setId >= ipfix::MIN_DATA_SET) {
+            ok = handleDataSet(domain, setId, p + ipfix::SET_HDR_LEN, setEnd);
+        }
+        if (!ok) {
+            malformed += 1;
+            return false;
+        }
+        p = setEnd;
+    }
+    return true;
+}
+
+bool IpfixCollector::handleTemplateSet(uint32_t domain, const uint8_t* p,
+                                       const uint8_t* end, bool options) {
+    const size_t hdrLen = options ? 6 : 4;
+    while (p + hdrLen <= end) {
+        uint16_t templateId = get16(p);
+        uint16_t fieldCount = get16(p + 2);
+        p += hdrLen;
+        if (templateId < ipfix::MIN_DATA_SET)
+            return false;
+
+        std::vector<Field> fields;
+        fields.reserve(fieldCount);
+        for (uint16_t i = 0; i < fieldCount; ++i) {
+            if (p + 4 > end)
+                return false;
+            Field f;
+            f.id = get16(p) & 0x7fff;
+            f.enterprise = (get16(p) & 0x8000) != 0;
+            f.length = get16(p + 2);
+            p += 4;
+            if (f.enterprise) {
+                if (p + 4 > end)
+                    return false;
+                p += 4;
+            }
+            fields.push_back(f);
+        }
+
+        uint64_t key = templateKey(domain, templateId);
+        if (fieldCount == 0)
+            // a template withdrawal
+            templates.erase(key);
+        else
+            templates[key] = std::move(fields);
+    }
+    return true;
+}
+
+bool IpfixCollector::handleDataSet(uint32_t domain, uint16_t setId,
+                                   const uint8_t* p, const uint8_t* end) {
+    auto it = templates.find(templateKey(domain, setId));
+    if (it == templates.end())
+        // can't decode records until the template arrives
+        return true;
+    const std::vector<Field>& fields = it->second;
+
+    size_t minLen = 0;
+    for (const Field& f : fields)
+        minLen += (f.length == ipfix::VARLEN) ? 1 : f.length;
+    if (minLen == 0)
+        return false;
+
+    // anything shorter than a record at the end of the set is padding
+    while (p + minLen <= end) {
+        Record r{};
+        r.observationDomain = domain;
+        uint64_t l3Octets = 0, l2Octets = 0;
+        bool haveL3Octets = false;
+
+        for (const Field& f : fields) {
+            size_t flen = f.length;
+            if (flen == ipfix::VARLEN) {
+                if (p + 1 > end)
+                    return false;
+                flen = *p++;
+                if (flen == 255) {
+                    if (p + 2 > end)
+                        return false;
+                    flen = get16(p);
+                    p += 2;
+                }
+            }
+            if (p + flen > end)
+                return false;
+
+            if (!f.enterprise) {
+                switch (f.id) {
+                case ipfix::OCTET_DELTA_COUNT:
+                    l3Octets = getUint(p, flen);
+                    haveL3Octets = true;
+                    break;
+                case ipfix::LAYER2_OCTET_DELTA_COUNT:
+                    l2Octets = getUint(p, flen);
+                    break;
+                case ipfix::PACKET_DELTA_COUNT:
+                    r.packets = getUint(p, flen);
+                    break;
+                case ipfix::OBSERVATION_POINT_ID:
+                    r.observationPoint = (uint32_t)getUint(p, flen);
+                    break;
+                case ipfix::SOURCE_IPV4_ADDRESS:
+                case ipfix::DESTINATION_IPV4_ADDRESS:
+                    if (flen == 4) {
+                        address a = address_v4(get32(p));
+                        if (f.id == ipfix::SOURCE_IPV4_ADDRESS)
+                            r.srcAddr = a;
+                        else
+                            r.dstAddr = a;
+                    }
+                    break;
+                case ipfix::SOURCE_IPV6_ADDRESS:
+                case ipfix::DESTINATION_IPV6_ADDRESS:
+                    if (flen == 16) {
+                        address_v6::bytes_type b;
+                        std::copy(p, p + 16, b.begin());
+                        address a = address_v6(b);
+                        if (f.id == ipfix::SOURCE_IPV6_ADDRESS)
+                            r.srcAddr = a;
+                        else
+                            r.dstAddr = a;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+            p += flen;
+        }
+
+        r.bytes = haveL3Octets ? l3Octets : l2Octets;
+        if (callback)
+            callback(r);
+    }
+    return true;
+}
+
+} /* namespace opflexagent */
@@ -146,6 +146,56 @@ bool JsonRpc::deleteIpfix(const string& brName) {
     return true;
 }
 
+bool JsonRpc::createFlowSampleCollectorSet(const string& brUuid, uint32_t id,
+                                           const string& target) {
+    vector<TupleData> tuples;
+    tuples.emplace_back("", target);
+    TupleDataSet tdSet(tuples);
+    JsonRpcTransactMessage msg1(OvsdbOperation::INSERT, OvsdbTable::IPFIX);
+    msg1.rowData.emplace("targets", tdSet);
+    const string uuid_name = "ipfix_sample";
+    msg1.kvPairs.emplace_back("uuid-name", uuid_name);
+
+    JsonRpcTransactMessage msg2(OvsdbOperation::INSERT,
+                                OvsdbTable::FLOW_SAMPLE_COLLECTOR_SET);
+    tuples.clear();
+    tuples.emplace_back("", (int)id);
+    tdSet = TupleDataSet(tuples);
+    msg2.rowData.emplace("id", tdSet);
+
+    tuples.clear();
+    tuples.emplace_back("uuid", brUuid);
+    tdSet = TupleDataSet(tuples);
+    msg2.rowData.emplace("bridge", tdSet);
+
+    tuples.clear();
+    tuples.emplace_back("named-uuid", uuid_name);
+    tdSet = TupleDataSet(tuples);
+    msg2.rowData.emplace("ipfix", tdSet);
+
+    const list<JsonRpcTransactMessage> requests = {msg1, msg2};
+    if (!sendRequestAndAwaitResponse(requests)) {
+        LOG(DEBUG) << "Error sending message";
+        return false;
+    }
+    return true;
+}
+
+bool JsonRpc::deleteFlowSampleCollectorSets(const string& brUuid) {
+    JsonRpcTransactMessage msg1(OvsdbOperation::DELETE,
+                                OvsdbTable::FLOW_SAMPLE_COLLECTOR_SET);
+    set<tuple<string, OvsdbFunction, string>> condSet;
+    condSet.emplace("bridge", OvsdbFunction::EQ, brUuid);
+    msg1.conditions = condSet;
+
+    const list<JsonRpcTransactMessage> requests = {msg1};
+    if (!sendRequestAndAwaitResponse(requests)) {
+        LOG(DEBUG) << "Error sending message";
+        return false;
+    }
+    return true;
+}
+
 bool JsonRpc::updateBridgePorts(const string& brName, const string& portUuid, bool addToList) {
     JsonRpcTransactMessage msg1(OvsdbOperation::MUTATE, OvsdbTable::BRIDGE);
     set<tuple<string, OvsdbFunction, string>> condSet;
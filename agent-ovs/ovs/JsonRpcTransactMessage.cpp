@@ -35,7 +35,8 @@ static const char* toString(OvsdbOperation operation) {
     return OvsdbOperationStrings[static_cast<uint32_t>(operation)];
 }
 
-static const char* OvsdbTableStrings[] = {"Port", "Interface", "Bridge", "IPFIX", "NetFlow", "Mirror"};
+static const char* OvsdbTableStrings[] = {"Port", "Interface", "Bridge", "IPFIX", "NetFlow", "Mirror",
+                                          "Flow_Sample_Collector_Set"};
 
 static const char* toString(OvsdbTable table) {
     return OvsdbTableStrings[static_cast<uint32_t>(table)];
@@ -112,7 +113,8 @@ bool JsonRpcTransactMessage::operator()(rapidjson::Writer<T> & writer) {
                 writer.String(toString(get<1>(elem)));
                 string rhs = get<2>(elem);
                 if (lhs == "_uuid" ||
-                        lhs == "mirrors") {
+                        lhs == "mirrors" ||
+                        lhs == "bridge") {
                     writer.StartArray();
                     writer.String("uuid");
                     writer.String(rhs.c_str());
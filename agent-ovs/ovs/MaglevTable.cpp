@@ -0,0 +1,120 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for MaglevTable class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "MaglevTable.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+namespace opflexagent {
+
+const uint32_t MaglevTable::DEFAULT_SIZE;
+
+// FNV-1a, so that tables don't change across agent restarts or
+// standard library versions
+static uint64_t hashName(const std::string& name, uint64_t seed) {
+    uint64_t h = 14695981039346656037ULL ^ seed;
+    for (unsigned char c : name) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    // finalize so that similar names spread over the table
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static const uint64_t OFFSET_SEED = 0;
+static const uint64_t SKIP_SEED = 0x9e3779b97f4a7c15ULL;
+static const uint64_t LINK_SEED = 0xc2b2ae3d27d4eb4fULL;
+
+bool MaglevTable::isPrime(uint32_t n) {
+    if (n < 2)
+        return false;
+    for (uint32_t d = 2; (uint64_t)d * d <= n; ++d) {
+        if (n % d == 0)
+            return false;
+    }
+    return true;
+}
+
+uint32_t MaglevTable::nextPrime(uint32_t n) {
+    while (!isPrime(n))
+        n += 1;
+    return n;
+}
+
+// visit the backends in name order so the table doesn't depend on
+// the order in which they are listed
+static std::vector<size_t> byName(const std::vector<std::string>& backends) {
+    std::vector<size_t> order(backends.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&backends](size_t a, size_t b) {
+                  return backends[a] < backends[b];
+              });
+    return order;
+}
+
+void MaglevTable::populate(const std::vector<std::string>& backends,
+                           uint32_t size, std::vector<uint32_t>& table) {
+    table.clear();
+    if (backends.empty() || size == 0)
+        return;
+
+    const uint32_t unset = static_cast<uint32_t>(-1);
+    table.assign(size, unset);
+
+    std::vector<size_t> order = byName(backends);
+    std::vector<uint32_t> offset(backends.size());
+    std::vector<uint32_t> skip(backends.size());
+    std::vector<uint32_t> next(backends.size(), 0);
+    for (size_t i : order) {
+        offset[i] = hashName(backends[i], OFFSET_SEED) % size;
+        skip[i] = (size > 1)
+            ? hashName(backends[i], SKIP_SEED) % (size - 1) + 1
+            : 1;
+    }
+
+    uint32_t filled = 0;
+    for (;;) {
+        for (size_t i : order) {
+            uint32_t slot;
+            do {
+                slot = (uint32_t)((offset[i] +
+                                   (uint64_t)next[i] * skip[i]) % size);
+                next[i] += 1;
+            } while (table[slot] != unset);
+
+            table[slot] = i;
+            if (++filled == size)
+                return;
+        }
+    }
+}
+
+void MaglevTable::getLinkIds(const std::vector<std::string>& backends,
+                             uint32_t size, std::vector<uint32_t>& ids) {
+    // keep identifiers in 31 bits, above the slot numbers
+    const uint32_t range = 0x7fffffff - size;
+    ids.assign(backends.size(), 0);
+    std::unordered_set<uint32_t> used;
+    for (size_t i : byName(backends)) {
+        uint32_t id = (uint32_t)(hashName(backends[i], LINK_SEED) % range);
+        while (!used.insert(id).second)
+            id = (id + 1) % range;
+        ids[i] = size + id;
+    }
+}
+
+} /* namespace opflexagent */
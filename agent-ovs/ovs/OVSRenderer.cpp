@@ -74,13 +74,25 @@ OVSRenderer::OVSRenderer(Agent& agent_)
       endpointAdvMode(AdvertManager::EPADV_GRATUITOUS_BROADCAST),
       tunnelEndpointAdvMode(AdvertManager::EPADV_RARP_BROADCAST),
       tunnelEndpointAdvIntvl(300),
+      endpointAdvBatchSize(AdvertManager::DEFAULT_ADV_BATCH_SIZE),
+      endpointAdvPacingWindow(AdvertManager::DEFAULT_ADV_PACING_WINDOW),
       virtualDHCP(true), connTrack(true), ctZoneRangeStart(0),
-      ctZoneRangeEnd(0), ovsdbUseLocalTcpPort(false), ifaceStatsEnabled(true), ifaceStatsInterval(0),
+      ctZoneRangeEnd(0), maglevTableSize(0),
+      pktInThreads(PacketInHandler::DEFAULT_THREADS),
+      pktInQueueDepth(PacketInHandler::DEFAULT_QUEUE_DEPTH),
+      pktInPortRate(PacketInHandler::DEFAULT_PORT_RATE),
+      pktInPortBurst(PacketInHandler::DEFAULT_PORT_BURST),
+      flowBatchMaxEdits(SwitchManager::DEFAULT_FLOW_BATCH_MAX_EDITS),
+      flowBatchMaxDelay(SwitchManager::DEFAULT_FLOW_BATCH_MAX_DELAY),
+      ovsdbUseLocalTcpPort(false), ifaceStatsEnabled(true), ifaceStatsInterval(0),
       contractStatsEnabled(true), contractStatsInterval(0),
       serviceStatsFlowDisabled(false), serviceStatsEnabled(true), serviceStatsInterval(0),
+      podSvcSampled(false), podSvcSamplingRate(1000),
+      podSvcCollectorPort(4739), podSvcTopK(1000), podSvcSketchSize(4000),
       secGroupStatsEnabled(true), secGroupStatsInterval(0),
       tableDropStatsEnabled(true), tableDropStatsInterval(0),
-      spanRenderer(agent_), netflowRenderer(agent_), started(false),
+      spanRenderer(agent_), netflowRenderer(agent_),
+      podSvcSampler(agent_, intFlowManager), started(false),
       dropLogRemotePort(6081), dropLogLocalPort(50000), pktLogger(pktLoggerIO, exporterIO) {
 
 }
@@ -143,8 +155,11 @@ void OVSRenderer::start() {
     intFlowManager.setVirtualRouter(virtualRouter, routerAdv, virtualRouterMac);
     intFlowManager.setVirtualDHCP(virtualDHCP, virtualDHCPMac);
     intFlowManager.setMulticastGroupFile(mcastGroupFile);
+    intFlowManager.setMaglevTableSize(maglevTableSize);
     intFlowManager.setEndpointAdv(endpointAdvMode, tunnelEndpointAdvMode,
             tunnelEndpointAdvIntvl);
+    intFlowManager.setEndpointAdvPacing(endpointAdvBatchSize,
+                                        endpointAdvPacingWindow);
     if(!dropLogIntIface.empty()) {
         intFlowManager.setDropLog(dropLogIntIface, dropLogRemoteIp,
                 dropLogRemotePort);
@@ -154,9 +169,20 @@ void OVSRenderer::start() {
                         dropLogRemotePort);
     }
 
+    if (podSvcSampled) {
+        podSvcSampler.setConfig(podSvcSamplingRate, podSvcCollectorPort,
+                                podSvcTopK, podSvcSketchSize,
+                                serviceStatsInterval);
+        intFlowManager.setPodSvcSampling(podSvcSampler.getProbability(),
+                                         PodSvcSampler::COLLECTOR_SET_ID);
+    }
+
+    intSwitchManager.setFlowBatching(flowBatchMaxEdits, flowBatchMaxDelay);
     intSwitchManager.registerStateHandler(&intFlowManager);
     intSwitchManager.start(intBridgeName);
     if (accessBridgeName != "") {
+        accessSwitchManager.setFlowBatching(flowBatchMaxEdits,
+                                            flowBatchMaxDelay);
         accessSwitchManager.registerStateHandler(&accessFlowManager);
         accessSwitchManager.start(accessBridgeName);
     }
@@ -176,6 +202,8 @@ void OVSRenderer::start() {
                                ? &accessSwitchManager.getPortMapper()
                                : NULL);
     pktInHandler.setFlowReader(&intSwitchManager.getFlowReader());
+    pktInHandler.setWorkerPool(pktInThreads, pktInQueueDepth);
+    pktInHandler.setPortRateLimit(pktInPortRate, pktInPortBurst);
     pktInHandler.start();
 
     if (ifaceStatsEnabled) {
@@ -242,6 +270,8 @@ void OVSRenderer::start() {
     if (getAgent().isFeatureEnabled(FeatureList::ERSPAN))
         spanRenderer.start(intBridgeName, ovsdbConnection.get());
     netflowRenderer.start(intBridgeName, ovsdbConnection.get());
+    if (podSvcSampled)
+        podSvcSampler.start(intBridgeName, ovsdbConnection.get());
 }
 
 void OVSRenderer::stop() {
@@ -275,6 +305,8 @@ void OVSRenderer::stop() {
     if (getAgent().isFeatureEnabled(FeatureList::ERSPAN))
         spanRenderer.stop();
     netflowRenderer.stop();
+    if (podSvcSampled)
+        podSvcSampler.stop();
 
     ovsdbConnection->stop();
 
@@ -340,6 +372,10 @@ void OVSRenderer::setProperties(const ptree& properties) {
                                "endpoint-advertisements.tunnel-endpoint-mode");
     static const std::string ENDPOINT_TNL_ADV_INTVL("forwarding."
                                    "endpoint-advertisements.tunnel-endpoint-interval");
+    static const std::string ENDPOINT_ADV_BATCH_SIZE("forwarding."
+                                   "endpoint-advertisements.batch-size");
+    static const std::string ENDPOINT_ADV_PACING_WINDOW("forwarding."
+                                   "endpoint-advertisements.pacing-window");
 
     static const std::string FLOWID_CACHE_DIR("flowid-cache-dir");
     static const std::string MCAST_GROUP_FILE("mcast-group-file");
@@ -352,6 +388,23 @@ void OVSRenderer::setProperties(const ptree& properties) {
     static const std::string CONN_TRACK_RANGE_END("forwarding."
                                                   "connection-tracking."
                                                   "zone-range.end");
+    static const std::string SERVICE_LB_MODE("forwarding."
+                                             "service-load-balancing.mode");
+    static const std::string SERVICE_LB_MAGLEV_SIZE("forwarding."
+                                                    "service-load-balancing."
+                                                    "maglev-table-size");
+    static const std::string PACKET_IN_THREADS("forwarding.packet-in."
+                                               "threads");
+    static const std::string PACKET_IN_QUEUE_DEPTH("forwarding.packet-in."
+                                                   "queue-depth");
+    static const std::string PACKET_IN_PORT_RATE("forwarding.packet-in."
+                                                 "port-rate");
+    static const std::string PACKET_IN_PORT_BURST("forwarding.packet-in."
+                                                  "port-burst");
+    static const std::string FLOW_BATCH_MAX_EDITS("forwarding.flow-batching."
+                                                  "max-edits");
+    static const std::string FLOW_BATCH_MAX_DELAY("forwarding.flow-batching."
+                                                  "max-delay");
 
     static const std::string STATS_INTERFACE_ENABLED("statistics"
                                                      ".interface.enabled");
@@ -367,6 +420,18 @@ void OVSRenderer::setProperties(const ptree& properties) {
                                                   ".service.enabled");
     static const std::string STATS_SERVICE_INTERVAL("statistics"
                                                    ".service.interval");
+    static const std::string STATS_SERVICE_PODSVC_MODE("statistics"
+                                                       ".service.pod-svc-mode");
+    static const std::string STATS_SERVICE_SAMPLING_RATE("statistics"
+                                                         ".service"
+                                                         ".sampling-rate");
+    static const std::string STATS_SERVICE_COLLECTOR_PORT("statistics"
+                                                          ".service"
+                                                          ".collector-port");
+    static const std::string STATS_SERVICE_TOP_K("statistics"
+                                                 ".service.top-k");
+    static const std::string STATS_SERVICE_SKETCH_SIZE("statistics"
+                                                       ".service.sketch-size");
     static const std::string STATS_SECGROUP_ENABLED("statistics"
                                                     ".security-group.enabled");
     static const std::string STATS_SECGROUP_INTERVAL("statistics"
@@ -473,11 +538,49 @@ void OVSRenderer::setProperties(const ptree& properties) {
     tunnelEndpointAdvIntvl =
         properties.get<uint64_t>(ENDPOINT_TNL_ADV_INTVL,
                                     300);
+    endpointAdvBatchSize =
+        properties.get<size_t>(ENDPOINT_ADV_BATCH_SIZE,
+                               AdvertManager::DEFAULT_ADV_BATCH_SIZE);
+    endpointAdvPacingWindow =
+        properties.get<uint64_t>(ENDPOINT_ADV_PACING_WINDOW,
+                                 AdvertManager::DEFAULT_ADV_PACING_WINDOW);
 
     connTrack = properties.get<bool>(CONN_TRACK, true);
     ctZoneRangeStart = properties.get<uint16_t>(CONN_TRACK_RANGE_START, 1);
     ctZoneRangeEnd = properties.get<uint16_t>(CONN_TRACK_RANGE_END, 65534);
 
+    const std::string& serviceLbMode =
+        properties.get<std::string>(SERVICE_LB_MODE, "hash");
+    if (serviceLbMode == "maglev") {
+        maglevTableSize =
+            properties.get<uint32_t>(SERVICE_LB_MAGLEV_SIZE,
+                                     MaglevTable::DEFAULT_SIZE);
+    } else {
+        if (serviceLbMode != "hash")
+            LOG(WARNING) << "Invalid service load balancing mode: "
+                         << serviceLbMode << "; using hash";
+        maglevTableSize = 0;
+    }
+
+    pktInThreads =
+        properties.get<size_t>(PACKET_IN_THREADS,
+                               PacketInHandler::DEFAULT_THREADS);
+    pktInQueueDepth =
+        properties.get<size_t>(PACKET_IN_QUEUE_DEPTH,
+                               PacketInHandler::DEFAULT_QUEUE_DEPTH);
+    pktInPortRate =
+        properties.get<uint32_t>(PACKET_IN_PORT_RATE,
+                                 PacketInHandler::DEFAULT_PORT_RATE);
+    pktInPortBurst =
+        properties.get<uint32_t>(PACKET_IN_PORT_BURST,
+                                 PacketInHandler::DEFAULT_PORT_BURST);
+    flowBatchMaxEdits =
+        properties.get<size_t>(FLOW_BATCH_MAX_EDITS,
+                               SwitchManager::DEFAULT_FLOW_BATCH_MAX_EDITS);
+    flowBatchMaxDelay =
+        properties.get<long>(FLOW_BATCH_MAX_DELAY,
+                             SwitchManager::DEFAULT_FLOW_BATCH_MAX_DELAY);
+
     flowIdCache = properties.get<std::string>(FLOWID_CACHE_DIR,
                                               DEF_FLOWID_CACHEDIR);
 
@@ -502,6 +605,35 @@ void OVSRenderer::setProperties(const ptree& properties) {
         properties.get<long>(STATS_SECGROUP_INTERVAL, 10000);
     tableDropStatsInterval =
         properties.get<long>(TABLE_DROP_STATS_INTERVAL, 30000);
+
+    const std::string& podSvcMode =
+        properties.get<std::string>(STATS_SERVICE_PODSVC_MODE, "exact");
+    if (podSvcMode == "sampled") {
+        podSvcSampled = true;
+    } else {
+        if (podSvcMode != "exact")
+            LOG(WARNING) << "Invalid pod<-->svc stats mode: " << podSvcMode
+                         << "; using exact";
+        podSvcSampled = false;
+    }
+    podSvcSamplingRate =
+        properties.get<uint32_t>(STATS_SERVICE_SAMPLING_RATE, 1000);
+    podSvcCollectorPort =
+        properties.get<uint16_t>(STATS_SERVICE_COLLECTOR_PORT, 4739);
+    podSvcTopK = properties.get<size_t>(STATS_SERVICE_TOP_K, 1000);
+    podSvcSketchSize =
+        properties.get<size_t>(STATS_SERVICE_SKETCH_SIZE, 4 * podSvcTopK);
+    if (podSvcSampled && podSvcSamplingRate == 0) {
+        LOG(WARNING) << "Invalid pod<-->svc sampling rate 0; using 1";
+        podSvcSamplingRate = 1;
+    } else if (podSvcSampled &&
+               podSvcSamplingRate > PodSvcSampler::MAX_SAMPLING_RATE) {
+        LOG(WARNING) << "Invalid pod<-->svc sampling rate "
+                     << podSvcSamplingRate << "; using "
+                     << PodSvcSampler::MAX_SAMPLING_RATE;
+        podSvcSamplingRate = PodSvcSampler::MAX_SAMPLING_RATE;
+    }
+
     if (ifaceStatsInterval <= 0) {
         ifaceStatsEnabled = false;
     }
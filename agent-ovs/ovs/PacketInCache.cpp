@@ -0,0 +1,132 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for PacketInCache class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "PacketInCache.h"
+
+namespace opflexagent {
+
+using std::string;
+using opflex::modb::MAC;
+using opflex::modb::URI;
+
+typedef std::lock_guard<std::mutex> mutex_guard;
+
+PacketInCache::PacketInCache()
+    : generation(0), hits(0), misses(0) {}
+
+PacketInCache::ep_entry_ptr
+PacketInCache::getEndpoint(const string& iface, const MAC& mac) {
+    mutex_guard lock(cacheMtx);
+    auto it = ifaceEntries.find(iface);
+    if (it != ifaceEntries.end()) {
+        auto mit = it->second.find(mac);
+        if (mit != it->second.end()) {
+            hits += 1;
+            return mit->second;
+        }
+    }
+    misses += 1;
+    return ep_entry_ptr();
+}
+
+void PacketInCache::putEndpoint(const string& iface, const MAC& mac,
+                                const ep_entry_ptr& entry,
+                                uint64_t gen) {
+    if (!entry || !entry->ep)
+        return;
+    mutex_guard lock(cacheMtx);
+    if (gen != generation)
+        return;
+
+    // an endpoint is only looked up on its own interface, but guard
+    // against stale entries if it moves
+    const string& uuid = entry->ep->getUUID();
+    auto uit = uuidIfaces.find(uuid);
+    if (uit != uuidIfaces.end() && uit->second != iface) {
+        eraseIface(uit->second);
+    }
+    uuidIfaces[uuid] = iface;
+    ifaceEntries[iface][mac] = entry;
+}
+
+PacketInCache::frame_ptr
+PacketInCache::getRouterAdvert(const URI& egUri, const MAC& srcMac) {
+    mutex_guard lock(cacheMtx);
+    auto it = routerAdverts.find(egUri);
+    if (it != routerAdverts.end()) {
+        auto mit = it->second.find(srcMac);
+        if (mit != it->second.end()) {
+            hits += 1;
+            return mit->second;
+        }
+    }
+    misses += 1;
+    return frame_ptr();
+}
+
+void PacketInCache::putRouterAdvert(const URI& egUri, const MAC& srcMac,
+                                    const frame_ptr& frame,
+                                    uint64_t gen) {
+    if (!frame)
+        return;
+    mutex_guard lock(cacheMtx);
+    if (gen != generation)
+        return;
+    routerAdverts[egUri][srcMac] = frame;
+}
+
+void PacketInCache::eraseIface(const string& iface) {
+    auto it = ifaceEntries.find(iface);
+    if (it == ifaceEntries.end())
+        return;
+    for (const auto& e : it->second) {
+        auto uit = uuidIfaces.find(e.second->ep->getUUID());
+        if (uit != uuidIfaces.end() && uit->second == iface)
+            uuidIfaces.erase(uit);
+    }
+    ifaceEntries.erase(it);
+}
+
+void PacketInCache::invalidateEndpoint(const string& uuid,
+                                       const boost::optional<string>& iface) {
+    mutex_guard lock(cacheMtx);
+    generation += 1;
+    auto uit = uuidIfaces.find(uuid);
+    if (uit != uuidIfaces.end()) {
+        // copy, since erasing the interface erases the mapping
+        string oldIface = uit->second;
+        eraseIface(oldIface);
+    }
+    if (iface)
+        eraseIface(iface.get());
+}
+
+void PacketInCache::invalidateGroup(const URI& egUri) {
+    mutex_guard lock(cacheMtx);
+    generation += 1;
+    routerAdverts.erase(egUri);
+}
+
+void PacketInCache::invalidateRouterAdverts() {
+    mutex_guard lock(cacheMtx);
+    generation += 1;
+    routerAdverts.clear();
+}
+
+void PacketInCache::clear() {
+    mutex_guard lock(cacheMtx);
+    generation += 1;
+    ifaceEntries.clear();
+    uuidIfaces.clear();
+    routerAdverts.clear();
+}
+
+} /* namespace opflexagent */
@@ -50,12 +50,30 @@ using modelgbp::gbp::Subnet;
 
 namespace opflexagent {
 
+const size_t PacketInHandler::DEFAULT_THREADS;
+const size_t PacketInHandler::DEFAULT_QUEUE_DEPTH;
+const uint32_t PacketInHandler::DEFAULT_PORT_RATE;
+const uint32_t PacketInHandler::DEFAULT_PORT_BURST;
+
 PacketInHandler::PacketInHandler(Agent& agent_,
                                  IntFlowManager& intFlowManager_)
     : agent(agent_), intFlowManager(intFlowManager_),
       intPortMapper(NULL), accessPortMapper(NULL),
       intFlowReader(NULL),
-      intSwConnection(NULL), accSwConnection(NULL) {}
+      intSwConnection(NULL), accSwConnection(NULL),
+      workerThreads(DEFAULT_THREADS),
+      pktInExecutor("packet-in", DEFAULT_THREADS, DEFAULT_QUEUE_DEPTH),
+      portLimiter(DEFAULT_PORT_RATE, DEFAULT_PORT_BURST),
+      rateLimited(0), cacheEnabled(false) {}
+
+void PacketInHandler::setWorkerPool(size_t threads, size_t queueDepth) {
+    workerThreads = threads;
+    pktInExecutor.setLimits(threads, queueDepth);
+}
+
+void PacketInHandler::setPortRateLimit(uint32_t rate, uint32_t burst) {
+    portLimiter.setRate(rate, burst);
+}
 
 void PacketInHandler::registerConnection(SwitchConnection* intConnection,
                                          SwitchConnection* accessConnection) {
@@ -70,6 +88,13 @@ void PacketInHandler::setPortMapper(PortMapper* intMapper,
 }
 
 void PacketInHandler::start() {
+    agent.getEndpointManager().registerListener(this);
+    agent.getPolicyManager().registerListener(this);
+    cache.clear();
+    cacheEnabled = true;
+
+    if (workerThreads > 0)
+        pktInExecutor.start();
     if (intSwConnection)
         intSwConnection->RegisterMessageHandler(OFPTYPE_PACKET_IN, this);
 }
@@ -77,6 +102,49 @@ void PacketInHandler::start() {
 void PacketInHandler::stop() {
     if (intSwConnection)
         intSwConnection->UnregisterMessageHandler(OFPTYPE_PACKET_IN, this);
+    pktInExecutor.stop();
+
+    cacheEnabled = false;
+    agent.getEndpointManager().unregisterListener(this);
+    agent.getPolicyManager().unregisterListener(this);
+    cache.clear();
+}
+
+void PacketInHandler::endpointUpdated(const std::string& uuid) {
+    optional<string> iface;
+    shared_ptr<const Endpoint> ep =
+        agent.getEndpointManager().getEndpoint(uuid);
+    if (ep)
+        iface = ep->getInterfaceName();
+    cache.invalidateEndpoint(uuid, iface);
+}
+
+void PacketInHandler::egDomainUpdated(const URI& egURI) {
+    cache.invalidateGroup(egURI);
+}
+
+void PacketInHandler::domainUpdated(opflex::modb::class_id_t,
+                                    const URI&) {
+    // routing domain settings and subnets feed into the router
+    // advertisements of any group
+    cache.invalidateRouterAdverts();
+}
+
+bool PacketInHandler::isRateLimited(const struct ofputil_packet_in& pi) {
+    // only the requests answered by the agent are limited; other
+    // packet-ins such as virtual IP announcements are cheap
+    if (pi.cookie != flow::cookie::DHCP_V4 &&
+        pi.cookie != flow::cookie::DHCP_V6 &&
+        pi.cookie != flow::cookie::NEIGH_DISC)
+        return false;
+
+    if (portLimiter.event(pi.flow_metadata.flow.in_port.ofp_port))
+        return false;
+    if (rateLimited++ == 0) {
+        LOG(WARNING) << "Rate limiting packet-ins from port "
+                     << pi.flow_metadata.flow.in_port.ofp_port;
+    }
+    return true;
 }
 
 typedef std::function<void (ActionBuilder&)> output_act_t;
@@ -145,33 +213,36 @@ static void send_packet_out(Agent& agent,
                             OfpBuf& b,
                             ofputil_protocol& proto,
                             uint32_t in_port,
-                            uint32_t out_port) {
+                            uint32_t out_port,
+                            const ep_ptr& knownEp = ep_ptr()) {
     string iface;
     opt_output_act_t outActions =
         tunnelOutActions(intFlowManager, egUri, out_port);
     opt_output_act_t outActionsSkipVlan;
     SwitchConnection* conn = intConn;
-    ep_ptr ep;
+    ep_ptr ep = knownEp;
     bool send_untagged = false;
 
     try {
-        if (out_port == OFPP_IN_PORT)
-            iface = intPortMapper->FindPort(in_port);
-        else
-            iface = intPortMapper->FindPort(out_port);
+        if (!ep) {
+            if (out_port == OFPP_IN_PORT)
+                iface = intPortMapper->FindPort(in_port);
+            else
+                iface = intPortMapper->FindPort(out_port);
+
+            unordered_set<string> eps;
+            agent.getEndpointManager().getEndpointsByIface(iface, eps);
+            if (eps.size() == 0) {
+                LOG(WARNING) << "No endpoint found for output packet"
+                             << " on " << iface;
+                return;
+            }
+            if (eps.size() > 1)
+                LOG(WARNING) << "Multiple possible endpoints for output"
+                             << " packet on " << iface;
 
-        unordered_set<string> eps;
-        agent.getEndpointManager().getEndpointsByIface(iface, eps);
-        if (eps.size() == 0) {
-            LOG(WARNING) << "No endpoint found for output packet"
-                         << " on " << iface;
-            return;
+            ep = agent.getEndpointManager().getEndpoint(*eps.begin());
         }
-        if (eps.size() > 1)
-            LOG(WARNING) << "Multiple possible endpoints for output packet "
-                         << " on " << iface;
-
-        ep = agent.getEndpointManager().getEndpoint(*eps.begin());
         if (ep && ep->getAccessInterface() && ep->getAccessUplinkInterface()) {
             if (!accConn || !accPortMapper) {
                 return;
@@ -220,6 +291,7 @@ static void send_packet_out(Agent& agent,
  * @param proto an openflow proto object
  * @param pkt the packet from the packet-in
  * @param flow the parsed flow from the packet
+ * @param cache the router advertisement cache, or NULL
  */
 static void handleNDPktIn(Agent& agent,
                           IntFlowManager& intFlowManager,
@@ -230,7 +302,8 @@ static void handleNDPktIn(Agent& agent,
                           struct ofputil_packet_in& pi,
                           ofputil_protocol& proto,
                           const struct dp_packet* pkt,
-                          struct flow& flow) {
+                          struct flow& flow,
+                          PacketInCache* cache) {
     uint32_t epgId = (uint32_t)pi.flow_metadata.flow.regs[0];
     PolicyManager& polMgr = agent.getPolicyManager();
     optional<URI> egUri = polMgr.getGroupForVnid(epgId);
@@ -282,12 +355,34 @@ static void handleNDPktIn(Agent& agent,
 
         LOG(DEBUG) << "Handling ICMPv6 router solicitation";
 
-        b = packets::compose_icmp6_router_ad(mac,
-                                             flow.dl_src.ea,
-                                             &flow.ipv6_src,
-                                             egUri.get(),
-                                             polMgr);
-        if (!b.get()) return;
+        // The advertisement only depends on the group and the
+        // source MAC, so it is built once and readdressed for each
+        // solicitation
+        MAC srcMac(mac);
+        PacketInCache::frame_ptr ra;
+        if (cache)
+            ra = cache->getRouterAdvert(egUri.get(), srcMac);
+        if (!ra) {
+            uint64_t generation = cache ? cache->getGeneration() : 0;
+            struct in6_addr unspecified;
+            memset(&unspecified, 0, sizeof(unspecified));
+            OfpBuf rab(packets::compose_icmp6_router_ad(mac,
+                                                        packets::MAC_ADDR_ZERO,
+                                                        &unspecified,
+                                                        egUri.get(),
+                                                        polMgr));
+            if (!rab.get()) return;
+            ra = std::make_shared<const vector<uint8_t> >
+                ((uint8_t*)rab.data(), (uint8_t*)rab.data() + rab.size());
+            if (cache)
+                cache->putRouterAdvert(egUri.get(), srcMac, ra, generation);
+        }
+
+        b = OfpBuf(ofpbuf_clone_data(ra->data(), ra->size()));
+        if (!packets::patch_icmp6_router_ad((uint8_t*)b.data(), b.size(),
+                                            flow.dl_src.ea,
+                                            &flow.ipv6_src))
+            return;
     }
 
     if (((uint8_t*)&metadata)[6] == 1) {
@@ -302,13 +397,82 @@ static void handleNDPktIn(Agent& agent,
     }
 }
 
+/**
+ * Resolve the state used to answer DHCP requests from a client of an
+ * endpoint, including a DHCPv4 reply with the options from the
+ * endpoint's configuration already encoded.
+ *
+ * @param intFlowManager the flow manager
+ * @param ep the endpoint
+ * @param srcMac the MAC address of the client
+ * @return the resolved state
+ */
+static PacketInCache::ep_entry_ptr
+resolveDHCPEntry(IntFlowManager& intFlowManager,
+                 const ep_ptr& ep,
+                 const MAC& srcMac) {
+    std::shared_ptr<PacketInCache::EndpointEntry> entry =
+        std::make_shared<PacketInCache::EndpointEntry>();
+    entry->ep = ep;
+    boost::system::error_code ec;
+
+    const optional<Endpoint::DHCPv4Config>& v4c = ep->getDHCPv4Config();
+    if (v4c && v4c.get().getIpAddress()) {
+        const string& dhcpIpStr = v4c.get().getIpAddress().get();
+        address_v4 dhcpIp = address_v4::from_string(dhcpIpStr, ec);
+        if (ec) {
+            LOG(INFO) << "bad ip " << dhcpIpStr << " " << ec.message();
+        } else {
+            uint8_t serverMac[6];
+            if (v4c.get().getServerMac()) {
+                v4c.get().getServerMac()->toUIntArray(serverMac);
+            } else {
+                memcpy(serverMac, intFlowManager.getDHCPMacAddr(),
+                       sizeof(serverMac));
+            }
+            uint8_t clientMac[6];
+            srcMac.toUIntArray(clientMac);
+
+            // the message type and transaction ID are filled in for
+            // each request
+            OfpBuf b(packets::compose_dhcpv4_reply
+                     (dhcp::message_type::OFFER,
+                      0,
+                      serverMac,
+                      clientMac,
+                      dhcpIp.to_ulong(),
+                      v4c.get().getPrefixLen().get_value_or(32),
+                      v4c.get().getServerIp(),
+                      v4c.get().getRouters(),
+                      v4c.get().getDnsServers(),
+                      v4c.get().getDomain(),
+                      v4c.get().getStaticRoutes(),
+                      v4c.get().getInterfaceMtu(),
+                      v4c.get().getLeaseTime()));
+            entry->dhcpv4Reply.assign((uint8_t*)b.data(),
+                                      (uint8_t*)b.data() + b.size());
+            entry->dhcpv4Ip = dhcpIp.to_ulong();
+        }
+    }
+
+    if (ep->getDHCPv6Config()) {
+        for (const string& addrStr : ep->getIPs()) {
+            address_v6 addr_v6 = address_v6::from_string(addrStr, ec);
+            if (ec) continue;
+            entry->dhcpv6Ips.push_back(addr_v6);
+        }
+    }
+
+    return entry;
+}
+
 static void handleDHCPv4PktIn(Agent& agent,
                               IntFlowManager& intFlowManager,
                               PortMapper* intPortMapper,
                               PortMapper* accPortMapper,
                               SwitchConnection* intConn,
                               SwitchConnection* accConn,
-                              const shared_ptr<const Endpoint>& ep,
+                              const PacketInCache::EndpointEntry& entry,
                               std::string iface,
                               struct ofputil_packet_in& pi,
                               ofputil_protocol& proto,
@@ -317,18 +481,8 @@ static void handleDHCPv4PktIn(Agent& agent,
     using namespace dhcp;
     using namespace udp;
 
-    const optional<Endpoint::DHCPv4Config>& v4c = ep->getDHCPv4Config();
-    if (!v4c) return;
-
-    const optional<string>& dhcpIpStr = v4c.get().getIpAddress();
-    if (!dhcpIpStr) return;
-
-    boost::system::error_code ec;
-    address_v4 dhcpIp = address_v4::from_string(dhcpIpStr.get(), ec);
-    if (ec) {
-        LOG(INFO) << "bad ip " << dhcpIpStr.get() << " " << ec.message();
-        return;
-    }
+    if (entry.dhcpv4Reply.empty()) return;
+    address_v4 dhcpIp(entry.dhcpv4Ip);
 
     size_t l4_size = dpp_l4_size(pkt);
     if (l4_size < (sizeof(struct udp_hdr) + sizeof(struct dhcp_hdr) + 1))
@@ -378,7 +532,6 @@ static void handleDHCPv4PktIn(Agent& agent,
 
     MAC srcMac(flow.dl_src.ea);
 
-    uint8_t prefixLen = v4c.get().getPrefixLen().get_value_or(32);
     uint8_t reply_type = message_type::NAK;
 
     switch(message_type) {
@@ -403,31 +556,16 @@ static void handleDHCPv4PktIn(Agent& agent,
         return;
     }
 
-    uint8_t serverMac[6];
-    if (v4c.get().getServerMac()) {
-        v4c.get().getServerMac()->toUIntArray(serverMac);
-    } else {
-        memcpy(serverMac, intFlowManager.getDHCPMacAddr(), sizeof(serverMac));
-    }
-
-    OfpBuf b(packets::compose_dhcpv4_reply(reply_type,
-                                           dhcp_pkt->xid,
-                                           serverMac,
-                                           flow.dl_src.ea,
-                                           dhcpIp.to_ulong(),
-                                           prefixLen,
-                                           v4c.get().getServerIp(),
-                                           v4c.get().getRouters(),
-                                           v4c.get().getDnsServers(),
-                                           v4c.get().getDomain(),
-                                           v4c.get().getStaticRoutes(),
-                                           v4c.get().getInterfaceMtu(),
-                                           v4c.get().getLeaseTime()));
+    OfpBuf b(ofpbuf_clone_data(entry.dhcpv4Reply.data(),
+                               entry.dhcpv4Reply.size()));
+    if (!packets::patch_dhcpv4_reply((uint8_t*)b.data(), b.size(),
+                                     reply_type, dhcp_pkt->xid))
+        return;
 
     send_packet_out(agent, intConn, accConn, intFlowManager,
                     intPortMapper, accPortMapper, URI::ROOT, b,
                     proto, OFPP_CONTROLLER,
-                    pi.flow_metadata.flow.in_port.ofp_port);
+                    pi.flow_metadata.flow.in_port.ofp_port, entry.ep);
 }
 
 static void handleDHCPv6PktIn(Agent& agent,
@@ -436,7 +574,7 @@ static void handleDHCPv6PktIn(Agent& agent,
                               PortMapper* accPortMapper,
                               SwitchConnection* intConn,
                               SwitchConnection* accConn,
-                              const shared_ptr<const Endpoint>& ep,
+                              const PacketInCache::EndpointEntry& entry,
                               struct ofputil_packet_in& pi,
                               ofputil_protocol& proto,
                               struct dp_packet* pkt,
@@ -444,18 +582,11 @@ static void handleDHCPv6PktIn(Agent& agent,
     using namespace dhcp6;
     using namespace udp;
 
-    const optional<Endpoint::DHCPv6Config>& v6c = ep->getDHCPv6Config();
+    const optional<Endpoint::DHCPv6Config>& v6c =
+        entry.ep->getDHCPv6Config();
     if (!v6c) return;
 
-    const unordered_set<string>& addresses = ep->getIPs();
-
-    boost::system::error_code ec;
-    vector<address_v6> v6addresses;
-    for (const string& addrStr : addresses) {
-        address_v6 addr_v6 = address_v6::from_string(addrStr, ec);
-        if (ec) continue;
-        v6addresses.push_back(addr_v6);
-    }
+    const vector<address_v6>& v6addresses = entry.dhcpv6Ips;
 
     size_t l4_size = dpp_l4_size(pkt);
     if (l4_size < (sizeof(struct udp_hdr) + sizeof(struct dhcp6_hdr) + 1))
@@ -560,7 +691,7 @@ static void handleDHCPv6PktIn(Agent& agent,
     send_packet_out(agent, intConn, accConn, intFlowManager,
                     intPortMapper, accPortMapper, URI::ROOT, b, proto,
                     OFPP_CONTROLLER,
-                    pi.flow_metadata.flow.in_port.ofp_port);
+                    pi.flow_metadata.flow.in_port.ofp_port, entry.ep);
 }
 
 typedef std::function<bool (const Endpoint&)> ep_pred;
@@ -585,6 +716,45 @@ static unordered_set<ep_ptr> findEpsForIface(EndpointManager& epMgr,
     return eps;
 }
 
+/*
+ * Find the endpoint that a DHCP client on an interface belongs to,
+ * and resolve the state used to answer it
+ */
+static PacketInCache::ep_entry_ptr
+findDHCPEntry(IntFlowManager& intFlowManager,
+              EndpointManager& epMgr,
+              const string& iface,
+              const MAC& srcMac) {
+    unordered_set<ep_ptr> eps =
+        findEpsForIface(epMgr, iface,
+                       [&srcMac](const Endpoint& ep) {
+                           const optional<MAC>& epMac = ep.getMAC();
+                           if (epMac && srcMac == epMac.get()) {
+                               return true;
+                           }
+                           const Endpoint::virt_ip_set& virtIps =
+                               ep.getVirtualIPs();
+
+                           for (const Endpoint::virt_ip_t& virt_ip : virtIps) {
+                               if (virt_ip.first == srcMac) {
+                                   return true;
+                               }
+                           }
+                           return false;
+                       });
+
+    if (eps.size() == 0) {
+        LOG(WARNING) << "No endpoint found for DHCP request from "
+                     << srcMac << " on " << iface;
+        return PacketInCache::ep_entry_ptr();
+    }
+    if (eps.size() > 1)
+        LOG(WARNING) << "Multiple possible endpoints for DHCP request from "
+                     << srcMac << " on " << iface;
+
+    return resolveDHCPEntry(intFlowManager, *eps.begin(), srcMac);
+}
+
 /**
  * Handle a packet-in for DHCP messages.  The reply is written as a
  * packet-out to the connection
@@ -598,7 +768,7 @@ static unordered_set<ep_ptr> findEpsForIface(EndpointManager& epMgr,
  * @param proto an openflow proto object
  * @param pkt the packet from the packet-in
  * @param flow the parsed flow from the packet
- * @param virtualDhcpMac the MAC address of the virtual DHCP server
+ * @param cache the cache of resolved endpoint state, or NULL
  */
 static void handleDHCPPktIn(bool v4,
                             Agent& agent,
@@ -610,7 +780,8 @@ static void handleDHCPPktIn(bool v4,
                             struct ofputil_packet_in& pi,
                             ofputil_protocol& proto,
                             struct dp_packet* pkt,
-                            struct flow& flow) {
+                            struct flow& flow,
+                            PacketInCache* cache) {
     if (!intPortMapper) return;
     EndpointManager& epMgr = agent.getEndpointManager();
 
@@ -623,43 +794,25 @@ static void handleDHCPPktIn(bool v4,
         return;
     }
 
-    unordered_set<ep_ptr> eps =
-        findEpsForIface(epMgr, iface,
-                       [&srcMac](const Endpoint& ep) {
-                           const optional<MAC>& epMac = ep.getMAC();
-                           if (epMac && srcMac == epMac.get()) {
-                               return true;
-                           }
-                           const Endpoint::virt_ip_set& virtIps =
-                               ep.getVirtualIPs();
-
-                           for (const Endpoint::virt_ip_t& virt_ip : virtIps) {
-                               if (virt_ip.first == srcMac) {
-                                   return true;
-                               }
-                           }
-                           return false;
-                       });
-
-    if (eps.size() == 0) {
-        LOG(WARNING) << "No endpoint found for DHCP request from "
-                     << srcMac << " on " << iface;
-        return;
+    PacketInCache::ep_entry_ptr entry;
+    if (cache)
+        entry = cache->getEndpoint(iface, srcMac);
+    if (!entry) {
+        uint64_t generation = cache ? cache->getGeneration() : 0;
+        entry = findDHCPEntry(intFlowManager, epMgr, iface, srcMac);
+        if (!entry) return;
+        if (cache)
+            cache->putEndpoint(iface, srcMac, entry, generation);
     }
-    if (eps.size() > 1)
-        LOG(WARNING) << "Multiple possible endpoints for DHCP request from "
-                     << srcMac << " on " << iface;
-
-    const shared_ptr<const Endpoint> ep = *eps.begin();
 
     if (v4)
         handleDHCPv4PktIn(agent, intFlowManager,
                           intPortMapper, accPortMapper, intConn, accConn,
-                          ep, iface, pi, proto, pkt, flow);
+                          *entry, iface, pi, proto, pkt, flow);
     else
         handleDHCPv6PktIn(agent, intFlowManager,
                           intPortMapper, accPortMapper, intConn, accConn,
-                          ep, pi, proto, pkt, flow);
+                          *entry, pi, proto, pkt, flow);
 
 }
 
@@ -916,6 +1069,25 @@ void PacketInHandler::Handle(SwitchConnection* conn,
     if (pi.reason != OFPR_ACTION)
         return;
 
+    if (isRateLimited(pi))
+        return;
+
+    if (workerThreads > 0) {
+        // The worker runs after msg is freed, so it gets a copy, and
+        // the packet decoded here is pointed at the copy
+        std::shared_ptr<ofpbuf> copy(ofpbuf_clone(msg), ofpbuf_delete);
+        pi.packet = (char*)copy->data +
+            ((const char*)pi.packet - (const char*)msg->data);
+        if (pktInExecutor.execute([this, conn, copy, pi]() mutable {
+                    handlePacketIn(conn, pi);
+                }))
+            return;
+    }
+    handlePacketIn(conn, pi);
+}
+
+void PacketInHandler::handlePacketIn(SwitchConnection* conn,
+                                     struct ofputil_packet_in& pi) {
     DpPacketP pkt;
     struct flow flow;
 
@@ -926,18 +1098,22 @@ void PacketInHandler::Handle(SwitchConnection* conn,
         ((ofp_version)conn->GetProtocolVersion());
     assert(ofputil_protocol_is_valid(proto));
 
+    // the cache is only kept up to date while listening for updates
+    PacketInCache* pktCache = cacheEnabled ? &cache : NULL;
+
     if (pi.cookie == flow::cookie::NEIGH_DISC)
         handleNDPktIn(agent, intFlowManager, conn, accSwConnection,
                       intPortMapper, accessPortMapper,
-                      pi, proto, pkt.get(), flow);
+                      pi, proto, pkt.get(), flow, pktCache);
     else if (pi.cookie == flow::cookie::DHCP_V4)
         handleDHCPPktIn(true, agent, intFlowManager, intPortMapper,
                         accessPortMapper, conn, accSwConnection,
-                        pi, proto, pkt.get(), flow);
+                        pi, proto, pkt.get(), flow, pktCache);
     else if (pi.cookie == flow::cookie::DHCP_V6)
         handleDHCPPktIn(false, agent, intFlowManager,
                         intPortMapper, accessPortMapper,
-                        conn, accSwConnection, pi, proto, pkt.get(), flow);
+                        conn, accSwConnection, pi, proto, pkt.get(), flow,
+                        pktCache);
     else if (pi.cookie == flow::cookie::VIRTUAL_IP_V4)
         handleVIPPktIn(true, agent, *intPortMapper, pi, flow);
     else if (pi.cookie == flow::cookie::VIRTUAL_IP_V6)
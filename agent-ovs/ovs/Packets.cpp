@@ -400,6 +400,45 @@ OfpBuf compose_icmp6_neigh_solit(const uint8_t* srcMac,
     return b;
 }
 
+bool patch_icmp6_router_ad(uint8_t* frame, size_t len,
+                           const uint8_t* dstMac,
+                           const struct in6_addr* dstIp) {
+    const size_t hdrLen = sizeof(eth::eth_header) + sizeof(struct ip6_hdr);
+    if (len < hdrLen + sizeof(struct nd_router_advert))
+        return false;
+
+    eth::eth_header* eth = (eth::eth_header*)frame;
+    memcpy(eth->eth_dst, dstMac, eth::ADDR_LEN);
+
+    struct ip6_hdr tmpIp6;
+    memcpy(&tmpIp6, frame + sizeof(eth::eth_header), sizeof(tmpIp6));
+    memcpy(&tmpIp6.ip6_dst, dstIp, sizeof(struct in6_addr));
+    memcpy(frame + sizeof(eth::eth_header), &tmpIp6, sizeof(tmpIp6));
+
+    uint16_t payloadLen = ntohs(tmpIp6.ip6_plen);
+    if (len < hdrLen + payloadLen)
+        return false;
+
+    struct nd_router_advert* router_ad =
+        (struct nd_router_advert*)(frame + hdrLen);
+    memset(&router_ad->nd_ra_hdr.icmp6_cksum, 0,
+           sizeof(router_ad->nd_ra_hdr.icmp6_cksum));
+
+    uint32_t chksum = 0;
+    // pseudoheader
+    chksum_accum(chksum, (uint16_t*)&tmpIp6.ip6_src,
+                 sizeof(struct in6_addr));
+    chksum_accum(chksum, (uint16_t*)&tmpIp6.ip6_dst,
+                 sizeof(struct in6_addr));
+    chksum_accum(chksum, (uint16_t*)&tmpIp6.ip6_plen, 2);
+    chksum += (uint16_t)htons(58);
+    // payload
+    chksum_accum(chksum, (uint16_t*)router_ad, payloadLen);
+    uint16_t fchksum = chksum_finalize(chksum);
+    memcpy(&router_ad->nd_ra_hdr.icmp6_cksum, &fchksum, sizeof(fchksum));
+    return true;
+}
+
 static const size_t MAX_IP = 32;
 static const size_t MAX_ROUTE = 16;
 
@@ -704,6 +743,50 @@ OfpBuf compose_dhcpv4_reply(uint8_t message_type,
     return b;
 }
 
+bool patch_dhcpv4_reply(uint8_t* frame, size_t len,
+                        uint8_t message_type, uint32_t xid) {
+    using namespace dhcp;
+    using namespace udp;
+
+    const size_t udpOffset = sizeof(eth::eth_header) + sizeof(struct iphdr);
+    const size_t dhcpOffset = udpOffset + sizeof(struct udp_hdr);
+    // the message type is always the first option
+    if (len < dhcpOffset + sizeof(struct dhcp_hdr) +
+        option::MESSAGE_TYPE_LEN + 2)
+        return false;
+
+    struct iphdr tmpIp;
+    memcpy(&tmpIp, frame + sizeof(eth::eth_header), sizeof(tmpIp));
+    struct udp_hdr* udp = (struct udp_hdr*)(frame + udpOffset);
+    struct dhcp_hdr* dhcp = (struct dhcp_hdr*)(frame + dhcpOffset);
+    size_t udpLen = ntohs(udp->len);
+    if (len < udpOffset + udpLen)
+        return false;
+
+    memcpy(&dhcp->xid, &xid, sizeof(xid));
+    uint8_t* message_type_opt =
+        (uint8_t*)dhcp + sizeof(struct dhcp_hdr);
+    if (message_type_opt[0] != option::MESSAGE_TYPE)
+        return false;
+    message_type_opt[2] = message_type;
+
+    // compute UDP checksum
+    udp->chksum = 0;
+    uint32_t chksum = 0;
+    // pseudoheader
+    chksum_accum(chksum, (uint16_t*)&tmpIp.saddr, 4);
+    chksum_accum(chksum, (uint16_t*)&tmpIp.daddr, 4);
+    struct {uint8_t zero; uint8_t proto;} proto;
+    proto.zero = 0;
+    proto.proto = tmpIp.protocol;
+    chksum_accum(chksum, (uint16_t*)&proto, 2);
+    chksum_accum(chksum, (uint16_t*)&udp->len, 2);
+    // payload
+    chksum_accum(chksum, (uint16_t*)udp, udpLen);
+    udp->chksum = chksum_finalize(chksum);
+    return true;
+}
+
 OfpBuf compose_dhcpv6_reply(uint8_t message_type,
                              const uint8_t* xid,
                              const uint8_t* srcMac,
@@ -0,0 +1,228 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for PodSvcSampler class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include "PodSvcSampler.h"
+#include <opflexagent/EndpointManager.h>
+#include <opflexagent/logging.h>
+
+#include <boost/asio/placeholders.hpp>
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace opflexagent {
+
+using std::string;
+using std::shared_ptr;
+using boost::asio::deadline_timer;
+using boost::asio::ip::address;
+using boost::posix_time::milliseconds;
+
+const uint32_t PodSvcSampler::COLLECTOR_SET_ID;
+const uint32_t PodSvcSampler::MAX_SAMPLING_RATE;
+
+size_t PodSvcSampler::SampleKeyHash::
+operator()(const SampleKey& k) const noexcept {
+    size_t hashv = 0;
+    boost::hash_combine(hashv, k.svcId);
+    boost::hash_combine(hashv, k.toSvc);
+    if (k.client.is_v4()) {
+        boost::hash_combine(hashv, k.client.to_v4().to_ulong());
+    } else {
+        for (uint8_t b : k.client.to_v6().to_bytes())
+            boost::hash_combine(hashv, b);
+    }
+    return hashv;
+}
+
+PodSvcSampler::PodSvcSampler(Agent& agent_, IntFlowManager& intFlowManager_)
+    : JsonRpcRenderer(agent_), intFlowManager(intFlowManager_),
+      collector(agent_.getAgentIOService(),
+                [this](const IpfixCollector::Record& r) {
+                    handleRecord(r);
+                }),
+      samplingRate(1000), collectorPort(4739), topK(1000),
+      exportInterval(10000), stopping(false) {}
+
+void PodSvcSampler::setConfig(uint32_t samplingRate_, uint16_t collectorPort_,
+                              size_t topK_, size_t sketchSize,
+                              long exportInterval_) {
+    if (samplingRate_ > MAX_SAMPLING_RATE) {
+        LOG(WARNING) << "Pod<-->svc sampling rate " << samplingRate_
+                     << " is above the maximum; using "
+                     << MAX_SAMPLING_RATE;
+        samplingRate_ = MAX_SAMPLING_RATE;
+    }
+    samplingRate = std::max<uint32_t>(samplingRate_, 1);
+    collectorPort = collectorPort_;
+    topK = topK_;
+    exportInterval = exportInterval_;
+    sketch.reset(new HeavyHitterSketch<SampleKey, SampleKeyHash>
+                 (std::max(sketchSize, topK)));
+}
+
+uint16_t PodSvcSampler::getProbability() const {
+    return static_cast<uint16_t>(std::max<uint32_t>(65535 / samplingRate, 1));
+}
+
+void PodSvcSampler::start(const string& swName, OvsdbConnection* conn) {
+    LOG(INFO) << "Sampling pod<-->svc traffic at 1 in " << samplingRate
+              << " packets, publishing the top " << topK << " pairs";
+    JsonRpcRenderer::start(swName, conn);
+    stopping = false;
+    if (!sketch)
+        setConfig(samplingRate, collectorPort, topK, topK, exportInterval);
+
+    collector.start(address::from_string("127.0.0.1"), collectorPort);
+    scheduleExport();
+
+    // create the collector set from the IO thread so start doesn't
+    // block on OVSDB
+    connection_timer.reset(new deadline_timer(agent.getAgentIOService(),
+                                              milliseconds(0)));
+    connection_timer->async_wait(boost::bind(&PodSvcSampler::connectCb, this,
+                                             boost::asio::placeholders::error));
+    timerStarted = true;
+}
+
+void PodSvcSampler::stop() {
+    LOG(DEBUG) << "Stopping pod<-->svc sampler";
+    stopping = true;
+    if (connection_timer)
+        connection_timer->cancel();
+    if (exportTimer)
+        exportTimer->cancel();
+    collector.stop();
+}
+
+void PodSvcSampler::connectCb(const boost::system::error_code& ec) {
+    if (ec || stopping)
+        return;
+    timerStarted = false;
+    if (createCollectorSet())
+        return;
+
+    LOG(DEBUG) << "Failed to create flow sample collector set, retry in "
+               << CONNECTION_RETRY << " seconds";
+    connection_timer.reset(new deadline_timer(agent.getAgentIOService(),
+                                              milliseconds(CONNECTION_RETRY
+                                                           * 1000)));
+    connection_timer->async_wait(boost::bind(&PodSvcSampler::connectCb, this,
+                                             boost::asio::placeholders::error));
+    timerStarted = true;
+}
+
+bool PodSvcSampler::createCollectorSet() {
+    std::unique_lock<std::mutex> lock(handlerMutex);
+    if (!connect())
+        return false;
+    string brUuid;
+    jRpc->getBridgeUuid(switchName, brUuid);
+    if (brUuid.empty())
+        return false;
+    // replace any collector sets left over from a previous run
+    jRpc->deleteFlowSampleCollectorSets(brUuid);
+    return jRpc->createFlowSampleCollectorSet(brUuid, COLLECTOR_SET_ID,
+                                              "127.0.0.1:" +
+                                              std::to_string(collectorPort));
+}
+
+void PodSvcSampler::handleRecord(const IpfixCollector::Record& r) {
+    if (r.observationPoint == 0 || !sketch)
+        return;
+    SampleKey key;
+    key.svcId = r.observationPoint;
+    if (r.observationDomain == IntFlowManager::SAMPLE_TO_SERVICE) {
+        key.toSvc = true;
+        key.client = r.srcAddr;
+    } else if (r.observationDomain == IntFlowManager::SAMPLE_FROM_SERVICE) {
+        key.toSvc = false;
+        key.client = r.dstAddr;
+    } else {
+        return;
+    }
+    sketch->add(key, r.packets, r.bytes);
+}
+
+void PodSvcSampler::scheduleExport() {
+    if (stopping || exportInterval <= 0)
+        return;
+    exportTimer.reset(new deadline_timer(agent.getAgentIOService(),
+                                         milliseconds(exportInterval)));
+    exportTimer->async_wait(boost::bind(&PodSvcSampler::onExportTimer, this,
+                                        boost::asio::placeholders::error));
+}
+
+void PodSvcSampler::onExportTimer(const boost::system::error_code& ec) {
+    if (ec || stopping)
+        return;
+    exportCounters();
+    scheduleExport();
+}
+
+void PodSvcSampler::exportCounters() {
+    if (!sketch)
+        return;
+    typedef HeavyHitterSketch<SampleKey, SampleKeyHash>::Entry entry_t;
+    std::vector<entry_t> top;
+    sketch->getTop(topK, top);
+
+    // OVS samples each packet with probability getProbability() /
+    // 65535, which is only approximately one in samplingRate
+    const double scale = 65535.0 / getProbability();
+    auto scaled = [scale](uint64_t count) {
+        return static_cast<uint64_t>(std::llround(count * scale));
+    };
+
+    EndpointManager& epMgr = agent.getEndpointManager();
+    // several client addresses of an endpoint share its counters
+    std::map<counter_key_t, std::pair<uint64_t, uint64_t> > deltas;
+
+    for (const entry_t& e : top) {
+        boost::optional<string> svcUuid =
+            intFlowManager.getSampledServiceUuid(e.key.svcId);
+        if (!svcUuid)
+            continue;
+        shared_ptr<const Endpoint> ep =
+            epMgr.getLocalEndpointByIP(e.key.client.to_string());
+        if (!ep)
+            continue;
+
+        // only the traffic sampled since the key was last exported
+        // is added, so that a key that was evicted and came back is
+        // not counted twice
+        auto& delta =
+            deltas[std::make_pair(e.key.toSvc,
+                                  ep->getUUID() + ":" + svcUuid.get())];
+        delta.first += scaled(e.newPackets);
+        delta.second += scaled(e.newBytes);
+        sketch->markExported(e.key);
+    }
+
+    std::set<counter_key_t> nextCounters;
+    for (const auto& d : deltas) {
+        intFlowManager.updatePodSvcSampledCounters(d.first.first,
+                                                   d.first.second,
+                                                   d.second.first,
+                                                   d.second.second);
+        nextCounters.insert(d.first);
+    }
+    for (const counter_key_t& c : publishedCounters) {
+        if (nextCounters.find(c) == nextCounters.end())
+            intFlowManager.clearPodSvcSampledCounters(c.first, c.second);
+    }
+
+    publishedCounters.swap(nextCounters);
+}
+
+} /* namespace opflexagent */
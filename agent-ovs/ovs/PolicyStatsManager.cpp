@@ -55,6 +55,7 @@ PolicyStatsManager::PolicyStatsManager(Agent* agent_, IdGenerator& idGen_,
 #endif
       switchManager(switchManager_),
       connection(NULL),
+      statsExecutor("policy stats"),
       timer_interval(timer_interval_),
       stopping(false) {}
 
@@ -69,6 +70,7 @@ void PolicyStatsManager::start(bool register_listener) {
 
     LOG(DEBUG) << "Starting policy stats manager " << this;
     if(connection) {
+        statsExecutor.start();
         connection->RegisterMessageHandler(OFPTYPE_FLOW_STATS_REPLY, this);
         connection->RegisterMessageHandler(OFPTYPE_FLOW_REMOVED, this);
         {
@@ -90,6 +92,7 @@ void PolicyStatsManager::stop(bool unregister_listener) {
     if (connection) {
         connection->UnregisterMessageHandler(OFPTYPE_FLOW_STATS_REPLY, this);
         connection->UnregisterMessageHandler(OFPTYPE_FLOW_REMOVED, this);
+        statsExecutor.stop();
     }
     if(unregister_listener) {
         L24Classifier::unregisterListener(agent->getFramework(),this);
@@ -397,6 +400,20 @@ void PolicyStatsManager::updateNewFlowCounters(uint32_t cookie,
     }
 }
 
+MessageExecutor* PolicyStatsManager::GetExecutor(int msgType) {
+    return &statsExecutor;
+}
+
+bool PolicyStatsManager::Accepts(int msgType, ofpbuf *msg) {
+    // Every stats manager sees every flow stats reply; only copy
+    // the ones that answer our own requests
+    if (msgType != OFPTYPE_FLOW_STATS_REPLY)
+        return true;
+    ovs_be32 recvXid = ((ofp_header *)msg->data)->xid;
+    std::lock_guard<mutex> lock(txnMtx);
+    return txns.find(recvXid) != txns.end();
+}
+
 void PolicyStatsManager::handleMessage(int msgType,
                                        ofpbuf *msg,
                                        const table_map_t& tableMap,
@@ -15,6 +15,7 @@
 
 #include <boost/scope_exit.hpp>
 
+#include <memory>
 #include <unordered_map>
 
 #include "ovs-ofputil.h"
@@ -64,10 +65,15 @@ int SwitchConnection::DecodeFlowRemoved(ofpbuf *msg,
 }
 
 SwitchConnection::SwitchConnection(const std::string& swName) :
-    switchName(swName), ofConn(NULL), ofProtoVersion(OFP10_VERSION), isDisconnecting(false) {
+    switchName(swName), ofConn(NULL), ofProtoVersion(OFP10_VERSION), isDisconnecting(false),
+    hasSendHead(false), sendable(false), sendGen(0), sendQueueDepth(0),
+    sendQueueLimit(DEFAULT_SEND_QUEUE_LIMIT), connThreadId(std::thread::id()),
+    sendSpaceWaiters(0),
+    statMaxDepth(0), statSent(0), statDropped(0), statFlushes(0),
+    statBlocked(0), statTotalLatencyUs(0), statMaxLatencyUs(0) {
     connThread = NULL;
 
-    pollEventFd = eventfd(0, 0);
+    pollEventFd = eventfd(0, EFD_NONBLOCK);
 
     RegisterMessageHandler(OFPTYPE_ECHO_REQUEST, &echoReqHandler);
     RegisterMessageHandler(OFPTYPE_ECHO_REPLY, &echoRepHandler);
@@ -157,15 +163,41 @@ SwitchConnection::doConnectOF() {
         cleanupOFConn();
         ofConn = newConn;
         ofProtoVersion = connVersion;
+        // messages queued for an earlier connection must not be
+        // written to this one
+        ++sendGen;
+        sendable = true;
     }
     return 0;
 }
 
 void SwitchConnection::cleanupOFConn() {
+    sendable = false;
     if (ofConn != NULL) {
         vconn_close(ofConn);
         ofConn = NULL;
     }
+    dropSendQueue();
+}
+
+void SwitchConnection::dropSendQueue() {
+    // Messages queued for a connection that is gone are of no use to
+    // the next one; listeners resend their state on reconnect
+    QueuedMessage m;
+    if (hasSendHead) {
+        m = std::move(sendHead);
+        hasSendHead = false;
+    } else if (!sendQueue.pop(m)) {
+        notifySendSpace();
+        return;
+    }
+    do {
+        --sendQueueDepth;
+        ++statDropped;
+        if (m.done)
+            m.done(ENOTCONN);
+    } while (sendQueue.pop(m));
+    notifySendSpace();
 }
 
 void
@@ -206,6 +238,12 @@ SwitchConnection::operator()() {
     Monitor();
 }
 
+void
+SwitchConnection::ClearPollEvent() {
+    uint64_t data;
+    while (read(pollEventFd, &data, sizeof(data)) == sizeof(data)) {}
+}
+
 bool
 SwitchConnection::SignalPollEvent() {
     uint64_t data = 1;
@@ -225,6 +263,7 @@ SwitchConnection::WatchPollEvent() {
 void
 SwitchConnection::Monitor() {
     LOG(DEBUG) << "Connection monitor started ...";
+    connThreadId = std::this_thread::get_id();
 
     bool connLost = !IsConnected();
     if (!connLost) {
@@ -243,6 +282,7 @@ SwitchConnection::Monitor() {
             WatchPollEvent();
             poll_timer_wait(LOST_CONN_BACKOFF_MSEC);
             poll_block(); // block till timer expires or disconnect is requested
+            ClearPollEvent();
             if (!isDisconnecting) {
                 int err = doConnectOF();
                 /**
@@ -274,6 +314,7 @@ SwitchConnection::Monitor() {
         }
         WatchPollEvent();
         if (!connLost) {
+            flushSendQueue();
             {
                 mutex_guard lock(connMtx);
                 poll_timer_wait(LOST_CONN_BACKOFF_MSEC);
@@ -283,6 +324,7 @@ SwitchConnection::Monitor() {
                 vconn_recv_wait(ofConn);
             }
             poll_block();
+            ClearPollEvent();
         }
         connLost = (EOF == receiveOFMessage());
 
@@ -331,12 +373,7 @@ SwitchConnection::receiveOFMessage() {
                         break;
                     }
                 }
-                HandlerMap::const_iterator itr = msgHandlers.find(type);
-                if (itr != msgHandlers.end()) {
-                    for (MessageHandler *h : itr->second) {
-                        h->Handle(this, type, recvMsg, &flow_removed);
-                    }
-                }
+                DispatchMessage(type, recvMsg, &flow_removed);
             }
             ofpbuf_delete(recvMsg);
         }
@@ -344,28 +381,203 @@ SwitchConnection::receiveOFMessage() {
     return 0;
 }
 
+void
+SwitchConnection::DispatchMessage(int type, ofpbuf *msg,
+                                  struct ofputil_flow_removed *fentry) {
+    HandlerMap::const_iterator itr = msgHandlers.find(type);
+    if (itr == msgHandlers.end()) {
+        return;
+    }
+    for (MessageHandler *h : itr->second) {
+        if (!h->Accepts(type, msg)) {
+            continue;
+        }
+        MessageExecutor* executor = h->GetExecutor(type);
+        if (executor == NULL) {
+            h->Handle(this, type, msg, fentry);
+            continue;
+        }
+
+        // The executor's handler may run after msg is freed, and
+        // may consume it while decoding, so it gets its own copy
+        std::shared_ptr<ofpbuf> copy(ofpbuf_clone(msg), ofpbuf_delete);
+        std::shared_ptr<ofputil_flow_removed> fcopy;
+        if (type == OFPTYPE_FLOW_REMOVED && fentry) {
+            fcopy = std::make_shared<ofputil_flow_removed>(*fentry);
+        }
+        if (!executor->execute([this, h, type, copy, fcopy]() {
+                    h->Handle(this, type, copy.get(), fcopy.get());
+                })) {
+            h->Handle(this, type, msg, fentry);
+        }
+    }
+}
+
 int
 SwitchConnection::SendMessage(OfpBuf& msg) {
-    while(true) {
+    return enqueueMessage(msg, SendCompletion(), true);
+}
+
+int
+SwitchConnection::SendMessage(OfpBuf& msg, const SendCompletion& done) {
+    return enqueueMessage(msg, done, true);
+}
+
+int
+SwitchConnection::SendMessageAsync(OfpBuf& msg, const SendCompletion& done) {
+    return enqueueMessage(msg, done, false);
+}
+
+int
+SwitchConnection::enqueueMessage(OfpBuf& msg, const SendCompletion& done,
+                                 bool wait) {
+    // Read the generation first: if the connection is replaced after
+    // this, the message is stamped with the old generation and
+    // dropped rather than written to the new connection
+    uint64_t gen = sendGen;
+    if (!sendable) {
+        return ENOTCONN;
+    }
+
+    // The connection thread never waits for itself; it is the one
+    // that makes room
+    if (sendQueueDepth >= sendQueueLimit &&
+        connThreadId.load() != std::this_thread::get_id()) {
+        if (!wait) {
+            return EAGAIN;
+        }
+        ++statBlocked;
+        std::unique_lock<std::mutex> lock(sendSpaceMtx);
+        ++sendSpaceWaiters;
+        sendSpaceCond.wait(lock, [this]() {
+            return sendQueueDepth < sendQueueLimit || !sendable;
+        });
+        --sendSpaceWaiters;
+        if (!sendable || sendGen != gen) {
+            return ENOTCONN;
+        }
+    }
+
+    QueuedMessage m;
+    m.msg = std::move(msg);
+    m.done = done;
+    m.queued = std::chrono::steady_clock::now();
+    m.gen = gen;
+    size_t depth = ++sendQueueDepth;
+    size_t maxDepth = statMaxDepth;
+    while (depth > maxDepth &&
+           !statMaxDepth.compare_exchange_weak(maxDepth, depth)) {}
+    sendQueue.push(std::move(m));
+
+    // Only the first message into an empty queue needs to wake the
+    // connection thread; it drains everything queued after it too
+    if (depth == 1) {
+        SignalPollEvent();
+    }
+    return 0;
+}
+
+void
+SwitchConnection::flushSendQueue() {
+    std::vector<std::pair<SendCompletion, int> > completed;
+    {
         mutex_guard lock(connMtx);
         if (!IsConnectedLocked()) {
-            return ENOTCONN;
+            return;
         }
-        int err = vconn_send(ofConn, msg.get());
-        if (err == 0) {
-            // vconn_send takes ownership
-            msg.release();
-            return 0;
-        } else if (err != EAGAIN) {
-            LOG(ERROR) << "Error sending OF message: " << ovs_strerror(err);
-            return err;
-        } else {
-            vconn_run(ofConn);
-            vconn_send_wait(ofConn);
+        ++statFlushes;
+
+        bool retried = false;
+        while (true) {
+            if (!hasSendHead) {
+                if (!sendQueue.pop(sendHead)) {
+                    break;
+                }
+                hasSendHead = true;
+            }
+            int err = sendHead.gen == sendGen
+                ? vconn_send(ofConn, sendHead.msg.get())
+                : ENOTCONN;
+            if (err == EAGAIN) {
+                if (!retried) {
+                    // let the connection push out what it has buffered
+                    vconn_run(ofConn);
+                    retried = true;
+                    continue;
+                }
+                vconn_send_wait(ofConn);
+                break;
+            }
+            retried = false;
+            hasSendHead = false;
+            if (err == 0) {
+                // vconn_send takes ownership
+                sendHead.msg.release();
+                uint64_t latency = std::chrono::duration_cast
+                    <std::chrono::microseconds>
+                    (std::chrono::steady_clock::now() - sendHead.queued)
+                    .count();
+                ++statSent;
+                statTotalLatencyUs += latency;
+                uint64_t maxLatency = statMaxLatencyUs;
+                while (latency > maxLatency &&
+                       !statMaxLatencyUs.compare_exchange_weak(maxLatency,
+                                                               latency)) {}
+            } else {
+                LOG(ERROR) << "Error sending OF message: "
+                           << ovs_strerror(err);
+                ++statDropped;
+                sendHead.msg.reset();
+            }
+            --sendQueueDepth;
+            if (sendHead.done) {
+                completed.emplace_back(std::move(sendHead.done), err);
+                sendHead.done = SendCompletion();
+            }
         }
+
+        // A sender may have counted its message but not yet linked
+        // it in; come straight back for it
+        if (!hasSendHead && sendQueueDepth > 0) {
+            poll_immediate_wake();
+        }
+        vconn_run(ofConn);
+    }
+
+    notifySendSpace();
+    for (auto& c : completed) {
+        c.first(c.second);
+    }
+}
+
+void
+SwitchConnection::notifySendSpace() {
+    if (sendSpaceWaiters > 0) {
+        std::lock_guard<std::mutex> lock(sendSpaceMtx);
+        sendSpaceCond.notify_all();
     }
 }
 
+void
+SwitchConnection::setSendQueueLimit(size_t limit) {
+    sendQueueLimit = limit;
+    notifySendSpace();
+}
+
+SwitchConnection::SendQueueStats
+SwitchConnection::getSendQueueStats() const {
+    SendQueueStats stats;
+    stats.depth = sendQueueDepth;
+    stats.maxDepth = statMaxDepth;
+    stats.sent = statSent;
+    stats.dropped = statDropped;
+    stats.flushes = statFlushes;
+    stats.blocked = statBlocked;
+    stats.totalLatencyUs = statTotalLatencyUs;
+    stats.maxLatencyUs = statMaxLatencyUs;
+    return stats;
+}
+
 void
 SwitchConnection::FireOnConnectListeners() {
     if (GetProtocolVersion() >= OFP12_VERSION) {
@@ -432,4 +644,105 @@ SwitchConnection::ErrorHandler::Handle(SwitchConnection*, int,
                << ofperr_get_description(err);
 }
 
+MessageExecutor::MessageExecutor(const std::string& name_, size_t nthreads_,
+                                 size_t maxQueueDepth_)
+    : name(name_), nthreads(nthreads_ ? nthreads_ : 1),
+      maxQueueDepth(maxQueueDepth_), dropped(0), running(false) {
+}
+
+MessageExecutor::~MessageExecutor() {
+    stop();
+}
+
+void
+MessageExecutor::start() {
+    std::lock_guard<std::mutex> lock(queueMtx);
+    if (running) {
+        return;
+    }
+    LOG(DEBUG) << "Starting " << name << " message executor with "
+               << nthreads << " thread(s)";
+    running = true;
+    for (size_t i = 0; i < nthreads; ++i) {
+        workers.emplace_back(&MessageExecutor::run, this);
+    }
+}
+
+void
+MessageExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        if (!running) {
+            return;
+        }
+        LOG(DEBUG) << "Stopping " << name << " message executor";
+        running = false;
+        tasks.clear();
+    }
+    queueCond.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    workers.clear();
+}
+
+void
+MessageExecutor::setLimits(size_t nthreads_, size_t maxQueueDepth_) {
+    std::lock_guard<std::mutex> lock(queueMtx);
+    nthreads = nthreads_ ? nthreads_ : 1;
+    maxQueueDepth = maxQueueDepth_;
+}
+
+bool
+MessageExecutor::execute(std::function<void()>&& task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        if (!running) {
+            return false;
+        }
+        if (maxQueueDepth && tasks.size() >= maxQueueDepth) {
+            if (dropped++ == 0) {
+                LOG(WARNING) << "Queue for " << name
+                             << " message executor is full; dropping"
+                             << " messages";
+            }
+            return true;
+        }
+        tasks.push_back(std::move(task));
+    }
+    queueCond.notify_one();
+    return true;
+}
+
+size_t
+MessageExecutor::getQueueDepth() {
+    std::lock_guard<std::mutex> lock(queueMtx);
+    return tasks.size();
+}
+
+uint64_t
+MessageExecutor::getDropped() {
+    std::lock_guard<std::mutex> lock(queueMtx);
+    return dropped;
+}
+
+void
+MessageExecutor::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMtx);
+            queueCond.wait(lock, [this]() {
+                return !running || !tasks.empty();
+            });
+            if (!running) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
 } // namespace opflexagent
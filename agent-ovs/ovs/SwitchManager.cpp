@@ -26,6 +26,9 @@ using boost::asio::placeholders::error;
 
 const long DEFAULT_SYNC_DELAY_ON_CONNECT_MSEC = 5000;
 
+const size_t SwitchManager::DEFAULT_FLOW_BATCH_MAX_EDITS;
+const long SwitchManager::DEFAULT_FLOW_BATCH_MAX_DELAY;
+
 SwitchManager::SwitchManager(Agent& agent_,
                              FlowExecutor& flowExecutor_,
                              FlowReader& flowReader_,
@@ -37,7 +40,9 @@ SwitchManager::SwitchManager(Agent& agent_,
       connectDelayMs(DEFAULT_SYNC_DELAY_ON_CONNECT_MSEC),
       stopping(false), syncEnabled(false), syncing(false),
       syncInProgress(false), syncPending(false),
-      tlvTableDone(false), groupsDone(false) {
+      tlvTableDone(false), groupsDone(false),
+      batchMaxEdits(0), batchMaxDelayMs(0), batchSize(0),
+      batchCheckedSize(0), batchGen(0), batchSending(false) {
 
 }
 
@@ -60,6 +65,11 @@ void SwitchManager::connect() {
 void SwitchManager::stop() {
     stopping = true;
 
+    // Send the batched flow edits while the switch can still
+    // acknowledge them, since the tables are not reconciled again
+    // once we stop
+    flushFlows();
+
     if (connection) {
         flowReader.uninstallListenersForConnection(connection.get());
         flowExecutor.UninstallListenersForConnection(connection.get());
@@ -70,12 +80,15 @@ void SwitchManager::stop() {
     if (connectTimer) {
         connectTimer->cancel();
     }
+    dropFlowBatch(false);
 }
 
 void SwitchManager::setMaxFlowTables(int max) {
     flowTables.resize(max);
     recvFlows.resize(max);
     tableDone.resize(max);
+    std::lock_guard<std::mutex> guard(batchMutex);
+    batchEdits.resize(max);
 }
 
 void SwitchManager::setForwardingTableList(
@@ -163,8 +176,6 @@ void SwitchManager::onConnectTimer(const boost::system::error_code& ec) {
 
 bool SwitchManager::writeFlow(const std::string& objId, int tableId,
                               FlowEntryList& el) {
-    bool success = true;
-
     assert(tableId >= 0 &&
            static_cast<size_t>(tableId) < flowTables.size());
     for (FlowEntryPtr& fe : el)
@@ -173,19 +184,9 @@ bool SwitchManager::writeFlow(const std::string& objId, int tableId,
 
     FlowEdit diffs;
     tab.apply(objId, el, diffs);
-    if (!syncing) {
-        // If a sync is in progress, don't write to the flow tables
-        // while we are reading and reconciling with the current
-        // flows.
-        if (!(success = flowExecutor.Execute(diffs))) {
-            LOG(ERROR) << "[" << connection->getSwitchName() << "] "
-                       << "Writing flows for " << objId << " failed";
-
-        }
-    }
     el.clear();
 
-    return success;
+    return executeFlowEdit(tableId, diffs, objId);
 }
 
 bool SwitchManager::writeFlow(const std::string& objId,
@@ -201,6 +202,187 @@ bool SwitchManager::writeFlow(const std::string& objId,
     return writeFlow(objId, tableId, fb.build());
 }
 
+bool SwitchManager::writeFlows(int tableId, obj_flows_t& objFlows) {
+    assert(tableId >= 0 &&
+           static_cast<size_t>(tableId) < flowTables.size());
+    TableState& tab = flowTables[tableId];
+
+    FlowEdit diffs;
+    FlowEdit objDiffs;
+    for (auto& of : objFlows) {
+        for (FlowEntryPtr& fe : of.second)
+            fe->entry->table_id = tableId;
+        tab.apply(of.first, of.second, objDiffs);
+        diffs.edits.insert(diffs.edits.end(),
+                           objDiffs.edits.begin(), objDiffs.edits.end());
+        of.second.clear();
+    }
+
+    return executeFlowEdit(tableId, diffs,
+                           std::to_string(objFlows.size()) + " objects");
+}
+
+bool SwitchManager::executeFlowEdit(int tableId, FlowEdit& diffs,
+                                    const std::string& what) {
+    // If a sync is in progress, don't write to the flow tables
+    // while we are reading and reconciling with the current
+    // flows.
+    if (syncing) {
+        return true;
+    }
+
+    if (batchMaxEdits == 0) {
+        bool success = flowExecutor.Execute(diffs);
+        if (!success) {
+            LOG(ERROR) << "[" << connection->getSwitchName() << "] "
+                       << "Writing flows for " << what << " failed";
+        }
+        return success;
+    }
+
+    if (diffs.edits.empty()) {
+        return true;
+    }
+    bool full;
+    {
+        std::lock_guard<std::mutex> guard(batchMutex);
+        bool opened = (batchSize == 0);
+        FlowEdit& batch = batchEdits[tableId];
+        batch.edits.insert(batch.edits.end(),
+                           diffs.edits.begin(), diffs.edits.end());
+        batchSize += diffs.edits.size();
+        full = batchSize >= batchMaxEdits;
+        if (opened && !full) {
+            // Tasks already on the IO queue run before the check, so
+            // the edits of a burst of tasks join the batch
+            batchCheckedSize = 0;
+            agent.getAgentIOService()
+                .post(bind(&SwitchManager::onBatchDrainCheck, this,
+                           batchGen));
+            batchTimer
+                .reset(new deadline_timer(agent.getAgentIOService(),
+                                          milliseconds(batchMaxDelayMs)));
+            batchTimer->async_wait(bind(&SwitchManager::onBatchTimer,
+                                        this, error, batchGen));
+        }
+    }
+
+    return full ? flushFlows() : true;
+}
+
+void SwitchManager::setFlowBatching(size_t maxEdits, long maxDelayMs) {
+    batchMaxEdits = maxEdits;
+    batchMaxDelayMs = maxDelayMs;
+    if (maxEdits == 0)
+        flushFlows();
+}
+
+void SwitchManager::onFlowsWritten(const write_cb_t& cb) {
+    {
+        std::lock_guard<std::mutex> guard(batchMutex);
+        if (batchSize > 0 || batchSending) {
+            batchCallbacks.push_back(cb);
+            return;
+        }
+    }
+    cb(true);
+}
+
+bool SwitchManager::flushFlows() {
+    FlowEdit edits;
+    std::vector<write_cb_t> callbacks;
+    bool success = true;
+    {
+        std::lock_guard<std::mutex> flushGuard(flushMutex);
+        {
+            std::lock_guard<std::mutex> guard(batchMutex);
+            // the edits of each table stay in the order they were
+            // written, which keeps the order of the edits to any flow
+            for (FlowEdit& batch : batchEdits) {
+                edits.edits.insert(edits.edits.end(),
+                                   batch.edits.begin(), batch.edits.end());
+                batch.edits.clear();
+            }
+            callbacks.swap(batchCallbacks);
+            batchSize = 0;
+            batchGen += 1;
+            batchSending = true;
+            if (batchTimer) {
+                batchTimer->cancel();
+                batchTimer.reset();
+            }
+        }
+
+        if (!edits.edits.empty() && !syncing) {
+            success = flowExecutor.Execute(edits);
+            if (!success) {
+                LOG(ERROR) << "[" << connection->getSwitchName() << "] "
+                           << "Writing a batch of " << edits.edits.size()
+                           << " flow edits failed";
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(batchMutex);
+        batchSending = false;
+        // callbacks registered while the batch was being sent complete
+        // with it if nothing was batched after it
+        if (batchSize == 0) {
+            callbacks.insert(callbacks.end(),
+                             batchCallbacks.begin(), batchCallbacks.end());
+            batchCallbacks.clear();
+        }
+    }
+
+    // callbacks may write more flows
+    for (const write_cb_t& cb : callbacks)
+        cb(success);
+    return success;
+}
+
+void SwitchManager::dropFlowBatch(bool success) {
+    std::vector<write_cb_t> callbacks;
+    {
+        std::lock_guard<std::mutex> guard(batchMutex);
+        for (FlowEdit& batch : batchEdits)
+            batch.edits.clear();
+        callbacks.swap(batchCallbacks);
+        batchSize = 0;
+        batchGen += 1;
+        if (batchTimer) {
+            batchTimer->cancel();
+            batchTimer.reset();
+        }
+    }
+    for (const write_cb_t& cb : callbacks)
+        cb(success);
+}
+
+void SwitchManager::onBatchDrainCheck(uint64_t gen) {
+    {
+        std::lock_guard<std::mutex> guard(batchMutex);
+        if (gen != batchGen || batchSize == 0) return;
+        if (batchSize != batchCheckedSize) {
+            // Tasks that ran since the last check added to the batch,
+            // so check again once the tasks queued behind it have run
+            batchCheckedSize = batchSize;
+            agent.getAgentIOService()
+                .post(bind(&SwitchManager::onBatchDrainCheck, this, gen));
+            return;
+        }
+    }
+    flushFlows();
+}
+
+void SwitchManager::onBatchTimer(const boost::system::error_code& ec,
+                                 uint64_t gen) {
+    if (ec) return;
+    {
+        std::lock_guard<std::mutex> guard(batchMutex);
+        if (gen != batchGen) return;
+    }
+    flushFlows();
+}
+
 bool SwitchManager::clearFlows(const std::string& objId, int tableId) {
     FlowEntryList empty;
     return writeFlow(objId, tableId, empty);
@@ -212,6 +394,11 @@ bool SwitchManager::writeGroupMod(const GroupEdit::Entry& e) {
     if (syncing) {
         return true;
     }
+    // Send the batched flow edits first, since flows may refer to
+    // the group
+    if (batchMaxEdits > 0) {
+        flushFlows();
+    }
 
     GroupEdit ge;
     ge.edits.push_back(e);
@@ -229,6 +416,9 @@ bool SwitchManager::writeTlv(const std::string& objId, TlvEntryList& el) {
     TlvEdit diffs;
     tlvTable.apply(objId, el, diffs);
     if (!syncing) {
+        if (batchMaxEdits > 0) {
+            flushFlows();
+        }
         // If a sync is in progress, don't write to the flow tables
         // while we are reading and reconciling with the current
         // flows.
@@ -265,6 +455,9 @@ void SwitchManager::initiateSync() {
     syncInProgress = true;
     syncPending = false;
     syncing = true;
+    // The sync reconciles the switch with the table state, which
+    // already includes any batched flow edits
+    dropFlowBatch(true);
     LOG(INFO) << "[" << connection->getSwitchName() << "] "
               << "Sync initiated";
 
@@ -13,12 +13,16 @@
 
 #include <boost/noncopyable.hpp>
 
+#include <mutex>
+#include <unordered_map>
+
 #include <opflexagent/Agent.h>
 #include <opflexagent/EndpointManager.h>
 #include <opflexagent/PolicyListener.h>
 #include <opflexagent/ExtraConfigListener.h>
 #include "PortMapper.h"
 #include "SwitchManager.h"
+#include "FlowUtils.h"
 #include <opflexagent/TaskQueue.h>
 #include "SwitchStateHandler.h"
 
@@ -154,6 +158,26 @@ public:
     };
 
 private:
+    /**
+     * A security group rule compiled once per security group, with
+     * its remote subnets compressed to a minimal CIDR cover.  The
+     * compiled rules are shared by every security group set that
+     * references the security group.
+     */
+    struct SecGrpRule {
+        std::shared_ptr<modelgbp::gbpe::L24Classifier> cls;
+        network::subnets_t remoteSubs;
+        uint64_t cookie;
+        uint16_t priority;
+        uint8_t dir;
+        bool skipL34;
+        flowutils::ClassAction act;
+    };
+    typedef std::vector<SecGrpRule> sec_grp_rules_t;
+    typedef std::shared_ptr<const sec_grp_rules_t> sec_grp_rules_ptr;
+
+    sec_grp_rules_ptr getSecGrpRules(const opflex::modb::URI& secGrp);
+
     void createStaticFlows();
     void handleEndpointUpdate(const std::string& uuid);
     void handleSecGrpUpdate(const opflex::modb::URI& uri);
@@ -167,6 +191,11 @@ private:
     CtZoneManager& ctZoneManager;
     TaskQueue taskQueue;
 
+    std::mutex secGrpRulesMutex;
+    std::unordered_map<opflex::modb::URI, sec_grp_rules_ptr> secGrpRulesCache;
+    // incremented on each invalidation of the cache
+    uint64_t secGrpRulesGen;
+
     bool conntrackEnabled;
     bool stopping;
     std::string dropLogIface;
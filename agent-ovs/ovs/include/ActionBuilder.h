@@ -389,6 +389,20 @@ public:
     ActionBuilder& macVlanLearn(uint16_t prio,
                                 uint64_t cookie,
                                 uint8_t table);
+    /**
+     * Sample the packet to a flow sample collector set, which exports
+     * it over IPFIX along with the observation domain and point IDs
+     *
+     * @param probability the fraction of packets to sample, out of
+     * 65535
+     * @param collectorSetId the ID of the Flow_Sample_Collector_Set
+     * @param obsDomainId the observation domain ID to export
+     * @param obsPointId the observation point ID to export
+     * @return this action builder for chaining
+     */
+    ActionBuilder& sample(uint16_t probability, uint32_t collectorSetId,
+                          uint32_t obsDomainId, uint32_t obsPointId);
+
     /**
      * Fill tunnel metadata with current openflow state
      *
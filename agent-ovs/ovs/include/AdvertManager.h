@@ -20,6 +20,8 @@
 
 #include <mutex>
 #include <random>
+#include <deque>
+#include <vector>
 
 namespace opflexagent {
 
@@ -37,6 +39,19 @@ public:
      */
     AdvertManager(Agent& agent, IntFlowManager& intFlowManager);
 
+    /**
+     * Default largest number of endpoints in a batch of periodic
+     * endpoint advertisements
+     */
+    static const size_t DEFAULT_ADV_BATCH_SIZE = 64;
+
+    /**
+     * Default window in milliseconds across which the batches of
+     * periodic endpoint advertisements are spread.  The initial
+     * round is not paced.
+     */
+    static const uint64_t DEFAULT_ADV_PACING_WINDOW = 60000;
+
     /**
      * Set the port mapper to use
      * @param m the port mapper
@@ -129,12 +144,44 @@ public:
     void scheduleInitialEndpointAdv(uint64_t delay = 10000);
 
     /**
-     * Schedule endpoint advertisements for a specific endpoint
+     * Schedule a round of periodic endpoint advertisements, paced
+     * across the pacing window.  Subsequent rounds follow at the
+     * periodic interval.
+     *
+     * @param delay number of milliseconds to delay before sending
+     * advertisements
+     */
+    void schedulePeriodicEndpointAdv(uint64_t delay);
+
+    /**
+     * Schedule endpoint advertisements for a specific endpoint.  This
+     * also invalidates any cached advertisements for the endpoint.
      *
      * @param uuid the uuid of the endpoint
      */
     void scheduleEndpointAdv(const std::string& uuid);
 
+    /**
+     * Set the parameters used to pace the periodic advertisements
+     * for all endpoints.  Endpoints are advertised in batches of at
+     * most batchSize endpoints, spread evenly across the pacing
+     * window.
+     *
+     * @param batchSize the maximum number of endpoints in a batch
+     * @param window the pacing window in milliseconds
+     */
+    void setEndpointAdvPacing(size_t batchSize, uint64_t window) {
+        advBatchSize = batchSize ? batchSize : 1;
+        advPacingWindow = window;
+    }
+
+    /**
+     * Invalidate the cached advertisements for all endpoints.  This
+     * must be called when the endpoint groups or forwarding
+     * configuration used to build the advertisements change.
+     */
+    void invalidateEndpointAdvs();
+
     /**
      * Schedule service advertisements for a specific service
      *
@@ -177,11 +224,42 @@ private:
      */
     void sendEndpointAdvs(const std::string& uuid);
 
+    /**
+     * Pre-encoded packet-out messages advertising all the IPs of an
+     * endpoint, along with the switch state they were encoded for
+     */
+    struct EpAdvTemplate {
+        uint32_t tunPort;
+        int protoVersion;
+        std::vector<std::vector<uint8_t> > msgs;
+    };
+    typedef std::shared_ptr<const EpAdvTemplate> ep_adv_template_ptr;
+
+    ep_adv_template_ptr buildEndpointAdvs(const std::string& uuid,
+                                          uint32_t tunPort);
+    std::mutex adv_cache_mutex;
+    std::unordered_map<std::string, ep_adv_template_ptr> epAdvCache;
+    // incremented on each invalidation of the cache
+    uint64_t epAdvCacheGen;
+
+    size_t advBatchSize;
+    uint64_t advPacingWindow;
+    uint64_t advPacingInterval;
+    std::deque<std::string> pendingAllEps;
+    // whether the next round for all endpoints is paced; the
+    // initial round after start or reconnect is not
+    bool pacedEpAdvRound;
+    std::unique_ptr<boost::asio::deadline_timer> advPacingTimer;
+    void onAdvPacingTimer(const boost::system::error_code& ec);
+
     /**
      * Synchronously send endpoint gratuitous advertisements for all
      * active endpoints.
+     *
+     * @param paced spread the advertisements across the pacing
+     * window rather than sending them at once
      */
-    void sendAllEndpointAdvs();
+    void sendAllEndpointAdvs(bool paced);
 
     /**
      * Synchronously send service gratuitous advertisements for all
@@ -184,6 +184,16 @@ private:
      */
     int WaitOnBarrier(OfpBuf& barrReq);
 
+    /**
+     * Completion for a message associated with a barrier request.
+     * Records a failure to write the message as the status of the
+     * request.
+     * @param barrXid ID of the barrier request
+     * @param err the result of writing the message
+     * @param barrier true if the message is the barrier request itself
+     */
+    void SendDone(uint32_t barrXid, int err, bool barrier);
+
     SwitchConnection *swConn;
 
     /**
@@ -35,6 +35,8 @@
 
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace opflexagent {
 
@@ -207,6 +209,16 @@ public:
             AdvertManager::EndpointAdvMode tunnelMode,
             uint64_t tunnelAdvIntvl=600);
 
+    /**
+     * Set the parameters used to pace the periodic advertisements for
+     * all endpoints
+     *
+     * @param batchSize the maximum number of endpoints in a batch
+     * @param window the pacing window in milliseconds
+     * @see AdvertManager::setEndpointAdvPacing
+     */
+    void setEndpointAdvPacing(size_t batchSize, uint64_t window);
+
     /**
      * Set the multicast group file
      * @param mcastGroupFile The file where multicast group
@@ -223,6 +235,53 @@ public:
     void setDropLog(const string& dropLogPort, const string& dropLogRemoteIp,
             const uint16_t dropLogRemotePort);
 
+    /**
+     * Observation domain IDs for sampled service traffic
+     */
+    enum PodSvcSampleDomain {
+        /** Traffic from a client to a service */
+        SAMPLE_TO_SERVICE = 1,
+        /** Traffic from a service back to a client */
+        SAMPLE_FROM_SERVICE = 2
+    };
+
+    /**
+     * Account for pod<-->svc traffic by sampling instead of with a
+     * stats flow for every endpoint and service IP pair.  The
+     * load-balancing flows of each service sample packets to the
+     * given flow sample collector set, with the service's ID as the
+     * observation point and a PodSvcSampleDomain as the observation
+     * domain.  Must be called before start().
+     *
+     * @param probability the fraction of packets to sample, out of
+     * 65535, or 0 to use pod<-->svc stats flows
+     * @param collectorSetId the flow sample collector set ID
+     */
+    void setPodSvcSampling(uint16_t probability, uint32_t collectorSetId);
+
+    /**
+     * Select next hops for services with more than one next hop
+     * using a Maglev lookup table of the given size, so that next hop
+     * changes only move the connections of the affected next hops.
+     * Otherwise the next hop is selected with a hash modulo the
+     * number of next hops.  Must be called before start().
+     *
+     * @param tableSize the number of slots in the lookup table, which
+     * is rounded up to a prime, or 0 to disable
+     */
+    void setMaglevTableSize(uint32_t tableSize);
+
+    /**
+     * Enable or disable incremental endpoint flow updates.  When
+     * enabled, an endpoint update regenerates only the groups of
+     * endpoint flows whose inputs changed since the last update of
+     * the endpoint; otherwise every update regenerates all of them.
+     * Enabled by default.  Must be called before start().
+     *
+     * @param enabled true to regenerate only the changed flow groups
+     */
+    void setIncrementalEndpointFlows(bool enabled);
+
     /**
      * Get the openflow port that maps to the configured tunnel
      * interface
@@ -332,6 +391,19 @@ public:
         const std::unordered_set<opflex::modb::URI>& uris,
         /* out */std::unordered_set<uint32_t>& ids);
 
+    /**
+     * Get the set of vnids for the given endpoint groups or external
+     * networks, using the endpoint group state from a policy snapshot
+     *
+     * @param policy the policy snapshot
+     * @param uris URIs of endpoint groups to search for
+     * @param ids the corresponding set of vnids
+     */
+    void getGroupVnid(
+        const PolicyManager::Snapshot& policy,
+        const std::unordered_set<opflex::modb::URI>& uris,
+        /* out */std::unordered_set<uint32_t>& ids);
+
     /**
      * Get or generate a unique ID for a given object for use with flows.
      *
@@ -507,6 +579,41 @@ public:
         }
         return true;
     }
+
+    /**
+     * Get the UUID of the service whose load-balancing flows sample
+     * with the given observation point ID
+     *
+     * @param obsPointId the observation point ID
+     * @return the service UUID, or boost::none if not known
+     */
+    boost::optional<std::string> getSampledServiceUuid(uint32_t obsPointId);
+
+    /**
+     * Add sampled traffic to the pod<-->svc counters for an endpoint
+     * and service, creating the counters if needed
+     *
+     * @param isEpToSvc true for traffic from the endpoint to the
+     * service
+     * @param uuid the pod<-->svc uuid, "ep-uuid:svc-uuid"
+     * @param pkts the number of packets to add
+     * @param bytes the number of bytes to add
+     */
+    void updatePodSvcSampledCounters(bool isEpToSvc,
+                                     const std::string& uuid,
+                                     uint64_t pkts, uint64_t bytes);
+
+    /**
+     * Remove the sampled pod<-->svc counters for an endpoint and
+     * service
+     *
+     * @param isEpToSvc true for traffic from the endpoint to the
+     * service
+     * @param uuid the pod<-->svc uuid, "ep-uuid:svc-uuid"
+     */
+    void clearPodSvcSampledCounters(bool isEpToSvc,
+                                    const std::string& uuid);
+
     /**
      * Populate TableDescriptionMap for this FlowManager
      * for use by drop counters.
@@ -522,12 +629,49 @@ private:
     void createStaticFlows();
 
     /**
-     * Compare and update flow/group tables due to changes in an remote
-     * endpoint.
+     * Compare and update flow/group tables due to changes in the
+     * remote endpoints that were updated since the last batch.  The
+     * forwarding state of each endpoint group is resolved once for
+     * all of its endpoints, and each table is written as a single
+     * edit.
+     */
+    void handleRemoteEndpointBatch();
+
+    /**
+     * The state shared by the remote endpoints of an endpoint group
+     * in a batch
+     */
+    struct RemoteEpGroupCtx {
+        RemoteEpGroupCtx()
+            : epgVnid(0), rdId(0), bdId(0), fgrpId(0),
+              hostAccessChecked(false), hasHostMac(false), hostPort(0) {}
+
+        uint32_t epgVnid;
+        uint32_t rdId;
+        uint32_t bdId;
+        uint32_t fgrpId;
+        /* host access is looked up once per batch, when needed */
+        bool hostAccessChecked;
+        bool hasHostMac;
+        uint32_t hostPort;
+        uint8_t hostMac[6];
+    };
+
+    /**
+     * Generate the flows for a remote endpoint in a group that has
+     * forwarding state.
      *
-     * @param uuid UUID of the changed remote endpoint
+     * @param ep the remote endpoint
+     * @param ctx the forwarding state of the endpoint's group
+     * @param elSrc the flows for the source table
+     * @param elBridgeDst the flows for the bridge table
+     * @param elRouteDst the flows for the route table
      */
-    void handleRemoteEndpointUpdate(const std::string& uuid);
+    void addRemoteEndpointFlows(modelgbp::inv::RemoteInventoryEp& ep,
+                                RemoteEpGroupCtx& ctx,
+                                FlowEntryList& elSrc,
+                                FlowEntryList& elBridgeDst,
+                                FlowEntryList& elRouteDst);
 
     /**
      * Compare and update flow/group tables due to changes in an endpoint.
@@ -536,6 +680,88 @@ private:
      */
     void handleEndpointUpdate(const std::string& uuid);
 
+    /**
+     * The inputs to the flows of a local endpoint: the endpoint
+     * fields and the forwarding state they resolve to.  The inputs
+     * from the last update of an endpoint determine which groups of
+     * its flows must be regenerated on the next one.
+     */
+    struct EndpointFlowInputs {
+        /**
+         * Groups of endpoint flows that are regenerated
+         * independently.  The IP address mapping and SNAT flows are
+         * written under their own object IDs, the others under the
+         * endpoint UUID.
+         */
+        enum {
+            FLOWS_SEC         = 1 << 0,
+            FLOWS_SRC         = 1 << 1,
+            FLOWS_BRIDGE      = 1 << 2,
+            FLOWS_ROUTE       = 1 << 3,
+            FLOWS_SERVICE_DST = 1 << 4,
+            FLOWS_OUT         = 1 << 5,
+            FLOWS_IPM         = 1 << 6,
+            FLOWS_SNAT        = 1 << 7,
+            FLOWS_ALL         = (1 << 8) - 1
+        };
+
+        /**
+         * An IP address mapping with its forwarding state resolved
+         */
+        struct IpMapping {
+            boost::asio::ip::address mappedIp;
+            boost::asio::ip::address floatingIp;
+            uint32_t epgVnid, rdId, bdId, fdId;
+            uint32_t nextHopPort;
+            boost::optional<opflex::modb::MAC> nextHopMac;
+
+            bool operator==(const IpMapping& other) const;
+        };
+
+        /**
+         * A local SNAT IP used by the endpoint
+         */
+        struct SnatIp {
+            std::shared_ptr<const Snat> snat;
+            uint32_t port;
+            uint16_t zoneId;
+
+            bool operator==(const SnatIp& other) const;
+        };
+
+        // inputs to every group
+        uint32_t ofPort, tunnelPort;
+        uint32_t epgVnid, rdId, bdId, fgrpId;
+        bool hasForwardingInfo;
+        uint8_t arpMode, ndMode, unkFloodMode, bcastFloodMode;
+        uint8_t routingMode;
+        EncapType encapType;
+        bool virtualRouterEnabled, virtualDHCPEnabled;
+        opflex::modb::MAC routerMac, dhcpMac;
+        boost::optional<opflex::modb::MAC> mac;
+        std::unordered_set<std::string> ips;
+        bool external;
+
+        // inputs to some of the groups
+        bool promiscuousMode, natMode, discoveryProxyMode, aapModeAA;
+        Endpoint::virt_ip_set virtualIps;
+        std::unordered_set<std::string> anycastReturnIps;
+        bool dhcpv4, dhcpv6;
+        boost::optional<std::string> dhcpv4ServerIp;
+        boost::optional<opflex::modb::MAC> dhcpv4ServerMac;
+        std::vector<IpMapping> ipMappings;
+        std::vector<SnatIp> snatIps;
+
+        /**
+         * Get the groups of flows whose inputs differ from the
+         * inputs of a previous update
+         *
+         * @param prev the inputs of the previous update
+         * @return a mask of FLOWS_* values
+         */
+        uint32_t getChanges(const EndpointFlowInputs& prev) const;
+    };
+
     /**
      * Compare and update flow/group tables due to changes in an
      * service.
@@ -763,15 +989,17 @@ private:
     /**
      * Get Forwarding Info for a given EpGroup
      *
+     * @param policy the policy snapshot to read the group state from
      * @param snatIp the snat ip affected
      * @param snatUuid the snat uuid for the snat object
      */
-    bool getGroupForwardingInfo(const opflex::modb::URI& egUri, uint32_t& vnid,
+    bool getGroupForwardingInfo(const PolicyManager::Snapshot& policy,
+            const opflex::modb::URI& egUri, uint32_t& vnid,
             boost::optional<opflex::modb::URI>& rdURI, uint32_t& rdId,
             boost::optional<opflex::modb::URI>& bdURI, uint32_t& bdId,
             boost::optional<opflex::modb::URI>& fdURI, uint32_t& fdId);
 
-    void updateGroupSubnets(const opflex::modb::URI& egUri,
+    void updateGroupSubnets(const PolicyManager::Snapshot::GroupInfo& group,
                             uint32_t bdId, uint32_t rdId);
     /**
      * Apply appropriate flood action on the EPG
@@ -861,6 +1089,24 @@ private:
     boost::asio::ip::address dropLogDst;
     uint16_t dropLogRemotePort;
     bool serviceStatsFlowDisabled;
+    uint16_t podSvcSampleProbability;
+    uint32_t podSvcSampleCollectorSetId;
+    uint32_t maglevTableSize;
+    bool incrementalEpFlows;
+
+    /**
+     * Flow inputs from the last update of each local endpoint, used
+     * only from the task queue
+     */
+    std::unordered_map<std::string, EndpointFlowInputs> epFlowInputs;
+
+    /**
+     * Check whether next hops are selected with a Maglev lookup
+     * table for a service mapping with the given number of next hops
+     */
+    bool useMaglev(size_t nextHops) const {
+        return maglevTableSize != 0 && nextHops > 1;
+    }
 
     /* Map containing ingress and egress cookie: Flows generated out
      * of same pod<-->svc uuid will use these cookies */
@@ -883,6 +1129,10 @@ private:
     // Lock to safe guard svcstat related state
     std::mutex svcStatMutex;
 
+    // Remote endpoints updated since the last batch was taken
+    std::mutex remoteEpMutex;
+    unordered_set<std::string> pendingRemoteEps;
+
     /*
      * Map of flood-group URI to the endpoints associated with it.
      * The flood-group can either be a flood-domain or an endpoint-group
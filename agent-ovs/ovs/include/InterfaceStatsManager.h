@@ -99,6 +99,9 @@ public:
                 ofpbuf *msg,
                 struct ofputil_flow_removed* fentry=NULL);
 
+    // see: MessageHandler
+    MessageExecutor* GetExecutor(int type) { return &statsExecutor; }
+
 private:
     Agent* agent;
     PortMapper& intPortMapper;
@@ -108,6 +111,7 @@ private:
     boost::asio::io_service& agent_io;
     long timer_interval;
     std::unique_ptr<boost::asio::deadline_timer> timer;
+    MessageExecutor statsExecutor;
 
     /**
      * Counters for endpoints.
@@ -122,6 +126,8 @@ private:
     std::mutex statMtx;
 
     void on_timer(const boost::system::error_code& ec);
+    // Publish the send queue stats of a switch connection
+    void updateSendQueueStats(SwitchConnection* connection);
     void updateEndpointCounters(const std::string& uuid,
                                 SwitchConnection *swConn,
                                 EndpointManager::EpCounters& counters);
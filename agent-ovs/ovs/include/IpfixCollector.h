@@ -0,0 +1,142 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Definition of IpfixCollector class
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_IPFIXCOLLECTOR_H
+#define OPFLEXAGENT_IPFIXCOLLECTOR_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/ip/address.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace opflexagent {
+
+/**
+ * A minimal IPFIX (RFC 7011) collector for the flow records that OVS
+ * exports for packets sampled with the sample action.
+ *
+ * The collector learns templates as they arrive and decodes each
+ * data record into the fields needed for traffic accounting; other
+ * fields, options records and enterprise-specific elements are
+ * skipped.
+ */
+class IpfixCollector : private boost::noncopyable {
+public:
+    /**
+     * A decoded flow record
+     */
+    struct Record {
+        /**
+         * Observation domain ID from the message header
+         */
+        uint32_t observationDomain;
+        /**
+         * Observation point ID of the record, or 0 if not present
+         */
+        uint32_t observationPoint;
+        /**
+         * Source IP address, if present
+         */
+        boost::asio::ip::address srcAddr;
+        /**
+         * Destination IP address, if present
+         */
+        boost::asio::ip::address dstAddr;
+        /**
+         * Number of sampled packets
+         */
+        uint64_t packets;
+        /**
+         * Number of sampled bytes
+         */
+        uint64_t bytes;
+    };
+
+    /**
+     * Callback for decoded records
+     */
+    typedef std::function<void(const Record&)> record_cb_t;
+
+    /**
+     * Create a collector
+     *
+     * @param io_service the IO service on which to receive messages
+     * and run the callback
+     * @param callback called for each decoded data record
+     */
+    IpfixCollector(boost::asio::io_service& io_service,
+                   const record_cb_t& callback);
+
+    /**
+     * Start listening for IPFIX messages
+     *
+     * @param addr the local address to listen on
+     * @param port the local UDP port to listen on
+     * @return true if the socket was bound
+     */
+    bool start(const boost::asio::ip::address& addr, uint16_t port);
+
+    /**
+     * Stop listening
+     */
+    void stop();
+
+    /**
+     * Decode an IPFIX message and invoke the callback for each data
+     * record in it
+     *
+     * @param data the message
+     * @param len the length of the message
+     * @return false if the message was malformed
+     */
+    bool handleMessage(const uint8_t* data, size_t len);
+
+    /**
+     * Get the number of messages that could not be decoded
+     */
+    uint64_t getMalformed() const { return malformed; }
+
+private:
+    struct Field {
+        uint16_t id;
+        uint16_t length;
+        bool enterprise;
+    };
+
+    bool handleTemplateSet(uint32_t domain, const uint8_t* p,
+                           const uint8_t* end, bool options);
+    bool handleDataSet(uint32_t domain, uint16_t setId,
+                       const uint8_t* p, const uint8_t* end);
+    void startReceive();
+    void handleReceive(const boost::system::error_code& ec,
+                       size_t bytes);
+
+    boost::asio::ip::udp::socket socket;
+    boost::asio::ip::udp::endpoint remoteEndpoint;
+    std::array<uint8_t, 65536> buffer;
+    record_cb_t callback;
+    bool stopped;
+    uint64_t malformed;
+
+    // templates keyed by observation domain and template ID
+    std::unordered_map<uint64_t, std::vector<Field> > templates;
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_IPFIXCOLLECTOR_H */
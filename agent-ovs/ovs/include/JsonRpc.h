@@ -198,6 +198,24 @@ public:
     */
     bool deleteIpfix(const string& brName);
 
+    /**
+     * create a flow sample collector set on the bridge that exports
+     * packets sampled with the sample action over IPFIX
+     * @param[in] brUuid uuid of the bridge
+     * @param[in] id ID of the collector set, as used in sample actions
+     * @param[in] target IPFIX collector address as ip:port
+     * @return bool true if created successfully, false otherwise.
+    */
+    bool createFlowSampleCollectorSet(const string& brUuid, uint32_t id,
+                                      const string& target);
+
+    /**
+     * delete the flow sample collector sets on the bridge
+     * @param[in] brUuid uuid of the bridge
+     * @return true if success, false otherwise.
+    */
+    bool deleteFlowSampleCollectorSets(const string& brUuid);
+
     /**
      * retrieve uuid from response
      * @param[in] payload body of the response
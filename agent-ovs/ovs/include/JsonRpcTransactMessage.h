@@ -38,7 +38,8 @@ enum class OvsdbOperation {SELECT, INSERT, UPDATE, MUTATE, DELETE};
 /**
  * OVSDB tables
  */
-enum class OvsdbTable {PORT, INTERFACE, BRIDGE, IPFIX, NETFLOW, MIRROR};
+enum class OvsdbTable {PORT, INTERFACE, BRIDGE, IPFIX, NETFLOW, MIRROR,
+                       FLOW_SAMPLE_COLLECTOR_SET};
 
 /**
  * OVSDB functions
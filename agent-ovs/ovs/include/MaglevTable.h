@@ -0,0 +1,84 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Definition of MaglevTable class
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_MAGLEVTABLE_H
+#define OPFLEXAGENT_MAGLEVTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace opflexagent {
+
+/**
+ * Consistent hashing of flows to backends with a Maglev lookup
+ * table.
+ *
+ * Each backend derives a permutation of the table slots from its
+ * name, and backends take turns claiming their next preferred free
+ * slot until the table is full.  The result depends only on the set
+ * of backend names, and adding or removing one of N backends moves
+ * about 1/N of the slots.
+ */
+class MaglevTable {
+public:
+    /**
+     * Default table size
+     */
+    static const uint32_t DEFAULT_SIZE = 251;
+
+    /**
+     * Check whether a number is prime; the table size must be prime
+     * for every backend permutation to cover the whole table.
+     *
+     * @param n the number to check
+     * @return true if n is prime
+     */
+    static bool isPrime(uint32_t n);
+
+    /**
+     * Get the least prime not smaller than n
+     *
+     * @param n the lower bound
+     * @return the prime
+     */
+    static uint32_t nextPrime(uint32_t n);
+
+    /**
+     * Populate the lookup table
+     *
+     * @param backends the backend names, which must be distinct
+     * @param size the table size, which must be prime
+     * @param table receives, for each slot, the index in backends of
+     * the backend that owns the slot.  Empty if there are no
+     * backends.
+     */
+    static void populate(const std::vector<std::string>& backends,
+                         uint32_t size, std::vector<uint32_t>& table);
+
+    /**
+     * Get identifiers for the backends that are stable as other
+     * backends come and go, for use as link numbers in flows.  The
+     * identifiers are not smaller than size, so they cannot be
+     * confused with a slot number.
+     *
+     * @param backends the backend names, which must be distinct
+     * @param size the table size
+     * @param ids receives the identifier for each backend
+     */
+    static void getLinkIds(const std::vector<std::string>& backends,
+                           uint32_t size, std::vector<uint32_t>& ids);
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_MAGLEVTABLE_H */
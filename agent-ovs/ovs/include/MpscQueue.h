@@ -0,0 +1,89 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Definition of MpscQueue class
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#ifndef OPFLEXAGENT_MPSCQUEUE_H_
+#define OPFLEXAGENT_MPSCQUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+namespace opflexagent {
+
+/**
+ * An unbounded FIFO queue that any number of threads may push to
+ * without locking, and that a single thread at a time may pop from.
+ *
+ * Pushing is a single atomic exchange.  A push that has not finished
+ * linking its node can make the queue briefly look empty to the
+ * consumer even though later pushes have completed, so a consumer
+ * that needs to see everything must keep its own count of pushed
+ * items and come back if pop() fails while that count is non-zero.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(new Node()), tail(head.load()) {}
+
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {}
+        delete tail;
+    }
+
+    /**
+     * Add a value to the back of the queue.  Safe to call from any
+     * thread.
+     *
+     * @param value the value to add
+     */
+    void push(T&& value) {
+        Node* node = new Node(std::move(value));
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * Remove the value at the front of the queue.  Must only be
+     * called by one thread at a time.
+     *
+     * @param value set to the removed value
+     * @return true if a value was removed
+     */
+    bool pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return false;
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        Node() : next(nullptr) {}
+        explicit Node(T&& value_) : next(nullptr), value(std::move(value_)) {}
+
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    // producers append here
+    std::atomic<Node*> head;
+    // the consumer's stub node; its successor is the front of the queue
+    Node* tail;
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_MPSCQUEUE_H_ */
@@ -25,6 +25,8 @@
 #include "CtZoneManager.h"
 #include "SpanRenderer.h"
 #include "NetFlowRenderer.h"
+#include "PodSvcSampler.h"
+#include "MaglevTable.h"
 #include "PacketLogHandler.h"
 
 #pragma once
@@ -105,6 +107,8 @@ private:
     AdvertManager::EndpointAdvMode endpointAdvMode;
     AdvertManager::EndpointAdvMode tunnelEndpointAdvMode;
     uint64_t tunnelEndpointAdvIntvl;
+    size_t endpointAdvBatchSize;
+    uint64_t endpointAdvPacingWindow;
     bool virtualDHCP;
     std::string virtualDHCPMac;
     std::string flowIdCache;
@@ -112,6 +116,13 @@ private:
     bool connTrack;
     uint16_t ctZoneRangeStart;
     uint16_t ctZoneRangeEnd;
+    uint32_t maglevTableSize;
+    size_t pktInThreads;
+    size_t pktInQueueDepth;
+    uint32_t pktInPortRate;
+    uint32_t pktInPortBurst;
+    size_t flowBatchMaxEdits;
+    long flowBatchMaxDelay;
     bool ovsdbUseLocalTcpPort;
 
     bool ifaceStatsEnabled;
@@ -121,6 +132,11 @@ private:
     bool serviceStatsFlowDisabled;
     bool serviceStatsEnabled;
     long serviceStatsInterval;
+    bool podSvcSampled;
+    uint32_t podSvcSamplingRate;
+    uint16_t podSvcCollectorPort;
+    size_t podSvcTopK;
+    size_t podSvcSketchSize;
     bool secGroupStatsEnabled;
     long secGroupStatsInterval;
     bool tableDropStatsEnabled;
@@ -129,6 +145,7 @@ private:
     std::unique_ptr<OvsdbConnection> ovsdbConnection;
     SpanRenderer spanRenderer;
     NetFlowRenderer netflowRenderer;
+    PodSvcSampler podSvcSampler;
 
     bool started;
     std::string dropLogIntIface, dropLogAccessIface, dropLogRemoteIp;
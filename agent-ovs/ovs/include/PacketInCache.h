@@ -0,0 +1,205 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Definition of PacketInCache class
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_PACKETINCACHE_H
+#define OPFLEXAGENT_PACKETINCACHE_H
+
+#include <opflexagent/Endpoint.h>
+#include <opflex/modb/MAC.h>
+#include <opflex/modb/URI.h>
+
+#include <boost/asio/ip/address_v6.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace opflexagent {
+
+/**
+ * Cache of the state needed to answer DHCP and neighbor discovery
+ * packet-ins, so that a storm of requests from booting endpoints
+ * does not resolve the endpoint, parse its configuration and encode
+ * a reply from scratch for each packet.
+ *
+ * Endpoint entries are kept per interface and client MAC, and router
+ * advertisements per endpoint group and source MAC.  Entries are
+ * immutable once added and are shared with the handlers using them.
+ * The owner must invalidate them when endpoints or policy change;
+ * an entry built from state read before an invalidation is not
+ * added, which is detected with a generation number.
+ */
+class PacketInCache : private boost::noncopyable {
+public:
+    /**
+     * Resolved state for a client MAC on an interface
+     */
+    struct EndpointEntry {
+        /**
+         * The endpoint the client MAC belongs to
+         */
+        std::shared_ptr<const Endpoint> ep;
+
+        /**
+         * A DHCPv4 reply for the endpoint with its options encoded,
+         * which needs only the message type and transaction ID
+         * patched.  Empty if the endpoint has no valid DHCPv4
+         * configuration.
+         */
+        std::vector<uint8_t> dhcpv4Reply;
+
+        /**
+         * The address offered by DHCPv4, in host byte order
+         */
+        uint32_t dhcpv4Ip = 0;
+
+        /**
+         * The IPv6 addresses of the endpoint, for DHCPv6
+         */
+        std::vector<boost::asio::ip::address_v6> dhcpv6Ips;
+    };
+
+    /**
+     * A shared reference to an endpoint entry
+     */
+    typedef std::shared_ptr<const EndpointEntry> ep_entry_ptr;
+
+    /**
+     * A shared reference to an encoded packet
+     */
+    typedef std::shared_ptr<const std::vector<uint8_t> > frame_ptr;
+
+    PacketInCache();
+
+    /**
+     * Get the generation number, to be read before the state used to
+     * build a new entry is read
+     *
+     * @return the generation number
+     */
+    uint64_t getGeneration() const { return generation; }
+
+    /**
+     * Look up the entry for a client MAC on an interface
+     *
+     * @param iface the interface name
+     * @param mac the client MAC
+     * @return the entry, or an empty pointer on a miss
+     */
+    ep_entry_ptr getEndpoint(const std::string& iface,
+                             const opflex::modb::MAC& mac);
+
+    /**
+     * Add the entry for a client MAC on an interface
+     *
+     * @param iface the interface name
+     * @param mac the client MAC
+     * @param entry the entry to add
+     * @param generation the generation number read before the
+     * entry was built.  The entry is not added if the cache was
+     * invalidated since.
+     */
+    void putEndpoint(const std::string& iface,
+                     const opflex::modb::MAC& mac,
+                     const ep_entry_ptr& entry,
+                     uint64_t generation);
+
+    /**
+     * Look up the router advertisement for an endpoint group
+     *
+     * @param egUri the endpoint group
+     * @param srcMac the source MAC of the advertisement
+     * @return the advertisement, or an empty pointer on a miss
+     */
+    frame_ptr getRouterAdvert(const opflex::modb::URI& egUri,
+                              const opflex::modb::MAC& srcMac);
+
+    /**
+     * Add the router advertisement for an endpoint group
+     *
+     * @param egUri the endpoint group
+     * @param srcMac the source MAC of the advertisement
+     * @param frame the encoded advertisement
+     * @param generation the generation number read before the
+     * advertisement was built
+     */
+    void putRouterAdvert(const opflex::modb::URI& egUri,
+                         const opflex::modb::MAC& srcMac,
+                         const frame_ptr& frame,
+                         uint64_t generation);
+
+    /**
+     * Invalidate the entries for an endpoint that was updated or
+     * removed, and for any other client on its current interface.
+     *
+     * @param uuid the UUID of the endpoint
+     * @param iface the current interface of the endpoint, if it
+     * still exists and has one
+     */
+    void invalidateEndpoint(const std::string& uuid,
+                            const boost::optional<std::string>& iface);
+
+    /**
+     * Invalidate the router advertisements for an endpoint group
+     *
+     * @param egUri the endpoint group
+     */
+    void invalidateGroup(const opflex::modb::URI& egUri);
+
+    /**
+     * Invalidate all router advertisements, for example when a
+     * routing domain or subnet changes
+     */
+    void invalidateRouterAdverts();
+
+    /**
+     * Invalidate everything
+     */
+    void clear();
+
+    /**
+     * Get the number of cache hits
+     */
+    uint64_t getHits() const { return hits; }
+
+    /**
+     * Get the number of cache misses
+     */
+    uint64_t getMisses() const { return misses; }
+
+private:
+    typedef std::unordered_map<opflex::modb::MAC, ep_entry_ptr> mac_map_t;
+    typedef std::unordered_map<opflex::modb::MAC, frame_ptr> ra_map_t;
+
+    std::mutex cacheMtx;
+    std::atomic<uint64_t> generation;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+    // interface name -> client MAC -> entry
+    std::unordered_map<std::string, mac_map_t> ifaceEntries;
+    // endpoint UUID -> interface its entries are under
+    std::unordered_map<std::string, std::string> uuidIfaces;
+    // endpoint group -> source MAC -> advertisement
+    std::unordered_map<opflex::modb::URI, ra_map_t> routerAdverts;
+
+    void eraseIface(const std::string& iface);
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_PACKETINCACHE_H */
@@ -18,7 +18,13 @@
 #include "PortMapper.h"
 #include "FlowReader.h"
 #include "TableState.h"
+#include "PacketInCache.h"
 #include <opflexagent/Agent.h>
+#include <opflexagent/EndpointListener.h>
+#include <opflexagent/PolicyListener.h>
+#include <opflexagent/KeyedRateLimiter.h>
+
+#include <atomic>
 
 struct dp_packet;
 struct flow;
@@ -29,9 +35,18 @@ namespace opflexagent {
 class IntFlowManager;
 
 /**
- * Handler for packet-in messages arriving from the switch
+ * Handler for packet-in messages arriving from the switch.
+ *
+ * Packet-ins are handled on a bounded pool of worker threads, and
+ * the DHCP and neighbor discovery requests of each switch port are
+ * rate limited so that a storm of requests from one port cannot
+ * starve the others.  The state needed to answer
+ * DHCP and router solicitations is cached while the handler is
+ * started, and invalidated by endpoint and policy updates.
  */
 class PacketInHandler : public MessageHandler,
+                        public EndpointListener,
+                        public PolicyListener,
                         private boost::noncopyable {
 public:
     /**
@@ -39,6 +54,49 @@ public:
      */
     PacketInHandler(Agent& agent, IntFlowManager& intFlowManager);
 
+    /**
+     * Default number of packet-in worker threads
+     */
+    static const size_t DEFAULT_THREADS = 2;
+
+    /**
+     * Default maximum number of packet-ins waiting for a worker
+     */
+    static const size_t DEFAULT_QUEUE_DEPTH = 1024;
+
+    /**
+     * Default sustained rate of DHCP and neighbor discovery
+     * packet-ins allowed per port, per second
+     */
+    static const uint32_t DEFAULT_PORT_RATE = 50;
+
+    /**
+     * Default DHCP and neighbor discovery packet-in burst allowed per
+     * port
+     */
+    static const uint32_t DEFAULT_PORT_BURST = 100;
+
+    /**
+     * Set the size of the packet-in worker pool.  Must be called
+     * before start().
+     *
+     * @param threads the number of worker threads, or 0 to handle
+     * packet-ins on the connection thread
+     * @param queueDepth the maximum number of packet-ins waiting for
+     * a worker; more are dropped
+     */
+    void setWorkerPool(size_t threads, size_t queueDepth);
+
+    /**
+     * Set the rate limit applied to the DHCP and neighbor discovery
+     * packet-ins of each port
+     *
+     * @param rate the sustained number of packet-ins per second
+     * allowed from a port, or 0 for no limit
+     * @param burst the number of packet-ins allowed in a burst
+     */
+    void setPortRateLimit(uint32_t rate, uint32_t burst);
+
     /**
      * Set the port mapper to use
      * @param intMapper the integration bridge port mapper
@@ -80,7 +138,43 @@ public:
                         ofpbuf *msg,
                         struct ofputil_flow_removed* fentry=NULL);
 
+
+    // ****************
+    // EndpointListener
+    // ****************
+
+    virtual void endpointUpdated(const std::string& uuid);
+
+    // **************
+    // PolicyListener
+    // **************
+
+    virtual void egDomainUpdated(const opflex::modb::URI& egURI);
+    virtual void domainUpdated(opflex::modb::class_id_t cid,
+                               const opflex::modb::URI& domURI);
+
+    /**
+     * Get the DHCP and neighbor discovery reply cache
+     */
+    PacketInCache& getCache() { return cache; }
+
+    /**
+     * Get the number of DHCP and neighbor discovery packet-ins
+     * dropped by the per-port rate limit
+     */
+    uint64_t getRateLimited() const { return rateLimited; }
+
+    /**
+     * Get the number of packet-ins dropped because the worker pool
+     * queue was full
+     */
+    uint64_t getQueueDropped() { return pktInExecutor.getDropped(); }
+
 private:
+    bool isRateLimited(const struct ofputil_packet_in& pi);
+    void handlePacketIn(SwitchConnection* conn,
+                        struct ofputil_packet_in& pi);
+
     Agent& agent;
     IntFlowManager& intFlowManager;
     PortMapper* intPortMapper;
@@ -88,6 +182,14 @@ private:
     FlowReader* intFlowReader;
     SwitchConnection* intSwConnection;
     SwitchConnection* accSwConnection;
+
+    size_t workerThreads;
+    MessageExecutor pktInExecutor;
+    KeyedTokenBucket<uint32_t> portLimiter;
+    std::atomic<uint64_t> rateLimited;
+
+    PacketInCache cache;
+    std::atomic<bool> cacheEnabled;
 };
 } /* namespace opflexagent */
 
@@ -135,6 +135,23 @@ OfpBuf compose_icmp6_router_ad(const uint8_t* srcMac,
                                const opflex::modb::URI& egUri,
                                PolicyManager& polMgr);
 
+/**
+ * Rewrite the destination of a router advertisement composed by
+ * compose_icmp6_router_ad, so that an advertisement built once for
+ * an endpoint group can be reused for each solicitation.  The ICMPv6
+ * checksum is recomputed.
+ *
+ * @param frame the router advertisement frame
+ * @param len the length of the frame
+ * @param dstMac the new destination MAC
+ * @param dstIp the new destination IP
+ * @return false if the frame is too short to be a router
+ * advertisement
+ */
+bool patch_icmp6_router_ad(uint8_t* frame, size_t len,
+                           const uint8_t* dstMac,
+                           const struct in6_addr* dstIp);
+
 /**
  * A convenience typedef for static routes
  */
@@ -173,6 +190,21 @@ OfpBuf compose_dhcpv4_reply(uint8_t message_type,
                             const boost::optional<uint16_t>& interfaceMtu,
                             const boost::optional<uint32_t>& leaseTime);
 
+/**
+ * Rewrite the message type and transaction ID of a DHCPv4 reply
+ * composed by compose_dhcpv4_reply, so that a reply built once for
+ * an endpoint can be reused for each of its requests.  The UDP
+ * checksum is recomputed.
+ *
+ * @param frame the DHCPv4 reply frame
+ * @param len the length of the frame
+ * @param message_type the new message type
+ * @param xid the new transaction ID
+ * @return false if the frame is too short to be a DHCPv4 reply
+ */
+bool patch_dhcpv4_reply(uint8_t* frame, size_t len,
+                        uint8_t message_type, uint32_t xid);
+
 /**
  * Compose a DHCPv6 Advertise or Reply message
  *
@@ -0,0 +1,154 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Include file for PodSvcSampler
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEXAGENT_PODSVCSAMPLER_H
+#define OPFLEXAGENT_PODSVCSAMPLER_H
+
+#include "JsonRpcRenderer.h"
+#include "IntFlowManager.h"
+#include "IpfixCollector.h"
+#include <opflexagent/HeavyHitterSketch.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/ip/address.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace opflexagent {
+
+/**
+ * Maintain pod<-->svc counters from sampled traffic instead of
+ * exact per-pair stats flows.
+ *
+ * The load-balancing flows of each service sample packets to a flow
+ * sample collector set that this renderer creates on the integration
+ * bridge.  OVS exports the samples over IPFIX to a local collector,
+ * which feeds a heavy-hitter sketch keyed by service, direction and
+ * client address.  Periodically the heaviest pairs are resolved to
+ * endpoints and services and published through the pod<-->svc
+ * counters of the IntFlowManager, scaled up by the inverse of the
+ * sampling probability.
+ * Pairs that fall out of the top K have their counters removed.
+ */
+class PodSvcSampler : public JsonRpcRenderer,
+                      private boost::noncopyable {
+public:
+    /**
+     * ID of the flow sample collector set used for pod<-->svc
+     * sampling
+     */
+    static const uint32_t COLLECTOR_SET_ID = 1;
+
+    /**
+     * The largest supported sampling rate.  Sample actions take a
+     * probability out of 65535, so one in 65535 is the lowest rate
+     * OVS can sample at.
+     */
+    static const uint32_t MAX_SAMPLING_RATE = 65535;
+
+    /**
+     * Create a sampler
+     *
+     * @param agent the agent object
+     * @param intFlowManager the flow manager that owns the counters
+     */
+    PodSvcSampler(Agent& agent, IntFlowManager& intFlowManager);
+
+    /**
+     * Configure the sampler.  Must be called before start().
+     *
+     * @param samplingRate sample one in this many packets; rates
+     * above MAX_SAMPLING_RATE are clamped
+     * @param collectorPort local UDP port for the IPFIX collector
+     * @param topK the number of pod<-->svc pairs to publish
+     * @param sketchSize the number of pairs tracked by the sketch
+     * @param exportInterval interval between exports in milliseconds
+     */
+    void setConfig(uint32_t samplingRate, uint16_t collectorPort,
+                   size_t topK, size_t sketchSize, long exportInterval);
+
+    /**
+     * Get the sampling probability to use in sample actions, out of
+     * 65535
+     */
+    uint16_t getProbability() const;
+
+    /**
+     * Start the sampler
+     * @param swName Switch to connect to
+     * @param conn OVSDB connection
+     */
+    virtual void start(const std::string& swName, OvsdbConnection* conn);
+
+    /**
+     * Stop the sampler
+     */
+    void stop();
+
+    /**
+     * Account for a record from the IPFIX collector
+     *
+     * @param record the decoded record
+     */
+    void handleRecord(const IpfixCollector::Record& record);
+
+    /**
+     * Publish the heaviest pairs to the pod<-->svc counters
+     */
+    void exportCounters();
+
+private:
+    struct SampleKey {
+        uint32_t svcId;
+        bool toSvc;
+        boost::asio::ip::address client;
+
+        bool operator==(const SampleKey& o) const {
+            return svcId == o.svcId && toSvc == o.toSvc &&
+                client == o.client;
+        }
+    };
+
+    struct SampleKeyHash {
+        size_t operator()(const SampleKey& k) const noexcept;
+    };
+
+    // direction and "ep-uuid:svc-uuid"
+    typedef std::pair<bool, std::string> counter_key_t;
+
+    IntFlowManager& intFlowManager;
+    IpfixCollector collector;
+    uint32_t samplingRate;
+    uint16_t collectorPort;
+    size_t topK;
+    long exportInterval;
+    std::unique_ptr<HeavyHitterSketch<SampleKey, SampleKeyHash> > sketch;
+    std::unique_ptr<boost::asio::deadline_timer> exportTimer;
+    bool stopping;
+
+    // counters currently published
+    std::set<counter_key_t> publishedCounters;
+
+    bool createCollectorSet();
+    void connectCb(const boost::system::error_code& ec);
+    void onExportTimer(const boost::system::error_code& ec);
+    void scheduleExport();
+};
+
+} /* namespace opflexagent */
+
+#endif /* OPFLEXAGENT_PODSVCSAMPLER_H */
@@ -125,6 +125,12 @@ public:
      */
     virtual void on_timer(const boost::system::error_code& ec) = 0;
 
+    // see: MessageHandler
+    virtual MessageExecutor* GetExecutor(int msgType);
+
+    // see: MessageHandler
+    virtual bool Accepts(int msgType, struct ofpbuf *msg);
+
     /**
      * Size of window of counters to maintain for each classifier
      */
@@ -365,6 +371,12 @@ protected:
      */
     SwitchConnection* connection;
 
+    /**
+     * Decodes flow stats replies and flow removed messages off the
+     * connection thread, in the order they were received
+     */
+    MessageExecutor statsExecutor;
+
     /**
      * timer for periodically querying for stats
      */
@@ -11,23 +11,104 @@
 #define OPFLEXAGENT_SWITCHCONNECTION_H_
 
 #include <queue>
+#include <deque>
 #include <list>
+#include <string>
 #include <unordered_map>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 #include <atomic>
+#include <functional>
+#include <vector>
+
+#include "MpscQueue.h"
+#include "ovs-ofpbuf.h"
 
 
 struct vconn;
 struct ofpbuf;
-class OfpBuf;
 struct ofputil_flow_removed;
 
 namespace opflexagent {
 
 class SwitchConnection;
 
+/**
+ * @brief Runs OpenFlow message handlers on threads of its own, so
+ * that expensive handlers do not hold up the connection thread.
+ * Tasks run in the order they were queued; with a single thread,
+ * each one also finishes before the next starts.  The queue may be
+ * bounded, in which case tasks queued while it is full are dropped.
+ */
+class MessageExecutor {
+public:
+    /**
+     * Create an executor; it does not run anything until started
+     * @param name name used in log messages
+     * @param nthreads number of worker threads
+     * @param maxQueueDepth maximum number of tasks waiting to run,
+     * or 0 for no limit
+     */
+    MessageExecutor(const std::string& name, size_t nthreads = 1,
+                    size_t maxQueueDepth = 0);
+    ~MessageExecutor();
+
+    /**
+     * Start the worker threads
+     */
+    void start();
+
+    /**
+     * Discard queued tasks and wait for the worker threads to exit
+     */
+    void stop();
+
+    /**
+     * Set the number of worker threads and the queue bound.  Only
+     * takes effect when the executor is next started.
+     * @param nthreads number of worker threads
+     * @param maxQueueDepth maximum number of tasks waiting to run,
+     * or 0 for no limit
+     */
+    void setLimits(size_t nthreads, size_t maxQueueDepth);
+
+    /**
+     * Queue a task to run on a worker thread.  If the queue is full
+     * the task is dropped and counted.
+     * @param task the task to run
+     * @return false if the executor is not running
+     */
+    bool execute(std::function<void()>&& task);
+
+    /**
+     * Get the number of tasks waiting to run
+     */
+    size_t getQueueDepth();
+
+    /**
+     * Get the number of tasks dropped because the queue was full
+     */
+    uint64_t getDropped();
+
+private:
+    std::string name;
+    size_t nthreads;
+    size_t maxQueueDepth;
+    uint64_t dropped;
+    bool running;
+    std::mutex queueMtx;
+    std::condition_variable queueCond;
+    std::deque<std::function<void()> > tasks;
+    std::vector<std::thread> workers;
+
+    void run();
+
+    MessageExecutor(const MessageExecutor&) = delete;
+    MessageExecutor& operator=(const MessageExecutor&) = delete;
+};
+
 /**
  * @brief Abstract base-class for a OpenFlow message handler.
  */
@@ -44,6 +125,28 @@ public:
                         int msgType,
                         struct ofpbuf *msg,
                         struct ofputil_flow_removed *fentry=NULL) = 0;
+
+    /**
+     * Get the executor to call Handle() on for a message type.  By
+     * default messages are handled inline on the connection thread,
+     * which suits cheap or latency-sensitive messages.  Handlers that
+     * decode large replies should return an executor of their own;
+     * they then receive a copy of the message.
+     * @param msgType Type of the received message
+     * @return the executor, or NULL to handle the message inline
+     */
+    virtual MessageExecutor* GetExecutor(int msgType) { return NULL; }
+
+    /**
+     * Cheap check made on the connection thread before a message is
+     * handled inline or copied for an executor, so that a handler
+     * does not pay for copies of messages it would ignore, and can
+     * shed load before it reaches its executor.
+     * @param msgType Type of the received message
+     * @param msg The received message
+     * @return true if the message should be passed to Handle()
+     */
+    virtual bool Accepts(int msgType, struct ofpbuf *msg) { return true; }
 };
 
 /**
@@ -74,6 +177,44 @@ public:
      * maximum value for such retries. Amounts to 30s.
      */
     static const uint32_t maxSocketFileMissingFailure = 6;
+
+    /**
+     * Default maximum number of messages waiting to be written to
+     * the switch before senders are made to wait
+     */
+    static const size_t DEFAULT_SEND_QUEUE_LIMIT = 16384;
+
+    /**
+     * Called once a message passed to SendMessageAsync(), or to
+     * SendMessage() with a completion, has been written to the switch
+     * connection (with 0) or dropped (with an openvswitch error
+     * code).  May be called with the connection lock held, so it must
+     * not call back into the connection other than to send.
+     */
+    typedef std::function<void(int)> SendCompletion;
+
+    /**
+     * Counters for the outbound message queue
+     */
+    struct SendQueueStats {
+        /** Messages currently waiting to be written */
+        size_t depth;
+        /** Highest number of messages waiting at once */
+        size_t maxDepth;
+        /** Messages written to the switch connection */
+        uint64_t sent;
+        /** Messages dropped because of an error or lost connection */
+        uint64_t dropped;
+        /** Times the connection thread drained the queue */
+        uint64_t flushes;
+        /** Senders that had to wait for space in the queue */
+        uint64_t blocked;
+        /** Sum of the time messages spent queued, in microseconds */
+        uint64_t totalLatencyUs;
+        /** Longest time a message spent queued, in microseconds */
+        uint64_t maxLatencyUs;
+    };
+
     /**
      * Parse the received flow_removed message and notify listeners.
      * This message requires central handling since this is
@@ -137,11 +278,57 @@ public:
     void UnregisterMessageHandler(int msgType, MessageHandler *handler);
 
     /**
-     * Send an OpenFlow message to the switch.
-     * @return 0 on success, openvswitch error code on failure
+     * Queue an OpenFlow message to be sent to the switch by the
+     * connection thread.  Messages are written in the order they
+     * were queued.  If the queue is full, waits until the connection
+     * thread has made room, unless called from the connection thread
+     * itself.
+     *
+     * The return value only reports whether the message was queued.
+     * An error writing it to the switch later is logged and counted
+     * as dropped in getSendQueueStats(), and messages still queued
+     * when the connection is lost are dropped.  Callers that need
+     * the result of the write pass a completion.
+     *
+     * @param msg the message to send; ownership is taken on success
+     * @return 0 if the message was queued, openvswitch error code on
+     * failure
      */
     virtual int SendMessage(OfpBuf& msg);
 
+    /**
+     * Queue an OpenFlow message as SendMessage(OfpBuf&) does, and
+     * report the result of writing it.
+     * @param msg the message to send; ownership is taken on success
+     * @param done called once the message has been written or
+     * dropped, if it was queued
+     * @return 0 if the message was queued, openvswitch error code on
+     * failure
+     */
+    virtual int SendMessage(OfpBuf& msg, const SendCompletion& done);
+
+    /**
+     * Queue an OpenFlow message to be sent to the switch without
+     * ever waiting.
+     * @param msg the message to send; ownership is taken on success
+     * @param done called once the message has been written or dropped
+     * @return 0 if the message was queued, EAGAIN if the queue is
+     * full, or another openvswitch error code on failure
+     */
+    virtual int SendMessageAsync(OfpBuf& msg, const SendCompletion& done);
+
+    /**
+     * Set the maximum number of messages waiting to be written to the
+     * switch
+     * @param limit the new queue limit
+     */
+    void setSendQueueLimit(size_t limit);
+
+    /**
+     * Get a snapshot of the outbound message queue counters
+     */
+    SendQueueStats getSendQueueStats() const;
+
     /**
      * Returns the OpenFlow protocol version being used by the connection.
      */
@@ -179,6 +366,16 @@ public:
      */
     int receiveOFMessage();
 
+    /**
+     * Pass a received message to the handlers registered for its
+     * type, inline or through their executors.
+     * @param type the decoded OpenFlow message type
+     * @param msg the received message; still owned by the caller
+     * @param fentry decoded flow_removed message
+     */
+    void DispatchMessage(int type, struct ofpbuf *msg,
+                         struct ofputil_flow_removed *fentry);
+
     /**
      * Make the poll-loop watch for activity on poll-event-FD.
      * Needs to be done repeatedly because the poll-loop
@@ -187,6 +384,12 @@ public:
      */
     void WatchPollEvent();
 
+    /**
+     * Consume pending poll-events so that the poll-loop does not
+     * keep waking up for them.
+     */
+    void ClearPollEvent();
+
     /**
      * Cause monitor poll-loop to break-out.
      * @return true if successful in sending event
@@ -203,6 +406,14 @@ public:
      */
     bool IsConnectedLocked();
 
+    /**
+     * Write as many queued messages as the switch connection will
+     * take without blocking, then arrange for the poll loop to wake
+     * up when more can be written.
+     * Must be called from the poll-loop thread.
+     */
+    void flushSendQueue();
+
 protected:
     /**
      * Notify connect listeners of a connect event
@@ -229,6 +440,44 @@ private:
     int pollEventFd;
     std::chrono::time_point<std::chrono::steady_clock> lastEchoTime;
 
+    struct QueuedMessage {
+        QueuedMessage() : msg((struct ofpbuf*)NULL), gen(0) {}
+
+        OfpBuf msg;
+        SendCompletion done;
+        std::chrono::steady_clock::time_point queued;
+        /* sendGen when the message was queued */
+        uint64_t gen;
+    };
+
+    /* Producers push without locking; connMtx holders pop */
+    MpscQueue<QueuedMessage> sendQueue;
+    /* Head of the queue that the switch would not take yet */
+    QueuedMessage sendHead;
+    bool hasSendHead;
+    std::atomic<bool> sendable;
+    /* Incremented on each new connection to the switch */
+    std::atomic<uint64_t> sendGen;
+    std::atomic<size_t> sendQueueDepth;
+    std::atomic<size_t> sendQueueLimit;
+    std::atomic<std::thread::id> connThreadId;
+
+    std::mutex sendSpaceMtx;
+    std::condition_variable sendSpaceCond;
+    std::atomic<int> sendSpaceWaiters;
+
+    std::atomic<size_t> statMaxDepth;
+    std::atomic<uint64_t> statSent;
+    std::atomic<uint64_t> statDropped;
+    std::atomic<uint64_t> statFlushes;
+    std::atomic<uint64_t> statBlocked;
+    std::atomic<uint64_t> statTotalLatencyUs;
+    std::atomic<uint64_t> statMaxLatencyUs;
+
+    int enqueueMessage(OfpBuf& msg, const SendCompletion& done, bool wait);
+    void dropSendQueue();
+    void notifySendSpace();
+
 private:
     /**
      * @brief Handle ECHO requests from the switch by replying immediately.
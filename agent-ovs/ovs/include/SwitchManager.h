@@ -23,8 +23,12 @@
 #include <boost/noncopyable.hpp>
 #include <boost/asio/deadline_timer.hpp>
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace opflexagent {
 
@@ -95,6 +99,55 @@ public:
      */
     void setSyncDelayOnConnect(long delay);
 
+    /**
+     * Default largest number of flow edits in a batch
+     */
+    static const size_t DEFAULT_FLOW_BATCH_MAX_EDITS = 1024;
+
+    /**
+     * Default longest time in milliseconds a flow edit waits in a
+     * batch
+     */
+    static const long DEFAULT_FLOW_BATCH_MAX_DELAY = 10;
+
+    /**
+     * Batch the flow edits from consecutive writes, so that the edits
+     * of many small updates reach the switch together behind a single
+     * barrier.  The edits for each table are kept in order, and a
+     * batch is sent once it holds maxEdits edits, once the oldest
+     * edit has waited maxDelayMs, or once the tasks queued on the
+     * agent IO service stop adding to it, whichever comes first.
+     * Group and TLV writes send any batched flow edits first.
+     *
+     * @param maxEdits the largest number of edits in a batch, or 0 to
+     * send the edits of each write on their own
+     * @param maxDelayMs the longest time an edit waits in a batch
+     */
+    void setFlowBatching(size_t maxEdits, long maxDelayMs);
+
+    /**
+     * Callback for a completed write, called with true if the
+     * switch accepted the flow edits
+     */
+    typedef std::function<void (bool)> write_cb_t;
+
+    /**
+     * Call the callback once the flow edits from the writes so far
+     * have been applied by the switch.  The callback is called right
+     * away when no flow edits are waiting in a batch.
+     *
+     * @param cb the callback to call
+     */
+    void onFlowsWritten(const write_cb_t& cb);
+
+    /**
+     * Send the batched flow edits to the switch and wait for them to
+     * be applied
+     *
+     * @return true is successful, false otherwise
+     */
+    bool flushFlows();
+
     /* Interface: OnConnectListener */
     virtual void Connected(SwitchConnection *swConn);
 
@@ -157,6 +210,23 @@ public:
      */
     bool writeFlow(const std::string& objId, int tableId, FlowEntryPtr e);
 
+    /**
+     * Object IDs along with the flows to write for each of them
+     */
+    typedef std::vector<std::pair<std::string, FlowEntryList> > obj_flows_t;
+
+    /**
+     * Write the flow lists for several objects to the flow table,
+     * sending the changes for all of them to the switch as a single
+     * edit
+     *
+     * @param tableId the tableId for the flow table
+     * @param objFlows the object IDs and the lists of flows to write
+     * for them.  The lists are cleared.
+     * @return true is successful, false otherwise
+     */
+    bool writeFlows(int tableId, obj_flows_t& objFlows);
+
     /**
      * Write a group-table change to the switch
      *
@@ -271,6 +341,22 @@ private:
      */
     void clearSyncState();
 
+    /**
+     * Send the edits for a write to the flow table, or add them to
+     * the current batch
+     */
+    bool executeFlowEdit(int tableId, FlowEdit& diffs,
+                         const std::string& what);
+
+    /**
+     * Drop the batched flow edits, such as when a sync will reconcile
+     * the switch with the table state, and call their callbacks
+     */
+    void dropFlowBatch(bool success);
+
+    void onBatchDrainCheck(uint64_t gen);
+    void onBatchTimer(const boost::system::error_code& ec, uint64_t gen);
+
     Agent& agent;
     FlowExecutor& flowExecutor;
     FlowReader& flowReader;
@@ -302,6 +388,23 @@ private:
     SwitchStateHandler::GroupMap recvGroups;
     bool groupsDone;
 
+    // flow edit batching
+    size_t batchMaxEdits;
+    long batchMaxDelayMs;
+    // held while a batch is taken and sent, so batches are sent in
+    // order
+    std::mutex flushMutex;
+    std::mutex batchMutex;
+    std::vector<FlowEdit> batchEdits;
+    size_t batchSize;
+    size_t batchCheckedSize;
+    // incremented as each batch is taken, so the checks and timer
+    // of a batch ignore the batches after it
+    uint64_t batchGen;
+    bool batchSending;
+    std::vector<write_cb_t> batchCallbacks;
+    std::unique_ptr<boost::asio::deadline_timer> batchTimer;
+
     /*Drop counter table list*/
     TableDescriptionMap tableDescriptionMap;
 
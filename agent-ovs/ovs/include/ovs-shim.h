@@ -238,6 +238,15 @@ extern "C" {
                            uint64_t cookie,
                            uint8_t table);
 
+    /**
+     * sample to a flow sample collector set
+     */
+    void act_sample(struct ofpbuf* buf,
+                    uint16_t probability,
+                    uint32_t collectorSetId,
+                    uint32_t obsDomainId,
+                    uint32_t obsPointId);
+
     /**
      * Load value to tunnel metadata register
      */
@@ -8,6 +8,9 @@
  * and is available at http://www.eclipse.org/legal/epl-v10.html
  */
 
+#include <atomic>
+#include <thread>
+
 #include <boost/test/unit_test.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <openvswitch/ofp-msgs.h>
@@ -34,6 +37,27 @@ public:
     int counter;
 };
 
+class OffloadedEchoReplyHandler : public MessageHandler {
+public:
+    OffloadedEchoReplyHandler() : executor("test"), counter(0) {
+        executor.start();
+    }
+    void Handle(SwitchConnection*,
+                int type,
+                ofpbuf* msg,
+                struct ofputil_flow_removed *) {
+        // runs on the executor, where Boost.Test checks are not safe
+        if (type == OFPTYPE_ECHO_REPLY && msg != NULL &&
+            thread != std::this_thread::get_id())
+            ++counter;
+    }
+    MessageExecutor* GetExecutor(int) { return &executor; }
+
+    MessageExecutor executor;
+    std::thread::id thread;
+    std::atomic<int> counter;
+};
+
 class SimpleConnectListener : public OnConnectListener {
 public:
     SimpleConnectListener() : counter(0) {}
@@ -139,6 +163,68 @@ BOOST_FIXTURE_TEST_CASE(sendrecv, ConnectionFixture) {
     BOOST_CHECK(conn.SendMessage(echoReq) != 0);
 }
 
+BOOST_FIXTURE_TEST_CASE(executor, ConnectionFixture) {
+    SwitchConnection conn(testSwitchName);
+
+    EchoReplyHandler inlineHandler;
+    OffloadedEchoReplyHandler offloadHandler;
+    offloadHandler.thread = std::this_thread::get_id();
+    conn.RegisterMessageHandler(OFPTYPE_ECHO_REPLY, &inlineHandler);
+    conn.RegisterMessageHandler(OFPTYPE_ECHO_REPLY, &offloadHandler);
+
+    BOOST_CHECK(!conn.Connect(OFP13_VERSION));
+
+    const int numEchos = 5;
+    for (int i = 0; i < numEchos; ++i) {
+        OfpBuf echoReq(ofputil_encode_echo_request(OFP13_VERSION));
+        BOOST_CHECK(conn.SendMessage(echoReq) == 0);
+    }
+    WAIT_FOR(offloadHandler.counter == numEchos, 5);
+    WAIT_FOR(inlineHandler.counter == numEchos, 5);
+
+    conn.Disconnect();
+    offloadHandler.executor.stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(sendqueue, ConnectionFixture) {
+    SwitchConnection conn(testSwitchName);
+
+    EchoReplyHandler erh;
+    conn.RegisterMessageHandler(OFPTYPE_ECHO_REPLY, &erh);
+    conn.setSendQueueLimit(4);
+
+    BOOST_CHECK(!conn.Connect(OFP13_VERSION));
+
+    /* More messages than the queue holds, so senders have to wait */
+    const int numEchos = 200;
+    std::atomic<int> completed(0);
+    for (int i = 0; i < numEchos; ++i) {
+        OfpBuf echoReq(ofputil_encode_echo_request(OFP13_VERSION));
+        if (i % 2) {
+            BOOST_CHECK(conn.SendMessage(echoReq) == 0);
+        } else {
+            int err;
+            while ((err = conn.SendMessageAsync(echoReq, [&](int e) {
+                            BOOST_CHECK(e == 0);
+                            ++completed;
+                        })) == EAGAIN) {
+                std::this_thread::yield();
+            }
+            BOOST_CHECK(err == 0);
+        }
+    }
+    WAIT_FOR(erh.counter == numEchos, 5);
+    BOOST_CHECK(completed == numEchos / 2);
+
+    SwitchConnection::SendQueueStats stats = conn.getSendQueueStats();
+    BOOST_CHECK(stats.depth == 0);
+    BOOST_CHECK(stats.maxDepth > 0);
+    BOOST_CHECK(stats.sent >= (uint64_t)numEchos);
+    BOOST_CHECK(stats.dropped == 0);
+
+    conn.Disconnect();
+}
+
 BOOST_FIXTURE_TEST_CASE(reconnect, ConnectionFixture) {
     SwitchConnection conn(testSwitchName);
     SimpleConnectListener cl1;
@@ -319,6 +319,19 @@ void act_multipath(struct ofpbuf* buf,
     initSubField(&act->dst, dst);
 }
 
+void act_sample(struct ofpbuf* buf,
+                uint16_t probability,
+                uint32_t collectorSetId,
+                uint32_t obsDomainId,
+                uint32_t obsPointId) {
+    struct ofpact_sample* act = ofpact_put_SAMPLE(buf);
+    act->probability = probability;
+    act->collector_set_id = collectorSetId;
+    act->obs_domain_id = obsDomainId;
+    act->obs_point_id = obsPointId;
+    act->sampling_port = OFPP_NONE;
+}
+
 void act_macvlan_learn(struct ofpbuf* ofpacts,
                        uint16_t prio,
                        uint64_t cookie,
@@ -210,6 +210,22 @@ public:
     }
 };
 
+class EpAdvertFixturePaced : public AdvertManagerFixture {
+public:
+    EpAdvertFixturePaced()
+        : AdvertManagerFixture() {
+        advertManager.
+            enableEndpointAdv(AdvertManager::EPADV_GRATUITOUS_UNICAST);
+        advertManager.setEndpointAdvPacing(2, 3000);
+        start();
+        advertManager.scheduleInitialEndpointAdv(10);
+    }
+
+    ~EpAdvertFixturePaced() {
+        stop();
+    }
+};
+
 class RouterAdvertFixture : public AdvertManagerFixture {
 public:
     RouterAdvertFixture()
@@ -339,6 +355,21 @@ BOOST_FIXTURE_TEST_CASE(endpointAdvertGB, EpAdvertFixtureGB) {
     testEpAdvert(AdvertManager::EPADV_GRATUITOUS_BROADCAST);
 }
 
+BOOST_FIXTURE_TEST_CASE(endpointAdvertPaced, EpAdvertFixturePaced) {
+    // the initial round is sent at once rather than across the
+    // pacing window
+    testEpAdvert(AdvertManager::EPADV_GRATUITOUS_UNICAST);
+
+    // a periodic round is paced, and sent from the cached
+    // advertisements
+    conn->clear();
+    advertManager.schedulePeriodicEndpointAdv(10);
+    WAIT_FOR(conn->getSentMsgCount() > 0, 1000);
+    BOOST_CHECK(conn->getSentMsgCount() < 11);
+    WAIT_FOR(conn->getSentMsgCount() == 11, 5000);
+    testEpAdvert(AdvertManager::EPADV_GRATUITOUS_UNICAST);
+}
+
 BOOST_FIXTURE_TEST_CASE(routerAdvert, RouterAdvertFixture) {
     WAIT_FOR(conn->getSentMsgCount() == 1, 1000);
     BOOST_CHECK_EQUAL(1, conn->getSentMsgCount());
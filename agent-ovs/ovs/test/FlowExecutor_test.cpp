@@ -8,6 +8,7 @@
  * and is available at http://www.eclipse.org/legal/epl-v10.html
  */
 
+#include <cerrno>
 #include <vector>
 #include <boost/test/unit_test.hpp>
 #include <boost/assign/list_inserter.hpp>
@@ -29,13 +30,26 @@ using namespace opflexagent;
 class MockExecutorConnection : public SwitchConnection {
 public:
     MockExecutorConnection() : SwitchConnection("mockBridge"),
-        lastXid(0), errReply(ofperr(0)), reconnectReply(false), executor(nullptr) {
+        lastXid(0), errReply(ofperr(0)), reconnectReply(false),
+        sendError(0), executor(nullptr) {
     }
     ~MockExecutorConnection() {
     }
 
     int GetProtocolVersion() { return OFP13_VERSION; }
     int SendMessage(OfpBuf& msg);
+    int SendMessage(OfpBuf& msg, const SendCompletion& done) {
+        // the message is queued but cannot be written
+        if (sendError) {
+            msg.reset();
+            done(sendError);
+            return 0;
+        }
+        int err = SendMessage(msg);
+        if (!err && done)
+            done(0);
+        return err;
+    }
 
     void Expect(const FlowEdit& fe) {
         expectedEdits = fe;
@@ -48,6 +62,7 @@ public:
     ovs_be32 lastXid;
     ofperr errReply;
     bool reconnectReply;
+    int sendError;
     FlowExecutor *executor;
 };
 
@@ -105,6 +120,14 @@ BOOST_FIXTURE_TEST_CASE(reconnect, FlowExecutorFixture) {
     BOOST_CHECK(fexec.Execute(fe) == false);
 }
 
+BOOST_FIXTURE_TEST_CASE(senderror, FlowExecutorFixture) {
+    FlowEdit fe;
+    assign::push_back(fe.edits)(FlowEdit::MOD, flows[0]);
+    conn.Expect(fe);
+    conn.sendError = EPIPE;
+    BOOST_CHECK(fexec.Execute(fe) == false);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 int MockExecutorConnection::SendMessage(OfpBuf& msg) {
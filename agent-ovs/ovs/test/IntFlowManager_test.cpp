@@ -8,10 +8,13 @@
  * and is available at http://www.eclipse.org/legal/epl-v10.html
  */
 
+#include <algorithm>
+#include <future>
 #include <sstream>
 #include <boost/test/unit_test.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/algorithm/string/erase.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
@@ -39,6 +42,7 @@
 #include "FlowUtils.h"
 #include "FlowManagerFixture.h"
 #include "FlowBuilder.h"
+#include "MaglevTable.h"
 #include "ovs-shim.h"
 
 using namespace boost::assign;
@@ -220,7 +224,14 @@ public:
     void connectTest();
     void portStatusTest();
     void loadBalancedServiceTest();
+    void initExpMaglevService(const Service::ServiceMapping& sm,
+                              uint32_t tableSize);
+    bool tableMatches(int tableId, FlowEdit& diffs);
     void remoteEndpointTest();
+    void initExpRemoteEpFlows(const string& mac, const string& tunDst,
+                              const string& ip,
+                              shared_ptr<EpGroup>& epg, uint32_t bdId);
+    bool remoteEpFlowsMatch(const string& mac, const string& ip);
 
     IntFlowManager intFlowManager;
     PacketInHandler pktInHandler;
@@ -611,6 +622,76 @@ BOOST_FIXTURE_TEST_CASE(localEp, VxlanIntFlowManagerFixture) {
     WAIT_FOR_TABLES("remove", 500);
 }
 
+BOOST_FIXTURE_TEST_CASE(incrementalEp, VxlanIntFlowManagerFixture) {
+    setConnected();
+
+    /* created */
+    intFlowManager.endpointUpdated(ep0->getUUID());
+
+    initExpStatic();
+    initExpEp(ep0, epg0);
+    WAIT_FOR_TABLES("create", 500);
+
+    /* changes that don't affect any flows */
+    ep0->addAttribute("app", "web");
+    ep0->addSecurityGroup(URI("/PolicyUniverse/PolicySpace/test/"
+                              "GbpSecGroup/sg1/"));
+    epSrc.updateEndpoint(*ep0);
+    intFlowManager.endpointUpdated(ep0->getUUID());
+    WAIT_FOR_TABLES("attributes", 500);
+
+    /* service map flows only */
+    unordered_set<string> anycastIps(ep0->getAnycastReturnIPs());
+    ep0->addAnycastReturnIP("10.20.45.1");
+    epSrc.updateEndpoint(*ep0);
+    intFlowManager.endpointUpdated(ep0->getUUID());
+
+    clearExpFlowTables();
+    initExpStatic();
+    initExpEp(ep0, epg0);
+    WAIT_FOR_TABLES("anycast", 500);
+
+    /* bridge flows only */
+    ep0->setDiscoveryProxyMode(true);
+    epSrc.updateEndpoint(*ep0);
+    intFlowManager.endpointUpdated(ep0->getUUID());
+
+    clearExpFlowTables();
+    initExpStatic();
+    initExpEp(ep0, epg0);
+    WAIT_FOR_TABLES("discovery proxy", 500);
+
+    /* forwarding change regenerates every group */
+    ep0->setEgURI(epg1->getURI());
+    epSrc.updateEndpoint(*ep0);
+    intFlowManager.endpointUpdated(ep0->getUUID());
+
+    clearExpFlowTables();
+    initExpStatic();
+    initExpEp(ep0, epg1, 0, 2);
+    WAIT_FOR_TABLES("change epg", 500);
+
+    /* back to the original endpoint */
+    ep0->setEgURI(epg0->getURI());
+    ep0->setDiscoveryProxyMode(false);
+    ep0->setAnycastReturnIPs(anycastIps);
+    epSrc.updateEndpoint(*ep0);
+    intFlowManager.endpointUpdated(ep0->getUUID());
+
+    clearExpFlowTables();
+    initExpStatic();
+    initExpEp(ep0, epg0);
+    WAIT_FOR_TABLES("restore", 500);
+
+    /* remove endpoint */
+    epSrc.removeEndpoint(ep0->getUUID());
+    intFlowManager.endpointUpdated(ep0->getUUID());
+
+    clearExpFlowTables();
+    initExpStatic();
+    WAIT_FOR_TABLES("remove", 500);
+}
+
 BOOST_FIXTURE_TEST_CASE(noifaceEp, VxlanIntFlowManagerFixture) {
     setConnected();
 
@@ -1350,6 +1431,181 @@ BOOST_FIXTURE_TEST_CASE(remoteEndpoint_vlan, VlanIntFlowManagerFixture) {
     remoteEndpointTest();
 }
 
+BOOST_FIXTURE_TEST_CASE(remoteEndpointBatch, VxlanIntFlowManagerFixture) {
+    setConnected();
+    intFlowManager.egDomainUpdated(epg0->getURI());
+    intFlowManager.egDomainUpdated(epg1->getURI());
+    intFlowManager.domainUpdated(RoutingDomain::CLASS_ID, rd0->getURI());
+    uint32_t bd1Id = intFlowManager.getId(BridgeDomain::CLASS_ID,
+                                          bd1->getURI());
+
+    Mutator m(framework, policyOwner);
+    auto invu = modelgbp::inv::Universe::resolve(framework);
+    auto inv = invu.get()->addInvRemoteEndpointInventory();
+    auto rep1 = inv->addInvRemoteInventoryEp("ep1");
+    rep1->setMac(MAC("ab:cd:ef:ab:cd:01"))
+        .setNextHopTunnel("5.6.7.8")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg0->getURI());
+    rep1->addInvRemoteIp("1.3.5.7");
+    auto rep2 = inv->addInvRemoteInventoryEp("ep2");
+    rep2->setMac(MAC("ab:cd:ef:ab:cd:02"))
+        .setNextHopTunnel("5.6.7.9")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg1->getURI());
+    rep2->addInvRemoteIp("1.3.5.8");
+    auto rep3 = inv->addInvRemoteInventoryEp("ep3");
+    rep3->setMac(MAC("ab:cd:ef:ab:cd:03"))
+        .setNextHopTunnel("5.6.7.8")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg0->getURI());
+    rep3->addInvRemoteIp("1.3.5.9");
+    m.commit();
+
+    // the endpoints of both groups are written in one batch
+    intFlowManager.remoteEndpointUpdated("ep1");
+    intFlowManager.remoteEndpointUpdated("ep2");
+    intFlowManager.remoteEndpointUpdated("ep3");
+
+    clearExpFlowTables();
+    initExpRemoteEpFlows("ab:cd:ef:ab:cd:01", "5.6.7.8", "1.3.5.7", epg0, 1);
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:01", "1.3.5.7"), 500);
+    clearExpFlowTables();
+    initExpRemoteEpFlows("ab:cd:ef:ab:cd:02", "5.6.7.9", "1.3.5.8",
+                         epg1, bd1Id);
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:02", "1.3.5.8"), 500);
+    clearExpFlowTables();
+    initExpRemoteEpFlows("ab:cd:ef:ab:cd:03", "5.6.7.8", "1.3.5.9", epg0, 1);
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:03", "1.3.5.9"), 500);
+}
+
+BOOST_FIXTURE_TEST_CASE(remoteEndpointBatchRemove,
+                        VxlanIntFlowManagerFixture) {
+    setConnected();
+    intFlowManager.egDomainUpdated(epg0->getURI());
+    intFlowManager.domainUpdated(RoutingDomain::CLASS_ID, rd0->getURI());
+
+    Mutator m1(framework, policyOwner);
+    auto invu = modelgbp::inv::Universe::resolve(framework);
+    auto inv = invu.get()->addInvRemoteEndpointInventory();
+    auto rep1 = inv->addInvRemoteInventoryEp("ep1");
+    rep1->setMac(MAC("ab:cd:ef:ab:cd:01"))
+        .setNextHopTunnel("5.6.7.8")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg0->getURI());
+    rep1->addInvRemoteIp("1.3.5.7");
+    m1.commit();
+    intFlowManager.remoteEndpointUpdated("ep1");
+
+    clearExpFlowTables();
+    initExpRemoteEpFlows("ab:cd:ef:ab:cd:01", "5.6.7.8", "1.3.5.7", epg0, 1);
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:01", "1.3.5.7"), 500);
+
+    // remove one endpoint and add another in the same batch
+    Mutator m2(framework, policyOwner);
+    rep1->remove();
+    auto rep2 = inv->addInvRemoteInventoryEp("ep2");
+    rep2->setMac(MAC("ab:cd:ef:ab:cd:02"))
+        .setNextHopTunnel("5.6.7.8")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg0->getURI());
+    rep2->addInvRemoteIp("1.3.5.8");
+    m2.commit();
+
+    std::promise<void> queued;
+    agent.getAgentIOService().dispatch([&]() {
+            // the batch task runs after this one
+            intFlowManager.remoteEndpointUpdated("ep1");
+            intFlowManager.remoteEndpointUpdated("ep2");
+            queued.set_value();
+        });
+    queued.get_future().wait();
+
+    clearExpFlowTables();
+    initExpRemoteEpFlows("ab:cd:ef:ab:cd:02", "5.6.7.8", "1.3.5.8", epg0, 1);
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:02", "1.3.5.8"), 500);
+    clearExpFlowTables();
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:01", "1.3.5.7"), 500);
+}
+
+BOOST_FIXTURE_TEST_CASE(remoteEndpointNoForwarding,
+                        VxlanIntFlowManagerFixture) {
+    setConnected();
+    intFlowManager.egDomainUpdated(epg0->getURI());
+    intFlowManager.domainUpdated(RoutingDomain::CLASS_ID, rd0->getURI());
+
+    Mutator m1(framework, policyOwner);
+    auto invu = modelgbp::inv::Universe::resolve(framework);
+    auto inv = invu.get()->addInvRemoteEndpointInventory();
+    auto rep1 = inv->addInvRemoteInventoryEp("ep1");
+    rep1->setMac(MAC("ab:cd:ef:ab:cd:01"))
+        .setNextHopTunnel("5.6.7.8")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg0->getURI());
+    rep1->addInvRemoteIp("1.3.5.7");
+    m1.commit();
+    intFlowManager.remoteEndpointUpdated("ep1");
+
+    clearExpFlowTables();
+    initExpRemoteEpFlows("ab:cd:ef:ab:cd:01", "5.6.7.8", "1.3.5.7", epg0, 1);
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:01", "1.3.5.7"), 500);
+
+    // a group without forwarding state clears the flows
+    Mutator m2(framework, policyOwner);
+    rep1->addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(URI("/PolicyUniverse/PolicySpace/tenant0/"
+                               "GbpEpGroup/nonexistent/"));
+    m2.commit();
+    intFlowManager.remoteEndpointUpdated("ep1");
+
+    clearExpFlowTables();
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:01", "1.3.5.7"), 500);
+}
+
+BOOST_FIXTURE_TEST_CASE(remoteEndpointClearOnly, VlanIntFlowManagerFixture) {
+    setConnected();
+    intFlowManager.egDomainUpdated(epg0->getURI());
+    intFlowManager.domainUpdated(RoutingDomain::CLASS_ID, rd0->getURI());
+
+    // stale flows, such as from before a change of encapsulation
+    std::promise<void> written;
+    agent.getAgentIOService().dispatch([&]() {
+            switchManager.writeFlow("ep1", IntFlowManager::BRIDGE_TABLE_ID,
+                                    FlowBuilder().priority(10)
+                                    .ethDst(MAC("ab:cd:ef:ab:cd:01"))
+                                    .action().go(IntFlowManager::POL_TABLE_ID)
+                                    .parent().build());
+            written.set_value();
+        });
+    written.get_future().wait();
+    clearExpFlowTables();
+    BOOST_CHECK(!remoteEpFlowsMatch("ab:cd:ef:ab:cd:01", "1.3.5.7"));
+
+    Mutator m(framework, policyOwner);
+    auto invu = modelgbp::inv::Universe::resolve(framework);
+    auto inv = invu.get()->addInvRemoteEndpointInventory();
+    auto rep1 = inv->addInvRemoteInventoryEp("ep1");
+    rep1->setMac(MAC("ab:cd:ef:ab:cd:01"))
+        .setNextHopTunnel("5.6.7.8")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg0->getURI());
+    rep1->addInvRemoteIp("1.3.5.7");
+    auto rep2 = inv->addInvRemoteInventoryEp("ep2");
+    rep2->setMac(MAC("ab:cd:ef:ab:cd:02"))
+        .setNextHopTunnel("5.6.7.8")
+        .addInvRemoteInventoryEpToGroupRSrc()
+        ->setTargetEpGroup(epg1->getURI());
+    rep2->addInvRemoteIp("1.3.5.8");
+    m.commit();
+
+    // with VLAN encapsulation the endpoints only have their flows
+    // cleared
+    intFlowManager.remoteEndpointUpdated("ep1");
+    intFlowManager.remoteEndpointUpdated("ep2");
+    WAIT_FOR(remoteEpFlowsMatch("ab:cd:ef:ab:cd:01", "1.3.5.7"), 500);
+    BOOST_CHECK(remoteEpFlowsMatch("ab:cd:ef:ab:cd:02", "1.3.5.8"));
+}
+
 BOOST_FIXTURE_TEST_CASE(anycastService, VxlanIntFlowManagerFixture) {
     setConnected();
     intFlowManager.egDomainUpdated(epg0->getURI());
@@ -1445,6 +1701,89 @@ BOOST_FIXTURE_TEST_CASE(loadBalancedService_vlan, VlanIntFlowManagerFixture) {
     loadBalancedServiceTest();
 }
 
+BOOST_FIXTURE_TEST_CASE(maglevService, VxlanIntFlowManagerFixture) {
+    intFlowManager.setMaglevTableSize(7);
+    setConnected();
+    intFlowManager.egDomainUpdated(epg0->getURI());
+    intFlowManager.domainUpdated(RoutingDomain::CLASS_ID, rd0->getURI());
+
+    Service as;
+    as.setUUID("ed84daef-1696-4b98-8c80-6b22d85f4dc2");
+    as.setDomainURI(URI(rd0->getURI()));
+    as.setServiceMode(Service::LOADBALANCER);
+
+    Service::ServiceMapping sm;
+    sm.setServiceIP("169.254.169.254");
+    sm.setServiceProto("udp");
+    sm.addNextHopIP("169.254.169.2");
+    sm.addNextHopIP("169.254.169.3");
+    sm.addNextHopIP("169.254.169.4");
+    sm.setServicePort(53);
+    sm.setNextHopPort(5353);
+    as.addServiceMapping(sm);
+
+    servSrc.updateService(as);
+    intFlowManager.serviceUpdated(as.getUUID());
+
+    // the slot flows and the next hop flows they select are all in
+    // the next hop table, so only that table is checked
+    FlowEdit diffs;
+    clearExpFlowTables();
+    initExpMaglevService(sm, 7);
+    WAIT_FOR_DO_ONFAIL(tableMatches(IntFlowManager::SERVICE_NEXTHOP_TABLE_ID,
+                                    diffs), 500,
+                       ,
+                       LOG(ERROR) << "create: Incorrect next hop table";
+                       for (const FlowEdit::Entry& e : diffs.edits)
+                           LOG(ERROR) << e;);
+
+    std::vector<string> before(sm.getNextHopIPs().begin(),
+                               sm.getNextHopIPs().end());
+    std::vector<uint32_t> beforeLinks;
+    MaglevTable::getLinkIds(before, 7, beforeLinks);
+
+    // remove a next hop; its slots move to the remaining next hops,
+    // which keep their links
+    as.clearServiceMappings();
+    Service::ServiceMapping sm2(sm);
+    std::set<string> nextHops = {"169.254.169.2", "169.254.169.4"};
+    sm2.setNextHopIPs(nextHops);
+    as.addServiceMapping(sm2);
+
+    servSrc.updateService(as);
+    intFlowManager.serviceUpdated(as.getUUID());
+
+    clearExpFlowTables();
+    initExpMaglevService(sm2, 7);
+    WAIT_FOR_DO_ONFAIL(tableMatches(IntFlowManager::SERVICE_NEXTHOP_TABLE_ID,
+                                    diffs), 500,
+                       ,
+                       LOG(ERROR) << "remove: Incorrect next hop table";
+                       for (const FlowEdit::Entry& e : diffs.edits)
+                           LOG(ERROR) << e;);
+
+    std::vector<string> after(nextHops.begin(), nextHops.end());
+    std::vector<uint32_t> afterLinks;
+    std::vector<uint32_t> afterSlots;
+    MaglevTable::getLinkIds(after, 7, afterLinks);
+    MaglevTable::populate(after, 7, afterSlots);
+    BOOST_CHECK_EQUAL(beforeLinks[0], afterLinks[0]);
+    BOOST_CHECK_EQUAL(beforeLinks[2], afterLinks[1]);
+    for (uint32_t link : afterSlots)
+        BOOST_CHECK_NE("169.254.169.3", after[link]);
+
+    servSrc.removeService(as.getUUID());
+    intFlowManager.serviceUpdated(as.getUUID());
+
+    clearExpFlowTables();
+    WAIT_FOR_DO_ONFAIL(tableMatches(IntFlowManager::SERVICE_NEXTHOP_TABLE_ID,
+                                    diffs), 500,
+                       ,
+                       LOG(ERROR) << "delete: Incorrect next hop table";
+                       for (const FlowEdit::Entry& e : diffs.edits)
+                           LOG(ERROR) << e;);
+}
+
 void BaseIntFlowManagerFixture::loadBalancedServiceTest() {
     setConnected();
     LOG(DEBUG) << "#### Starting LB Service Test ####";
@@ -2646,6 +2985,92 @@ void BaseIntFlowManagerFixture::initExpRemoteEp() {
     }
 }
 
+// Expected flows for a remote endpoint with one IPv4 address behind a
+// tunnel
+void BaseIntFlowManagerFixture::initExpRemoteEpFlows(const string& mac,
+                                                     const string& tunDst,
+                                                     const string& ip,
+                                                     shared_ptr<EpGroup>& epg,
+                                                     uint32_t bdId) {
+    uint32_t vnid = policyMgr.getVnidForGroup(epg->getURI()).get();
+    uint32_t tun = address::from_string(tunDst).to_v4().to_ulong();
+    uint8_t rmacArr[6];
+    memcpy(rmacArr, intFlowManager.getRouterMacAddr(), sizeof(rmacArr));
+    string rmac = MAC(rmacArr).toString();
+    string bmac("ff:ff:ff:ff:ff:ff");
+    string macHex = "0x" + boost::algorithm::erase_all_copy(mac, ":");
+    std::stringstream ipHex;
+    ipHex << "0x" << std::hex
+          << address::from_string(ip).to_v4().to_ulong();
+
+    ADDF(Bldr().table(BR).priority(10).reg(BD, bdId)
+         .isEthDst(mac).actions().load(DEPG, vnid)
+         .load(OUTPORT, tun)
+         .mdAct(opflexagent::flow::meta::out::REMOTE_TUNNEL)
+         .go(POL).done());
+    ADDF(Bldr().table(RT).priority(500).ip().reg(RD, 1)
+         .isEthDst(rmac).isIpDst(ip)
+         .actions().load(DEPG, vnid)
+         .load(OUTPORT, tun)
+         .mdAct(opflexagent::flow::meta::out::REMOTE_TUNNEL)
+         .go(POL).done());
+    ADDF(Bldr().table(BR).priority(40).arp()
+         .reg(BD, bdId).reg(RD, 1)
+         .isEthDst(bmac).isTpa(ip)
+         .isArpOp(1)
+         .actions().move(ETHSRC, ETHDST)
+         .load(ETHSRC, macHex).load(ARPOP, 2)
+         .move(ARPSHA, ARPTHA).load(ARPSHA, macHex)
+         .move(ARPSPA, ARPTPA).load(ARPSPA, ipHex.str())
+         .inport().done());
+}
+
+// Check the flows of a remote endpoint in each table it writes
+// against the expected tables, from the IO thread.  Every expected
+// flow must be in the table, and no other flow in it may match on the
+// endpoint's MAC or IP address.
+bool BaseIntFlowManagerFixture::remoteEpFlowsMatch(const string& mac,
+                                                   const string& ip) {
+    const vector<string> keys = {"dl_src=" + mac, "dl_dst=" + mac,
+                                 "nw_dst=" + ip, "arp_tpa=" + ip};
+    auto isEpFlow = [&keys](const FlowEntry& fe) {
+        std::stringstream ss;
+        ss << fe;
+        string flow = ss.str();
+        for (const string& key : keys) {
+            size_t pos = flow.find(key);
+            if (pos == string::npos)
+                continue;
+            pos += key.size();
+            if (pos == flow.size() || flow[pos] == ',' || flow[pos] == ' ')
+                return true;
+        }
+        return false;
+    };
+
+    bool match = true;
+    std::promise<void> done;
+    agent.getAgentIOService().dispatch([&]() {
+            for (int tableId : {IntFlowManager::SRC_TABLE_ID,
+                                IntFlowManager::BRIDGE_TABLE_ID,
+                                IntFlowManager::ROUTE_TABLE_ID}) {
+                // the flows of other objects are added by the diff,
+                // and the expected flows that differ are modified or
+                // deleted
+                FlowEdit diffs;
+                switchManager.diffTableState(tableId, expTables[tableId],
+                                             diffs);
+                for (const FlowEdit::Entry& e : diffs.edits) {
+                    if (e.first != FlowEdit::ADD || isEpFlow(*e.second))
+                        match = false;
+                }
+            }
+            done.set_value();
+        });
+    done.get_future().wait();
+    return match;
+}
+
 void BaseIntFlowManagerFixture::initExpAnycastService(Service &as, int nextHop) {
     string mac = "ed:84:da:ef:16:96";
     string bmac("ff:ff:ff:ff:ff:ff");
@@ -3450,6 +3875,59 @@ void BaseIntFlowManagerFixture::initExpLBService(Service &as1,
     }
 }
 
+// Expected next hop table flows for a UDP service mapping whose next
+// hops are selected with a Maglev table
+void BaseIntFlowManagerFixture::initExpMaglevService(
+                                    const Service::ServiceMapping& sm,
+                                    uint32_t tableSize) {
+    std::vector<string> nextHops(sm.getNextHopIPs().begin(),
+                                 sm.getNextHopIPs().end());
+    std::vector<uint32_t> linkIds;
+    std::vector<uint32_t> slots;
+    MaglevTable::getLinkIds(nextHops, tableSize, linkIds);
+    MaglevTable::populate(nextHops, tableSize, slots);
+    BOOST_REQUIRE_EQUAL(tableSize, slots.size());
+
+    // each slot sets the link of the next hop that owns it and
+    // looks up the next hop again
+    for (uint32_t slot = 0; slot < slots.size(); ++slot) {
+        ADDF(Bldr().table(SVH).priority(101)
+             .udp().reg(RD, 1).reg(OUTPORT, slot)
+             .isIpDst(sm.getServiceIP().get()).isTpDst(53)
+             .actions()
+             .load(OUTPORT, linkIds[slots[slot]])
+             .resubmit(SVH).done());
+    }
+    for (size_t i = 0; i < nextHops.size(); ++i) {
+        Bldr b;
+        b.table(SVH).udp().reg(RD, 1);
+        if (i == 0)
+            b.priority(99);
+        else
+            b.priority(100).reg(OUTPORT, linkIds[i]);
+        ADDF(b.isIpDst(sm.getServiceIP().get()).isTpDst(53)
+             .actions()
+             .tpDst(5353).ipDst(nextHops[i])
+             .decTtl()
+             .load(SVCADDR1, 0xa9fea9fe)
+             .meta(opflexagent::flow::meta::ROUTED,
+                   opflexagent::flow::meta::ROUTED)
+             .go(RT).done());
+    }
+}
+
+// Diff a single table against its expected flows from the IO thread
+bool BaseIntFlowManagerFixture::tableMatches(int tableId, FlowEdit& diffs) {
+    std::promise<void> done;
+    agent.getAgentIOService().dispatch([&]() {
+            diffs.edits.clear();
+            switchManager.diffTableState(tableId, expTables[tableId], diffs);
+            done.set_value();
+        });
+    done.get_future().wait();
+    return diffs.edits.empty();
+}
+
 void BaseIntFlowManagerFixture::initExpVirtualIp() {
     uint32_t port = portmapper.FindPort(ep0->getInterfaceName().get());
     ADDF(Bldr().cookie(ovs_ntohll(opflexagent::flow::cookie::VIRTUAL_IP_V4))
@@ -0,0 +1,175 @@
+/*
+ * Test suite for class IpfixCollector.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/asio/io_service.hpp>
+
+#include "IpfixCollector.h"
+
+using namespace opflexagent;
+using std::vector;
+using boost::asio::ip::address;
+
+class IpfixFixture {
+public:
+    IpfixFixture()
+        : collector(io, [this](const IpfixCollector::Record& r) {
+                records.push_back(r);
+            }) {}
+
+    static void put16(vector<uint8_t>& b, uint16_t v) {
+        b.push_back(v >> 8);
+        b.push_back(v & 0xff);
+    }
+
+    static void put32(vector<uint8_t>& b, uint32_t v) {
+        put16(b, v >> 16);
+        put16(b, v & 0xffff);
+    }
+
+    static void put64(vector<uint8_t>& b, uint64_t v) {
+        put32(b, v >> 32);
+        put32(b, v & 0xffffffff);
+    }
+
+    // wrap sets in a message header and fix up the lengths
+    static vector<uint8_t> message(uint32_t domain,
+                                   const vector<vector<uint8_t> >& sets) {
+        vector<uint8_t> m;
+        put16(m, 10);
+        put16(m, 0);
+        put32(m, 0);
+        put32(m, 1);
+        put32(m, domain);
+        for (const vector<uint8_t>& s : sets)
+            m.insert(m.end(), s.begin(), s.end());
+        m[2] = m.size() >> 8;
+        m[3] = m.size() & 0xff;
+        return m;
+    }
+
+    static vector<uint8_t> set(uint16_t id, const vector<uint8_t>& body) {
+        vector<uint8_t> s;
+        put16(s, id);
+        put16(s, body.size() + 4);
+        s.insert(s.end(), body.begin(), body.end());
+        return s;
+    }
+
+    // the layout OVS uses for the keys and counters we care about,
+    // with an enterprise element in between
+    static vector<uint8_t> v4Template(uint16_t id) {
+        vector<uint8_t> t;
+        put16(t, id);
+        put16(t, 6);
+        put16(t, 138); put16(t, 4);          // observationPointId
+        put16(t, 8); put16(t, 4);            // sourceIPv4Address
+        put16(t, 12); put16(t, 4);           // destinationIPv4Address
+        put16(t, 0x8000 | 891); put16(t, 4); // enterprise element
+        put32(t, 6876);
+        put16(t, 2); put16(t, 8);            // packetDeltaCount
+        put16(t, 352); put16(t, 8);          // layer2OctetDeltaCount
+        return t;
+    }
+
+    static void v4Record(vector<uint8_t>& b, uint32_t point,
+                         uint32_t src, uint32_t dst,
+                         uint64_t packets, uint64_t bytes) {
+        put32(b, point);
+        put32(b, src);
+        put32(b, dst);
+        put32(b, 0xdeadbeef);
+        put64(b, packets);
+        put64(b, bytes);
+    }
+
+    boost::asio::io_service io;
+    IpfixCollector collector;
+    vector<IpfixCollector::Record> records;
+};
+
+BOOST_AUTO_TEST_SUITE(IpfixCollector_test)
+
+BOOST_FIXTURE_TEST_CASE(v4, IpfixFixture) {
+    vector<uint8_t> data;
+    v4Record(data, 42, 0x0a000001, 0x0a600002, 3, 4500);
+    v4Record(data, 43, 0x0a000003, 0x0a600002, 1, 60);
+    // padding after the last record
+    data.push_back(0);
+    data.push_back(0);
+
+    // data before its template is skipped
+    vector<uint8_t> m = message(1, {set(256, data)});
+    BOOST_CHECK(collector.handleMessage(m.data(), m.size()));
+    BOOST_CHECK_EQUAL(0, records.size());
+
+    m = message(1, {set(2, v4Template(256)), set(256, data)});
+    BOOST_CHECK(collector.handleMessage(m.data(), m.size()));
+    BOOST_REQUIRE_EQUAL(2, records.size());
+    BOOST_CHECK_EQUAL(1, records[0].observationDomain);
+    BOOST_CHECK_EQUAL(42, records[0].observationPoint);
+    BOOST_CHECK_EQUAL(address::from_string("10.0.0.1"), records[0].srcAddr);
+    BOOST_CHECK_EQUAL(address::from_string("10.96.0.2"), records[0].dstAddr);
+    BOOST_CHECK_EQUAL(3, records[0].packets);
+    BOOST_CHECK_EQUAL(4500, records[0].bytes);
+    BOOST_CHECK_EQUAL(43, records[1].observationPoint);
+
+    // templates are per observation domain
+    m = message(2, {set(256, data)});
+    BOOST_CHECK(collector.handleMessage(m.data(), m.size()));
+    BOOST_CHECK_EQUAL(2, records.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(v6_varlen, IpfixFixture) {
+    vector<uint8_t> t;
+    put16(t, 300);
+    put16(t, 5);
+    put16(t, 27); put16(t, 16);     // sourceIPv6Address
+    put16(t, 28); put16(t, 16);     // destinationIPv6Address
+    put16(t, 96); put16(t, 65535);  // applicationName, variable length
+    put16(t, 2); put16(t, 4);       // packetDeltaCount, reduced size
+    put16(t, 1); put16(t, 8);       // octetDeltaCount
+
+    vector<uint8_t> d;
+    auto src = address::from_string("fd00::1").to_v6().to_bytes();
+    auto dst = address::from_string("fd00::2").to_v6().to_bytes();
+    d.insert(d.end(), src.begin(), src.end());
+    d.insert(d.end(), dst.begin(), dst.end());
+    d.push_back(3);
+    d.push_back('f'); d.push_back('o'); d.push_back('o');
+    put32(d, 7);
+    put64(d, 700);
+
+    vector<uint8_t> m = message(2, {set(2, t), set(300, d)});
+    BOOST_CHECK(collector.handleMessage(m.data(), m.size()));
+    BOOST_REQUIRE_EQUAL(1, records.size());
+    BOOST_CHECK_EQUAL(address::from_string("fd00::1"), records[0].srcAddr);
+    BOOST_CHECK_EQUAL(address::from_string("fd00::2"), records[0].dstAddr);
+    BOOST_CHECK_EQUAL(7, records[0].packets);
+    BOOST_CHECK_EQUAL(700, records[0].bytes);
+    BOOST_CHECK_EQUAL(0, records[0].observationPoint);
+}
+
+BOOST_FIXTURE_TEST_CASE(malformed, IpfixFixture) {
+    vector<uint8_t> m = message(1, {set(2, v4Template(256))});
+    // truncated
+    BOOST_CHECK(!collector.handleMessage(m.data(), 10));
+    // wrong version
+    m[1] = 9;
+    BOOST_CHECK(!collector.handleMessage(m.data(), m.size()));
+    m[1] = 10;
+    // set longer than the message
+    m[19] += 4;
+    BOOST_CHECK(!collector.handleMessage(m.data(), m.size()));
+    BOOST_CHECK_EQUAL(3, collector.getMalformed());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/*
+ * Test suite for class MaglevTable.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#include "MaglevTable.h"
+
+using namespace opflexagent;
+using std::string;
+using std::vector;
+
+static vector<string> backends(size_t n) {
+    vector<string> b;
+    for (size_t i = 0; i < n; ++i)
+        b.push_back("10.1.0." + std::to_string(i + 1));
+    return b;
+}
+
+// map each slot to the name of its backend
+static vector<string> names(const vector<string>& b, uint32_t size) {
+    vector<uint32_t> table;
+    MaglevTable::populate(b, size, table);
+    vector<string> n;
+    for (uint32_t i : table)
+        n.push_back(b[i]);
+    return n;
+}
+
+BOOST_AUTO_TEST_SUITE(MaglevTable_test)
+
+BOOST_AUTO_TEST_CASE(prime) {
+    BOOST_CHECK(!MaglevTable::isPrime(1));
+    BOOST_CHECK(MaglevTable::isPrime(2));
+    BOOST_CHECK(MaglevTable::isPrime(251));
+    BOOST_CHECK(!MaglevTable::isPrime(255));
+    BOOST_CHECK_EQUAL(257, MaglevTable::nextPrime(252));
+    BOOST_CHECK_EQUAL(251, MaglevTable::nextPrime(251));
+}
+
+BOOST_AUTO_TEST_CASE(balanced) {
+    vector<uint32_t> table;
+    MaglevTable::populate(vector<string>(), 251, table);
+    BOOST_CHECK(table.empty());
+
+    vector<string> b = backends(5);
+    MaglevTable::populate(b, 251, table);
+    BOOST_REQUIRE_EQUAL(251, table.size());
+    vector<size_t> count(b.size());
+    for (uint32_t i : table) {
+        BOOST_REQUIRE(i < b.size());
+        count[i] += 1;
+    }
+    // round-robin filling keeps shares within one slot of each other
+    for (size_t c : count) {
+        BOOST_CHECK(c >= 50);
+        BOOST_CHECK(c <= 51);
+    }
+
+    MaglevTable::populate(backends(1), 7, table);
+    BOOST_CHECK(table == vector<uint32_t>(7, 0));
+}
+
+BOOST_AUTO_TEST_CASE(order_independent) {
+    vector<string> b = backends(8);
+    vector<string> r(b.rbegin(), b.rend());
+    BOOST_CHECK(names(b, 251) == names(r, 251));
+
+    vector<uint32_t> ids, rids;
+    MaglevTable::getLinkIds(b, 251, ids);
+    MaglevTable::getLinkIds(r, 251, rids);
+    for (size_t i = 0; i < b.size(); ++i)
+        BOOST_CHECK_EQUAL(ids[i], rids[b.size() - 1 - i]);
+}
+
+BOOST_AUTO_TEST_CASE(minimal_disruption) {
+    const uint32_t size = 1021;
+    vector<string> b = backends(10);
+    vector<string> before = names(b, size);
+
+    // removing a backend only moves its own slots, plus a few others
+    vector<string> removed(b.begin() + 1, b.end());
+    vector<string> after = names(removed, size);
+    size_t moved = 0;
+    for (uint32_t s = 0; s < size; ++s) {
+        if (before[s] != b[0]) {
+            if (before[s] != after[s])
+                moved += 1;
+        } else {
+            BOOST_CHECK(after[s] != b[0]);
+        }
+    }
+    BOOST_CHECK(moved < size / 20);
+
+    // adding one takes about 1/N of the slots
+    vector<string> added(b);
+    added.push_back("10.1.0.100");
+    after = names(added, size);
+    moved = 0;
+    for (uint32_t s = 0; s < size; ++s) {
+        if (before[s] != after[s])
+            moved += 1;
+    }
+    BOOST_CHECK(moved > size / 11 - size / 50);
+    BOOST_CHECK(moved < size / 11 + size / 20);
+}
+
+BOOST_AUTO_TEST_CASE(link_ids) {
+    vector<string> b = backends(20);
+    vector<uint32_t> ids;
+    MaglevTable::getLinkIds(b, 251, ids);
+    BOOST_REQUIRE_EQUAL(b.size(), ids.size());
+    std::set<uint32_t> unique(ids.begin(), ids.end());
+    BOOST_CHECK_EQUAL(b.size(), unique.size());
+    for (uint32_t id : ids) {
+        BOOST_CHECK(id >= 251);
+        BOOST_CHECK(id <= 0x7fffffff);
+    }
+
+    // identifiers don't depend on the other backends
+    vector<string> fewer(b.begin() + 5, b.end());
+    vector<uint32_t> fewerIds;
+    MaglevTable::getLinkIds(fewer, 251, fewerIds);
+    for (size_t i = 0; i < fewer.size(); ++i)
+        BOOST_CHECK_EQUAL(ids[i + 5], fewerIds[i]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+/*
+ * Test suite for class PacketInCache.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <memory>
+#include <string>
+#include <boost/test/unit_test.hpp>
+
+#include "PacketInCache.h"
+
+using namespace opflexagent;
+using std::make_shared;
+using std::string;
+using opflex::modb::MAC;
+using opflex::modb::URI;
+
+static PacketInCache::ep_entry_ptr entry(const string& uuid) {
+    auto e = make_shared<PacketInCache::EndpointEntry>();
+    e->ep = make_shared<const Endpoint>(uuid);
+    return e;
+}
+
+static PacketInCache::frame_ptr frame(uint8_t b) {
+    return make_shared<const std::vector<uint8_t> >(4, b);
+}
+
+BOOST_AUTO_TEST_SUITE(PacketInCache_test)
+
+BOOST_AUTO_TEST_CASE(endpoint) {
+    PacketInCache cache;
+    MAC mac1("00:00:00:00:00:01");
+    MAC mac2("00:00:00:00:00:02");
+
+    BOOST_CHECK(!cache.getEndpoint("veth0", mac1));
+    cache.putEndpoint("veth0", mac1, entry("ep1"), cache.getGeneration());
+    cache.putEndpoint("veth0", mac2, entry("ep2"), cache.getGeneration());
+    cache.putEndpoint("veth1", mac1, entry("ep3"), cache.getGeneration());
+
+    PacketInCache::ep_entry_ptr e = cache.getEndpoint("veth0", mac1);
+    BOOST_REQUIRE(e);
+    BOOST_CHECK_EQUAL("ep1", e->ep->getUUID());
+    BOOST_CHECK(!cache.getEndpoint("veth0", MAC("00:00:00:00:00:03")));
+    BOOST_CHECK_EQUAL(1, cache.getHits());
+    BOOST_CHECK_EQUAL(2, cache.getMisses());
+
+    // an update invalidates every client on the endpoint's interface
+    cache.invalidateEndpoint("ep1", string("veth0"));
+    BOOST_CHECK(!cache.getEndpoint("veth0", mac1));
+    BOOST_CHECK(!cache.getEndpoint("veth0", mac2));
+    BOOST_CHECK(cache.getEndpoint("veth1", mac1));
+
+    // and those on the interface it was cached under, if it moved
+    cache.invalidateEndpoint("ep3", string("veth2"));
+    BOOST_CHECK(!cache.getEndpoint("veth1", mac1));
+
+    // a removed endpoint has no interface
+    cache.putEndpoint("veth0", mac1, entry("ep1"), cache.getGeneration());
+    cache.invalidateEndpoint("ep1", boost::none);
+    BOOST_CHECK(!cache.getEndpoint("veth0", mac1));
+}
+
+BOOST_AUTO_TEST_CASE(stale) {
+    PacketInCache cache;
+    MAC mac1("00:00:00:00:00:01");
+
+    // an entry resolved before an invalidation is not added
+    uint64_t generation = cache.getGeneration();
+    cache.invalidateEndpoint("ep1", string("veth0"));
+    cache.putEndpoint("veth0", mac1, entry("ep1"), generation);
+    BOOST_CHECK(!cache.getEndpoint("veth0", mac1));
+
+    generation = cache.getGeneration();
+    cache.invalidateRouterAdverts();
+    cache.putRouterAdvert(URI("/eg1"), mac1, frame(1), generation);
+    BOOST_CHECK(!cache.getRouterAdvert(URI("/eg1"), mac1));
+}
+
+BOOST_AUTO_TEST_CASE(router_advert) {
+    PacketInCache cache;
+    MAC mac1("00:00:00:00:00:01");
+    MAC mac2("00:00:00:00:00:02");
+    URI eg1("/eg1");
+    URI eg2("/eg2");
+
+    cache.putRouterAdvert(eg1, mac1, frame(1), cache.getGeneration());
+    cache.putRouterAdvert(eg1, mac2, frame(2), cache.getGeneration());
+    cache.putRouterAdvert(eg2, mac1, frame(3), cache.getGeneration());
+    PacketInCache::frame_ptr f = cache.getRouterAdvert(eg1, mac2);
+    BOOST_REQUIRE(f);
+    BOOST_CHECK_EQUAL(2, (*f)[0]);
+
+    cache.invalidateGroup(eg1);
+    BOOST_CHECK(!cache.getRouterAdvert(eg1, mac1));
+    BOOST_CHECK(!cache.getRouterAdvert(eg1, mac2));
+    BOOST_CHECK(cache.getRouterAdvert(eg2, mac1));
+
+    cache.invalidateRouterAdverts();
+    BOOST_CHECK(!cache.getRouterAdvert(eg2, mac1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
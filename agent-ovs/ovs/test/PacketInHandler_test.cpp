@@ -59,9 +59,9 @@ public:
         pktInHandler.setPortMapper(&intPortMapper, &accPortMapper);
     }
 
-    void setDhcpv4Config() {
+    void setDhcpv4Config(const std::string& ip = "10.20.44.2") {
         Endpoint::DHCPv4Config c;
-        c.setIpAddress("10.20.44.2");
+        c.setIpAddress(ip);
         c.setPrefixLen(24);
         c.addRouter("10.20.44.1");
         c.addRouter("1.2.3.4");
@@ -735,6 +735,66 @@ BOOST_FIXTURE_TEST_CASE(dhcpv4_request_inv, PacketInHandlerFixture) {
     verify_dhcpv4(intConn.getSentMsg(0), opflexagent::dhcp::message_type::NAK);
 }
 
+BOOST_FIXTURE_TEST_CASE(dhcpv4_cached, PacketInHandlerFixture) {
+    pktInHandler.setWorkerPool(0, 0);
+    pktInHandler.start();
+    setDhcpv4Config();
+
+    ofputil_packet_in_private pin;
+    init_packet_in(pin, &pkt_dhcpv4_discover, sizeof(pkt_dhcpv4_discover),
+                   opflexagent::flow::cookie::DHCP_V4, IntFlowManager::SEC_TABLE_ID,
+                   80);
+    OfpBuf discover(ofputil_encode_packet_in_private(&pin,
+                                                     OFPUTIL_P_OF13_OXM,
+                                                     OFPUTIL_PACKET_IN_NXT));
+    init_packet_in(pin, &pkt_dhcpv4_request, sizeof(pkt_dhcpv4_request),
+                   opflexagent::flow::cookie::DHCP_V4, IntFlowManager::SEC_TABLE_ID,
+                   80);
+    OfpBuf request(ofputil_encode_packet_in_private(&pin,
+                                                    OFPUTIL_P_OF13_OXM,
+                                                    OFPUTIL_PACKET_IN_NXT));
+
+    // the reply is built once and reused
+    pktInHandler.Handle(&intConn, OFPTYPE_PACKET_IN, discover.get());
+    pktInHandler.Handle(&intConn, OFPTYPE_PACKET_IN, discover.get());
+    pktInHandler.Handle(&intConn, OFPTYPE_PACKET_IN, request.get());
+    BOOST_REQUIRE_EQUAL(3, intConn.getSentMsgCount());
+    verify_dhcpv4(intConn.getSentMsg(0), opflexagent::dhcp::message_type::OFFER);
+    verify_dhcpv4(intConn.getSentMsg(1), opflexagent::dhcp::message_type::OFFER);
+    verify_dhcpv4(intConn.getSentMsg(2), opflexagent::dhcp::message_type::ACK);
+    BOOST_CHECK_EQUAL(2, pktInHandler.getCache().getHits());
+
+    // an endpoint update invalidates it
+    setDhcpv4Config("10.20.44.3");
+    pktInHandler.Handle(&intConn, OFPTYPE_PACKET_IN, request.get());
+    BOOST_REQUIRE_EQUAL(4, intConn.getSentMsgCount());
+    verify_dhcpv4(intConn.getSentMsg(3), opflexagent::dhcp::message_type::NAK);
+
+    pktInHandler.stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(dhcpv4_rate_limited, PacketInHandlerFixture) {
+    pktInHandler.setWorkerPool(0, 0);
+    pktInHandler.setPortRateLimit(1, 2);
+    setDhcpv4Config();
+
+    ofputil_packet_in_private pin;
+    init_packet_in(pin, &pkt_dhcpv4_discover, sizeof(pkt_dhcpv4_discover),
+                   opflexagent::flow::cookie::DHCP_V4, IntFlowManager::SEC_TABLE_ID,
+                   80);
+    OfpBuf discover(ofputil_encode_packet_in_private(&pin,
+                                                     OFPUTIL_P_OF13_OXM,
+                                                     OFPUTIL_PACKET_IN_NXT));
+
+    // the burst is answered and the rest of the storm is dropped
+    for (int i = 0; i < 5; i++)
+        pktInHandler.Handle(&intConn, OFPTYPE_PACKET_IN, discover.get());
+    BOOST_REQUIRE_EQUAL(2, intConn.getSentMsgCount());
+    verify_dhcpv4(intConn.getSentMsg(0), opflexagent::dhcp::message_type::OFFER);
+    verify_dhcpv4(intConn.getSentMsg(1), opflexagent::dhcp::message_type::OFFER);
+    BOOST_CHECK_EQUAL(3, pktInHandler.getRateLimited());
+}
+
 BOOST_FIXTURE_TEST_CASE(dhcpv6_noconfig, PacketInHandlerFixture) {
     ofputil_packet_in_private pin;
     init_packet_in(pin, &pkt_dhcpv6_solicit, sizeof(pkt_dhcpv6_solicit),
@@ -8,6 +8,7 @@
  * and is available at http://www.eclipse.org/legal/epl-v10.html
  */
 
+#include <cmath>
 #include <sstream>
 #include <boost/test/unit_test.hpp>
 #include <boost/lexical_cast.hpp>
@@ -21,6 +22,7 @@
 #include <lib/util.h>
 #include "IntFlowManager.h"
 #include "ServiceStatsManager.h"
+#include "PodSvcSampler.h"
 #include "TableState.h"
 #include "ActionBuilder.h"
 #include "RangeMask.h"
@@ -117,6 +119,7 @@ public:
                                uint32_t initPkts,
                                const string& nhip,
                                bool isNodePort=false);
+    void testPodSvcSampled(void);
     void checkPodSvcObsObj(bool);
     void checkSvcTgtObsObj(bool);
     void removeServiceObjects(void);
@@ -1222,6 +1225,61 @@ ServiceStatsManagerFixture::checkPodSvcObjectStats (const std::string& epToSvcUu
 #endif
 }
 
+/*
+ * Feed sampled records for ep0 <--> svc to a sampler and check that
+ * the exported pod<-->svc counters are the injected counts scaled by
+ * the inverse of the sampling probability
+ */
+void ServiceStatsManagerFixture::testPodSvcSampled (void)
+{
+    PodSvcSampler sampler(agent, intFlowManager);
+    sampler.setConfig(1000, 4739, 10, 10, 0);
+    const double scale = 65535.0 / sampler.getProbability();
+    auto scaled = [scale](uint64_t count) {
+        return static_cast<uint32_t>(std::llround(count * scale));
+    };
+
+    auto epSvcUuid = ep0->getUUID() + ":" + as.getUUID();
+    auto epToSvcUuid = "eptosvc:" + epSvcUuid;
+    auto svcToEpUuid = "svctoep:" + epSvcUuid;
+    const address svcIp = address::from_string("169.254.169.254");
+
+    auto inject = [&](const string& client, uint64_t pkts, uint64_t bytes) {
+        IpfixCollector::Record r;
+        r.observationPoint = idGen.getId("service", as.getUUID());
+        r.packets = pkts;
+        r.bytes = bytes;
+        r.observationDomain = IntFlowManager::SAMPLE_TO_SERVICE;
+        r.srcAddr = address::from_string(client);
+        r.dstAddr = svcIp;
+        sampler.handleRecord(r);
+        r.observationDomain = IntFlowManager::SAMPLE_FROM_SERVICE;
+        r.srcAddr = svcIp;
+        r.dstAddr = address::from_string(client);
+        sampler.handleRecord(r);
+    };
+
+    // both addresses of ep0 count towards its counters
+    inject("10.20.44.2", 1, 100);
+    inject("10.20.44.2", 2, 200);
+    inject("10.20.44.3", 1, 60);
+    sampler.exportCounters();
+    uint32_t pkts = scaled(3) + scaled(1);
+    uint32_t bytes = scaled(300) + scaled(60);
+    checkPodSvcObjectStats(epToSvcUuid, svcToEpUuid, pkts, bytes);
+
+    // nothing new was sampled, so nothing is added
+    sampler.exportCounters();
+    checkPodSvcObjectStats(epToSvcUuid, svcToEpUuid, pkts, bytes);
+
+    // only the new samples are added
+    inject("10.20.44.2", 2, 150);
+    sampler.exportCounters();
+    pkts += scaled(2);
+    bytes += scaled(150);
+    checkPodSvcObjectStats(epToSvcUuid, svcToEpUuid, pkts, bytes);
+}
+
 void ServiceStatsManagerFixture::checkSvcTgtObsObj (bool add)
 {
     auto svcUuid = as.getUUID();
@@ -1605,6 +1663,12 @@ BOOST_FIXTURE_TEST_CASE(testFlowRemovedNodeSvcTgtOld, ServiceStatsManagerFixture
     serviceStatsManager.stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(testPodSvcSampledCounters, ServiceStatsManagerFixture) {
+    LOG(DEBUG) << "############# SAMPLED pod <--> svc START ############";
+    testPodSvcSampled();
+    LOG(DEBUG) << "############# SAMPLED pod <--> svc END ############";
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
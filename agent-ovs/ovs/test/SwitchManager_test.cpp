@@ -0,0 +1,210 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Test suite for flow edit batching in class SwitchManager
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include <opflexagent/test/BaseFixture.h>
+#include <opflexagent/logging.h>
+
+#include "SwitchManager.h"
+#include "FlowBuilder.h"
+#include "MockSwitchManager.h"
+#include "MockFlowReader.h"
+#include "MockPortMapper.h"
+
+using namespace opflexagent;
+
+BOOST_AUTO_TEST_SUITE(SwitchManager_test)
+
+// Records the flow edits it is sent, in order
+class RecordingFlowExecutor : public FlowExecutor {
+public:
+    RecordingFlowExecutor() : executes(0) {}
+
+    struct Edit {
+        FlowEdit::type type;
+        int table;
+        uint16_t priority;
+    };
+
+    virtual bool Execute(const FlowEdit& fe) {
+        if (fe.edits.empty()) return true;
+        std::lock_guard<std::mutex> guard(mutex);
+        executes += 1;
+        for (const FlowEdit::Entry& e : fe.edits)
+            edits.push_back(Edit{e.first, e.second->entry->table_id,
+                                 e.second->entry->priority});
+        return true;
+    }
+    virtual bool Execute(const GroupEdit&) { return true; }
+    virtual bool Execute(const TlvEdit&) { return true; }
+
+    size_t getExecutes() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return executes;
+    }
+
+    std::vector<Edit> getEdits() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return edits;
+    }
+
+private:
+    std::mutex mutex;
+    size_t executes;
+    std::vector<Edit> edits;
+};
+
+class SwitchManagerFixture : public BaseFixture {
+public:
+    SwitchManagerFixture()
+        : switchManager(agent, exec, reader, portmapper) {
+        switchManager.setMaxFlowTables(4);
+        switchManager.start("placeholder");
+    }
+
+    virtual ~SwitchManagerFixture() {
+        switchManager.stop();
+        agent.stop();
+    }
+
+    void write(const std::string& objId, int tableId, uint16_t prio) {
+        switchManager.writeFlow(objId, tableId,
+                                FlowBuilder().priority(prio).build());
+    }
+
+    // Run the function as a task on the agent IO thread, so that the
+    // batch is not sent when the queue drains while it runs
+    void runTask(const std::function<void ()>& task) {
+        std::promise<void> done;
+        agent.getAgentIOService().post([&]() {
+                task();
+                done.set_value();
+            });
+        done.get_future().wait();
+    }
+
+    RecordingFlowExecutor exec;
+    MockFlowReader reader;
+    MockPortMapper portmapper;
+    MockSwitchManager switchManager;
+};
+
+BOOST_FIXTURE_TEST_CASE(unbatched, SwitchManagerFixture) {
+    write("a", 1, 10);
+    write("b", 2, 10);
+    BOOST_CHECK_EQUAL(2, exec.getExecutes());
+
+    bool called = false;
+    switchManager.onFlowsWritten([&called](bool success) {
+            BOOST_CHECK(success);
+            called = true;
+        });
+    BOOST_CHECK(called);
+}
+
+BOOST_FIXTURE_TEST_CASE(maxedits, SwitchManagerFixture) {
+    switchManager.setFlowBatching(4, 100000);
+
+    std::atomic<int> called(0);
+    runTask([&]() {
+            write("a", 1, 10);
+            write("b", 2, 10);
+            write("c", 1, 20);
+            switchManager.onFlowsWritten([&called](bool success) {
+                    BOOST_CHECK(success);
+                    called += 1;
+                });
+            BOOST_CHECK_EQUAL(0, exec.getExecutes());
+            BOOST_CHECK_EQUAL(0, called);
+
+            // the batch is sent once it is full
+            write("d", 3, 10);
+            BOOST_CHECK_EQUAL(1, exec.getExecutes());
+            BOOST_CHECK_EQUAL(4, exec.getEdits().size());
+            BOOST_CHECK_EQUAL(1, called);
+        });
+}
+
+BOOST_FIXTURE_TEST_CASE(order, SwitchManagerFixture) {
+    switchManager.setFlowBatching(1000, 100000);
+
+    runTask([&]() {
+            write("a", 1, 10);
+            write("b", 2, 10);
+            switchManager.clearFlows("a", 1);
+            write("a", 1, 10);
+            BOOST_CHECK_EQUAL(0, exec.getExecutes());
+            switchManager.flushFlows();
+        });
+
+    // the edits of each table keep the order they were written in
+    std::vector<RecordingFlowExecutor::Edit> edits = exec.getEdits();
+    BOOST_REQUIRE_EQUAL(4, edits.size());
+    BOOST_CHECK_EQUAL(1, exec.getExecutes());
+    BOOST_CHECK_EQUAL(1, edits[0].table);
+    BOOST_CHECK_EQUAL(FlowEdit::ADD, edits[0].type);
+    BOOST_CHECK_EQUAL(1, edits[1].table);
+    BOOST_CHECK_EQUAL(FlowEdit::DEL, edits[1].type);
+    BOOST_CHECK_EQUAL(1, edits[2].table);
+    BOOST_CHECK_EQUAL(FlowEdit::ADD, edits[2].type);
+    BOOST_CHECK_EQUAL(2, edits[3].table);
+    BOOST_CHECK_EQUAL(FlowEdit::ADD, edits[3].type);
+}
+
+BOOST_FIXTURE_TEST_CASE(drain, SwitchManagerFixture) {
+    switchManager.setFlowBatching(1000, 100000);
+
+    std::atomic<int> called(0);
+    agent.getAgentIOService().post([&]() {
+            write("a", 1, 10);
+            write("b", 2, 10);
+            switchManager.onFlowsWritten([&called](bool success) {
+                    BOOST_CHECK(success);
+                    called += 1;
+                });
+        });
+    agent.getAgentIOService().post([&]() { write("c", 1, 20); });
+
+    // the batch is sent once the queue has drained
+    WAIT_FOR(called == 1, 500);
+    BOOST_CHECK_EQUAL(1, exec.getExecutes());
+    BOOST_CHECK_EQUAL(3, exec.getEdits().size());
+}
+
+BOOST_FIXTURE_TEST_CASE(stop, SwitchManagerFixture) {
+    switchManager.setFlowBatching(1000, 100000);
+
+    std::atomic<int> called(0);
+    runTask([&]() {
+            write("a", 1, 10);
+            write("b", 2, 10);
+            switchManager.onFlowsWritten([&called](bool success) {
+                    BOOST_CHECK(success);
+                    called += 1;
+                });
+            BOOST_CHECK_EQUAL(0, exec.getExecutes());
+
+            // stopping sends the batch rather than dropping it
+            switchManager.stop();
+            BOOST_CHECK_EQUAL(1, exec.getExecutes());
+            BOOST_CHECK_EQUAL(2, exec.getEdits().size());
+            BOOST_CHECK_EQUAL(1, called);
+        });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
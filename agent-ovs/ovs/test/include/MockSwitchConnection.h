@@ -46,6 +46,20 @@ public:
         return 0;
     }
 
+    virtual int SendMessage(OfpBuf& msg, const SendCompletion& done) {
+        int err = SendMessage(msg);
+        if (!err && done)
+            done(0);
+        return err;
+    }
+
+    virtual int SendMessageAsync(OfpBuf& msg, const SendCompletion& done) {
+        int err = SendMessage(msg);
+        if (!err && done)
+            done(0);
+        return err;
+    }
+
     virtual bool IsConnected() { return connected; }
 
     bool connected;
@@ -1,6 +1,10 @@
 package org.opendaylight.opflex.genie.content.format.agent.meta.cpp;
 
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
 import java.util.Collection;
+import java.util.LinkedHashMap;
+import java.util.List;
 import java.util.Map;
 import java.util.TreeMap;
 
@@ -68,6 +72,7 @@ public class FMetaDef
         out.println(0, "namespace " + Config.getProjName());
         out.println(0, "{");
 
+        generateNameIndexes(0);
         generateMetaAccessor(0);
 
         out.println(0, "} // namespace " + Config.getProjName());
@@ -81,11 +86,219 @@ public class FMetaDef
         out.println(aInIndent + 1, "static const opflex::modb::ModelMetadata metadata(\"" +
                     Config.getProjName() + "\", ");
         generateClassDefs(aInIndent + 2);
+        out.println(aInIndent + 2, ", " + getNameIndex("class_index", getClassNames().size()));
         out.println(aInIndent + 2, ");");
         out.println(aInIndent + 1, "return metadata;");
         out.println(aInIndent, "}");
     }
 
+    /**
+     * Emits minimal perfect hash tables for the class names of the model and for the property names of each
+     * class, for opflex::modb::NameIndex.  A name hashes to a bucket holding a seed, and the name hashed with
+     * that seed gives the slot holding its ID.
+     */
+    private void generateNameIndexes(int aInIndent)
+    {
+        out.println(aInIndent, "namespace");
+        out.println(aInIndent, "{");
+        genNameIndex(aInIndent, "class_index", getClassNames());
+        for (Item lIt : MClass.getConcreteClasses())
+        {
+            MClass lClass = (MClass) lIt;
+            if (lClass.isConcrete())
+            {
+                genNameIndex(aInIndent, "prop_index_" + lClass.getGID().getId(), getPropNames(lClass));
+            }
+        }
+        out.println(aInIndent, "}");
+    }
+
+    private static Map<String,Long> getClassNames()
+    {
+        Map<String,Long> lNames = new LinkedHashMap<>();
+        for (Item lIt : MClass.getConcreteClasses())
+        {
+            MClass lClass = (MClass) lIt;
+            if (lClass.isConcrete())
+            {
+                lNames.put(lClass.getFullConcatenatedName(), (long) lClass.getGID().getId());
+            }
+        }
+        return lNames;
+    }
+
+    /**
+     * @return the property names of the class, as given to the ClassInfo by genProps, and their IDs
+     */
+    private static Map<String,Long> getPropNames(MClass aInClass)
+    {
+        Map<String,Long> lNames = new LinkedHashMap<>();
+        TreeMap<String,MProp> lProps = new TreeMap<>();
+        aInClass.findProp(lProps,true);
+        for (MProp lProp : lProps.values())
+        {
+            String lName = lProp.getLID().getName();
+            if (isRelationshipSource(aInClass))
+            {
+                if (!lName.equalsIgnoreCase("targetName"))
+                {
+                    continue;
+                }
+                lName = "target";
+            }
+            else if (lName.equalsIgnoreCase("source") && isRelationshipTarget(aInClass))
+            {
+                lName = "source";
+            }
+            lNames.put(lName, lProp.getPropId(aInClass) & 0xFFFFFFFFL);
+        }
+
+        TreeMap<Ident,MClass> lConts = new TreeMap<>();
+        aInClass.getContainsClasses(lConts);
+        for (MClass lContained : lConts.values())
+        {
+            lNames.put(lContained.getFullConcatenatedName(), lContained.getClassAsPropId(aInClass) & 0xFFFFFFFFL);
+        }
+        return lNames;
+    }
+
+    /**
+     * Same hash as opflex::modb::NameIndex::hash(): the name eight bytes at a time as little-endian words
+     */
+    private static long hashName(byte[] aInName)
+    {
+        long lHash = 0xcbf29ce484222325L ^ aInName.length;
+        for (int lOff = 0; lOff < aInName.length; lOff += 8)
+        {
+            long lWord = 0;
+            for (int lIdx = 0; lIdx < 8 && lOff + lIdx < aInName.length; lIdx++)
+            {
+                lWord |= (aInName[lOff + lIdx] & 0xffL) << (8 * lIdx);
+            }
+            lHash = (lHash ^ lWord) * 0x9e3779b97f4a7c15L;
+            lHash ^= lHash >>> 32;
+        }
+        return lHash;
+    }
+
+    /**
+     * Same as opflex::modb::NameIndex::mix(): the murmur3 64-bit finalizer over the seeded hash
+     */
+    private static long mixHash(long aInHash, int aInSeed)
+    {
+        long lHash = aInHash ^ Integer.toUnsignedLong(aInSeed);
+        lHash ^= lHash >>> 33;
+        lHash *= 0xff51afd7ed558ccdL;
+        lHash ^= lHash >>> 33;
+        lHash *= 0xc4ceb9fe1a85ec53L;
+        lHash ^= lHash >>> 33;
+        return lHash;
+    }
+
+    /**
+     * Same as opflex::modb::NameIndex::reduce()
+     */
+    private static int toSlot(long aInHash, int aInSize)
+    {
+        return (int) (((aInHash >>> 32) * aInSize) >>> 32);
+    }
+
+    private void genNameIndex(int aInIndent, String aInName, Map<String,Long> aInNames)
+    {
+        int lSize = aInNames.size();
+        if (0 == lSize)
+        {
+            return;
+        }
+        List<Long> lKeys = new ArrayList<>();
+        List<Long> lIds = new ArrayList<>();
+        List<List<Integer>> lBuckets = new ArrayList<>();
+        for (int lIdx = 0; lIdx < lSize; lIdx++)
+        {
+            lBuckets.add(new ArrayList<Integer>());
+        }
+        for (Map.Entry<String,Long> lEntry : aInNames.entrySet())
+        {
+            long lKey = hashName(lEntry.getKey().getBytes(StandardCharsets.UTF_8));
+            lBuckets.get(toSlot(mixHash(lKey, 0), lSize)).add(lKeys.size());
+            lKeys.add(lKey);
+            lIds.add(lEntry.getValue());
+        }
+
+        // place the largest buckets first, while most slots are free
+        List<Integer> lOrder = new ArrayList<>();
+        for (int lIdx = 0; lIdx < lSize; lIdx++)
+        {
+            lOrder.add(lIdx);
+        }
+        lOrder.sort((a, b) -> lBuckets.get(b).size() - lBuckets.get(a).size());
+
+        long[] lSeeds = new long[lSize];
+        long[] lSlotIds = new long[lSize];
+        boolean[] lUsed = new boolean[lSize];
+        for (int lBucket : lOrder)
+        {
+            List<Integer> lMembers = lBuckets.get(lBucket);
+            if (lMembers.isEmpty())
+            {
+                break;
+            }
+            for (int lSeed = 1; ; lSeed++)
+            {
+                List<Integer> lSlots = new ArrayList<>();
+                for (int lMember : lMembers)
+                {
+                    int lSlot = toSlot(mixHash(lKeys.get(lMember), lSeed), lSize);
+                    if (lUsed[lSlot] || lSlots.contains(lSlot))
+                    {
+                        break;
+                    }
+                    lSlots.add(lSlot);
+                }
+                if (lSlots.size() == lMembers.size())
+                {
+                    lSeeds[lBucket] = Integer.toUnsignedLong(lSeed);
+                    for (int lIdx = 0; lIdx < lSlots.size(); lIdx++)
+                    {
+                        lUsed[lSlots.get(lIdx)] = true;
+                        lSlotIds[lSlots.get(lIdx)] = lIds.get(lMembers.get(lIdx));
+                    }
+                    break;
+                }
+            }
+        }
+
+        genArray(aInIndent + 1, "uint32_t", aInName + "_seeds", lSeeds, "u");
+        genArray(aInIndent + 1, "uint64_t", aInName + "_ids", lSlotIds, "ul");
+    }
+
+    private void genArray(int aInIndent, String aInType, String aInName, long[] aInValues, String aInSuffix)
+    {
+        out.println(aInIndent, "constexpr " + aInType + " " + aInName + "[] = {");
+        StringBuilder lLine = new StringBuilder();
+        for (int lIdx = 0; lIdx < aInValues.length; lIdx++)
+        {
+            lLine.append(aInValues[lIdx]).append(aInSuffix);
+            if (lIdx + 1 < aInValues.length)
+            {
+                lLine.append(", ");
+            }
+            if (lIdx % 8 == 7 || lIdx + 1 == aInValues.length)
+            {
+                out.println(aInIndent + 1, lLine.toString().trim());
+                lLine.setLength(0);
+            }
+        }
+        out.println(aInIndent, "};");
+    }
+
+    private static String getNameIndex(String aInName, int aInSize)
+    {
+        return 0 == aInSize ?
+                "NameIndex()" :
+                "NameIndex(" + aInName + "_seeds, " + aInName + "_ids, " + aInSize + ")";
+    }
+
     private void generateClassDefs(int aInIndent)
     {
         out.println(aInIndent, "{");
@@ -213,6 +426,8 @@ public class FMetaDef
         out.print(aInIndent , lPrefix + "ClassInfo(" + aInClass.getGID().getId() + ", ");
         out.println(getClassType(aInClass) + ", \"" + aInClass.getFullConcatenatedName() + "\", \"" + getOwner(aInClass) + "\",");
         genProps(aInIndent + 1, aInClass);
+        out.println(aInIndent + 1, ", " + getNameIndex("prop_index_" + aInClass.getGID().getId(),
+                                                      getPropNames(aInClass).size()));
         out.println(aInIndent + 1, ')');
     }
 
@@ -230,7 +445,7 @@ public class FMetaDef
 
         if (lProps.size() + lConts.size() == 0)
         {
-            out.println(aInIndent, "std::vector<prop_id_t>(),");
+            out.println(aInIndent, "std::vector<PropertyInfo>()");
         }
         else
         {
@@ -146,6 +146,7 @@ public class FClassDef extends ItemFormatterTask
         out.println(aInIndent,getInclude("boost/optional.hpp", true));
         out.println(aInIndent,getInclude("opflex/modb/URIBuilder.h", false));
         out.println(aInIndent,getInclude("opflex/modb/mo-internal/MO.h", false));
+        out.println(aInIndent,getInclude("opflex/modb/mo-internal/MOView.h", false));
         TreeMap<Ident, MClass> lConts = new TreeMap<>();
         aInClass.getContainsClasses(lConts);
         for (MClass lThis : lConts.values())
@@ -187,6 +188,7 @@ public class FClassDef extends ItemFormatterTask
         genResolvers(aInIndent, aInClass);
         genRemove(aInIndent, aInClass);
         genListenerReg(aInIndent, aInClass);
+        genView(aInIndent, aInClass);
         genConstructor(aInIndent, aInClass);
     }
 
@@ -260,28 +262,63 @@ public class FClassDef extends ItemFormatterTask
         }
         else
         {
-            genPropCheck(aInIndent, aInProp,aInPropIdx, lBaseType,lComments);
-            genPropAccessor(aInIndent, aInProp, aInPropIdx, lBaseType, lComments);
-            genPropDefaultedAccessor(aInIndent, aInProp, lBaseType, lComments);
+            genPropReaders(aInIndent, aInProp, aInPropIdx, lBaseType, lComments, "");
             genPropMutator(aInIndent, aInClass, aInProp, aInPropIdx, lBaseType, lComments);
             genPropUnset(aInIndent, aInClass, aInProp, aInPropIdx, lBaseType, lComments);
         }
     }
 
+    private void genPropReaders(
+        int aInIndent, MClass aInClass, MProp aInProp, int aInPropIdx, String aInQual)
+    {
+        MType lBaseType = aInProp.getBase().getType(false).getBuiltInType();
+
+        LinkedList<String> lComments = new LinkedList<>();
+        aInProp.getComments(lComments);
+
+        if (aInClass.isConcreteSuperclassOf("relator/Source") &&
+            aInProp.getLID().getName().toLowerCase().startsWith("target"))
+        {
+            if (aInProp.getLID().getName().equalsIgnoreCase("targetName"))
+            {
+                genRefReaders(aInIndent, aInPropIdx, lComments, aInQual);
+            }
+        }
+        else
+        {
+            genPropReaders(aInIndent, aInProp, aInPropIdx, lBaseType, lComments, aInQual);
+        }
+    }
+
+    private void genPropReaders(
+        int aInIndent, MProp aInProp, int aInPropIdx, MType aInBaseType,
+        Collection<String> aInComments, String aInQual)
+    {
+        genPropCheck(aInIndent, aInProp, aInPropIdx, aInBaseType, aInComments, aInQual);
+        genPropAccessor(aInIndent, aInProp, aInPropIdx, aInBaseType, aInComments, aInQual);
+        genPropDefaultedAccessor(aInIndent, aInProp, aInBaseType, aInComments, aInQual);
+    }
+
     private void genRef(
         int aInIndent, MClass aInClass, int aInPropIdx,
         Collection<String> aInComments)
     {
-        genRefCheck(aInIndent, aInPropIdx, aInComments);
-        genRefAccessors(aInIndent, aInPropIdx, aInComments);
-        genRefDefaultedAccessors(aInIndent, aInComments);
+        genRefReaders(aInIndent, aInPropIdx, aInComments, "");
         genRefMutators(aInIndent, aInClass, aInPropIdx, aInComments);
         genRefUnset(aInIndent, aInClass, aInPropIdx, aInComments);
     }
+
+    private void genRefReaders(
+        int aInIndent, int aInPropIdx, Collection<String> aInComments, String aInQual)
+    {
+        genRefCheck(aInIndent, aInPropIdx, aInComments, aInQual);
+        genRefAccessors(aInIndent, aInPropIdx, aInComments, aInQual);
+        genRefDefaultedAccessors(aInIndent, aInComments, aInQual);
+    }
     
     private void genPropCheck(
         int aInIndent, int aInPropIdx, Collection<String> aInComments,
-        String aInCheckName, String aInPType)
+        String aInCheckName, String aInPType, String aInQual)
     {
         //
         // COMMENT
@@ -299,7 +336,7 @@ public class FClassDef extends ItemFormatterTask
         //
         // METHOD DEFINITION
         //
-        out.println(aInIndent,"bool is" + Strings.upFirstLetter(aInCheckName) + "Set()");
+        out.println(aInIndent,"bool is" + Strings.upFirstLetter(aInCheckName) + "Set()" + aInQual);
 
         //
         // METHOD BODY
@@ -312,24 +349,26 @@ public class FClassDef extends ItemFormatterTask
     }
 
     private void genPropCheck(
-        int aInIndent, MProp aInProp, int aInPropIdx, MType aInBaseType, Collection<String> aInComments)
+        int aInIndent, MProp aInProp, int aInPropIdx, MType aInBaseType, Collection<String> aInComments,
+        String aInQual)
     {
         String lPType = FMetaDef.getTypeName(aInBaseType);
         genPropCheck(aInIndent, aInPropIdx,
                 aInComments, aInProp.getLID().getName(),
-                     lPType);
+                     lPType, aInQual);
     }
 
     private void genRefCheck(
-        int aInIndent, int aInPropIdx, Collection<String> aInComments)
+        int aInIndent, int aInPropIdx, Collection<String> aInComments, String aInQual)
     {
         genPropCheck(aInIndent, aInPropIdx,
-                aInComments, "target", "REFERENCE");
+                aInComments, "target", "REFERENCE", aInQual);
     }
 
     private void genPropAccessor(
         int aInIndent, int aInPropIdx, Collection<String> aInComments, String aInCheckName,
-        String aInName, String aInEffSyntax, String aInPType, String aInCast, String aInAccessor)
+        String aInName, String aInEffSyntax, String aInPType, String aInCast, String aInAccessor,
+        String aInQual)
     {
         //
         // COMMENT
@@ -345,7 +384,7 @@ public class FClassDef extends ItemFormatterTask
         }
         lComment[lCommentIdx++] = "@return the value of " + aInName + " or boost::none if not set";
         out.printHeaderComment(aInIndent,lComment);
-        out.println(aInIndent,"boost::optional<" + aInEffSyntax + "> get" + Strings.upFirstLetter(aInName) + "()");
+        out.println(aInIndent,"boost::optional<" + aInEffSyntax + "> get" + Strings.upFirstLetter(aInName) + "()" + aInQual);
         out.println(aInIndent,"{");
         out.println(aInIndent + 1,"if (is" + Strings.upFirstLetter(aInCheckName) + "Set())");
         out.println(aInIndent + 2,"return " + aInCast + "getObjectInstance().get" + aInPType + "(" + toUnsignedStr(aInPropIdx) + ")" + aInAccessor + ";");
@@ -356,7 +395,7 @@ public class FClassDef extends ItemFormatterTask
 
     private void genPropAccessor(
         int aInIndent, MProp aInProp, int aInPropIdx, MType aInBaseType,
-        Collection<String> aInComments)
+        Collection<String> aInComments, String aInQual)
     {
         String lName = aInProp.getLID().getName();
         String lPType = Strings.upFirstLetter(aInBaseType.getLID().getName());
@@ -364,22 +403,23 @@ public class FClassDef extends ItemFormatterTask
         String lCast = getCast(lPType, lEffSyntax);
         lPType = getTypeAccessor(lPType);
         genPropAccessor(aInIndent, aInPropIdx, aInComments,
-                        lName, lName, lEffSyntax, lPType, lCast, "");
+                        lName, lName, lEffSyntax, lPType, lCast, "", aInQual);
     }
 
     private void genRefAccessors(
         int aInIndent, int aInPropIdx,
-        Collection<String> aInComments)
+        Collection<String> aInComments, String aInQual)
     {
         String lName = "target";
         genPropAccessor(aInIndent, aInPropIdx, aInComments,
-                        lName, lName + "Class", "opflex::modb::class_id_t", "Reference", "", ".first");
+                        lName, lName + "Class", "opflex::modb::class_id_t", "Reference", "", ".first", aInQual);
         genPropAccessor(aInIndent, aInPropIdx, aInComments,
-                        lName, lName + "URI", "opflex::modb::URI", "Reference", "", ".second");
+                        lName, lName + "URI", "opflex::modb::URI", "Reference", "", ".second", aInQual);
     }
 
     private void genPropDefaultedAccessor(
-        int aInIndent, Collection<String> aInComments, String aInName, String aInEffSyntax)
+        int aInIndent, Collection<String> aInComments, String aInName, String aInEffSyntax,
+        String aInQual)
     {
         //
         // COMMENT
@@ -399,7 +439,7 @@ public class FClassDef extends ItemFormatterTask
         lComment[lCommentIdx++] = "@param defaultValue default value returned if the property is not set";
         lComment[lCommentIdx++] = "@return the value of " + aInName + " if set, otherwise the value of default passed in";
         out.printHeaderComment(aInIndent,lComment);
-        out.println(aInIndent, aInEffSyntax + " get" + Strings.upFirstLetter(aInName) + "(" + aInEffSyntax + " defaultValue)");
+        out.println(aInIndent, aInEffSyntax + " get" + Strings.upFirstLetter(aInName) + "(" + aInEffSyntax + " defaultValue)" + aInQual);
         //
         // BODY
         //
@@ -411,21 +451,21 @@ public class FClassDef extends ItemFormatterTask
 
     private void genPropDefaultedAccessor(
         int aInIndent, MProp aInProp, MType aInBaseType,
-        Collection<String> aInComments)
+        Collection<String> aInComments, String aInQual)
     {
         genPropDefaultedAccessor(aInIndent, aInComments,
                                  aInProp.getLID().getName(),
-                                 getPropEffSyntax(aInBaseType));
+                                 getPropEffSyntax(aInBaseType), aInQual);
     }
 
     private void genRefDefaultedAccessors(
-        int aInIndent, Collection<String> aInComments)
+        int aInIndent, Collection<String> aInComments, String aInQual)
     {
         String lName = "target";
         genPropDefaultedAccessor(aInIndent, aInComments,
-                                 lName + "Class", "const opflex::modb::class_id_t");
+                                 lName + "Class", "const opflex::modb::class_id_t", aInQual);
         genPropDefaultedAccessor(aInIndent, aInComments,
-                                 lName + "URI", "const opflex::modb::URI&");
+                                 lName + "URI", "const opflex::modb::URI&", aInQual);
     }
 
     private void genPropMutator(
@@ -1356,6 +1396,100 @@ public class FClassDef extends ItemFormatterTask
         }
     }
 
+    private void genView(int aInIdent, MClass aInClass)
+    {
+        if (!aInClass.isConcrete())
+        {
+            return;
+        }
+        String lclassName = getClassName(aInClass, false);
+        out.printHeaderComment(aInIdent, Arrays.asList(
+            "A read-only view of an instance of " + lclassName + " pinned in a",
+            "snapshot.  Views own nothing and are created without allocating,",
+            "and are valid only until the snapshot is cleared or destroyed.",
+            "",
+            "@see opflex::modb::MOSnapshot"));
+        out.println(aInIdent, "class View : public opflex::modb::mointernal::MOView");
+        out.println(aInIdent, "{");
+        out.println(aInIdent, "public:");
+        out.println();
+
+        out.printHeaderComment(aInIdent + 1, Arrays.asList(
+            "Retrieve a view of an instance of " + lclassName + " from the",
+            "snapshot, pinning it in the snapshot.  If the object does not",
+            "exist in the local store, returns boost::none.",
+            "",
+            "@param snapshot the snapshot to use",
+            "@param uri the URI of the object to retrieve",
+            "@return a view of the object or boost::none if it does not",
+            "exist."));
+        out.println(aInIdent + 1, "static boost::optional<View> resolve(");
+        out.println(aInIdent + 2, "opflex::modb::MOSnapshot& snapshot,");
+        out.println(aInIdent + 2, "const opflex::modb::URI& uri)");
+        out.println(aInIdent + 1, "{");
+        out.println(aInIdent + 2, "return opflex::modb::mointernal::MOView::resolve<View>(snapshot, CLASS_ID, uri);");
+        out.println(aInIdent + 1, "}");
+        out.println();
+
+        TreeMap<String, MProp> lProps = new TreeMap<>();
+        aInClass.findProp(lProps, true);
+        for (MProp lProp : lProps.values())
+        {
+            genPropReaders(aInIdent + 1, aInClass, lProp, lProp.getPropId(aInClass), " const");
+        }
+
+        Map<Ident,MClass> lConts = new TreeMap<>();
+        aInClass.getContainsClasses(lConts);
+        for (MClass lChildClass : lConts.values())
+        {
+            genViewChildResolver(aInIdent + 1, aInClass, lChildClass);
+        }
+
+        out.printHeaderComment(aInIdent + 1, Arrays.asList(
+            "Construct a view of an instance of " + lclassName + " pinned in",
+            "the snapshot.  This should not typically be called from user code."));
+        out.println(aInIdent + 1, "View(opflex::modb::MOSnapshot& snapshot, size_t index)");
+        out.println(aInIdent + 2, ": MOView(snapshot, index) { }");
+        out.println(aInIdent, "}; // class View");
+        out.println();
+    }
+
+    private void genViewChildResolver(int aInIdent, MClass aInParentClass, MClass aInChildClass)
+    {
+        MNamer lChildNamer = MNamer.get(aInChildClass.getGID().getName(),false);
+        MNameRule lChildNr = lChildNamer.findNameRule(aInParentClass.getGID().getName());
+        if (null == lChildNr)
+        {
+            return;
+        }
+        boolean lMultipleChildren = false;
+        for (MNameComponent lNc : lChildNr.getComponents())
+        {
+            if (lNc.hasPropName())
+            {
+                lMultipleChildren = true;
+                break;
+            }
+        }
+        if (!lMultipleChildren)
+        {
+            return;
+        }
+        String lFormattedChildClassName = getClassName(aInChildClass,true);
+        out.printHeaderComment(aInIdent, Arrays.asList(
+            "Resolve all of the immediate children of type",
+            lFormattedChildClassName + " that exist in the local store,",
+            "pinning them in the snapshot of this view.",
+            "",
+            "@return a range of views of the child objects"));
+        out.println(aInIdent, "opflex::modb::MOSnapshot::Range<" + lFormattedChildClassName + "::View> resolve" + aInChildClass.getFullConcatenatedName() + "() const");
+        out.println(aInIdent, "{");
+        out.println(aInIdent + 1, "return resolveChildren<" + lFormattedChildClassName + "::View>(");
+        out.println(aInIdent + 2, toUnsignedStr(aInChildClass.getClassAsPropId(aInParentClass)) + ", " + aInChildClass.getGID().getId() + ");");
+        out.println(aInIdent, "}");
+        out.println();
+    }
+
     private void genConstructor(int aInIdent, MClass aInClass)
     {
         String lclassName = getClassName(aInClass, false);
@@ -0,0 +1,140 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Helpers shared by the libopflex benchmarks
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#ifndef OPFLEX_BENCH_BENCHUTIL_H
+#define OPFLEX_BENCH_BENCHUTIL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace opflex {
+namespace bench {
+
+using std::chrono::steady_clock;
+
+/**
+ * Milliseconds elapsed since start
+ */
+inline double msSince(steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>
+        (steady_clock::now() - start).count();
+}
+
+/**
+ * Microseconds elapsed since start
+ */
+inline double usSince(steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>
+        (steady_clock::now() - start).count();
+}
+
+/**
+ * Poll pred until it returns true or timeoutMs elapses
+ *
+ * @return the final value of pred
+ */
+inline bool waitFor(const std::function<bool()>& pred, int timeoutMs) {
+    steady_clock::time_point deadline =
+        steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!pred()) {
+        if (steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return true;
+}
+
+/**
+ * Read a positional numeric argument, falling back to a default so
+ * that a bare run is always the same workload
+ */
+inline size_t argOr(int argc, char** argv, int i, size_t def) {
+    return argc > i ? std::strtoul(argv[i], NULL, 10) : def;
+}
+
+/**
+ * A set of samples, summarized as percentiles
+ */
+class Samples {
+public:
+    void reserve(size_t n) { samples.reserve(n); }
+    void add(double v) { samples.push_back(v); sorted = false; }
+    size_t size() const { return samples.size(); }
+
+    /**
+     * Nearest-rank percentile, p in [0, 100]
+     */
+    double percentile(double p) {
+        if (samples.empty()) return 0;
+        if (!sorted) {
+            std::sort(samples.begin(), samples.end());
+            sorted = true;
+        }
+        size_t rank = size_t(p / 100 * (samples.size() - 1) + 0.5);
+        return samples[std::min(rank, samples.size() - 1)];
+    }
+
+    double median() { return percentile(50); }
+
+private:
+    std::vector<double> samples;
+    bool sorted = false;
+};
+
+/**
+ * Accumulates a flat JSON object, one benchmark result per line, so
+ * that runs can be collected and diffed across commits
+ */
+class JsonReport {
+public:
+    explicit JsonReport(const std::string& benchmark) {
+        out << "{\"benchmark\": \"" << benchmark << "\"";
+    }
+
+    JsonReport& add(const std::string& key, double value) {
+        out << ", \"" << key << "\": " << value;
+        return *this;
+    }
+
+    JsonReport& add(const std::string& key, const std::string& value) {
+        out << ", \"" << key << "\": \"" << value << "\"";
+        return *this;
+    }
+
+    /**
+     * Add p50/p90/p99/max of samples as <key>_p50 etc.
+     */
+    JsonReport& addLatency(const std::string& key, Samples& samples) {
+        return add(key + "_p50", samples.percentile(50))
+            .add(key + "_p90", samples.percentile(90))
+            .add(key + "_p99", samples.percentile(99))
+            .add(key + "_max", samples.percentile(100));
+    }
+
+    void print(std::ostream& os = std::cout) {
+        os << out.str() << "}" << std::endl;
+    }
+
+private:
+    std::ostringstream out;
+};
+
+} /* namespace bench */
+} /* namespace opflex */
+
+#endif /* OPFLEX_BENCH_BENCHUTIL_H */
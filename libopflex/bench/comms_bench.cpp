@@ -0,0 +1,233 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Loopback benchmark for the yajr JSON-RPC transport
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <uv.h>
+
+#include <yajr/rpc/methods.hpp>
+#include <yajr/transport/ZeroCopyOpenSSL.hpp>
+#include <opflex/yajr/internal/comms.hpp>
+#include <opflex/logging/StdOutLogHandler.h>
+#include <opflex/logging/internal/logging.hpp>
+
+#include "BenchUtil.h"
+
+using namespace opflex::bench;
+using namespace opflex::logging;
+using yajr::transport::ZeroCopyOpenSSL;
+
+static const uint16_t PORT = 8021;
+
+/*
+ * State for one run: a listener and a client peer on the same loop.
+ * The client first sends requests one at a time to measure the round
+ * trip, then keeps window requests in flight to measure throughput.
+ */
+struct CommsBench {
+    uv_loop_t loop;
+    yajr::Listener* listener;
+    yajr::Peer* client;
+    ZeroCopyOpenSSL::Ctx* serverCtx;
+    ZeroCopyOpenSSL::Ctx* clientCtx;
+
+    std::string payload;
+    size_t requests;
+    size_t window;
+
+    bool pipelined;
+    size_t sent;
+    size_t received;
+    steady_clock::time_point lastSend;
+    steady_clock::time_point start;
+    Samples rtt;
+    double throughputMs;
+    bool done;
+
+    void sendOne() {
+        ++sent;
+        lastSend = steady_clock::now();
+        std::string& p = payload;
+        yajr::rpc::OutReq<&yajr::rpc::method::custom>(
+            [&p](yajr::rpc::SendHandler& h) {
+                return h.StartArray() &&
+                    h.String(p.c_str(), p.size()) &&
+                    h.EndArray();
+            }, client).send();
+    }
+
+    void finish() {
+        done = true;
+        client->destroy();
+        listener->destroy();
+    }
+
+    void onReply() {
+        ++received;
+        if (!pipelined) {
+            rtt.add(usSince(lastSend));
+            if (received < requests) {
+                sendOne();
+                return;
+            }
+            /* switch to the pipelined phase */
+            pipelined = true;
+            sent = received = 0;
+            start = steady_clock::now();
+            while (sent < window && sent < requests)
+                sendOne();
+            return;
+        }
+        if (sent < requests) {
+            sendOne();
+        } else if (received == requests) {
+            throughputMs = msSince(start);
+            finish();
+        }
+    }
+};
+
+namespace yajr {
+    namespace rpc {
+
+template<>
+void InbReq<&yajr::rpc::method::custom>::process() const {
+    OutboundResult(this, GeneratorFromValue(getPayload())).send();
+}
+
+template<>
+void InbRes<&yajr::rpc::method::custom>::process() const {
+    static_cast<CommsBench*>(getPeer()->getData())->onReply();
+}
+
+} /* yajr::rpc namespace */
+} /* yajr namespace */
+
+static uv_loop_t* currentLoop;
+
+static uv_loop_t* loopSelector(void*) {
+    return currentLoop;
+}
+
+static void* passthroughAccept(yajr::Listener*, void* data, int) {
+    return data;
+}
+
+static void onServerStateChange(yajr::Peer* p, void* data,
+                                yajr::StateChange::To stateChange,
+                                int error) {
+    if (stateChange == yajr::StateChange::CONNECT && data)
+        ZeroCopyOpenSSL::attachTransport(
+            p, static_cast<ZeroCopyOpenSSL::Ctx*>(data));
+}
+
+static void onClientStateChange(yajr::Peer* p, void* data,
+                                yajr::StateChange::To stateChange,
+                                int error) {
+    CommsBench* b = static_cast<CommsBench*>(data);
+    switch (stateChange) {
+    case yajr::StateChange::CONNECT:
+        b->sendOne();
+        break;
+    case yajr::StateChange::FAILURE:
+        LOG(ERROR) << "connection failed: " << uv_strerror(error);
+        if (!b->done)
+            b->finish();
+        break;
+    case yajr::StateChange::DELETE:
+        yajr::finiLoop(&b->loop);
+        break;
+    default:
+        break;
+    }
+}
+
+static bool runOnce(bool ssl, size_t payloadLen, size_t requests,
+                    size_t window, JsonReport& report) {
+    std::unique_ptr<ZeroCopyOpenSSL::Ctx> serverCtx, clientCtx;
+    if (ssl) {
+        serverCtx.reset(ZeroCopyOpenSSL::Ctx::createCtx(
+                            NULL, SRCDIR"/comms/test/server.pem",
+                            "password123"));
+        clientCtx.reset(ZeroCopyOpenSSL::Ctx::createCtx(
+                            SRCDIR"/comms/test/ca.pem", NULL));
+        if (!serverCtx || !clientCtx)
+            return false;
+    }
+
+    CommsBench b;
+    b.serverCtx = serverCtx.get();
+    b.clientCtx = clientCtx.get();
+    b.payload.assign(payloadLen, 'x');
+    b.requests = requests;
+    b.window = window;
+    b.pipelined = false;
+    b.sent = b.received = 0;
+    b.throughputMs = 0;
+    b.done = false;
+
+    uv_loop_init(&b.loop);
+    yajr::initLoop(&b.loop);
+    currentLoop = &b.loop;
+
+    b.listener = yajr::Listener::create("127.0.0.1", PORT,
+                                        onServerStateChange,
+                                        passthroughAccept, b.serverCtx,
+                                        &b.loop, loopSelector);
+    b.client = yajr::Peer::create("127.0.0.1", std::to_string(PORT),
+                                  onClientStateChange, &b, loopSelector);
+    if (ssl && !ZeroCopyOpenSSL::attachTransport(b.client, b.clientCtx))
+        return false;
+
+    uv_run(&b.loop, UV_RUN_DEFAULT);
+    uv_loop_close(&b.loop);
+
+    if (!b.throughputMs)
+        return false;
+
+    std::string prefix(ssl ? "ssl_" : "plain_");
+    double mb = 2.0 * payloadLen * requests / (1024.0 * 1024.0);
+    report.addLatency(prefix + "rtt_us", b.rtt)
+        .add(prefix + "msgs_per_sec", requests / (b.throughputMs / 1000))
+        .add(prefix + "mb_per_sec", mb / (b.throughputMs / 1000));
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t payloadLen = argOr(argc, argv, 1, 1024);
+    size_t requests = argOr(argc, argv, 2, 20000);
+    size_t window = argOr(argc, argv, 3, 64);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+    ZeroCopyOpenSSL::initOpenSSL(false);
+
+    JsonReport report("comms");
+    report.add("payload_bytes", payloadLen)
+        .add("requests", requests)
+        .add("window", window);
+    if (!runOnce(false, payloadLen, requests, window, report) ||
+        !runOnce(true, payloadLen, requests, window, report)) {
+        std::cerr << "loopback exchange did not complete" << std::endl;
+        return 1;
+    }
+    report.print();
+
+    ZeroCopyOpenSSL::finiOpenSSL();
+    return 0;
+}
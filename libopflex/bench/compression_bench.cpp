@@ -0,0 +1,302 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Loopback benchmark for OpFlex message compression
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/assign/list_of.hpp>
+
+#include "opflex/modb/internal/ObjectStore.h"
+#include "opflex/engine/Processor.h"
+#include "opflex/engine/internal/GbpOpflexServerImpl.h"
+#include "opflex/logging/StdOutLogHandler.h"
+
+#include "MDFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine;
+using namespace opflex::engine::internal;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+using boost::asio::ip::tcp;
+using boost::asio::ip::address_v4;
+using opflex::ofcore::OFConstants;
+using opflex::util::ThreadManager;
+
+#define SERVER_ROLES \
+        (OFConstants::POLICY_REPOSITORY |     \
+         OFConstants::ENDPOINT_REGISTRY |     \
+         OFConstants::OBSERVER)
+#define LOCALHOST "127.0.0.1"
+
+static const uint16_t SERVER_PORT = 8019;
+static const uint16_t RELAY_PORT = 8020;
+
+/*
+ * TCP relay between the agent and the server counting the bytes that
+ * actually cross the socket in each direction.
+ */
+class CountingRelay {
+public:
+    CountingRelay(uint16_t port, uint16_t upstream_)
+        : acceptor(io, tcp::endpoint(address_v4::loopback(), port)),
+          upstream(upstream_), toServer(0), toClient(0) {}
+
+    void start() {
+        accept();
+        thread = std::thread([this]() { io.run(); });
+    }
+
+    void stop() {
+        io.stop();
+        thread.join();
+    }
+
+    uint64_t getToServer() const { return toServer; }
+    uint64_t getToClient() const { return toClient; }
+
+private:
+    typedef std::array<char, 65536> buffer_t;
+
+    struct Session {
+        Session(boost::asio::io_service& io) : client(io), server(io) {}
+        tcp::socket client;
+        tcp::socket server;
+        buffer_t clientBuf;
+        buffer_t serverBuf;
+    };
+    typedef std::shared_ptr<Session> session_ptr;
+
+    void accept() {
+        session_ptr s = std::make_shared<Session>(io);
+        acceptor.async_accept(s->client,
+            [this, s](const boost::system::error_code& ec) {
+                if (ec) return;
+                tcp::endpoint ep(address_v4::loopback(), upstream);
+                s->server.async_connect(ep,
+                    [this, s](const boost::system::error_code& ec) {
+                        if (ec) return;
+                        pump(s, s->client, s->server, s->clientBuf,
+                             toServer);
+                        pump(s, s->server, s->client, s->serverBuf,
+                             toClient);
+                    });
+                accept();
+            });
+    }
+
+    void pump(session_ptr s, tcp::socket& from, tcp::socket& to,
+              buffer_t& buf, std::atomic<uint64_t>& counter) {
+        from.async_read_some(boost::asio::buffer(buf),
+            [this, s, &from, &to, &buf, &counter]
+            (const boost::system::error_code& ec, size_t n) {
+                if (ec) {
+                    boost::system::error_code ignored;
+                    to.close(ignored);
+                    return;
+                }
+                counter += n;
+                boost::asio::async_write(to, boost::asio::buffer(buf, n),
+                    [this, s, &from, &to, &buf, &counter]
+                    (const boost::system::error_code& ec, size_t) {
+                        if (ec) {
+                            boost::system::error_code ignored;
+                            from.close(ignored);
+                            return;
+                        }
+                        pump(s, from, to, buf, counter);
+                    });
+            });
+    }
+
+    boost::asio::io_service io;
+    tcp::acceptor acceptor;
+    uint16_t upstream;
+    std::thread thread;
+    std::atomic<uint64_t> toServer;
+    std::atomic<uint64_t> toClient;
+};
+
+struct Result {
+    double connectMs;
+    double resolveMs;
+    double updateMs;
+    uint64_t toServer;
+    uint64_t toClient;
+};
+
+/*
+ * Have a local relationship object reference every policy on the
+ * server, time how long it takes for all of them to be downloaded,
+ * then time a policy update touching every object.
+ */
+static bool runOnce(const ModelMetadata& md, bool compression,
+                    size_t objects, size_t children, Result& result) {
+    CountingRelay relay(RELAY_PORT, SERVER_PORT);
+    relay.start();
+
+    GbpOpflexServerImpl server(SERVER_PORT, SERVER_ROLES,
+                               boost::assign::list_of
+                               (std::make_pair(SERVER_ROLES,
+                                               LOCALHOST":8020")),
+                               std::vector<std::string>(), md, 60);
+    server.start();
+    if (!waitFor([&]() { return server.getListener().isListening(); },
+                 5000)) {
+        server.stop();
+        relay.stop();
+        return false;
+    }
+
+    StoreClient* rclient = server.getSystemClient();
+    std::vector<URI> uris;
+    std::vector<reference_t> refs;
+    rclient->put(1, URI::ROOT, std::make_shared<ObjectInstance>(1));
+    for (size_t i = 0; i < objects; ++i) {
+        URI c4u("/class4/" + std::to_string(i) +
+                "-policy-with-a-reasonably-long-name/");
+        auto oi4 = std::make_shared<ObjectInstance>(4);
+        oi4->setString(9, "value-" + std::to_string(i));
+        rclient->put(4, c4u, oi4);
+        rclient->addChild(1, URI::ROOT, 8, 4, c4u);
+        for (size_t j = 0; j < children; ++j) {
+            URI c6u(c4u.toString() + "class6/" + std::to_string(j) + "/");
+            auto oi6 = std::make_shared<ObjectInstance>(6);
+            oi6->setString(13, "child-" + std::to_string(j));
+            rclient->put(6, c6u, oi6);
+            rclient->addChild(4, c4u, 12, 6, c6u);
+        }
+        uris.push_back(c4u);
+        refs.emplace_back(4, c4u);
+    }
+
+    ThreadManager dbThreadManager;
+    ObjectStore db(dbThreadManager);
+    db.init(md);
+    db.start();
+    StoreClient* client = &db.getStoreClient("owner2");
+
+    bool ok;
+    {
+        ThreadManager threadManager;
+        Processor processor(&db, threadManager);
+        processor.setProcDelay(5);
+        processor.setRetryDelay(100);
+        processor.setOpflexIdentity("bench", "testdomain");
+        processor.setCompression(compression);
+        processor.start();
+
+        auto start = steady_clock::now();
+        processor.addPeer(LOCALHOST, RELAY_PORT);
+        ok = waitFor([&]() {
+                OpflexConnection* conn =
+                    processor.getPool().getPeer(LOCALHOST, RELAY_PORT);
+                return conn != NULL && conn->isReady();
+            }, 5000);
+        result.connectMs = msSince(start);
+
+        if (ok) {
+            start = steady_clock::now();
+            URI c5u("/class5/bench/");
+            auto oi5 = std::make_shared<ObjectInstance>(5);
+            for (const URI& u : uris)
+                oi5->addReference(11, 4, u);
+            StoreClient::notif_t notifs;
+            client->put(5, c5u, oi5);
+            client->queueNotification(5, c5u, notifs);
+            client->deliverNotifications(notifs);
+            ok = waitFor([&]() {
+                    for (const URI& u : uris)
+                        if (!client->isPresent(4, u))
+                            return false;
+                    return true;
+                }, 60000);
+            result.resolveMs = msSince(start);
+        }
+
+        if (ok) {
+            for (size_t i = 0; i < objects; ++i) {
+                auto oi4 = std::make_shared<ObjectInstance>(4);
+                oi4->setString(9, "updated-" + std::to_string(i));
+                rclient->put(4, uris[i], oi4);
+            }
+            start = steady_clock::now();
+            server.policyUpdate(std::vector<reference_t>(), refs,
+                                std::vector<reference_t>());
+            ok = waitFor([&]() {
+                    return client->get(4, uris.back())->getString(9) ==
+                        "updated-" + std::to_string(objects - 1);
+                }, 60000);
+            result.updateMs = msSince(start);
+        }
+
+        processor.stop();
+        threadManager.stop();
+    }
+    db.stop();
+    server.stop();
+    relay.stop();
+
+    result.toServer = relay.getToServer();
+    result.toClient = relay.getToClient();
+    return ok;
+}
+
+static void printResult(const char* name, const Result& r) {
+    std::cout << "\"" << name << "\": {"
+              << "\"connect_ms\": " << r.connectMs << ", "
+              << "\"resolve_ms\": " << r.resolveMs << ", "
+              << "\"update_ms\": " << r.updateMs << ", "
+              << "\"bytes_to_server\": " << r.toServer << ", "
+              << "\"bytes_to_client\": " << r.toClient << "}";
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 2000);
+    size_t children = argOr(argc, argv, 2, 4);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    MDFixture mdf;
+    Result plain = {}, deflate = {};
+    if (!runOnce(mdf.md, false, objects, children, plain) ||
+        !runOnce(mdf.md, true, objects, children, deflate)) {
+        std::cerr << "policy download did not complete" << std::endl;
+        return 1;
+    }
+
+    std::cout << "{\"benchmark\": \"compression\", "
+              << "\"objects\": " << objects << ", "
+              << "\"children\": " << children << ", ";
+    printResult("plain", plain);
+    std::cout << ", ";
+    printResult("deflate", deflate);
+    std::cout << ", \"ratio\": "
+              << (deflate.toClient
+                  ? double(plain.toClient) / deflate.toClient : 0)
+              << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,228 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for resolving class and property names while deserializing
+ * a large policy document
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "opflex/engine/internal/MOSerializer.h"
+#include "opflex/logging/StdOutLogHandler.h"
+#include "opflex/modb/URIBuilder.h"
+
+#include "BaseFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine::internal;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+using namespace rapidjson;
+
+/*
+ * A policy document as a policy repository would send it: `objects`
+ * class4 policies with `children` class6 children each, under a root
+ * that also holds a class5 relationship referencing every policy.
+ */
+static size_t populate(StoreClient& client, size_t objects,
+                       size_t children) {
+    size_t count = 2;
+    client.put(1, URI::ROOT, OF_MAKE_SHARED<ObjectInstance>(1));
+    URI c5u(URIBuilder().addElement("class5").addElement("bench").build());
+    OF_SHARED_PTR<ObjectInstance> oi5 = OF_MAKE_SHARED<ObjectInstance>(5);
+    oi5->setString(10, "bench");
+    for (size_t i = 0; i < objects; ++i) {
+        URI c4u(URIBuilder().addElement("class4")
+                .addElement("policy-" + std::to_string(i)).build());
+        OF_SHARED_PTR<ObjectInstance> oi4 = OF_MAKE_SHARED<ObjectInstance>(4);
+        oi4->setString(9, "value-" + std::to_string(i));
+        client.put(4, c4u, oi4);
+        client.addChild(1, URI::ROOT, 8, 4, c4u);
+        oi5->addReference(11, 4, c4u);
+        count += 1;
+        for (size_t j = 0; j < children; ++j) {
+            URI c6u(URIBuilder(c4u).addElement("class6")
+                    .addElement(std::to_string(j)).build());
+            OF_SHARED_PTR<ObjectInstance> oi6 =
+                OF_MAKE_SHARED<ObjectInstance>(6);
+            oi6->setString(13, "child-" + std::to_string(j));
+            client.put(6, c6u, oi6);
+            client.addChild(4, c4u, 12, 6, c6u);
+            count += 1;
+        }
+    }
+    client.put(5, c5u, oi5);
+    client.addChild(1, URI::ROOT, 24, 5, c5u);
+    return count;
+}
+
+/*
+ * The names that deserializing one managed object resolves: its
+ * subject, and the name of each of its properties
+ */
+struct MoNames {
+    const Value* subject;
+    std::vector<const Value*> props;
+};
+
+/*
+ * Lookup tables keyed by std::string, as the store and class metadata
+ * kept them before the generated name indexes
+ */
+typedef OF_UNORDERED_MAP<std::string, prop_id_t> prop_names_t;
+struct StringClass {
+    const ClassInfo* ci;
+    prop_names_t props;
+};
+typedef OF_UNORDERED_MAP<std::string, StringClass> class_names_t;
+
+static size_t lookupStrings(const class_names_t& classes,
+                            const std::vector<MoNames>& names) {
+    size_t sink = 0;
+    for (const MoNames& mo : names) {
+        class_names_t::const_iterator cit =
+            classes.find(mo.subject->GetString());
+        if (cit == classes.end()) continue;
+        const ClassInfo::property_map_t& props =
+            cit->second.ci->getProperties();
+        for (const Value* pname : mo.props) {
+            prop_names_t::const_iterator pit =
+                cit->second.props.find(pname->GetString());
+            if (pit == cit->second.props.end()) continue;
+            sink += props.at(pit->second).getId();
+        }
+    }
+    return sink;
+}
+
+static size_t lookupIndex(const ObjectStore& db,
+                          const std::vector<MoNames>& names) {
+    size_t sink = 0;
+    for (const MoNames& mo : names) {
+        const ClassInfo* ci =
+            db.findClassInfo(mo.subject->GetString(),
+                             mo.subject->GetStringLength());
+        if (ci == NULL) continue;
+        for (const Value* pname : mo.props) {
+            const PropertyInfo* pi =
+                ci->findProperty(pname->GetString(),
+                                 pname->GetStringLength());
+            if (pi == NULL) continue;
+            sink += pi->getId();
+        }
+    }
+    return sink;
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 20000);
+    size_t children = argOr(argc, argv, 2, 4);
+    size_t rounds = argOr(argc, argv, 3, 10);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    BaseFixture f;
+    StoreClient& sysClient = f.db.getStoreClient("_SYSTEM_");
+    size_t count = populate(sysClient, objects, children);
+    MOSerializer serializer(&f.db);
+
+    StringBuffer buffer;
+    {
+        Writer<StringBuffer> writer(buffer);
+        writer.StartArray();
+        serializer.serialize(1, URI::ROOT, sysClient, writer);
+        writer.EndArray();
+    }
+    size_t bytes = buffer.GetSize();
+
+    Document d;
+    d.Parse(buffer.GetString());
+
+    Samples deserMs;
+    for (size_t r = 0; r < rounds; ++r) {
+        /* start each round from an empty store so every object is new */
+        BaseFixture target;
+        StoreClient& targetClient = target.db.getStoreClient("_SYSTEM_");
+        MOSerializer targetSerializer(&target.db);
+        StoreClient::notif_t notifs;
+        steady_clock::time_point start = steady_clock::now();
+        for (Value::ConstValueIterator it = d.Begin(); it != d.End(); ++it)
+            targetSerializer.deserialize(*it, targetClient, true, &notifs);
+        deserMs.add(msSince(start));
+    }
+
+    /* the name lookups alone, out of the same document */
+    std::vector<MoNames> names;
+    size_t lookups = 0;
+    for (Value::ConstValueIterator it = d.Begin(); it != d.End(); ++it) {
+        MoNames mo;
+        mo.subject = &(*it)["subject"];
+        if (it->HasMember("properties")) {
+            const Value& props = (*it)["properties"];
+            for (Value::ConstValueIterator pit = props.Begin();
+                 pit != props.End(); ++pit) {
+                if (pit->HasMember("name"))
+                    mo.props.push_back(&(*pit)["name"]);
+            }
+        }
+        lookups += 1 + mo.props.size();
+        names.push_back(mo);
+    }
+
+    class_names_t classes;
+    for (const ClassInfo& ci : f.md.getClasses()) {
+        StringClass& sc = classes[ci.getName()];
+        sc.ci = &f.db.getClassInfo(ci.getId());
+        for (const ClassInfo::property_map_t::value_type& p :
+                 ci.getProperties())
+            sc.props[p.second.getName()] = p.first;
+    }
+
+    size_t sink = 0;
+    Samples stringMs, indexMs;
+    for (size_t r = 0; r < rounds; ++r) {
+        steady_clock::time_point start = steady_clock::now();
+        sink += lookupStrings(classes, names);
+        stringMs.add(msSince(start));
+
+        start = steady_clock::now();
+        sink += lookupIndex(f.db, names);
+        indexMs.add(msSince(start));
+    }
+
+    double mb = bytes / (1024.0 * 1024.0);
+    JsonReport("deserialize")
+        .add("objects", count)
+        .add("bytes", bytes)
+        .add("rounds", rounds)
+        .add("deserialize_ms", deserMs.median())
+        .add("deserialize_mb_per_sec", mb / (deserMs.median() / 1000))
+        .add("deserialize_objects_per_sec",
+             count / (deserMs.median() / 1000))
+        .add("name_lookups", lookups)
+        .add("string_lookup_ms", stringMs.median())
+        .add("index_lookup_ms", indexMs.median())
+        .add("lookup_speedup", indexMs.median() > 0
+             ? stringMs.median() / indexMs.median() : 0)
+        .add("sink", sink)
+        .print();
+    return 0;
+}
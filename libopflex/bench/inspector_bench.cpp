@@ -0,0 +1,195 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for Inspector queries against a large store: query time
+ * and peak memory for unpaged, paged and streamed queries
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "opflex/engine/Inspector.h"
+#include "opflex/engine/InspectorClientImpl.h"
+#include "opflex/logging/StdOutLogHandler.h"
+
+#include "BaseFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+static const std::string SOCK_NAME("/tmp/inspector_bench.sock");
+
+struct Mode {
+    const char* name;
+    size_t pageSize;
+    bool stream;
+};
+
+/* streamed first, since the agent's peak RSS only ever goes up */
+static const Mode MODES[] = {
+    { "streamed", 1000, true },
+    { "paged", 1000, false },
+    { "unpaged", 0, false },
+};
+static const size_t NMODES = sizeof(MODES) / sizeof(MODES[0]);
+
+struct ClientResult {
+    double queryMs;
+    long maxRssKb;
+};
+
+struct Client {
+    pid_t pid;
+    int startFd;
+    int resultFd;
+};
+
+static long maxRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*
+ * Run one gbp_inspect-style recursive class query, writing the list
+ * output to /dev/null
+ */
+static void runClient(const Mode& mode, int startFd, int resultFd) {
+    char go;
+    if (read(startFd, &go, 1) != 1)
+        _exit(1);
+
+    MDFixture mdf;
+    std::ofstream devnull("/dev/null");
+    ClientResult result;
+    {
+        InspectorClientImpl client(SOCK_NAME, mdf.md);
+        client.setRecursive(true);
+        client.setPageSize(mode.pageSize);
+        if (mode.stream)
+            client.setStreamOutput(&devnull, true, false);
+        client.addClassQuery("class4");
+
+        steady_clock::time_point start = steady_clock::now();
+        client.execute();
+        if (!mode.stream)
+            client.prettyPrint(devnull, false, true, false);
+        result.queryMs = msSince(start);
+        result.maxRssKb = maxRssKb();
+    }
+    ssize_t w = write(resultFd, &result, sizeof(result));
+    _exit(w == sizeof(result) ? 0 : 1);
+}
+
+/*
+ * Fork the clients before the store is populated so that their peak
+ * RSS only counts what they retrieve
+ */
+static bool spawnClients(std::vector<Client>& clients) {
+    for (size_t i = 0; i < NMODES; ++i) {
+        int startPipe[2], resultPipe[2];
+        if (pipe(startPipe) != 0 || pipe(resultPipe) != 0)
+            return false;
+        pid_t pid = fork();
+        if (pid < 0)
+            return false;
+        if (pid == 0) {
+            close(startPipe[1]);
+            close(resultPipe[0]);
+            runClient(MODES[i], startPipe[0], resultPipe[1]);
+        }
+        close(startPipe[0]);
+        close(resultPipe[1]);
+        Client c = { pid, startPipe[1], resultPipe[0] };
+        clients.push_back(c);
+    }
+    return true;
+}
+
+static size_t populate(StoreClient& client, size_t objects) {
+    for (size_t i = 0; i < objects; ++i) {
+        URI c4u("/class4/policy-" + std::to_string(i) + "/");
+        URI c6u(c4u.toString() + "class6/child/");
+        OF_SHARED_PTR<ObjectInstance> oi4 = OF_MAKE_SHARED<ObjectInstance>(4);
+        oi4->setString(9, "value-" + std::to_string(i));
+        OF_SHARED_PTR<ObjectInstance> oi6 = OF_MAKE_SHARED<ObjectInstance>(6);
+        oi6->setString(13, "child");
+        client.put(4, c4u, oi4);
+        client.put(6, c6u, oi6);
+        client.addChild(4, c4u, 12, 6, c6u);
+    }
+    return objects * 2;
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 250000);
+
+    std::vector<Client> clients;
+    if (!spawnClients(clients)) {
+        perror("could not start inspector clients");
+        return 1;
+    }
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    BaseFixture f;
+    size_t count = populate(*f.client2, objects);
+    Inspector inspector(&f.db);
+    inspector.setSocketName(SOCK_NAME);
+    inspector.start();
+    struct stat buffer;
+    waitFor([&]() { return stat(SOCK_NAME.c_str(), &buffer) == 0; }, 5000);
+
+    JsonReport report("inspector");
+    report.add("objects", count);
+    bool ok = true;
+    for (size_t i = 0; i < clients.size(); ++i) {
+        std::string prefix(std::string(MODES[i].name) + "_");
+        long agentBefore = maxRssKb();
+        ClientResult result;
+        char go = 1;
+        ok = ok &&
+            write(clients[i].startFd, &go, 1) == 1 &&
+            read(clients[i].resultFd, &result, sizeof(result)) ==
+            sizeof(result);
+        if (ok)
+            report.add(prefix + "query_ms", result.queryMs)
+                .add(prefix + "client_max_rss_kb", result.maxRssKb)
+                .add(prefix + "agent_rss_growth_kb",
+                     maxRssKb() - agentBefore);
+        close(clients[i].startFd);
+        close(clients[i].resultFd);
+        waitpid(clients[i].pid, NULL, 0);
+    }
+
+    inspector.stop();
+    std::remove(SOCK_NAME.c_str());
+    if (!ok) {
+        std::cerr << "inspector query did not complete" << std::endl;
+        return 1;
+    }
+    report.print();
+    return 0;
+}
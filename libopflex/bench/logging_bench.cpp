@@ -0,0 +1,146 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for log-heavy workloads: throughput and per-message
+ * latency of logging threads, writing synchronously and through an
+ * AsyncLogHandler
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opflex/logging/AsyncLogHandler.h"
+
+#include "BenchUtil.h"
+
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+static const char* LOG_FILE = "/tmp/logging_bench.log";
+
+/*
+ * Writes each message to a file, flushing it as it goes when called
+ * directly and once per batch when called through the async handler
+ */
+class FileLogHandler : public OFLogHandler {
+public:
+    FileLogHandler()
+        : OFLogHandler(INFO), out(LOG_FILE, std::ios_base::trunc) {}
+
+    virtual void handleMessage(const std::string& file,
+                               const int line,
+                               const std::string& function,
+                               const Level level,
+                               const std::string& message) {
+        std::lock_guard<std::mutex> guard(mtx);
+        out << "[" << level << "] [" << file << ":" << line << ":"
+            << function << "] " << message << std::endl;
+    }
+
+    virtual void handleDeferredMessage(const struct timespec& timestamp,
+                                       const std::string& file,
+                                       const int line,
+                                       const std::string& function,
+                                       const Level level,
+                                       const std::string& message) {
+        std::lock_guard<std::mutex> guard(mtx);
+        out << "[" << level << "] [" << file << ":" << line << ":"
+            << function << "] " << message << '\n';
+    }
+
+    virtual void flush() {
+        std::lock_guard<std::mutex> guard(mtx);
+        out.flush();
+    }
+
+private:
+    std::mutex mtx;
+    std::ofstream out;
+};
+
+/*
+ * Log messages from nthreads threads as fast as they can, sampling
+ * how long each call to the handler takes.  Throughput is as seen by
+ * the logging threads; the async writer may still be catching up.
+ */
+static void runOnce(OFLogHandler& handler, size_t nthreads,
+                    size_t messages, JsonReport& report,
+                    const std::string& prefix) {
+    std::vector<Samples> latency(nthreads);
+    std::vector<std::thread> threads;
+    std::string file(__FILE__);
+    std::string function("runOnce");
+    steady_clock::time_point start = steady_clock::now();
+    for (size_t t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&, t]() {
+                Samples& s = latency[t];
+                s.reserve(messages);
+                std::string message("policy update for /PolicyUniverse/"
+                                    "PolicySpace/tenant/GbpEpGroup/epg-" +
+                                    std::to_string(t));
+                for (size_t i = 0; i < messages; ++i) {
+                    steady_clock::time_point before = steady_clock::now();
+                    handler.handleMessage(file, __LINE__, function,
+                                          OFLogHandler::INFO, message);
+                    s.add(usSince(before));
+                }
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+    double elapsedMs = msSince(start);
+
+    // report the worst thread, since that is the one that would
+    // hold up whatever it is logging from
+    double p99 = 0, max = 0;
+    for (Samples& s : latency) {
+        p99 = std::max(p99, s.percentile(99));
+        max = std::max(max, s.percentile(100));
+    }
+    report.add(prefix + "msgs_per_sec",
+               nthreads * messages / (elapsedMs / 1000))
+        .add(prefix + "log_us_p99", p99)
+        .add(prefix + "log_us_max", max);
+}
+
+int main(int argc, char** argv) {
+    size_t nthreads = argOr(argc, argv, 1, 4);
+    size_t messages = argOr(argc, argv, 2, 100000);
+    size_t bufferSize = argOr(argc, argv, 3,
+                              AsyncLogHandler::DEFAULT_BUFFER_SIZE);
+
+    JsonReport report("logging");
+    report.add("threads", nthreads)
+        .add("messages_per_thread", messages)
+        .add("buffer_size", bufferSize);
+    {
+        FileLogHandler file;
+        runOnce(file, nthreads, messages, report, "sync_");
+    }
+    {
+        FileLogHandler file;
+        AsyncLogHandler async(file, bufferSize);
+        async.start();
+        runOnce(async, nthreads, messages, report, "async_");
+        async.stop();
+        report.add("async_dropped", async.getDropped());
+    }
+    std::remove(LOG_FILE);
+    report.print();
+    return 0;
+}
@@ -0,0 +1,173 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for reading a tree of managed objects through the
+ * generated-model API, with MO wrappers or with views in a snapshot
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "opflex/modb/MOSnapshot.h"
+#include "opflex/modb/Mutator.h"
+#include "opflex/logging/StdOutLogHandler.h"
+
+#include "FrameworkFixture.h"
+#include "BenchUtil.h"
+
+// This is a hand-coded version of testmodel that exercises the
+// features a generated model would require
+#include "testmodel/class1.h"
+
+using namespace opflex::modb;
+using namespace opflex::ofcore;
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+/*
+ * Walk the tree with MO wrappers, the way the agent resolves policy
+ * today, and return the number of objects visited
+ */
+static size_t walkMO(OFFramework& framework, uint64_t& sum) {
+    size_t visited = 0;
+    boost::optional<OF_SHARED_PTR<testmodel::class1> > root =
+        testmodel::class1::resolve(framework, URI::ROOT);
+    if (!root) return visited;
+    visited += 1;
+    sum += root.get()->getProp1(0);
+
+    std::vector<OF_SHARED_PTR<testmodel::class2> > c2s;
+    root.get()->resolveClass2(c2s);
+    for (const OF_SHARED_PTR<testmodel::class2>& c2 : c2s) {
+        visited += 1;
+        sum += c2->getProp4(0);
+        std::vector<OF_SHARED_PTR<testmodel::class3> > c3s;
+        c2->resolveClass3(c3s);
+        for (const OF_SHARED_PTR<testmodel::class3>& c3 : c3s) {
+            visited += 1;
+            sum += c3->getProp6(0) + c3->getProp7("").size();
+        }
+    }
+    return visited;
+}
+
+/*
+ * Walk the same tree with views in a snapshot that is reused for
+ * every walk
+ */
+static size_t walkView(MOSnapshot& snapshot, uint64_t& sum) {
+    size_t visited = 0;
+    snapshot.clear();
+    boost::optional<testmodel::class1::View> root =
+        testmodel::class1::View::resolve(snapshot, URI::ROOT);
+    if (!root) return visited;
+    visited += 1;
+    sum += root->getProp1(0);
+
+    for (const testmodel::class2::View& c2 : root->resolveClass2()) {
+        visited += 1;
+        sum += c2.getProp4(0);
+        for (const testmodel::class3::View& c3 : c2.resolveClass3()) {
+            visited += 1;
+            sum += c3.getProp6(0) + c3.getProp7("").size();
+        }
+    }
+    return visited;
+}
+
+/*
+ * A root with `objects` class2 children that have `children` class3
+ * children each, walked `rounds` times each way.
+ */
+static void benchWalk(size_t objects, size_t children, size_t rounds) {
+    FrameworkFixture f;
+    {
+        Mutator mutator(f.framework, "owner1");
+        OF_SHARED_PTR<testmodel::class1> root =
+            testmodel::class1::createRootElement(f.framework);
+        root->setProp1(1);
+        for (size_t i = 0; i < objects; ++i)
+            root->addClass2(i);
+        mutator.commit();
+    }
+    {
+        Mutator mutator(f.framework, "owner2");
+        std::vector<OF_SHARED_PTR<testmodel::class2> > c2s;
+        testmodel::class1::resolve(f.framework, URI::ROOT)
+            .get()->resolveClass2(c2s);
+        for (const OF_SHARED_PTR<testmodel::class2>& c2 : c2s)
+            for (size_t j = 0; j < children; ++j)
+                c2->addClass3(j, "child-" + std::to_string(j));
+        mutator.commit();
+    }
+
+    JsonReport report("mo_view");
+    report.add("objects", objects)
+        .add("children", children)
+        .add("rounds", rounds);
+
+    MOSnapshot snapshot(f.framework);
+    // grow the snapshot to the size of a walk before measuring
+    uint64_t sum = 0;
+    walkView(snapshot, sum);
+
+    for (bool views : {false, true}) {
+        Samples walkMs;
+        size_t visited = 0;
+        size_t allocs = 0;
+        for (size_t r = 0; r < rounds; ++r) {
+            size_t before = allocations;
+            steady_clock::time_point start = steady_clock::now();
+            visited = views ? walkView(snapshot, sum)
+                            : walkMO(f.framework, sum);
+            walkMs.add(msSince(start));
+            allocs += allocations - before;
+        }
+        std::string prefix(views ? "view_" : "mo_");
+        report.add(prefix + "walk_ms", walkMs.median())
+            .add(prefix + "objects_per_sec",
+                 visited / (walkMs.median() / 1000))
+            .add(prefix + "allocs_per_object",
+                 (double)allocs / (visited * rounds));
+    }
+    report.add("checksum", sum);
+    report.print();
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 10000);
+    size_t children = argOr(argc, argv, 2, 4);
+    size_t rounds = argOr(argc, argv, 3, 10);
+
+    StdOutLogHandler logHandler(OFLogHandler::ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    benchWalk(objects, children, rounds);
+    return 0;
+}
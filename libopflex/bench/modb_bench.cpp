@@ -0,0 +1,249 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the managed object database: Mutator commit rate,
+ * commit throughput for large objects and StoreClient lookup latency
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "opflex/modb/Mutator.h"
+#include "opflex/modb/URIBuilder.h"
+#include "opflex/modb/internal/ObjectStore.h"
+#include "opflex/logging/StdOutLogHandler.h"
+
+#include "FrameworkFixture.h"
+#include "BenchUtil.h"
+
+// This is a hand-coded version of testmodel that exercises the
+// features a generated model would require
+#include "testmodel/class1.h"
+
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::ofcore;
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+using opflex::util::ThreadManager;
+
+/* fixed seed so that every run looks up the same keys */
+static const unsigned SEED = 42;
+
+static URI class2Uri(int64_t i) {
+    return URIBuilder().addElement("class2").addElement(i).build();
+}
+
+/*
+ * Create objects through the generated-model API, committing every
+ * batch objects, then modify each of them in the same batches.
+ */
+static void benchCommit(size_t objects, size_t batch) {
+    FrameworkFixture f;
+    OF_SHARED_PTR<testmodel::class1> root;
+    {
+        Mutator mutator(f.framework, "owner1");
+        root = testmodel::class1::createRootElement(f.framework);
+        mutator.commit();
+    }
+
+    size_t commits = 0;
+    steady_clock::time_point start = steady_clock::now();
+    for (size_t i = 0; i < objects; i += batch) {
+        Mutator mutator(f.framework, "owner1");
+        for (size_t j = i; j < std::min(objects, i + batch); ++j)
+            root->addClass2(j);
+        mutator.commit();
+        commits += 1;
+    }
+    double createMs = msSince(start);
+
+    std::vector<OF_SHARED_PTR<testmodel::class2> > children;
+    root->resolveClass2(children);
+
+    start = steady_clock::now();
+    for (size_t i = 0; i < children.size(); i += batch) {
+        Mutator mutator(f.framework, "owner1");
+        for (size_t j = i; j < std::min(children.size(), i + batch); ++j)
+            children[j]->setProp4(children[j]->getProp4(0) + 1);
+        mutator.commit();
+    }
+    double modifyMs = msSince(start);
+
+    JsonReport("modb_commit")
+        .add("objects", objects)
+        .add("batch", batch)
+        .add("commits", commits)
+        .add("create_ms", createMs)
+        .add("create_commits_per_sec", commits / (createMs / 1000))
+        .add("create_objects_per_sec", objects / (createMs / 1000))
+        .add("modify_ms", modifyMs)
+        .add("modify_objects_per_sec", children.size() / (modifyMs / 1000))
+        .print();
+}
+
+/*
+ * Create objects with `props` string properties each, then commit
+ * batches that change one property of each object, and batches that
+ * set a property of each object to the value it already has.  The
+ * cost of these commits depends on how much of each object the
+ * mutator copies and compares.
+ */
+static void benchCommitLarge(size_t objects, size_t props, size_t batch) {
+    FrameworkFixture f;
+    std::vector<URI> uris;
+    {
+        Mutator mutator(f.framework, "owner1");
+        mutator.modify(1, URI::ROOT);
+        for (size_t i = 0; i < objects; ++i) {
+            URI u(class2Uri(i));
+            OF_SHARED_PTR<ObjectInstance>& oi =
+                mutator.addChild(1, URI::ROOT, 3, 2, u);
+            oi->setInt64(4, i);
+            for (size_t p = 0; p < props; ++p)
+                oi->setString(100 + p, "value-" + std::to_string(p) +
+                              "-" + std::to_string(i));
+            uris.push_back(u);
+        }
+        mutator.commit();
+    }
+
+    steady_clock::time_point start = steady_clock::now();
+    for (size_t i = 0; i < objects; i += batch) {
+        Mutator mutator(f.framework, "owner1");
+        for (size_t j = i; j < std::min(objects, i + batch); ++j)
+            mutator.modify(2, uris[j])->setInt64(4, j + 1);
+        mutator.commit();
+    }
+    double modifyMs = msSince(start);
+
+    start = steady_clock::now();
+    for (size_t i = 0; i < objects; i += batch) {
+        Mutator mutator(f.framework, "owner1");
+        for (size_t j = i; j < std::min(objects, i + batch); ++j)
+            mutator.modify(2, uris[j])->setInt64(4, j + 1);
+        mutator.commit();
+    }
+    double unchangedMs = msSince(start);
+
+    JsonReport("modb_commit_large")
+        .add("objects", objects)
+        .add("props", props)
+        .add("batch", batch)
+        .add("modify_ms", modifyMs)
+        .add("modify_objects_per_sec", objects / (modifyMs / 1000))
+        .add("unchanged_ms", unchangedMs)
+        .add("unchanged_objects_per_sec", objects / (unchangedMs / 1000))
+        .print();
+}
+
+/*
+ * Time individual StoreClient::get() and getChildren() calls against a
+ * store holding `objects` class2 instances under the root and class4
+ * instances with a handful of class6 children each.
+ */
+static void benchLookup(const ModelMetadata& md, size_t objects,
+                        size_t lookups) {
+    ThreadManager threadManager;
+    ObjectStore db(threadManager);
+    db.init(md);
+    db.start();
+    StoreClient& client = db.getStoreClient("owner1");
+    StoreClient& client2 = db.getStoreClient("owner2");
+
+    client.put(1, URI::ROOT, OF_MAKE_SHARED<ObjectInstance>(1));
+    std::vector<URI> c2uris;
+    std::vector<URI> c4uris;
+    for (size_t i = 0; i < objects; ++i) {
+        URI c2u(class2Uri(i));
+        OF_SHARED_PTR<ObjectInstance> oi2 = OF_MAKE_SHARED<ObjectInstance>(2);
+        oi2->setInt64(4, i);
+        client.put(2, c2u, oi2);
+        client.addChild(1, URI::ROOT, 3, 2, c2u);
+        c2uris.push_back(c2u);
+
+        URI c4u(URIBuilder().addElement("class4")
+                .addElement("policy-" + std::to_string(i)).build());
+        OF_SHARED_PTR<ObjectInstance> oi4 = OF_MAKE_SHARED<ObjectInstance>(4);
+        oi4->setString(9, "value-" + std::to_string(i));
+        client2.put(4, c4u, oi4);
+        for (size_t j = 0; j < 4; ++j) {
+            URI c6u(URIBuilder(c4u).addElement("class6")
+                    .addElement(std::to_string(j)).build());
+            OF_SHARED_PTR<ObjectInstance> oi6 =
+                OF_MAKE_SHARED<ObjectInstance>(6);
+            oi6->setString(13, "child");
+            client2.put(6, c6u, oi6);
+            client2.addChild(4, c4u, 12, 6, c6u);
+        }
+        c4uris.push_back(c4u);
+    }
+
+    std::mt19937 rng(SEED);
+    std::uniform_int_distribution<size_t> pick(0, objects - 1);
+    Samples get, children, fanout;
+    get.reserve(lookups);
+    children.reserve(lookups);
+
+    for (size_t i = 0; i < lookups; ++i) {
+        const URI& u = c2uris[pick(rng)];
+        steady_clock::time_point start = steady_clock::now();
+        OF_SHARED_PTR<const ObjectInstance> oi = client.get(2, u);
+        get.add(usSince(start));
+    }
+
+    std::vector<URI> out;
+    for (size_t i = 0; i < lookups; ++i) {
+        const URI& u = c4uris[pick(rng)];
+        out.clear();
+        steady_clock::time_point start = steady_clock::now();
+        client2.getChildren(4, u, 12, 6, out);
+        children.add(usSince(start));
+    }
+
+    /* the root fans out to every class2, so this is linear in objects */
+    for (size_t i = 0; i < 100; ++i) {
+        out.clear();
+        steady_clock::time_point start = steady_clock::now();
+        client.getChildren(1, URI::ROOT, 3, 2, out);
+        fanout.add(usSince(start));
+    }
+
+    JsonReport("modb_lookup")
+        .add("objects", objects)
+        .add("lookups", lookups)
+        .addLatency("get_us", get)
+        .addLatency("get_children_us", children)
+        .addLatency("get_children_root_us", fanout)
+        .print();
+
+    db.stop();
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 10000);
+    size_t lookups = argOr(argc, argv, 2, 100000);
+
+    StdOutLogHandler logHandler(OFLogHandler::ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    benchCommit(objects, 1);
+    benchCommit(objects, 100);
+    benchCommitLarge(objects, 50, 100);
+
+    MDFixture mdf;
+    benchLookup(mdf.md, objects, lookups);
+    return 0;
+}
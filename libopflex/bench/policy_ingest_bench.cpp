@@ -0,0 +1,273 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for how a large policy download holds up a connection
+ * loop, writing it to the store inline or through the MO writer
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <uv.h>
+
+#include "opflex/engine/internal/MOSerializer.h"
+#include "opflex/engine/internal/MOWriter.h"
+#include "opflex/logging/StdOutLogHandler.h"
+#include "opflex/modb/URIBuilder.h"
+
+#include "BaseFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine::internal;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+using namespace rapidjson;
+
+using opflex::util::ThreadManager;
+
+typedef std::vector<std::pair<class_id_t, URI> > objects_t;
+
+/*
+ * `objects` class4 policies with `children` class6 children each
+ */
+static objects_t populate(StoreClient& client, size_t objects,
+                          size_t children) {
+    objects_t uris;
+    client.put(1, URI::ROOT, OF_MAKE_SHARED<ObjectInstance>(1));
+    for (size_t i = 0; i < objects; ++i) {
+        URI c4u(URIBuilder().addElement("class4")
+                .addElement("policy-" + std::to_string(i)).build());
+        OF_SHARED_PTR<ObjectInstance> oi4 = OF_MAKE_SHARED<ObjectInstance>(4);
+        oi4->setString(9, "value-" + std::to_string(i));
+        client.put(4, c4u, oi4);
+        client.addChild(1, URI::ROOT, 8, 4, c4u);
+        uris.push_back(std::make_pair(4, c4u));
+        for (size_t j = 0; j < children; ++j) {
+            URI c6u(URIBuilder(c4u).addElement("class6")
+                    .addElement(std::to_string(j)).build());
+            OF_SHARED_PTR<ObjectInstance> oi6 =
+                OF_MAKE_SHARED<ObjectInstance>(6);
+            oi6->setString(13, "child-" + std::to_string(j));
+            client.put(6, c6u, oi6);
+            client.addChild(4, c4u, 12, 6, c6u);
+            uris.push_back(std::make_pair(6, c6u));
+        }
+    }
+    return uris;
+}
+
+/*
+ * Stands in for a connection loop: each turn of the loop handles one
+ * policy update message of `batch` objects out of the document, as if
+ * it had just been read from the socket.  Probes sent from another
+ * thread measure how long the loop takes to get to other work, such
+ * as an echo request.
+ */
+struct Ingest {
+    Ingest(MOSerializer& serializer_, StoreClient& client_,
+           MOWriter* writer_, const Value& mos_, size_t batch_,
+           Samples& probeUs_)
+        : serializer(serializer_), client(client_), writer(writer_),
+          mos(mos_), batch(batch_), next(0), paused(false),
+          probeDone(true), probeUs(probeUs_) {}
+
+    MOSerializer& serializer;
+    StoreClient& client;
+    MOWriter* writer;
+    const Value& mos;
+    size_t batch;
+    size_t next;
+    bool paused;
+
+    uv_async_t feed_async;
+    uv_async_t resume_async;
+    uv_async_t probe_async;
+    uv_async_t cleanup_async;
+
+    steady_clock::time_point probeSent;
+    std::atomic<bool> probeDone;
+    Samples& probeUs;
+
+    void feed() {
+        if (paused || next >= mos.Size()) return;
+        size_t end = std::min<size_t>(next + batch, mos.Size());
+        if (writer) {
+            std::vector<MOWriter::Op> ops;
+            for (; next < end; ++next) {
+                ops.push_back(MOWriter::Op());
+                if (!serializer.decode(mos[next], true, ops.back().mo))
+                    ops.pop_back();
+            }
+            // stop reading until the writer catches up
+            paused = writer->queueUpdates(ops);
+        } else {
+            StoreClient::notif_t notifs;
+            for (; next < end; ++next)
+                serializer.deserialize(mos[next], client, true, &notifs);
+            client.deliverNotifications(notifs);
+        }
+        uv_async_send(&feed_async);
+    }
+
+    static void on_feed(uv_async_t* handle) {
+        ((Ingest*)handle->data)->feed();
+    }
+
+    static void on_resume(uv_async_t* handle) {
+        Ingest* ingest = (Ingest*)handle->data;
+        ingest->paused = false;
+        ingest->feed();
+    }
+
+    static void on_probe(uv_async_t* handle) {
+        Ingest* ingest = (Ingest*)handle->data;
+        ingest->probeUs.add(usSince(ingest->probeSent));
+        ingest->probeDone = true;
+    }
+
+    static void on_cleanup(uv_async_t* handle) {
+        Ingest* ingest = (Ingest*)handle->data;
+        uv_close((uv_handle_t*)&ingest->feed_async, NULL);
+        uv_close((uv_handle_t*)&ingest->resume_async, NULL);
+        uv_close((uv_handle_t*)&ingest->probe_async, NULL);
+        uv_close((uv_handle_t*)handle, NULL);
+    }
+};
+
+/*
+ * Download the document into an empty store.
+ *
+ * @return the time until every object is in the store in
+ * milliseconds, or a negative value if that did not happen
+ */
+static double runOnce(const Value& mos, const objects_t& uris,
+                      size_t batch, bool useWriter, Samples& probeUs) {
+    BaseFixture target;
+    StoreClient& client = target.db.getStoreClient("_SYSTEM_");
+    MOSerializer serializer(&target.db);
+    ThreadManager threadManager;
+    MOWriter writer(serializer, threadManager);
+    Ingest ingest(serializer, client, useWriter ? &writer : NULL, mos,
+                  batch, probeUs);
+
+    uv_loop_t* loop = threadManager.initTask("connection");
+    ingest.feed_async.data = &ingest;
+    ingest.resume_async.data = &ingest;
+    ingest.probe_async.data = &ingest;
+    ingest.cleanup_async.data = &ingest;
+    uv_async_init(loop, &ingest.feed_async, Ingest::on_feed);
+    uv_async_init(loop, &ingest.resume_async, Ingest::on_resume);
+    uv_async_init(loop, &ingest.probe_async, Ingest::on_probe);
+    uv_async_init(loop, &ingest.cleanup_async, Ingest::on_cleanup);
+    if (useWriter) {
+        writer.setResumeHandler([&ingest]() {
+                uv_async_send(&ingest.resume_async);
+            });
+        writer.start(&client);
+    }
+    threadManager.startTask("connection");
+
+    steady_clock::time_point start = steady_clock::now();
+    uv_async_send(&ingest.feed_async);
+    bool ok = false;
+    size_t checked = 0;
+    steady_clock::time_point deadline =
+        start + std::chrono::seconds(60);
+    while (steady_clock::now() < deadline) {
+        if (ingest.probeDone) {
+            // objects stay once they are written, so pick up where
+            // the last check stopped
+            while (checked < uris.size() &&
+                   client.isPresent(uris[checked].first,
+                                    uris[checked].second))
+                checked += 1;
+            if (checked == uris.size()) {
+                ok = true;
+                break;
+            }
+            // a probe every millisecond once the last one is answered
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ingest.probeDone = false;
+            ingest.probeSent = steady_clock::now();
+            uv_async_send(&ingest.probe_async);
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+    double ms = msSince(start);
+
+    waitFor([&]() { return (bool)ingest.probeDone; }, 1000);
+    writer.stop();
+    uv_async_send(&ingest.cleanup_async);
+    threadManager.stopTask("connection");
+
+    return ok ? ms : -1;
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 10000);
+    size_t children = argOr(argc, argv, 2, 4);
+    size_t batch = argOr(argc, argv, 3, 1000);
+    size_t rounds = argOr(argc, argv, 4, 3);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    BaseFixture f;
+    StoreClient& sysClient = f.db.getStoreClient("_SYSTEM_");
+    objects_t uris = populate(sysClient, objects, children);
+    MOSerializer serializer(&f.db);
+
+    StringBuffer buffer;
+    {
+        Writer<StringBuffer> writer(buffer);
+        writer.StartArray();
+        serializer.serialize(1, URI::ROOT, sysClient, writer);
+        writer.EndArray();
+    }
+    Document d;
+    d.Parse(buffer.GetString());
+
+    JsonReport report("policy_ingest");
+    report.add("objects", d.Size())
+        .add("batch", batch)
+        .add("rounds", rounds);
+    for (bool useWriter : {false, true}) {
+        Samples ingestMs, probeUs;
+        for (size_t r = 0; r < rounds; ++r) {
+            double ms = runOnce(d, uris, batch, useWriter, probeUs);
+            if (ms < 0) {
+                std::cerr << "policy download did not complete"
+                          << std::endl;
+                return 1;
+            }
+            ingestMs.add(ms);
+        }
+        std::string prefix(useWriter ? "writer_" : "inline_");
+        report.add(prefix + "ingest_ms", ingestMs.median())
+            .add(prefix + "objects_per_sec",
+                 d.Size() / (ingestMs.median() / 1000))
+            .add(prefix + "probes", probeUs.size())
+            .addLatency(prefix + "probe_us", probeUs);
+    }
+    report.print();
+    return 0;
+}
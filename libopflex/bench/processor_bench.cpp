@@ -0,0 +1,186 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for Processor policy resolution against a local server
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/assign/list_of.hpp>
+
+#include "opflex/modb/internal/ObjectStore.h"
+#include "opflex/engine/Processor.h"
+#include "opflex/engine/internal/GbpOpflexServerImpl.h"
+#include "opflex/logging/StdOutLogHandler.h"
+
+#include "MDFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine;
+using namespace opflex::engine::internal;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+using opflex::ofcore::OFConstants;
+using opflex::util::ThreadManager;
+
+#define SERVER_ROLES \
+        (OFConstants::POLICY_REPOSITORY |     \
+         OFConstants::ENDPOINT_REGISTRY |     \
+         OFConstants::OBSERVER)
+#define LOCALHOST "127.0.0.1"
+
+static const uint16_t SERVER_PORT = 8022;
+
+/*
+ * Have a local relationship object reference `objects` policies on the
+ * server and time how long it takes for all of them to be resolved.
+ *
+ * @return the time to resolve everything in milliseconds, or a
+ * negative value if the download did not complete
+ */
+static double runOnce(const ModelMetadata& md, bool ssl,
+                      size_t objects, size_t children, double& connectMs) {
+    GbpOpflexServerImpl server(SERVER_PORT, SERVER_ROLES,
+                               boost::assign::list_of
+                               (std::make_pair(SERVER_ROLES,
+                                               LOCALHOST":8022")),
+                               std::vector<std::string>(), md, 60);
+    if (ssl)
+        server.enableSSL(SRCDIR"/comms/test/ca.pem",
+                         SRCDIR"/comms/test/server.pem",
+                         "password123", true);
+    server.start();
+    if (!waitFor([&]() { return server.getListener().isListening(); },
+                 5000)) {
+        server.stop();
+        return -1;
+    }
+
+    StoreClient* rclient = server.getSystemClient();
+    std::vector<URI> uris;
+    rclient->put(1, URI::ROOT, std::make_shared<ObjectInstance>(1));
+    for (size_t i = 0; i < objects; ++i) {
+        URI c4u("/class4/" + std::to_string(i) + "/");
+        auto oi4 = std::make_shared<ObjectInstance>(4);
+        oi4->setString(9, "value-" + std::to_string(i));
+        rclient->put(4, c4u, oi4);
+        rclient->addChild(1, URI::ROOT, 8, 4, c4u);
+        for (size_t j = 0; j < children; ++j) {
+            URI c6u(c4u.toString() + "class6/" + std::to_string(j) + "/");
+            auto oi6 = std::make_shared<ObjectInstance>(6);
+            oi6->setString(13, "child-" + std::to_string(j));
+            rclient->put(6, c6u, oi6);
+            rclient->addChild(4, c4u, 12, 6, c6u);
+        }
+        uris.push_back(c4u);
+    }
+
+    ThreadManager dbThreadManager;
+    ObjectStore db(dbThreadManager);
+    db.init(md);
+    db.start();
+    StoreClient* client = &db.getStoreClient("owner2");
+
+    double resolveMs = -1;
+    {
+        ThreadManager threadManager;
+        Processor processor(&db, threadManager);
+        processor.setProcDelay(5);
+        processor.setRetryDelay(100);
+        processor.setOpflexIdentity("bench", "testdomain");
+        if (ssl)
+            processor.enableSSL(SRCDIR"/comms/test/ca.pem",
+                                SRCDIR"/comms/test/server.pem",
+                                "password123", true);
+        processor.start();
+
+        steady_clock::time_point start = steady_clock::now();
+        processor.addPeer(LOCALHOST, SERVER_PORT);
+        bool ok = waitFor([&]() {
+                OpflexConnection* conn =
+                    processor.getPool().getPeer(LOCALHOST, SERVER_PORT);
+                return conn != NULL && conn->isReady();
+            }, 5000);
+        connectMs = msSince(start);
+
+        if (ok) {
+            start = steady_clock::now();
+            URI c5u("/class5/bench/");
+            auto oi5 = std::make_shared<ObjectInstance>(5);
+            for (const URI& u : uris)
+                oi5->addReference(11, 4, u);
+            StoreClient::notif_t notifs;
+            client->put(5, c5u, oi5);
+            client->queueNotification(5, c5u, notifs);
+            client->deliverNotifications(notifs);
+            ok = waitFor([&]() {
+                    for (const URI& u : uris)
+                        if (!client->isPresent(4, u))
+                            return false;
+                    return true;
+                }, 60000);
+            if (ok)
+                resolveMs = msSince(start);
+        }
+
+        processor.stop();
+        threadManager.stop();
+    }
+    db.stop();
+    server.stop();
+    return resolveMs;
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 2000);
+    size_t children = argOr(argc, argv, 2, 4);
+    size_t rounds = argOr(argc, argv, 3, 3);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    MDFixture mdf;
+    JsonReport report("processor");
+    report.add("objects", objects)
+        .add("children", children)
+        .add("rounds", rounds);
+    for (bool ssl : {false, true}) {
+        Samples connect, resolve;
+        for (size_t r = 0; r < rounds; ++r) {
+            double connectMs = 0;
+            double resolveMs = runOnce(mdf.md, ssl, objects, children,
+                                       connectMs);
+            if (resolveMs < 0) {
+                std::cerr << "policy resolution did not complete"
+                          << std::endl;
+                return 1;
+            }
+            connect.add(connectMs);
+            resolve.add(resolveMs);
+        }
+        std::string prefix(ssl ? "ssl_" : "plain_");
+        double policies = objects * (1 + children);
+        report.add(prefix + "connect_ms", connect.median())
+            .add(prefix + "resolve_ms", resolve.median())
+            .add(prefix + "objects_per_sec",
+                 policies / (resolve.median() / 1000));
+    }
+    report.print();
+    return 0;
+}
@@ -0,0 +1,249 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for policy resolution against two redundant local
+ * servers, sending resolves to every server or to a primary only
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "opflex/modb/internal/ObjectStore.h"
+#include "opflex/engine/Processor.h"
+#include "opflex/engine/internal/GbpOpflexServerImpl.h"
+#include "opflex/logging/StdOutLogHandler.h"
+
+#include "MDFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine;
+using namespace opflex::engine::internal;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+using opflex::ofcore::OFConstants;
+using opflex::test::GbpOpflexServer;
+using opflex::util::ThreadManager;
+
+#define SERVER_ROLES \
+        (OFConstants::POLICY_REPOSITORY |     \
+         OFConstants::ENDPOINT_REGISTRY |     \
+         OFConstants::OBSERVER)
+#define LOCALHOST "127.0.0.1"
+
+static const uint16_t SERVER_PORTS[] = { 8022, 8023 };
+
+struct Result {
+    Result() : resolveMs(-1), failoverMs(-1), resolves(0), responses(0) {}
+
+    double resolveMs;
+    double failoverMs;
+    uint64_t resolves;
+    uint64_t responses;
+};
+
+/*
+ * Sum the policy resolve counters over all connections, and return
+ * the responses from the given peer
+ */
+static uint64_t countResolves(OpflexPool& pool, Result& result,
+                              const std::string& peer) {
+    std::unordered_map<std::string, std::shared_ptr<OFStats> > stats;
+    pool.getOpflexPeerStats(stats);
+    result.resolves = 0;
+    result.responses = 0;
+    uint64_t peerResponses = 0;
+    for (auto& s : stats) {
+        result.resolves += s.second->getPolResolves();
+        result.responses += s.second->getPolResolveResps();
+        if (s.first == peer)
+            peerResponses = s.second->getPolResolveResps();
+    }
+    return peerResponses;
+}
+
+/*
+ * Have a local relationship object reference `objects` policies that
+ * both servers hold, and time how long it takes for all of them to be
+ * resolved.  Then stop the primary server, and time how long it
+ * takes for the other server to answer a resolve for every policy.
+ */
+static Result runOnce(const ModelMetadata& md, bool primaryRouting,
+                      size_t objects, size_t children) {
+    GbpOpflexServer::peer_vec_t peers;
+    for (uint16_t port : SERVER_PORTS)
+        peers.push_back(std::make_pair(SERVER_ROLES, std::string(LOCALHOST":")
+                                       + std::to_string(port)));
+    std::vector<std::unique_ptr<GbpOpflexServerImpl> > servers;
+    for (uint16_t port : SERVER_PORTS) {
+        servers.emplace_back(new GbpOpflexServerImpl(port, SERVER_ROLES,
+                                                     peers,
+                                                     std::vector<std::string>(),
+                                                     md, 60));
+    }
+
+    std::vector<URI> uris;
+    for (size_t i = 0; i < objects; ++i)
+        uris.push_back(URI("/class4/" + std::to_string(i) + "/"));
+    for (auto& server : servers) {
+        StoreClient* rclient = server->getSystemClient();
+        rclient->put(1, URI::ROOT, std::make_shared<ObjectInstance>(1));
+        for (size_t i = 0; i < objects; ++i) {
+            auto oi4 = std::make_shared<ObjectInstance>(4);
+            oi4->setString(9, "value-" + std::to_string(i));
+            rclient->put(4, uris[i], oi4);
+            rclient->addChild(1, URI::ROOT, 8, 4, uris[i]);
+            for (size_t j = 0; j < children; ++j) {
+                URI c6u(uris[i].toString() + "class6/" +
+                        std::to_string(j) + "/");
+                auto oi6 = std::make_shared<ObjectInstance>(6);
+                oi6->setString(13, "child-" + std::to_string(j));
+                rclient->put(6, c6u, oi6);
+                rclient->addChild(4, uris[i], 12, 6, c6u);
+            }
+        }
+        server->start();
+    }
+
+    Result result;
+    if (!waitFor([&]() {
+                for (auto& server : servers)
+                    if (!server->getListener().isListening())
+                        return false;
+                return true;
+            }, 5000)) {
+        for (auto& server : servers)
+            server->stop();
+        return result;
+    }
+
+    ThreadManager dbThreadManager;
+    ObjectStore db(dbThreadManager);
+    db.init(md);
+    db.start();
+    StoreClient* client = &db.getStoreClient("owner2");
+    {
+        ThreadManager threadManager;
+        Processor processor(&db, threadManager);
+        processor.setProcDelay(5);
+        processor.setRetryDelay(100);
+        processor.setOpflexIdentity("bench", "testdomain");
+        processor.setPrimaryRouting(primaryRouting);
+        processor.start();
+
+        OpflexPool& pool = processor.getPool();
+        for (uint16_t port : SERVER_PORTS)
+            processor.addPeer(LOCALHOST, port);
+        bool ok = waitFor([&]() {
+                for (uint16_t port : SERVER_PORTS) {
+                    OpflexConnection* conn = pool.getPeer(LOCALHOST, port);
+                    if (conn == NULL || !conn->isReady())
+                        return false;
+                }
+                return true;
+            }, 5000);
+
+        if (ok) {
+            steady_clock::time_point start = steady_clock::now();
+            URI c5u("/class5/bench/");
+            auto oi5 = std::make_shared<ObjectInstance>(5);
+            for (const URI& u : uris)
+                oi5->addReference(11, 4, u);
+            StoreClient::notif_t notifs;
+            client->put(5, c5u, oi5);
+            client->queueNotification(5, c5u, notifs);
+            client->deliverNotifications(notifs);
+            ok = waitFor([&]() {
+                    for (const URI& u : uris)
+                        if (!client->isPresent(4, u))
+                            return false;
+                    return true;
+                }, 60000);
+            if (ok)
+                result.resolveMs = msSince(start);
+        }
+
+        if (ok) {
+            // without primary routing stop either one, since both
+            // servers already have every resolve
+            OpflexClientConnection* primary =
+                pool.getMasterForRole(OFConstants::POLICY_REPOSITORY);
+            size_t failed = (primary != NULL &&
+                             primary->getPort() == SERVER_PORTS[1]) ? 1 : 0;
+            std::string backup(std::string(LOCALHOST":") +
+                               std::to_string(SERVER_PORTS[1 - failed]));
+            uint64_t backupResponses = countResolves(pool, result, backup);
+
+            steady_clock::time_point start = steady_clock::now();
+            servers[failed]->stop();
+            Result after;
+            if (waitFor([&]() {
+                        return countResolves(pool, after, backup) >=
+                            std::max<uint64_t>(backupResponses, objects);
+                    }, 60000))
+                result.failoverMs = msSince(start);
+        }
+
+        processor.stop();
+        threadManager.stop();
+    }
+    db.stop();
+    for (auto& server : servers)
+        server->stop();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 2000);
+    size_t children = argOr(argc, argv, 2, 4);
+    size_t rounds = argOr(argc, argv, 3, 3);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    MDFixture mdf;
+    JsonReport report("resolve_routing");
+    report.add("objects", objects)
+        .add("children", children)
+        .add("servers", sizeof(SERVER_PORTS) / sizeof(SERVER_PORTS[0]))
+        .add("rounds", rounds);
+    for (bool primaryRouting : {false, true}) {
+        Samples resolve, failover, resolves, responses;
+        for (size_t r = 0; r < rounds; ++r) {
+            Result result = runOnce(mdf.md, primaryRouting,
+                                    objects, children);
+            if (result.resolveMs < 0 || result.failoverMs < 0) {
+                std::cerr << "policy resolution did not complete"
+                          << std::endl;
+                return 1;
+            }
+            resolve.add(result.resolveMs);
+            failover.add(result.failoverMs);
+            resolves.add(result.resolves);
+            responses.add(result.responses);
+        }
+        std::string prefix(primaryRouting ? "primary_" : "all_");
+        report.add(prefix + "resolve_ms", resolve.median())
+            .add(prefix + "failover_ms", failover.median())
+            .add(prefix + "resolves_sent", resolves.median())
+            .add(prefix + "resolve_responses", responses.median());
+    }
+    report.print();
+    return 0;
+}
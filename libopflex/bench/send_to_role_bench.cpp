@@ -0,0 +1,172 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for the cost of sending one endpoint declare to several
+ * registry peers, serializing it for each peer or once for all
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "opflex/engine/Processor.h"
+#include "opflex/engine/internal/ProcessorMessage.h"
+#include "opflex/logging/StdOutLogHandler.h"
+#include "opflex/modb/URIBuilder.h"
+
+#include "MDFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine;
+using namespace opflex::engine::internal;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+
+using opflex::util::ThreadManager;
+
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+/*
+ * Write a request frame the way OutboundRequest does, into the
+ * buffer that stands in for the socket of one peer
+ */
+static void writeFrame(OpflexMessage& message, uint64_t xid,
+                       yajr::internal::StringQueue& buf) {
+    yajr::rpc::SendHandler writer(buf);
+    writer.StartObject();
+    writer.String("id");
+    writer.StartArray();
+    writer.String(message.getMethod().c_str());
+    writer.Uint64(xid);
+    writer.EndArray();
+    writer.String("method");
+    writer.String(message.getMethod().c_str());
+    writer.String("params");
+    message.serializePayload(writer);
+    writer.EndObject();
+}
+
+/*
+ * Send one declare to each peer as sendToRole does, and write the
+ * frame for each peer as its connection would
+ */
+static void send(OpflexMessage* declare, bool shared,
+                 std::vector<yajr::internal::StringQueue>& peers) {
+    std::unique_ptr<OpflexMessage> message(declare);
+    if (shared && peers.size() > 1)
+        message.reset(new SerializedOpflexMessage(*declare));
+    for (size_t i = 0; i < peers.size(); ++i) {
+        std::unique_ptr<OpflexMessage> copy(message->clone());
+        writeFrame(*copy, i + 1, peers[i]);
+        peers[i].Clear();
+    }
+}
+
+/*
+ * CPU time of this process in microseconds
+ */
+static double cpuUs() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char** argv) {
+    size_t declares = argOr(argc, argv, 1, 2000);
+    size_t endpoints = argOr(argc, argv, 2, 10);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    MDFixture mdf;
+    ThreadManager dbThreadManager;
+    ObjectStore db(dbThreadManager);
+    db.init(mdf.md);
+    db.start();
+
+    JsonReport report("send_to_role");
+    report.add("declares", declares)
+        .add("endpoints", endpoints);
+    {
+        ThreadManager threadManager;
+        Processor processor(&db, threadManager);
+        processor.setOpflexIdentity("bench", "testdomain");
+        processor.start();
+
+        /* endpoints with a few properties and children each */
+        StoreClient* client = processor.getSystemClient();
+        std::vector<reference_t> refs;
+        for (size_t i = 0; i < endpoints; ++i) {
+            URI c4u(URIBuilder().addElement("class4")
+                    .addElement("ep-" + std::to_string(i)).build());
+            OF_SHARED_PTR<ObjectInstance> oi4 =
+                OF_MAKE_SHARED<ObjectInstance>(4);
+            oi4->setString(9, "endpoint-" + std::to_string(i));
+            client->put(4, c4u, oi4);
+            for (size_t j = 0; j < 4; ++j) {
+                URI c6u(URIBuilder(c4u).addElement("class6")
+                        .addElement(std::to_string(j)).build());
+                OF_SHARED_PTR<ObjectInstance> oi6 =
+                    OF_MAKE_SHARED<ObjectInstance>(6);
+                oi6->setString(13, "ip-" + std::to_string(j));
+                client->put(6, c6u, oi6);
+                client->addChild(4, c4u, 12, 6, c6u);
+            }
+            refs.push_back(std::make_pair(4, c4u));
+        }
+
+        for (size_t npeers = 2; npeers <= 4; ++npeers) {
+            std::vector<yajr::internal::StringQueue> peers(npeers);
+            for (bool shared : {false, true}) {
+                size_t allocs = allocations;
+                double cpu = cpuUs();
+                for (size_t d = 0; d < declares; ++d) {
+                    send(new EndpointDeclareReq(&processor, d + 1, refs),
+                         shared, peers);
+                }
+                cpu = cpuUs() - cpu;
+                allocs = allocations - allocs;
+
+                std::string prefix((shared ? "shared_" : "per_peer_") +
+                                   std::to_string(npeers) + "_peers_");
+                report.add(prefix + "cpu_us_per_declare", cpu / declares)
+                    .add(prefix + "allocs_per_declare",
+                         (double)allocs / declares);
+            }
+        }
+
+        processor.stop();
+        threadManager.stop();
+    }
+    db.stop();
+
+    report.print();
+    return 0;
+}
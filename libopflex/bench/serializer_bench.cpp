@@ -0,0 +1,142 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Benchmark for MOSerializer throughput
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "opflex/engine/internal/MOSerializer.h"
+#include "opflex/logging/StdOutLogHandler.h"
+#include "opflex/modb/URIBuilder.h"
+
+#include "BaseFixture.h"
+#include "BenchUtil.h"
+
+using namespace opflex::engine::internal;
+using namespace opflex::modb;
+using namespace opflex::modb::mointernal;
+using namespace opflex::logging;
+using namespace opflex::bench;
+using namespace rapidjson;
+
+/*
+ * A policy tree shaped like what a policy repository sends: `objects`
+ * class4 policies, each with `children` class6 children, and a class5
+ * relationship referencing all of them.
+ */
+static size_t populate(StoreClient& client, size_t objects,
+                       size_t children) {
+    size_t count = 2;
+    client.put(1, URI::ROOT, OF_MAKE_SHARED<ObjectInstance>(1));
+    URI c5u(URIBuilder().addElement("class5").addElement("bench").build());
+    OF_SHARED_PTR<ObjectInstance> oi5 = OF_MAKE_SHARED<ObjectInstance>(5);
+    oi5->setString(10, "bench");
+    for (size_t i = 0; i < objects; ++i) {
+        URI c4u(URIBuilder().addElement("class4")
+                .addElement("policy-with-a-reasonably-long-name-" +
+                            std::to_string(i)).build());
+        OF_SHARED_PTR<ObjectInstance> oi4 = OF_MAKE_SHARED<ObjectInstance>(4);
+        oi4->setString(9, "value-" + std::to_string(i));
+        client.put(4, c4u, oi4);
+        client.addChild(1, URI::ROOT, 8, 4, c4u);
+        oi5->addReference(11, 4, c4u);
+        count += 1;
+        for (size_t j = 0; j < children; ++j) {
+            URI c6u(URIBuilder(c4u).addElement("class6")
+                    .addElement(std::to_string(j)).build());
+            OF_SHARED_PTR<ObjectInstance> oi6 =
+                OF_MAKE_SHARED<ObjectInstance>(6);
+            oi6->setString(13, "child-" + std::to_string(j));
+            client.put(6, c6u, oi6);
+            client.addChild(4, c4u, 12, 6, c6u);
+            count += 1;
+        }
+    }
+    client.put(5, c5u, oi5);
+    client.addChild(1, URI::ROOT, 24, 5, c5u);
+    return count;
+}
+
+int main(int argc, char** argv) {
+    size_t objects = argOr(argc, argv, 1, 5000);
+    size_t children = argOr(argc, argv, 2, 4);
+    size_t rounds = argOr(argc, argv, 3, 10);
+
+    StdOutLogHandler logHandler(ERROR);
+    OFLogHandler::registerHandler(logHandler);
+
+    BaseFixture f;
+    StoreClient& sysClient = f.db.getStoreClient("_SYSTEM_");
+    size_t count = populate(sysClient, objects, children);
+    MOSerializer serializer(&f.db);
+
+    /* warm up, and keep the output for the deserialization rounds */
+    StringBuffer buffer;
+    {
+        Writer<StringBuffer> writer(buffer);
+        writer.StartArray();
+        serializer.serialize(1, URI::ROOT, sysClient, writer);
+        writer.EndArray();
+    }
+    size_t bytes = buffer.GetSize();
+
+    Samples serMs;
+    for (size_t r = 0; r < rounds; ++r) {
+        StringBuffer out;
+        Writer<StringBuffer> writer(out);
+        steady_clock::time_point start = steady_clock::now();
+        writer.StartArray();
+        serializer.serialize(1, URI::ROOT, sysClient, writer);
+        writer.EndArray();
+        serMs.add(msSince(start));
+    }
+
+    Samples parseMs, deserMs;
+    for (size_t r = 0; r < rounds; ++r) {
+        steady_clock::time_point start = steady_clock::now();
+        Document d;
+        d.Parse(buffer.GetString());
+        parseMs.add(msSince(start));
+
+        /* start each round from an empty store so every object is new */
+        BaseFixture target;
+        StoreClient& targetClient = target.db.getStoreClient("_SYSTEM_");
+        MOSerializer targetSerializer(&target.db);
+        StoreClient::notif_t notifs;
+        start = steady_clock::now();
+        for (Value::ConstValueIterator it = d.Begin(); it != d.End(); ++it)
+            targetSerializer.deserialize(*it, targetClient, true, &notifs);
+        deserMs.add(msSince(start));
+    }
+
+    double mb = bytes / (1024.0 * 1024.0);
+    JsonReport("serializer")
+        .add("objects", count)
+        .add("bytes", bytes)
+        .add("rounds", rounds)
+        .add("serialize_ms", serMs.median())
+        .add("serialize_mb_per_sec", mb / (serMs.median() / 1000))
+        .add("parse_ms", parseMs.median())
+        .add("parse_mb_per_sec", mb / (parseMs.median() / 1000))
+        .add("deserialize_ms", deserMs.median())
+        .add("deserialize_mb_per_sec", mb / (deserMs.median() / 1000))
+        .add("deserialize_objects_per_sec",
+             count / (deserMs.median() / 1000))
+        .print();
+    return 0;
+}
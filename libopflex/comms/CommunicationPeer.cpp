@@ -14,6 +14,7 @@
 #include <yajr/rpc/gen/echo.hpp>
 #include <yajr/rpc/internal/json_stream_wrappers.hpp>
 #include <yajr/rpc/methods.hpp>
+#include <yajr/transport/FrameCompressor.hpp>
 #include <opflex/yajr/internal/comms.hpp>
 
 #include <opflex/logging/internal/logging.hpp>
@@ -80,6 +81,8 @@ namespace yajr {
     namespace comms {
         namespace internal {
 
+CommunicationPeer::~CommunicationPeer() {}
+
 void CommunicationPeer::startKeepAlive(
         uint64_t begin,
         uint64_t repeat,
@@ -173,6 +176,12 @@ void CommunicationPeer::onDisconnect() {
 
         resetSsIn();
 
+        /* compression is negotiated again on the next connection */
+        compressor_.reset();
+
+        /* the next connection starts reading as usual */
+        readPaused_ = 0;
+
         if (getKeepAliveInterval()) {
             stopKeepAlive();
         }
@@ -329,6 +338,15 @@ void CommunicationPeer::readBufferZ(char const * buffer, size_t nread) {
     ;
 
     while ((--nread > 0) && connected_) {
+        if ((compressor_ || static_cast<unsigned char>(*buffer) ==
+                 transport::FrameCompressor::kFrameMarker) &&
+            getCompressor()->isCompressed(buffer, ssIn_.tellp() == 0)) {
+            chunk_size = readCompressedChunk(buffer, nread);
+            nread -= chunk_size - 1;
+            buffer += chunk_size;
+            continue;
+        }
+
         chunk_size = readChunk(buffer);
         nread -= chunk_size++;
 
@@ -353,6 +371,90 @@ void CommunicationPeer::readBufferZ(char const * buffer, size_t nread) {
     }
 }
 
+size_t CommunicationPeer::readCompressedChunk(
+        char const * buffer,
+        size_t n) {
+
+    ssize_t consumed = compressor_->feed(buffer, n);
+
+    VLOG(6) << "consumed " << consumed << " compressed bytes of " << n;
+
+    if (consumed >= 0 && !compressor_->frameReady()) {
+        /* wait for the rest of the frame */
+        return consumed;
+    }
+
+    if (consumed < 0 || !compressor_->inflateFrame(ssIn_)) {
+        onError(UV_EPROTO);
+        onDisconnect();
+        return n;
+    }
+
+    boost::scoped_ptr<yajr::rpc::InboundMessage> msg(parseFrame());
+    if (!msg) {
+        LOG(ERROR) << "skipping inbound message";
+    } else {
+        msg->process();
+    }
+
+    return consumed;
+}
+
+void CommunicationPeer::CompressorDeleter::operator()(
+        transport::FrameCompressor * c) const {
+    delete c;
+}
+
+transport::FrameCompressor * CommunicationPeer::getCompressor() const {
+    if (!compressor_) {
+        compressor_.reset(new transport::FrameCompressor());
+    }
+    return compressor_.get();
+}
+
+void CommunicationPeer::enableCompression() {
+    VLOG(1)
+        << this
+        << " compressing outbound frames"
+    ;
+    getCompressor()->enableDeflate();
+}
+
+void CommunicationPeer::pauseReading() {
+    if (readPaused_) {
+        return;
+    }
+    VLOG(3)
+        << this
+        << " pausing reads"
+    ;
+    readPaused_ = 1;
+    if (!choked_) {
+        choke();
+    }
+}
+
+void CommunicationPeer::resumeReading() {
+    if (!readPaused_) {
+        return;
+    }
+    VLOG(3)
+        << this
+        << " resuming reads"
+    ;
+    readPaused_ = 0;
+    if (choked_ && connected_) {
+        unchoke();
+    }
+}
+
+void CommunicationPeer::delimitFrame(size_t frameStart) const {
+    if (compressor_ && compressor_->deflateFrame(s_.deque_, frameStart)) {
+        return;
+    }
+    s_.Put('\0');
+}
+
 void CommunicationPeer::onWrite() {
     transport_.callbacks_->onSent_(this);
     pendingBytes_ = 0;
@@ -444,6 +546,13 @@ void CommunicationPeer::timeout() {
         return;
     }
 
+    if (readPaused_) {
+        /* we are not reading, so silence says nothing about the peer */
+        VLOG(5) << this << " reads paused";
+        lastHeard_ = now();
+        return;
+    }
+
     if (rtt <= (keepAliveInterval_ >> 3u) ) {
         VLOG(5) << this << " still waiting";
         return;
@@ -497,6 +606,11 @@ int comms::internal::CommunicationPeer::unchoke() const {
         return 0;
     }
 
+    if (readPaused_) {
+        /* resumeReading() will unchoke the peer */
+        return 0;
+    }
+
     int rc;
 
     if ((rc = uv_read_start(
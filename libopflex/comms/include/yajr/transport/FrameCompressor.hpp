@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2014 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef _____COMMS__INCLUDE__YAJR__TRANSPORT__FRAMECOMPRESSOR_H
+#define _____COMMS__INCLUDE__YAJR__TRANSPORT__FRAMECOMPRESSOR_H
+
+#include <zlib.h>
+
+#include <sys/types.h>
+
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace yajr {
+namespace transport {
+
+/**
+ * @brief Deflate stage sitting between the JSON writer and the transport
+ * engine.
+ *
+ * Once compression has been negotiated, each outbound frame that is large
+ * enough is replaced in the send queue by a compressed frame: a marker byte,
+ * a 32-bit big-endian payload length and a raw deflate block flushed with
+ * Z_SYNC_FLUSH (minus its constant 4-byte trailer).  The deflate and inflate
+ * contexts live for the whole connection so that the repetitive keys and
+ * URIs of OpFlex messages are matched against previous frames.
+ *
+ * The marker byte can never start a JSON text, so receivers can tell the
+ * two kinds of frames apart without any further negotiation and plain
+ * '\0'-delimited frames keep flowing alongside compressed ones.
+ */
+class FrameCompressor {
+  public:
+    /** First byte of every compressed frame */
+    static const unsigned char kFrameMarker = 0x1f;
+    /** Marker plus 32-bit payload length */
+    static const size_t kHeaderLen = 5;
+    /** Frames shorter than this are sent uncompressed */
+    static const size_t kMinFrameLen = 64;
+    /** Largest compressed payload we accept from a peer */
+    static const size_t kMaxFrameLen = 64 << 20;
+    /** Default largest JSON text we inflate from a single frame */
+    static const size_t kMaxInflatedLen = 256 << 20;
+
+    FrameCompressor();
+    ~FrameCompressor();
+
+    /**
+     * Allow outbound frames to be compressed.  Must only be called
+     * once the remote peer has advertised support for it.
+     */
+    void enableDeflate() { deflateEnabled_ = true; }
+
+    /**
+     * Whether outbound frames are being compressed
+     */
+    bool isDeflateEnabled() const { return deflateEnabled_; }
+
+    /**
+     * Set the largest JSON text inflated from a single frame.  A
+     * frame that inflates to more than this is rejected, so that a
+     * small frame cannot expand without bound.
+     *
+     * @param len the limit in bytes
+     */
+    void setMaxInflatedLen(size_t len) { maxInflatedLen_ = len; }
+
+    /**
+     * Compress the frame occupying the tail of the send queue.
+     *
+     * @param queue the peer's send queue
+     * @param frameStart offset in queue of the first byte of the frame
+     * @return true if the frame was replaced by a compressed frame,
+     * false if it was left untouched and still needs delimiting
+     */
+    bool deflateFrame(std::deque<char>& queue, size_t frameStart);
+
+    /**
+     * Whether the bytes at buffer start a new compressed frame or
+     * continue one that is being reassembled
+     *
+     * @param buffer next unread inbound byte
+     * @param atFrameBoundary true if no plain frame is partially read
+     */
+    bool isCompressed(char const * buffer, bool atFrameBoundary) const {
+        return !inFrame_.empty() ||
+            (atFrameBoundary &&
+             static_cast<unsigned char>(*buffer) == kFrameMarker);
+    }
+
+    /**
+     * Reassemble an inbound compressed frame
+     *
+     * @param buffer inbound bytes
+     * @param len number of bytes available at buffer
+     * @return number of bytes consumed, or -1 if the frame is malformed
+     */
+    ssize_t feed(char const * buffer, size_t len);
+
+    /**
+     * Whether a complete compressed frame has been reassembled
+     */
+    bool frameReady() const {
+        return inFrame_.size() >= kHeaderLen &&
+            inFrame_.size() == kHeaderLen + inFrameLen_;
+    }
+
+    /**
+     * Inflate the frame reassembled by feed() and reset for the next one
+     *
+     * @param out where the JSON text of the frame is written
+     * @return true on success, false if the frame is malformed or
+     * inflates to more than the limit set with setMaxInflatedLen()
+     */
+    bool inflateFrame(std::ostream& out);
+
+    /**
+     * Total uncompressed bytes handed to deflateFrame()
+     */
+    uint64_t getRawBytesOut() const { return rawBytesOut_; }
+
+    /**
+     * Total bytes put on the wire by deflateFrame()
+     */
+    uint64_t getWireBytesOut() const { return wireBytesOut_; }
+
+  private:
+    z_stream deflater_;
+    z_stream inflater_;
+    bool deflateInit_;
+    bool inflateInit_;
+    bool deflateEnabled_;
+
+    std::string inFrame_;
+    size_t inFrameLen_;
+    size_t maxInflatedLen_;
+
+    std::vector<unsigned char> in_;
+    std::vector<unsigned char> out_;
+
+    uint64_t rawBytesOut_;
+    uint64_t wireBytesOut_;
+};
+
+} /* yajr::transport namespace */
+} /* yajr namespace */
+
+#endif /* _____COMMS__INCLUDE__YAJR__TRANSPORT__FRAMECOMPRESSOR_H */
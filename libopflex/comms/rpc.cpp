@@ -131,10 +131,11 @@ bool OutboundMessage::send() {
 #if __cpp_exceptions || __EXCEPTIONS
     try {
 #endif
+        size_t frameStart = cP->getStringQueue().GetSize();
         bool ok = Accept(cP->getWriter());
 
         if (cP->nullTermination)
-            cP->delimitFrame();
+            cP->delimitFrame(frameStart);
         cP->write();
 
         if (!ok) {
@@ -1773,6 +1773,76 @@ BOOST_FIXTURE_TEST_CASE( STABLE_test_several_SSL_peers, CommsFixture ) {
 }
 #endif
 
+BOOST_AUTO_TEST_CASE( STABLE_test_frame_compressor ) {
+
+    using ::yajr::transport::FrameCompressor;
+
+    FrameCompressor tx, rx;
+    std::deque<char> wire;
+    std::vector<std::string> sent;
+
+    /* frames stay plain until compression is enabled */
+    std::string small("{\"id\":[\"echo\",0],\"result\":[0]}");
+    wire.insert(wire.end(), small.begin(), small.end());
+    BOOST_CHECK(!tx.deflateFrame(wire, 0));
+    wire.clear();
+
+    tx.enableDeflate();
+    for (size_t i = 0; i < 50; ++i) {
+        std::string frame("{\"method\":\"policy_update\",\"params\":[{"
+                "\"replace\":[{\"uri\":\"/PolicyUniverse/PolicySpace/"
+                "tenant/GbpEpGroup/epg" +
+                boost::lexical_cast<std::string>(i) + "/\"}]}],\"id\":" +
+                boost::lexical_cast<std::string>(i) + "}");
+        size_t frameStart = wire.size();
+        wire.insert(wire.end(), frame.begin(), frame.end());
+        BOOST_CHECK(tx.deflateFrame(wire, frameStart));
+        sent.push_back(frame);
+    }
+    BOOST_CHECK_LT(tx.getWireBytesOut(), tx.getRawBytesOut() / 2);
+
+    /* feed the receiver in small, arbitrarily aligned pieces */
+    std::string bytes(wire.begin(), wire.end());
+    size_t frames = 0;
+    for (size_t off = 0; off < bytes.size(); ) {
+        BOOST_REQUIRE(rx.isCompressed(&bytes[off], true));
+        ssize_t n = rx.feed(&bytes[off],
+                            std::min<size_t>(7, bytes.size() - off));
+        BOOST_REQUIRE_GT(n, 0);
+        off += n;
+        if (rx.frameReady()) {
+            std::stringstream out;
+            BOOST_REQUIRE(rx.inflateFrame(out));
+            BOOST_CHECK_EQUAL(out.str(), sent[frames]);
+            ++frames;
+        }
+    }
+    BOOST_CHECK_EQUAL(frames, sent.size());
+
+    /* oversized frames are rejected */
+    FrameCompressor bad;
+    char header[] = { 0x1f, 0x7f, 0x7f, 0x7f, 0x7f };
+    BOOST_CHECK(bad.isCompressed(header, true));
+    BOOST_CHECK(!bad.isCompressed(header, false));
+    BOOST_CHECK_EQUAL(bad.feed(header, sizeof(header)), -1);
+
+    /* so are frames that inflate to more than the limit */
+    FrameCompressor bombTx, bombRx;
+    bombTx.enableDeflate();
+    bombRx.setMaxInflatedLen(64 << 10);
+    std::string bomb("{\"method\":\"echo\",\"params\":[\"" +
+                     std::string(1 << 20, 'a') + "\"],\"id\":1}");
+    wire.assign(bomb.begin(), bomb.end());
+    BOOST_REQUIRE(bombTx.deflateFrame(wire, 0));
+    BOOST_CHECK_LT(wire.size(), 64 << 10);
+    bytes.assign(wire.begin(), wire.end());
+    BOOST_REQUIRE_EQUAL(bombRx.feed(bytes.data(), bytes.size()),
+                        (ssize_t)bytes.size());
+    BOOST_REQUIRE(bombRx.frameReady());
+    std::stringstream out;
+    BOOST_CHECK(!bombRx.inflateFrame(out));
+    BOOST_CHECK_LE(out.str().size(), 64 << 10);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
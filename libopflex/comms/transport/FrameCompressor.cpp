@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2014 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <yajr/transport/FrameCompressor.hpp>
+
+#include <opflex/logging/internal/logging.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace yajr {
+namespace transport {
+
+/* what Z_SYNC_FLUSH always appends; stripped on the wire */
+static const unsigned char kSyncTrailer[] = { 0x00, 0x00, 0xff, 0xff };
+
+FrameCompressor::FrameCompressor()
+    : deflateInit_(false), inflateInit_(false), deflateEnabled_(false),
+      inFrameLen_(0), maxInflatedLen_(kMaxInflatedLen),
+      rawBytesOut_(0), wireBytesOut_(0) {
+    memset(&deflater_, 0, sizeof(deflater_));
+    memset(&inflater_, 0, sizeof(inflater_));
+}
+
+FrameCompressor::~FrameCompressor() {
+    if (deflateInit_)
+        deflateEnd(&deflater_);
+    if (inflateInit_)
+        inflateEnd(&inflater_);
+}
+
+bool FrameCompressor::deflateFrame(std::deque<char>& queue,
+                                   size_t frameStart) {
+    size_t frameLen = queue.size() - frameStart;
+    if (!deflateEnabled_ || frameLen < kMinFrameLen)
+        return false;
+
+    if (!deflateInit_) {
+        /* favour latency: most of the gain comes from the shared window */
+        int rc = deflateInit2(&deflater_, Z_BEST_SPEED, Z_DEFLATED,
+                              -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        if (rc != Z_OK) {
+            LOG(ERROR) << "deflateInit2: " << rc
+                       << ", sending uncompressed frames";
+            deflateEnabled_ = false;
+            return false;
+        }
+        deflateInit_ = true;
+    }
+
+    in_.assign(queue.begin() + frameStart, queue.end());
+    out_.resize(kHeaderLen);
+
+    deflater_.next_in = &in_[0];
+    deflater_.avail_in = frameLen;
+    do {
+        size_t have = out_.size();
+        size_t room = std::max<size_t>(frameLen / 2, 4096);
+        out_.resize(have + room);
+        deflater_.next_out = &out_[have];
+        deflater_.avail_out = room;
+        int rc = deflate(&deflater_, Z_SYNC_FLUSH);
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            /* our stream state is now unknown, but nothing has been
+               sent with it: fall back to plain frames for good */
+            LOG(ERROR) << "deflate: " << rc
+                       << ", sending uncompressed frames";
+            deflateEnabled_ = false;
+            return false;
+        }
+        out_.resize(out_.size() - deflater_.avail_out);
+    } while (deflater_.avail_out == 0);
+
+    size_t payloadLen = out_.size() - kHeaderLen;
+    if (payloadLen >= sizeof(kSyncTrailer) &&
+        !memcmp(&out_[out_.size() - sizeof(kSyncTrailer)],
+                kSyncTrailer, sizeof(kSyncTrailer))) {
+        payloadLen -= sizeof(kSyncTrailer);
+        out_.resize(out_.size() - sizeof(kSyncTrailer));
+    }
+
+    out_[0] = kFrameMarker;
+    out_[1] = (payloadLen >> 24) & 0xff;
+    out_[2] = (payloadLen >> 16) & 0xff;
+    out_[3] = (payloadLen >> 8) & 0xff;
+    out_[4] = payloadLen & 0xff;
+
+    VLOG(5) << "deflated frame " << frameLen << " -> " << out_.size();
+
+    rawBytesOut_ += frameLen;
+    wireBytesOut_ += out_.size();
+
+    queue.resize(frameStart);
+    queue.insert(queue.end(), out_.begin(), out_.end());
+
+    return true;
+}
+
+ssize_t FrameCompressor::feed(char const * buffer, size_t len) {
+    size_t consumed = 0;
+
+    if (inFrame_.size() < kHeaderLen) {
+        consumed = std::min(len, kHeaderLen - inFrame_.size());
+        inFrame_.append(buffer, consumed);
+        if (inFrame_.size() < kHeaderLen)
+            return consumed;
+
+        unsigned char const * h =
+            reinterpret_cast<unsigned char const *>(inFrame_.data());
+        inFrameLen_ = (static_cast<size_t>(h[1]) << 24) |
+            (static_cast<size_t>(h[2]) << 16) |
+            (static_cast<size_t>(h[3]) << 8) | h[4];
+        if (h[0] != kFrameMarker || inFrameLen_ > kMaxFrameLen) {
+            LOG(ERROR) << "malformed compressed frame header, length "
+                       << inFrameLen_;
+            inFrame_.clear();
+            return -1;
+        }
+        inFrame_.reserve(kHeaderLen + inFrameLen_);
+    }
+
+    size_t n = std::min(len - consumed,
+                        kHeaderLen + inFrameLen_ - inFrame_.size());
+    inFrame_.append(buffer + consumed, n);
+
+    return consumed + n;
+}
+
+bool FrameCompressor::inflateFrame(std::ostream& out) {
+    assert(frameReady());
+
+    if (!inflateInit_) {
+        int rc = inflateInit2(&inflater_, -MAX_WBITS);
+        if (rc != Z_OK) {
+            LOG(ERROR) << "inflateInit2: " << rc;
+            return false;
+        }
+        inflateInit_ = true;
+    }
+
+    inFrame_.append(reinterpret_cast<char const *>(kSyncTrailer),
+                    sizeof(kSyncTrailer));
+
+    inflater_.next_in = reinterpret_cast<Bytef *>(&inFrame_[kHeaderLen]);
+    inflater_.avail_in = inFrame_.size() - kHeaderLen;
+
+    char chunk[16384];
+    size_t inflated = 0;
+    int rc;
+    do {
+        inflater_.next_out = reinterpret_cast<Bytef *>(chunk);
+        inflater_.avail_out = sizeof(chunk);
+        rc = inflate(&inflater_, Z_SYNC_FLUSH);
+        if (rc == Z_BUF_ERROR) {
+            /* no progress possible: everything was consumed */
+            rc = Z_OK;
+            break;
+        }
+        if (rc != Z_OK) {
+            LOG(ERROR) << "inflate: " << rc
+                       << (inflater_.msg ? inflater_.msg : "");
+            break;
+        }
+        size_t have = sizeof(chunk) - inflater_.avail_out;
+        inflated += have;
+        if (inflated > maxInflatedLen_) {
+            /* the stream can't be resynchronized: the caller drops
+               the peer */
+            LOG(ERROR) << "compressed frame of " << inFrameLen_
+                       << " bytes inflates to more than "
+                       << maxInflatedLen_ << " bytes";
+            rc = Z_DATA_ERROR;
+            break;
+        }
+        out.write(chunk, have);
+    } while (inflater_.avail_in || !inflater_.avail_out);
+
+    VLOG(5) << "inflated frame " << inFrame_.size() - kHeaderLen
+            << " -> " << inflated;
+
+    inFrame_.clear();
+    inFrameLen_ = 0;
+
+    return rc == Z_OK;
+}
+
+} /* yajr::transport namespace */
+} /* yajr namespace */
@@ -64,6 +64,7 @@ void InspectorClientHandler::handlePolicyQueryRes(const Value& payload) {
             LOG(ERROR) << "[" << getConnection()->getRemotePeer() << "] "
                        << "Malformed policy resolve response: policy must be array";
             conn->disconnect();
+            return;
         }
 
         Value::ConstValueIterator it;
@@ -71,6 +72,13 @@ void InspectorClientHandler::handlePolicyQueryRes(const Value& payload) {
             const Value& mo = *it;
             serializer.deserialize(mo, *storeClient, true, &notifs);
         }
+        client->pageReceived(policy);
+    }
+
+    // a paged query stays pending until its last page arrives
+    if (payload.HasMember("cursor") && payload["cursor"].IsUint64()) {
+        client->requestNextPage(payload["cursor"].GetUint64());
+        return;
     }
 
     client->pendingRequests -= 1;
@@ -56,7 +56,9 @@ InspectorClientImpl::InspectorClientImpl(const std::string& name_,
                                          const modb::ModelMetadata& model)
     : conn(*this, name_), db(threadManager),
       serializer(&db, this), pendingRequests(0),
-      followRefs(false), recursive(false), unresolved(false) {
+      followRefs(false), recursive(false), unresolved(false), pageSize(0),
+      streamOutput(NULL), streamProps(true), streamUtf8(true),
+      streamTruncate(0), streamDump(NULL) {
     db.init(model);
     storeClient = &db.getStoreClient("_SYSTEM_");
 }
@@ -79,9 +81,25 @@ OpflexHandler* InspectorClientImpl::newHandler(OpflexConnection* conn) {
 }
 
 void InspectorClientImpl::execute() {
+    if (streamDump) {
+        dumpStream.reset(new rapidjson::FileWriteStream(streamDump,
+                                                        dumpBuffer,
+                                                        sizeof(dumpBuffer)));
+        dumpWriter.reset(new dump_writer_t(*dumpStream));
+        dumpWriter->StartArray();
+    }
+
     db.start();
     conn.connect();
     db.stop();
+
+    if (dumpWriter) {
+        dumpWriter->EndArray();
+        dumpStream->Flush();
+        fwrite("\n", 1, 1, streamDump);
+        dumpWriter.reset();
+        dumpStream.reset();
+    }
 }
 
 void InspectorClientImpl::executeCommands() {
@@ -149,6 +167,10 @@ public:
         }
         writer.String("recursive");
         writer.Bool(query.recursive);
+        if (client.getPageSize()) {
+            writer.String("page_size");
+            writer.Uint64(client.getPageSize());
+        }
         writer.EndObject();
         writer.EndArray();
         writer.EndObject();
@@ -165,6 +187,80 @@ int Query::execute(InspectorClientImpl& client) {
     return 1;
 }
 
+class PolicyQueryNextReq : public InspectorMessage {
+public:
+    PolicyQueryNextReq(InspectorClientImpl& client, uint64_t cursor_)
+        : InspectorMessage("custom", REQUEST, client),
+          cursor(cursor_) {}
+
+    virtual void serializePayload(yajr::rpc::SendHandler& writer) {
+        (*this)(writer);
+    }
+
+    virtual PolicyQueryNextReq* clone() {
+        return new PolicyQueryNextReq(*this);
+    }
+
+    template <typename T>
+    bool operator()(rapidjson::Writer<T> & writer) {
+        writer.StartArray();
+        writer.StartObject();
+        writer.String("method");
+        writer.String("org.opendaylight.opflex.policy_query");
+        writer.String("params");
+        writer.StartArray();
+        writer.StartObject();
+        writer.String("cursor");
+        writer.Uint64(cursor);
+        if (client.getPageSize()) {
+            writer.String("page_size");
+            writer.Uint64(client.getPageSize());
+        }
+        writer.EndObject();
+        writer.EndArray();
+        writer.EndObject();
+        writer.EndArray();
+        return true;
+    }
+
+    uint64_t cursor;
+};
+
+void InspectorClientImpl::requestNextPage(uint64_t cursor) {
+    conn.sendMessage(new PolicyQueryNextReq(*this, cursor), true);
+}
+
+void InspectorClientImpl::pageReceived(const rapidjson::Value& policy) {
+    if (!streamOutput && !dumpWriter) return;
+
+    // Objects whose parent came in an earlier page are not linked to
+    // it, so every object in the store is reached from some root
+    if (streamOutput)
+        serializer.displayMODB(*streamOutput, false, streamProps,
+                               streamUtf8, streamTruncate);
+
+    rapidjson::Value::ConstValueIterator it;
+    for (it = policy.Begin(); it != policy.End(); ++it) {
+        const rapidjson::Value& mo = *it;
+        if (dumpWriter)
+            mo.Accept(*dumpWriter);
+
+        if (!mo.IsObject() || !mo.HasMember("uri") ||
+            !mo.HasMember("subject"))
+            continue;
+        const rapidjson::Value& uriv = mo["uri"];
+        const rapidjson::Value& subjectv = mo["subject"];
+        if (!uriv.IsString() || !subjectv.IsString())
+            continue;
+        try {
+            const ClassInfo& ci = db.getClassInfo(subjectv.GetString());
+            storeClient->remove(ci.getId(), URI(uriv.GetString()), false);
+        } catch (const std::out_of_range& e) {
+            // already dropped
+        }
+    }
+}
+
 void InspectorClientImpl::addQuery(const string& subject,
                                    const URI& uri) {
     commands.push_back(new Query(subject, optional<URI>(uri), recursive));
@@ -211,6 +307,24 @@ void InspectorClientImpl::setUnresolved(bool enabled) {
     followRefs = enabled;
 }
 
+void InspectorClientImpl::setPageSize(size_t objects) {
+    pageSize = objects;
+}
+
+void InspectorClientImpl::setStreamOutput(std::ostream* output,
+                                          bool includeProps,
+                                          bool utf8,
+                                          size_t truncate) {
+    streamOutput = output;
+    streamProps = includeProps;
+    streamUtf8 = utf8;
+    streamTruncate = truncate;
+}
+
+void InspectorClientImpl::setStreamDump(FILE* file) {
+    streamDump = file;
+}
+
 static std::string getRefSubj(const modb::ObjectStore& store,
                               const modb::reference_t& ref) {
     try {
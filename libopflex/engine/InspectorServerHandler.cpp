@@ -14,6 +14,8 @@
 #  include <config.h>
 #endif
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 
 #include <boost/foreach.hpp>
@@ -29,13 +31,17 @@ namespace internal {
 using rapidjson::Value;
 using rapidjson::Writer;
 using ofcore::OFConstants;
+using modb::ClassInfo;
+using modb::PropertyInfo;
+using modb::reference_t;
+using modb::mointernal::StoreClient;
 
 void InspectorServerHandler::connected() {
 
 }
 
 void InspectorServerHandler::disconnected() {
-
+    cursors.clear();
 }
 
 void InspectorServerHandler::ready() {
@@ -47,10 +53,11 @@ public:
     PolicyQueryRes(const rapidjson::Value& id,
                    Inspector* inspector_,
                    const std::vector<modb::reference_t>& mos_,
-                   bool recursive_)
+                   bool recursive_,
+                   uint64_t cursor_ = 0)
         : OpflexMessage("custom", RESPONSE, &id),
           inspector(inspector_),
-          mos(mos_), recursive(recursive_) {}
+          mos(mos_), recursive(recursive_), cursor(cursor_) {}
 
     virtual void serializePayload(yajr::rpc::SendHandler& writer) {
         (*this)(writer);
@@ -83,6 +90,10 @@ public:
             }
         }
         writer.EndArray();
+        if (cursor) {
+            writer.String("cursor");
+            writer.Uint64(cursor);
+        }
         writer.EndObject();
         writer.EndObject();
         return true;
@@ -91,6 +102,7 @@ public:
     Inspector* inspector;
     std::vector<modb::reference_t> mos;
     bool recursive;
+    uint64_t cursor;
 };
 
 void InspectorServerHandler::handlePolicyQueryReq(const Value& id,
@@ -98,12 +110,35 @@ void InspectorServerHandler::handlePolicyQueryReq(const Value& id,
     Value::ConstValueIterator it;
     std::vector<modb::reference_t> mos;
     bool recursive = false;
-    
+    size_t pageSize = 0;
+
     for (it = payload.Begin(); it != payload.End(); ++it) {
         if (!it->IsObject()) {
             sendErrorRes(id, "ERROR", "Malformed message: not an object");
             return;
         }
+        if (it->HasMember("page_size")) {
+            const Value& pagev = (*it)["page_size"];
+            if (!pagev.IsUint64()) {
+                sendErrorRes(id, "ERROR",
+                             "Malformed message: page_size is not an "
+                             "unsigned integer");
+                return;
+            }
+            pageSize = std::min<uint64_t>(pagev.GetUint64(), MAX_PAGE_SIZE);
+        }
+        if (it->HasMember("cursor")) {
+            const Value& cursorv = (*it)["cursor"];
+            if (!cursorv.IsUint64()) {
+                sendErrorRes(id, "ERROR",
+                             "Malformed message: cursor is not an "
+                             "unsigned integer");
+                return;
+            }
+            sendPage(id, cursorv.GetUint64(),
+                     pageSize ? pageSize : MAX_PAGE_SIZE);
+            return;
+        }
         if (!it->HasMember("subject")) {
             sendErrorRes(id, "ERROR", "Malformed message: no endpoint");
             return;
@@ -150,13 +185,95 @@ void InspectorServerHandler::handlePolicyQueryReq(const Value& id,
         }
     }
 
+    if (pageSize == 0) {
+        PolicyQueryRes* res =
+            new PolicyQueryRes(id, inspector, mos, recursive);
+        getConnection()->sendMessage(res, true);
+        return;
+    }
+
+    if (cursors.size() >= MAX_CURSORS) {
+        sendErrorRes(id, "ERROR", "Too many open paged queries");
+        return;
+    }
+    uint64_t cursorId = nextCursor++;
+    QueryCursor& cursor = cursors[cursorId];
+    cursor.pending.assign(mos.rbegin(), mos.rend());
+    cursor.recursive = recursive;
+    sendPage(id, cursorId, pageSize);
+}
+
+/*
+ * Push the children of mo so that they are popped in the same order
+ * as MOSerializer::serialize() would write them
+ */
+static void pushChildren(modb::ObjectStore& store, StoreClient& client,
+                         const reference_t& mo,
+                         std::vector<reference_t>& pending) {
+    const ClassInfo& ci = store.getClassInfo(mo.first);
+    std::map<modb::class_id_t, std::vector<modb::URI> > children;
+    BOOST_FOREACH(const ClassInfo::property_map_t::value_type& p,
+                  ci.getProperties()) {
+        if (p.second.getType() == PropertyInfo::COMPOSITE)
+            client.getChildren(mo.first, mo.second, p.first,
+                               p.second.getClassId(),
+                               children[p.second.getClassId()]);
+    }
+
+    std::map<modb::class_id_t, std::vector<modb::URI> >
+        ::const_reverse_iterator clsit;
+    std::vector<modb::URI>::const_reverse_iterator cit;
+    for (clsit = children.rbegin(); clsit != children.rend(); ++clsit) {
+        for (cit = clsit->second.rbegin(); cit != clsit->second.rend(); ++cit)
+            pending.push_back(reference_t(clsit->first, *cit));
+    }
+}
+
+void InspectorServerHandler::sendPage(const Value& id, uint64_t cursorId,
+                                      size_t pageSize) {
+    cursor_map_t::iterator cit = cursors.find(cursorId);
+    if (cit == cursors.end()) {
+        sendErrorRes(id, "ERROR", "Unknown or expired cursor");
+        return;
+    }
+
+    // Only the objects of this page are collected; each one is
+    // serialized on its own when the reply is written so the size of
+    // a reply is bounded by the page size rather than the query
+    QueryCursor& cursor = cit->second;
+    StoreClient& client = inspector->getStore().getReadOnlyStoreClient();
+    std::vector<reference_t> page;
+    page.reserve(std::min(pageSize, cursor.pending.size()));
+    while (!cursor.pending.empty() && page.size() < pageSize) {
+        reference_t mo(cursor.pending.back());
+        cursor.pending.pop_back();
+        if (cursor.recursive) {
+            try {
+                pushChildren(inspector->getStore(), client, mo,
+                             cursor.pending);
+            } catch (const std::out_of_range& e) {
+                // removed since the query started
+                continue;
+            }
+        }
+        page.push_back(mo);
+    }
+
+    uint64_t next = 0;
+    if (cursor.pending.empty())
+        cursors.erase(cit);
+    else
+        next = cursorId;
+
     PolicyQueryRes* res =
-        new PolicyQueryRes(id, inspector, mos, recursive);
+        new PolicyQueryRes(id, inspector, page, false, next);
     getConnection()->sendMessage(res, true);
 }
 
 const std::string
 InspectorServerHandler::POLICY_QUERY("org.opendaylight.opflex.policy_query");
+const size_t InspectorServerHandler::MAX_PAGE_SIZE;
+const size_t InspectorServerHandler::MAX_CURSORS;
 
 void InspectorServerHandler::handleCustomReq(const Value& id,
                                              const Value& payload) {
@@ -58,8 +58,7 @@ MOSerializer::~MOSerializer() {
 
 }
 
-void MOSerializer::deserialize_ref(modb::mointernal::StoreClient& client,
-                                   const PropertyInfo& pinfo,
+void MOSerializer::deserialize_ref(const PropertyInfo& pinfo,
                                    const rapidjson::Value& v,
                                    ObjectInstance& oi,
                                    bool scalar) {
@@ -70,22 +69,20 @@ void MOSerializer::deserialize_ref(modb::mointernal::StoreClient& client,
     const Value& subject = v["subject"];
     const Value& refuri = v["reference_uri"];
 
-    try {
-        const ClassInfo& ci = store->getClassInfo(subject.GetString());
-        if (scalar) {
-            oi.setReference(pinfo.getId(), ci.getId(), URI(refuri.GetString()));
-        } else {
-            oi.addReference(pinfo.getId(), ci.getId(), URI(refuri.GetString()));
-        }
-    } catch (const std::out_of_range& e) {
+    const ClassInfo* ci =
+        store->findClassInfo(subject.GetString(), subject.GetStringLength());
+    if (!ci) {
         // ignore unknown class
         LOG(DEBUG) << "Could not deserialize reference of unknown class "
                    << subject.GetString();
+    } else if (scalar) {
+        oi.setReference(pinfo.getId(), ci->getId(), URI(refuri.GetString()));
+    } else {
+        oi.addReference(pinfo.getId(), ci->getId(), URI(refuri.GetString()));
     }
 }
 
-void MOSerializer::deserialize_enum(modb::mointernal::StoreClient& client,
-                                    const PropertyInfo& pinfo,
+void MOSerializer::deserialize_enum(const PropertyInfo& pinfo,
                                     const rapidjson::Value& pvalue,
                                     ObjectInstance& oi,
                                     bool scalar) {
@@ -111,246 +108,325 @@ void MOSerializer::deserialize(const rapidjson::Value& mo,
                                modb::mointernal::StoreClient& client,
                                bool replaceChildren,
                                /* out */ modb::mointernal::StoreClient::notif_t* notifs) {
+    DecodedMO dmo;
+    if (decode(mo, replaceChildren, dmo))
+        apply(dmo, client, notifs);
+}
+
+bool MOSerializer::decode(const rapidjson::Value& mo,
+                          bool replaceChildren,
+                          /* out */ DecodedMO& dmo) {
     if (!mo.IsObject()
         || !mo.HasMember("uri")
-        || !mo.HasMember("subject")) return;
+        || !mo.HasMember("subject")) return false;
 
     const Value& uriv = mo["uri"];
-    if (!uriv.IsString()) return;
+    if (!uriv.IsString()) return false;
     const Value& classv = mo["subject"];
-    if (!classv.IsString()) return;
+    if (!classv.IsString()) return false;
+    const ClassInfo* cip =
+        store->findClassInfo(classv.GetString(), classv.GetStringLength());
+    if (!cip) {
+        // ignore unknown class
+        LOG(DEBUG) << "Could not deserialize object of unknown class "
+                   << classv.GetString();
+        return false;
+    }
+    const ClassInfo& ci = *cip;
+
+    dmo.class_id = ci.getId();
+    dmo.uri = URI(uriv.GetString());
+    dmo.oi = OF_MAKE_SHARED<ObjectInstance>(ci.getId(), false);
+    ObjectInstance* oi = dmo.oi.get();
+    if (mo.HasMember("properties")) {
+        const Value& properties = mo["properties"];
+        if (properties.IsArray()) {
+            for (SizeType i = 0; i < properties.Size(); ++i) {
+                const Value& prop = properties[i];
+                if (!prop.IsObject() ||
+                    !prop.HasMember("name") ||
+                    !prop.HasMember("data"))
+                    continue;
+
+                const Value& pname = prop["name"];
+                if (!pname.IsString())
+                    continue;
+                const Value& pvalue = prop["data"];
+                const PropertyInfo* pinfop =
+                    ci.findProperty(pname.GetString(),
+                                    pname.GetStringLength());
+                if (!pinfop) {
+                    LOG(DEBUG) << "Unknown property "
+                               << pname.GetString()
+                               << " in class "
+                               << ci.getName();
+                    // ignore property
+                    continue;
+                }
+                const PropertyInfo& pinfo = *pinfop;
 
-    try {
-        URI uri(uriv.GetString());
-        const ClassInfo& ci = store->getClassInfo(classv.GetString());
-        OF_SHARED_PTR<ObjectInstance> oi =
-            OF_MAKE_SHARED<ObjectInstance>(ci.getId(), false);
-        if (mo.HasMember("properties")) {
-            const Value& properties = mo["properties"];
-            if (properties.IsArray()) {
-                for (SizeType i = 0; i < properties.Size(); ++i) {
-                    const Value& prop = properties[i];
-                    if (!prop.IsObject() ||
-                        !prop.HasMember("name") ||
-                        !prop.HasMember("data"))
-                        continue;
-
-                    const Value& pname = prop["name"];
-                    if (!pname.IsString())
-                        continue;
-                    const Value& pvalue = prop["data"];
-
-                    try {
-                        const PropertyInfo& pinfo =
-                            ci.getProperty(pname.GetString());
-                        switch (pinfo.getType()) {
-                        case PropertyInfo::STRING:
-                            if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
-                                if (!pvalue.IsArray()) continue;
-                                for (SizeType j = 0; j < pvalue.Size(); ++j) {
-                                    const Value& v = pvalue[j];
-                                    if (!v.IsString()) continue;
-                                    oi->addString(pinfo.getId(), v.GetString());
-                                }
-                            } else {
-                                if (!pvalue.IsString()) continue;
-                                oi->setString(pinfo.getId(),
-                                              pvalue.GetString());
-                            }
-                            break;
-                        case PropertyInfo::REFERENCE:
-                            if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
-                                if (!pvalue.IsArray()) continue;
-                                for (SizeType j = 0; j < pvalue.Size(); ++j) {
-                                    const Value& v = pvalue[j];
-                                    deserialize_ref(client, pinfo, v, *oi, false);
-                                }
-                            } else {
-                                deserialize_ref(client, pinfo, pvalue, *oi, true);
+                try {
+                    switch (pinfo.getType()) {
+                    case PropertyInfo::STRING:
+                        if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
+                            if (!pvalue.IsArray()) continue;
+                            for (SizeType j = 0; j < pvalue.Size(); ++j) {
+                                const Value& v = pvalue[j];
+                                if (!v.IsString()) continue;
+                                oi->addString(pinfo.getId(), v.GetString());
                             }
-                            break;
-                        case PropertyInfo::S64:
-                            if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
-                                if (!pvalue.IsArray()) continue;
-                                for (SizeType j = 0; j < pvalue.Size(); ++j) {
-                                    const Value& v = pvalue[j];
-                                    if (!v.IsInt64()) continue;
-                                    oi->addInt64(pinfo.getId(), v.GetInt64());
-                                }
-                            } else {
-                                if (!pvalue.IsInt64()) continue;
-                                oi->setInt64(pinfo.getId(),
-                                             pvalue.GetInt64());
+                        } else {
+                            if (!pvalue.IsString()) continue;
+                            oi->setString(pinfo.getId(),
+                                          pvalue.GetString());
+                        }
+                        break;
+                    case PropertyInfo::REFERENCE:
+                        if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
+                            if (!pvalue.IsArray()) continue;
+                            for (SizeType j = 0; j < pvalue.Size(); ++j) {
+                                const Value& v = pvalue[j];
+                                deserialize_ref(pinfo, v, *oi, false);
                             }
-                            break;
-                        case PropertyInfo::ENUM8:
-                        case PropertyInfo::ENUM16:
-                        case PropertyInfo::ENUM32:
-                        case PropertyInfo::ENUM64:
-                            {
-                                if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
-                                    if (!pvalue.IsArray()) continue;
-                                    for (SizeType j = 0; j < pvalue.Size(); ++j) {
-                                        const Value& v = pvalue[j];
-                                        deserialize_enum(client, pinfo, v, *oi, false);
-                                    }
-                                } else {
-                                    deserialize_enum(client, pinfo, pvalue, *oi, true);
-                                }
+                        } else {
+                            deserialize_ref(pinfo, pvalue, *oi, true);
+                        }
+                        break;
+                    case PropertyInfo::S64:
+                        if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
+                            if (!pvalue.IsArray()) continue;
+                            for (SizeType j = 0; j < pvalue.Size(); ++j) {
+                                const Value& v = pvalue[j];
+                                if (!v.IsInt64()) continue;
+                                oi->addInt64(pinfo.getId(), v.GetInt64());
                             }
-                            break;
-                        case PropertyInfo::U64:
+                        } else {
+                            if (!pvalue.IsInt64()) continue;
+                            oi->setInt64(pinfo.getId(),
+                                         pvalue.GetInt64());
+                        }
+                        break;
+                    case PropertyInfo::ENUM8:
+                    case PropertyInfo::ENUM16:
+                    case PropertyInfo::ENUM32:
+                    case PropertyInfo::ENUM64:
+                        {
                             if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
                                 if (!pvalue.IsArray()) continue;
                                 for (SizeType j = 0; j < pvalue.Size(); ++j) {
                                     const Value& v = pvalue[j];
-                                    if (!v.IsUint64()) continue;
-                                    oi->addUInt64(pinfo.getId(), v.GetUint64());
+                                    deserialize_enum(pinfo, v, *oi, false);
                                 }
                             } else {
-                                if (!pvalue.IsUint64()) continue;
-                                oi->setUInt64(pinfo.getId(),
-                                              pvalue.GetUint64());
+                                deserialize_enum(pinfo, pvalue, *oi, true);
                             }
-                            break;
-                        case PropertyInfo::MAC:
-                            if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
-                                if (!pvalue.IsArray()) continue;
-                                for (SizeType j = 0; j < pvalue.Size(); ++j) {
-                                    const Value& v = pvalue[j];
-                                    if (!v.IsString()) continue;
-                                    oi->addMAC(pinfo.getId(), MAC(v.GetString()));
-                                }
-                            } else {
-                                oi->setMAC(pinfo.getId(),
-                                           MAC(pvalue.GetString()));
+                        }
+                        break;
+                    case PropertyInfo::U64:
+                        if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
+                            if (!pvalue.IsArray()) continue;
+                            for (SizeType j = 0; j < pvalue.Size(); ++j) {
+                                const Value& v = pvalue[j];
+                                if (!v.IsUint64()) continue;
+                                oi->addUInt64(pinfo.getId(), v.GetUint64());
+                            }
+                        } else {
+                            if (!pvalue.IsUint64()) continue;
+                            oi->setUInt64(pinfo.getId(),
+                                          pvalue.GetUint64());
+                        }
+                        break;
+                    case PropertyInfo::MAC:
+                        if (pinfo.getCardinality() == PropertyInfo::VECTOR) {
+                            if (!pvalue.IsArray()) continue;
+                            for (SizeType j = 0; j < pvalue.Size(); ++j) {
+                                const Value& v = pvalue[j];
+                                if (!v.IsString()) continue;
+                                oi->addMAC(pinfo.getId(), MAC(v.GetString()));
                             }
-                            break;
-                        case PropertyInfo::COMPOSITE:
-                            // do nothing;
-                            break;
+                        } else {
+                            oi->setMAC(pinfo.getId(),
+                                       MAC(pvalue.GetString()));
                         }
-                    } catch (const std::invalid_argument& e) {
-                        LOG(DEBUG) << "Invalid property "
-                                   << pname.GetString()
-                                   << " in class "
-                                   << ci.getName();
-                    } catch (const std::out_of_range& e) {
-                        LOG(DEBUG) << "Unknown property "
-                                   << pname.GetString()
-                                   << " in class "
-                                   << ci.getName();
-                        // ignore property
+                        break;
+                    case PropertyInfo::COMPOSITE:
+                        // do nothing;
+                        break;
                     }
+                } catch (const std::invalid_argument& e) {
+                    LOG(DEBUG) << "Invalid property "
+                               << pname.GetString()
+                               << " in class "
+                               << ci.getName();
+                } catch (const std::out_of_range& e) {
+                    LOG(DEBUG) << "Unknown property "
+                               << pname.GetString()
+                               << " in class "
+                               << ci.getName();
+                    // ignore property
                 }
             }
         }
+    }
 
-        bool remoteUpdated = false;
-        if (client.putIfModified(ci.getId(), uri, oi)) {
-            remoteUpdated = true;
+    if (mo.HasMember("parent_uri") && mo.HasMember("parent_subject")) {
+        const Value& pname = mo["parent_uri"];
+        const Value& psubj = mo["parent_subject"];
+        const Value* prel = &classv;
+        if (mo.HasMember("parent_relation"))
+            prel = &mo["parent_relation"];
+
+        if (pname.IsString() && psubj.IsString() && prel->IsString()) {
+            const ClassInfo* parent_class =
+                store->findClassInfo(psubj.GetString(),
+                                     psubj.GetStringLength());
+            const PropertyInfo* parent_prop = parent_class
+                ? parent_class->findProperty(prel->GetString(),
+                                             prel->GetStringLength())
+                : NULL;
+            if (parent_prop) {
+                dmo.has_parent = true;
+                dmo.parent_class = parent_class->getId();
+                dmo.parent_prop = parent_prop->getId();
+                dmo.parent_uri = URI(pname.GetString());
+            } else {
+                // no parent class or property found
+                LOG(ERROR) << "Invalid parent or property for "
+                           << dmo.uri.toString();
+            }
         }
-        if (mo.HasMember("parent_uri") && mo.HasMember("parent_subject")) {
-            const Value& pname = mo["parent_uri"];
-            const Value& psubj = mo["parent_subject"];
-            const Value* prel = &classv;
-            if (mo.HasMember("parent_relation"))
-                prel = &mo["parent_relation"];
-
-            if (pname.IsString() && psubj.IsString() && prel->IsString()) {
-                try {
-                    const ClassInfo& parent_class =
-                        store->getClassInfo(psubj.GetString());
-                    const PropertyInfo& parent_prop =
-                        parent_class.getProperty(prel->GetString());
-                    URI parent_uri(pname.GetString());
-                    if (client.isPresent(parent_class.getId(), parent_uri)) {
-                        if (client.addChild(parent_class.getId(),
-                                            parent_uri,
-                                            parent_prop.getId(),
-                                            ci.getId(),
-                                            uri)) {
-                            if (notifs)
-                                client.queueNotification(parent_class.getId(),
-                                                         parent_uri,
-                                                         *notifs);
-                        }
-                    } else {
-                        LOG(DEBUG2) << "No parent present for "
-                                    << uri.toString();
-                    }
-                } catch (const std::out_of_range& e) {
-                    // no parent class or property found
-                    LOG(ERROR) << "Invalid parent or property for "
-                               << uri.toString();
-                }
+    }
+
+    dmo.replace_children = replaceChildren;
+    if (replaceChildren && mo.HasMember("children")) {
+        const Value& cvs = mo["children"];
+        if (cvs.IsArray()) {
+            for (SizeType i = 0; i < cvs.Size(); ++i) {
+                const Value& cv = cvs[i];
+                if (cv.IsString())
+                    dmo.children.insert(cv.GetString());
             }
         }
+    }
+    return true;
+}
 
-        if (replaceChildren) {
-            OF_UNORDERED_SET<string> children;
-            if (mo.HasMember("children")) {
-                const Value& cvs = mo["children"];
-                if (cvs.IsArray()) {
-                    for (SizeType i = 0; i < cvs.Size(); ++i) {
-                        const Value& cv = cvs[i];
-                        if (cv.IsString())
-                            children.insert(cv.GetString());
-                    }
-                }
+void MOSerializer::apply(const DecodedMO& dmo,
+                         modb::mointernal::StoreClient& client,
+                         /* out */ modb::mointernal::StoreClient::notif_t* notifs) {
+    try {
+        bool updated = client.putIfModified(dmo.class_id, dmo.uri, dmo.oi);
+        finishApply(dmo, updated, client, notifs);
+    } catch (const std::out_of_range& e) {
+        // ignore unknown class
+        LOG(DEBUG) << "Could not deserialize object of unknown class "
+                   << dmo.class_id;
+    }
+}
+
+void MOSerializer::apply(const std::vector<DecodedMO>& dmos,
+                         modb::mointernal::StoreClient& client,
+                         /* out */ modb::mointernal::StoreClient::notif_t* notifs) {
+    vector<StoreClient::PutRequest> puts;
+    puts.reserve(dmos.size());
+    BOOST_FOREACH(const DecodedMO& dmo, dmos) {
+        StoreClient::PutRequest req =
+            { dmo.class_id, dmo.uri, dmo.oi,
+              OF_SHARED_PTR<const ObjectInstance>() };
+        puts.push_back(req);
+    }
+    StoreClient::notif_t modified;
+    try {
+        client.putIfModified(puts, modified);
+    } catch (const std::out_of_range& e) {
+        LOG(ERROR) << "Could not write batch of "
+                   << dmos.size() << " objects: " << e.what();
+        return;
+    }
+
+    BOOST_FOREACH(const DecodedMO& dmo, dmos) {
+        try {
+            bool updated = modified.find(dmo.uri) != modified.end();
+            // an earlier object in the batch removed this one as a
+            // missing child, so put it back as applying the objects
+            // one at a time would have
+            if (!client.isPresent(dmo.class_id, dmo.uri))
+                updated = client.putIfModified(dmo.class_id, dmo.uri,
+                                               dmo.oi) || updated;
+            finishApply(dmo, updated, client, notifs);
+        } catch (const std::out_of_range& e) {
+            LOG(DEBUG) << "Could not deserialize object of unknown class "
+                       << dmo.class_id;
+        }
+    }
+}
+
+void MOSerializer::finishApply(const DecodedMO& dmo, bool updated,
+                               modb::mointernal::StoreClient& client,
+                               modb::mointernal::StoreClient::notif_t* notifs) {
+    const URI& uri = dmo.uri;
+    if (dmo.has_parent) {
+        if (client.isPresent(dmo.parent_class, dmo.parent_uri)) {
+            if (client.addChild(dmo.parent_class,
+                                dmo.parent_uri,
+                                dmo.parent_prop,
+                                dmo.class_id,
+                                uri)) {
+                if (notifs)
+                    client.queueNotification(dmo.parent_class,
+                                             dmo.parent_uri,
+                                             *notifs);
             }
+        } else {
+            LOG(DEBUG2) << "No parent present for "
+                        << uri.toString();
+        }
+    }
 
-            const ClassInfo::property_map_t& props = ci.getProperties();
-            ClassInfo::property_map_t::const_iterator it;
-            for (it = props.begin(); it != props.end(); ++it) {
-                if (it->second.getType() == PropertyInfo::COMPOSITE) {
-                    std::vector<URI> curChildren;
-                    client.getChildren(ci.getId(),
-                                       uri,
-                                       it->second.getId(),
-                                       it->second.getClassId(),
-                                       curChildren);
-
-                    BOOST_FOREACH(URI& child, curChildren) {
-                        if (children.find(child.toString()) == children.end()) {
-                            // this child isn't in the list of children
-                            // set in the update
-                            try {
-                                LOG(DEBUG) << "Removing missing child " << child
-                                           << " from updated parent " << uri;
-                                client.remove(it->second.getClassId(), child,
-                                              true, notifs);
-                                if (notifs)
-                                    (*notifs)[child] = it->second.getClassId();
-                                remoteUpdated = true;
-                            } catch (const std::out_of_range& e) {
-                                // most likely already removed by
-                                // another thread
-                            }
+    if (dmo.replace_children) {
+        const ClassInfo& ci = store->getClassInfo(dmo.class_id);
+        const ClassInfo::property_map_t& props = ci.getProperties();
+        ClassInfo::property_map_t::const_iterator it;
+        for (it = props.begin(); it != props.end(); ++it) {
+            if (it->second.getType() == PropertyInfo::COMPOSITE) {
+                std::vector<URI> curChildren;
+                client.getChildren(ci.getId(),
+                                   uri,
+                                   it->second.getId(),
+                                   it->second.getClassId(),
+                                   curChildren);
+
+                BOOST_FOREACH(URI& child, curChildren) {
+                    if (dmo.children.find(child.toString()) ==
+                        dmo.children.end()) {
+                        // this child isn't in the list of children
+                        // set in the update
+                        try {
+                            LOG(DEBUG) << "Removing missing child " << child
+                                       << " from updated parent " << uri;
+                            client.remove(it->second.getClassId(), child,
+                                          true, notifs);
+                            if (notifs)
+                                (*notifs)[child] = it->second.getClassId();
+                            updated = true;
+                        } catch (const std::out_of_range& e) {
+                            // most likely already removed by
+                            // another thread
                         }
                     }
                 }
             }
         }
+    }
 
-        if (remoteUpdated) {
-            LOG(DEBUG2) << "Updated object " << uri;
-            if (notifs)
-                client.queueNotification(ci.getId(), uri, *notifs);
-            PolicyUpdateOp op = replaceChildren ? PolicyUpdateOp::REPLACE
-                                                : PolicyUpdateOp::ADD;
-            if (listener)
-                listener->remoteObjectUpdated(ci.getId(), uri, op);
-        }
-
-    } catch (const std::invalid_argument& e) {
-        // ignore invalid URIs
-        LOG(DEBUG) << "Could not deserialize invalid object of class "
-                   << classv.GetString();
-    } catch (const std::out_of_range& e) {
-        // ignore unknown class
-        LOG(DEBUG) << "Could not deserialize object of unknown class "
-                   << classv.GetString();
+    if (updated) {
+        LOG(DEBUG2) << "Updated object " << uri;
+        if (notifs)
+            client.queueNotification(dmo.class_id, uri, *notifs);
+        PolicyUpdateOp op = dmo.replace_children ? PolicyUpdateOp::REPLACE
+                                                 : PolicyUpdateOp::ADD;
+        if (listener)
+            listener->remoteObjectUpdated(dmo.class_id, uri, op);
     }
 }
 
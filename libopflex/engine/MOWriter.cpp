@@ -0,0 +1,180 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for MOWriter
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <iterator>
+
+#include "opflex/engine/internal/MOWriter.h"
+#include "opflex/util/LockGuard.h"
+#include "opflex/logging/internal/logging.hpp"
+
+namespace opflex {
+namespace engine {
+namespace internal {
+
+using std::vector;
+using modb::mointernal::StoreClient;
+
+static const size_t DEFAULT_MAX_QUEUED = 16384;
+
+MOWriter::MOWriter(MOSerializer& serializer_,
+                   util::ThreadManager& threadManager_)
+    : serializer(serializer_), threadManager(threadManager_),
+      client(NULL), maxQueued(DEFAULT_MAX_QUEUED), writer_loop(NULL),
+      active(false), full(false), pending(0) {
+    uv_mutex_init(&queue_mutex);
+}
+
+MOWriter::~MOWriter() {
+    stop();
+    uv_mutex_destroy(&queue_mutex);
+}
+
+void MOWriter::setMaxQueued(size_t maxQueued_) {
+    util::LockGuard guard(&queue_mutex);
+    maxQueued = maxQueued_;
+}
+
+void MOWriter::setResumeHandler(const resume_fn_t& resumeHandler_) {
+    resumeHandler = resumeHandler_;
+}
+
+void MOWriter::start(StoreClient* client_) {
+    if (active) return;
+    client = client_;
+
+    writer_loop = threadManager.initTask("mo_writer");
+    writer_async.data = this;
+    cleanup_async.data = this;
+    uv_async_init(writer_loop, &writer_async, on_writer_async);
+    uv_async_init(writer_loop, &cleanup_async, on_cleanup_async);
+    {
+        util::LockGuard guard(&queue_mutex);
+        active = true;
+    }
+    threadManager.startTask("mo_writer");
+}
+
+void MOWriter::stop() {
+    size_t dropped;
+    {
+        util::LockGuard guard(&queue_mutex);
+        if (!active) return;
+        active = false;
+        full = false;
+        pending = 0;
+        dropped = queue.size();
+        queue.clear();
+    }
+    if (dropped > 0)
+        LOG(WARNING) << "Dropped " << dropped
+                     << " queued policy updates on stop";
+
+    uv_async_send(&cleanup_async);
+    threadManager.stopTask("mo_writer");
+}
+
+bool MOWriter::queueUpdates(vector<Op>& ops) {
+    if (ops.empty()) return false;
+    {
+        util::LockGuard guard(&queue_mutex);
+        if (active) {
+            pending += ops.size();
+            if (queue.empty())
+                queue.swap(ops);
+            else
+                queue.insert(queue.end(),
+                             std::make_move_iterator(ops.begin()),
+                             std::make_move_iterator(ops.end()));
+            ops.clear();
+            uv_async_send(&writer_async);
+            if (pending >= maxQueued)
+                full = true;
+            return full;
+        }
+    }
+
+    // not started, so there is no other writer to race with
+    if (client != NULL)
+        write(ops);
+    ops.clear();
+    return false;
+}
+
+void MOWriter::write(vector<Op>& ops) {
+    StoreClient::notif_t notifs;
+    vector<MOSerializer::DecodedMO> puts;
+    for (vector<Op>::iterator it = ops.begin(); ; ++it) {
+        if (it == ops.end() || it->remove) {
+            // write the run of objects before the removal together
+            if (!puts.empty()) {
+                serializer.apply(puts, *client, &notifs);
+                puts.clear();
+            }
+            if (it == ops.end()) break;
+            client->remove(it->mo.class_id, it->mo.uri, false, &notifs);
+            client->queueNotification(it->mo.class_id, it->mo.uri, notifs);
+        } else {
+            puts.push_back(std::move(it->mo));
+        }
+    }
+    client->deliverNotifications(notifs);
+}
+
+void MOWriter::on_writer_async(uv_async_t* handle) {
+    MOWriter* writer = static_cast<MOWriter*>(handle->data);
+
+    while (true) {
+        vector<Op> ops;
+        {
+            util::LockGuard guard(&writer->queue_mutex);
+            if (!writer->active || writer->queue.empty()) return;
+            ops.swap(writer->queue);
+        }
+
+        size_t count = ops.size();
+        try {
+            writer->write(ops);
+        } catch (const std::exception& ex) {
+            LOG(ERROR) << "Exception while writing policy updates: "
+                       << ex.what();
+        } catch (...) {
+            LOG(ERROR) << "Unknown error writing policy updates";
+        }
+
+        bool resume = false;
+        {
+            util::LockGuard guard(&writer->queue_mutex);
+            if (!writer->active) return;
+            writer->pending -= count;
+            if (writer->full && writer->pending <= writer->maxQueued / 2) {
+                writer->full = false;
+                resume = true;
+            }
+        }
+        if (resume && writer->resumeHandler)
+            writer->resumeHandler();
+    }
+}
+
+void MOWriter::on_cleanup_async(uv_async_t* handle) {
+    MOWriter* writer = static_cast<MOWriter*>(handle->data);
+    uv_close((uv_handle_t*)&writer->writer_async, NULL);
+    uv_close((uv_handle_t*)handle, NULL);
+}
+
+} /* namespace internal */
+} /* namespace engine */
+} /* namespace opflex */
@@ -55,6 +55,20 @@ void OpflexHandler::setState(ConnectionState state_) {
     }
 }
 
+bool OpflexHandler::hasFeature(const Value& data, const string& feature) {
+    if (!data.IsObject())
+        return false;
+    Value::ConstMemberIterator fitr = data.FindMember("features");
+    if (fitr == data.MemberEnd() || !fitr->value.IsArray())
+        return false;
+    for (Value::ConstValueIterator it = fitr->value.Begin();
+         it != fitr->value.End(); ++it) {
+        if (it->IsString() && feature == it->GetString())
+            return true;
+    }
+    return false;
+}
+
 void OpflexHandler::handleUnexpected(const string& type) {
     LOG(ERROR) << "Unexpected message of type " << type;
     conn->disconnect();
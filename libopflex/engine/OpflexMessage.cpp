@@ -30,6 +30,20 @@ void GenericOpflexMessage::serializePayload(yajr::rpc::SendHandler& writer) {
     (*this)(writer);
 }
 
+SerializedOpflexMessage::SerializedOpflexMessage(OpflexMessage& message)
+    : OpflexMessage(message.getMethod(), REQUEST),
+      xid(message.getReqXid()) {
+    yajr::internal::StringQueue buf;
+    yajr::rpc::SendHandler writer(buf);
+    message.serializePayload(writer);
+    payload = OF_MAKE_SHARED<const std::string>(buf.deque_.begin(),
+                                                buf.deque_.end());
+}
+
+void SerializedOpflexMessage::serializePayload(yajr::rpc::SendHandler& writer) {
+    writer.RawValue(payload->data(), payload->size(), rapidjson::kArrayType);
+}
+
 } /* namespace internal */
 } /* namespace engine */
 } /* namespace opflex */
@@ -57,10 +57,11 @@ public:
                     const string& domain_,
                     const optional<string>& location_,
                     const uint8_t roles_,
-                    const string& mac_)
+                    const string& mac_,
+                    bool compression_)
         : OpflexMessage("send_identity", REQUEST),
           name(name_), domain(domain_), location(location_), roles(roles_),
-          mac(mac_) {}
+          mac(mac_), compression(compression_) {}
 
     virtual void serializePayload(yajr::rpc::SendHandler& writer) {
         (*this)(writer);
@@ -106,6 +107,8 @@ public:
             writer.String("features");
             writer.StartArray();
             writer.String("anycastFallback");
+            if (compression)
+                writer.String("deflate");
             writer.EndArray();
             writer.EndObject();
         }
@@ -121,6 +124,7 @@ private:
     optional<string> location;
     uint8_t roles;
     string mac;
+    bool compression;
 };
 
 OpflexPEHandler::OpflexPEHandler(OpflexConnection* conn, Processor* processor_)
@@ -137,7 +141,8 @@ void OpflexPEHandler::connected() {
                             pool.getDomain(),
                             pool.getLocation(),
                             OFConstants::POLICY_ELEMENT,
-                            pool.getTunnelMac().toString());
+                            pool.getTunnelMac().toString(),
+                            getProcessor()->isCompressionEnabled());
     auto conn = (OpflexClientConnection*)getConnection();
     conn->getOpflexStats()->incrIdentReqs();
     conn->sendMessage(req, true);
@@ -148,6 +153,7 @@ void OpflexPEHandler::disconnected() {
     OpflexPool& pool = getProcessor()->getPool();
     auto conn = (OpflexClientConnection*)getConnection();
     pool.setRoles(conn, 0);
+    getProcessor()->connectionDisconnected(conn);
 }
 
 void OpflexPEHandler::ready() {
@@ -206,6 +212,12 @@ void OpflexPEHandler::handleSendIdentityRes(uint64_t reqId,
     if (payload.HasMember("data")) {
         const Value& data = payload["data"];
         if (data.IsObject()) {
+            if (getProcessor()->isCompressionEnabled() &&
+                hasFeature(data, "deflate")) {
+                LOG(INFO) << "[" << remotePeer << "] "
+                          << "Compressing outbound messages";
+                conn->getPeer()->enableCompression();
+            }
             if(isTransportMode && seekingProxies) {
                 address_v4 addr;
                 Value::ConstMemberIterator itr = data.FindMember("proxy_v4");
@@ -355,9 +367,8 @@ void OpflexPEHandler::handlePolicyResolveRes(uint64_t reqId,
     auto conn = (OpflexClientConnection*)getConnection();
     conn->getOpflexStats()->incrPolResolveResps();
     getProcessor()->responseReceived(reqId);
-    StoreClient* client = getProcessor()->getSystemClient();
     MOSerializer& serializer = getProcessor()->getSerializer();
-    StoreClient::notif_t notifs;
+    vector<MOWriter::Op> ops;
     if (payload.HasMember("policy")) {
         const Value& policy = payload["policy"];
         if (!policy.IsArray()) {
@@ -368,11 +379,12 @@ void OpflexPEHandler::handlePolicyResolveRes(uint64_t reqId,
 
         Value::ConstValueIterator it;
         for (it = policy.Begin(); it != policy.End(); ++it) {
-            const Value& mo = *it;
-            serializer.deserialize(mo, *client, true, &notifs);
+            ops.push_back(MOWriter::Op());
+            if (!serializer.decode(*it, true, ops.back().mo))
+                ops.pop_back();
         }
     }
-    client->deliverNotifications(notifs);
+    queueUpdates(ops);
 }
 
 void OpflexPEHandler::handlePolicyResolveErr(uint64_t reqId,
@@ -386,13 +398,13 @@ void OpflexPEHandler::handlePolicyUpdateReq(const rapidjson::Value& id,
                                             const rapidjson::Value& payload) {
     auto conn = (OpflexClientConnection*)getConnection();
     conn->getOpflexStats()->incrPolUpdates();
-    StoreClient* client = getProcessor()->getSystemClient();
     MOSerializer& serializer = getProcessor()->getSerializer();
-    StoreClient::notif_t notifs;
+    vector<MOWriter::Op> ops;
 
     Value::ConstValueIterator it;
     for (it = payload.Begin(); it != payload.End(); ++it) {
         if (!it->IsObject()) {
+            queueUpdates(ops);
             sendErrorRes(id, "ERROR",
                          "Malformed message: payload array contains a nonobject");
             return;
@@ -401,32 +413,37 @@ void OpflexPEHandler::handlePolicyUpdateReq(const rapidjson::Value& id,
         if (it->HasMember("replace")) {
             const Value& replace = (*it)["replace"];
             if (!replace.IsArray()) {
+                queueUpdates(ops);
                 sendErrorRes(id, "ERROR",
                              "Malformed message: replace is not an array");
                 return;
             }
             Value::ConstValueIterator it;
             for (it = replace.Begin(); it != replace.End(); ++it) {
-                const Value& mo = *it;
-                serializer.deserialize(mo, *client, true, &notifs);
+                ops.push_back(MOWriter::Op());
+                if (!serializer.decode(*it, true, ops.back().mo))
+                    ops.pop_back();
             }
         }
         if (it->HasMember("merge_children")) {
             const Value& merge = (*it)["merge_children"];
             if (!merge.IsArray()) {
+                queueUpdates(ops);
                 sendErrorRes(id, "ERROR",
                              "Malformed message: merge_children is not an array");
                 return;
             }
             Value::ConstValueIterator it;
             for (it = merge.Begin(); it != merge.End(); ++it) {
-                const Value& mo = *it;
-                serializer.deserialize(mo, *client, false, &notifs);
+                ops.push_back(MOWriter::Op());
+                if (!serializer.decode(*it, false, ops.back().mo))
+                    ops.pop_back();
             }
         }
         if (it->HasMember("delete")) {
             const Value& del = (*it)["delete"];
             if (!del.IsArray()) {
+                queueUpdates(ops);
                 sendErrorRes(id, "ERROR",
                              "Malformed message: delete is not an array");
                 return;
@@ -434,16 +451,19 @@ void OpflexPEHandler::handlePolicyUpdateReq(const rapidjson::Value& id,
             Value::ConstValueIterator dit;
             for (dit = del.Begin(); dit != del.End(); ++dit) {
                 if (!dit->IsObject()) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: delete contains a non-object");
                     return;
                 }
                 if (!dit->HasMember("subject")) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: subject missing from delete");
                     return;
                 }
                 if (!dit->HasMember("uri")) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: uri missing from delete");
                     return;
@@ -452,33 +472,38 @@ void OpflexPEHandler::handlePolicyUpdateReq(const rapidjson::Value& id,
                 const Value& subjectv = (*dit)["subject"];
                 const Value& puriv = (*dit)["uri"];
                 if (!subjectv.IsString()) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: subject is not a string");
                     return;
                 }
                 if (!puriv.IsString()) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: uri is not a string");
                     return;
                 }
 
-                try {
-                    const modb::ClassInfo& ci =
-                        getProcessor()->getStore()->getClassInfo(subjectv.GetString());
-                    modb::URI puri(puriv.GetString());
-                    client->remove(ci.getId(), puri, false, &notifs);
-                    client->queueNotification(ci.getId(), puri, notifs);
-                } catch (const std::out_of_range& e) {
+                const modb::ClassInfo* ci =
+                    getProcessor()->getStore()->
+                    findClassInfo(subjectv.GetString(),
+                                  subjectv.GetStringLength());
+                if (ci == NULL) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  std::string("Unknown subject: ") +
                                  subjectv.GetString());
                     return;
                 }
+                ops.push_back(MOWriter::Op());
+                ops.back().remove = true;
+                ops.back().mo.class_id = ci->getId();
+                ops.back().mo.uri = URI(puriv.GetString());
             }
         }
     }
 
-    client->deliverNotifications(notifs);
+    queueUpdates(ops);
 }
 
 void OpflexPEHandler::handlePolicyUnresolveRes(uint64_t reqId,
@@ -525,9 +550,8 @@ void OpflexPEHandler::handleEPUndeclareErr(uint64_t reqId,
 
 void OpflexPEHandler::handleEPResolveRes(uint64_t reqId,
                                          const rapidjson::Value& payload) {
-    StoreClient* client = getProcessor()->getSystemClient();
     MOSerializer& serializer = getProcessor()->getSerializer();
-    StoreClient::notif_t notifs;
+    vector<MOWriter::Op> ops;
     if (payload.HasMember("endpoint")) {
         const Value& endpoint = payload["endpoint"];
         if (!endpoint.IsArray()) {
@@ -538,11 +562,12 @@ void OpflexPEHandler::handleEPResolveRes(uint64_t reqId,
 
         Value::ConstValueIterator it;
         for (it = endpoint.Begin(); it != endpoint.End(); ++it) {
-            const Value& mo = *it;
-            serializer.deserialize(mo, *client, true, &notifs);
+            ops.push_back(MOWriter::Op());
+            if (!serializer.decode(*it, true, ops.back().mo))
+                ops.pop_back();
         }
     }
-    client->deliverNotifications(notifs);
+    queueUpdates(ops);
 }
 
 void OpflexPEHandler::handleEPUnresolveRes(uint64_t reqId,
@@ -552,13 +577,13 @@ void OpflexPEHandler::handleEPUnresolveRes(uint64_t reqId,
 
 void OpflexPEHandler::handleEPUpdateReq(const rapidjson::Value& id,
                                         const rapidjson::Value& payload) {
-    StoreClient* client = getProcessor()->getSystemClient();
     MOSerializer& serializer = getProcessor()->getSerializer();
-    StoreClient::notif_t notifs;
+    vector<MOWriter::Op> ops;
 
     Value::ConstValueIterator it;
     for (it = payload.Begin(); it != payload.End(); ++it) {
         if (!it->IsObject()) {
+            queueUpdates(ops);
             sendErrorRes(id, "ERROR",
                          "Malformed message: payload array contains a nonobject");
             return;
@@ -567,19 +592,22 @@ void OpflexPEHandler::handleEPUpdateReq(const rapidjson::Value& id,
         if (it->HasMember("replace")) {
             const Value& replace = (*it)["replace"];
             if (!replace.IsArray()) {
+                queueUpdates(ops);
                 sendErrorRes(id, "ERROR",
                              "Malformed message: replace is not an array");
                 return;
             }
             Value::ConstValueIterator it;
             for (it = replace.Begin(); it != replace.End(); ++it) {
-                const Value& mo = *it;
-                serializer.deserialize(mo, *client, true, &notifs);
+                ops.push_back(MOWriter::Op());
+                if (!serializer.decode(*it, true, ops.back().mo))
+                    ops.pop_back();
             }
         }
         if (it->HasMember("delete")) {
             const Value& del = (*it)["delete"];
             if (!del.IsArray()) {
+                queueUpdates(ops);
                 sendErrorRes(id, "ERROR",
                              "Malformed message: delete is not an array");
                 return;
@@ -587,16 +615,19 @@ void OpflexPEHandler::handleEPUpdateReq(const rapidjson::Value& id,
             Value::ConstValueIterator dit;
             for (dit = del.Begin(); dit != del.End(); ++dit) {
                 if (!dit->IsObject()) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: delete contains a non-object");
                     return;
                 }
                 if (!dit->HasMember("subject")) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: subject missing from delete");
                     return;
                 }
                 if (!dit->HasMember("uri")) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: uri missing from delete");
                     return;
@@ -605,33 +636,53 @@ void OpflexPEHandler::handleEPUpdateReq(const rapidjson::Value& id,
                 const Value& subjectv = (*dit)["subject"];
                 const Value& puriv = (*dit)["uri"];
                 if (!subjectv.IsString()) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: subject is not a string");
                     return;
                 }
                 if (!puriv.IsString()) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  "Malformed message: uri is not a string");
                     return;
                 }
 
-                try {
-                    const modb::ClassInfo& ci =
-                        getProcessor()->getStore()->getClassInfo(subjectv.GetString());
-                    modb::URI puri(puriv.GetString());
-                    client->remove(ci.getId(), puri, false, &notifs);
-                    client->queueNotification(ci.getId(), puri, notifs);
-                } catch (const std::out_of_range& e) {
+                const modb::ClassInfo* ci =
+                    getProcessor()->getStore()->
+                    findClassInfo(subjectv.GetString(),
+                                  subjectv.GetStringLength());
+                if (ci == NULL) {
+                    queueUpdates(ops);
                     sendErrorRes(id, "ERROR",
                                  std::string("Unknown subject: ") +
                                  subjectv.GetString());
                     return;
                 }
+                ops.push_back(MOWriter::Op());
+                ops.back().remove = true;
+                ops.back().mo.class_id = ci->getId();
+                ops.back().mo.uri = URI(puriv.GetString());
             }
         }
     }
 
-    client->deliverNotifications(notifs);
+    queueUpdates(ops);
+}
+
+void OpflexPEHandler::queueUpdates(vector<MOWriter::Op>& ops) {
+    if (!getProcessor()->getWriter().queueUpdates(ops))
+        return;
+    // The writer resumes reading through the pool loop, which is the
+    // loop we run on, so that cannot happen before we pause here
+    auto conn = (OpflexClientConnection*)getConnection();
+    conn->getOpflexStats()->incrReadPauses();
+    yajr::Peer* peer = conn->getPeer();
+    if (peer) {
+        LOG(DEBUG) << "[" << conn->getRemotePeer() << "] "
+                   << "Policy update queue full; pausing reads";
+        peer->pauseReading();
+    }
 }
 
 void OpflexPEHandler::handleStateReportRes(uint64_t reqId,
@@ -35,7 +35,7 @@ using yajr::transport::ZeroCopyOpenSSL;
 OpflexPool::OpflexPool(HandlerFactory& factory_,
                        util::ThreadManager& threadManager_)
     : factory(factory_), threadManager(threadManager_),
-      active(false),
+      primaryGeneration(0), active(false), primaryRouting(false),
       client_mode(OFConstants::OpflexElementMode::STITCHED_MODE),
       transport_state(OFConstants::OpflexTransportModeState::SEEKING_PROXIES),
       ipv4_proxy(0), ipv6_proxy(0),
@@ -115,6 +115,7 @@ void OpflexPool::on_cleanup_async(uv_async_t* handle) {
     }
 
     uv_close((uv_handle_t*)&pool->writeq_async, NULL);
+    uv_close((uv_handle_t*)&pool->resume_async, NULL);
     uv_close((uv_handle_t*)&pool->conn_async, NULL);
     uv_close((uv_handle_t*)handle, NULL);
     yajr::finiLoop(pool->client_loop);
@@ -129,6 +130,16 @@ void OpflexPool::on_writeq_async(uv_async_t* handle) {
     }
 }
 
+void OpflexPool::on_resume_async(uv_async_t* handle) {
+    OpflexPool* pool = (OpflexPool*)handle->data;
+    util::RecursiveLockGuard guard(&pool->conn_mutex,
+                                   &pool->conn_mutex_key);
+    BOOST_FOREACH(conn_map_t::value_type& v, pool->connections) {
+        yajr::Peer* peer = v.second.conn->getPeer();
+        if (peer) peer->resumeReading();
+    }
+}
+
 void OpflexPool::start() {
     if (active) return;
     active = true;
@@ -139,9 +150,11 @@ void OpflexPool::start() {
     conn_async.data = this;
     cleanup_async.data = this;
     writeq_async.data = this;
+    resume_async.data = this;
     uv_async_init(client_loop, &conn_async, on_conn_async);
     uv_async_init(client_loop, &cleanup_async, on_cleanup_async);
     uv_async_init(client_loop, &writeq_async, on_writeq_async);
+    uv_async_init(client_loop, &resume_async, on_resume_async);
 
     threadManager.startTask("connection_pool");
 }
@@ -290,8 +303,10 @@ void OpflexPool::updateRole(ConnData& cd,
         if (!(newroles & role)) {
             auto it = roles.find(role);
             if (it != roles.end()) {
-                if (it->second.curMaster == cd.conn)
+                if (it->second.curMaster == cd.conn) {
                     it->second.curMaster = NULL;
+                    primaryGeneration += 1;
+                }
                 it->second.conns.erase(cd.conn);
                 if (it->second.conns.empty())
                     roles.erase(it);
@@ -344,13 +359,21 @@ OpflexPool::getMasterForRole(OFConstants::OpflexRole role) {
         return it->second.curMaster;
     BOOST_FOREACH(OpflexClientConnection* conn, it->second.conns) {
         if (conn->isReady()) {
-            it->second.curMaster = conn;
+            if (it->second.curMaster != conn) {
+                it->second.curMaster = conn;
+                primaryGeneration += 1;
+            }
             return conn;
         }
     }
     return NULL;
 }
 
+uint64_t OpflexPool::getPrimaryGeneration() {
+    util::RecursiveLockGuard guard(&conn_mutex, &conn_mutex_key);
+    return primaryGeneration;
+}
+
 void OpflexPool::connectionClosed(OpflexClientConnection* conn) {
     util::RecursiveLockGuard guard(&conn_mutex, &conn_mutex_key);
 
@@ -370,6 +393,11 @@ void OpflexPool::messagesReady() {
     uv_async_send(&writeq_async);
 }
 
+void OpflexPool::resumeReading() {
+    if (active)
+        uv_async_send(&resume_async);
+}
+
 void incrementMsgCounter(OpflexClientConnection* conn, OpflexMessage* msg)
 {
     if (OpflexMessage::REQUEST == msg->getType()) {
@@ -417,6 +445,11 @@ size_t OpflexPool::sendToRole(OpflexMessage* message,
         if (!conn->isReady()) continue;
         ready.push_back(conn);
     }
+    if (ready.size() > 1) {
+        // serialize the payload once and share it between the copies
+        messagep.reset(new SerializedOpflexMessage(*message));
+        message = messagep.get();
+    }
     BOOST_FOREACH(OpflexClientConnection* conn, ready) {
         if (i < (ready.size() - 1)) {
             m_copy = message->clone();
@@ -434,6 +467,30 @@ size_t OpflexPool::sendToRole(OpflexMessage* message,
     return i;
 }
 
+size_t OpflexPool::sendToPrimary(OpflexMessage* message,
+                                 OFConstants::OpflexRole role,
+                                 bool sync) {
+    if (!primaryRouting)
+        return sendToRole(message, role, sync);
+
+#ifdef HAVE_CXX11
+    std::unique_ptr<OpflexMessage> messagep(message);
+#else
+    std::auto_ptr<OpflexMessage> messagep(message);
+#endif
+
+    if (!active) return 0;
+
+    util::RecursiveLockGuard guard(&conn_mutex, &conn_mutex_key);
+    OpflexClientConnection* conn = getMasterForRole(role);
+    if (conn == NULL)
+        return 0;
+
+    incrementMsgCounter(conn, message);
+    conn->sendMessage(messagep.release(), sync);
+    return 1;
+}
+
 void OpflexPool::validatePeerSet(OpflexClientConnection * conn, const peer_name_set_t& peers) {
     peer_name_set_t to_remove;
     util::RecursiveLockGuard guard(&conn_mutex, &conn_mutex_key);
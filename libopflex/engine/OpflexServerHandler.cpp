@@ -59,10 +59,12 @@ public:
                     const optional<std::string>& your_location_,
                     const uint8_t roles_,
                     const test::GbpOpflexServer::peer_vec_t& peers_,
-                    const std::vector<std::string>& proxies_)
+                    const std::vector<std::string>& proxies_,
+                    bool compression_)
         : OpflexMessage("send_identity", RESPONSE, &id),
           name(name_), domain(domain_), your_location(your_location_),
-          roles(roles_), peers(peers_), proxies(proxies_) {}
+          roles(roles_), peers(peers_), proxies(proxies_),
+          compression(compression_) {}
 
     virtual void serializePayload(yajr::rpc::SendHandler& writer) {
         (*this)(writer);
@@ -100,6 +102,12 @@ public:
                 writer.String(proxy.c_str());
                 i++;
             }
+            if (compression) {
+                writer.String("features");
+                writer.StartArray();
+                writer.String("deflate");
+                writer.EndArray();
+            }
             writer.EndObject();
         }
         writer.String("my_role");
@@ -144,6 +152,7 @@ private:
     uint8_t roles;
     test::GbpOpflexServer::peer_vec_t peers;
     std::vector<std::string> proxies;
+    bool compression;
 };
 
 class PolicyResolveRes : public OpflexMessage {
@@ -237,6 +246,9 @@ protected:
 void OpflexServerHandler::handleSendIdentityReq(const rapidjson::Value& id,
                                                 const Value& payload) {
     LOG(DEBUG) << "Got send_identity req";
+    bool compression = payload.IsArray() && payload.Size() > 0 &&
+        payload[0].IsObject() && payload[0].HasMember("data") &&
+        hasFeature(payload[0]["data"], "deflate");
     std::stringstream sb;
     sb << "127.0.0.1:" << server->getPort();
     SendIdentityRes* res =
@@ -244,8 +256,11 @@ void OpflexServerHandler::handleSendIdentityReq(const rapidjson::Value& id,
                             std::string("location_string"),
                             server->getRoles(),
                             server->getPeers(),
-                            server->getProxies());
+                            server->getProxies(),
+                            compression);
     getConnection()->sendMessage(res, true);
+    if (compression)
+        getConnection()->getPeer()->enableCompression();
     ready();
 }
 
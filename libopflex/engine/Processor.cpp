@@ -23,6 +23,7 @@
 
 #include <boost/tuple/tuple.hpp>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 #include "opflex/engine/internal/OpflexPEHandler.h"
 #include "opflex/engine/internal/ProcessorMessage.h"
 #include "opflex/engine/Processor.h"
@@ -62,11 +63,12 @@ Processor::Processor(ObjectStore* store_, ThreadManager& threadManager_)
     : AbstractObjectListener(store_),
       serializer(store_),
       threadManager(threadManager_),
-      pool(*this, threadManager_), nextXid(FIRST_XID),
+      pool(*this, threadManager_), writer(serializer, threadManager_),
+      nextXid(FIRST_XID),
       reportObservables(true),
       processingDelay(DEFAULT_PROC_DELAY),
       retryDelay(DEFAULT_RETRY_DELAY),
-      proc_active(false) {
+      proc_active(false), primaryGeneration(0) {
     uv_mutex_init(&item_mutex);
 }
 
@@ -225,9 +227,12 @@ bool Processor::isParentSyncObject(const item& item) {
 
 void Processor::sendToRole(const item& i, uint64_t& newexp,
                            OpflexMessage* req,
-                           ofcore::OFConstants::OpflexRole role) {
+                           ofcore::OFConstants::OpflexRole role,
+                           bool toPrimary) {
     uint64_t xid = req->getReqXid();
-    size_t pending = pool.sendToRole(req, role);
+    size_t pending = toPrimary
+        ? pool.sendToPrimary(req, role)
+        : pool.sendToRole(req, role);
     i.details->pending_reqs = pending;
 
     obj_state_by_uri& uri_index = obj_state.get<uri_tag>();
@@ -278,7 +283,8 @@ bool Processor::resolveObj(ClassInfo::class_type_t type, const item& i,
             refs.emplace_back(i.details->class_id, i.uri);
             PolicyResolveReq* req =
                 new PolicyResolveReq(this, nextXid++, refs);
-            sendToRole(i, newexp, req, OFConstants::POLICY_REPOSITORY);
+            sendToRole(i, newexp, req, OFConstants::POLICY_REPOSITORY,
+                       true);
             return true;
         }
         break;
@@ -290,7 +296,8 @@ bool Processor::resolveObj(ClassInfo::class_type_t type, const item& i,
             refs.emplace_back(i.details->class_id, i.uri);
             EndpointResolveReq* req =
                 new EndpointResolveReq(this, nextXid++, refs);
-            sendToRole(i, newexp, req, OFConstants::ENDPOINT_REGISTRY);
+            sendToRole(i, newexp, req, OFConstants::ENDPOINT_REGISTRY,
+                       true);
             return true;
         }
         break;
@@ -484,6 +491,8 @@ void Processor::processItem(obj_state_by_exp::iterator& it) {
                                it->uri,
                                &notifs);
 
+        // unresolves go to every peer even with primary routing, so
+        // a former primary does not keep the subscription
         switch (ci.getType()) {
         case ClassInfo::POLICY:
             if (it->details->resolve_time > 0) {
@@ -561,6 +570,11 @@ void Processor::connect_async_cb(uv_async_t* handle) {
     processor->handleNewConnections();
 }
 
+void Processor::primary_async_cb(uv_async_t* handle) {
+    Processor* processor = (Processor*)handle->data;
+    processor->handlePrimaryChange();
+}
+
 static void register_listeners(void* processor, const modb::ClassInfo& ci) {
     Processor* p = (Processor*)processor;
     p->listen(ci.getId());
@@ -577,6 +591,7 @@ void Processor::cleanup_async_cb(uv_async_t* handle) {
     uv_close((uv_handle_t*)&processor->proc_timer, NULL);
     uv_close((uv_handle_t*)&processor->proc_async, NULL);
     uv_close((uv_handle_t*)&processor->connect_async, NULL);
+    uv_close((uv_handle_t*)&processor->primary_async, NULL);
     uv_close((uv_handle_t*)handle, NULL);
 }
 
@@ -602,11 +617,15 @@ void Processor::start(ofcore::OFConstants::OpflexElementMode agent_mode) {
     uv_async_init(proc_loop, &proc_async, proc_async_cb);
     connect_async.data = this;
     uv_async_init(proc_loop, &connect_async, connect_async_cb);
+    primary_async.data = this;
+    uv_async_init(proc_loop, &primary_async, primary_async_cb);
     proc_timer.data = this;
     uv_timer_start(&proc_timer, &timer_callback,
                    processingDelay, processingDelay);
     threadManager.startTask("processor");
 
+    writer.setResumeHandler(boost::bind(&OpflexPool::resumeReading, &pool));
+    writer.start(client);
     pool.start();
 }
 
@@ -624,6 +643,8 @@ void Processor::stop() {
     uv_async_send(&cleanup_async);
     threadManager.stopTask("processor");
 
+    // the writer may resume reading on the pool
+    writer.stop();
     pool.stop();
 }
 
@@ -714,23 +735,66 @@ OpflexHandler* Processor::newHandler(OpflexConnection* conn) {
 }
 
 void Processor::handleNewConnections() {
-    util::LockGuard guard(&item_mutex);
-    BOOST_FOREACH(const item& i, obj_state) {
-        uint64_t newexp = 0;
-        const ClassInfo& ci = store->getClassInfo(i.details->class_id);
-        if (i.details->state == IN_SYNC) {
-            declareObj(ci.getType(), i, newexp);
-        }
-        if (i.details->state == RESOLVED) {
-            resolveObj(ci.getType(), i, newexp, false);
+    // with primary routing only a new primary needs the resolves
+    bool primaryRouting = pool.isPrimaryRouting();
+    {
+        util::LockGuard guard(&item_mutex);
+        BOOST_FOREACH(const item& i, obj_state) {
+            uint64_t newexp = 0;
+            const ClassInfo& ci = store->getClassInfo(i.details->class_id);
+            if (i.details->state == IN_SYNC) {
+                declareObj(ci.getType(), i, newexp);
+            }
+            if (i.details->state == RESOLVED && !primaryRouting) {
+                resolveObj(ci.getType(), i, newexp, false);
+            }
         }
     }
+    if (primaryRouting)
+        handlePrimaryChange();
+}
+
+void Processor::handlePrimaryChange() {
+    // choose the primaries now so that a new one shows up in the
+    // generation
+    pool.getMasterForRole(OFConstants::POLICY_REPOSITORY);
+    pool.getMasterForRole(OFConstants::ENDPOINT_REGISTRY);
+    uint64_t generation = pool.getPrimaryGeneration();
+
+    util::LockGuard guard(&item_mutex);
+    if (generation == primaryGeneration) return;
+    primaryGeneration = generation;
+
+    // Resolve everything again through the processing loop rather
+    // than all at once, so the new primary is brought up to date a
+    // batch at a time with the usual retries.  The resolve time is
+    // cleared since nothing was resolved on the new primary yet.
+    size_t count = 0;
+    obj_state_by_uri& uri_index = obj_state.get<uri_tag>();
+    obj_state_by_uri::iterator uit;
+    for (uit = uri_index.begin(); uit != uri_index.end(); ++uit) {
+        if (uit->details->state != RESOLVED) continue;
+        uit->details->resolve_time = 0;
+        uit->details->retry_count = 0;
+        uri_index.modify(uit, change_expiration(0));
+        count += 1;
+    }
+    if (count > 0) {
+        LOG(INFO) << "Primary connection changed; resolving "
+                  << count << " items again";
+        uv_async_send(&proc_async);
+    }
 }
 
 void Processor::connectionReady(OpflexConnection* conn) {
     uv_async_send(&connect_async);
 }
 
+void Processor::connectionDisconnected(OpflexConnection* conn) {
+    if (proc_active && pool.isPrimaryRouting())
+        uv_async_send(&primary_async);
+}
+
 void Processor::responseReceived(uint64_t reqId) {
     util::LockGuard guard(&item_mutex);
     obj_state_by_xid& xid_index = obj_state.get<xid_tag>();
@@ -16,6 +16,10 @@
 
 #include <string>
 
+#include <boost/scoped_ptr.hpp>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/prettywriter.h>
+
 #include "opflex/ofcore/InspectorClient.h"
 #include "opflex/modb/internal/ObjectStore.h"
 #include "opflex/engine/internal/InspectorClientHandler.h"
@@ -65,6 +69,13 @@ public:
      */
     internal::InspectorClientConn& getConn() { return conn; }
 
+    /**
+     * Get the number of objects to request per reply
+     *
+     * @return the page size, or 0 for unpaged queries
+     */
+    size_t getPageSize() const { return pageSize; }
+
     // ***************
     // InspectorClient
     // ***************
@@ -72,6 +83,12 @@ public:
     virtual void setFollowRefs(bool enabled);
     virtual void setRecursive(bool enabled);
     virtual void setUnresolved(bool enabled);
+    virtual void setPageSize(size_t objects);
+    virtual void setStreamOutput(std::ostream* output,
+                                 bool includeProps = true,
+                                 bool utf8 = true,
+                                 size_t truncate = 0);
+    virtual void setStreamDump(FILE* file);
     virtual void addQuery(const std::string& subject,
                           const modb::URI& uri);
     virtual void addClassQuery(const std::string& subject);
@@ -111,9 +128,33 @@ private:
     bool followRefs;
     bool recursive;
     bool unresolved;
+    size_t pageSize;
+
+    std::ostream* streamOutput;
+    bool streamProps;
+    bool streamUtf8;
+    size_t streamTruncate;
+
+    typedef rapidjson::PrettyWriter<rapidjson::FileWriteStream> dump_writer_t;
+    FILE* streamDump;
+    char dumpBuffer[1024];
+    boost::scoped_ptr<rapidjson::FileWriteStream> dumpStream;
+    boost::scoped_ptr<dump_writer_t> dumpWriter;
+
     friend class internal::InspectorClientHandler;
 
     void executeCommands();
+
+    /**
+     * Ask the server for the next page of a paged query
+     */
+    void requestNextPage(uint64_t cursor);
+
+    /**
+     * Called once the objects of a reply have been added to the
+     * store; renders and drops them when streaming
+     */
+    void pageReceived(const rapidjson::Value& policy);
 };
 
 } /* namespace engine */
@@ -31,6 +31,7 @@
 #include "opflex/engine/internal/OpflexPool.h"
 #include "opflex/engine/internal/OpflexHandler.h"
 #include "opflex/engine/internal/MOSerializer.h"
+#include "opflex/engine/internal/MOWriter.h"
 #include "opflex/engine/internal/AbstractObjectListener.h"
 
 #include "opflex/util/ThreadManager.h"
@@ -155,6 +156,11 @@ public:
      */
     internal::MOSerializer& getSerializer() { return serializer; }
 
+    /**
+     * Get the writer that applies policy updates to the store
+     */
+    internal::MOWriter& getWriter() { return writer; }
+
     /**
      * Get the MO serializer
      */
@@ -204,11 +210,36 @@ public:
         peerHandshakeTimeout = timeout;
     }
 
+    /**
+     * Whether to offer compressed frames to peers
+     */
+    bool isCompressionEnabled() const {
+        return compressionEnabled;
+    }
+
+    /**
+     * Offer compressed frames to peers during the handshake
+     */
+    void setCompression(bool enabled) {
+        compressionEnabled = enabled;
+    }
+
     /**
      * Set the prr timer duration in secs
      */
     uint64_t getPrrTimerDuration() { return prrTimerDuration; }
 
+    /**
+     * Send policy and endpoint resolves only to the primary
+     * connection for their role, keeping the other connections as
+     * backups
+     *
+     * @see internal::OpflexPool::setPrimaryRouting
+     */
+    void setPrimaryRouting(bool enabled) {
+        pool.setPrimaryRouting(enabled);
+    }
+
     // See HandlerFactory::newHandler
     virtual
     internal::OpflexHandler* newHandler(internal::OpflexConnection* conn);
@@ -225,6 +256,14 @@ public:
      */
     void connectionReady(internal::OpflexConnection* conn);
 
+    /**
+     * A client connection was disconnected, so with primary routing
+     * the resolver state may have to be synchronized to a new
+     * primary.
+     * @param conn the connection object
+     */
+    void connectionDisconnected(internal::OpflexConnection* conn);
+
     /**
      * Called when a response to a message sent from the processor is
      * received
@@ -283,6 +322,11 @@ private:
      */
     internal::OpflexPool pool;
 
+    /**
+     * Writes received policy updates to the store
+     */
+    internal::MOWriter writer;
+
     /**
      * Request ID counter
      */
@@ -509,6 +553,7 @@ private:
     uint64_t prrTimerDuration = DEFAULT_PRR_TIMER_DURATION;
 
     uint32_t peerHandshakeTimeout = 45000;
+    bool compressionEnabled = false;
 
     /**
      *  policy refresh timer duration in msecs
@@ -523,12 +568,19 @@ private:
     uv_async_t cleanup_async;
     uv_async_t proc_async;
     uv_async_t connect_async;
+    uv_async_t primary_async;
     uv_timer_t proc_timer;
 
+    /**
+     * The pool primary generation that resolves were last sent for
+     */
+    uint64_t primaryGeneration;
+
     static void timer_callback(uv_timer_t* handle);
     static void cleanup_async_cb(uv_async_t *handle);
     static void proc_async_cb(uv_async_t *handle);
     static void connect_async_cb(uv_async_t *handle);
+    static void primary_async_cb(uv_async_t *handle);
 
     bool hasWork(/* out */ obj_state_by_exp::iterator& it);
     void addRef(obj_state_by_exp::iterator& it,
@@ -541,12 +593,14 @@ private:
     void doProcess();
     void sendToRole(const item& it, uint64_t& newexp,
                     internal::OpflexMessage* req,
-                    ofcore::OFConstants::OpflexRole role);
+                    ofcore::OFConstants::OpflexRole role,
+                    bool toPrimary = false);
     bool resolveObj(modb::ClassInfo::class_type_t type, const item& it,
                     uint64_t& newexp, bool checkTime = true);
     bool declareObj(modb::ClassInfo::class_type_t type, const item& it,
                     uint64_t& newexp);
     void handleNewConnections();
+    void handlePrimaryChange();
 };
 
 } /* namespace engine */
@@ -16,11 +16,14 @@
 #define OPFLEX_ENGINE_INSPECTORSERVERHANDLER_H
 
 #include <string>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <rapidjson/document.h>
 
 #include "opflex/engine/internal/OpflexHandler.h"
+#include "opflex/modb/mo-internal/ObjectInstance.h"
+#include "opflex/ofcore/OFTypes.h"
 
 namespace opflex {
 namespace engine {
@@ -44,7 +47,7 @@ public:
      */
     InspectorServerHandler(OpflexConnection* conn_,
                            Inspector* inspector_)
-        : OpflexHandler(conn_), inspector(inspector_) {}
+        : OpflexHandler(conn_), inspector(inspector_), nextCursor(1) {}
 
     /**
      * Destroy the handler
@@ -56,6 +59,16 @@ public:
      */ 
     static const std::string POLICY_QUERY;
 
+    /**
+     * Largest page a client can ask for, in managed objects
+     */
+    static const size_t MAX_PAGE_SIZE = 10000;
+
+    /**
+     * Number of paged queries a single client can have open at once
+     */
+    static const size_t MAX_CURSORS = 16;
+
     // *************
     // OpflexHandler
     // *************
@@ -73,6 +86,26 @@ protected:
 
     virtual void handlePolicyQueryReq(const rapidjson::Value& id,
                                       const rapidjson::Value& payload);
+
+private:
+    /**
+     * The remaining work of a paged query: the objects still to be
+     * sent, as a stack whose top is sent next.  For a recursive query
+     * the children of each object are pushed as it is sent, so the
+     * stack only ever holds the frontier of the walk rather than the
+     * whole result set.
+     */
+    struct QueryCursor {
+        std::vector<modb::reference_t> pending;
+        bool recursive;
+    };
+    typedef OF_UNORDERED_MAP<uint64_t, QueryCursor> cursor_map_t;
+
+    cursor_map_t cursors;
+    uint64_t nextCursor;
+
+    void sendPage(const rapidjson::Value& id, uint64_t cursorId,
+                  size_t pageSize);
 };
 
 } /* namespace internal */
@@ -52,6 +52,35 @@ public:
                                          gbp::PolicyUpdateOp op) = 0;
     };
 
+    /**
+     * A managed object decoded from its JSON form, which can be
+     * written to the store later and from another thread
+     */
+    struct DecodedMO {
+        DecodedMO()
+            : class_id(0), uri(""), has_parent(false), parent_class(0),
+              parent_prop(0), parent_uri(""), replace_children(false) {}
+
+        /** the class ID of the object */
+        modb::class_id_t class_id;
+        /** the URI of the object */
+        modb::URI uri;
+        /** the object instance to write */
+        OF_SHARED_PTR<modb::mointernal::ObjectInstance> oi;
+        /** whether the object should be added to a parent */
+        bool has_parent;
+        /** the class ID of the parent */
+        modb::class_id_t parent_class;
+        /** the parent property holding the object */
+        modb::prop_id_t parent_prop;
+        /** the URI of the parent */
+        modb::URI parent_uri;
+        /** delete any children not in children */
+        bool replace_children;
+        /** the URIs of the children of the object */
+        OF_UNORDERED_SET<std::string> children;
+    };
+
     /**
      * Allocate a new managed object serializer
      */
@@ -385,6 +414,51 @@ public:
                      /* out */
                      modb::mointernal::StoreClient::notif_t* notifs = NULL);
 
+    /**
+     * Decode a managed object from the JSON value without touching
+     * the store, so that it can be applied later.
+     *
+     * @param mo the JSON value to decode
+     * @param replaceChildren if true, delete any children not present
+     * in the list of child URIs when the object is applied
+     * @param dmo the decoded object
+     * @return false if the object is malformed or of an unknown class
+     */
+    bool decode(const rapidjson::Value& mo,
+                bool replaceChildren,
+                /* out */ DecodedMO& dmo);
+
+    /**
+     * Write a decoded managed object to the store
+     *
+     * @param dmo the decoded object
+     * @param client the store client where we should write the output
+     * @param notifs an optional map that will hold update
+     * notifications that should be dispatched as a result of this
+     * change.
+     */
+    void apply(const DecodedMO& dmo,
+               modb::mointernal::StoreClient& client,
+               /* out */
+               modb::mointernal::StoreClient::notif_t* notifs = NULL);
+
+    /**
+     * Write a sequence of decoded managed objects to the store, with
+     * the same result as applying them one at a time.  The objects
+     * are put with a single batch operation per region, and then
+     * linked to their parents in order.
+     *
+     * @param dmos the decoded objects
+     * @param client the store client where we should write the output
+     * @param notifs an optional map that will hold update
+     * notifications that should be dispatched as a result of this
+     * change.
+     */
+    void apply(const std::vector<DecodedMO>& dmos,
+               modb::mointernal::StoreClient& client,
+               /* out */
+               modb::mointernal::StoreClient::notif_t* notifs = NULL);
+
     /**
      * Dump the managed object database to the file specified as a
      * JSON blob.
@@ -509,14 +583,12 @@ private:
     /**
      * Deserialize a reference
      *
-     * @param client the store client
      * @param pinfo the property info for the reference
      * @param v the value containing the reference
      * @param oi the object instance where we'll store the result
      * @param scalar true if this is a scalar-valued reference
      */
-    void deserialize_ref(modb::mointernal::StoreClient& client,
-                         const modb::PropertyInfo& pinfo,
+    void deserialize_ref(const modb::PropertyInfo& pinfo,
                          const rapidjson::Value& v,
                          modb::mointernal::ObjectInstance& oi,
                          bool scalar);
@@ -524,12 +596,24 @@ private:
     /**
      * Deserialize an enum
      */
-    static void deserialize_enum(modb::mointernal::StoreClient& client,
-                                const modb::PropertyInfo& pinfo,
+    static void deserialize_enum(const modb::PropertyInfo& pinfo,
                                 const rapidjson::Value& v,
                                 modb::mointernal::ObjectInstance& oi,
                                 bool scalar);
 
+    /**
+     * Link an object that was just put to its parent and remove its
+     * missing children
+     *
+     * @param dmo the decoded object
+     * @param updated whether the put modified the object
+     * @param client the store client
+     * @param notifs the notifications to add to
+     */
+    void finishApply(const DecodedMO& dmo, bool updated,
+                     modb::mointernal::StoreClient& client,
+                     modb::mointernal::StoreClient::notif_t* notifs);
+
     /**
      * Display a particular object
      */
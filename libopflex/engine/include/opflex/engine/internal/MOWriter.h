@@ -0,0 +1,139 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*!
+ * @file MOWriter.h
+ * @brief Interface definition file for MOWriter
+ */
+/*
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEX_ENGINE_MOWRITER_H
+#define OPFLEX_ENGINE_MOWRITER_H
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <uv.h>
+
+#include "opflex/engine/internal/MOSerializer.h"
+#include "opflex/modb/mo-internal/StoreClient.h"
+#include "opflex/util/ThreadManager.h"
+
+namespace opflex {
+namespace engine {
+namespace internal {
+
+/**
+ * A bounded queue of decoded managed object updates, which a
+ * dedicated thread writes to the store.  Connection threads decode
+ * policy updates and queue them here, so a large policy resolve does
+ * not hold up the connection loop while it is written, and
+ * consecutive updates are written with combined region operations.
+ */
+class MOWriter : private boost::noncopyable {
+public:
+    /**
+     * One update to the store
+     */
+    struct Op {
+        Op() : remove(false) {}
+
+        /**
+         * if true, remove the object with the class and URI of mo
+         * instead of writing it
+         */
+        bool remove;
+
+        /** the decoded object */
+        MOSerializer::DecodedMO mo;
+    };
+
+    /**
+     * A function to call when the queue drains after it was full
+     */
+    typedef boost::function<void ()> resume_fn_t;
+
+    /**
+     * Construct a new writer
+     *
+     * @param serializer the serializer that decoded the updates
+     * @param threadManager the thread manager for the writer thread
+     */
+    MOWriter(MOSerializer& serializer, util::ThreadManager& threadManager);
+    ~MOWriter();
+
+    /**
+     * Set the number of queued objects at which the queue is full.
+     * Updates are still accepted beyond this, but the caller should
+     * stop reading more until the resume handler is called.
+     *
+     * @param maxQueued the number of objects
+     */
+    void setMaxQueued(size_t maxQueued);
+
+    /**
+     * Set the function to call when the queue drains to half of its
+     * limit after it was full.  It is called on the writer thread.
+     *
+     * @param resumeHandler the function to call
+     */
+    void setResumeHandler(const resume_fn_t& resumeHandler);
+
+    /**
+     * Start the writer thread
+     *
+     * @param client the store client to write to
+     */
+    void start(modb::mointernal::StoreClient* client);
+
+    /**
+     * Stop the writer thread, dropping any queued updates.  The
+     * store is being torn down, and a restarted processor resolves
+     * its policy again.
+     */
+    void stop();
+
+    /**
+     * Queue updates to be written in order.  If the writer is not
+     * running they are written before returning.
+     *
+     * @param ops the updates, which are moved out of the vector
+     * @return true if the queue is now full
+     */
+    bool queueUpdates(std::vector<Op>& ops);
+
+private:
+    MOSerializer& serializer;
+    util::ThreadManager& threadManager;
+    modb::mointernal::StoreClient* client;
+    resume_fn_t resumeHandler;
+    size_t maxQueued;
+
+    uv_loop_t* writer_loop;
+    uv_async_t writer_async;
+    uv_async_t cleanup_async;
+
+    uv_mutex_t queue_mutex;
+    bool active;
+    bool full;
+    std::vector<Op> queue;
+    // queued plus being written
+    size_t pending;
+
+    void write(std::vector<Op>& ops);
+
+    static void on_writer_async(uv_async_t* handle);
+    static void on_cleanup_async(uv_async_t* handle);
+};
+
+} /* namespace internal */
+} /* namespace engine */
+} /* namespace opflex */
+
+#endif /* OPFLEX_ENGINE_MOWRITER_H */
@@ -538,6 +538,17 @@ protected:
      */
     void setState(ConnectionState state);
 
+    /**
+     * Check whether the "features" array of the data object of an
+     * identity message lists the given feature
+     *
+     * @param data the "data" member of the identity message
+     * @param feature the feature name to look for
+     * @return true if the feature is listed
+     */
+    static bool hasFeature(const rapidjson::Value& data,
+                           const std::string& feature);
+
     /**
      * The OpflexConnection associated with the handler
      */
@@ -20,6 +20,7 @@
 
 #include "opflex/yajr/rpc/message_factory.hpp"
 #include "opflex/rpc/JsonRpcMessage.h"
+#include "opflex/ofcore/OFTypes.h"
 
 #pragma once
 #ifndef OPFLEX_ENGINE_OPFLEXMESSAGE_H
@@ -94,6 +95,47 @@ public:
 
 };
 
+/**
+ * A request whose payload was serialized once up front, so that it
+ * can be sent to several peers without serializing it for each of
+ * them.  Clones share the serialized payload, and only the request
+ * ID is written separately for each connection.
+ */
+class SerializedOpflexMessage : public OpflexMessage {
+public:
+    /**
+     * Serialize the payload of the given request
+     *
+     * @param message the request to serialize
+     */
+    explicit SerializedOpflexMessage(OpflexMessage& message);
+
+    /**
+     * Destroy the message
+     */
+    virtual ~SerializedOpflexMessage() {}
+
+    /**
+     * Clone the opflex message, sharing the serialized payload
+     */
+    virtual SerializedOpflexMessage* clone() {
+        return new SerializedOpflexMessage(*this);
+    }
+
+    virtual void serializePayload(yajr::rpc::SendHandler& writer);
+
+    virtual uint64_t getReqXid() { return xid; }
+
+    /**
+     * Get the serialized payload
+     */
+    const std::string& getPayload() const { return *payload; }
+
+private:
+    uint64_t xid;
+    OF_SHARED_PTR<const std::string> payload;
+};
+
 } /* namespace internal */
 } /* namespace engine */
 } /* namespace opflex */
@@ -12,10 +12,12 @@
  */
 
 #include <string>
+#include <vector>
 
 #include <rapidjson/document.h>
 
 #include "opflex/engine/internal/OpflexHandler.h"
+#include "opflex/engine/internal/MOWriter.h"
 
 #pragma once
 #ifndef OPFLEX_ENGINE_OPFLEXPEHANDLER_H
@@ -94,6 +96,12 @@ public:
 
 private:
     Processor* processor;
+
+    /**
+     * Queue decoded updates to be written to the store, and stop
+     * reading from the connection if the queue is full
+     */
+    void queueUpdates(std::vector<MOWriter::Op>& ops);
 };
 
 } /* namespace internal */
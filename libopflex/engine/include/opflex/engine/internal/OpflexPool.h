@@ -142,6 +142,13 @@ public:
      */
     void stop();
 
+    /**
+     * Resume reading from any connections that stopped reading
+     * because the policy update queue was full.  This can be called
+     * from any thread.
+     */
+    void resumeReading();
+
     /**
      * Enable SSL for connections to opflex peers
      *
@@ -243,6 +250,52 @@ public:
                       ofcore::OFConstants::OpflexRole role,
                       bool sync = false);
 
+    /**
+     * Send a given message only to the primary connection for the
+     * given role when primary routing is enabled, or otherwise to
+     * all the connected and ready peers with the role as sendToRole
+     * does.  This message can be called from any thread.
+     *
+     * @param message the message to write.  The memory will be owned by the pool.
+     * @param role the role to which the message should be sent
+     * @param sync if true then this is being called from the libuv
+     * thread
+     * @return the number of ready connections to which we sent the message
+     * @see getMasterForRole
+     */
+    size_t sendToPrimary(OpflexMessage* message,
+                         ofcore::OFConstants::OpflexRole role,
+                         bool sync = false);
+
+    /**
+     * Send resolve requests only to the primary connection for their
+     * role instead of to every ready connection.  The other
+     * connections with the role are kept as backups, and take over
+     * when the primary is lost.
+     *
+     * @param primaryRouting true to send to the primary only
+     */
+    void setPrimaryRouting(bool primaryRouting_) {
+        primaryRouting = primaryRouting_;
+    }
+
+    /**
+     * Check whether resolve requests are sent to the primary
+     * connection only
+     *
+     * @return true if primary routing is enabled
+     */
+    bool isPrimaryRouting() { return primaryRouting; }
+
+    /**
+     * Get a counter that changes whenever the primary connection for
+     * any role is lost or a new one is chosen.  Requests that went
+     * only to the primary must be sent again when it changes.
+     *
+     * @return the primary generation
+     */
+    uint64_t getPrimaryGeneration();
+
     /**
      * Get the number of connections in a particular role
      *
@@ -383,7 +436,9 @@ private:
     peer_name_set_t configured_peers;
     conn_map_t connections;
     role_map_t roles;
+    uint64_t primaryGeneration;
     boost::atomic<bool> active;
+    boost::atomic<bool> primaryRouting;
 
     opflex::ofcore::OFConstants::OpflexElementMode client_mode;
     opflex::ofcore::OFConstants::OpflexTransportModeState transport_state;
@@ -396,6 +451,7 @@ private:
     uv_async_t conn_async;
     uv_async_t cleanup_async;
     uv_async_t writeq_async;
+    uv_async_t resume_async;
 
     std::list<ofcore::PeerStatusListener*> peerStatusListeners;
     ofcore::PeerStatusListener::Health curHealth;
@@ -413,6 +469,7 @@ private:
     static void on_conn_async(uv_async_t *handle);
     static void on_cleanup_async(uv_async_t *handle);
     static void on_writeq_async(uv_async_t *handle);
+    static void on_resume_async(uv_async_t *handle);
 
     void updatePeerStatus(const std::string& hostname, int port,
                           ofcore::PeerStatusListener::PeerStatus status);
@@ -267,6 +267,70 @@ BOOST_FIXTURE_TEST_CASE( mo_deserialize , BaseFixture ) {
     serializer.readMOs(moFile, sysClient);
 }
 
+BOOST_FIXTURE_TEST_CASE( mo_decode_apply , BaseFixture ) {
+    StoreClient::notif_t notifs;
+
+    static const char buffer[] =
+        "[{\"subject\":\"class1\",\"uri\":\"/\",\"properties\":[{\"na"
+        "me\":\"prop1\",\"data\":42}],\"children\":[\"/class2/-84\",\"/c"
+        "lass2/-42\"]},{\"subject\":\"class2\",\"uri\":\"/class2/-84\",\""
+        "properties\":[{\"name\":\"prop4\",\"data\":-84}],\"children\":["
+        "],\"parent_subject\":\"class1\",\"parent_uri\":\"/\",\"parent_"
+        "relation\":\"class2\"},{\"subject\":\"class2\",\"uri\":\"/clas"
+        "s2/-42\",\"properties\":[{\"name\":\"prop4\",\"data\":-42}],\"c"
+        "hildren\":[],\"parent_subject\":\"class1\",\"parent_uri\":\"/\""
+        ",\"parent_relation\":\"class2\"},{\"subject\":\"unknown\",\"uri"
+        "\":\"/\"}]";
+
+    MOSerializer serializer(&db);
+    StoreClient& sysClient = db.getStoreClient("_SYSTEM_");
+    Document d;
+    d.Parse(buffer);
+    std::vector<MOSerializer::DecodedMO> dmos(d.Size());
+    for (SizeType i = 0; i < d.Size(); ++i) {
+        // the last object is of an unknown class
+        BOOST_CHECK_EQUAL(i < 3, serializer.decode(d[i], true, dmos[i]));
+    }
+    dmos.pop_back();
+
+    // decoding does not touch the store
+    URI uri("/");
+    URI uri2("/class2/-42");
+    URI uri3("/class2/-84");
+    BOOST_CHECK(!sysClient.isPresent(1, uri));
+
+    serializer.apply(dmos, sysClient, &notifs);
+    BOOST_CHECK_EQUAL(42, sysClient.get(1, uri)->getUInt64(1));
+    BOOST_CHECK_EQUAL(-42, sysClient.get(2, uri2)->getInt64(4));
+    BOOST_CHECK_EQUAL(-84, sysClient.get(2, uri3)->getInt64(4));
+    std::vector<URI> children;
+    sysClient.getChildren(2, uri, 3, 2, children);
+    BOOST_CHECK_EQUAL(2, children.size());
+    children.clear();
+    BOOST_CHECK(notifs.find(uri) != notifs.end());
+    BOOST_CHECK(notifs.find(uri2) != notifs.end());
+    BOOST_CHECK(notifs.find(uri3) != notifs.end());
+    notifs.clear();
+
+    // the parent drops a child that a later object in the same batch
+    // puts back, as it would be when applied one at a time
+    static const char buffer2[] =
+        "{\"subject\":\"class1\",\"uri\":\"/\",\"properties\":[{\"nam"
+        "e\":\"prop1\",\"data\":84}],\"children\":[\"/class2/-84\"]}";
+    Document d2;
+    d2.Parse(buffer2);
+    std::vector<MOSerializer::DecodedMO> dmos2(2);
+    BOOST_CHECK(serializer.decode(d2, true, dmos2[0]));
+    BOOST_CHECK(serializer.decode(d[SizeType(2)], true, dmos2[1]));
+    serializer.apply(dmos2, sysClient, &notifs);
+    BOOST_CHECK_EQUAL(84, sysClient.get(1, uri)->getUInt64(1));
+    BOOST_CHECK_EQUAL(-42, sysClient.get(2, uri2)->getInt64(4));
+    sysClient.getChildren(2, uri, 3, 2, children);
+    BOOST_CHECK_EQUAL(2, children.size());
+    BOOST_CHECK(notifs.find(uri) != notifs.end());
+    BOOST_CHECK(notifs.find(uri2) != notifs.end());
+}
+
 BOOST_FIXTURE_TEST_CASE( types , BaseFixture ) {
     MOSerializer serializer(&db);
     StringBuffer buffer;
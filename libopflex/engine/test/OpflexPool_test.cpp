@@ -19,6 +19,7 @@
 
 #include "opflex/ofcore/OFConstants.h"
 #include "opflex/engine/internal/OpflexPool.h"
+#include "opflex/engine/internal/OpflexMessage.h"
 
 using namespace opflex::engine;
 using namespace opflex::engine::internal;
@@ -54,8 +55,33 @@ public:
     virtual void close() {
         closed = true;
     }
+    virtual void sendMessage(OpflexMessage* message, bool sync) {
+        sent.push_back(OF_SHARED_PTR<OpflexMessage>(message));
+    }
     bool ready;
     bool closed;
+    std::vector<OF_SHARED_PTR<OpflexMessage> > sent;
+};
+
+class CountingMessage : public OpflexMessage {
+public:
+    CountingMessage(int& count_)
+        : OpflexMessage("endpoint_declare", REQUEST), count(count_) {}
+
+    virtual CountingMessage* clone() {
+        return new CountingMessage(*this);
+    }
+
+    virtual void serializePayload(yajr::rpc::SendHandler& writer) {
+        count += 1;
+        writer.StartArray();
+        writer.String("payload");
+        writer.EndArray();
+    }
+
+    virtual uint64_t getReqXid() { return 42; }
+
+    int& count;
 };
 
 class PoolFixture {
@@ -164,4 +190,115 @@ BOOST_FIXTURE_TEST_CASE( manage_ivxlan_roles , PoolFixture ) {
     c3->disconnect();
 }
 
+BOOST_FIXTURE_TEST_CASE( send_to_role , PoolFixture ) {
+    MockClientConn* c1 = new MockClientConn(handlerFactory, &pool,
+                                            "1.2.3.4", 1234);
+    MockClientConn* c2 = new MockClientConn(handlerFactory, &pool,
+                                            "1.2.3.4", 1235);
+    MockClientConn* c3 = new MockClientConn(handlerFactory, &pool,
+                                            "1.2.3.4", 1236);
+    pool.addPeer(c1);
+    pool.addPeer(c2);
+    pool.addPeer(c3);
+    pool.setRoles(c1, OFConstants::ENDPOINT_REGISTRY);
+    pool.setRoles(c2, OFConstants::ENDPOINT_REGISTRY);
+    pool.setRoles(c3, OFConstants::ENDPOINT_REGISTRY);
+    c3->ready = false;
+
+    // a single ready peer gets the message itself
+    int count = 0;
+    c2->ready = false;
+    BOOST_CHECK_EQUAL(1, pool.sendToRole(new CountingMessage(count),
+                                         OFConstants::ENDPOINT_REGISTRY));
+    BOOST_REQUIRE_EQUAL(1, c1->sent.size());
+    BOOST_CHECK(dynamic_cast<CountingMessage*>(c1->sent[0].get()));
+    BOOST_CHECK_EQUAL(0, count);
+    c1->sent.clear();
+
+    // several ready peers share one serialized payload
+    c2->ready = true;
+    BOOST_CHECK_EQUAL(2, pool.sendToRole(new CountingMessage(count),
+                                         OFConstants::ENDPOINT_REGISTRY));
+    BOOST_CHECK_EQUAL(1, count);
+    BOOST_REQUIRE_EQUAL(1, c1->sent.size());
+    BOOST_REQUIRE_EQUAL(1, c2->sent.size());
+    SerializedOpflexMessage* m1 =
+        dynamic_cast<SerializedOpflexMessage*>(c1->sent[0].get());
+    SerializedOpflexMessage* m2 =
+        dynamic_cast<SerializedOpflexMessage*>(c2->sent[0].get());
+    BOOST_REQUIRE(m1 != NULL && m2 != NULL);
+    BOOST_CHECK_EQUAL(&m1->getPayload(), &m2->getPayload());
+    BOOST_CHECK_EQUAL("[\"payload\"]", m1->getPayload());
+    BOOST_CHECK_EQUAL("endpoint_declare", m2->getMethod());
+    BOOST_CHECK_EQUAL(42, m2->getReqXid());
+
+    yajr::internal::StringQueue buf;
+    yajr::rpc::SendHandler writer(buf);
+    m2->serializePayload(writer);
+    BOOST_CHECK_EQUAL(m1->getPayload(),
+                      std::string(buf.deque_.begin(), buf.deque_.end()));
+    BOOST_CHECK_EQUAL(1, count);
+
+    c1->disconnect();
+    c2->disconnect();
+    c3->disconnect();
+}
+
+BOOST_FIXTURE_TEST_CASE( send_to_primary , PoolFixture ) {
+    MockClientConn* c1 = new MockClientConn(handlerFactory, &pool,
+                                            "1.2.3.4", 1234);
+    MockClientConn* c2 = new MockClientConn(handlerFactory, &pool,
+                                            "1.2.3.4", 1235);
+    pool.addPeer(c1);
+    pool.addPeer(c2);
+    pool.setRoles(c1, OFConstants::POLICY_REPOSITORY);
+    pool.setRoles(c2, OFConstants::POLICY_REPOSITORY);
+
+    // every ready peer gets the message unless primary routing is on
+    int count = 0;
+    BOOST_CHECK_EQUAL(2, pool.sendToPrimary(new CountingMessage(count),
+                                            OFConstants::POLICY_REPOSITORY));
+    BOOST_CHECK_EQUAL(1, c1->sent.size());
+    BOOST_CHECK_EQUAL(1, c2->sent.size());
+    c1->sent.clear();
+    c2->sent.clear();
+
+    pool.setPrimaryRouting(true);
+    uint64_t generation = pool.getPrimaryGeneration();
+    BOOST_CHECK_EQUAL(1, pool.sendToPrimary(new CountingMessage(count),
+                                            OFConstants::POLICY_REPOSITORY));
+    MockClientConn* primary = (MockClientConn*)
+        pool.getMasterForRole(OFConstants::POLICY_REPOSITORY);
+    MockClientConn* backup = primary == c1 ? c2 : c1;
+    BOOST_CHECK_EQUAL(1, primary->sent.size());
+    BOOST_CHECK_EQUAL(0, backup->sent.size());
+    BOOST_CHECK(generation != pool.getPrimaryGeneration());
+
+    // the backup takes over when the primary is not ready
+    generation = pool.getPrimaryGeneration();
+    primary->ready = false;
+    BOOST_CHECK_EQUAL(1, pool.sendToPrimary(new CountingMessage(count),
+                                            OFConstants::POLICY_REPOSITORY));
+    BOOST_CHECK_EQUAL(1, primary->sent.size());
+    BOOST_CHECK_EQUAL(1, backup->sent.size());
+    BOOST_CHECK(generation != pool.getPrimaryGeneration());
+
+    // and stays primary when the old one comes back
+    generation = pool.getPrimaryGeneration();
+    primary->ready = true;
+    BOOST_CHECK_EQUAL(backup,
+                      pool.getMasterForRole(OFConstants::POLICY_REPOSITORY));
+    BOOST_CHECK_EQUAL(generation, pool.getPrimaryGeneration());
+
+    // losing the primary's role changes the generation as well
+    pool.setRoles(backup, 0);
+    BOOST_CHECK(generation != pool.getPrimaryGeneration());
+    BOOST_CHECK_EQUAL(primary,
+                      pool.getMasterForRole(OFConstants::POLICY_REPOSITORY));
+
+    BOOST_CHECK_EQUAL(0, count);
+    c1->disconnect();
+    c2->disconnect();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -644,6 +644,91 @@ BOOST_FIXTURE_TEST_CASE( policy_resolve_reconnect, PolicyFixture ) {
     BOOST_CHECK_EQUAL("test2", client2->get(6, c6u)->getString(13));
 }
 
+// test policy resolve and update over a compressed connection
+BOOST_FIXTURE_TEST_CASE( policy_resolve_compressed, PolicyFixture ) {
+    processor.setCompression(true);
+    startClient();
+    WAIT_FOR(connReady(processor.getPool(), LOCALHOST, 8009), 1000);
+    setup();
+
+    WAIT_FOR(itemPresent(client2, 4, c4u), 1000);
+    WAIT_FOR(itemPresent(client2, 6, c6u), 1000);
+    BOOST_CHECK_EQUAL("test", client2->get(4, c4u)->getString(9));
+    BOOST_CHECK_EQUAL("test2", client2->get(6, c6u)->getString(13));
+
+    vector<reference_t> replace;
+    vector<reference_t> merge;
+    vector<reference_t> del;
+
+    for (int i = 0; i < 10; i++) {
+        std::string value = "compressed" + std::to_string(i);
+        oi4->setString(9, value);
+        rclient->put(4, c4u, oi4);
+        merge.clear();
+        merge.emplace_back(4, c4u);
+        opflexServer.policyUpdate(replace, merge, del);
+        WAIT_FOR(value == client2->get(4, c4u)->getString(9), 1000);
+    }
+    BOOST_CHECK_EQUAL("test2", client2->get(6, c6u)->getString(13));
+}
+
+static uint64_t readPauses(OpflexPool& pool, const std::string& peer) {
+    OF_UNORDERED_MAP<std::string, OF_SHARED_PTR<OFStats> > stats;
+    pool.getOpflexPeerStats(stats);
+    auto it = stats.find(peer);
+    return it == stats.end() ? 0 : it->second->getReadPauses();
+}
+
+// test that policy updates are applied in order when the writer
+// queue is full, and that reads from the peer pause and resume
+BOOST_FIXTURE_TEST_CASE( policy_update_queue_full, PolicyFixture ) {
+    // any queued update fills the queue
+    processor.getWriter().setMaxQueued(1);
+    startClient();
+    WAIT_FOR(connReady(processor.getPool(), LOCALHOST, 8009), 1000);
+    setup();
+
+    WAIT_FOR(itemPresent(client2, 4, c4u), 1000);
+    WAIT_FOR(itemPresent(client2, 6, c6u), 1000);
+    WAIT_FOR(opflexServer.getListener().applyConnPred(resolutions_pred, NULL), 1000);
+    // the resolve response paused reads
+    uint64_t pauses = readPauses(processor.getPool(), LOCALHOST":8009");
+    BOOST_CHECK(pauses > 0);
+
+    vector<reference_t> replace;
+    vector<reference_t> merge;
+    vector<reference_t> del;
+
+    // a put and a delete of the same object in one update
+    oi4->setString(9, "moretesting");
+    oi6->setString(13, "moretesting2");
+    rclient->put(4, c4u, oi4);
+    rclient->put(6, c6u, oi6);
+    merge.emplace_back(4, c4u);
+    replace.emplace_back(6, c6u);
+    del.emplace_back(6, c6u);
+    opflexServer.policyUpdate(replace, merge, del);
+    WAIT_FOR("moretesting" == client2->get(4, c4u)->getString(9), 1000);
+    BOOST_CHECK(!itemPresent(client2, 6, c6u));
+
+    // the next update is only read once reads resume
+    merge.clear();
+    del.clear();
+    opflexServer.policyUpdate(replace, merge, del);
+    WAIT_FOR(itemPresent(client2, 6, c6u), 1000);
+    BOOST_CHECK_EQUAL("moretesting2", client2->get(6, c6u)->getString(13));
+
+    oi4->setString(9, "evenmore");
+    rclient->put(4, c4u, oi4);
+    replace.clear();
+    merge.emplace_back(4, c4u);
+    opflexServer.policyUpdate(replace, merge, del);
+    WAIT_FOR("evenmore" == client2->get(4, c4u)->getString(9), 1000);
+
+    BOOST_CHECK(readPauses(processor.getPool(), LOCALHOST":8009") >=
+                pauses + 3);
+}
+
 // test policy resolve when the server is flaky
 BOOST_FIXTURE_TEST_CASE( policy_resolve_flaky, PolicyFixture ) {
     startClient();
@@ -663,6 +748,93 @@ BOOST_FIXTURE_TEST_CASE( policy_resolve_flaky, PolicyFixture ) {
     WAIT_FOR(opflexServer.getListener().applyConnPred(resolutions_pred, NULL), 1000);
 }
 
+static uint64_t polResolves(OpflexPool& pool, const std::string& peer) {
+    OF_UNORDERED_MAP<std::string, OF_SHARED_PTR<OFStats> > stats;
+    pool.getOpflexPeerStats(stats);
+    auto it = stats.find(peer);
+    return it == stats.end() ? 0 : it->second->getPolResolves();
+}
+
+// test that resolves go to one primary server, and move to the
+// backup when the primary fails
+BOOST_FIXTURE_TEST_CASE( policy_resolve_primary, BasePFixture ) {
+    GbpOpflexServer::peer_t p1 = make_pair(SERVER_ROLES, LOCALHOST":8009");
+    GbpOpflexServer::peer_t p2 = make_pair(SERVER_ROLES, LOCALHOST":8010");
+    GbpOpflexServerImpl peer1(8009, SERVER_ROLES, list_of(p1)(p2),
+                              vector<std::string>(), md, 60);
+    GbpOpflexServerImpl peer2(8010, SERVER_ROLES, list_of(p1)(p2),
+                              vector<std::string>(), md, 60);
+
+    URI c4u("/class4/test/");
+    URI c5u("/class5/test/");
+    URI c6u("/class4/test/class6/test2/");
+    OF_SHARED_PTR<ObjectInstance> oi4 = OF_MAKE_SHARED<ObjectInstance>(4);
+    OF_SHARED_PTR<ObjectInstance> oi6 = OF_MAKE_SHARED<ObjectInstance>(6);
+    oi4->setString(9, "test");
+    oi6->setString(13, "test2");
+    GbpOpflexServerImpl* servers[] = { &peer1, &peer2 };
+    for (GbpOpflexServerImpl* server : servers) {
+        StoreClient* rclient = server->getSystemClient();
+        rclient->put(1, URI::ROOT, OF_MAKE_SHARED<ObjectInstance>(1));
+        rclient->put(4, c4u, oi4);
+        rclient->put(6, c6u, oi6);
+        rclient->addChild(1, URI::ROOT, 8, 4, c4u);
+        rclient->addChild(4, c4u, 12, 6, c6u);
+        server->start();
+        WAIT_FOR(server->getListener().isListening(), 1000);
+    }
+
+    processor.setPrimaryRouting(true);
+    processor.start();
+    processor.addPeer(LOCALHOST, 8009);
+    processor.addPeer(LOCALHOST, 8010);
+    WAIT_FOR(connReady(processor.getPool(), LOCALHOST, 8009), 1000);
+    WAIT_FOR(connReady(processor.getPool(), LOCALHOST, 8010), 1000);
+
+    StoreClient::notif_t notifs;
+    OF_SHARED_PTR<ObjectInstance> oi5 = OF_MAKE_SHARED<ObjectInstance>(5);
+    oi5->setString(10, "test");
+    oi5->addReference(11, 4, c4u);
+    client2->put(5, c5u, oi5);
+    client2->queueNotification(5, c5u, notifs);
+    client2->deliverNotifications(notifs);
+    notifs.clear();
+
+    WAIT_FOR(itemPresent(client2, 4, c4u), 1000);
+    WAIT_FOR(itemPresent(client2, 6, c6u), 1000);
+
+    // only the primary got the resolve
+    OpflexClientConnection* conn =
+        processor.getPool().getMasterForRole(OFConstants::POLICY_REPOSITORY);
+    BOOST_REQUIRE(conn != NULL);
+    bool firstIsPrimary = conn->getPort() == 8009;
+    GbpOpflexServerImpl& primary = firstIsPrimary ? peer1 : peer2;
+    GbpOpflexServerImpl& backup = firstIsPrimary ? peer2 : peer1;
+    std::string backupName(firstIsPrimary ? LOCALHOST":8010"
+                                          : LOCALHOST":8009");
+    WAIT_FOR(primary.getListener().applyConnPred(resolutions_pred, NULL),
+             1000);
+    BOOST_CHECK(!backup.getListener().applyConnPred(resolutions_pred, NULL));
+    BOOST_CHECK_EQUAL(0, polResolves(processor.getPool(), backupName));
+
+    // the backup takes over when the primary goes away
+    primary.stop();
+    WAIT_FOR(backup.getListener().applyConnPred(resolutions_pred, NULL),
+             1000);
+    BOOST_CHECK(polResolves(processor.getPool(), backupName) > 0);
+
+    vector<reference_t> replace;
+    vector<reference_t> merge;
+    vector<reference_t> del;
+    oi4->setString(9, "failover");
+    backup.getSystemClient()->put(4, c4u, oi4);
+    merge.emplace_back(4, c4u);
+    backup.policyUpdate(replace, merge, del);
+    WAIT_FOR("failover" == client2->get(4, c4u)->getString(9), 1000);
+
+    backup.stop();
+}
+
 class StateFixture : public ServerFixture {
 public:
     StateFixture()
@@ -0,0 +1,119 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*!
+ * @file AsyncLogHandler.h
+ * @brief Interface definition file for AsyncLogHandler
+ */
+/*
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#pragma once
+#ifndef OPFLEX_LOGGING_ASYNCLOGHANDLER_H
+#define OPFLEX_LOGGING_ASYNCLOGHANDLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "opflex/logging/OFLogHandler.h"
+
+namespace opflex {
+namespace logging {
+
+/**
+ * An @ref OFLogHandler that takes log messages off the logging
+ * thread and hands them to another handler from a background writer
+ * thread.
+ *
+ * Each logging thread queues its messages in its own fixed-size
+ * buffer without taking any locks, along with the time they were
+ * logged.  The writer collects the messages from all buffers, orders
+ * them by time and passes them to the target with
+ * OFLogHandler::handleDeferredMessage(), then calls
+ * OFLogHandler::flush() once for the whole batch.  When a thread's
+ * buffer is full its messages are dropped and counted rather than
+ * blocking the thread.
+ *
+ * Messages logged before start() or after stop() are passed to the
+ * target synchronously.
+ *
+ * @code
+ * StdOutLogHandler stdOut(OFLogHandler::INFO);
+ * AsyncLogHandler async(stdOut);
+ * async.start();
+ * OFLogHandler::registerHandler(async);
+ * @endcode
+ */
+class AsyncLogHandler : public OFLogHandler {
+public:
+    /**
+     * Default number of messages each logging thread can queue
+     */
+    static const size_t DEFAULT_BUFFER_SIZE = 8192;
+
+    /**
+     * Allocate an asynchronous log handler
+     *
+     * @param target the handler that will write out the messages.
+     * It is called only from one thread at a time.
+     * @param bufferSize the number of messages each logging thread
+     * can queue before messages are dropped; rounded up to a power
+     * of two
+     */
+    AsyncLogHandler(OFLogHandler& target,
+                    size_t bufferSize = DEFAULT_BUFFER_SIZE)
+        __attribute__((no_instrument_function));
+    virtual ~AsyncLogHandler()
+        __attribute__((no_instrument_function));
+
+    /**
+     * Start the writer thread
+     */
+    void start() __attribute__((no_instrument_function));
+
+    /**
+     * Stop the writer thread after writing out all queued messages
+     */
+    void stop() __attribute__((no_instrument_function));
+
+    /**
+     * Get the number of messages that were dropped because the
+     * logging thread's buffer was full
+     *
+     * @return the number of dropped messages
+     */
+    uint64_t getDropped() const
+        __attribute__((no_instrument_function));
+
+    /* see OFLogHandler */
+    virtual void handleMessage(const std::string& file,
+                               const int line,
+                               const std::string& function,
+                               const Level level,
+                               const std::string& message)
+        __attribute__((no_instrument_function));
+
+    /**
+     * Check whether the target handler would log at the given level
+     *
+     * @param level the level of a message to log
+     * @return true if the log level could be allowed
+     */
+    virtual bool shouldEmit(const Level level)
+        __attribute__((no_instrument_function));
+
+private:
+    class AsyncLogHandlerImpl;
+    AsyncLogHandlerImpl* pimpl;
+
+    AsyncLogHandler(const AsyncLogHandler&) = delete;
+    AsyncLogHandler& operator=(const AsyncLogHandler&) = delete;
+};
+
+} /* namespace logging */
+} /* namespace opflex */
+
+#endif /* OPFLEX_LOGGING_ASYNCLOGHANDLER_H */
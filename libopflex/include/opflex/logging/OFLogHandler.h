@@ -16,6 +16,7 @@
 #define OPFLEX_LOGGING_OFLOGHANDLER_H
 
 #include <string>
+#include <ctime>
 
 namespace opflex {
 namespace logging {
@@ -102,6 +103,37 @@ public:
                                const Level level,
                                const std::string& message) = 0;
 
+    /**
+     * Process a log message that was logged at an earlier time than
+     * it is being handled, for example one that was queued by an
+     * @ref AsyncLogHandler.  Handlers that print a timestamp should
+     * override this to use the time the message was logged.  The
+     * default implementation calls handleMessage().
+     *
+     * @param timestamp the wall clock time the message was logged
+     * @param file the file that performs the logging
+     * @param line the line number for the log message
+     * @param function the name of the function that's performing the
+     * logging
+     * @param level the log level of the log message
+     * @param message the formatted message to log
+     */
+    virtual void handleDeferredMessage(const struct timespec& timestamp,
+                                       const std::string& file,
+                                       const int line,
+                                       const std::string& function,
+                                       const Level level,
+                                       const std::string& message)
+        __attribute__((no_instrument_function));
+
+    /**
+     * Write out any output that the handler has buffered.  Called
+     * after each batch of deferred messages.  The default
+     * implementation does nothing.
+     */
+    virtual void flush()
+        __attribute__((no_instrument_function));
+
     /**
      * Check whether we should attempt to log at the given log level.
      * 
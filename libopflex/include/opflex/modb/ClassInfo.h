@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "opflex/modb/PropertyInfo.h"
+#include "opflex/modb/NameIndex.h"
 
 namespace opflex {
 namespace modb {
@@ -114,11 +115,33 @@ public:
               const std::string& owner,
               const std::vector<PropertyInfo>& properties);
 
+    /**
+     * Construct a class info object for the given class ID, with a
+     * generated index of its property names.  If the index does not
+     * match the properties, a new one is built.
+     */
+    ClassInfo(class_id_t class_id,
+              class_type_t class_type,
+              const std::string& class_name,
+              const std::string& owner,
+              const std::vector<PropertyInfo>& properties,
+              const NameIndex& prop_index);
+
+    /**
+     * Copy a class info object
+     */
+    ClassInfo(const ClassInfo& other);
+
     /**
      * Destroy the class index
      */
     ~ClassInfo();
 
+    /**
+     * Assign a class info object
+     */
+    ClassInfo& operator=(const ClassInfo& other);
+
     /**
      * Get the name for this class
      * @return the name
@@ -156,9 +179,16 @@ public:
      * @return a reference to the property info
      * @throws std::out_of_range if there is no property with that name
      */
-    const PropertyInfo& getProperty(const std::string& name) const {
-        return properties.at(prop_names.at(name));
-    }
+    const PropertyInfo& getProperty(const std::string& name) const;
+
+    /**
+     * Find the PropertyInfo for the given named property
+     * @param name the name of the property
+     * @param len the length of the name
+     * @return the property info, or NULL if there is no property with
+     * that name
+     */
+    const PropertyInfo* findProperty(const char* name, size_t len) const;
 
     /**
      * Get the PropertyInfo for the given property ID
@@ -191,17 +221,24 @@ private:
      */
     std::string owner;
 
-    typedef OF_UNORDERED_MAP<std::string, prop_id_t> prop_name_map_t;
-
     /**
      * The properties for this class
      */
     property_map_t properties;
 
     /**
-     * Look up properties IDs by name
+     * Look up properties by name
      */
-    prop_name_map_t prop_names;
+    NameIndex prop_index;
+
+    /**
+     * The property in each slot of the name index, pointing into
+     * properties
+     */
+    std::vector<const PropertyInfo*> prop_slots;
+
+    void initPropIndex(const NameIndex& index);
+    void initPropSlots();
 };
 
 /* @} metadata */
@@ -0,0 +1,284 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*!
+ * @file MOSnapshot.h
+ * @brief Interface definition file for MOSnapshot
+ */
+/*
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#ifndef MODB_MOSNAPSHOT_H
+#define MODB_MOSNAPSHOT_H
+
+#include <iterator>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "opflex/modb/URI.h"
+#include "opflex/modb/mo-internal/ObjectInstance.h"
+#include "opflex/modb/mo-internal/StoreClient.h"
+#include "opflex/ofcore/OFTypes.h"
+
+namespace opflex {
+
+namespace ofcore {
+class OFFramework;
+}
+
+namespace modb {
+
+/**
+ * \addtogroup cpp
+ * @{
+ * \addtogroup modb
+ * @{
+ */
+
+/**
+ * @brief A read snapshot pins the objects resolved through it, so
+ * that the views of them that the generated classes return stay
+ * valid while the snapshot is in use.
+ *
+ * Views refer to the object instances held by the snapshot rather
+ * than owning a copy, and are cheap to create and copy.  Every
+ * resolve pins another object until the snapshot is cleared, and the
+ * storage for pinned objects is kept across calls to clear(), so a
+ * snapshot that is reused for each update does not allocate once it
+ * has grown to the size of an update.
+ *
+ * As with managed objects, the pinned objects do not change once
+ * resolved.  A snapshot must be used from one thread at a time.
+ */
+class MOSnapshot : private boost::noncopyable {
+public:
+    /**
+     * Create a snapshot for resolving objects from the provided
+     * framework instance.
+     *
+     * @param framework the framework instance to read from
+     */
+    explicit MOSnapshot(ofcore::OFFramework& framework);
+
+    /**
+     * Destroy the snapshot.  Any views of its objects become
+     * invalid.
+     */
+    ~MOSnapshot();
+
+    /**
+     * Release all the pinned objects, keeping the storage for reuse.
+     * Any views of them become invalid.
+     */
+    void clear();
+
+    /**
+     * Get the number of objects pinned in the snapshot
+     *
+     * @return the number of objects
+     */
+    size_t size() const { return used; }
+
+    /**
+     * @brief A range of views of consecutive objects pinned in the
+     * snapshot, such as the children of an object.
+     *
+     * @tparam V the view type for the objects
+     */
+    template <class V>
+    class Range {
+    public:
+        /**
+         * An iterator that creates a view for each object in the range
+         */
+        class iterator {
+        public:
+            /** iterator traits */
+            typedef std::forward_iterator_tag iterator_category;
+            /** iterator traits */
+            typedef V value_type;
+            /** iterator traits */
+            typedef std::ptrdiff_t difference_type;
+            /** iterator traits */
+            typedef void pointer;
+            /** iterator traits */
+            typedef V reference;
+
+            /**
+             * Create an iterator for the given object in the snapshot
+             */
+            iterator(MOSnapshot* snapshot_, size_t index_)
+                : snapshot(snapshot_), index(index_) {}
+
+            /**
+             * Get a view of the current object
+             */
+            V operator*() const { return V(*snapshot, index); }
+
+            /**
+             * Advance to the next object
+             */
+            iterator& operator++() { ++index; return *this; }
+
+            /**
+             * Advance to the next object
+             */
+            iterator operator++(int) {
+                iterator prev(*this);
+                ++index;
+                return prev;
+            }
+
+            /**
+             * Check for iterator equality
+             */
+            bool operator==(const iterator& rhs) const {
+                return index == rhs.index && snapshot == rhs.snapshot;
+            }
+
+            /**
+             * Check for iterator inequality
+             */
+            bool operator!=(const iterator& rhs) const {
+                return !operator==(rhs);
+            }
+
+        private:
+            MOSnapshot* snapshot;
+            size_t index;
+        };
+
+        /**
+         * Views are created on the fly, so they cannot be modified
+         * through the range
+         */
+        typedef iterator const_iterator;
+
+        /**
+         * Create a range of the pinned objects with indexes from
+         * first up to but not including last
+         */
+        Range(MOSnapshot& snapshot_, size_t first_, size_t last_)
+            : snapshot(&snapshot_), first(first_), last(last_) {}
+
+        /**
+         * Get an iterator to the first object in the range
+         */
+        iterator begin() const { return iterator(snapshot, first); }
+
+        /**
+         * Get an iterator past the last object in the range
+         */
+        iterator end() const { return iterator(snapshot, last); }
+
+        /**
+         * Get the number of objects in the range
+         */
+        size_t size() const { return last - first; }
+
+        /**
+         * Check whether the range is empty
+         */
+        bool empty() const { return first == last; }
+
+    private:
+        MOSnapshot* snapshot;
+        size_t first;
+        size_t last;
+    };
+
+    /**
+     * Resolve the specified URI and pin its object instance, if it
+     * exists.
+     *
+     * @param class_id the class ID for the corresponding object
+     * @param uri the URI to resolve
+     * @param index set to the index of the pinned object
+     * @return true if the object exists
+     */
+    bool pin(class_id_t class_id, const URI& uri, /* out */ size_t& index);
+
+    /**
+     * Resolve the children of the specified parent object and pin
+     * their object instances.  The children are pinned with
+     * consecutive indexes.
+     *
+     * @param parent_class the class ID of the parent
+     * @param parent_uri the URI of the parent object
+     * @param parent_prop the property ID in the parent object
+     * @param child_class the class ID of the children
+     * @param first set to the index of the first child
+     * @param last set to one past the index of the last child
+     */
+    void pinChildren(class_id_t parent_class,
+                     const URI& parent_uri,
+                     prop_id_t parent_prop,
+                     class_id_t child_class,
+                     /* out */ size_t& first,
+                     /* out */ size_t& last);
+
+    /**
+     * Get the class ID of a pinned object
+     *
+     * @param index the index of the pinned object
+     */
+    class_id_t getClassId(size_t index) const {
+        return entry(index).class_id;
+    }
+
+    /**
+     * Get the URI of a pinned object.  The reference stays valid
+     * until the snapshot is cleared.
+     *
+     * @param index the index of the pinned object
+     */
+    const URI& getURI(size_t index) const {
+        return entry(index).uri;
+    }
+
+    /**
+     * Get the object instance of a pinned object.  The reference
+     * stays valid until the snapshot is cleared.
+     *
+     * @param index the index of the pinned object
+     */
+    const mointernal::ObjectInstance& getObjectInstance(size_t index) const {
+        return *entry(index).oi;
+    }
+
+private:
+    struct Entry {
+        Entry() : class_id(0), uri(URI::ROOT) {}
+
+        class_id_t class_id;
+        URI uri;
+        OF_SHARED_PTR<const mointernal::ObjectInstance> oi;
+    };
+
+    // entries are allocated in chunks that are never moved, so views
+    // can refer to them while more objects are pinned
+    static const size_t CHUNK_SIZE = 256;
+
+    mointernal::StoreClient& client;
+    std::vector<Entry*> chunks;
+    size_t used;
+    // reused for each call to pinChildren
+    std::vector<mointernal::StoreClient::uri_obj_t> children;
+
+    Entry& add();
+    const Entry& entry(size_t index) const {
+        return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+};
+
+/* @} modb */
+/* @} cpp */
+
+} /* namespace modb */
+} /* namespace opflex */
+
+#endif /* MODB_MOSNAPSHOT_H */
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "opflex/modb/ClassInfo.h"
+#include "opflex/modb/NameIndex.h"
 
 namespace opflex {
 namespace modb {
@@ -55,6 +56,19 @@ public:
     ModelMetadata(const std::string& model_name,
                   const std::vector<ClassInfo>& classes);
 
+    /**
+     * Construct a model metadata object with a generated index of the
+     * class names.  If the index does not match the classes, a new
+     * one is built.
+     * @param model_name the name of the model
+     * @param classes a vector containing the classes to be used with
+     * the model
+     * @param class_index an index from class names to class IDs
+     */
+    ModelMetadata(const std::string& model_name,
+                  const std::vector<ClassInfo>& classes,
+                  const NameIndex& class_index);
+
     /**
      * Destroy the class index
      */
@@ -72,6 +86,13 @@ public:
      */
     const std::vector<ClassInfo>& getClasses() const { return classes; }
 
+    /**
+     * Get the index from the names of the classes in this model to
+     * their class IDs
+     * @return the class name index
+     */
+    const NameIndex& getClassIndex() const { return class_index; }
+
 private:
     /**
      * The name for this model
@@ -87,6 +108,13 @@ private:
      * The properties for this class
      */
     std::vector<ClassInfo> classes;
+
+    /**
+     * Look up class IDs by name
+     */
+    NameIndex class_index;
+
+    void initClassIndex(const NameIndex& index);
 };
 
 /* @} metadata */
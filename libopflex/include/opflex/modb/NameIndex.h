@@ -0,0 +1,186 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*!
+ * @file NameIndex.h
+ * @brief Interface definition file for NameIndex
+ */
+/*
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#ifndef MODB_NAMEINDEX_H
+#define MODB_NAMEINDEX_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+namespace opflex {
+namespace modb {
+
+/**
+ * \addtogroup cpp
+ * @{
+ * \addtogroup metadata
+ * @{
+ */
+
+/**
+ * @brief A minimal perfect hash table from the class or property
+ * names of a model to their IDs.
+ *
+ * A name hashes to one of the buckets, which holds a seed, and its
+ * hash mixed with that seed gives its slot.  The seeds are
+ * chosen so that every known name has a slot of its own.  The code
+ * generation framework emits these tables along with the model
+ * metadata; they can also be built when the metadata is loaded.
+ *
+ * Any other string also maps to some slot, so the caller must check
+ * that the name of what it finds matches.
+ */
+class NameIndex {
+public:
+    /**
+     * Construct an empty index, in which nothing can be found
+     */
+    NameIndex() {}
+
+    /**
+     * Construct an index from generated tables
+     *
+     * @param seeds the seed for each bucket
+     * @param ids the ID for each slot
+     * @param size the number of buckets and slots
+     */
+    NameIndex(const uint32_t* seeds, const uint64_t* ids, size_t size);
+
+    /**
+     * Build an index for the given names.  If a name appears more
+     * than once, the last ID given for it is used.
+     *
+     * @param names the names and their IDs
+     * @return the index
+     */
+    static NameIndex build(const std::vector<std::pair<std::string,
+                                                       uint64_t> >& names);
+
+    /**
+     * Hash a name.  The code generation framework implements the same
+     * function.
+     *
+     * @param name the name
+     * @param len the length of the name
+     * @return the hash
+     */
+    static uint64_t hash(const char* name, size_t len) {
+        // eight bytes at a time, little-endian whatever the host
+        const uint8_t* p = (const uint8_t*)name;
+        uint64_t h = 14695981039346656037ull ^ len;
+        for (; len >= 8; p += 8, len -= 8) {
+            uint64_t w = (uint64_t)p[0] | (uint64_t)p[1] << 8 |
+                (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+                (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 |
+                (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+            h = (h ^ w) * 0x9e3779b97f4a7c15ull;
+            h ^= h >> 32;
+        }
+        if (len > 0) {
+            uint64_t w = 0;
+            for (size_t i = 0; i < len; ++i)
+                w |= (uint64_t)p[i] << (8 * i);
+            h = (h ^ w) * 0x9e3779b97f4a7c15ull;
+            h ^= h >> 32;
+        }
+        return h;
+    }
+
+    /**
+     * Mix the hash of a name with a seed.  Seed zero gives the bucket
+     * of the name, and the seed of the bucket gives its slot.
+     *
+     * @param h the hash of the name
+     * @param seed the seed
+     * @return the mixed hash
+     */
+    static uint64_t mix(uint64_t h, uint32_t seed) {
+        h ^= seed;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /**
+     * Get the slot for the given name, which is the slot of the name
+     * if it is in the index.  The index must not be empty.
+     *
+     * @param name the name
+     * @param len the length of the name
+     * @return the slot
+     */
+    size_t slot(const char* name, size_t len) const {
+        uint64_t h = hash(name, len);
+        return reduce(mix(h, seeds[reduce(mix(h, 0), seeds.size())]),
+                      ids.size());
+    }
+
+    /**
+     * Map a mixed hash onto [0, n) with a multiply rather than a
+     * division, using its high bits
+     *
+     * @param h the mixed hash
+     * @param n the number of buckets or slots
+     * @return the bucket or slot
+     */
+    static size_t reduce(uint64_t h, size_t n) {
+        return (size_t)(((h >> 32) * (uint64_t)n) >> 32);
+    }
+
+    /**
+     * Get the ID in the given slot
+     * @param slot the slot
+     * @return the ID
+     */
+    uint64_t getId(size_t slot) const { return ids[slot]; }
+
+    /**
+     * Get the ID in the slot for the given name, which is the ID of
+     * the name if it is in the index
+     *
+     * @param name the name
+     * @param len the length of the name
+     * @param id set to the ID in the slot
+     * @return false if the index is empty
+     */
+    bool find(const char* name, size_t len, /* out */ uint64_t& id) const {
+        if (ids.empty()) return false;
+        id = ids[slot(name, len)];
+        return true;
+    }
+
+    /**
+     * Get the number of slots in the index
+     * @return the number of slots
+     */
+    size_t size() const { return ids.size(); }
+
+private:
+    std::vector<uint32_t> seeds;
+    std::vector<uint64_t> ids;
+};
+
+/* @} metadata */
+/* @} cpp */
+
+} /* namespace modb */
+} /* namespace opflex */
+
+#endif /* MODB_NAMEINDEX_H */
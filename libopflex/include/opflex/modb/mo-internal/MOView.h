@@ -0,0 +1,126 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*!
+ * @file MOView.h
+ * @brief Interface definition file for managed object views
+ */
+/*
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+#ifndef OPFLEX_CORE_MOVIEW_H
+#define OPFLEX_CORE_MOVIEW_H
+
+#include <boost/optional.hpp>
+
+#include "opflex/modb/MOSnapshot.h"
+#include "opflex/modb/URI.h"
+#include "opflex/modb/mo-internal/ObjectInstance.h"
+
+namespace opflex {
+namespace modb {
+namespace mointernal {
+
+/**
+ * @brief This is the base class for the read-only views of managed
+ * objects that the generated classes provide.
+ *
+ * A view refers to an object pinned in a MOSnapshot and owns
+ * nothing, so unlike an MO it is created on the stack without
+ * allocating and can be copied freely.  A view is valid only until
+ * its snapshot is cleared or destroyed.
+ */
+class MOView {
+public:
+    /**
+     * Get the class ID associated with this managed object.
+     *
+     * @return The unique class ID
+     */
+    class_id_t getClassId() const { return class_id; }
+
+    /**
+     * Get the URI associated with this managed object.
+     *
+     * @return the URI for the object
+     */
+    const URI& getURI() const { return *uri; }
+
+protected:
+    /**
+     * Construct a view of an object pinned in the snapshot
+     *
+     * @param snapshot_ the snapshot that pins the object
+     * @param index the index of the object in the snapshot
+     */
+    MOView(MOSnapshot& snapshot_, size_t index)
+        : snapshot(&snapshot_),
+          class_id(snapshot_.getClassId(index)),
+          uri(&snapshot_.getURI(index)),
+          oi(&snapshot_.getObjectInstance(index)) {}
+
+    /**
+     * Get the snapshot that pins this object
+     *
+     * @return the snapshot
+     */
+    MOSnapshot& getSnapshot() const { return *snapshot; }
+
+    /**
+     * Get the raw object instance associated with this managed object
+     *
+     * @return the raw object instance
+     */
+    const ObjectInstance& getObjectInstance() const { return *oi; }
+
+    /**
+     * Resolve the specified URI in the snapshot to a view of the
+     * given type, if it exists.
+     *
+     * @param snapshot the snapshot to pin the object in
+     * @param class_id the class ID for the corresponding object
+     * @param uri the URI to resolve
+     * @return the view, or boost::none if the object does not exist
+     */
+    template <class V> static
+    boost::optional<V> resolve(MOSnapshot& snapshot,
+                               class_id_t class_id,
+                               const URI& uri) {
+        size_t index;
+        if (snapshot.pin(class_id, uri, index))
+            return V(snapshot, index);
+        return boost::none;
+    }
+
+    /**
+     * Resolve the children of this object in its snapshot to a range
+     * of views of the given type.
+     *
+     * @param parent_prop the property ID in this object
+     * @param child_class the class ID of the children
+     * @return the range of child views
+     */
+    template <class V>
+    MOSnapshot::Range<V> resolveChildren(prop_id_t parent_prop,
+                                         class_id_t child_class) const {
+        size_t first, last;
+        snapshot->pinChildren(class_id, *uri, parent_prop, child_class,
+                              first, last);
+        return MOSnapshot::Range<V>(*snapshot, first, last);
+    }
+
+private:
+    MOSnapshot* snapshot;
+    class_id_t class_id;
+    const URI* uri;
+    const ObjectInstance* oi;
+};
+
+} /* namespace mointernal */
+} /* namespace modb */
+} /* namespace opflex */
+
+#endif /* OPFLEX_CORE_MOVIEW_H */
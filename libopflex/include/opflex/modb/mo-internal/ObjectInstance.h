@@ -15,6 +15,7 @@
 #define MODB_OBJECTINSTANCE_H_
 
 #include <string>
+#include <vector>
 #include <utility>
 #include <boost/tuple/tuple_comparison.hpp>
 #include <boost/cstdint.hpp>
@@ -99,6 +100,14 @@ namespace mointernal {
  * While inside the object store, an object instance should never be
  * modified; only const references should be generated.  To modify, we
  * atomically update the pointer to point to a modified copy.
+ *
+ * The properties are kept as an immutable base shared between copies,
+ * with the properties set or unset since the base was made kept
+ * separately in each copy, so copying an object does not copy every
+ * property.  The base is rebuilt once the changes grow large compared
+ * to it.  Each copy also records which properties were modified since
+ * it was made, so that it can be compared to its original without
+ * comparing every property.
  */
 class ObjectInstance {
 public:
@@ -120,6 +129,35 @@ public:
     ObjectInstance(class_id_t class_id_, bool local_)
         : class_id(class_id_), local(local_) { }
 
+    /**
+     * Construct a copy of the given object, which shares its base
+     * properties
+     *
+     * @param oi the object to copy
+     */
+    ObjectInstance(const ObjectInstance& oi)
+        : class_id(oi.class_id), base(oi.base), delta(oi.delta),
+          removed(oi.removed), local(oi.local) { }
+
+    /**
+     * Assign a copy of the given object, which shares its base
+     * properties
+     *
+     * @param oi the object to copy
+     */
+    ObjectInstance& operator=(const ObjectInstance& oi);
+
+    /**
+     * Check whether this object differs from the object it was
+     * copied from, comparing only the properties modified since the
+     * copy was made.
+     *
+     * @param orig the object from which this object was copied, and
+     * which was not modified since
+     * @return true if any property differs
+     */
+    bool isModifiedFrom(const ObjectInstance& orig) const;
+
     /**
      * Get the class ID for this object instance
      *
@@ -458,6 +496,14 @@ public:
      */
     void addMAC(prop_id_t prop_id, const MAC& value);
 
+    /**
+     * Merge the properties set since this object was created or
+     * copied into a new immutable base, so that copies of this object
+     * share all of its properties.  This is cheap for a new object,
+     * and worthwhile before storing an object that will be copied.
+     */
+    void compact();
+
 private:
     class_id_t class_id;
 
@@ -477,17 +523,39 @@ private:
                        std::vector<MAC>*> value;
 
         Value() : type(PropertyInfo::STRING), cardinality(PropertyInfo::SCALAR) {}
+        Value(PropertyInfo::property_type_t type_,
+              PropertyInfo::cardinality_t cardinality_)
+            : type(type_), cardinality(cardinality_) {}
         Value(const Value& val);
         ~Value();
         Value& operator=(const Value& val);
+        void swap(Value& val);
     private:
         void clear();
     };
 
     typedef OF_UNORDERED_MAP<prop_key_t, Value> prop_map_t;
-    prop_map_t prop_map;
+    typedef OF_UNORDERED_SET<prop_key_t> prop_key_set_t;
+
+    // properties shared with copies of this object; never modified
+    OF_SHARED_PTR<const prop_map_t> base;
+    // properties set since base was made, which replace those in base
+    prop_map_t delta;
+    // properties in base unset since base was made
+    prop_key_set_t removed;
+    // properties written since this object was copied, possibly
+    // with repeats
+    std::vector<prop_key_t> modified_props;
     bool local;
 
+    const Value* find(const prop_key_t& key) const;
+    const Value& at(const prop_key_t& key) const;
+    size_t size() const;
+    void markModified(const prop_key_t& key);
+    Value& write(const prop_key_t& key);
+    void setValue(const prop_key_t& key, Value& value);
+    void maybeCompact();
+
     friend bool operator==(const ObjectInstance& lhs,
                            const ObjectInstance& rhs);
     friend bool operator!=(const ObjectInstance& lhs,
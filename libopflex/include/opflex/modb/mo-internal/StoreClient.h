@@ -111,6 +111,36 @@ public:
      */
     typedef OF_UNORDERED_MAP<URI, class_id_t> notif_t;
 
+    /**
+     * An object to write with putIfModified(), along with the object
+     * in the store from which it was copied, if any
+     */
+    struct PutRequest {
+        /** the class ID for the object */
+        class_id_t class_id;
+        /** the URI for the object instance */
+        URI uri;
+        /** the object instance to set */
+        OF_SHARED_PTR<const ObjectInstance> oi;
+        /** the object instance that oi was copied from, or NULL */
+        OF_SHARED_PTR<const ObjectInstance> orig;
+    };
+
+    /**
+     * Set each object to the provided object instance if it has been
+     * modified, taking the lock of each region once for the batch.
+     * If the object in the store is still the one it was copied from,
+     * only the properties modified in the copy are compared.
+     *
+     * @param objs the objects to set
+     * @param modified the URIs and class IDs of the objects that were
+     * updated are added to this map
+     * @throws std::out_of_range if there is no such class ID
+     * registered
+     */
+    void putIfModified(const std::vector<PutRequest>& objs,
+                       /* out */ notif_t& modified);
+
     /**
      * Remove the specified URI, if present
      *
@@ -200,6 +230,31 @@ public:
                      class_id_t child_class,
                      /* out */ std::vector<URI>& output);
 
+    /**
+     * A URI along with the object instance stored for it
+     */
+    typedef std::pair<URI, OF_SHARED_PTR<const ObjectInstance> > uri_obj_t;
+
+    /**
+     * Get the children of the parent URI and property along with
+     * their object instances, taking the region lock once, and append
+     * them to the supplied vector.  This copies no strings, so once
+     * a vector reused across calls has grown it does not allocate.
+     * Children that have no object instance are skipped.
+     *
+     * @param parent_class the class ID of the parent
+     * @param parent_uri the URI of the parent object
+     * @param parent_prop the property ID in the parent object
+     * @param child_class the class ID of the child
+     * @param output the output array that will get the output
+     * @throws std::out_of_range If no such class ID is registered
+     */
+    void getChildObjects(class_id_t parent_class,
+                         const URI& parent_uri,
+                         prop_id_t parent_prop,
+                         class_id_t child_class,
+                         /* out */ std::vector<uri_obj_t>& output);
+
     /**
      * Remove all the children of the given object, exluding the
      * object itself.
@@ -79,6 +79,48 @@ public:
      */
     virtual void setUnresolved(bool enabled) = 0;
 
+    /**
+     * Ask the server to return query results in pages of at most the
+     * given number of managed objects.  Each page is requested once
+     * the previous one has been processed, so neither side ever holds
+     * more than a page of serialized results, however large the
+     * query.
+     *
+     * @param objects the page size, or 0 to receive each query result
+     * in a single reply
+     */
+    virtual void setPageSize(size_t objects) = 0;
+
+    /**
+     * Render managed objects to the given stream in list format as
+     * each page of results arrives, rather than accumulating them for
+     * prettyPrint().  Objects are dropped from the client's MODB view
+     * once rendered, so memory use does not grow with the size of the
+     * query.  Must be called before execute().
+     *
+     * @param output the output stream to write to, or NULL to
+     * accumulate results as usual
+     * @param includeProps include the object properties
+     * @param utf8 output using UTF-8 characters
+     * @param truncate truncate lines to the specified number of
+     * characters.  0 means do not truncate.
+     */
+    virtual void setStreamOutput(std::ostream* output,
+                                 bool includeProps = true,
+                                 bool utf8 = true,
+                                 size_t truncate = 0) = 0;
+
+    /**
+     * Write managed objects to the given file using the Opflex JSON
+     * wire format as each page of results arrives, rather than
+     * accumulating them for dumpToFile().  Must be called before
+     * execute().
+     *
+     * @param file the file to write to, or NULL to accumulate results
+     * as usual
+     */
+    virtual void setStreamDump(FILE* file) = 0;
+
     /**
      * Query for a particular managed object
      *
@@ -604,6 +604,7 @@ namespace opflex {
 namespace modb {
 class ObjectStore;
 class ModelMetadata;
+class MOSnapshot;
 namespace mointernal {
 class MO;
 }
@@ -741,6 +742,24 @@ public:
      */
      void setHandshakeTimeout(const uint32_t timeout);
 
+    /**
+     * Offer deflate compression of OpFlex messages to peers.  It is
+     * only used on connections where the peer accepts it during the
+     * identity handshake.
+     * @param enabled true to offer compression
+     */
+    void setCompression(bool enabled);
+
+    /**
+     * Send policy and endpoint resolves only to one primary peer for
+     * each role instead of to every connected peer.  The other peers
+     * are kept as backups, and resolves are sent again to a new
+     * primary if the primary is lost.  Declares still go to every
+     * peer.
+     * @param enabled true to send resolves to the primary only
+     */
+    void setPrimaryRouting(bool enabled);
+
     /**
      * Start the framework.  This will start all the framework threads
      * and attempt to connect to configured OpFlex peers.
@@ -942,6 +961,7 @@ private:
     OFFrameworkImpl* pimpl;
 
     friend class modb::Mutator;
+    friend class modb::MOSnapshot;
     friend class modb::mointernal::MO;
     friend class MockOFFramework;
 };
@@ -75,6 +75,10 @@ public:
     uint64_t getPolUpdates() { return polUpdates; }
     /** increment the number of policy updates received */
     void incrPolUpdates() { polUpdates++; }
+    /** get the number of times reads paused on a full update queue */
+    uint64_t getReadPauses() { return readPauses; }
+    /** increment the number of times reads paused on a full update queue */
+    void incrReadPauses() { readPauses++; }
 
     /** get the number of endpoint_declare msgs sent */
     uint64_t getEpDeclares() { return epDeclares; }
@@ -130,6 +134,7 @@ private:
     std::atomic_ullong polUnresolveErrs{};
 
     std::atomic_ullong polUpdates{};
+    std::atomic_ullong readPauses{};
 
     std::atomic_ullong epDeclares{};
     std::atomic_ullong epDeclareResps{};
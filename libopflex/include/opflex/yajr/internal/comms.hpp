@@ -27,6 +27,7 @@
 
 #include <sstream>  /* for basic_stringstream<> */
 #include <iostream>
+#include <memory>
 
 #define uv_close(h, cb)                        \
     do {                                       \
@@ -37,6 +38,9 @@
 
 
 namespace yajr {
+    namespace transport {
+        class FrameCompressor;
+    }
     namespace comms {
         namespace internal {
 
@@ -342,6 +346,7 @@ class Peer : public SafeListBaseHook {
               destroying_(0),
               passive_(passive),
               choked_(1),
+              readPaused_(0),
               createFail_(1),
               status_(status),
               nullTermination(true)
@@ -434,6 +439,8 @@ class Peer : public SafeListBaseHook {
     /** Is the peer currently choked */
     mutable
     unsigned char choked_     :1;
+    /** Has the application paused reading from the peer */
+    unsigned char readPaused_ :1;
     /** Did the peer creation fail */
     unsigned char createFail_ :1;
     /** Current status of the peer */
@@ -533,11 +540,29 @@ class CommunicationPeer : public Peer, virtual public ::yajr::Peer {
     void onWrite();
 
     /**
-     * Add frame delimiter
+     * Add frame delimiter, or replace the frame with its compressed
+     * form if compression is enabled towards this peer
+     *
+     * @param frameStart offset in the send queue where the frame starts
      */
-    void delimitFrame() const {
-        s_.Put('\0');
-    }
+    void delimitFrame(size_t frameStart) const;
+
+    /**
+     * Compress outbound frames from now on.  The remote peer must have
+     * advertised that it is able to inflate them.
+     */
+    virtual void enableCompression();
+
+    /**
+     * Stop reading from the peer until resumeReading() is called.  The
+     * transport may not unchoke the peer in the meantime.
+     */
+    virtual void pauseReading();
+
+    /**
+     * Start reading from the peer again after pauseReading()
+     */
+    virtual void resumeReading();
 
     /**
      * Write to peer
@@ -790,7 +815,7 @@ class CommunicationPeer : public Peer, virtual public ::yajr::Peer {
 
   protected:
     /* don't leak memory! */
-    virtual ~CommunicationPeer() {}
+    virtual ~CommunicationPeer();
 
   private:
 
@@ -821,8 +846,23 @@ class CommunicationPeer : public Peer, virtual public ::yajr::Peer {
         ssIn_.copyfmt(initialFmt);
     }
 
+    /* FrameCompressor is only complete in CommunicationPeer.cpp, so the
+     * deleter must not be instantiated by the inline constructors */
+    struct CompressorDeleter {
+        void operator()(::yajr::transport::FrameCompressor * c) const;
+    };
+
+    mutable std::unique_ptr< ::yajr::transport::FrameCompressor,
+                             CompressorDeleter > compressor_;
+
+    ::yajr::transport::FrameCompressor * getCompressor() const;
+
     yajr::rpc::InboundMessage * parseFrame();
 
+    size_t readCompressedChunk(
+            char const * buffer,
+            size_t n);
+
     void readBufferZ(
             char const * bufferZ,
             size_t n);
@@ -235,6 +235,30 @@ class Peer {
      */
     virtual void stopKeepAlive() = 0;
 
+    /**
+     * @brief start compressing outbound messages
+     *
+     * Replace outbound frames with deflate-compressed frames. Only call
+     * this once the remote peer has advertised that it understands them;
+     * inbound compressed frames are always accepted.
+     */
+    virtual void enableCompression() = 0;
+
+    /**
+     * @brief stop reading inbound frames
+     *
+     * Stop reading from the peer until resumeReading() is called, so
+     * that a consumer that falls behind pushes back on the sender
+     * rather than buffering without bound.  Call this from the thread
+     * running the loop of the peer.
+     */
+    virtual void pauseReading() = 0;
+
+    /**
+     * @brief resume reading inbound frames after pauseReading()
+     */
+    virtual void resumeReading() = 0;
+
   protected:
     Peer() {}
     ~Peer() {}
@@ -0,0 +1,292 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for AsyncLogHandler class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "opflex/logging/AsyncLogHandler.h"
+
+namespace opflex {
+namespace logging {
+
+const size_t AsyncLogHandler::DEFAULT_BUFFER_SIZE;
+
+namespace {
+
+/* how long the writer waits for a buffer to fill before writing anyway */
+const std::chrono::milliseconds WRITE_INTERVAL(5);
+
+struct Record {
+    struct timespec timestamp;
+    OFLogHandler::Level level;
+    int line;
+    std::string file;
+    std::string function;
+    std::string message;
+};
+
+/*
+ * A fixed-size ring of records written only by the thread that owns
+ * it and read only by the writer thread
+ */
+class ThreadBuffer {
+public:
+    explicit ThreadBuffer(size_t size)
+        : records(size), mask(size - 1), head(0), tail(0), closed(false) {}
+
+    /*
+     * Queue a record.  Returns the number of records now queued, or 0
+     * if the buffer is full.
+     */
+    size_t push(const struct timespec& timestamp,
+                const std::string& file, int line,
+                const std::string& function,
+                OFLogHandler::Level level,
+                const std::string& message) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        if (t - h > mask)
+            return 0;
+        Record& r = records[t & mask];
+        r.timestamp = timestamp;
+        r.level = level;
+        r.line = line;
+        r.file = file;
+        r.function = function;
+        r.message = message;
+        tail.store(t + 1, std::memory_order_release);
+        return t + 1 - h;
+    }
+
+    /* Move all queued records to the end of out */
+    void drain(std::vector<Record>& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        for (; h != t; ++h)
+            out.push_back(std::move(records[h & mask]));
+        head.store(h, std::memory_order_release);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    std::vector<Record> records;
+    const size_t mask;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    /* set by the owning thread when it exits */
+    std::atomic<bool> closed;
+};
+
+/*
+ * The calling thread's buffer for one handler.  A thread only keeps
+ * a buffer for the last handler it logged to, which in practice is
+ * the only one.
+ */
+struct ThreadBufferRef {
+    ThreadBufferRef() : handlerId(0) {}
+    ~ThreadBufferRef() { close(); }
+
+    void close() {
+        if (buffer)
+            buffer->closed.store(true, std::memory_order_release);
+        buffer.reset();
+    }
+
+    uint64_t handlerId;
+    std::shared_ptr<ThreadBuffer> buffer;
+};
+
+thread_local ThreadBufferRef threadBuffer;
+std::atomic<uint64_t> nextHandlerId(1);
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+bool earlier(const Record& a, const Record& b) {
+    if (a.timestamp.tv_sec != b.timestamp.tv_sec)
+        return a.timestamp.tv_sec < b.timestamp.tv_sec;
+    return a.timestamp.tv_nsec < b.timestamp.tv_nsec;
+}
+
+} /* anonymous namespace */
+
+class AsyncLogHandler::AsyncLogHandlerImpl {
+public:
+    AsyncLogHandlerImpl(OFLogHandler& target_, size_t bufferSize_)
+        : target(target_),
+          bufferSize(roundUpPow2(std::max<size_t>(bufferSize_, 2))),
+          handlerId(nextHandlerId++), running(false),
+          dropped(0), reportedDropped(0) {}
+
+    ThreadBuffer* getThreadBuffer() {
+        if (threadBuffer.handlerId != handlerId || !threadBuffer.buffer) {
+            threadBuffer.close();
+            threadBuffer.handlerId = handlerId;
+            threadBuffer.buffer = std::make_shared<ThreadBuffer>(bufferSize);
+            std::lock_guard<std::mutex> guard(buffersMutex);
+            buffers.push_back(threadBuffer.buffer);
+        }
+        return threadBuffer.buffer.get();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (running) {
+            wakeCond.wait_for(lock, WRITE_INTERVAL);
+            lock.unlock();
+            writeBatch();
+            lock.lock();
+        }
+        lock.unlock();
+        writeBatch();
+    }
+
+    void writeBatch() {
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> guard(buffersMutex);
+            auto it = buffers.begin();
+            while (it != buffers.end()) {
+                // anything the owner queued before closing is visible
+                // once closed is
+                bool closed = (*it)->closed.load(std::memory_order_acquire);
+                (*it)->drain(batch);
+                if (closed)
+                    it = buffers.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        uint64_t d = dropped.load(std::memory_order_relaxed);
+        if (batch.empty() && d == reportedDropped)
+            return;
+
+        // each buffer is already in order, but a batch interleaves
+        // messages from several threads
+        std::stable_sort(batch.begin(), batch.end(), earlier);
+
+        std::lock_guard<std::mutex> guard(writeMutex);
+        for (const Record& r : batch)
+            target.handleDeferredMessage(r.timestamp, r.file, r.line,
+                                         r.function, r.level, r.message);
+        if (d != reportedDropped) {
+            std::stringstream msg;
+            msg << "Dropped " << (d - reportedDropped)
+                << " log messages because the log buffer was full";
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            target.handleDeferredMessage(now, __FILE__, __LINE__,
+                                         __FUNCTION__, OFLogHandler::WARNING,
+                                         msg.str());
+            reportedDropped = d;
+        }
+        target.flush();
+    }
+
+    OFLogHandler& target;
+    const size_t bufferSize;
+    const uint64_t handlerId;
+
+    std::atomic<bool> running;
+    std::thread writer;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCond;
+
+    // protects the list of buffers, not their contents
+    std::mutex buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+
+    // serializes calls into the target
+    std::mutex writeMutex;
+    // only used by the writer
+    std::vector<Record> batch;
+
+    std::atomic<uint64_t> dropped;
+    uint64_t reportedDropped;
+};
+
+AsyncLogHandler::AsyncLogHandler(OFLogHandler& target, size_t bufferSize)
+    : OFLogHandler(NO_LOGGING),
+      pimpl(new AsyncLogHandlerImpl(target, bufferSize)) { }
+
+AsyncLogHandler::~AsyncLogHandler() {
+    stop();
+    delete pimpl;
+}
+
+void AsyncLogHandler::start() {
+    std::lock_guard<std::mutex> guard(pimpl->wakeMutex);
+    if (pimpl->running) return;
+    pimpl->running = true;
+    pimpl->writer = std::thread([this]() { pimpl->run(); });
+}
+
+void AsyncLogHandler::stop() {
+    {
+        std::lock_guard<std::mutex> guard(pimpl->wakeMutex);
+        if (!pimpl->running) return;
+        pimpl->running = false;
+    }
+    pimpl->wakeCond.notify_all();
+    pimpl->writer.join();
+}
+
+uint64_t AsyncLogHandler::getDropped() const {
+    return pimpl->dropped.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogHandler::shouldEmit(const Level level) {
+    return pimpl->target.shouldEmit(level);
+}
+
+void AsyncLogHandler::handleMessage(const std::string& file,
+                                    const int line,
+                                    const std::string& function,
+                                    const Level level,
+                                    const std::string& message) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    if (!pimpl->running.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(pimpl->writeMutex);
+        pimpl->target.handleDeferredMessage(now, file, line, function,
+                                            level, message);
+        pimpl->target.flush();
+        return;
+    }
+
+    ThreadBuffer* buffer = pimpl->getThreadBuffer();
+    size_t queued = buffer->push(now, file, line, function, level, message);
+    if (queued == 0)
+        pimpl->dropped.fetch_add(1, std::memory_order_relaxed);
+    else if (queued == buffer->capacity() / 2)
+        // don't wait for the timer when this thread is logging heavily
+        pimpl->wakeCond.notify_one();
+}
+
+} /* namespace logging */
+} /* namespace opflex */
@@ -36,6 +36,17 @@ OFLogHandler* OFLogHandler::getHandler() {
     return &defaultHandler;
 }
 
+void OFLogHandler::handleDeferredMessage(const struct timespec& timestamp,
+                                         const std::string& file,
+                                         const int line,
+                                         const std::string& function,
+                                         const Level level,
+                                         const std::string& message) {
+    handleMessage(file, line, function, level, message);
+}
+
+void OFLogHandler::flush() { }
+
 bool OFLogHandler::shouldEmit(const Level level) {
     return level >= logLevel_;
 }
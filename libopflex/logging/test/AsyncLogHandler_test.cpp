@@ -0,0 +1,237 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Test suite for AsyncLogHandler class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opflex/logging/AsyncLogHandler.h"
+
+using namespace opflex::logging;
+
+/*
+ * Records the messages and flushes it is given.  Can be made to
+ * block in the next message it handles until released.
+ */
+class RecordingLogHandler : public OFLogHandler {
+public:
+    struct Entry {
+        struct timespec timestamp;
+        Level level;
+        std::string message;
+        // number of flushes before this message
+        size_t flushes;
+    };
+
+    RecordingLogHandler()
+        : OFLogHandler(DEBUG0), flushes(0), blockNext(false),
+          blocked(false) {}
+
+    virtual void handleMessage(const std::string&, const int,
+                               const std::string&, const Level level,
+                               const std::string& message) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        handleDeferredMessage(now, "", 0, "", level, message);
+    }
+
+    virtual void handleDeferredMessage(const struct timespec& timestamp,
+                                       const std::string&, const int,
+                                       const std::string&,
+                                       const Level level,
+                                       const std::string& message) {
+        std::unique_lock<std::mutex> lock(mutex);
+        entries.push_back({timestamp, level, message, flushes});
+        if (blockNext) {
+            blockNext = false;
+            blocked = true;
+            cond.notify_all();
+            cond.wait(lock, [this]() { return !blocked; });
+        }
+    }
+
+    virtual void flush() {
+        std::lock_guard<std::mutex> guard(mutex);
+        flushes += 1;
+    }
+
+    void block() {
+        std::lock_guard<std::mutex> guard(mutex);
+        blockNext = true;
+    }
+
+    bool waitForBlocked() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cond.wait_for(lock, std::chrono::seconds(5),
+                             [this]() { return blocked; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> guard(mutex);
+        blocked = false;
+        cond.notify_all();
+    }
+
+    std::vector<Entry> getEntries() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return entries;
+    }
+
+    size_t getFlushes() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return flushes;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<Entry> entries;
+    size_t flushes;
+    bool blockNext;
+    bool blocked;
+};
+
+static void log(OFLogHandler& handler, const std::string& message) {
+    handler.handleMessage(__FILE__, __LINE__, __FUNCTION__,
+                          OFLogHandler::INFO, message);
+}
+
+static bool notAfter(const struct timespec& a, const struct timespec& b) {
+    return a.tv_sec < b.tv_sec ||
+        (a.tv_sec == b.tv_sec && a.tv_nsec <= b.tv_nsec);
+}
+
+BOOST_AUTO_TEST_SUITE(AsyncLogHandler_test)
+
+BOOST_AUTO_TEST_CASE(threads) {
+    const int THREADS = 4;
+    const int MESSAGES = 1000;
+
+    RecordingLogHandler target;
+    AsyncLogHandler async(target);
+    async.start();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&async, t]() {
+                for (int m = 0; m < MESSAGES; ++m)
+                    log(async, std::to_string(t) + " " + std::to_string(m));
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+    async.stop();
+
+    BOOST_CHECK_EQUAL(0, async.getDropped());
+    std::vector<RecordingLogHandler::Entry> entries = target.getEntries();
+    BOOST_REQUIRE_EQUAL(THREADS * MESSAGES, entries.size());
+
+    // messages are written in the order they were logged, and each
+    // thread's messages in the order that thread logged them
+    std::vector<int> next(THREADS, 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i > 0)
+            BOOST_CHECK(notAfter(entries[i - 1].timestamp,
+                                 entries[i].timestamp));
+        size_t sep = entries[i].message.find(' ');
+        BOOST_REQUIRE(sep != std::string::npos);
+        int t = std::stoi(entries[i].message.substr(0, sep));
+        int m = std::stoi(entries[i].message.substr(sep + 1));
+        BOOST_REQUIRE(t >= 0 && t < THREADS);
+        BOOST_CHECK_EQUAL(next[t], m);
+        next[t] = m + 1;
+    }
+    BOOST_CHECK(target.getFlushes() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(overflow) {
+    RecordingLogHandler target;
+    AsyncLogHandler async(target, 4);
+    async.start();
+
+    // hold the writer in the target so that it cannot make room
+    target.block();
+    log(async, "first");
+    BOOST_REQUIRE(target.waitForBlocked());
+
+    for (int m = 0; m < 10; ++m)
+        log(async, std::to_string(m));
+    BOOST_CHECK_EQUAL(6, async.getDropped());
+
+    target.release();
+    async.stop();
+
+    // the buffer holds the first 4 messages, and the writer reports
+    // how many were dropped after them
+    std::vector<RecordingLogHandler::Entry> entries = target.getEntries();
+    BOOST_REQUIRE_EQUAL(6, entries.size());
+    BOOST_CHECK_EQUAL("first", entries[0].message);
+    for (int m = 0; m < 4; ++m)
+        BOOST_CHECK_EQUAL(std::to_string(m), entries[m + 1].message);
+    BOOST_CHECK_EQUAL(OFLogHandler::WARNING, entries[5].level);
+    BOOST_CHECK(entries[5].message.find("Dropped 6 log messages") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(stop) {
+    RecordingLogHandler target;
+    AsyncLogHandler async(target);
+    async.start();
+
+    for (int m = 0; m < 100; ++m)
+        log(async, std::to_string(m));
+    async.stop();
+
+    // stop() writes out everything queued and flushes it
+    std::vector<RecordingLogHandler::Entry> entries = target.getEntries();
+    BOOST_REQUIRE_EQUAL(100, entries.size());
+    for (int m = 0; m < 100; ++m)
+        BOOST_CHECK_EQUAL(std::to_string(m), entries[m].message);
+    size_t flushes = target.getFlushes();
+    BOOST_CHECK(flushes > entries.back().flushes);
+
+    // after stop() messages are written synchronously
+    log(async, "after");
+    entries = target.getEntries();
+    BOOST_REQUIRE_EQUAL(101, entries.size());
+    BOOST_CHECK_EQUAL("after", entries.back().message);
+    BOOST_CHECK_EQUAL(flushes + 1, target.getFlushes());
+}
+
+BOOST_AUTO_TEST_CASE(restart) {
+    RecordingLogHandler target;
+    AsyncLogHandler async(target);
+
+    // the thread's buffer is reused across a stop and start
+    for (int r = 0; r < 3; ++r) {
+        async.start();
+        log(async, std::to_string(r));
+        async.stop();
+    }
+
+    std::vector<RecordingLogHandler::Entry> entries = target.getEntries();
+    BOOST_REQUIRE_EQUAL(3, entries.size());
+    for (int r = 0; r < 3; ++r)
+        BOOST_CHECK_EQUAL(std::to_string(r), entries[r].message);
+    BOOST_CHECK_EQUAL(0, async.getDropped());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
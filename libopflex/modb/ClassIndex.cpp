@@ -92,6 +92,16 @@ void ClassIndex::getChildren(const URI& parent, prop_id_t parent_prop,
     }
 }
 
+const OF_UNORDERED_SET<URI>*
+ClassIndex::getChildSet(const URI& parent, prop_id_t parent_prop) const {
+    uri_prop_uri_map_t::const_iterator cit = child_map.find(parent);
+    if (cit == child_map.end()) return NULL;
+
+    prop_uri_map_t::const_iterator pit = cit->second.find(parent_prop);
+    if (pit == cit->second.end()) return NULL;
+    return &pit->second;
+}
+
 const std::pair<URI, prop_id_t>& ClassIndex::getParent(const URI& child) const {
     return parent_map.at(child);
 }
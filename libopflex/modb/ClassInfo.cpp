@@ -15,6 +15,9 @@
 #endif
 
 
+#include <cstring>
+#include <stdexcept>
+
 #include "opflex/modb/ClassInfo.h"
 
 namespace opflex {
@@ -32,8 +35,96 @@ ClassInfo::ClassInfo(class_id_t class_id_,
     std::vector<PropertyInfo>::const_iterator it;
     for (it = properties_.begin(); it != properties_.end(); ++it) {
         properties[it->getId()] = *it;
-        prop_names[it->getName()] = it->getId();
     }
+    initPropIndex(NameIndex());
+}
+
+ClassInfo::ClassInfo(class_id_t class_id_,
+                     class_type_t class_type_,
+                     const std::string& class_name_,
+                     const std::string& owner_,
+                     const std::vector<PropertyInfo>& properties_,
+                     const NameIndex& prop_index_)
+    : class_id(class_id_),
+      class_type(class_type_),
+      class_name(class_name_),
+      owner(owner_) {
+    std::vector<PropertyInfo>::const_iterator it;
+    for (it = properties_.begin(); it != properties_.end(); ++it) {
+        properties[it->getId()] = *it;
+    }
+    initPropIndex(prop_index_);
+}
+
+ClassInfo::ClassInfo(const ClassInfo& other)
+    : class_id(other.class_id),
+      class_type(other.class_type),
+      class_name(other.class_name),
+      owner(other.owner),
+      properties(other.properties),
+      prop_index(other.prop_index) {
+    initPropSlots();
+}
+
+ClassInfo& ClassInfo::operator=(const ClassInfo& other) {
+    if (this == &other) return *this;
+    class_id = other.class_id;
+    class_type = other.class_type;
+    class_name = other.class_name;
+    owner = other.owner;
+    properties = other.properties;
+    prop_index = other.prop_index;
+    initPropSlots();
+    return *this;
+}
+
+void ClassInfo::initPropIndex(const NameIndex& index) {
+    prop_index = index;
+    initPropSlots();
+    property_map_t::const_iterator it;
+    for (it = properties.begin(); it != properties.end(); ++it) {
+        const std::string& name = it->second.getName();
+        if (findProperty(name.data(), name.size()) != &it->second)
+            break;
+    }
+    if (it == properties.end()) return;
+
+    // the index is missing or was generated for another version of
+    // the model
+    std::vector<std::pair<std::string, uint64_t> > names;
+    for (it = properties.begin(); it != properties.end(); ++it) {
+        names.push_back(std::make_pair(it->second.getName(), it->first));
+    }
+    prop_index = NameIndex::build(names);
+    initPropSlots();
+}
+
+void ClassInfo::initPropSlots() {
+    prop_slots.assign(prop_index.size(), NULL);
+    for (size_t i = 0; i < prop_slots.size(); ++i) {
+        property_map_t::const_iterator it =
+            properties.find(prop_index.getId(i));
+        if (it != properties.end())
+            prop_slots[i] = &it->second;
+    }
+}
+
+const PropertyInfo& ClassInfo::getProperty(const std::string& name) const {
+    const PropertyInfo* pinfo = findProperty(name.data(), name.size());
+    if (!pinfo)
+        throw std::out_of_range("No property " + name);
+    return *pinfo;
+}
+
+const PropertyInfo* ClassInfo::findProperty(const char* name,
+                                            size_t len) const {
+    if (prop_slots.empty()) return NULL;
+    const PropertyInfo* pinfo = prop_slots[prop_index.slot(name, len)];
+    if (!pinfo) return NULL;
+    const std::string& pname = pinfo->getName();
+    if (pname.size() != len || std::memcmp(pname.data(), name, len) != 0)
+        return NULL;
+    return pinfo;
 }
 
 ClassInfo::~ClassInfo() {
@@ -23,7 +23,34 @@ namespace modb {
 ModelMetadata::ModelMetadata(const std::string& name,
                              const std::vector<ClassInfo>& classes_)
     : classes(classes_) {
-    
+    initClassIndex(NameIndex());
+}
+
+ModelMetadata::ModelMetadata(const std::string& name,
+                             const std::vector<ClassInfo>& classes_,
+                             const NameIndex& class_index_)
+    : classes(classes_) {
+    initClassIndex(class_index_);
+}
+
+void ModelMetadata::initClassIndex(const NameIndex& index) {
+    class_index = index;
+    std::vector<ClassInfo>::const_iterator it;
+    for (it = classes.begin(); it != classes.end(); ++it) {
+        uint64_t id;
+        if (!class_index.find(it->getName().data(), it->getName().size(), id)
+            || id != it->getId())
+            break;
+    }
+    if (it == classes.end()) return;
+
+    // the index is missing or was generated for another version of
+    // the model
+    std::vector<std::pair<std::string, uint64_t> > names;
+    for (it = classes.begin(); it != classes.end(); ++it) {
+        names.push_back(std::make_pair(it->getName(), it->getId()));
+    }
+    class_index = NameIndex::build(names);
 }
 
 ModelMetadata::~ModelMetadata() {
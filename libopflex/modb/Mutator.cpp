@@ -17,6 +17,7 @@
 
 #include <utility>
 #include <stdexcept>
+#include <vector>
 
 #include <boost/foreach.hpp>
 
@@ -39,7 +40,13 @@ using mointernal::ObjectInstance;
 typedef OF_UNORDERED_SET<reference_t > uri_set_t;
 typedef OF_UNORDERED_MAP<prop_id_t, uri_set_t> prop_uri_map_t;
 typedef OF_UNORDERED_MAP<reference_t, prop_uri_map_t> uri_prop_uri_map_t;
-typedef OF_UNORDERED_MAP<URI, OF_SHARED_PTR<ObjectInstance> > obj_map_t;
+
+// a modified object and the object in the store it was copied from
+struct ModifiedObject {
+    OF_SHARED_PTR<ObjectInstance> oi;
+    OF_SHARED_PTR<const ObjectInstance> orig;
+};
+typedef OF_UNORDERED_MAP<URI, ModifiedObject> obj_map_t;
 
 class Mutator::MutatorImpl {
 public:
@@ -87,19 +94,20 @@ OF_SHARED_PTR<ObjectInstance>& Mutator::modify(class_id_t class_id,
                                                const URI& uri) {
     // check for copy in mutator
     obj_map_t::iterator it = pimpl->obj_map.find(uri);
-    if (it != pimpl->obj_map.end()) return it->second;
-    OF_SHARED_PTR<ObjectInstance> copy;
-    OF_SHARED_PTR<const ObjectInstance> oi;
-    if (pimpl->client.get(class_id, uri, oi)) {
-        copy = OF_MAKE_SHARED<ObjectInstance>(*oi.get());
+    if (it != pimpl->obj_map.end()) return it->second.oi;
+    ModifiedObject mo;
+    if (pimpl->client.get(class_id, uri, mo.orig)) {
+        // the copy shares its properties with the original until
+        // they are written
+        mo.oi = OF_MAKE_SHARED<ObjectInstance>(*mo.orig);
     } else {
         // create new object
-        copy = OF_MAKE_SHARED<ObjectInstance>(class_id);
+        mo.oi = OF_MAKE_SHARED<ObjectInstance>(class_id);
     }
 
     pair<obj_map_t::iterator, bool> r =
-        pimpl->obj_map.insert(obj_map_t::value_type(uri, copy));
-    return r.first->second;
+        pimpl->obj_map.insert(obj_map_t::value_type(uri, mo));
+    return r.first->second.oi;
 }
 
 void Mutator::remove(class_id_t class_id, const URI& uri) {
@@ -109,13 +117,20 @@ void Mutator::remove(class_id_t class_id, const URI& uri) {
 void Mutator::commit() {
     StoreClient::notif_t raw_notifs;
     StoreClient::notif_t notifs;
+    std::vector<StoreClient::PutRequest> puts;
+    puts.reserve(pimpl->obj_map.size());
     BOOST_FOREACH(obj_map_t::value_type& objt, pimpl->obj_map) {
-        if (pimpl->client.putIfModified(objt.second->getClassId(),
-                                        objt.first,
-                                        objt.second))
-            raw_notifs[objt.first] = objt.second->getClassId();
-
+        // new objects move their properties into a base that later
+        // copies will share
+        if (!objt.second.orig)
+            objt.second.oi->compact();
+        StoreClient::PutRequest req = {
+            objt.second.oi->getClassId(), objt.first,
+            objt.second.oi, objt.second.orig
+        };
+        puts.push_back(req);
     }
+    pimpl->client.putIfModified(puts, raw_notifs);
     BOOST_FOREACH(uri_prop_uri_map_t::value_type& upt, pimpl->added_children) {
         BOOST_FOREACH(prop_uri_map_t::value_type& pt, upt.second) {
             BOOST_FOREACH(const reference_t& ut, pt.second) {
@@ -0,0 +1,104 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for NameIndex class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "opflex/modb/NameIndex.h"
+#include "opflex/ofcore/OFTypes.h"
+
+namespace opflex {
+namespace modb {
+
+NameIndex::NameIndex(const uint32_t* seeds_, const uint64_t* ids_,
+                     size_t size)
+    : seeds(seeds_, seeds_ + size), ids(ids_, ids_ + size) {}
+
+static bool bucketLarger(const std::vector<size_t>* a,
+                         const std::vector<size_t>* b) {
+    return a->size() > b->size();
+}
+
+NameIndex NameIndex::build(const std::vector<std::pair<std::string,
+                                                       uint64_t> >& names) {
+    // keep the last ID for each name
+    OF_UNORDERED_MAP<std::string, size_t> last;
+    for (size_t i = 0; i < names.size(); ++i)
+        last[names[i].first] = i;
+    std::vector<size_t> keys;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (last[names[i].first] == i)
+            keys.push_back(i);
+    }
+
+    NameIndex index;
+    size_t n = keys.size();
+    if (n == 0) return index;
+
+    std::vector<uint64_t> hashes(names.size());
+    std::vector<std::vector<size_t> > buckets(n);
+    for (size_t k : keys) {
+        const std::string& name = names[k].first;
+        hashes[k] = hash(name.data(), name.size());
+        buckets[reduce(mix(hashes[k], 0), n)].push_back(k);
+    }
+
+    // place the largest buckets first, while most slots are free
+    std::vector<const std::vector<size_t>*> order;
+    for (const std::vector<size_t>& b : buckets)
+        order.push_back(&b);
+    std::stable_sort(order.begin(), order.end(), bucketLarger);
+
+    index.seeds.resize(n, 0);
+    index.ids.resize(n, 0);
+    std::vector<bool> used(n, false);
+    std::vector<size_t> slots;
+    for (const std::vector<size_t>* b : order) {
+        if (b->empty()) break;
+        size_t bucket = reduce(mix(hashes[b->front()], 0), n);
+        // names with the same hash could never get slots of their own
+        for (size_t i = 1; i < b->size(); ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                if (hashes[(*b)[i]] == hashes[(*b)[j]])
+                    throw std::runtime_error("Could not build name index");
+            }
+        }
+        for (uint32_t seed = 1; ; ++seed) {
+            if (seed == 0)
+                throw std::runtime_error("Could not build name index");
+            slots.clear();
+            for (size_t k : *b) {
+                size_t slot = reduce(mix(hashes[k], seed), n);
+                if (used[slot] ||
+                    std::find(slots.begin(), slots.end(), slot) != slots.end())
+                    break;
+                slots.push_back(slot);
+            }
+            if (slots.size() < b->size()) continue;
+
+            index.seeds[bucket] = seed;
+            for (size_t i = 0; i < slots.size(); ++i) {
+                used[slots[i]] = true;
+                index.ids[slots[i]] = names[(*b)[i]].second;
+            }
+            break;
+        }
+    }
+    return index;
+}
+
+} /* namespace modb */
+} /* namespace opflex */
@@ -77,6 +77,8 @@ ObjectInstance::Value::Value(const Value& val)
             value = new vector<reference_t>(*get<vector<reference_t>*>(val.value));
         else if (type == PropertyInfo::STRING)
             value = new vector<string>(*get<vector<string>*>(val.value));
+        else if (type == PropertyInfo::MAC)
+            value = new vector<MAC>(*get<vector<MAC>*>(val.value));
     }
 }
 
@@ -99,6 +101,8 @@ void ObjectInstance::Value::clear() {
             delete get<vector<reference_t>*>(value);
         else if (type == PropertyInfo::STRING)
             delete get<vector<string>*>(value);
+        else if (type == PropertyInfo::MAC)
+            delete get<vector<MAC>*>(value);
     }
 }
 
@@ -120,261 +124,342 @@ ObjectInstance::Value& ObjectInstance::Value::operator=(const Value& val) {
             value = new vector<reference_t>(*get<vector<reference_t>*>(val.value));
         else if (type == PropertyInfo::STRING)
             value = new vector<string>(*get<vector<string>*>(val.value));
+        else if (type == PropertyInfo::MAC)
+            value = new vector<MAC>(*get<vector<MAC>*>(val.value));
     }
     return *this;
 }
 
+void ObjectInstance::Value::swap(Value& val) {
+    std::swap(type, val.type);
+    std::swap(cardinality, val.cardinality);
+    value.swap(val.value);
+}
+
+ObjectInstance& ObjectInstance::operator=(const ObjectInstance& oi) {
+    class_id = oi.class_id;
+    base = oi.base;
+    delta = oi.delta;
+    removed = oi.removed;
+    modified_props.clear();
+    local = oi.local;
+    return *this;
+}
+
+const ObjectInstance::Value*
+ObjectInstance::find(const prop_key_t& key) const {
+    auto it = delta.find(key);
+    if (it != delta.end()) return &it->second;
+    if (!base || (!removed.empty() && removed.count(key))) return NULL;
+    auto bit = base->find(key);
+    return bit != base->end() ? &bit->second : NULL;
+}
+
+const ObjectInstance::Value&
+ObjectInstance::at(const prop_key_t& key) const {
+    const Value* v = find(key);
+    if (!v) throw std::out_of_range("Property not set");
+    return *v;
+}
+
+size_t ObjectInstance::size() const {
+    size_t n = delta.size();
+    if (base) {
+        BOOST_FOREACH(const prop_map_t::value_type& v, *base) {
+            if (delta.find(v.first) == delta.end() &&
+                removed.find(v.first) == removed.end())
+                n += 1;
+        }
+    }
+    return n;
+}
+
+bool ObjectInstance::isModifiedFrom(const ObjectInstance& orig) const {
+    BOOST_FOREACH(const prop_key_t& key, modified_props) {
+        const Value* v = find(key);
+        const Value* ov = orig.find(key);
+        if (!v || !ov) {
+            if (v || ov) return true;
+        } else if (*v != *ov) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool ObjectInstance::isSet(prop_id_t prop_id,
                            PropertyInfo::property_type_t type,
                            PropertyInfo::cardinality_t cardinality) const {
     type = normalize(type);
-    return prop_map.find(make_tuple(type,
-                                    cardinality,
-                                    prop_id)) != prop_map.end();
+    return find(make_tuple(type, cardinality, prop_id)) != NULL;
 }
 
 bool ObjectInstance::unset(prop_id_t prop_id,
                            PropertyInfo::property_type_t type,
                            PropertyInfo::cardinality_t cardinality) {
     type = normalize(type);
-    auto it = prop_map.find(make_tuple(type, cardinality, prop_id));
-    if (it == prop_map.end()) return false;
-
-    prop_map.erase(it);
+    prop_key_t key = make_tuple(type, cardinality, prop_id);
+    if (!find(key)) return false;
+
+    markModified(key);
+    delta.erase(key);
+    if (base && base->find(key) != base->end())
+        removed.insert(key);
+    maybeCompact();
     return true;
 }
 
 uint64_t ObjectInstance::getUInt64(prop_id_t prop_id) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::U64,
-                                            PropertyInfo::SCALAR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::U64,
+                                   PropertyInfo::SCALAR,
+                                   prop_id));
     return get<uint64_t>(v.value);
 }
 
 uint64_t ObjectInstance::getUInt64(prop_id_t prop_id,
                                    size_t index) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::U64,
-                                            PropertyInfo::VECTOR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::U64,
+                                   PropertyInfo::VECTOR,
+                                   prop_id));
     return get<vector<uint64_t>*>(v.value)->at(index);
 }
 
 size_t ObjectInstance::getUInt64Size(prop_id_t prop_id) const {
-    auto it =
-        prop_map.find(make_tuple(PropertyInfo::U64,
-                                 PropertyInfo::VECTOR,
-                                 prop_id));
-    if (it == prop_map.end()) return 0;
-    return get<vector<uint64_t>*>(it->second.value)->size();
+    const Value* v = find(make_tuple(PropertyInfo::U64,
+                                     PropertyInfo::VECTOR,
+                                     prop_id));
+    if (!v) return 0;
+    return get<vector<uint64_t>*>(v->value)->size();
 }
 
 const MAC& ObjectInstance::getMAC(prop_id_t prop_id) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::MAC,
-                                            PropertyInfo::SCALAR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::MAC,
+                                   PropertyInfo::SCALAR,
+                                   prop_id));
     return get<MAC>(v.value);
 }
 
 const MAC& ObjectInstance::getMAC(prop_id_t prop_id,
                                    size_t index) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::MAC,
-                                            PropertyInfo::VECTOR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::MAC,
+                                   PropertyInfo::VECTOR,
+                                   prop_id));
     return get<vector<MAC>*>(v.value)->at(index);
 }
 
 size_t ObjectInstance::getMACSize(prop_id_t prop_id) const {
-    auto it =
-        prop_map.find(make_tuple(PropertyInfo::MAC,
-                                 PropertyInfo::VECTOR,
-                                 prop_id));
-    if (it == prop_map.end()) return 0;
-    return get<vector<MAC>*>(it->second.value)->size();
+    const Value* v = find(make_tuple(PropertyInfo::MAC,
+                                     PropertyInfo::VECTOR,
+                                     prop_id));
+    if (!v) return 0;
+    return get<vector<MAC>*>(v->value)->size();
 }
 
 int64_t ObjectInstance::getInt64(prop_id_t prop_id) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::S64,
-                                            PropertyInfo::SCALAR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::S64,
+                                   PropertyInfo::SCALAR,
+                                   prop_id));
     return get<int64_t>(v.value);
 }
 
 int64_t ObjectInstance::getInt64(prop_id_t prop_id,
                                  size_t index) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::S64,
-                                            PropertyInfo::VECTOR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::S64,
+                                   PropertyInfo::VECTOR,
+                                   prop_id));
     return get<vector<int64_t>*>(v.value)->at(index);
 }
 
 size_t ObjectInstance::getInt64Size(prop_id_t prop_id) const {
-    auto it =
-        prop_map.find(make_tuple(PropertyInfo::S64,
-                                 PropertyInfo::VECTOR,
-                                 prop_id));
-    if (it == prop_map.end()) return 0;
-    return get<vector<int64_t>*>(it->second.value)->size();
+    const Value* v = find(make_tuple(PropertyInfo::S64,
+                                     PropertyInfo::VECTOR,
+                                     prop_id));
+    if (!v) return 0;
+    return get<vector<int64_t>*>(v->value)->size();
 }
 
 const string& ObjectInstance::getString(prop_id_t prop_id) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::STRING,
-                                            PropertyInfo::SCALAR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::STRING,
+                                   PropertyInfo::SCALAR,
+                                   prop_id));
     return get<string>(v.value);
 }
 
 const string& ObjectInstance::getString(prop_id_t prop_id,
                                         size_t index) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::STRING,
-                                            PropertyInfo::VECTOR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::STRING,
+                                   PropertyInfo::VECTOR,
+                                   prop_id));
     return get<vector<string>*>(v.value)->at(index);
 }
 
 size_t ObjectInstance::getStringSize(prop_id_t prop_id) const {
-    auto it =
-        prop_map.find(make_tuple(PropertyInfo::STRING,
-                                 PropertyInfo::VECTOR,
-                                 prop_id));
-    if (it == prop_map.end()) return 0;
-    return get<vector<string>*>(it->second.value)->size();
+    const Value* v = find(make_tuple(PropertyInfo::STRING,
+                                     PropertyInfo::VECTOR,
+                                     prop_id));
+    if (!v) return 0;
+    return get<vector<string>*>(v->value)->size();
 }
 
 reference_t ObjectInstance::getReference(prop_id_t prop_id) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::REFERENCE,
-                                            PropertyInfo::SCALAR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::REFERENCE,
+                                   PropertyInfo::SCALAR,
+                                   prop_id));
     return get<reference_t>(v.value);
 }
 
 reference_t ObjectInstance::getReference(prop_id_t prop_id,
                                          size_t index) const {
-    const Value& v = prop_map.at(make_tuple(PropertyInfo::REFERENCE,
-                                            PropertyInfo::VECTOR,
-                                            prop_id));
+    const Value& v = at(make_tuple(PropertyInfo::REFERENCE,
+                                   PropertyInfo::VECTOR,
+                                   prop_id));
     return get<vector<reference_t>*>(v.value)->at(index);
 }
 
 size_t ObjectInstance::getReferenceSize(prop_id_t prop_id) const {
-    auto it =
-        prop_map.find(make_tuple(PropertyInfo::REFERENCE,
-                                 PropertyInfo::VECTOR,
-                                 prop_id));
-    if (it == prop_map.end()) return 0;
-    return get<vector<reference_t>*>(it->second.value)->size();
+    const Value* v = find(make_tuple(PropertyInfo::REFERENCE,
+                                     PropertyInfo::VECTOR,
+                                     prop_id));
+    if (!v) return 0;
+    return get<vector<reference_t>*>(v->value)->size();
+}
+
+void ObjectInstance::markModified(const prop_key_t& key) {
+    // vector properties are usually built by repeated writes to the
+    // same key
+    if (modified_props.empty() || modified_props.back() != key)
+        modified_props.push_back(key);
+}
+
+ObjectInstance::Value& ObjectInstance::write(const prop_key_t& key) {
+    markModified(key);
+    auto it = delta.find(key);
+    if (it != delta.end()) return it->second;
+
+    // copy the value from the shared base before modifying it
+    Value& v = delta[key];
+    if (!removed.empty() && removed.erase(key)) return v;
+    if (base) {
+        auto bit = base->find(key);
+        if (bit != base->end()) v = bit->second;
+    }
+    return v;
+}
+
+void ObjectInstance::setValue(const prop_key_t& key, Value& value) {
+    const Value* cur = find(key);
+    if (cur && *cur == value) return;
+
+    markModified(key);
+    if (!removed.empty()) removed.erase(key);
+    delta[key].swap(value);
+    maybeCompact();
+}
+
+void ObjectInstance::maybeCompact() {
+    // keep the changes small compared to the base, so that copies
+    // stay cheap and the base is rebuilt only occasionally
+    size_t baseSize = base ? base->size() : 0;
+    if (delta.size() + removed.size() > 8 + baseSize / 8)
+        compact();
+}
+
+void ObjectInstance::compact() {
+    if (delta.empty() && removed.empty())
+        return;
+    if (!base) {
+        base = OF_MAKE_SHARED<prop_map_t>(std::move(delta));
+        delta.clear();
+        return;
+    }
+    OF_SHARED_PTR<prop_map_t> merged = OF_MAKE_SHARED<prop_map_t>(*base);
+    BOOST_FOREACH(const prop_key_t& key, removed) {
+        merged->erase(key);
+    }
+    BOOST_FOREACH(prop_map_t::value_type& v, delta) {
+        (*merged)[v.first].swap(v.second);
+    }
+    base = merged;
+    delta.clear();
+    removed.clear();
 }
 
 void ObjectInstance::setUInt64(prop_id_t prop_id, uint64_t value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::U64,
-                                   PropertyInfo::SCALAR,
-                                   prop_id)];
-    v.type = PropertyInfo::U64;
-    v.cardinality = PropertyInfo::SCALAR;
+    Value v(PropertyInfo::U64, PropertyInfo::SCALAR);
     v.value = value;
+    setValue(make_tuple(PropertyInfo::U64, PropertyInfo::SCALAR, prop_id), v);
 }
 
 void ObjectInstance::setUInt64(prop_id_t prop_id,
                                const vector<uint64_t>& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::U64,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
-    v.type = PropertyInfo::U64;
-    v.cardinality = PropertyInfo::VECTOR;
-    if (v.value.which() != 0)
-        delete get<vector<uint64_t>*>(v.value);
+    Value v(PropertyInfo::U64, PropertyInfo::VECTOR);
     v.value = new vector<uint64_t>(value);
+    setValue(make_tuple(PropertyInfo::U64, PropertyInfo::VECTOR, prop_id), v);
 }
 
 void ObjectInstance::setMAC(prop_id_t prop_id, const MAC& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::MAC,
-                                   PropertyInfo::SCALAR,
-                                   prop_id)];
-    v.type = PropertyInfo::MAC;
-    v.cardinality = PropertyInfo::SCALAR;
+    Value v(PropertyInfo::MAC, PropertyInfo::SCALAR);
     v.value = value;
+    setValue(make_tuple(PropertyInfo::MAC, PropertyInfo::SCALAR, prop_id), v);
 }
 
 void ObjectInstance::setMAC(prop_id_t prop_id,
                                const vector<MAC>& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::MAC,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
-    v.type = PropertyInfo::MAC;
-    v.cardinality = PropertyInfo::VECTOR;
-    if (v.value.which() != 0)
-        delete get<vector<MAC>*>(v.value);
+    Value v(PropertyInfo::MAC, PropertyInfo::VECTOR);
     v.value = new vector<MAC>(value);
+    setValue(make_tuple(PropertyInfo::MAC, PropertyInfo::VECTOR, prop_id), v);
 }
 
 void ObjectInstance::setInt64(prop_id_t prop_id, int64_t value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::S64,
-                                   PropertyInfo::SCALAR,
-                                   prop_id)];
-    v.type = PropertyInfo::S64;
-    v.cardinality = PropertyInfo::SCALAR;
+    Value v(PropertyInfo::S64, PropertyInfo::SCALAR);
     v.value = value;
+    setValue(make_tuple(PropertyInfo::S64, PropertyInfo::SCALAR, prop_id), v);
 }
 
 void ObjectInstance::setInt64(prop_id_t prop_id,
                               const vector<int64_t>& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::S64,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
-    v.type = PropertyInfo::S64;
-    v.cardinality = PropertyInfo::VECTOR;
-    if (v.value.which() != 0)
-        delete get<vector<int64_t>*>(v.value);
+    Value v(PropertyInfo::S64, PropertyInfo::VECTOR);
     v.value = new vector<int64_t>(value);
+    setValue(make_tuple(PropertyInfo::S64, PropertyInfo::VECTOR, prop_id), v);
 }
 
 void ObjectInstance::setString(prop_id_t prop_id, const string& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::STRING,
-                                   PropertyInfo::SCALAR,
-                                   prop_id)];
-    v.type = PropertyInfo::STRING;
-    v.cardinality = PropertyInfo::SCALAR;
+    Value v(PropertyInfo::STRING, PropertyInfo::SCALAR);
     v.value = value;
+    setValue(make_tuple(PropertyInfo::STRING, PropertyInfo::SCALAR, prop_id),
+             v);
 }
 
 void ObjectInstance::setString(prop_id_t prop_id,
                                const vector<string>& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::STRING,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
-    v.type = PropertyInfo::STRING;
-    v.cardinality = PropertyInfo::VECTOR;
-    if (v.value.which() != 0)
-        delete get<vector<string>*>(v.value);
+    Value v(PropertyInfo::STRING, PropertyInfo::VECTOR);
     v.value = new vector<string>(value);
+    setValue(make_tuple(PropertyInfo::STRING, PropertyInfo::VECTOR, prop_id),
+             v);
 }
 
 
 void ObjectInstance::setReference(prop_id_t prop_id,
                                   class_id_t class_id, const URI& uri) {
-    Value& v = prop_map[make_tuple(PropertyInfo::REFERENCE,
-                                   PropertyInfo::SCALAR,
-                                   prop_id)];
-    v.type = PropertyInfo::REFERENCE;
-    v.cardinality = PropertyInfo::SCALAR;
+    Value v(PropertyInfo::REFERENCE, PropertyInfo::SCALAR);
     v.value = make_pair(class_id, uri);
+    setValue(make_tuple(PropertyInfo::REFERENCE, PropertyInfo::SCALAR,
+                        prop_id), v);
 }
 
 void ObjectInstance::setReference(prop_id_t prop_id,
                                   const vector<reference_t>& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::REFERENCE,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
-    v.type = PropertyInfo::REFERENCE;
-    v.cardinality = PropertyInfo::VECTOR;
-    if (v.value.which() != 0)
-        delete get<vector<reference_t>*>(v.value);
+    Value v(PropertyInfo::REFERENCE, PropertyInfo::VECTOR);
     v.value = new vector<reference_t>(value);
+    setValue(make_tuple(PropertyInfo::REFERENCE, PropertyInfo::VECTOR,
+                        prop_id), v);
 }
 
 void ObjectInstance::addUInt64(prop_id_t prop_id, uint64_t value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::U64,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
+    prop_key_t key = make_tuple(PropertyInfo::U64,
+                                PropertyInfo::VECTOR,
+                                prop_id);
+    Value& v = write(key);
     vector<uint64_t>* val;
     if (v.value.which() == 0) {
         v.type = PropertyInfo::U64;
@@ -384,12 +469,14 @@ void ObjectInstance::addUInt64(prop_id_t prop_id, uint64_t value) {
         val = get<vector<uint64_t>*>(v.value);
     }
     val->push_back(value);
+    maybeCompact();
 }
 
 void ObjectInstance::addMAC(prop_id_t prop_id, const MAC& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::MAC,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
+    prop_key_t key = make_tuple(PropertyInfo::MAC,
+                                PropertyInfo::VECTOR,
+                                prop_id);
+    Value& v = write(key);
     vector<MAC>* val;
     if (v.value.which() == 0) {
         v.type = PropertyInfo::MAC;
@@ -399,12 +486,14 @@ void ObjectInstance::addMAC(prop_id_t prop_id, const MAC& value) {
         val = get<vector<MAC>*>(v.value);
     }
     val->push_back(value);
+    maybeCompact();
 }
 
 void ObjectInstance::addInt64(prop_id_t prop_id, int64_t value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::S64,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
+    prop_key_t key = make_tuple(PropertyInfo::S64,
+                                PropertyInfo::VECTOR,
+                                prop_id);
+    Value& v = write(key);
     vector<int64_t>* val;
     if (v.value.which() == 0) {
         v.type = PropertyInfo::S64;
@@ -414,12 +503,14 @@ void ObjectInstance::addInt64(prop_id_t prop_id, int64_t value) {
         val = get<vector<int64_t>*>(v.value);
     }
     val->push_back(value);
+    maybeCompact();
 }
 
 void ObjectInstance::addString(prop_id_t prop_id, const string& value) {
-    Value& v = prop_map[make_tuple(PropertyInfo::STRING,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
+    prop_key_t key = make_tuple(PropertyInfo::STRING,
+                                PropertyInfo::VECTOR,
+                                prop_id);
+    Value& v = write(key);
     vector<string>* val;
     if (v.value.which() == 0) {
         v.type = PropertyInfo::STRING;
@@ -429,14 +520,16 @@ void ObjectInstance::addString(prop_id_t prop_id, const string& value) {
         val = get<vector<string>*>(v.value);
     }
     val->push_back(value);
+    maybeCompact();
 }
 
 void ObjectInstance::addReference(prop_id_t prop_id,
                                   class_id_t class_id,
                                   const URI& uri) {
-    Value& v = prop_map[make_tuple(PropertyInfo::REFERENCE,
-                                   PropertyInfo::VECTOR,
-                                   prop_id)];
+    prop_key_t key = make_tuple(PropertyInfo::REFERENCE,
+                                PropertyInfo::VECTOR,
+                                prop_id);
+    Value& v = write(key);
     vector<reference_t>* val;
     if (v.value.which() == 0) {
         v.type = PropertyInfo::REFERENCE;
@@ -446,6 +539,7 @@ void ObjectInstance::addReference(prop_id_t prop_id,
         val = get<vector<reference_t>*>(v.value);
     }
     val->push_back(make_pair(class_id, uri));
+    maybeCompact();
 }
 
 template <typename T>
@@ -505,16 +599,18 @@ bool operator!=(const ObjectInstance::Value& lhs,
 }
 
 bool operator==(const ObjectInstance& lhs, const ObjectInstance& rhs) {
+    if (lhs.size() != rhs.size()) return false;
     BOOST_FOREACH(const ObjectInstance::prop_map_t::value_type& v,
-                  lhs.prop_map) {
-        auto it = rhs.prop_map.find(v.first);
-        if (it == rhs.prop_map.end()) return false;
-        if (v.second != it->second) return false;
+                  lhs.delta) {
+        const ObjectInstance::Value* rv = rhs.find(v.first);
+        if (!rv || v.second != *rv) return false;
     }
-    BOOST_FOREACH(ObjectInstance::prop_map_t::value_type v,
-                  rhs.prop_map) {
-        auto it = lhs.prop_map.find(v.first);
-        if (it == rhs.prop_map.end()) return false;
+    if (!lhs.base) return true;
+    BOOST_FOREACH(const ObjectInstance::prop_map_t::value_type& v,
+                  *lhs.base) {
+        if (lhs.find(v.first) != &v.second) continue;
+        const ObjectInstance::Value* rv = rhs.find(v.first);
+        if (!rv || v.second != *rv) return false;
     }
     return true;
 }
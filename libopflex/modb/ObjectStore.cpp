@@ -14,6 +14,7 @@
 #  include <config.h>
 #endif
 
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/foreach.hpp>
@@ -45,6 +46,7 @@ ObjectStore::~ObjectStore() {
 }
 
 void ObjectStore::init(const ModelMetadata& model) {
+    bool first = class_map.empty();
     std::vector<ClassInfo>::const_iterator it;
     for (it = model.getClasses().begin();
          it != model.getClasses().end();
@@ -58,7 +60,6 @@ void ObjectStore::init(const ModelMetadata& model) {
         ClassContext& cc = class_map[it->getId()];
         cc.region = r;
         cc.classInfo = *it;
-        class_name_map[cc.classInfo.getName()] = &cc.classInfo;
 
         ClassInfo::property_map_t::const_iterator pit;
         for (pit = cc.classInfo.getProperties().begin();
@@ -67,6 +68,23 @@ void ObjectStore::init(const ModelMetadata& model) {
             prop_map[pit->second.getId()] = &cc.classInfo;
         }
     }
+
+    if (first) {
+        class_index = model.getClassIndex();
+    } else {
+        std::vector<std::pair<std::string, uint64_t> > names;
+        BOOST_FOREACH(const class_map_t::value_type& c, class_map) {
+            names.push_back(std::make_pair(c.second.classInfo.getName(),
+                                           c.first));
+        }
+        class_index = NameIndex::build(names);
+    }
+    class_slots.assign(class_index.size(), NULL);
+    for (size_t i = 0; i < class_slots.size(); ++i) {
+        class_map_t::const_iterator cit = class_map.find(class_index.getId(i));
+        if (cit != class_map.end())
+            class_slots[i] = &cit->second.classInfo;
+    }
 }
 
 ObjectStore::NotifQueueProc::NotifQueueProc(ObjectStore* store_)
@@ -130,7 +148,21 @@ const ClassInfo& ObjectStore::getClassInfo(class_id_t class_id) const {
 }
 
 const ClassInfo& ObjectStore::getClassInfo(const std::string& class_name) const {
-    return *class_name_map.at(class_name);
+    const ClassInfo* ci = findClassInfo(class_name.data(), class_name.size());
+    if (!ci)
+        throw std::out_of_range("No class " + class_name);
+    return *ci;
+}
+
+const ClassInfo* ObjectStore::findClassInfo(const char* class_name,
+                                            size_t len) const {
+    if (class_slots.empty()) return NULL;
+    const ClassInfo* ci = class_slots[class_index.slot(class_name, len)];
+    if (!ci) return NULL;
+    const std::string& name = ci->getName();
+    if (name.size() != len || std::memcmp(name.data(), class_name, len) != 0)
+        return NULL;
+    return ci;
 }
 
 const ClassInfo& ObjectStore::getPropClassInfo(prop_id_t prop_id) const {
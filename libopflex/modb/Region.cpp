@@ -102,6 +102,35 @@ bool Region::putIfModified(class_id_t class_id, const URI& uri,
     }
 }
 
+void Region::putIfModified(const vector<const mointernal::StoreClient
+                           ::PutRequest*>& objs,
+                           /* out */ mointernal::StoreClient::notif_t& modified) {
+    LockGuard guard(&region_mutex);
+    BOOST_FOREACH(const mointernal::StoreClient::PutRequest* req, objs) {
+        class_map_t::iterator cit = class_map.find(req->class_id);
+        if (cit == class_map.end())
+            throw std::out_of_range("Unknown class ID");
+        ClassIndex& ci = cit->second;
+        uri_map_t::iterator it = uri_map.find(req->uri);
+        if (it != uri_map.end()) {
+            // if the stored object is the one the new object was
+            // copied from, only its modified properties can differ
+            bool changed = (req->orig && req->orig == it->second)
+                ? req->oi->isModifiedFrom(*req->orig)
+                : *req->oi != *it->second;
+            if (!changed) continue;
+            it->second = req->oi;
+        } else {
+            uri_map[req->uri] = req->oi;
+            ci.addInstance(req->uri);
+        }
+
+        if (!ci.hasParent(req->uri))
+            roots.insert(make_pair(req->class_id, req->uri));
+        modified[req->uri] = req->class_id;
+    }
+}
+
 bool Region::remove(class_id_t class_id, const URI& uri) {
     LockGuard guard(&region_mutex);
     ClassIndex& ci = class_map.at(class_id);
@@ -146,6 +175,24 @@ void Region::getChildren(class_id_t parent_class,
     ci.getChildren(parent_uri, parent_prop, output);
 }
 
+void Region::getChildObjects(class_id_t parent_class,
+                             const URI& parent_uri,
+                             prop_id_t parent_prop,
+                             class_id_t child_class,
+                             /* out */ vector<mointernal::StoreClient
+                                               ::uri_obj_t>& output) {
+    LockGuard guard(&region_mutex);
+    const ClassIndex& ci = class_map.at(child_class);
+    const OF_UNORDERED_SET<URI>* children =
+        ci.getChildSet(parent_uri, parent_prop);
+    if (children == NULL) return;
+    BOOST_FOREACH(const URI& child, *children) {
+        uri_map_t::const_iterator it = uri_map.find(child);
+        if (it != uri_map.end())
+            output.push_back(make_pair(it->first, it->second));
+    }
+}
+
 std::pair<URI, prop_id_t> Region::getParent(class_id_t child_class,
                                             const URI& child) {
     LockGuard guard(&region_mutex);
@@ -77,6 +77,28 @@ bool StoreClient::putIfModified(class_id_t class_id,
     return r->putIfModified(class_id, uri, oi);
 }
 
+void StoreClient::putIfModified(const std::vector<PutRequest>& objs,
+                                /* out */ notif_t& modified) {
+    // group the objects by region so each region lock is taken once
+    typedef std::vector<std::pair<Region*,
+                                  std::vector<const PutRequest*> > > batches_t;
+    batches_t batches;
+    for (const PutRequest& req : objs) {
+        Region* r = checkOwner(store, readOnly, region, req.class_id);
+        batches_t::iterator bit = batches.begin();
+        while (bit != batches.end() && bit->first != r) ++bit;
+        if (bit == batches.end()) {
+            batches.push_back(std::make_pair(r,
+                                             std::vector<const PutRequest*>()));
+            bit = batches.end() - 1;
+        }
+        bit->second.push_back(&req);
+    }
+    for (batches_t::value_type& b : batches) {
+        b.first->putIfModified(b.second, modified);
+    }
+}
+
 bool StoreClient::isPresent(class_id_t class_id, const URI& uri) const {
     Region* r = store->getRegion(class_id);
     return r->isPresent(uri);
@@ -197,6 +219,16 @@ void StoreClient::getChildren(class_id_t parent_class,
                    child_class, output);
 }
 
+void StoreClient::getChildObjects(class_id_t parent_class,
+                                  const URI& parent_uri,
+                                  prop_id_t parent_prop,
+                                  class_id_t child_class,
+                                  std::vector<uri_obj_t>& output) {
+    Region* r = store->getRegion(child_class);
+    r->getChildObjects(parent_class, parent_uri, parent_prop,
+                       child_class, output);
+}
+
 bool StoreClient::getParent(class_id_t child_class, const URI& child,
                             /* out */ std::pair<URI, prop_id_t>& parent) {
     Region *r;
@@ -91,6 +91,17 @@ public:
     void getChildren(const URI& parent, prop_id_t parent_prop,
                      /* out */ std::vector<URI>& output) const ;
 
+    /**
+     * Get the children of the parent URI and property without copying
+     * them.  The set may change once the index is modified.
+     *
+     * @param parent the URI of the parent object
+     * @param parent_prop The property ID of the parent property
+     * @return the set of child URIs, or NULL if there are none
+     */
+    const OF_UNORDERED_SET<URI>* getChildSet(const URI& parent,
+                                             prop_id_t parent_prop) const;
+
     /**
      * Get the parent for the given child URI.
      *
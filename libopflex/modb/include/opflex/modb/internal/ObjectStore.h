@@ -81,6 +81,15 @@ public:
      */
     const ClassInfo& getClassInfo(const std::string& class_name) const;
 
+    /**
+     * Find the class info object for the given class name
+     * @param class_name the class name
+     * @param len the length of the class name
+     * @return the class info object, or NULL if there is no such
+     * class registered
+     */
+    const ClassInfo* findClassInfo(const char* class_name, size_t len) const;
+
     /**
      * Get the class info object associated with the given property ID
      * @param prop_id The property ID
@@ -181,7 +190,6 @@ private:
 
     typedef OF_UNORDERED_MAP<std::string, Region*> region_owner_map_t;
     typedef OF_UNORDERED_MAP<class_id_t, ClassContext> class_map_t;
-    typedef OF_UNORDERED_MAP<std::string, ClassInfo*> class_name_map_t;
     typedef OF_UNORDERED_MAP<prop_id_t, ClassInfo*> prop_map_t;
 
     /**
@@ -196,7 +204,12 @@ private:
     /**
      * Look up the class info by the name
      */
-    class_name_map_t class_name_map;
+    NameIndex class_index;
+
+    /**
+     * The class info in each slot of the name index
+     */
+    std::vector<const ClassInfo*> class_slots;
 
     /**
      * Look up the class info for a property
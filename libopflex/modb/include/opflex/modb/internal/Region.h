@@ -122,6 +122,21 @@ public:
                        const OF_SHARED_PTR<const mointernal
                        ::ObjectInstance>& oi);
 
+    /**
+     * Set each URI in the batch to the provided object instance if it
+     * has been modified, holding the region lock for the whole batch.
+     *
+     * @param objs the objects to set, which must all belong to this
+     * region
+     * @param modified the URIs and class IDs of the objects that were
+     * updated are added to this map
+     * @throws std::out_of_range if there is no such class ID
+     * registered
+     */
+    void putIfModified(const std::vector<const mointernal::StoreClient
+                       ::PutRequest*>& objs,
+                       /* out */ mointernal::StoreClient::notif_t& modified);
+
     /**
      * Remove the given URI from the region
      *
@@ -187,6 +202,26 @@ public:
                      class_id_t child_class,
                      /* out */ std::vector<URI>& output);
 
+    /**
+     * Get the children of the parent URI and property along with
+     * their object instances, and append them to the supplied vector.
+     * Children that have no object instance are skipped.
+     *
+     * @param parent_class the class ID of the parent
+     * @param parent_uri the URI of the parent object
+     * @param parent_prop the property ID in the parent object
+     * @param child_class The class of the children to retrieve
+     * @param output the output array that will get the output
+     * @throws std::out_of_range if the child class ID is not
+     * registered
+     */
+    void getChildObjects(class_id_t parent_class,
+                         const URI& parent_uri,
+                         prop_id_t parent_prop,
+                         class_id_t child_class,
+                         /* out */ std::vector<mointernal::StoreClient
+                                               ::uri_obj_t>& output);
+
     /**
      * Get the parent for the given child URI.
      *
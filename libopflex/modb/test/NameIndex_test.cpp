@@ -0,0 +1,138 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Test suite for NameIndex class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+#include "opflex/modb/ModelMetadata.h"
+#include "opflex/modb/NameIndex.h"
+#include "opflex/modb/internal/ObjectStore.h"
+#include "BaseFixture.h"
+
+using namespace opflex::modb;
+using std::string;
+using std::vector;
+using std::make_pair;
+
+BOOST_AUTO_TEST_SUITE(NameIndex_test)
+
+typedef vector<std::pair<string, uint64_t> > names_t;
+
+static uint64_t lookup(const NameIndex& index, const string& name) {
+    uint64_t id = 0;
+    BOOST_REQUIRE(index.find(name.data(), name.size(), id));
+    return id;
+}
+
+static names_t gbpNames() {
+    names_t names;
+    names.push_back(make_pair("GbpEpGroup", 121));
+    names.push_back(make_pair("GbpBridgeDomain", 73));
+    names.push_back(make_pair("GbpFloodDomain", 76));
+    names.push_back(make_pair("GbpRoutingDomain", 85));
+    names.push_back(make_pair("GbpeInstContext", 174));
+    names.push_back(make_pair("GbpSubnets", 129));
+    return names;
+}
+
+BOOST_AUTO_TEST_CASE( build ) {
+    uint64_t id;
+    BOOST_CHECK(!NameIndex().find("a", 1, id));
+    BOOST_CHECK(!NameIndex::build(names_t()).find("a", 1, id));
+
+    names_t names;
+    for (uint64_t i = 0; i < 1000; ++i)
+        names.push_back(make_pair("name" + std::to_string(i), i * 7));
+    names.push_back(make_pair("name5", 42));
+    NameIndex index = NameIndex::build(names);
+    BOOST_CHECK_EQUAL(1000, index.size());
+    for (uint64_t i = 0; i < 1000; ++i) {
+        if (i == 5) continue;
+        BOOST_CHECK_EQUAL(i * 7, lookup(index, "name" + std::to_string(i)));
+    }
+    // the last ID for a name is used
+    BOOST_CHECK_EQUAL(42, lookup(index, "name5"));
+}
+
+// tables as the code generation framework emits them for the names
+// above, so that both compute the same hash
+static const uint32_t gen_seeds[] = { 2u, 1u, 0u, 0u, 10u, 13u };
+static const uint64_t gen_ids[] = { 121ul, 174ul, 76ul, 129ul, 73ul, 85ul };
+
+BOOST_AUTO_TEST_CASE( generated ) {
+    NameIndex index(gen_seeds, gen_ids, 6);
+    names_t names = gbpNames();
+    for (size_t i = 0; i < names.size(); ++i)
+        BOOST_CHECK_EQUAL(names[i].second, lookup(index, names[i].first));
+}
+
+BOOST_AUTO_TEST_CASE( metadata ) {
+    vector<PropertyInfo> props;
+    props.push_back(PropertyInfo(1, "prop1", PropertyInfo::U64,
+                                 PropertyInfo::SCALAR));
+    props.push_back(PropertyInfo(2, "prop2", PropertyInfo::STRING,
+                                 PropertyInfo::VECTOR));
+    vector<ClassInfo> classes;
+    names_t names = gbpNames();
+    for (size_t i = 0; i < names.size(); ++i) {
+        // a generated property index for another model is replaced
+        classes.push_back(ClassInfo(names[i].second, ClassInfo::POLICY,
+                                    names[i].first, "policyreg", props,
+                                    NameIndex(gen_seeds, gen_ids, 6)));
+    }
+
+    ModelMetadata md("gbp", classes, NameIndex(gen_seeds, gen_ids, 6));
+    BOOST_CHECK_EQUAL(6, md.getClassIndex().size());
+    ModelMetadata md2("gbp", classes);
+    BOOST_CHECK_EQUAL(6, md2.getClassIndex().size());
+    ModelMetadata md3("gbp", classes, NameIndex(gen_seeds, gen_ids, 3));
+    for (size_t i = 0; i < names.size(); ++i) {
+        BOOST_CHECK_EQUAL(names[i].second,
+                          lookup(md2.getClassIndex(), names[i].first));
+        BOOST_CHECK_EQUAL(names[i].second,
+                          lookup(md3.getClassIndex(), names[i].first));
+    }
+
+    const ClassInfo& ci = md.getClasses().at(0);
+    BOOST_CHECK_EQUAL(1, ci.getProperty("prop1").getId());
+    BOOST_CHECK_EQUAL(2, ci.findProperty("prop2", 5)->getId());
+    BOOST_CHECK(ci.findProperty("prop", 4) == NULL);
+    BOOST_CHECK(ci.findProperty("prop12", 6) == NULL);
+    BOOST_CHECK_THROW(ci.getProperty("prop3"), std::out_of_range);
+
+    // copies find their own properties
+    ClassInfo copy(ci);
+    BOOST_CHECK_EQUAL(&copy.getProperties().at(1),
+                      copy.findProperty("prop1", 5));
+    copy = md.getClasses().at(1);
+    BOOST_CHECK_EQUAL(&copy.getProperties().at(2),
+                      copy.findProperty("prop2", 5));
+}
+
+BOOST_FIXTURE_TEST_CASE( store, BaseFixture ) {
+    BOOST_CHECK_EQUAL(2, db.getClassInfo("class2").getId());
+    BOOST_CHECK_EQUAL(4, db.findClassInfo("class4", 6)->getId());
+    BOOST_CHECK(db.findClassInfo("class42", 7) == NULL);
+    BOOST_CHECK(db.findClassInfo("class4", 5) == NULL);
+    BOOST_CHECK_THROW(db.getClassInfo("unknown"), std::out_of_range);
+
+    const ClassInfo& ci = db.getClassInfo("class1");
+    BOOST_CHECK_EQUAL(3, ci.getProperty("class2").getId());
+    BOOST_CHECK_EQUAL(24, ci.findProperty("class5", 6)->getId());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -170,4 +170,63 @@ BOOST_AUTO_TEST_CASE( vector ) {
 
 }
 
+BOOST_AUTO_TEST_CASE( copy ) {
+    ObjectInstance orig(1);
+    for (prop_id_t i = 0; i < 100; ++i)
+        orig.setUInt64(i, i);
+    orig.setString(100, "value");
+
+    // changes to a copy do not affect the original
+    ObjectInstance oi(orig);
+    BOOST_CHECK(oi == orig);
+    BOOST_CHECK(!oi.isModifiedFrom(orig));
+    oi.setUInt64(5, 5);
+    BOOST_CHECK(!oi.isModifiedFrom(orig));
+    oi.setUInt64(5, 42);
+    oi.addString(101, "str1");
+    BOOST_CHECK(oi.isModifiedFrom(orig));
+    BOOST_CHECK(oi != orig);
+    BOOST_CHECK_EQUAL(42, oi.getUInt64(5));
+    BOOST_CHECK_EQUAL(5, orig.getUInt64(5));
+    BOOST_CHECK_EQUAL(0, orig.getStringSize(101));
+
+    // setting a property back to its original value
+    oi.setUInt64(5, 5);
+    oi.unset(101, PropertyInfo::STRING, PropertyInfo::VECTOR);
+    BOOST_CHECK(!oi.isModifiedFrom(orig));
+    BOOST_CHECK(oi == orig);
+
+    BOOST_CHECK(oi.unset(100, PropertyInfo::STRING, PropertyInfo::SCALAR));
+    BOOST_CHECK(!oi.unset(100, PropertyInfo::STRING, PropertyInfo::SCALAR));
+    BOOST_CHECK(!oi.isSet(100, PropertyInfo::STRING, PropertyInfo::SCALAR));
+    BOOST_CHECK_THROW(oi.getString(100), out_of_range);
+    BOOST_CHECK(oi.isModifiedFrom(orig));
+    BOOST_CHECK_EQUAL("value", orig.getString(100));
+    oi.setString(100, "value");
+    BOOST_CHECK(oi == orig);
+
+    // enough changes to merge them into the shared properties
+    for (prop_id_t i = 0; i < 100; ++i)
+        oi.setUInt64(i, i + 1);
+    oi.unset(0, PropertyInfo::U64, PropertyInfo::SCALAR);
+    BOOST_CHECK(oi.isModifiedFrom(orig));
+    BOOST_CHECK(!oi.isSet(0, PropertyInfo::U64, PropertyInfo::SCALAR));
+    for (prop_id_t i = 1; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(i + 1, oi.getUInt64(i));
+        BOOST_CHECK_EQUAL(i, orig.getUInt64(i));
+    }
+    BOOST_CHECK_EQUAL(0, orig.getUInt64(0));
+
+    // assignment starts with no modified properties
+    ObjectInstance oi2(1);
+    oi2 = oi;
+    BOOST_CHECK(oi2 == oi);
+    BOOST_CHECK(!oi2.isModifiedFrom(orig));
+
+    oi2.compact();
+    BOOST_CHECK(oi2 == oi);
+    BOOST_CHECK(!oi2.isSet(0, PropertyInfo::U64, PropertyInfo::SCALAR));
+    BOOST_CHECK_EQUAL(100, oi2.getUInt64(99));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,7 @@ using std::out_of_range;
 using std::invalid_argument;
 using std::vector;
 using mointernal::ObjectInstance;
+using mointernal::StoreClient;
 
 BOOST_AUTO_TEST_SUITE(ObjectStore_test)
 
@@ -90,6 +91,58 @@ BOOST_FIXTURE_TEST_CASE( region, BaseFixture ) {
     BOOST_CHECK_THROW(client2->remove(87, uri, true), out_of_range);
 }
 
+BOOST_FIXTURE_TEST_CASE( put_batch, BaseFixture ) {
+    OF_UNORDERED_MAP<URI, class_id_t> modified;
+    URI uri1("/");
+    URI uri2("/prop3/42");
+
+    OF_SHARED_PTR<ObjectInstance> oi1(new ObjectInstance(1));
+    oi1->setUInt64(1, 42);
+    OF_SHARED_PTR<ObjectInstance> oi2(new ObjectInstance(2));
+    oi2->setString(4, "value");
+    OF_SHARED_PTR<const ObjectInstance> none;
+    vector<StoreClient::PutRequest> puts;
+    StoreClient::PutRequest r1 = { 1, uri1, oi1, none };
+    StoreClient::PutRequest r2 = { 2, uri2, oi2, none };
+    puts.push_back(r1);
+    puts.push_back(r2);
+    client1->putIfModified(puts, modified);
+    BOOST_CHECK_EQUAL(2, modified.size());
+    BOOST_CHECK_EQUAL(42, client1->get(1, uri1)->getUInt64(1));
+    BOOST_CHECK_EQUAL("value", client1->get(2, uri2)->getString(4));
+
+    // copies of the stored objects, one with no effective change
+    modified.clear();
+    OF_SHARED_PTR<const ObjectInstance> orig1 = client1->get(1, uri1);
+    OF_SHARED_PTR<const ObjectInstance> orig2 = client1->get(2, uri2);
+    oi1.reset(new ObjectInstance(*orig1));
+    oi1->setUInt64(1, 43);
+    oi1->setUInt64(1, 42);
+    puts[0].oi = oi1;
+    puts[0].orig = orig1;
+    oi2.reset(new ObjectInstance(*orig2));
+    oi2->setString(4, "changed");
+    puts[1].oi = oi2;
+    puts[1].orig = orig2;
+    client1->putIfModified(puts, modified);
+    BOOST_CHECK_EQUAL(1, modified.size());
+    BOOST_CHECK(modified.find(uri2) != modified.end());
+    BOOST_CHECK(client1->get(1, uri1) == orig1);
+    BOOST_CHECK_EQUAL("changed", client1->get(2, uri2)->getString(4));
+
+    // the original is no longer stored, so the whole object is
+    // compared
+    modified.clear();
+    puts.erase(puts.begin());
+    puts[0].oi = OF_MAKE_SHARED<ObjectInstance>(*orig2);
+    client1->putIfModified(puts, modified);
+    BOOST_CHECK_EQUAL(1, modified.size());
+    BOOST_CHECK_EQUAL("value", client1->get(2, uri2)->getString(4));
+
+    BOOST_CHECK_THROW(client2->putIfModified(puts, modified),
+                      invalid_argument);
+}
+
 BOOST_FIXTURE_TEST_CASE( tree, BaseFixture ) {
     OF_UNORDERED_MAP<URI, class_id_t> notifs;
 
@@ -162,6 +215,15 @@ BOOST_FIXTURE_TEST_CASE( tree, BaseFixture ) {
     BOOST_CHECK_EQUAL(uri3.toString(), output.at(0).toString());
     output.clear();
 
+    vector<StoreClient::uri_obj_t> objs;
+    client1->getChildObjects(2, uri2, 5, 3, objs);
+    BOOST_REQUIRE_EQUAL(1, objs.size());
+    BOOST_CHECK_EQUAL(uri3, objs.at(0).first);
+    BOOST_CHECK(*oi3 == *objs.at(0).second);
+    client1->getChildObjects(1, uri1, 3, 2, objs);
+    BOOST_CHECK_EQUAL(3, objs.size());
+    objs.clear();
+
     client2->remove(3, uri3, true);
     client1->remove(1, uri1, true);
 
@@ -0,0 +1,100 @@
+/* -*- C++ -*-; c-basic-offset: 4; indent-tabs-mode: nil */
+/*
+ * Implementation for MOSnapshot class.
+ *
+ * Copyright (c) 2020 Cisco Systems, Inc. and others.  All rights reserved.
+ *
+ * This program and the accompanying materials are made available under the
+ * terms of the Eclipse Public License v1.0 which accompanies this distribution,
+ * and is available at http://www.eclipse.org/legal/epl-v10.html
+ */
+
+/* This must be included before anything else */
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdexcept>
+
+#include <boost/foreach.hpp>
+
+#include "opflex/modb/MOSnapshot.h"
+#include "opflex/modb/internal/ObjectStore.h"
+#include "opflex/ofcore/OFFramework.h"
+
+namespace opflex {
+namespace modb {
+
+using mointernal::StoreClient;
+
+MOSnapshot::MOSnapshot(ofcore::OFFramework& framework)
+    : client(framework.getStore().getReadOnlyStoreClient()), used(0) {
+
+}
+
+MOSnapshot::~MOSnapshot() {
+    BOOST_FOREACH(Entry* chunk, chunks) {
+        delete[] chunk;
+    }
+}
+
+void MOSnapshot::clear() {
+    for (size_t i = 0; i < used; ++i) {
+        Entry& e = chunks[i / CHUNK_SIZE][i % CHUNK_SIZE];
+        e.uri = URI::ROOT;
+        e.oi.reset();
+    }
+    used = 0;
+}
+
+MOSnapshot::Entry& MOSnapshot::add() {
+    if (used == chunks.size() * CHUNK_SIZE)
+        chunks.push_back(new Entry[CHUNK_SIZE]);
+    Entry& e = chunks[used / CHUNK_SIZE][used % CHUNK_SIZE];
+    used += 1;
+    return e;
+}
+
+bool MOSnapshot::pin(class_id_t class_id, const URI& uri,
+                     /* out */ size_t& index) {
+    OF_SHARED_PTR<const mointernal::ObjectInstance> oi;
+    try {
+        if (!client.get(class_id, uri, oi))
+            return false;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    index = used;
+    Entry& e = add();
+    e.class_id = class_id;
+    e.uri = uri;
+    e.oi.swap(oi);
+    return true;
+}
+
+void MOSnapshot::pinChildren(class_id_t parent_class,
+                             const URI& parent_uri,
+                             prop_id_t parent_prop,
+                             class_id_t child_class,
+                             /* out */ size_t& first,
+                             /* out */ size_t& last) {
+    first = last = used;
+    children.clear();
+    try {
+        client.getChildObjects(parent_class, parent_uri, parent_prop,
+                               child_class, children);
+    } catch (const std::out_of_range&) {
+        return;
+    }
+    BOOST_FOREACH(StoreClient::uri_obj_t& child, children) {
+        Entry& e = add();
+        e.class_id = child_class;
+        e.uri = child.first;
+        e.oi.swap(child.second);
+    }
+    children.clear();
+    last = used;
+}
+
+} /* namespace modb */
+} /* namespace opflex */
@@ -117,6 +117,14 @@ void OFFramework::setHandshakeTimeout(const uint32_t timeout) {
     pimpl->processor.setHandshakeTimeout(timeout);
 }
 
+void OFFramework::setCompression(bool enabled) {
+    pimpl->processor.setCompression(enabled);
+}
+
+void OFFramework::setPrimaryRouting(bool enabled) {
+    pimpl->processor.setPrimaryRouting(enabled);
+}
+
 void OFFramework::start() {
     LOG(DEBUG) << "Starting OpFlex Framework";
     pimpl->started = true;
@@ -15,6 +15,7 @@
 #endif
 
 #include <cstdio>
+#include <sstream>
 #include <boost/test/unit_test.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <sys/stat.h>
@@ -109,6 +110,71 @@ BOOST_FIXTURE_TEST_CASE( query, InspectorFixture ) {
     WAIT_FOR(itemPresent(&rosClient, 6, c6u), 1000);
 }
 
+static void populateTree(StoreClient* client, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        URI c4u("/class4/test" + std::to_string(i) + "/");
+        URI c6u(c4u.toString() + "class6/child/");
+        OF_SHARED_PTR<ObjectInstance> oi4(new ObjectInstance(4));
+        oi4->setString(9, "test" + std::to_string(i));
+        OF_SHARED_PTR<ObjectInstance> oi6(new ObjectInstance(6));
+        oi6->setString(13, "child");
+        client->put(4, c4u, oi4);
+        client->put(6, c6u, oi6);
+        client->addChild(4, c4u, 12, 6, c6u);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( paged, InspectorFixture ) {
+    populateTree(client2, 5);
+
+    struct stat buffer;
+    WAIT_FOR(stat(SOCK_NAME.c_str(), &buffer) == 0, 500);
+
+    // one object per reply, so the children are split from their
+    // parents across pages
+    client.setRecursive(true);
+    client.setPageSize(1);
+    client.addClassQuery("class4");
+    client.execute();
+
+    StoreClient& rosClient = client.getStore().getReadOnlyStoreClient();
+    for (size_t i = 0; i < 5; ++i) {
+        URI c4u("/class4/test" + std::to_string(i) + "/");
+        BOOST_CHECK(itemPresent(&rosClient, 4, c4u));
+        BOOST_CHECK(itemPresent(&rosClient, 6,
+                                URI(c4u.toString() + "class6/child/")));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( streamed, InspectorFixture ) {
+    populateTree(client2, 5);
+
+    struct stat buffer;
+    WAIT_FOR(stat(SOCK_NAME.c_str(), &buffer) == 0, 500);
+
+    std::ostringstream output;
+    client.setRecursive(true);
+    client.setPageSize(2);
+    client.setStreamOutput(&output, false, false);
+    client.addClassQuery("class4");
+    client.execute();
+
+    // each object is written out once and not kept afterwards
+    StoreClient& rosClient = client.getStore().getReadOnlyStoreClient();
+    string result = output.str();
+    for (size_t i = 0; i < 5; ++i) {
+        URI c4u("/class4/test" + std::to_string(i) + "/");
+        URI c6u(c4u.toString() + "class6/child/");
+        size_t pos = result.find(c4u.toString() + "\n");
+        BOOST_CHECK(pos != string::npos);
+        BOOST_CHECK(result.find(c4u.toString() + "\n", pos + 1) ==
+                    string::npos);
+        BOOST_CHECK(result.find(c6u.toString()) != string::npos);
+        BOOST_CHECK(!itemPresent(&rosClient, 4, c4u));
+        BOOST_CHECK(!itemPresent(&rosClient, 6, c6u));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } /* namespace ofcore */
@@ -18,7 +18,9 @@
 #include <stdexcept>
 #include <boost/test/unit_test.hpp>
 #include <boost/optional.hpp>
+#include <boost/foreach.hpp>
 
+#include "opflex/modb/MOSnapshot.h"
 #include "opflex/modb/URIBuilder.h"
 #include "FrameworkFixture.h"
 #include "TestListener.h"
@@ -143,4 +145,65 @@ BOOST_FIXTURE_TEST_CASE( model, FrameworkFixture ) {
 
 }
 
+BOOST_FIXTURE_TEST_CASE( view, FrameworkFixture ) {
+    Mutator mutator1(framework, "owner1");
+    OF_SHARED_PTR<testmodel::class1> root =
+        testmodel::class1::createRootElement(framework);
+    root->setProp1(42);
+    OF_SHARED_PTR<testmodel::class2> c2 = root->addClass2(-42);
+    root->addClass2(7);
+    mutator1.commit();
+
+    Mutator mutator2(framework, "owner2");
+    c2->addClass3(17, "test");
+    mutator2.commit();
+
+    MOSnapshot snapshot(framework);
+    optional<testmodel::class1::View> v1 =
+        testmodel::class1::View::resolve(snapshot, URI("/wrong"));
+    BOOST_CHECK(!v1);
+    BOOST_CHECK_EQUAL(0, snapshot.size());
+    v1 = testmodel::class1::View::resolve(snapshot, URI::ROOT);
+    BOOST_REQUIRE(v1);
+    BOOST_CHECK_EQUAL(1, v1->getClassId());
+    BOOST_CHECK_EQUAL(URI::ROOT, v1->getURI());
+    BOOST_CHECK_EQUAL(42, v1->getProp1().get());
+
+    MOSnapshot::Range<testmodel::class2::View> r2 = v1->resolveClass2();
+    BOOST_CHECK_EQUAL(2, r2.size());
+    size_t c3count = 0;
+    BOOST_FOREACH(const testmodel::class2::View& v2, r2) {
+        MOSnapshot::Range<testmodel::class3::View> r3 = v2.resolveClass3();
+        if (v2.getProp4(0) == -42) {
+            BOOST_REQUIRE_EQUAL(1, r3.size());
+            testmodel::class3::View v3 = *r3.begin();
+            BOOST_CHECK_EQUAL(17, v3.getProp6().get());
+            BOOST_CHECK_EQUAL("test", v3.getProp7().get());
+            BOOST_CHECK_EQUAL(URI("/class2/-42/class3/17/test/"),
+                              v3.getURI());
+        } else {
+            BOOST_CHECK_EQUAL(7, v2.getProp4().get());
+            BOOST_CHECK(r3.empty());
+        }
+        c3count += r3.size();
+    }
+    BOOST_CHECK_EQUAL(1, c3count);
+    BOOST_CHECK_EQUAL(4, snapshot.size());
+
+    // a view keeps the object as it was when it was resolved
+    Mutator mutator3(framework, "owner1");
+    root->setProp1(43);
+    mutator3.commit();
+    BOOST_CHECK_EQUAL(42, v1->getProp1().get());
+    BOOST_CHECK_EQUAL(43, testmodel::class1::View::resolve(snapshot, URI::ROOT)
+                      ->getProp1().get());
+
+    snapshot.clear();
+    BOOST_CHECK_EQUAL(0, snapshot.size());
+    v1 = testmodel::class1::View::resolve(snapshot, URI::ROOT);
+    BOOST_REQUIRE(v1);
+    BOOST_CHECK_EQUAL(43, v1->getProp1().get());
+    BOOST_CHECK_EQUAL(2, v1->resolveClass2().size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -16,6 +16,7 @@
 
 #include "opflex/modb/URIBuilder.h"
 #include "opflex/modb/mo-internal/MO.h"
+#include "opflex/modb/mo-internal/MOView.h"
 
 #include "testmodel/class2.h"
 #include "testmodel/class4.h"
@@ -456,6 +457,86 @@ public:
             ::MO::unregisterListener(framework, listener, CLASS_ID);
     }
 
+    /**
+     * A read-only view of an instance of class1 pinned in a snapshot.
+     * Views own nothing and are created without allocating, and are
+     * valid only until the snapshot is cleared or destroyed.
+     *
+     * @see opflex::modb::MOSnapshot
+     */
+    class View : public opflex::modb::mointernal::MOView {
+    public:
+        /**
+         * Retrieve a view of an instance of class1 from the snapshot,
+         * pinning it in the snapshot.  If the object does not exist in
+         * the local store, returns boost::none.
+         *
+         * @param snapshot the snapshot to use
+         * @param uri the URI of the object to retrieve
+         * @return a view of the object or boost::none if it does not
+         * exist.
+         */
+        static boost::optional<View>
+        resolve(opflex::modb::MOSnapshot& snapshot,
+                const opflex::modb::URI& uri) {
+            return opflex::modb::mointernal
+                ::MOView::resolve<View>(snapshot, CLASS_ID, uri);
+        }
+
+        /**
+         * Check whether prop1 has been set
+         *
+         * @return true if prop1 has been set
+         */
+        bool isProp1Set() const {
+            return getObjectInstance()
+                .isSet(1, opflex::modb::PropertyInfo::U64);
+        }
+
+        /**
+         * Get the value of prop1 if it has been set.
+         *
+         * @return the value of prop1, or boost::none if it is not set.
+         */
+        boost::optional<uint64_t> getProp1() const {
+            if (isProp1Set())
+                return getObjectInstance().getUInt64(1);
+            return boost::none;
+        }
+
+        /**
+         * Get the value of prop1 if it has been set, or the specified
+         * default value if it has not been set.
+         *
+         * @param defaultValue the default value to return if prop1 is
+         * not set.
+         * @return the value of prop1 or defaultValue
+         */
+        uint64_t getProp1(uint64_t defaultValue) const {
+            return getProp1().get_value_or(defaultValue);
+        }
+
+        /**
+         * Resolve all of the immediate children of type class2 that
+         * exist in the local store, pinning them in the snapshot of
+         * this view.
+         *
+         * @return a range of views of the child objects
+         */
+        opflex::modb::MOSnapshot::Range<class2::View> resolveClass2() const {
+            return resolveChildren<class2::View>((opflex::modb::prop_id_t)3,
+                                                 (opflex::modb::class_id_t)2);
+        }
+
+        /**
+         * Construct a view of an instance of class1 pinned in the
+         * snapshot.  This should typically not be called from user
+         * code.
+         */
+        View(opflex::modb::MOSnapshot& snapshot, size_t index)
+            : MOView(snapshot, index) { }
+    };
+
     /**
      * Construct a class1 wrapper class.  This should typically not be
      * called from user code.
@@ -16,6 +16,7 @@
 
 #include "opflex/modb/URIBuilder.h"
 #include "opflex/modb/mo-internal/MO.h"
+#include "opflex/modb/mo-internal/MOView.h"
 
 #include "testmodel/class3.h"
 
@@ -240,6 +241,86 @@ public:
             ::MO::unregisterListener(framework, listener, CLASS_ID);
     }
 
+    /**
+     * A read-only view of an instance of class2 pinned in a snapshot.
+     * Views own nothing and are created without allocating, and are
+     * valid only until the snapshot is cleared or destroyed.
+     *
+     * @see opflex::modb::MOSnapshot
+     */
+    class View : public opflex::modb::mointernal::MOView {
+    public:
+        /**
+         * Retrieve a view of an instance of class2 from the snapshot,
+         * pinning it in the snapshot.  If the object does not exist in
+         * the local store, returns boost::none.
+         *
+         * @param snapshot the snapshot to use
+         * @param uri the URI of the object to retrieve
+         * @return a view of the object or boost::none if it does not
+         * exist.
+         */
+        static boost::optional<View>
+        resolve(opflex::modb::MOSnapshot& snapshot,
+                const opflex::modb::URI& uri) {
+            return opflex::modb::mointernal
+                ::MOView::resolve<View>(snapshot, CLASS_ID, uri);
+        }
+
+        /**
+         * Check whether prop4 has been set
+         *
+         * @return true if prop4 has been set
+         */
+        bool isProp4Set() const {
+            return getObjectInstance()
+                .isSet(4, opflex::modb::PropertyInfo::S64);
+        }
+
+        /**
+         * Get the value of prop4 if it has been set.
+         *
+         * @return the value of prop4, or boost::none if it is not set.
+         */
+        boost::optional<int64_t> getProp4() const {
+            if (isProp4Set())
+                return getObjectInstance().getInt64(4);
+            return boost::none;
+        }
+
+        /**
+         * Get the value of prop4 if it has been set, or the specified
+         * default value if it has not been set.
+         *
+         * @param defaultValue the default value to return if prop4 is
+         * not set.
+         * @return the value of prop4 or defaultValue
+         */
+        int64_t getProp4(int64_t defaultValue) const {
+            return getProp4().get_value_or(defaultValue);
+        }
+
+        /**
+         * Resolve all of the immediate children of type class3 that
+         * exist in the local store, pinning them in the snapshot of
+         * this view.
+         *
+         * @return a range of views of the child objects
+         */
+        opflex::modb::MOSnapshot::Range<class3::View> resolveClass3() const {
+            return resolveChildren<class3::View>((opflex::modb::prop_id_t)5,
+                                                 (opflex::modb::class_id_t)3);
+        }
+
+        /**
+         * Construct a view of an instance of class2 pinned in the
+         * snapshot.  This should typically not be called from user
+         * code.
+         */
+        View(opflex::modb::MOSnapshot& snapshot, size_t index)
+            : MOView(snapshot, index) { }
+    };
+
     /**
      * Construct a class2 wrapper class.  This should typically not be
      * called from user code.
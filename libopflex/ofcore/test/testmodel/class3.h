@@ -16,6 +16,7 @@
 
 #include "opflex/modb/URIBuilder.h"
 #include "opflex/modb/mo-internal/MO.h"
+#include "opflex/modb/mo-internal/MOView.h"
 
 namespace testmodel {
 
@@ -248,6 +249,107 @@ public:
             ::MO::unregisterListener(framework, listener, CLASS_ID);
     }
 
+    /**
+     * A read-only view of an instance of class3 pinned in a snapshot.
+     * Views own nothing and are created without allocating, and are
+     * valid only until the snapshot is cleared or destroyed.
+     *
+     * @see opflex::modb::MOSnapshot
+     */
+    class View : public opflex::modb::mointernal::MOView {
+    public:
+        /**
+         * Retrieve a view of an instance of class3 from the snapshot,
+         * pinning it in the snapshot.  If the object does not exist in
+         * the local store, returns boost::none.
+         *
+         * @param snapshot the snapshot to use
+         * @param uri the URI of the object to retrieve
+         * @return a view of the object or boost::none if it does not
+         * exist.
+         */
+        static boost::optional<View>
+        resolve(opflex::modb::MOSnapshot& snapshot,
+                const opflex::modb::URI& uri) {
+            return opflex::modb::mointernal
+                ::MOView::resolve<View>(snapshot, CLASS_ID, uri);
+        }
+
+        /**
+         * Check whether prop6 has been set
+         *
+         * @return true if prop6 has been set
+         */
+        bool isProp6Set() const {
+            return getObjectInstance()
+                .isSet(6, opflex::modb::PropertyInfo::S64);
+        }
+
+        /**
+         * Get the value of prop6 if it has been set.
+         *
+         * @return the value of prop6, or boost::none if it is not set.
+         */
+        boost::optional<int64_t> getProp6() const {
+            if (isProp6Set())
+                return getObjectInstance().getInt64(6);
+            return boost::none;
+        }
+
+        /**
+         * Get the value of prop6 if it has been set, or the specified
+         * default value if it has not been set.
+         *
+         * @param defaultValue the default value to return if prop6 is
+         * not set.
+         * @return the value of prop6 or defaultValue
+         */
+        int64_t getProp6(int64_t defaultValue) const {
+            return getProp6().get_value_or(defaultValue);
+        }
+
+        /**
+         * Check whether prop7 has been set
+         *
+         * @return true if prop7 has been set
+         */
+        bool isProp7Set() const {
+            return getObjectInstance()
+                .isSet(7, opflex::modb::PropertyInfo::STRING);
+        }
+
+        /**
+         * Get the value of prop7 if it has been set.
+         *
+         * @return the value of prop7, or boost::none if it is not set.
+         */
+        boost::optional<const std::string&> getProp7() const {
+            if (isProp7Set())
+                return getObjectInstance().getString(7);
+            return boost::none;
+        }
+
+        /**
+         * Get the value of prop7 if it has been set, or the specified
+         * default value if it has not been set.
+         *
+         * @param defaultValue the default value to return if prop7 is
+         * not set.
+         * @return the value of prop7 or defaultValue
+         */
+        const std::string& getProp7(const std::string& defaultValue) const {
+            return getProp7().get_value_or(defaultValue);
+        }
+
+        /**
+         * Construct a view of an instance of class3 pinned in the
+         * snapshot.  This should typically not be called from user
+         * code.
+         */
+        View(opflex::modb::MOSnapshot& snapshot, size_t index)
+            : MOView(snapshot, index) { }
+    };
+
     /**
      * Construct a class3 wrapper class.  This should typically not be
      * called from user code.